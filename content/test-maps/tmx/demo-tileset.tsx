@@ -0,0 +1,18 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<tileset version="1.10" tiledversion="1.10.2" name="demo-tileset" tilewidth="16" tileheight="16" tilecount="48" columns="8">
+ <image source="../../demo-tileset.png" width="128" height="96"/>
+ <tile id="35">
+  <animation>
+   <frame tileid="35" duration="250"/>
+   <frame tileid="43" duration="250"/>
+  </animation>
+ </tile>
+ <wangsets>
+  <wangset name="Paths" type="edge" tile="-1">
+   <wangcolor name="Grass" color="#00ff00" tile="-1" probability="1"/>
+   <wangcolor name="Dirt" color="#ff7700" tile="-1" probability="0.5"/>
+   <wangtile tileid="0" wangid="1,0,2,0,1,0,1,0"/>
+   <wangtile tileid="1" wangid="2,0,2,0,1,0,1,0"/>
+  </wangset>
+ </wangsets>
+</tileset>
@@ -7,6 +7,7 @@
 
 #include "../interfaces/IDecompressor.hpp"
 #include <memory>
+#include <cstdint>
 #include <vector>
 #include <string_view>
 #include <functional>
@@ -23,17 +24,24 @@ namespace tson
             inline bool empty() const;
             inline size_t size() const;
             inline void clear();
+            [[nodiscard]] inline DecompressorContainer clone() const;
+            [[nodiscard]] inline uint64_t getRevision() const;
 
             inline IDecompressor<std::string_view, std::string> *get(std::string_view name);
         private:
             //Key: name,
             std::vector<std::unique_ptr<IDecompressor<std::string_view, std::string>>> m_decompressors;
+            //Creates a new instance of the decompressor at the same index. Used by clone()
+            std::vector<std::function<IDecompressor<std::string_view, std::string> *()>> m_factories;
+            uint64_t m_revision {0};
     };
 
     template<typename T, typename... Args>
     void DecompressorContainer::add(Args &&... args)
     {
         m_decompressors.emplace_back(new T(args...));
+        m_factories.emplace_back([args...]() -> IDecompressor<std::string_view, std::string> * { return new T(args...); });
+        ++m_revision;
     }
 
     /*!
@@ -57,11 +65,15 @@ namespace tson
      */
     void DecompressorContainer::remove(std::string_view name)
     {
-        auto iter = std::remove_if(m_decompressors.begin(), m_decompressors.end(), [&](const auto &item)
+        for(size_t i = m_decompressors.size(); i > 0; --i)
         {
-            return item->name() == name;
-        });
-        m_decompressors.erase(iter);
+            if(m_decompressors[i - 1]->name() == name)
+            {
+                m_decompressors.erase(m_decompressors.begin() + static_cast<std::ptrdiff_t>(i - 1));
+                m_factories.erase(m_factories.begin() + static_cast<std::ptrdiff_t>(i - 1));
+                ++m_revision;
+            }
+        }
     }
 
     size_t DecompressorContainer::size() const
@@ -99,6 +111,32 @@ namespace tson
     void DecompressorContainer::clear()
     {
         m_decompressors.clear();
+        m_factories.clear();
+        ++m_revision;
+    }
+
+    /*!
+     * Creates a container with new instances of the same decompressors, constructed with the same arguments as in add().
+     * Maps with lazy layers get their own copy, as they can decompress their layers after the parser is gone.
+     * Decompressors are not thread safe, so each thread parsing maps at the same time needs its own.
+     * @return A container with the same decompressors, in the same order
+     */
+    DecompressorContainer DecompressorContainer::clone() const
+    {
+        DecompressorContainer container;
+        for(const auto &factory : m_factories)
+            container.m_decompressors.emplace_back(factory());
+        container.m_factories = m_factories;
+        return container;
+    }
+
+    /*!
+     * Changes every time a decompressor is added or removed, so copies made by clone() can be told apart from the current decompressors
+     * @return The number of changes to the container
+     */
+    uint64_t DecompressorContainer::getRevision() const
+    {
+        return m_revision;
     }
 }
 #endif //TILESON_DECOMPRESSORCONTAINER_HPP
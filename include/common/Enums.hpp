@@ -150,6 +150,26 @@ namespace tson
         String = 2
     };
 
+    /*!
+     * NavigationGrid.hpp - NavigationTopology
+     */
+    enum class NavigationTopology : uint8_t
+    {
+        Orthogonal = 0,     //orthogonal and isometric maps
+        Staggered = 1,      //staggered (isometric) maps
+        Hexagonal = 2       //hexagonal maps
+    };
+
+    /*!
+     * MapSnapshot.hpp - SnapshotMode - How tson::Tileson uses .tsonb snapshots next to the maps it parses
+     */
+    enum class SnapshotMode : uint8_t
+    {
+        Disabled = 0,       //Always parse the json (default)
+        Read = 1,           //Load a snapshot instead of the json when it is up to date
+        ReadWrite = 2       //Like Read, and write a new snapshot when the json had to be parsed
+    };
+
     ENABLE_BITMASK_OPERATORS(TileFlipFlags)
 }
 
@@ -0,0 +1,555 @@
+#ifndef TILESON_INFLATE_HPP
+#define TILESON_INFLATE_HPP
+
+#include "../interfaces/IDecompressor.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tson
+{
+    /*!
+     * A small DEFLATE (RFC 1951) decompressor, used for tile layer data compressed with 'zlib' or 'gzip'.
+     * Huffman codes of up to FastBits bits are decoded through a lookup table, longer codes bit by bit.
+     *
+     * The checksums of the zlib and gzip formats are not verified.
+     */
+    class Inflate
+    {
+        public:
+            /*!
+             * Gets the decompressed data in order, a piece at a time. Returns false to stop decompressing.
+             */
+            using Sink = std::function<bool(const uint8_t *data, size_t size)>;
+
+            inline static bool Raw(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+            inline static bool Zlib(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+            inline static bool Gzip(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+            inline static bool Raw(const uint8_t *data, size_t size, const Sink &sink);
+            inline static bool Zlib(const uint8_t *data, size_t size, const Sink &sink);
+            inline static bool Gzip(const uint8_t *data, size_t size, const Sink &sink);
+
+        private:
+            static constexpr int FastBits = 9;
+            static constexpr int MaxBits = 15;
+            static constexpr size_t WindowSize = 32768;             /*! The longest distance a DEFLATE match can refer back */
+            static constexpr size_t FlushSize = WindowSize * 4;     /*! Size of the output kept in memory before it is given to a Sink */
+
+            class Huffman
+            {
+                public:
+                    inline bool build(const uint8_t *lengths, size_t count);
+
+                    uint16_t counts[MaxBits + 1] {};        /*! Number of codes of each length */
+                    uint16_t symbols[288] {};               /*! Symbols ordered by code */
+                    uint16_t fast[1 << FastBits] {};        /*! (length << 9) | symbol, by the first FastBits bits (reversed). 0 if the code is longer */
+            };
+
+            inline Inflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+            inline static size_t ZlibStart(const uint8_t *data, size_t size);
+            inline static size_t GzipStart(const uint8_t *data, size_t size);
+
+            inline bool run();
+            inline void flush(size_t keep);
+            inline bool stored();
+            inline bool codes(const Huffman &lengths, const Huffman &distances);
+            inline bool dynamic(Huffman &lengths, Huffman &distances);
+            inline static void fixed(Huffman &lengths, Huffman &distances);
+
+            inline void refill();
+            inline uint32_t bits(int count);
+            inline int decode(const Huffman &huffman);
+
+            const uint8_t *         m_data;
+            size_t                  m_size;
+            size_t                  m_pos {0};
+            uint64_t                m_bitBuffer {0};
+            int                     m_bitCount {0};
+            int                     m_paddingBits {0};  /*! Zero bits added to m_bitBuffer past the end of the data */
+            bool                    m_error {false};
+            std::vector<uint8_t> &  m_out;
+            const Sink *            m_sink {nullptr};   /*! If set, m_out is only the window of the latest output, and the rest is given to the sink */
+            bool                    m_stopped {false};  /*! The sink does not want more data */
+    };
+
+    /*!
+     * Decompresses the 'zlib' compression of Tiled tile layers
+     */
+    class ZlibDecompressor : public IDecompressor<std::string_view, std::string>
+    {
+        public:
+            [[nodiscard]] inline const std::string &name() const override
+            {
+                return NAME;
+            }
+
+            inline std::string decompress(const std::string_view &s) override
+            {
+                return decompress(s.data(), s.size());
+            }
+
+            inline std::string decompressFile(const fs::path &path) override
+            {
+                std::ifstream file(path, std::ios::binary);
+                std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                return decompress(content);
+            }
+
+            inline std::string decompress(const void *data, size_t size) override
+            {
+                std::vector<uint8_t> out;
+                if(!Inflate::Zlib(static_cast<const uint8_t *>(data), size, out))
+                    return std::string();
+                return std::string(out.begin(), out.end());
+            }
+
+        private:
+            inline static const std::string NAME = "zlib";
+    };
+
+    /*!
+     * Decompresses the 'gzip' compression of Tiled tile layers
+     */
+    class GzipDecompressor : public IDecompressor<std::string_view, std::string>
+    {
+        public:
+            [[nodiscard]] inline const std::string &name() const override
+            {
+                return NAME;
+            }
+
+            inline std::string decompress(const std::string_view &s) override
+            {
+                return decompress(s.data(), s.size());
+            }
+
+            inline std::string decompressFile(const fs::path &path) override
+            {
+                std::ifstream file(path, std::ios::binary);
+                std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                return decompress(content);
+            }
+
+            inline std::string decompress(const void *data, size_t size) override
+            {
+                std::vector<uint8_t> out;
+                if(!Inflate::Gzip(static_cast<const uint8_t *>(data), size, out))
+                    return std::string();
+                return std::string(out.begin(), out.end());
+            }
+
+        private:
+            inline static const std::string NAME = "gzip";
+    };
+
+    Inflate::Inflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out) : m_data {data}, m_size {size}, m_out {out}
+    {
+
+    }
+
+    /*!
+     * Decompresses raw DEFLATE data
+     * @param out The decompressed data is appended to 'out'
+     * @return false if the data is invalid or incomplete
+     */
+    bool Inflate::Raw(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+    {
+        Inflate inflate {data, size, out};
+        return inflate.run();
+    }
+
+    /*!
+     * Decompresses data in the zlib format (RFC 1950)
+     * @param out The decompressed data is appended to 'out'
+     * @return false if the data is invalid or incomplete
+     */
+    bool Inflate::Zlib(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+    {
+        size_t const start = ZlibStart(data, size);
+        return start > 0 && Raw(data + start, size - start, out);
+    }
+
+    /*!
+     * Decompresses data in the gzip format (RFC 1952). Only the first member is read.
+     * @param out The decompressed data is appended to 'out'
+     * @return false if the data is invalid or incomplete
+     */
+    bool Inflate::Gzip(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+    {
+        size_t const start = GzipStart(data, size);
+        return start > 0 && Raw(data + start, size - start, out);
+    }
+
+    /*!
+     * Decompresses raw DEFLATE data without keeping all of it in memory. Only the last FlushSize bytes are kept,
+     * so the memory use does not depend on the size of the output.
+     * @param sink Gets the decompressed data in order. Decompressing stops early if it returns false.
+     * @return false if the data is invalid or incomplete. true if the sink stopped it.
+     */
+    bool Inflate::Raw(const uint8_t *data, size_t size, const Sink &sink)
+    {
+        std::vector<uint8_t> window;
+        window.reserve(FlushSize + WindowSize);
+        Inflate inflate {data, size, window};
+        inflate.m_sink = &sink;
+        return inflate.run();
+    }
+
+    /*!
+     * Decompresses data in the zlib format without keeping all of it in memory. See Raw().
+     */
+    bool Inflate::Zlib(const uint8_t *data, size_t size, const Sink &sink)
+    {
+        size_t const start = ZlibStart(data, size);
+        return start > 0 && Raw(data + start, size - start, sink);
+    }
+
+    /*!
+     * Decompresses data in the gzip format without keeping all of it in memory. See Raw().
+     */
+    bool Inflate::Gzip(const uint8_t *data, size_t size, const Sink &sink)
+    {
+        size_t const start = GzipStart(data, size);
+        return start > 0 && Raw(data + start, size - start, sink);
+    }
+
+    /*!
+     * @return The offset of the DEFLATE data after the zlib header. 0 if the header is invalid.
+     */
+    size_t Inflate::ZlibStart(const uint8_t *data, size_t size)
+    {
+        if(size < 2)
+            return 0;
+
+        uint8_t const method = data[0];
+        uint8_t const flags = data[1];
+        bool const validHeader = (method & 0x0f) == 8 && ((method << 8) | flags) % 31 == 0;
+        bool const hasDictionary = (flags & 0x20) != 0;
+        return (validHeader && !hasDictionary) ? 2 : 0;
+    }
+
+    /*!
+     * @return The offset of the DEFLATE data after the gzip header. 0 if the header is invalid.
+     */
+    size_t Inflate::GzipStart(const uint8_t *data, size_t size)
+    {
+        if(size < 18 || data[0] != 0x1f || data[1] != 0x8b || data[2] != 8)
+            return 0;
+
+        uint8_t const flags = data[3];
+        size_t pos = 10;
+        if(flags & 0x04) //FEXTRA
+        {
+            if(pos + 2 > size)
+                return 0;
+            pos += 2 + (data[pos] | (data[pos + 1] << 8));
+        }
+        for(uint8_t const flag : {uint8_t(0x08), uint8_t(0x10)}) //FNAME and FCOMMENT are zero-terminated
+        {
+            if(flags & flag)
+            {
+                while(pos < size && data[pos] != 0)
+                    ++pos;
+                ++pos;
+            }
+        }
+        if(flags & 0x02) //FHCRC
+            pos += 2;
+
+        return (pos > size) ? 0 : pos;
+    }
+
+    bool Inflate::Huffman::build(const uint8_t *lengths, size_t count)
+    {
+        std::memset(counts, 0, sizeof(counts));
+        std::memset(fast, 0, sizeof(fast));
+        for(size_t i = 0; i < count; ++i)
+            ++counts[lengths[i]];
+        counts[0] = 0;
+
+        //An over-subscribed set of lengths is invalid. Incomplete sets are allowed, as they are used for single distance codes.
+        int left = 1;
+        for(int length = 1; length <= MaxBits; ++length)
+        {
+            left = (left << 1) - counts[length];
+            if(left < 0)
+                return false;
+        }
+
+        uint16_t offsets[MaxBits + 1] {};
+        for(int length = 1; length < MaxBits; ++length)
+            offsets[length + 1] = static_cast<uint16_t>(offsets[length] + counts[length]);
+        for(size_t symbol = 0; symbol < count; ++symbol)
+        {
+            if(lengths[symbol] != 0)
+                symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+        }
+
+        //Canonical codes are read least significant bit first, so the table is indexed by the reversed code
+        uint32_t code = 0;
+        size_t index = 0;
+        for(int length = 1; length <= FastBits; ++length)
+        {
+            for(int i = 0; i < counts[length]; ++i, ++code, ++index)
+            {
+                uint32_t reversed = 0;
+                for(int bit = 0; bit < length; ++bit)
+                    reversed |= ((code >> bit) & 1u) << (length - 1 - bit);
+
+                for(uint32_t entry = reversed; entry < (1u << FastBits); entry += (1u << length))
+                    fast[entry] = static_cast<uint16_t>((length << 9) | symbols[index]);
+            }
+            code <<= 1;
+        }
+
+        return true;
+    }
+
+    void Inflate::refill()
+    {
+        while(m_bitCount <= 56)
+        {
+            if(m_pos < m_size)
+                m_bitBuffer |= static_cast<uint64_t>(m_data[m_pos++]) << m_bitCount;
+            else
+                m_paddingBits += 8;
+            m_bitCount += 8;
+        }
+    }
+
+    uint32_t Inflate::bits(int count)
+    {
+        if(m_bitCount < count)
+            refill();
+
+        uint32_t const value = static_cast<uint32_t>(m_bitBuffer & ((uint64_t(1) << count) - 1));
+        m_bitBuffer >>= count;
+        m_bitCount -= count;
+        if(m_bitCount < m_paddingBits)
+            m_error = true;
+        return value;
+    }
+
+    int Inflate::decode(const Huffman &huffman)
+    {
+        if(m_bitCount < MaxBits)
+            refill();
+
+        uint16_t const entry = huffman.fast[m_bitBuffer & ((1u << FastBits) - 1)];
+        if(entry != 0)
+        {
+            bits(entry >> 9);
+            return entry & 0x1ff;
+        }
+
+        //Slow path for long codes: The canonical code is read one bit at a time
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for(int length = 1; length <= MaxBits; ++length)
+        {
+            code |= static_cast<int>(bits(1));
+            int const count = huffman.counts[length];
+            if(code - count < first)
+                return huffman.symbols[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        m_error = true;
+        return -1;
+    }
+
+    bool Inflate::run()
+    {
+        Huffman lengths;
+        Huffman distances;
+        bool last = false;
+        while(!last && !m_error && !m_stopped)
+        {
+            last = bits(1) == 1;
+            uint32_t const type = bits(2);
+            bool ok = false;
+            if(type == 0)
+                ok = stored();
+            else if(type == 1)
+            {
+                fixed(lengths, distances);
+                ok = codes(lengths, distances);
+            }
+            else if(type == 2)
+                ok = dynamic(lengths, distances) && codes(lengths, distances);
+
+            if(!ok)
+                return false;
+        }
+
+        if(m_sink != nullptr && !m_stopped && !m_error)
+            flush(0);
+        return !m_error;
+    }
+
+    /*!
+     * Gives all but the last 'keep' bytes of the output to the sink.
+     */
+    void Inflate::flush(size_t keep)
+    {
+        if(m_out.size() <= keep)
+            return;
+
+        size_t const count = m_out.size() - keep;
+        m_stopped = !(*m_sink)(m_out.data(), count);
+        m_out.erase(m_out.begin(), m_out.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+    bool Inflate::stored()
+    {
+        bits(m_bitCount % 8);
+        uint32_t const length = bits(16);
+        uint32_t const complement = bits(16);
+        if(m_error || (length ^ 0xffffu) != complement)
+            return false;
+
+        //Bytes still in the bit buffer are read first, the rest is copied directly
+        uint32_t remaining = length;
+        while(remaining > 0 && m_bitCount > m_paddingBits)
+        {
+            m_out.push_back(static_cast<uint8_t>(bits(8)));
+            --remaining;
+        }
+        if(m_pos + remaining > m_size)
+            return false;
+
+        m_out.insert(m_out.end(), m_data + m_pos, m_data + m_pos + remaining);
+        m_pos += remaining;
+        if(m_sink != nullptr && m_out.size() >= FlushSize)
+            flush(WindowSize);
+        return !m_error;
+    }
+
+    bool Inflate::codes(const Huffman &lengths, const Huffman &distances)
+    {
+        static constexpr uint16_t LengthBase[29] {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr uint8_t LengthExtra[29] {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static constexpr uint16_t DistanceBase[30] {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+                                                    4097, 6145, 8193, 12289, 16385, 24577};
+        static constexpr uint8_t DistanceExtra[30] {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        while(!m_error && !m_stopped)
+        {
+            if(m_sink != nullptr && m_out.size() >= FlushSize)
+            {
+                flush(WindowSize);
+                continue;
+            }
+
+            int symbol = decode(lengths);
+            if(symbol < 0)
+                return false;
+            if(symbol < 256)
+            {
+                m_out.push_back(static_cast<uint8_t>(symbol));
+                continue;
+            }
+            if(symbol == 256)
+                return true;
+
+            symbol -= 257;
+            if(symbol >= 29)
+                return false;
+            size_t const length = LengthBase[symbol] + bits(LengthExtra[symbol]);
+
+            int const distanceSymbol = decode(distances);
+            if(distanceSymbol < 0 || distanceSymbol >= 30)
+                return false;
+            size_t const distance = DistanceBase[distanceSymbol] + bits(DistanceExtra[distanceSymbol]);
+            if(distance > m_out.size())
+                return false;
+
+            //The copy may overlap the bytes it creates, so it must go forward one byte at a time
+            size_t const start = m_out.size();
+            m_out.resize(start + length);
+            uint8_t *out = m_out.data() + start;
+            for(size_t i = 0; i < length; ++i)
+                out[i] = out[i - distance];
+        }
+        return m_stopped && !m_error;
+    }
+
+    void Inflate::fixed(Huffman &lengths, Huffman &distances)
+    {
+        uint8_t codeLengths[288];
+        std::memset(codeLengths, 8, 144);
+        std::memset(codeLengths + 144, 9, 112);
+        std::memset(codeLengths + 256, 7, 24);
+        std::memset(codeLengths + 280, 8, 8);
+        lengths.build(codeLengths, 288);
+
+        std::memset(codeLengths, 5, 30);
+        distances.build(codeLengths, 30);
+    }
+
+    bool Inflate::dynamic(Huffman &lengths, Huffman &distances)
+    {
+        static constexpr uint8_t Order[19] {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        uint32_t const lengthCount = bits(5) + 257;
+        uint32_t const distanceCount = bits(5) + 1;
+        uint32_t const codeCount = bits(4) + 4;
+        if(lengthCount > 286 || distanceCount > 30)
+            return false;
+
+        uint8_t codeLengths[320] {};
+        for(uint32_t i = 0; i < codeCount; ++i)
+            codeLengths[Order[i]] = static_cast<uint8_t>(bits(3));
+
+        Huffman codeLengthCodes;
+        if(!codeLengthCodes.build(codeLengths, 19))
+            return false;
+
+        std::memset(codeLengths, 0, sizeof(codeLengths));
+        uint32_t index = 0;
+        while(index < lengthCount + distanceCount)
+        {
+            int const symbol = decode(codeLengthCodes);
+            if(symbol < 0 || m_error)
+                return false;
+            if(symbol < 16)
+            {
+                codeLengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            uint8_t length = 0;
+            uint32_t repeat = 0;
+            if(symbol == 16)
+            {
+                if(index == 0)
+                    return false;
+                length = codeLengths[index - 1];
+                repeat = 3 + bits(2);
+            }
+            else if(symbol == 17)
+                repeat = 3 + bits(3);
+            else
+                repeat = 11 + bits(7);
+
+            if(index + repeat > lengthCount + distanceCount)
+                return false;
+            while(repeat-- > 0)
+                codeLengths[index++] = length;
+        }
+
+        //The end of block code must exist
+        if(codeLengths[256] == 0)
+            return false;
+
+        return lengths.build(codeLengths, lengthCount) && distances.build(codeLengths + lengthCount, distanceCount);
+    }
+}
+
+#endif //TILESON_INFLATE_HPP
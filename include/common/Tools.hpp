@@ -5,6 +5,7 @@
 #ifndef TILESON_TOOLS_HPP
 #define TILESON_TOOLS_HPP
 
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <string_view>
@@ -18,6 +19,7 @@ namespace tson
             ~Tools() = delete;
             inline static std::vector<uint8_t> Base64DecodedStringToBytes(std::string_view str);
             inline static std::vector<uint32_t> BytesToUnsignedInts(const std::vector<uint8_t> &bytes);
+            inline static bool Base64DecodeRange(std::string_view base64, size_t offset, size_t size, uint8_t *out);
             inline static std::vector<std::string> SplitString(const std::string &s, char delim);
             inline static bool Equal(float a, float b, float precision = 8192.f);
 
@@ -77,6 +79,52 @@ namespace tson
         return uints;
     }
 
+    /*!
+     * Decodes 'size' bytes starting at byte 'offset' of the data encoded in a base64 string, without decoding what comes before.
+     * Every 4 characters hold 3 bytes, so the characters of a byte can be found directly. The string must not contain whitespace.
+     * @param out Receives the decoded bytes. Must have room for 'size' bytes.
+     * @return false if the string is too short or has invalid characters
+     */
+    bool Tools::Base64DecodeRange(std::string_view base64, size_t offset, size_t size, uint8_t *out)
+    {
+        static constexpr uint8_t Invalid = 0xff;
+        static const std::array<uint8_t, 256> Table = []()
+        {
+            std::array<uint8_t, 256> table {};
+            table.fill(Invalid);
+            const char *chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for(uint8_t i = 0; i < 64; ++i)
+                table[static_cast<uint8_t>(chars[i])] = i;
+            table['='] = 0;
+            return table;
+        }();
+
+        size_t group = offset / 3;
+        size_t skip = offset % 3;
+        while(size > 0)
+        {
+            size_t const pos = group * 4;
+            if(pos + 4 > base64.size())
+                return false;
+
+            uint32_t value = 0;
+            for(size_t i = pos; i < pos + 4; ++i)
+            {
+                uint8_t const sextet = Table[static_cast<uint8_t>(base64[i])];
+                if(sextet == Invalid)
+                    return false;
+                value = (value << 6) | sextet;
+            }
+
+            uint8_t const bytes[3] {static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+            for(size_t i = skip; i < 3 && size > 0; ++i, --size)
+                *out++ = bytes[i];
+            skip = 0;
+            ++group;
+        }
+        return true;
+    }
+
     std::vector<std::string> Tools::SplitString(const std::string &s, char delim)
     {
         std::vector<std::string> elems;
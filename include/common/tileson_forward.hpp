@@ -31,6 +31,19 @@ tson::TiledClass *tson::Map::getClass()
     return (m_class != nullptr) ? m_class.get() : nullptr;
 }
 
+/*!
+ * Gets a template from the template cache. Only available while parsing, for maps whose linked files are read from disk.
+ * @param relativePath Path to the template file, relative to the map file
+ * @return The template. nullptr if there is no cache, or the template could not be parsed.
+ */
+std::shared_ptr<const tson::ObjectTemplate> tson::Map::getTemplate(const std::string &relativePath)
+{
+    if(m_templateCache == nullptr || m_parsingJson == nullptr || m_hasCustomLinkedFileParser || m_parsingJson->directory().empty())
+        return nullptr;
+
+    return m_templateCache->get(m_parsingJson->directory() / relativePath, *m_parsingJson, this);
+}
+
 // T i l e . h p p
 // ---------------------
 /*!
@@ -249,6 +262,43 @@ tson::TiledClass *tson::Tileset::getClass()
     return (m_class != nullptr) ? m_class.get() : nullptr;
 }
 
+/*!
+ * Copies an external tileset from a tson::TilesetCache, and binds the copy to the map and 'firstgid' of this tileset.
+ * m_source and m_path must be set.
+ */
+bool tson::Tileset::parseFromCache(IJson &json, tson::TilesetCache &cache)
+{
+    std::shared_ptr<const tson::TilesetCache::Entry> entry = cache.get(m_path, json, m_map);
+    if(entry == nullptr)
+        return false;
+
+    tson::Map *map = m_map;
+    int const firstgid = m_firstgid;
+    fs::path source = std::move(m_source);
+    fs::path path = std::move(m_path);
+
+    *this = *entry->tileset;
+    m_source = std::move(source);
+    m_path = std::move(path);
+    if(m_type == TilesetType::ImageTileset)
+        m_imagePath = m_path.parent_path() / m_image;
+    bind(map, firstgid);
+
+    return entry->allFound;
+}
+
+/*!
+ * Reads the external tileset file ('source') through the tson::LinkedFileParser of the map, if the map was given one.
+ * @return The tileset file. nullptr if the map reads linked files from disk, or the parser could not read it.
+ */
+tson::IJson *tson::Tileset::parseLinkedFile()
+{
+    if(m_map == nullptr || !m_map->m_hasCustomLinkedFileParser)
+        return nullptr;
+
+    return m_map->parseLinkedFile(m_source.generic_string());
+}
+
 // T i l e O b j e c t . h p p
 // ---------------------
 
@@ -275,8 +325,10 @@ const tson::Rect &tson::TileObject::getDrawingRect() const
 
 /*!
  * Decompresses data if there are matching decompressors
+ * @param region If set, only the tiles inside this rectangle are kept. Uncompressed and zlib/gzip compressed base64 data is decoded
+ * without creating the rest of the tiles.
  */
-void tson::Layer::decompressData()
+void tson::Layer::decompressData(const tson::Rect *region)
 {
 
     tson::DecompressorContainer *container = m_map->getDecompressors();
@@ -286,6 +338,14 @@ void tson::Layer::decompressData()
     if(m_encoding.empty() && m_compression.empty())
         return;
 
+    bool const canDecodeRegion = m_encoding == "base64" && container->contains(m_encoding) &&
+                                 (m_compression.empty() || ((m_compression == "zlib" || m_compression == "gzip") && container->contains(m_compression)));
+    if(region != nullptr && canDecodeRegion)
+    {
+        decodeRegion(*region);
+        return;
+    }
+
     std::string data = m_base64Data;
     bool hasBeenDecoded = false;
     if(!m_encoding.empty() && container->contains(m_encoding))
@@ -304,6 +364,100 @@ void tson::Layer::decompressData()
         std::vector<uint8_t> bytes = tson::Tools::Base64DecodedStringToBytes(data);
         m_data = tson::Tools::BytesToUnsignedInts(bytes);
     }
+
+    //Other compressions are decoded in full, and then cropped
+    if(region != nullptr && hasBeenDecoded)
+    {
+        std::vector<uint32_t> tiles;
+        tiles.reserve(static_cast<size_t>(region->width) * static_cast<size_t>(region->height));
+        for(int y = region->y; y < region->y + region->height; ++y)
+        {
+            for(int x = region->x; x < region->x + region->width; ++x)
+            {
+                size_t const i = static_cast<size_t>(y) * static_cast<size_t>(m_size.x) + static_cast<size_t>(x);
+                tiles.push_back((i < m_data.size()) ? m_data[i] : 0);
+            }
+        }
+        m_data = std::move(tiles);
+    }
+}
+
+/*!
+ * Decodes the tiles inside the region from base64 data, which is either uncompressed or compressed with zlib or gzip.
+ * Uncompressed rows are decoded directly from their position in the base64 string. Compressed data is decompressed as a stream,
+ * where only the bytes of the rows inside the region are kept, and decompressing stops after the last row of the region.
+ */
+void tson::Layer::decodeRegion(const tson::Rect &region)
+{
+    size_t const rowBytes = static_cast<size_t>(m_size.x) * 4;
+    size_t const regionRowBytes = static_cast<size_t>(region.width) * 4;
+    size_t const firstRow = static_cast<size_t>(region.y);
+    size_t const endRow = firstRow + static_cast<size_t>(region.height);
+    if(regionRowBytes == 0 || region.height <= 0)
+        return;
+
+    std::vector<uint8_t> bytes;
+    bytes.resize(regionRowBytes * static_cast<size_t>(region.height), 0);
+
+    if(m_compression.empty())
+    {
+        for(size_t row = firstRow; row < endRow; ++row)
+        {
+            size_t const offset = row * rowBytes + static_cast<size_t>(region.x) * 4;
+            if(!tson::Tools::Base64DecodeRange(m_base64Data, offset, regionRowBytes, bytes.data() + (row - firstRow) * regionRowBytes))
+                break;
+        }
+    }
+    else
+    {
+        std::string compressed = m_map->getDecompressors()->get(m_encoding)->decompress(m_base64Data);
+        size_t position = 0;    //Position of the next decompressed byte in the whole layer
+        tson::Inflate::Sink sink = [&](const uint8_t *data, size_t size) -> bool
+        {
+            size_t const end = position + size;
+            for(size_t row = std::max(position / rowBytes, firstRow); row < endRow && row * rowBytes < end; ++row)
+            {
+                size_t const rowStart = row * rowBytes + static_cast<size_t>(region.x) * 4;
+                size_t const from = std::max(rowStart, position);
+                size_t const to = std::min(rowStart + regionRowBytes, end);
+                if(from < to)
+                    std::memcpy(bytes.data() + (row - firstRow) * regionRowBytes + (from - rowStart), data + (from - position), to - from);
+            }
+            position = end;
+            return position < endRow * rowBytes;
+        };
+
+        const auto *data = reinterpret_cast<const uint8_t *>(compressed.data());
+        if(m_compression == "zlib")
+            tson::Inflate::Zlib(data, compressed.size(), sink);
+        else
+            tson::Inflate::Gzip(data, compressed.size(), sink);
+    }
+
+    m_data = tson::Tools::BytesToUnsignedInts(bytes);
+}
+
+/*!
+ * The rectangle of the tile data to decode, when the map has a tile region (see tson::Map::setTileRegion()).
+ * Only finite tile layers are decoded as a region.
+ * @param region Receives the tile region of the map, clipped to the size of the layer
+ * @return true if only the region must be decoded
+ */
+bool tson::Layer::getDataRegion(tson::Rect &region) const
+{
+    if(m_map == nullptr || m_map->isInfinite() || m_type != tson::LayerType::TileLayer)
+        return false;
+
+    const tson::Rect &tileRegion = m_map->m_tileRegion;
+    if(tileRegion.width <= 0 || tileRegion.height <= 0)
+        return false;
+
+    int const x0 = std::clamp(tileRegion.x, 0, m_size.x);
+    int const y0 = std::clamp(tileRegion.y, 0, m_size.y);
+    int const x1 = std::clamp(tileRegion.x + tileRegion.width, 0, m_size.x);
+    int const y1 = std::clamp(tileRegion.y + tileRegion.height, 0, m_size.y);
+    region = {x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)};
+    return true;
 }
 
 /*!
@@ -312,11 +466,72 @@ void tson::Layer::decompressData()
  * @return true if all mandatory fields was found. false otherwise.
  */
 bool tson::Layer::parse(IJson &json, tson::Map *map)
+{
+    bool allFound = parseHeader(json, map);
+    if(json.count("layers") > 0 && json["layers"].isArray())
+        ParseLayers(json, m_map, m_layers, {}, false);
+
+    parseProperties(json);
+    parseData(json);
+    return allFound;
+}
+
+/*!
+ * Parses the 'layers' of json into layers.
+ * Layers rejected by filter are skipped before anything but their own fields are read. A rejected group is still kept
+ * if any of its child layers are accepted. The child layers of an accepted group are all kept.
+ * @param filter Which layers to keep. Keeps all layers if empty.
+ * @param lazy If true, the data, chunks and objects of the layers are not read until the layer is loaded. json must be owned by the map.
+ */
+void tson::Layer::ParseLayers(IJson &json, tson::Map *map, std::vector<tson::Layer> &layers, const tson::LayerFilter &filter, bool lazy)
+{
+    const tson::LayerFilter keepAll;
+    auto &array = json.array("layers");
+    for(std::unique_ptr<IJson> &item : array)
+    {
+        tson::Layer &layer = layers.emplace_back();
+        layer.parseHeader(*item, map);
+        bool const accepted = !filter || filter(layer);
+        if(!accepted && layer.m_type != tson::LayerType::Group)
+        {
+            layers.pop_back();
+            continue;
+        }
+
+        if(item->count("layers") > 0 && (*item)["layers"].isArray())
+            ParseLayers(*item, map, layer.m_layers, (accepted) ? keepAll : filter, lazy);
+
+        if(!accepted && layer.m_layers.empty())
+        {
+            layers.pop_back();
+            continue;
+        }
+
+        layer.parseProperties(*item);
+        if(lazy && map != nullptr)
+        {
+            layer.m_lazyJson = item.get();
+            ++map->m_unloadedLayers;
+        }
+        else
+            layer.parseData(*item);
+    }
+}
+
+/*!
+ * Reads the fields of the layer itself, which is everything but the data, chunks, child layers, objects and properties.
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Layer::parseHeader(IJson &json, tson::Map *map)
 {
     m_map = map;
 
     bool allFound = true;
-    if(json.count("tintcolor") > 0) m_tintColor = tson::Colori(json["tintcolor"].get<std::string>()); //Optional
+    if(json.count("tintcolor") > 0)
+    {
+        m_tintColor = tson::Colori(json["tintcolor"].get<std::string>()); //Optional
+        m_hasTintColor = true;
+    }
     if(json.count("compression") > 0) m_compression = json["compression"].get<std::string>(); //Optional
     if(json.count("draworder") > 0) m_drawOrder = json["draworder"].get<std::string>(); //Optional
     if(json.count("encoding") > 0) m_encoding = json["encoding"].get<std::string>(); //Optional
@@ -345,47 +560,229 @@ bool tson::Layer::parse(IJson &json, tson::Map *map)
 
     m_parallax = parallax;
 
+    setTypeByString();
+    return allFound;
+}
+
+void tson::Layer::parseProperties(IJson &json)
+{
+    if(json.count("properties") > 0 && json["properties"].isArray())
+    {
+        auto &properties = json.array("properties");
+        tson::Project *project = (m_map != nullptr) ? m_map->getProject() : nullptr;
+        std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item, project); });
+    }
+}
+
+/*!
+ * Reads the data, chunks and objects of the layer. This is the part of a layer that is deferred by lazy layers.
+ */
+void tson::Layer::parseData(IJson &json)
+{
+    tson::Rect region;
+    bool const decodeRegion = getDataRegion(region);
+
     //Handle DATA (Optional)
     if(json.count("data") > 0)
     {
         if(json["data"].isArray())
         {
-            auto &array = json.array("data");
-            std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item) { m_data.push_back(item->get<uint32_t>()); });
+            if(decodeRegion)
+                json.readArrayRegion("data", m_data, static_cast<size_t>(m_size.x), static_cast<size_t>(region.x), static_cast<size_t>(region.y),
+                                     static_cast<size_t>(region.width), static_cast<size_t>(region.height));
+            else
+                json.readArray("data", m_data);
         }
         else
         {
             m_base64Data = json["data"].get<std::string>();
-            decompressData();
+            decompressData((decodeRegion) ? &region : nullptr);
         }
     }
 
-    //More advanced data
-    if(json.count("chunks") > 0 && json["chunks"].isArray())
+    if(decodeRegion)
     {
-        auto &chunks = json.array("chunks");
-        std::for_each(chunks.begin(), chunks.end(), [&](std::unique_ptr<IJson> &item) { m_chunks.emplace_back(*item); });
+        m_regionOrigin = {region.x, region.y};
+        m_size = {region.width, region.height};
+        m_hasRegion = true;
     }
-    if(json.count("layers") > 0 && json["layers"].isArray())
+
+    //More advanced data. With a tile region, only the chunks overlapping it are read.
+    if(json.count("chunks") > 0 && json["chunks"].isArray())
     {
-        auto &layers = json.array("layers");
-        std::for_each(layers.begin(), layers.end(), [&](std::unique_ptr<IJson> &item) { m_layers.emplace_back(*item, m_map); });
+        const tson::Rect &tileRegion = (m_map != nullptr) ? m_map->m_tileRegion : tson::Rect();
+        auto &chunks = json.array("chunks");
+        for(std::unique_ptr<IJson> &item : chunks)
+        {
+            if(tileRegion.width > 0 && tileRegion.height > 0)
+            {
+                IJson &chunk = *item;
+                int const x = chunk["x"].get<int>();
+                int const y = chunk["y"].get<int>();
+                if(x >= tileRegion.x + tileRegion.width || x + chunk["width"].get<int>() <= tileRegion.x ||
+                   y >= tileRegion.y + tileRegion.height || y + chunk["height"].get<int>() <= tileRegion.y)
+                    continue;
+            }
+            m_chunks.emplace_back(*item);
+        }
     }
     if(json.count("objects") > 0 && json["objects"].isArray())
     {
         auto &objects = json.array("objects");
         std::for_each(objects.begin(), objects.end(), [&](std::unique_ptr<IJson> &item) { m_objects.emplace_back(*item, m_map); });
     }
-    if(json.count("properties") > 0 && json["properties"].isArray())
+
+    buildObjectBuckets();
+}
+
+/*!
+ * Reads the tile data, chunks and objects of a lazy layer (see tson::Tileson::setLazyLayers()), and makes its tiles and objects
+ * available through the map. Does nothing if the layer is already loaded.
+ * Called automatically by the functions that need the data, so calling it is only needed to control when the work is done.
+ *
+ * NOTE: Loading changes the layer and its map, so layers of the same map must not be loaded from several threads at once.
+ */
+void tson::Layer::load()
+{
+    if(m_lazyJson != nullptr && m_map != nullptr)
+        m_map->loadLayer(*this);
+}
+
+/*!
+ * The extra offset caused by the parallax factor of this layer, when the given camera rectangle is used.
+ * Follows Tiled: The offset is zero when the center of the camera is at the parallax origin of the map.
+ * @param camera The visible area in pixels
+ * @return Offset in pixels that must be added to the position of everything in this layer.
+ */
+tson::Vector2f tson::Layer::getParallaxOffset(const tson::Rect &camera) const
+{
+    tson::Vector2f origin = (m_map != nullptr) ? m_map->getParallaxOrigin() : tson::Vector2f();
+    float const centerX = static_cast<float>(camera.x) + static_cast<float>(camera.width) / 2.f;
+    float const centerY = static_cast<float>(camera.y) + static_cast<float>(camera.height) / 2.f;
+    return {(1.f - m_parallax.x) * (centerX - origin.x), (1.f - m_parallax.y) * (centerY - origin.y)};
+}
+
+/*!
+ * Converts a rectangle into a range of tiles for the current orientation of the map.
+ * @param rect The rectangle to convert
+ * @param inPixels true if rect is a camera in pixels, false if rect is in tile units
+ */
+tson::Layer::TileRegion tson::Layer::createTileRegion(const tson::Rect &rect, bool inPixels)
+{
+    TileRegion region;
+    if(m_map == nullptr || m_map->getTileSize().x <= 0 || m_map->getTileSize().y <= 0)
+        return region;
+
+    const std::string &orientation = m_map->getOrientation();
+    bool const hexagonal = orientation == "hexagonal";
+    region.orientation = (orientation == "isometric") ? 1 : (hexagonal || orientation == "staggered") ? 2 : 0;
+    region.tileWidth = static_cast<float>(m_map->getTileSize().x);
+    region.tileHeight = static_cast<float>(m_map->getTileSize().y);
+    region.origin = m_offset;
+
+    if(region.orientation == 1)
     {
-        auto &properties = json.array("properties");
-        tson::Project *project = (m_map != nullptr) ? m_map->getProject() : nullptr;
-        std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item, project); });
+        region.isoOriginX = static_cast<float>(m_map->getSize().y - 1) * region.tileWidth / 2.f;
+    }
+    else if(region.orientation == 2)
+    {
+        //Same as the RenderParams of Tiled's hexagonal renderer. Staggered maps are hexagonal maps with a side length of 0.
+        region.tileWidth = static_cast<float>(m_map->getTileSize().x & ~1);
+        region.tileHeight = static_cast<float>(m_map->getTileSize().y & ~1);
+        region.staggerX = m_map->getStaggerAxis() == "x";
+        region.staggerEven = m_map->getStaggerIndex() == "even";
+        float const sideLength = (hexagonal) ? static_cast<float>(m_map->getHexsideLength()) : 0.f;
+        region.sideLengthX = (region.staggerX) ? sideLength : 0.f;
+        region.sideLengthY = (region.staggerX) ? 0.f : sideLength;
+        region.columnWidth = (region.tileWidth - region.sideLengthX) / 2.f + region.sideLengthX;
+        region.rowHeight = (region.tileHeight - region.sideLengthY) / 2.f + region.sideLengthY;
     }
 
-    setTypeByString();
+    if(!inPixels)
+    {
+        region.x0 = rect.x;
+        region.y0 = rect.y;
+        region.x1 = rect.x + rect.width - 1;
+        region.y1 = rect.y + rect.height - 1;
+        return region;
+    }
 
-    return allFound;
+    tson::Vector2f parallax = getParallaxOffset(rect);
+    region.origin = {m_offset.x + parallax.x, m_offset.y + parallax.y};
+
+    //Tiles larger than the grid are drawn from the bottom-left corner of the cell, and may also have a tile offset.
+    float padX = 0.f;
+    float padY = 0.f;
+    float padOffset = 0.f;
+    for(auto &tileset : m_map->getTilesets())
+    {
+        padX = std::max(padX, static_cast<float>(tileset.getTileSize().x) - region.tileWidth);
+        padY = std::max(padY, static_cast<float>(tileset.getTileSize().y) - region.tileHeight);
+        padOffset = std::max(padOffset, static_cast<float>(std::max(std::abs(tileset.getTileOffset().x), std::abs(tileset.getTileOffset().y))));
+    }
+
+    region.cull = true;
+    region.minX = static_cast<float>(rect.x) - region.origin.x - padX - padOffset;
+    region.minY = static_cast<float>(rect.y) - region.origin.y - padOffset;
+    region.maxX = static_cast<float>(rect.x + rect.width) - region.origin.x + padOffset;
+    region.maxY = static_cast<float>(rect.y + rect.height) - region.origin.y + padY + padOffset;
+
+    auto toTile = [](float value, float size) { return static_cast<int>(std::floor(value / size)); };
+    if(region.orientation == 1)
+    {
+        float const halfWidth = region.tileWidth / 2.f;
+        float const halfHeight = region.tileHeight / 2.f;
+        float const u0 = (region.minX - region.isoOriginX) / halfWidth;
+        float const u1 = (region.maxX - region.isoOriginX) / halfWidth;
+        float const v0 = region.minY / halfHeight;
+        float const v1 = region.maxY / halfHeight;
+        //x = (u + v) / 2 and y = (v - u) / 2, where u = x - y and v = x + y
+        region.x0 = static_cast<int>(std::floor((u0 + v0) / 2.f)) - 1;
+        region.x1 = static_cast<int>(std::ceil((u1 + v1) / 2.f)) + 1;
+        region.y0 = static_cast<int>(std::floor((v0 - u1) / 2.f)) - 1;
+        region.y1 = static_cast<int>(std::ceil((v1 - u0) / 2.f)) + 1;
+    }
+    else if(region.orientation == 2)
+    {
+        float const stepX = (region.staggerX) ? region.columnWidth : region.tileWidth + region.sideLengthX;
+        float const stepY = (region.staggerX) ? region.tileHeight + region.sideLengthY : region.rowHeight;
+        region.x0 = toTile(region.minX, stepX) - 1;
+        region.x1 = toTile(region.maxX, stepX) + 1;
+        region.y0 = toTile(region.minY, stepY) - 1;
+        region.y1 = toTile(region.maxY, stepY) + 1;
+    }
+    else
+    {
+        region.x0 = toTile(region.minX, region.tileWidth) - 1;
+        region.x1 = toTile(region.maxX, region.tileWidth);
+        region.y0 = toTile(region.minY, region.tileHeight) - 1;
+        region.y1 = toTile(region.maxY, region.tileHeight);
+    }
+
+    return region;
+}
+
+/*!
+ * Finds the tile of a gid. Flip flagged gids are resolved to their flipped tile if it exists, otherwise to the original tile.
+ */
+tson::Tile *tson::Layer::resolveTile(uint32_t gid)
+{
+    if(m_map == nullptr)
+        return nullptr;
+
+    //Tiles without flip flags are found with a single lookup in the drawing table
+    if((gid & (FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG)) == 0)
+    {
+        const tson::TileDrawInfo *info = m_map->getTileDrawInfo(gid);
+        return (info != nullptr) ? info->tile : nullptr;
+    }
+
+    const std::map<uint32_t, tson::Tile *> &tileMap = m_map->getTileMap();
+    auto iter = tileMap.find(gid);
+    if(iter == tileMap.end())
+        iter = tileMap.find(gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG));
+
+    return (iter != tileMap.end()) ? iter->second : nullptr;
 }
 
 tson::TiledClass *tson::Layer::getClass()
@@ -544,6 +941,10 @@ bool tson::Object::parse(IJson &json, tson::Map *map)
     
     if(readField(m_template, "template", json) && map != nullptr)
     {
+        std::shared_ptr<const tson::ObjectTemplate> objectTemplate = map->getTemplate(m_template);
+        if(objectTemplate != nullptr)
+            return parseInstance(json, *objectTemplate);
+
         IJson* tobjJsonFile = map->parseLinkedFile(m_template);
         if(tobjJsonFile) 
             templateJson = readField("object", *tobjJsonFile);
@@ -578,6 +979,65 @@ bool tson::Object::parse(IJson &json, tson::Map *map)
     return allFound;
 }
 
+/*!
+ * Parses an instance of a cached template: The object starts as a copy of the template object, and only the fields of the
+ * instance are read on top of it.
+ * @param json The instance
+ * @param objectTemplate The template of the instance
+ * @return true if all mandatory fields was found in the instance or the template. false otherwise.
+ */
+bool tson::Object::parseInstance(IJson &json, const tson::ObjectTemplate &objectTemplate)
+{
+    tson::Map *map = m_map;
+    std::string templatePath = std::move(m_template);
+    *this = objectTemplate.getObject();
+    m_map = map;
+    m_template = std::move(templatePath);
+
+    auto hasField = [&](const std::string &name) { return json.count(name) > 0 || objectTemplate.hasField(name); };
+
+    readField(m_ellipse, "ellipse", json); //Optional
+    readField(m_point, "point", json); // Optional
+    readField(m_text, "text", json);
+    if(json.count("gid") > 0)
+    {
+        m_flipFlags = TileFlipFlags::None;
+        readGid(m_gid, m_flipFlags, json);
+    }
+
+    bool allFound = true;
+    allFound &= readField(m_id, "id", json) || objectTemplate.hasField("id");
+    allFound &= readField(m_name, "name", json) || objectTemplate.hasField("name");
+    allFound &= readField(m_rotation, "rotation", json) || objectTemplate.hasField("rotation");
+    allFound &= readField(m_type, "type", json) || objectTemplate.hasField("type") || readField(m_type, "class", json) || objectTemplate.hasField("class");
+    allFound &= readField(m_visible, "visible", json) || objectTemplate.hasField("visible");
+    readField(m_size.x, "width", json);
+    readField(m_size.y, "height", json);
+    allFound &= hasField("width") && hasField("height");
+    readField(m_position.x, "x", json);
+    readField(m_position.y, "y", json);
+    allFound &= hasField("x") && hasField("y");
+
+    setObjectType(hasField, true);
+    if(m_objectType == ObjectType::Template)
+        allFound = true; //Just accept anything with this type
+
+    if(json.count("polygon") > 0)
+    {
+        m_polygon.clear();
+        readField(m_polygon, "polygon", json);
+    }
+    if(json.count("polyline") > 0)
+    {
+        m_polyline.clear();
+        readField(m_polyline, "polyline", json);
+    }
+
+    readProperties(m_properties, json, m_map);
+
+    return allFound;
+}
+
 // W a n g s e t . h p p
 // ----------------------
 tson::TiledClass *tson::WangSet::getClass()
@@ -633,24 +1093,204 @@ tson::TiledClass *tson::Object::getClass()
 // ------------------
 
 /*!
- * Loads the actual maps based on the world data.
+ * Loads the actual maps based on the world data. The maps are parsed in parallel on the background threads of the parser,
+ * whose number is set by tson::Tileson::setThreadCount(). See tson::Tileson::parseMany().
+ *
+ * External tilesets and templates shared by the maps are only parsed once: If the parser has no tileset cache or template cache,
+ * the world attaches its own to every map it loads.
  * @param parser A Tileson object used for parsing the maps of the world.
- * @return How many maps who were parsed. Remember to call getStatus() for the actual map to find out if everything went okay.
+ * @return How many maps were loaded successfully. getMaps() has a map for every entry of getMapData(), in the same order,
+ * and getFailedMaps() lists the maps that failed. A map whose parsing threw an exception, like std::bad_alloc,
+ * fails with tson::ParseStatus::ParseError and the message of the exception (see tson::Tileson::CreateFailedMap()).
  */
-
 std::size_t tson::World::loadMaps(tson::Tileson *parser)
 {
     m_maps.clear();
-    std::for_each(m_mapData.begin(), m_mapData.end(), [&](const tson::WorldMapData &data)
+    m_failedMaps.clear();
+
+    std::shared_ptr<tson::TilesetCache> tilesetCache = parser->getTilesetCache();
+    std::shared_ptr<tson::TemplateCache> templateCache = parser->getTemplateCache();
+    if(tilesetCache == nullptr)
+    {
+        if(m_tilesetCache == nullptr)
+            m_tilesetCache = std::make_shared<tson::TilesetCache>();
+        parser->setTilesetCache(m_tilesetCache);
+    }
+    if(templateCache == nullptr)
     {
-        if(fs::exists(data.path))
+        if(m_templateCache == nullptr)
+            m_templateCache = std::make_shared<tson::TemplateCache>();
+        parser->setTemplateCache(m_templateCache);
+    }
+
+    std::vector<std::future<std::unique_ptr<tson::Map>>> futures;
+    futures.reserve(m_mapData.size());
+    for(const tson::WorldMapData &data : m_mapData)
+        futures.push_back((m_archive != nullptr) ? parser->parseAsync(*m_archive, data.path) : parser->parseAsync(data.path));
+
+    //The options are copied when the maps are queued, so the caches of the parser can be restored right away
+    parser->setTilesetCache(std::move(tilesetCache));
+    parser->setTemplateCache(std::move(templateCache));
+
+    m_maps.reserve(futures.size());
+    for(size_t i = 0; i < futures.size(); ++i)
+    {
+        try
+        {
+            m_maps.push_back(futures[i].get());
+        }
+        catch(...)
+        {
+            m_maps.push_back(tson::Tileson::CreateFailedMap(std::current_exception()));
+        }
+        if(m_maps.back()->getStatus() != tson::ParseStatus::OK)
+            m_failedMaps.push_back(i);
+    }
+
+    return m_maps.size() - m_failedMaps.size();
+}
+
+/*!
+ * Parses a world file in a tson::Archive. loadMaps() then loads the maps from the same archive,
+ * and 'patterns' match the files in the folder of the world in the archive.
+ * @param archive The archive. Must outlive the world, or at least every call to loadMaps().
+ * @param path Path of the world file in the archive
+ * @return false if the file is not in the archive, or could not be parsed
+ */
+bool tson::World::parse(const tson::Archive &archive, const fs::path &path)
+{
+    m_path = tson::Archive::NormalizePath(path);
+    m_folder = m_path.parent_path();
+    m_archive = &archive;
+
+    std::vector<uint8_t> content;
+    if(!archive.read(m_path, content) || !m_json->parse(content.data(), content.size()))
+        return false;
+
+    parseJson(*m_json);
+    return true;
+}
+
+std::vector<std::string> tson::World::getFileNamesInArchive() const
+{
+    return m_archive->getFileNames(m_folder);
+}
+
+// P r o j e c t . h p p
+// ------------------
+
+/*!
+ * Parses a project file in a tson::Archive. The 'folders' are listed in getData().folders, but are not loaded as tson::ProjectFolders,
+ * which read their folders from disk.
+ * @param archive The archive
+ * @param path Path of the project file in the archive
+ * @return false if the file is not in the archive, or could not be parsed
+ */
+bool tson::Project::parse(const tson::Archive &archive, const fs::path &path)
+{
+    m_path = tson::Archive::NormalizePath(path);
+
+    std::vector<uint8_t> content;
+    if(!archive.read(m_path, content) || !m_json->parse(content.data(), content.size()))
+        return false;
+
+    parseJson(*m_json, false);
+    return true;
+}
+
+// W o r l d S t r e a m e r . h p p
+// ------------------
+
+#ifdef JSON11_IS_DEFINED
+/*!
+ * Parses the maps with tson::Json11. The threads share a tson::TilesetCache and a tson::TemplateCache,
+ * so tilesets and templates used by many maps are only parsed once.
+ * @param world The world. Its map data is copied, so the world does not have to outlive the streamer.
+ * @param threadCount Number of background threads. 0 uses the number of hardware threads.
+ */
+tson::WorldStreamer::WorldStreamer(const tson::World &world, size_t threadCount)
+    : WorldStreamer(world, [tilesets = std::make_shared<tson::TilesetCache>(), templates = std::make_shared<tson::TemplateCache>()]()
+    {
+        std::unique_ptr<tson::Tileson> parser = std::make_unique<tson::Tileson>();
+        parser->setTilesetCache(tilesets);
+        parser->setTemplateCache(templates);
+        return parser;
+    }, threadCount)
+{
+
+}
+#endif
+
+/*!
+ * Parses queued maps, nearest first, until the streamer is destroyed.
+ * A map whose parsing throws, like when the parser factory does, fails like a file that does not exist.
+ */
+void tson::WorldStreamer::workerLoop()
+{
+    std::unique_ptr<tson::Tileson> parser;
+    while(true)
+    {
+        size_t index = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workAvailable.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+            if(m_stop)
+                return;
+
+            index = m_queue.back();
+            m_queue.pop_back();
+            ++m_activeJobs;
+        }
+
+        ActiveJob const active {*this};
+        std::unique_ptr<tson::Map> map;
+        try
+        {
+            //Created by the first job, so an exception from the factory fails that map instead of ending the thread
+            if(parser == nullptr)
+                parser = m_parserFactory();
+
+            const fs::path &path = m_mapData[index].path;
+            if(fs::exists(path))
+                map = parser->parse(path);
+        }
+        catch(...)
+        {
+            map = nullptr;
+        }
+
         {
-            std::unique_ptr<tson::Map> map = parser->parse(data.path);
-            m_maps.push_back(std::move(map));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished.emplace_back(index, std::move(map));
         }
-    });
+    }
+}
+
+// P a r s e P o o l . h p p
+// ------------------
+
+/*!
+ * Starts one background thread for each parser
+ * @param parsers The parsers of the threads. Each must have its own json backend and decompressors.
+ */
+tson::ParsePool::ParsePool(std::vector<std::unique_ptr<tson::Tileson>> parsers) : m_parsers {std::move(parsers)}
+{
+    for(auto &parser : m_parsers)
+        m_threads.emplace_back([this, &parser = *parser]() { workerLoop(parser); });
+}
 
-    return m_maps.size();
+/*!
+ * Finishes the queued jobs, and stops the background threads
+ */
+tson::ParsePool::~ParsePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workAvailable.notify_all();
+    for(auto &thread : m_threads)
+        thread.join();
 }
 
 // P r o p e r t y . h p p
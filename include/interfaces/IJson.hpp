@@ -38,6 +38,9 @@ namespace tson
             [[nodiscard]] virtual bool isArray() const = 0;
             [[nodiscard]] virtual bool isObject() const = 0;
             [[nodiscard]] virtual bool isNull() const = 0;
+            inline virtual bool readArray(std::string_view key, std::vector<uint32_t> &values);
+            inline virtual bool readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength,
+                                                size_t x, size_t y, size_t width, size_t height);
 
             /*!
              * Get the directory where the json was loaded.
@@ -83,7 +86,7 @@ namespace tson
     {
         if constexpr (std::is_same<T, double>::value)
             return getDouble(key);
-        if constexpr (std::is_same<T, float>::value)
+        else if constexpr (std::is_same<T, float>::value)
             return getFloat(key);
         else if constexpr (std::is_same<T, int32_t>::value)
             return getInt32(key);
@@ -106,7 +109,7 @@ namespace tson
     {
         if constexpr (std::is_same<T, double>::value)
             return getDouble();
-        if constexpr (std::is_same<T, float>::value)
+        else if constexpr (std::is_same<T, float>::value)
             return getFloat();
         else if constexpr (std::is_same<T, int32_t>::value)
             return getInt32();
@@ -124,6 +127,44 @@ namespace tson
             return nullptr;
     }
 
+    /*!
+     * Appends the items of an array of unsigned integers, like the tile data of a layer, to 'values'.
+     * Reads one item at a time. Backends that store such arrays as plain integers override it to copy them directly.
+     * @return false if 'key' is not an array
+     */
+    bool IJson::readArray(std::string_view key, std::vector<uint32_t> &values)
+    {
+        if(count(key) == 0 || !operator[](key).isArray())
+            return false;
+
+        auto &items = array(key);
+        values.reserve(values.size() + items.size());
+        for(std::unique_ptr<IJson> &item : items)
+            values.push_back(item->get<uint32_t>());
+        return true;
+    }
+
+    /*!
+     * Appends a rectangle of an array of unsigned integers stored row by row, like the tile data of a layer, to 'values'.
+     * The items outside the rectangle are skipped. Items past the end of the array are read as 0.
+     * @param rowLength Number of items in each row of the array
+     * @return false if 'key' is not an array
+     */
+    bool IJson::readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength, size_t x, size_t y, size_t width, size_t height)
+    {
+        if(count(key) == 0 || !operator[](key).isArray())
+            return false;
+
+        auto &items = array(key);
+        values.reserve(values.size() + width * height);
+        for(size_t row = y; row < y + height; ++row)
+        {
+            for(size_t i = row * rowLength + x; i < row * rowLength + x + width; ++i)
+                values.push_back((i < items.size()) ? items[i]->get<uint32_t>() : 0);
+        }
+        return true;
+    }
+
 }
 
 #endif //TILESON_IJSON_HPP
@@ -0,0 +1,1237 @@
+#ifndef TILESON_BINARYJSON_HPP
+#define TILESON_BINARYJSON_HPP
+
+#include <cmath>
+#include <cstring>
+
+namespace tson
+{
+    /*!
+     * Reads the Tiled json format stored as CBOR (RFC 8949) or MessagePack instead of text.
+     *
+     * The whole document is kept in one buffer, and strings and keys point into it, so parsing does not allocate
+     * per value. Arrays of unsigned 32-bit integers may be stored as a typed array, which is copied directly into the
+     * tile data of tson::Layer and tson::Chunk through readArray():
+     * - CBOR: A byte string tagged with 70 (little endian) or 66 (big endian), as in RFC 8746.
+     * - MessagePack: An ext value of type tson::BinaryJson::MessagePackUInt32Array, little endian.
+     *
+     * Maps are converted from json with tson::BinaryJson::ConvertJson(), which stores the tile 'data' of layers and chunks as
+     * typed arrays. External tilesets and templates are read with the same backend, so they must be converted as well.
+     *
+     * Use tson::CborJson or tson::MessagePackJson as the json parser of tson::Tileson.
+     */
+    class BinaryJson : public tson::IJson
+    {
+        public:
+            enum class Format : uint8_t
+            {
+                Cbor = 0,
+                MessagePack = 1
+            };
+
+            static constexpr uint64_t CborUInt32BigEndianTag {66};
+            static constexpr uint64_t CborUInt32LittleEndianTag {70};
+            static constexpr int8_t MessagePackUInt32Array {0x55};
+
+            inline explicit BinaryJson(Format format);
+
+            inline IJson &operator[](std::string_view key) override;
+            inline IJson &at(std::string_view key) override;
+            inline IJson &at(size_t pos) override;
+            inline std::vector<std::unique_ptr<IJson>> array() override;
+            inline std::vector<std::unique_ptr<IJson>> &array(std::string_view key) override;
+            [[nodiscard]] inline size_t size() const override;
+
+            inline bool parse(const fs::path &path) override;
+            inline bool parse(const void *data, size_t size) override;
+
+            [[nodiscard]] inline size_t count(std::string_view key) const override;
+            [[nodiscard]] inline bool any(std::string_view key) const override;
+            [[nodiscard]] inline bool isArray() const override;
+            [[nodiscard]] inline bool isObject() const override;
+            [[nodiscard]] inline bool isNull() const override;
+            inline bool readArray(std::string_view key, std::vector<uint32_t> &values) override;
+            inline bool readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength,
+                                        size_t x, size_t y, size_t width, size_t height) override;
+
+            [[nodiscard]] inline fs::path directory() const override;
+            inline void directory(const fs::path &directory) override;
+            inline std::unique_ptr<IJson> create() override;
+
+            [[nodiscard]] inline Format getFormat() const;
+
+            #ifdef JSON11_IS_DEFINED
+            inline static std::vector<uint8_t> FromJson(const json11::Json &json, Format format);
+            inline static bool ConvertJson(const fs::path &jsonPath, const fs::path &outputPath, Format format);
+            #endif
+
+        protected:
+            [[nodiscard]] inline int32_t getInt32(std::string_view key) override;
+            [[nodiscard]] inline uint32_t getUInt32(std::string_view key) override;
+            [[nodiscard]] inline int64_t getInt64(std::string_view key) override;
+            [[nodiscard]] inline uint64_t getUInt64(std::string_view key) override;
+            [[nodiscard]] inline double getDouble(std::string_view key) override;
+            [[nodiscard]] inline float getFloat(std::string_view key) override;
+            [[nodiscard]] inline std::string getString(std::string_view key) override;
+            [[nodiscard]] inline bool getBool(std::string_view key) override;
+
+            [[nodiscard]] inline int32_t getInt32() override;
+            [[nodiscard]] inline uint32_t getUInt32() override;
+            [[nodiscard]] inline int64_t getInt64() override;
+            [[nodiscard]] inline uint64_t getUInt64() override;
+            [[nodiscard]] inline double getDouble() override;
+            [[nodiscard]] inline float getFloat() override;
+            [[nodiscard]] inline std::string getString() override;
+            [[nodiscard]] inline bool getBool() override;
+
+        private:
+            /*!
+             * A decoded value. Strings, keys and typed arrays point into the buffer of the document.
+             */
+            class Value
+            {
+                public:
+                    enum class Kind : uint8_t
+                    {
+                        Null = 0,
+                        Bool = 1,
+                        Int = 2,
+                        UInt = 3,           /*! Only used for values above INT64_MAX */
+                        Double = 4,
+                        String = 5,
+                        Array = 6,
+                        Object = 7,
+                        UInt32Array = 8     /*! The bytes are in 'text' */
+                    };
+
+                    [[nodiscard]] inline double toDouble() const;
+                    [[nodiscard]] inline int64_t toInt64() const;
+                    [[nodiscard]] inline uint64_t toUInt64() const;
+                    [[nodiscard]] inline uint32_t getUInt32(size_t index) const;
+                    [[nodiscard]] inline const Value *find(std::string_view key) const;
+
+                    Kind                            kind {Kind::Null};
+                    bool                            bigEndian {false};
+                    bool                            boolean {false};
+                    int64_t                         integer {0};
+                    uint64_t                        unsignedInteger {0};
+                    double                          number {0.0};
+                    std::string_view                text;
+                    std::vector<std::string_view>   keys;       /*! Keys of the items of an object */
+                    std::vector<Value>              items;
+            };
+
+            class Reader
+            {
+                public:
+                    inline Reader(const uint8_t *data, size_t size);
+
+                    inline uint8_t byte();
+                    inline uint64_t bigEndian(size_t bytes);
+                    inline std::string_view bytes(uint64_t length);
+                    [[nodiscard]] inline bool hasMore() const;
+                    [[nodiscard]] inline bool isAtEnd() const;
+                    [[nodiscard]] inline uint8_t peek() const;
+
+                    bool ok {true};
+
+                private:
+                    const uint8_t * m_data;
+                    size_t m_size;
+                    size_t m_pos {0};
+            };
+
+            inline BinaryJson(const Value *value, Format format, const fs::path &path);
+            inline BinaryJson(std::unique_ptr<Value> value, Format format);
+
+            inline bool decode();
+            inline IJson &child(std::string_view key);
+            [[nodiscard]] inline const Value *value(std::string_view key) const;
+            inline std::unique_ptr<IJson> makeUInt32(uint32_t number) const;
+            inline void clearCache();
+            inline static const Value *GetNullValue();
+
+            inline static bool ReadCbor(Reader &reader, Value &value, int depth);
+            inline static bool ReadCborLength(Reader &reader, uint8_t info, uint64_t &length);
+            inline static bool ReadMessagePack(Reader &reader, Value &value, int depth);
+            inline static bool ReadMessagePackItems(Reader &reader, Value &value, uint64_t count, bool isObject, int depth);
+            inline static double HalfToDouble(uint16_t half);
+
+            #ifdef JSON11_IS_DEFINED
+            inline static void WriteCbor(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData);
+            inline static void WriteCborHead(uint8_t majorType, uint64_t length, std::vector<uint8_t> &out);
+            inline static void WriteMessagePack(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData);
+            inline static void WriteMessagePackHead(uint8_t small, uint8_t smallLimit, uint8_t head8, uint64_t length, std::vector<uint8_t> &out);
+            inline static void WriteBigEndian(uint64_t number, size_t bytes, std::vector<uint8_t> &out);
+            inline static bool IsTileData(const json11::Json &json);
+            #endif
+
+            static constexpr int MaxDepth {256};
+
+            std::vector<uint8_t>    m_buffer;               /*! Only used if this is the owner! */
+            std::unique_ptr<Value>  m_root;                 /*! Only used if this is the owner! */
+            const Value *           m_value {GetNullValue()};
+            Format                  m_format;
+            fs::path                m_path;
+
+            //Cache!
+            std::map<std::string, std::unique_ptr<IJson>, std::less<>> m_arrayCache;
+            std::map<size_t, std::unique_ptr<IJson>> m_arrayPosCache;
+            std::map<std::string, std::vector<std::unique_ptr<IJson>>, std::less<>> m_arrayListDataCache;
+    };
+
+    /*!
+     * Reads maps stored as CBOR.
+     *
+     * Example:
+     * tson::Tileson t {std::make_unique<tson::CborJson>()};
+     * std::unique_ptr<tson::Map> map = t.parse("map.cbor");
+     */
+    class CborJson : public BinaryJson
+    {
+        public:
+            inline CborJson() : BinaryJson(Format::Cbor) {}
+            inline std::unique_ptr<IJson> create() override { return std::make_unique<CborJson>(); }
+    };
+
+    /*!
+     * Reads maps stored as MessagePack.
+     *
+     * Example:
+     * tson::Tileson t {std::make_unique<tson::MessagePackJson>()};
+     * std::unique_ptr<tson::Map> map = t.parse("map.msgpack");
+     */
+    class MessagePackJson : public BinaryJson
+    {
+        public:
+            inline MessagePackJson() : BinaryJson(Format::MessagePack) {}
+            inline std::unique_ptr<IJson> create() override { return std::make_unique<MessagePackJson>(); }
+    };
+
+    double BinaryJson::Value::toDouble() const
+    {
+        switch(kind)
+        {
+            case Kind::Int: return static_cast<double>(integer);
+            case Kind::UInt: return static_cast<double>(unsignedInteger);
+            case Kind::Double: return number;
+            default: return 0.0;
+        }
+    }
+
+    int64_t BinaryJson::Value::toInt64() const
+    {
+        switch(kind)
+        {
+            case Kind::Int: return integer;
+            case Kind::UInt: return static_cast<int64_t>(unsignedInteger);
+            case Kind::Double: return static_cast<int64_t>(number);
+            default: return 0;
+        }
+    }
+
+    uint64_t BinaryJson::Value::toUInt64() const
+    {
+        switch(kind)
+        {
+            case Kind::Int: return static_cast<uint64_t>(integer);
+            case Kind::UInt: return unsignedInteger;
+            case Kind::Double: return static_cast<uint64_t>(number);
+            default: return 0;
+        }
+    }
+
+    /*!
+     * Gets an item of a typed array
+     */
+    uint32_t BinaryJson::Value::getUInt32(size_t index) const
+    {
+        const auto *bytes = reinterpret_cast<const uint8_t *>(text.data()) + index * 4;
+        if(bigEndian)
+            return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+        return bytes[0] | (static_cast<uint32_t>(bytes[1]) << 8) | (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    const BinaryJson::Value *BinaryJson::Value::find(std::string_view key) const
+    {
+        for(size_t i = 0; i < keys.size(); ++i)
+        {
+            if(keys[i] == key)
+                return &items[i];
+        }
+        return nullptr;
+    }
+
+    BinaryJson::Reader::Reader(const uint8_t *data, size_t size) : m_data {data}, m_size {size}
+    {
+
+    }
+
+    uint8_t BinaryJson::Reader::byte()
+    {
+        if(m_pos >= m_size)
+        {
+            ok = false;
+            return 0;
+        }
+        return m_data[m_pos++];
+    }
+
+    uint64_t BinaryJson::Reader::bigEndian(size_t bytes)
+    {
+        if(m_size - m_pos < bytes)
+        {
+            ok = false;
+            m_pos = m_size;
+            return 0;
+        }
+
+        uint64_t number = 0;
+        for(size_t i = 0; i < bytes; ++i)
+            number = (number << 8) | m_data[m_pos++];
+        return number;
+    }
+
+    std::string_view BinaryJson::Reader::bytes(uint64_t length)
+    {
+        if(m_size - m_pos < length)
+        {
+            ok = false;
+            m_pos = m_size;
+            return {};
+        }
+
+        std::string_view view {reinterpret_cast<const char *>(m_data + m_pos), static_cast<size_t>(length)};
+        m_pos += static_cast<size_t>(length);
+        return view;
+    }
+
+    bool BinaryJson::Reader::hasMore() const
+    {
+        return ok && m_pos < m_size;
+    }
+
+    bool BinaryJson::Reader::isAtEnd() const
+    {
+        return m_pos == m_size;
+    }
+
+    uint8_t BinaryJson::Reader::peek() const
+    {
+        return (m_pos < m_size) ? m_data[m_pos] : 0;
+    }
+
+    BinaryJson::BinaryJson(Format format) : m_format {format}
+    {
+
+    }
+
+    BinaryJson::BinaryJson(const Value *value, Format format, const fs::path &path) : m_value {value}, m_format {format}, m_path {path}
+    {
+
+    }
+
+    BinaryJson::BinaryJson(std::unique_ptr<Value> value, Format format) : m_root {std::move(value)}, m_value {m_root.get()}, m_format {format}
+    {
+
+    }
+
+    IJson &BinaryJson::operator[](std::string_view key)
+    {
+        return child(key);
+    }
+
+    IJson &BinaryJson::at(std::string_view key)
+    {
+        return child(key);
+    }
+
+    IJson &BinaryJson::at(size_t pos)
+    {
+        auto it = m_arrayPosCache.find(pos);
+        if(it == m_arrayPosCache.end())
+        {
+            std::unique_ptr<IJson> item;
+            if(m_value->kind == Value::Kind::UInt32Array)
+                item = makeUInt32(m_value->getUInt32(pos));
+            else
+                item = std::unique_ptr<IJson>(new BinaryJson(&m_value->items.at(pos), m_format, m_path));
+            it = m_arrayPosCache.emplace(pos, std::move(item)).first;
+        }
+        return *it->second;
+    }
+
+    std::vector<std::unique_ptr<IJson>> BinaryJson::array()
+    {
+        std::vector<std::unique_ptr<IJson>> vec;
+        if(m_value->kind == Value::Kind::Array)
+        {
+            for(const Value &item : m_value->items)
+                vec.emplace_back(new BinaryJson(&item, m_format, m_path));
+        }
+        else if(m_value->kind == Value::Kind::UInt32Array)
+        {
+            for(size_t i = 0; i < size(); ++i)
+                vec.emplace_back(makeUInt32(m_value->getUInt32(i)));
+        }
+        return vec;
+    }
+
+    std::vector<std::unique_ptr<IJson>> &BinaryJson::array(std::string_view key)
+    {
+        auto it = m_arrayListDataCache.find(key);
+        if(it == m_arrayListDataCache.end())
+        {
+            it = m_arrayListDataCache.emplace(std::string(key), std::vector<std::unique_ptr<IJson>>()).first;
+            if(value(key) != nullptr)
+                it->second = child(key).array();
+        }
+        return it->second;
+    }
+
+    size_t BinaryJson::size() const
+    {
+        if(m_value->kind == Value::Kind::UInt32Array)
+            return m_value->text.size() / 4;
+        if(m_value->kind == Value::Kind::Array || m_value->kind == Value::Kind::Object)
+            return m_value->items.size();
+        return 0;
+    }
+
+    bool BinaryJson::parse(const fs::path &path)
+    {
+        clearCache();
+        m_root = nullptr;
+        m_value = GetNullValue();
+        if(!fs::exists(path) || !fs::is_regular_file(path))
+            return false;
+
+        std::ifstream file(path, std::ios::binary);
+        m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if(!decode())
+            return false;
+
+        m_path = path.parent_path();
+        return true;
+    }
+
+    /*!
+     * Parses a document in memory. The data is copied, so it may be freed afterwards.
+     */
+    bool BinaryJson::parse(const void *data, size_t size)
+    {
+        clearCache();
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        m_buffer.assign(bytes, bytes + size);
+        return decode();
+    }
+
+    size_t BinaryJson::count(std::string_view key) const
+    {
+        return (value(key) != nullptr) ? 1 : 0;
+    }
+
+    bool BinaryJson::any(std::string_view key) const
+    {
+        return count(key) > 0;
+    }
+
+    bool BinaryJson::isArray() const
+    {
+        return m_value->kind == Value::Kind::Array || m_value->kind == Value::Kind::UInt32Array;
+    }
+
+    bool BinaryJson::isObject() const
+    {
+        return m_value->kind == Value::Kind::Object;
+    }
+
+    bool BinaryJson::isNull() const
+    {
+        return m_value->kind == Value::Kind::Null;
+    }
+
+    /*!
+     * Copies typed arrays directly, without creating a json value per item
+     */
+    bool BinaryJson::readArray(std::string_view key, std::vector<uint32_t> &values)
+    {
+        const Value *node = value(key);
+        if(node == nullptr || node->kind != Value::Kind::UInt32Array)
+            return IJson::readArray(key, values);
+
+        size_t const count = node->text.size() / 4;
+        size_t const offset = values.size();
+        values.resize(offset + count);
+        for(size_t i = 0; i < count; ++i)
+            values[offset + i] = node->getUInt32(i);
+        return true;
+    }
+
+    /*!
+     * Reads only the items of a typed array that are inside the rectangle, by seeking to each row
+     */
+    bool BinaryJson::readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength, size_t x, size_t y, size_t width, size_t height)
+    {
+        const Value *node = value(key);
+        if(node == nullptr || node->kind != Value::Kind::UInt32Array)
+            return IJson::readArrayRegion(key, values, rowLength, x, y, width, height);
+
+        size_t const count = node->text.size() / 4;
+        values.reserve(values.size() + width * height);
+        for(size_t row = y; row < y + height; ++row)
+        {
+            for(size_t i = row * rowLength + x; i < row * rowLength + x + width; ++i)
+                values.push_back((i < count) ? node->getUInt32(i) : 0);
+        }
+        return true;
+    }
+
+    fs::path BinaryJson::directory() const
+    {
+        return m_path;
+    }
+
+    void BinaryJson::directory(const fs::path &directory)
+    {
+        m_path = directory;
+    }
+
+    std::unique_ptr<IJson> BinaryJson::create()
+    {
+        return std::make_unique<BinaryJson>(m_format);
+    }
+
+    BinaryJson::Format BinaryJson::getFormat() const
+    {
+        return m_format;
+    }
+
+    int32_t BinaryJson::getInt32(std::string_view key)
+    {
+        const Value *node = value(key);
+        return (node != nullptr) ? static_cast<int32_t>(node->toInt64()) : 0;
+    }
+
+    uint32_t BinaryJson::getUInt32(std::string_view key)
+    {
+        const Value *node = value(key);
+        return (node != nullptr) ? static_cast<uint32_t>(node->toUInt64()) : 0;
+    }
+
+    int64_t BinaryJson::getInt64(std::string_view key)
+    {
+        const Value *node = value(key);
+        return (node != nullptr) ? node->toInt64() : 0;
+    }
+
+    uint64_t BinaryJson::getUInt64(std::string_view key)
+    {
+        const Value *node = value(key);
+        return (node != nullptr) ? node->toUInt64() : 0;
+    }
+
+    double BinaryJson::getDouble(std::string_view key)
+    {
+        const Value *node = value(key);
+        return (node != nullptr) ? node->toDouble() : 0.0;
+    }
+
+    float BinaryJson::getFloat(std::string_view key)
+    {
+        return static_cast<float>(getDouble(key));
+    }
+
+    std::string BinaryJson::getString(std::string_view key)
+    {
+        const Value *node = value(key);
+        return (node != nullptr && node->kind == Value::Kind::String) ? std::string(node->text) : std::string();
+    }
+
+    bool BinaryJson::getBool(std::string_view key)
+    {
+        const Value *node = value(key);
+        return node != nullptr && node->kind == Value::Kind::Bool && node->boolean;
+    }
+
+    int32_t BinaryJson::getInt32()
+    {
+        return static_cast<int32_t>(m_value->toInt64());
+    }
+
+    uint32_t BinaryJson::getUInt32()
+    {
+        return static_cast<uint32_t>(m_value->toUInt64());
+    }
+
+    int64_t BinaryJson::getInt64()
+    {
+        return m_value->toInt64();
+    }
+
+    uint64_t BinaryJson::getUInt64()
+    {
+        return m_value->toUInt64();
+    }
+
+    double BinaryJson::getDouble()
+    {
+        return m_value->toDouble();
+    }
+
+    float BinaryJson::getFloat()
+    {
+        return static_cast<float>(getDouble());
+    }
+
+    std::string BinaryJson::getString()
+    {
+        return (m_value->kind == Value::Kind::String) ? std::string(m_value->text) : std::string();
+    }
+
+    bool BinaryJson::getBool()
+    {
+        return m_value->kind == Value::Kind::Bool && m_value->boolean;
+    }
+
+    /*!
+     * Decodes m_buffer into m_root. The document must be exactly one value.
+     */
+    bool BinaryJson::decode()
+    {
+        m_root = std::make_unique<Value>();
+        Reader reader {m_buffer.data(), m_buffer.size()};
+        bool const ok = (m_format == Format::Cbor) ? ReadCbor(reader, *m_root, 0) : ReadMessagePack(reader, *m_root, 0);
+        if(!ok || !reader.ok || !reader.isAtEnd() || m_root->kind != Value::Kind::Object)
+        {
+            std::cerr << ((m_format == Format::Cbor) ? "CborJson" : "MessagePackJson") << " parse error: Invalid or truncated document\n";
+            m_root = nullptr;
+            m_value = GetNullValue();
+            return false;
+        }
+
+        m_value = m_root.get();
+        return true;
+    }
+
+    IJson &BinaryJson::child(std::string_view key)
+    {
+        auto it = m_arrayCache.find(key);
+        if(it == m_arrayCache.end())
+        {
+            const Value *node = value(key);
+            std::unique_ptr<IJson> item {new BinaryJson((node != nullptr) ? node : GetNullValue(), m_format, m_path)};
+            it = m_arrayCache.emplace(std::string(key), std::move(item)).first;
+        }
+        return *it->second;
+    }
+
+    const BinaryJson::Value *BinaryJson::value(std::string_view key) const
+    {
+        return (m_value->kind == Value::Kind::Object) ? m_value->find(key) : nullptr;
+    }
+
+    /*!
+     * An item of a typed array, which has no Value of its own
+     */
+    std::unique_ptr<IJson> BinaryJson::makeUInt32(uint32_t number) const
+    {
+        std::unique_ptr<Value> item = std::make_unique<Value>();
+        item->kind = Value::Kind::Int;
+        item->integer = number;
+        return std::unique_ptr<IJson>(new BinaryJson(std::move(item), m_format));
+    }
+
+    void BinaryJson::clearCache()
+    {
+        m_arrayCache.clear();
+        m_arrayPosCache.clear();
+        m_arrayListDataCache.clear();
+    }
+
+    /*!
+     * The value of keys that do not exist
+     */
+    const BinaryJson::Value *BinaryJson::GetNullValue()
+    {
+        static const Value nullValue;
+        return &nullValue;
+    }
+
+    /*!
+     * Reads the length or value following the initial byte of a CBOR item. 'info' is the low 5 bits of the initial byte.
+     * Indefinite lengths (31) are not handled here.
+     */
+    bool BinaryJson::ReadCborLength(Reader &reader, uint8_t info, uint64_t &length)
+    {
+        if(info < 24)
+            length = info;
+        else if(info <= 27)
+            length = reader.bigEndian(size_t(1) << (info - 24));
+        else
+            return false;
+        return reader.ok;
+    }
+
+    bool BinaryJson::ReadCbor(Reader &reader, Value &value, int depth)
+    {
+        if(depth > MaxDepth)
+            return false;
+
+        uint8_t const initial = reader.byte();
+        uint8_t const major = initial >> 5;
+        uint8_t const info = initial & 0x1f;
+        if(!reader.ok)
+            return false;
+
+        //Floats and simple values
+        if(major == 7)
+        {
+            switch(info)
+            {
+                case 20: value.kind = Value::Kind::Bool; value.boolean = false; return true;
+                case 21: value.kind = Value::Kind::Bool; value.boolean = true; return true;
+                case 22:
+                case 23: value.kind = Value::Kind::Null; return true;
+                case 25:
+                    value.kind = Value::Kind::Double;
+                    value.number = HalfToDouble(static_cast<uint16_t>(reader.bigEndian(2)));
+                    return reader.ok;
+                case 26:
+                {
+                    auto const bits = static_cast<uint32_t>(reader.bigEndian(4));
+                    float number;
+                    std::memcpy(&number, &bits, sizeof(number));
+                    value.kind = Value::Kind::Double;
+                    value.number = number;
+                    return reader.ok;
+                }
+                case 27:
+                {
+                    uint64_t const bits = reader.bigEndian(8);
+                    value.kind = Value::Kind::Double;
+                    std::memcpy(&value.number, &bits, sizeof(value.number));
+                    return reader.ok;
+                }
+                default: return false;
+            }
+        }
+
+        bool const indefinite = info == 31 && (major == 4 || major == 5);
+        uint64_t length = 0;
+        if(!indefinite && !ReadCborLength(reader, info, length))
+            return false;
+
+        switch(major)
+        {
+            case 0:
+                if(length > static_cast<uint64_t>(INT64_MAX))
+                {
+                    value.kind = Value::Kind::UInt;
+                    value.unsignedInteger = length;
+                }
+                else
+                {
+                    value.kind = Value::Kind::Int;
+                    value.integer = static_cast<int64_t>(length);
+                }
+                return true;
+
+            case 1:
+                if(length > static_cast<uint64_t>(INT64_MAX))
+                    return false;
+                value.kind = Value::Kind::Int;
+                value.integer = -1 - static_cast<int64_t>(length);
+                return true;
+
+            case 2:
+            case 3:
+                value.kind = Value::Kind::String;
+                value.text = reader.bytes(length);
+                return reader.ok;
+
+            case 4:
+            case 5:
+            {
+                bool const isObject = major == 5;
+                value.kind = (isObject) ? Value::Kind::Object : Value::Kind::Array;
+                if(!indefinite)
+                {
+                    //Every item is at least one byte, which keeps a broken length from reserving too much
+                    value.items.reserve(static_cast<size_t>(std::min<uint64_t>(length, 1024)));
+                    if(isObject)
+                        value.keys.reserve(value.items.capacity());
+                }
+
+                for(uint64_t i = 0; (indefinite) ? reader.peek() != 0xff : i < length; ++i)
+                {
+                    if(!reader.hasMore())
+                        return false;
+                    if(isObject)
+                    {
+                        Value key;
+                        if(!ReadCbor(reader, key, depth + 1) || key.kind != Value::Kind::String)
+                            return false;
+                        value.keys.push_back(key.text);
+                    }
+                    if(!ReadCbor(reader, value.items.emplace_back(), depth + 1))
+                        return false;
+                }
+                if(indefinite)
+                    reader.byte();
+                return reader.ok;
+            }
+
+            case 6:
+            {
+                if(!ReadCbor(reader, value, depth + 1))
+                    return false;
+                if((length == CborUInt32LittleEndianTag || length == CborUInt32BigEndianTag) && value.kind == Value::Kind::String)
+                {
+                    if(value.text.size() % 4 != 0)
+                        return false;
+                    value.kind = Value::Kind::UInt32Array;
+                    value.bigEndian = length == CborUInt32BigEndianTag;
+                }
+                return true;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    bool BinaryJson::ReadMessagePackItems(Reader &reader, Value &value, uint64_t count, bool isObject, int depth)
+    {
+        value.kind = (isObject) ? Value::Kind::Object : Value::Kind::Array;
+        value.items.reserve(static_cast<size_t>(std::min<uint64_t>(count, 1024)));
+        if(isObject)
+            value.keys.reserve(value.items.capacity());
+
+        for(uint64_t i = 0; i < count; ++i)
+        {
+            if(!reader.hasMore())
+                return false;
+            if(isObject)
+            {
+                Value key;
+                if(!ReadMessagePack(reader, key, depth + 1) || key.kind != Value::Kind::String)
+                    return false;
+                value.keys.push_back(key.text);
+            }
+            if(!ReadMessagePack(reader, value.items.emplace_back(), depth + 1))
+                return false;
+        }
+        return true;
+    }
+
+    bool BinaryJson::ReadMessagePack(Reader &reader, Value &value, int depth)
+    {
+        if(depth > MaxDepth)
+            return false;
+
+        uint8_t const type = reader.byte();
+        if(!reader.ok)
+            return false;
+
+        if(type <= 0x7f || type >= 0xe0)
+        {
+            value.kind = Value::Kind::Int;
+            value.integer = static_cast<int8_t>(type);
+            return true;
+        }
+        if(type <= 0x8f)
+            return ReadMessagePackItems(reader, value, type & 0x0f, true, depth);
+        if(type <= 0x9f)
+            return ReadMessagePackItems(reader, value, type & 0x0f, false, depth);
+        if(type <= 0xbf)
+        {
+            value.kind = Value::Kind::String;
+            value.text = reader.bytes(type & 0x1f);
+            return reader.ok;
+        }
+
+        switch(type)
+        {
+            case 0xc0: value.kind = Value::Kind::Null; return true;
+            case 0xc2: value.kind = Value::Kind::Bool; value.boolean = false; return true;
+            case 0xc3: value.kind = Value::Kind::Bool; value.boolean = true; return true;
+
+            //bin and str
+            case 0xc4:
+            case 0xc5:
+            case 0xc6:
+            case 0xd9:
+            case 0xda:
+            case 0xdb:
+            {
+                size_t const lengthBytes = size_t(1) << ((type >= 0xd9) ? type - 0xd9 : type - 0xc4);
+                value.kind = Value::Kind::String;
+                value.text = reader.bytes(reader.bigEndian(lengthBytes));
+                return reader.ok;
+            }
+
+            //ext and fixext
+            case 0xc7:
+            case 0xc8:
+            case 0xc9:
+            case 0xd4:
+            case 0xd5:
+            case 0xd6:
+            case 0xd7:
+            case 0xd8:
+            {
+                uint64_t const length = (type >= 0xd4) ? (uint64_t(1) << (type - 0xd4)) : reader.bigEndian(size_t(1) << (type - 0xc7));
+                auto const extType = static_cast<int8_t>(reader.byte());
+                std::string_view const data = reader.bytes(length);
+                if(!reader.ok)
+                    return false;
+                if(extType == MessagePackUInt32Array)
+                {
+                    if(data.size() % 4 != 0)
+                        return false;
+                    value.kind = Value::Kind::UInt32Array;
+                    value.text = data;
+                }
+                else
+                    value.kind = Value::Kind::Null;
+                return true;
+            }
+
+            case 0xca:
+            {
+                auto const bits = static_cast<uint32_t>(reader.bigEndian(4));
+                float number;
+                std::memcpy(&number, &bits, sizeof(number));
+                value.kind = Value::Kind::Double;
+                value.number = number;
+                return reader.ok;
+            }
+            case 0xcb:
+            {
+                uint64_t const bits = reader.bigEndian(8);
+                value.kind = Value::Kind::Double;
+                std::memcpy(&value.number, &bits, sizeof(value.number));
+                return reader.ok;
+            }
+
+            //uint 8 - 64
+            case 0xcc:
+            case 0xcd:
+            case 0xce:
+            case 0xcf:
+            {
+                uint64_t const number = reader.bigEndian(size_t(1) << (type - 0xcc));
+                if(number > static_cast<uint64_t>(INT64_MAX))
+                {
+                    value.kind = Value::Kind::UInt;
+                    value.unsignedInteger = number;
+                }
+                else
+                {
+                    value.kind = Value::Kind::Int;
+                    value.integer = static_cast<int64_t>(number);
+                }
+                return reader.ok;
+            }
+
+            //int 8 - 64
+            case 0xd0: value.kind = Value::Kind::Int; value.integer = static_cast<int8_t>(reader.bigEndian(1)); return reader.ok;
+            case 0xd1: value.kind = Value::Kind::Int; value.integer = static_cast<int16_t>(reader.bigEndian(2)); return reader.ok;
+            case 0xd2: value.kind = Value::Kind::Int; value.integer = static_cast<int32_t>(reader.bigEndian(4)); return reader.ok;
+            case 0xd3: value.kind = Value::Kind::Int; value.integer = static_cast<int64_t>(reader.bigEndian(8)); return reader.ok;
+
+            case 0xdc: return ReadMessagePackItems(reader, value, reader.bigEndian(2), false, depth);
+            case 0xdd: return ReadMessagePackItems(reader, value, reader.bigEndian(4), false, depth);
+            case 0xde: return ReadMessagePackItems(reader, value, reader.bigEndian(2), true, depth);
+            case 0xdf: return ReadMessagePackItems(reader, value, reader.bigEndian(4), true, depth);
+
+            default: return false;
+        }
+    }
+
+    double BinaryJson::HalfToDouble(uint16_t half)
+    {
+        int const exponent = (half >> 10) & 0x1f;
+        int const mantissa = half & 0x3ff;
+        double number;
+        if(exponent == 0)
+            number = std::ldexp(mantissa, -24);
+        else if(exponent != 31)
+            number = std::ldexp(mantissa + 1024, exponent - 25);
+        else
+            number = (mantissa == 0) ? INFINITY : NAN;
+        return (half & 0x8000) ? -number : number;
+    }
+
+    #ifdef JSON11_IS_DEFINED
+    /*!
+     * Encodes json as CBOR or MessagePack. Numbers without decimals are stored as integers, and other numbers as
+     * 32-bit floats when that is lossless. The tile 'data' arrays of layers and chunks are stored as typed arrays.
+     */
+    std::vector<uint8_t> BinaryJson::FromJson(const json11::Json &json, Format format)
+    {
+        std::vector<uint8_t> out;
+        if(format == Format::Cbor)
+            WriteCbor(json, out, false);
+        else
+            WriteMessagePack(json, out, false);
+        return out;
+    }
+
+    /*!
+     * Converts a Tiled json file (map, tileset, template...) to CBOR or MessagePack.
+     * @return false if the json could not be read, or the output could not be written
+     */
+    bool BinaryJson::ConvertJson(const fs::path &jsonPath, const fs::path &outputPath, Format format)
+    {
+        std::ifstream file(jsonPath, std::ios::binary);
+        if(!file.good())
+            return false;
+
+        std::string const content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string error;
+        json11::Json const json = json11::Json::parse(content, error);
+        if(!error.empty())
+            return false;
+
+        std::vector<uint8_t> const data = FromJson(json, format);
+        std::ofstream output(outputPath, std::ios::binary);
+        output.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        return output.good();
+    }
+
+    /*!
+     * An array where every item is an integer that fits in 32 unsigned bits
+     */
+    bool BinaryJson::IsTileData(const json11::Json &json)
+    {
+        if(!json.is_array())
+            return false;
+        for(const json11::Json &item : json.array_items())
+        {
+            double const number = item.number_value();
+            if(!item.is_number() || number < 0.0 || number > 4294967295.0 || std::floor(number) != number)
+                return false;
+        }
+        return true;
+    }
+
+    void BinaryJson::WriteBigEndian(uint64_t number, size_t bytes, std::vector<uint8_t> &out)
+    {
+        for(size_t i = bytes; i > 0; --i)
+            out.push_back(static_cast<uint8_t>(number >> ((i - 1) * 8)));
+    }
+
+    void BinaryJson::WriteCborHead(uint8_t majorType, uint64_t length, std::vector<uint8_t> &out)
+    {
+        auto const major = static_cast<uint8_t>(majorType << 5);
+        if(length < 24)
+            out.push_back(static_cast<uint8_t>(major | length));
+        else if(length <= 0xff)
+        {
+            out.push_back(major | 24);
+            WriteBigEndian(length, 1, out);
+        }
+        else if(length <= 0xffff)
+        {
+            out.push_back(major | 25);
+            WriteBigEndian(length, 2, out);
+        }
+        else if(length <= 0xffffffff)
+        {
+            out.push_back(major | 26);
+            WriteBigEndian(length, 4, out);
+        }
+        else
+        {
+            out.push_back(major | 27);
+            WriteBigEndian(length, 8, out);
+        }
+    }
+
+    void BinaryJson::WriteCbor(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData)
+    {
+        switch(json.type())
+        {
+            case json11::Json::NUL: out.push_back(0xf6); break;
+            case json11::Json::BOOL: out.push_back((json.bool_value()) ? 0xf5 : 0xf4); break;
+            case json11::Json::NUMBER:
+            {
+                double const number = json.number_value();
+                if(std::floor(number) == number && std::abs(number) < 9.2e18)
+                {
+                    auto const integer = static_cast<int64_t>(number);
+                    WriteCborHead((integer < 0) ? 1 : 0, static_cast<uint64_t>((integer < 0) ? -1 - integer : integer), out);
+                }
+                else if(static_cast<double>(static_cast<float>(number)) == number)
+                {
+                    auto const single = static_cast<float>(number);
+                    uint32_t bits;
+                    std::memcpy(&bits, &single, sizeof(bits));
+                    out.push_back(0xfa);
+                    WriteBigEndian(bits, 4, out);
+                }
+                else
+                {
+                    uint64_t bits;
+                    std::memcpy(&bits, &number, sizeof(bits));
+                    out.push_back(0xfb);
+                    WriteBigEndian(bits, 8, out);
+                }
+                break;
+            }
+            case json11::Json::STRING:
+                WriteCborHead(3, json.string_value().size(), out);
+                out.insert(out.end(), json.string_value().begin(), json.string_value().end());
+                break;
+            case json11::Json::ARRAY:
+                if(isTileData && IsTileData(json))
+                {
+                    WriteCborHead(6, CborUInt32LittleEndianTag, out);
+                    WriteCborHead(2, json.array_items().size() * 4, out);
+                    for(const json11::Json &item : json.array_items())
+                    {
+                        auto const gid = static_cast<uint32_t>(item.number_value());
+                        for(int shift = 0; shift < 32; shift += 8)
+                            out.push_back(static_cast<uint8_t>(gid >> shift));
+                    }
+                    break;
+                }
+                WriteCborHead(4, json.array_items().size(), out);
+                for(const json11::Json &item : json.array_items())
+                    WriteCbor(item, out, false);
+                break;
+            case json11::Json::OBJECT:
+                WriteCborHead(5, json.object_items().size(), out);
+                for(const auto &[key, item] : json.object_items())
+                {
+                    WriteCborHead(3, key.size(), out);
+                    out.insert(out.end(), key.begin(), key.end());
+                    WriteCbor(item, out, key == "data");
+                }
+                break;
+        }
+    }
+
+    /*!
+     * Writes the type and length of a str, array or map. 'small' is the fix-type, used for lengths below 'smallLimit',
+     * and 'head8' is the type using an 8-bit length, or 0 if there is none. The 16 and 32-bit types follow in the spec.
+     */
+    void BinaryJson::WriteMessagePackHead(uint8_t small, uint8_t smallLimit, uint8_t head8, uint64_t length, std::vector<uint8_t> &out)
+    {
+        uint8_t const head16 = (head8 != 0) ? head8 + 1 : ((small == 0x90) ? 0xdc : 0xde);
+        if(length < smallLimit)
+            out.push_back(static_cast<uint8_t>(small | length));
+        else if(head8 != 0 && length <= 0xff)
+        {
+            out.push_back(head8);
+            WriteBigEndian(length, 1, out);
+        }
+        else if(length <= 0xffff)
+        {
+            out.push_back(head16);
+            WriteBigEndian(length, 2, out);
+        }
+        else
+        {
+            out.push_back(head16 + 1);
+            WriteBigEndian(length, 4, out);
+        }
+    }
+
+    void BinaryJson::WriteMessagePack(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData)
+    {
+        switch(json.type())
+        {
+            case json11::Json::NUL: out.push_back(0xc0); break;
+            case json11::Json::BOOL: out.push_back((json.bool_value()) ? 0xc3 : 0xc2); break;
+            case json11::Json::NUMBER:
+            {
+                double const number = json.number_value();
+                if(std::floor(number) == number && std::abs(number) < 9.2e18)
+                {
+                    auto const integer = static_cast<int64_t>(number);
+                    if(integer >= -32 && integer <= 127)
+                        out.push_back(static_cast<uint8_t>(integer));
+                    else if(integer >= 0)
+                    {
+                        size_t const bytes = (integer <= 0xff) ? 1 : (integer <= 0xffff) ? 2 : (integer <= 0xffffffff) ? 4 : 8;
+                        out.push_back(static_cast<uint8_t>((bytes == 1) ? 0xcc : (bytes == 2) ? 0xcd : (bytes == 4) ? 0xce : 0xcf));
+                        WriteBigEndian(static_cast<uint64_t>(integer), bytes, out);
+                    }
+                    else
+                    {
+                        size_t const bytes = (integer >= INT8_MIN) ? 1 : (integer >= INT16_MIN) ? 2 : (integer >= INT32_MIN) ? 4 : 8;
+                        out.push_back(static_cast<uint8_t>((bytes == 1) ? 0xd0 : (bytes == 2) ? 0xd1 : (bytes == 4) ? 0xd2 : 0xd3));
+                        WriteBigEndian(static_cast<uint64_t>(integer), bytes, out);
+                    }
+                }
+                else if(static_cast<double>(static_cast<float>(number)) == number)
+                {
+                    auto const single = static_cast<float>(number);
+                    uint32_t bits;
+                    std::memcpy(&bits, &single, sizeof(bits));
+                    out.push_back(0xca);
+                    WriteBigEndian(bits, 4, out);
+                }
+                else
+                {
+                    uint64_t bits;
+                    std::memcpy(&bits, &number, sizeof(bits));
+                    out.push_back(0xcb);
+                    WriteBigEndian(bits, 8, out);
+                }
+                break;
+            }
+            case json11::Json::STRING:
+                WriteMessagePackHead(0xa0, 32, 0xd9, json.string_value().size(), out);
+                out.insert(out.end(), json.string_value().begin(), json.string_value().end());
+                break;
+            case json11::Json::ARRAY:
+                if(isTileData && IsTileData(json))
+                {
+                    size_t const bytes = json.array_items().size() * 4;
+                    if(bytes <= 0xff)
+                    {
+                        out.push_back(0xc7);
+                        WriteBigEndian(bytes, 1, out);
+                    }
+                    else if(bytes <= 0xffff)
+                    {
+                        out.push_back(0xc8);
+                        WriteBigEndian(bytes, 2, out);
+                    }
+                    else
+                    {
+                        out.push_back(0xc9);
+                        WriteBigEndian(bytes, 4, out);
+                    }
+                    out.push_back(static_cast<uint8_t>(MessagePackUInt32Array));
+                    for(const json11::Json &item : json.array_items())
+                    {
+                        auto const gid = static_cast<uint32_t>(item.number_value());
+                        for(int shift = 0; shift < 32; shift += 8)
+                            out.push_back(static_cast<uint8_t>(gid >> shift));
+                    }
+                    break;
+                }
+                WriteMessagePackHead(0x90, 16, 0, json.array_items().size(), out);
+                for(const json11::Json &item : json.array_items())
+                    WriteMessagePack(item, out, false);
+                break;
+            case json11::Json::OBJECT:
+                WriteMessagePackHead(0x80, 16, 0, json.object_items().size(), out);
+                for(const auto &[key, item] : json.object_items())
+                {
+                    WriteMessagePackHead(0xa0, 32, 0xd9, key.size(), out);
+                    out.insert(out.end(), key.begin(), key.end());
+                    WriteMessagePack(item, out, key == "data");
+                }
+                break;
+        }
+    }
+    #endif
+}
+
+#endif //TILESON_BINARYJSON_HPP
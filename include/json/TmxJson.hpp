@@ -0,0 +1,1098 @@
+#ifndef TILESON_TMXJSON_HPP
+#define TILESON_TMXJSON_HPP
+
+#include <array>
+#include <cstdlib>
+#include <functional>
+#include "../misc/XmlReader.hpp"
+#include "../common/Inflate.hpp"
+
+namespace tson
+{
+    /*!
+     * Reads the XML formats of Tiled: Maps (.tmx), tilesets (.tsx) and templates (.tx).
+     *
+     * The XML is read with a tson::XmlReader, and turned directly into the values the Tiled json format would have,
+     * so the rest of Tileson reads it like any other json. No XML document is kept in memory. Tile layer data, in csv, base64,
+     * base64 with zlib or gzip, or as <tile> elements, is decoded straight into arrays of gids, and read by tson::Layer and
+     * tson::Chunk through readArray().
+     *
+     * Example:
+     * tson::Tileson t {std::make_unique<tson::TmxJson>()};
+     * std::unique_ptr<tson::Map> map = t.parse("map.tmx");
+     */
+    class TmxJson : public tson::IJson
+    {
+        public:
+            inline TmxJson() = default;
+
+            inline IJson &operator[](std::string_view key) override;
+            inline IJson &at(std::string_view key) override;
+            inline IJson &at(size_t pos) override;
+            inline std::vector<std::unique_ptr<IJson>> array() override;
+            inline std::vector<std::unique_ptr<IJson>> &array(std::string_view key) override;
+            [[nodiscard]] inline size_t size() const override;
+
+            inline bool parse(const fs::path &path) override;
+            inline bool parse(const void *data, size_t size) override;
+
+            [[nodiscard]] inline size_t count(std::string_view key) const override;
+            [[nodiscard]] inline bool any(std::string_view key) const override;
+            [[nodiscard]] inline bool isArray() const override;
+            [[nodiscard]] inline bool isObject() const override;
+            [[nodiscard]] inline bool isNull() const override;
+            inline bool readArray(std::string_view key, std::vector<uint32_t> &values) override;
+            inline bool readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength,
+                                        size_t x, size_t y, size_t width, size_t height) override;
+
+            [[nodiscard]] inline fs::path directory() const override;
+            inline void directory(const fs::path &directory) override;
+            inline std::unique_ptr<IJson> create() override;
+
+        protected:
+            [[nodiscard]] inline int32_t getInt32(std::string_view key) override;
+            [[nodiscard]] inline uint32_t getUInt32(std::string_view key) override;
+            [[nodiscard]] inline int64_t getInt64(std::string_view key) override;
+            [[nodiscard]] inline uint64_t getUInt64(std::string_view key) override;
+            [[nodiscard]] inline double getDouble(std::string_view key) override;
+            [[nodiscard]] inline float getFloat(std::string_view key) override;
+            [[nodiscard]] inline std::string getString(std::string_view key) override;
+            [[nodiscard]] inline bool getBool(std::string_view key) override;
+
+            [[nodiscard]] inline int32_t getInt32() override;
+            [[nodiscard]] inline uint32_t getUInt32() override;
+            [[nodiscard]] inline int64_t getInt64() override;
+            [[nodiscard]] inline uint64_t getUInt64() override;
+            [[nodiscard]] inline double getDouble() override;
+            [[nodiscard]] inline float getFloat() override;
+            [[nodiscard]] inline std::string getString() override;
+            [[nodiscard]] inline bool getBool() override;
+
+        private:
+            /*!
+             * A json value. Numbers and booleans are kept as the text of the XML, and converted when they are read.
+             */
+            class Node
+            {
+                public:
+                    enum class Kind : uint8_t
+                    {
+                        Null = 0,
+                        Value = 1,
+                        Array = 2,
+                        Object = 3,
+                        Tiles = 4           /*! An array of gids, kept in 'tiles' */
+                    };
+
+                    inline Node() = default;
+                    inline explicit Node(Kind nodeKind);
+
+                    inline Node &add(std::string_view key, Kind nodeKind);
+                    inline Node &set(std::string_view key, std::string_view text);
+                    inline Node &push(Kind nodeKind);
+                    inline Node &getOrAdd(std::string_view key, Kind nodeKind);
+                    [[nodiscard]] inline const Node *find(std::string_view key) const;
+
+                    Kind                                    kind {Kind::Null};
+                    std::string                             value;
+                    std::vector<std::string>                keys;       /*! Keys of the children of an object */
+                    std::vector<std::unique_ptr<Node>>      children;
+                    std::vector<uint32_t>                   tiles;
+            };
+
+            inline TmxJson(const Node *node, const fs::path &path);
+            inline explicit TmxJson(std::unique_ptr<Node> node);
+
+            inline IJson &child(std::string_view key);
+            [[nodiscard]] inline const Node *value(std::string_view key) const;
+            inline void clearCache();
+            inline static const Node *GetNullNode();
+
+            inline static bool ReadDocument(XmlReader &reader, Node &root);
+            inline static bool ReadMap(XmlReader &reader, Node &map);
+            inline static bool ReadTileset(XmlReader &reader, Node &tileset);
+            inline static bool ReadTemplate(XmlReader &reader, Node &templ);
+            inline static bool ReadTile(XmlReader &reader, Node &tile);
+            inline static bool ReadWangSet(XmlReader &reader, Node &wangset);
+            inline static bool ReadLayer(XmlReader &reader, Node &layer);
+            inline static bool ReadData(XmlReader &reader, Node &layer);
+            inline static bool ReadObject(XmlReader &reader, Node &object);
+            inline static bool ReadText(XmlReader &reader, Node &text);
+            inline static bool ReadProperties(XmlReader &reader, Node &properties);
+            inline static bool ReadClassMembers(XmlReader &reader, Node &members);
+            inline static bool ReadImage(XmlReader &reader, Node &node);
+            inline static bool ReadChildren(XmlReader &reader, const std::function<bool(std::string_view)> &readChild);
+
+            inline static void ReadAttributes(const XmlReader &reader, Node &node);
+            inline static void SetDefault(Node &node, std::string_view key, std::string_view text);
+            inline static void ReadPoints(std::string_view points, Node &array);
+            inline static void ReadWangId(std::string_view wangid, Node &array);
+            inline static bool DecodeTiles(std::string_view text, std::string_view encoding, std::string_view compression, std::vector<uint32_t> &tiles);
+
+            std::unique_ptr<Node>   m_root;                 /*! Only used if this is the owner! */
+            const Node *            m_node {GetNullNode()};
+            fs::path                m_path;
+
+            //Cache!
+            std::map<std::string, std::unique_ptr<IJson>, std::less<>> m_arrayCache;
+            std::map<size_t, std::unique_ptr<IJson>> m_arrayPosCache;
+            std::map<std::string, std::vector<std::unique_ptr<IJson>>, std::less<>> m_arrayListDataCache;
+    };
+
+    TmxJson::Node::Node(Kind nodeKind) : kind {nodeKind}
+    {
+
+    }
+
+    TmxJson::Node &TmxJson::Node::add(std::string_view key, Kind nodeKind)
+    {
+        keys.emplace_back(key);
+        return *children.emplace_back(std::make_unique<Node>(nodeKind));
+    }
+
+    TmxJson::Node &TmxJson::Node::set(std::string_view key, std::string_view text)
+    {
+        Node &node = add(key, Kind::Value);
+        node.value = text;
+        return node;
+    }
+
+    TmxJson::Node &TmxJson::Node::push(Kind nodeKind)
+    {
+        return *children.emplace_back(std::make_unique<Node>(nodeKind));
+    }
+
+    /*!
+     * Gets the child with a key, and adds it if it does not exist. Used for arrays built from repeated elements, like 'layers'.
+     */
+    TmxJson::Node &TmxJson::Node::getOrAdd(std::string_view key, Kind nodeKind)
+    {
+        for(size_t i = 0; i < keys.size(); ++i)
+        {
+            if(keys[i] == key)
+                return *children[i];
+        }
+        return add(key, nodeKind);
+    }
+
+    const TmxJson::Node *TmxJson::Node::find(std::string_view key) const
+    {
+        for(size_t i = 0; i < keys.size(); ++i)
+        {
+            if(keys[i] == key)
+                return children[i].get();
+        }
+        return nullptr;
+    }
+
+    TmxJson::TmxJson(const Node *node, const fs::path &path) : m_node {node}, m_path {path}
+    {
+
+    }
+
+    TmxJson::TmxJson(std::unique_ptr<Node> node) : m_root {std::move(node)}, m_node {m_root.get()}
+    {
+
+    }
+
+    IJson &TmxJson::operator[](std::string_view key)
+    {
+        return child(key);
+    }
+
+    IJson &TmxJson::at(std::string_view key)
+    {
+        return child(key);
+    }
+
+    IJson &TmxJson::at(size_t pos)
+    {
+        auto it = m_arrayPosCache.find(pos);
+        if(it == m_arrayPosCache.end())
+        {
+            std::unique_ptr<IJson> item;
+            if(m_node->kind == Node::Kind::Tiles)
+            {
+                std::unique_ptr<Node> tile = std::make_unique<Node>(Node::Kind::Value);
+                tile->value = std::to_string(m_node->tiles.at(pos));
+                item = std::unique_ptr<IJson>(new TmxJson(std::move(tile)));
+            }
+            else
+                item = std::unique_ptr<IJson>(new TmxJson(m_node->children.at(pos).get(), m_path));
+            it = m_arrayPosCache.emplace(pos, std::move(item)).first;
+        }
+        return *it->second;
+    }
+
+    std::vector<std::unique_ptr<IJson>> TmxJson::array()
+    {
+        std::vector<std::unique_ptr<IJson>> vec;
+        if(m_node->kind == Node::Kind::Array)
+        {
+            for(const std::unique_ptr<Node> &item : m_node->children)
+                vec.emplace_back(new TmxJson(item.get(), m_path));
+        }
+        else if(m_node->kind == Node::Kind::Tiles)
+        {
+            for(uint32_t tile : m_node->tiles)
+            {
+                std::unique_ptr<Node> node = std::make_unique<Node>(Node::Kind::Value);
+                node->value = std::to_string(tile);
+                vec.emplace_back(new TmxJson(std::move(node)));
+            }
+        }
+        return vec;
+    }
+
+    std::vector<std::unique_ptr<IJson>> &TmxJson::array(std::string_view key)
+    {
+        auto it = m_arrayListDataCache.find(key);
+        if(it == m_arrayListDataCache.end())
+        {
+            it = m_arrayListDataCache.emplace(std::string(key), std::vector<std::unique_ptr<IJson>>()).first;
+            if(value(key) != nullptr)
+                it->second = child(key).array();
+        }
+        return it->second;
+    }
+
+    size_t TmxJson::size() const
+    {
+        if(m_node->kind == Node::Kind::Tiles)
+            return m_node->tiles.size();
+        if(m_node->kind == Node::Kind::Array || m_node->kind == Node::Kind::Object)
+            return m_node->children.size();
+        return 0;
+    }
+
+    bool TmxJson::parse(const fs::path &path)
+    {
+        clearCache();
+        m_root = nullptr;
+        m_node = GetNullNode();
+        if(!fs::exists(path) || !fs::is_regular_file(path))
+            return false;
+
+        std::ifstream file(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if(!parse(content.data(), content.size()))
+            return false;
+
+        m_path = path.parent_path();
+        return true;
+    }
+
+    /*!
+     * Parses a .tmx, .tsx or .tx file in memory. All text is copied, so the data may be freed afterwards.
+     */
+    bool TmxJson::parse(const void *data, size_t size)
+    {
+        clearCache();
+        m_root = std::make_unique<Node>(Node::Kind::Object);
+        m_node = m_root.get();
+
+        XmlReader reader {static_cast<const char *>(data), size};
+        if(!ReadDocument(reader, *m_root))
+        {
+            std::cerr << "TmxJson parse error: Not a valid Tiled map, tileset or template\n";
+            m_root = nullptr;
+            m_node = GetNullNode();
+            return false;
+        }
+        return true;
+    }
+
+    size_t TmxJson::count(std::string_view key) const
+    {
+        return (value(key) != nullptr) ? 1 : 0;
+    }
+
+    bool TmxJson::any(std::string_view key) const
+    {
+        return count(key) > 0;
+    }
+
+    bool TmxJson::isArray() const
+    {
+        return m_node->kind == Node::Kind::Array || m_node->kind == Node::Kind::Tiles;
+    }
+
+    bool TmxJson::isObject() const
+    {
+        return m_node->kind == Node::Kind::Object;
+    }
+
+    bool TmxJson::isNull() const
+    {
+        return m_node->kind == Node::Kind::Null;
+    }
+
+    /*!
+     * Copies decoded tile layer data directly, without creating a json value per gid
+     */
+    bool TmxJson::readArray(std::string_view key, std::vector<uint32_t> &values)
+    {
+        const Node *node = value(key);
+        if(node == nullptr || node->kind != Node::Kind::Tiles)
+            return IJson::readArray(key, values);
+
+        values.insert(values.end(), node->tiles.begin(), node->tiles.end());
+        return true;
+    }
+
+    /*!
+     * Copies the rows of decoded tile layer data that overlap the rectangle
+     */
+    bool TmxJson::readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength, size_t x, size_t y, size_t width, size_t height)
+    {
+        const Node *node = value(key);
+        if(node == nullptr || node->kind != Node::Kind::Tiles)
+            return IJson::readArrayRegion(key, values, rowLength, x, y, width, height);
+
+        const std::vector<uint32_t> &tiles = node->tiles;
+        values.reserve(values.size() + width * height);
+        for(size_t row = y; row < y + height; ++row)
+        {
+            size_t const start = std::min(row * rowLength + x, tiles.size());
+            size_t const end = std::min(start + width, tiles.size());
+            values.insert(values.end(), tiles.begin() + static_cast<std::ptrdiff_t>(start), tiles.begin() + static_cast<std::ptrdiff_t>(end));
+            values.resize(values.size() + width - (end - start), 0);
+        }
+        return true;
+    }
+
+    fs::path TmxJson::directory() const
+    {
+        return m_path;
+    }
+
+    void TmxJson::directory(const fs::path &directory)
+    {
+        m_path = directory;
+    }
+
+    std::unique_ptr<IJson> TmxJson::create()
+    {
+        return std::make_unique<TmxJson>();
+    }
+
+    int32_t TmxJson::getInt32(std::string_view key)
+    {
+        return static_cast<int32_t>(getDouble(key));
+    }
+
+    uint32_t TmxJson::getUInt32(std::string_view key)
+    {
+        return static_cast<uint32_t>(getDouble(key));
+    }
+
+    int64_t TmxJson::getInt64(std::string_view key)
+    {
+        return static_cast<int64_t>(getDouble(key));
+    }
+
+    uint64_t TmxJson::getUInt64(std::string_view key)
+    {
+        return static_cast<uint64_t>(getDouble(key));
+    }
+
+    double TmxJson::getDouble(std::string_view key)
+    {
+        const Node *node = value(key);
+        return (node != nullptr) ? std::strtod(node->value.c_str(), nullptr) : 0.0;
+    }
+
+    float TmxJson::getFloat(std::string_view key)
+    {
+        return static_cast<float>(getDouble(key));
+    }
+
+    std::string TmxJson::getString(std::string_view key)
+    {
+        const Node *node = value(key);
+        return (node != nullptr) ? node->value : std::string();
+    }
+
+    bool TmxJson::getBool(std::string_view key)
+    {
+        const Node *node = value(key);
+        return node != nullptr && (node->value == "1" || node->value == "true");
+    }
+
+    int32_t TmxJson::getInt32()
+    {
+        return static_cast<int32_t>(getDouble());
+    }
+
+    uint32_t TmxJson::getUInt32()
+    {
+        return static_cast<uint32_t>(getDouble());
+    }
+
+    int64_t TmxJson::getInt64()
+    {
+        return static_cast<int64_t>(getDouble());
+    }
+
+    uint64_t TmxJson::getUInt64()
+    {
+        return static_cast<uint64_t>(getDouble());
+    }
+
+    double TmxJson::getDouble()
+    {
+        return std::strtod(m_node->value.c_str(), nullptr);
+    }
+
+    float TmxJson::getFloat()
+    {
+        return static_cast<float>(getDouble());
+    }
+
+    std::string TmxJson::getString()
+    {
+        return m_node->value;
+    }
+
+    bool TmxJson::getBool()
+    {
+        return m_node->value == "1" || m_node->value == "true";
+    }
+
+    IJson &TmxJson::child(std::string_view key)
+    {
+        auto it = m_arrayCache.find(key);
+        if(it == m_arrayCache.end())
+        {
+            const Node *node = value(key);
+            std::unique_ptr<IJson> item {new TmxJson((node != nullptr) ? node : GetNullNode(), m_path)};
+            it = m_arrayCache.emplace(std::string(key), std::move(item)).first;
+        }
+        return *it->second;
+    }
+
+    const TmxJson::Node *TmxJson::value(std::string_view key) const
+    {
+        return (m_node != nullptr && m_node->kind == Node::Kind::Object) ? m_node->find(key) : nullptr;
+    }
+
+    /*!
+     * The value of keys that do not exist
+     */
+    const TmxJson::Node *TmxJson::GetNullNode()
+    {
+        static const Node nullNode;
+        return &nullNode;
+    }
+
+    void TmxJson::clearCache()
+    {
+        m_arrayCache.clear();
+        m_arrayPosCache.clear();
+        m_arrayListDataCache.clear();
+    }
+
+    /*!
+     * Reads the root element: <map>, <tileset> or <template>
+     */
+    bool TmxJson::ReadDocument(XmlReader &reader, Node &root)
+    {
+        if(reader.nextStartElement() != XmlReader::Token::StartElement)
+            return false;
+
+        std::string_view const name = reader.getName();
+        if(name == "map")
+            return ReadMap(reader, root);
+        if(name == "tileset")
+        {
+            root.set("type", "tileset");
+            return ReadTileset(reader, root);
+        }
+        if(name == "template")
+        {
+            root.set("type", "template");
+            return ReadTemplate(reader, root);
+        }
+        return false;
+    }
+
+    bool TmxJson::ReadMap(XmlReader &reader, Node &map)
+    {
+        map.set("type", "map");
+        ReadAttributes(reader, map);
+
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name == "tileset")
+                return ReadTileset(reader, map.getOrAdd("tilesets", Node::Kind::Array).push(Node::Kind::Object));
+            if(name == "layer" || name == "objectgroup" || name == "imagelayer" || name == "group")
+                return ReadLayer(reader, map.getOrAdd("layers", Node::Kind::Array).push(Node::Kind::Object));
+            if(name == "properties")
+                return ReadProperties(reader, map.getOrAdd("properties", Node::Kind::Array));
+            return reader.skipElement();
+        });
+    }
+
+    /*!
+     * Reads a <tileset> of a .tsx file or a map. Tilesets in maps only have 'firstgid' and 'source' when they are external.
+     */
+    bool TmxJson::ReadTileset(XmlReader &reader, Node &tileset)
+    {
+        ReadAttributes(reader, tileset);
+        bool const isExternal = tileset.find("source") != nullptr;
+
+        bool const ok = ReadChildren(reader, [&](std::string_view name)
+        {
+            if(isExternal)
+                return reader.skipElement();
+            if(name == "image")
+                return ReadImage(reader, tileset);
+            if(name == "tileoffset" || name == "grid" || name == "transformations")
+            {
+                ReadAttributes(reader, tileset.add(name, Node::Kind::Object));
+                return reader.skipElement();
+            }
+            if(name == "properties")
+                return ReadProperties(reader, tileset.getOrAdd("properties", Node::Kind::Array));
+            if(name == "tile")
+                return ReadTile(reader, tileset.getOrAdd("tiles", Node::Kind::Array).push(Node::Kind::Object));
+            if(name == "wangsets")
+            {
+                Node &wangsets = tileset.getOrAdd("wangsets", Node::Kind::Array);
+                return ReadChildren(reader, [&](std::string_view wangsetName)
+                {
+                    return (wangsetName == "wangset") ? ReadWangSet(reader, wangsets.push(Node::Kind::Object)) : reader.skipElement();
+                });
+            }
+            if(name == "terraintypes")
+            {
+                Node &terrains = tileset.getOrAdd("terrains", Node::Kind::Array);
+                return ReadChildren(reader, [&](std::string_view terrainName)
+                {
+                    if(terrainName != "terrain")
+                        return reader.skipElement();
+
+                    Node &terrain = terrains.push(Node::Kind::Object);
+                    ReadAttributes(reader, terrain);
+                    return ReadChildren(reader, [&](std::string_view childName)
+                    {
+                        return (childName == "properties") ? ReadProperties(reader, terrain.getOrAdd("properties", Node::Kind::Array)) : reader.skipElement();
+                    });
+                });
+            }
+            return reader.skipElement();
+        });
+
+        if(isExternal)
+            return ok;
+
+        SetDefault(tileset, "margin", "0");
+        SetDefault(tileset, "spacing", "0");
+
+        //Maps older than Tiled 0.15 have no 'columns'
+        if(tileset.find("columns") == nullptr)
+        {
+            int columns = 0;
+            const Node *imageWidth = tileset.find("imagewidth");
+            const Node *tileWidth = tileset.find("tilewidth");
+            if(imageWidth != nullptr && tileWidth != nullptr)
+            {
+                int const margin = std::atoi(tileset.find("margin")->value.c_str());
+                int const spacing = std::atoi(tileset.find("spacing")->value.c_str());
+                int const step = std::atoi(tileWidth->value.c_str()) + spacing;
+                if(step > 0)
+                    columns = (std::atoi(imageWidth->value.c_str()) - margin * 2 + spacing) / step;
+            }
+            tileset.set("columns", std::to_string(columns));
+        }
+
+        return ok;
+    }
+
+    bool TmxJson::ReadTemplate(XmlReader &reader, Node &templ)
+    {
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name == "tileset")
+            {
+                ReadAttributes(reader, templ.add("tileset", Node::Kind::Object));
+                return reader.skipElement();
+            }
+            if(name == "object")
+                return ReadObject(reader, templ.add("object", Node::Kind::Object));
+            return reader.skipElement();
+        });
+    }
+
+    bool TmxJson::ReadTile(XmlReader &reader, Node &tile)
+    {
+        for(const auto &[name, text] : reader.getAttributes())
+        {
+            if(name != "terrain")
+            {
+                tile.set(name, XmlReader::Unescape(text));
+                continue;
+            }
+
+            //Corners without a terrain are empty
+            Node &terrain = tile.add("terrain", Node::Kind::Array);
+            size_t start = 0;
+            while(start <= text.size())
+            {
+                size_t end = text.find(',', start);
+                if(end == std::string_view::npos)
+                    end = text.size();
+                std::string_view const corner = text.substr(start, end - start);
+                terrain.push(Node::Kind::Value).value = (corner.empty()) ? "-1" : std::string(corner);
+                start = end + 1;
+            }
+        }
+
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name == "image")
+                return ReadImage(reader, tile);
+            if(name == "properties")
+                return ReadProperties(reader, tile.getOrAdd("properties", Node::Kind::Array));
+            if(name == "objectgroup")
+                return ReadLayer(reader, tile.add("objectgroup", Node::Kind::Object));
+            if(name == "animation")
+            {
+                Node &animation = tile.add("animation", Node::Kind::Array);
+                return ReadChildren(reader, [&](std::string_view frameName)
+                {
+                    if(frameName == "frame")
+                        ReadAttributes(reader, animation.push(Node::Kind::Object));
+                    return reader.skipElement();
+                });
+            }
+            return reader.skipElement();
+        });
+    }
+
+    /*!
+     * Reads a <wangset>. Both the colors of Tiled 1.5 (<wangcolor>) and the older edge and corner colors are read.
+     */
+    bool TmxJson::ReadWangSet(XmlReader &reader, Node &wangset)
+    {
+        ReadAttributes(reader, wangset);
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name == "properties")
+                return ReadProperties(reader, wangset.getOrAdd("properties", Node::Kind::Array));
+            if(name == "wangcolor" || name == "wangedgecolor" || name == "wangcornercolor")
+            {
+                std::string_view const key = (name == "wangcolor") ? "colors" : (name == "wangedgecolor") ? "edgecolors" : "cornercolors";
+                Node &color = wangset.getOrAdd(key, Node::Kind::Array).push(Node::Kind::Object);
+                ReadAttributes(reader, color);
+                SetDefault(color, "probability", "1");
+                return ReadChildren(reader, [&](std::string_view childName)
+                {
+                    return (childName == "properties") ? ReadProperties(reader, color.getOrAdd("properties", Node::Kind::Array)) : reader.skipElement();
+                });
+            }
+            if(name == "wangtile")
+            {
+                Node &wangtile = wangset.getOrAdd("wangtiles", Node::Kind::Array).push(Node::Kind::Object);
+                for(const auto &[attributeName, text] : reader.getAttributes())
+                {
+                    if(attributeName == "wangid")
+                        ReadWangId(text, wangtile.add("wangid", Node::Kind::Array));
+                    else
+                        wangtile.set(attributeName, text);
+                }
+                return reader.skipElement();
+            }
+            return reader.skipElement();
+        });
+    }
+
+    /*!
+     * Reads a <layer>, <objectgroup>, <imagelayer> or <group>
+     */
+    bool TmxJson::ReadLayer(XmlReader &reader, Node &layer)
+    {
+        std::string_view const name = reader.getName();
+        if(name == "layer")
+            layer.set("type", "tilelayer");
+        else
+            layer.set("type", name);
+        ReadAttributes(reader, layer);
+
+        SetDefault(layer, "name", "");
+        SetDefault(layer, "opacity", "1");
+        SetDefault(layer, "visible", "1");
+        SetDefault(layer, "x", "0");
+        SetDefault(layer, "y", "0");
+        if(name == "objectgroup")
+            SetDefault(layer, "draworder", "topdown");
+
+        return ReadChildren(reader, [&](std::string_view childName)
+        {
+            if(childName == "properties")
+                return ReadProperties(reader, layer.getOrAdd("properties", Node::Kind::Array));
+            if(childName == "data")
+                return ReadData(reader, layer);
+            if(childName == "object")
+                return ReadObject(reader, layer.getOrAdd("objects", Node::Kind::Array).push(Node::Kind::Object));
+            if(childName == "image")
+                return ReadImage(reader, layer);
+            if(childName == "layer" || childName == "objectgroup" || childName == "imagelayer" || childName == "group")
+                return ReadLayer(reader, layer.getOrAdd("layers", Node::Kind::Array).push(Node::Kind::Object));
+            return reader.skipElement();
+        });
+    }
+
+    /*!
+     * Reads the <data> of a tile layer into 'data', or into 'chunks' for infinite maps
+     */
+    bool TmxJson::ReadData(XmlReader &reader, Node &layer)
+    {
+        std::string const encoding {reader.getAttribute("encoding")};
+        std::string const compression {reader.getAttribute("compression")};
+        if(encoding == "base64")
+            layer.set("encoding", encoding);
+        if(!compression.empty())
+            layer.set("compression", compression);
+
+        Node &data = layer.add("data", Node::Kind::Tiles);
+        size_t const depth = reader.getDepth();
+        while(true)
+        {
+            XmlReader::Token const token = reader.next();
+            if(token == XmlReader::Token::EndElement && reader.getDepth() < depth)
+                return true;
+            if(token == XmlReader::Token::Error || token == XmlReader::Token::EndOfDocument)
+                return false;
+
+            if(token == XmlReader::Token::Text)
+            {
+                if(!DecodeTiles(reader.getText(), encoding, compression, data.tiles))
+                    return false;
+            }
+            else if(token == XmlReader::Token::StartElement && reader.getName() == "tile")
+            {
+                //Tiled before 0.9 wrote one element per tile
+                data.tiles.push_back(static_cast<uint32_t>(std::strtoul(std::string(reader.getAttribute("gid")).c_str(), nullptr, 10)));
+                if(!reader.skipElement())
+                    return false;
+            }
+            else if(token == XmlReader::Token::StartElement && reader.getName() == "chunk")
+            {
+                Node &chunk = layer.getOrAdd("chunks", Node::Kind::Array).push(Node::Kind::Object);
+                ReadAttributes(reader, chunk);
+                Node &chunkData = chunk.add("data", Node::Kind::Tiles);
+                if(!DecodeTiles(reader.readText(), encoding, compression, chunkData.tiles))
+                    return false;
+            }
+            else if(token == XmlReader::Token::StartElement && !reader.skipElement())
+                return false;
+        }
+    }
+
+    bool TmxJson::ReadObject(XmlReader &reader, Node &object)
+    {
+        ReadAttributes(reader, object);
+
+        //Instances of templates only have the fields that differ from the template
+        if(object.find("template") == nullptr)
+        {
+            SetDefault(object, "name", "");
+            SetDefault(object, "rotation", "0");
+            SetDefault(object, "visible", "1");
+            if(object.find("class") == nullptr)
+                SetDefault(object, "type", "");
+            if(object.find("x") != nullptr || object.find("y") != nullptr)
+            {
+                SetDefault(object, "x", "0");
+                SetDefault(object, "y", "0");
+                SetDefault(object, "width", "0");
+                SetDefault(object, "height", "0");
+            }
+        }
+
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name == "properties")
+                return ReadProperties(reader, object.getOrAdd("properties", Node::Kind::Array));
+            if(name == "ellipse" || name == "point")
+            {
+                object.set(name, "true");
+                return reader.skipElement();
+            }
+            if(name == "polygon" || name == "polyline")
+            {
+                ReadPoints(reader.getAttribute("points"), object.add(name, Node::Kind::Array));
+                return reader.skipElement();
+            }
+            if(name == "text")
+                return ReadText(reader, object.add("text", Node::Kind::Object));
+            return reader.skipElement();
+        });
+    }
+
+    bool TmxJson::ReadText(XmlReader &reader, Node &text)
+    {
+        ReadAttributes(reader, text);
+        std::string_view const content = reader.readText();
+        if(reader.getToken() != XmlReader::Token::EndElement)
+            return false;
+        text.set("text", XmlReader::Unescape(content));
+        return true;
+    }
+
+    /*!
+     * Reads <properties> into an array of properties
+     */
+    bool TmxJson::ReadProperties(XmlReader &reader, Node &properties)
+    {
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name != "property")
+                return reader.skipElement();
+
+            Node &property = properties.push(Node::Kind::Object);
+            ReadAttributes(reader, property);
+            SetDefault(property, "type", "string");
+            if(property.find("value") != nullptr)
+                return reader.skipElement();
+
+            if(property.find("type")->value == "class")
+            {
+                Node &members = property.add("value", Node::Kind::Object);
+                return ReadChildren(reader, [&](std::string_view childName)
+                {
+                    return (childName == "properties") ? ReadClassMembers(reader, members) : reader.skipElement();
+                });
+            }
+
+            //Strings with several lines are stored as the text of the property
+            std::string_view const text = reader.readText();
+            if(reader.getToken() != XmlReader::Token::EndElement)
+                return false;
+            property.set("value", XmlReader::Unescape(text));
+            return true;
+        });
+    }
+
+    /*!
+     * Reads the <properties> of a class property into an object with the values of its members
+     */
+    bool TmxJson::ReadClassMembers(XmlReader &reader, Node &members)
+    {
+        return ReadChildren(reader, [&](std::string_view name)
+        {
+            if(name != "property")
+                return reader.skipElement();
+
+            std::string const memberName = XmlReader::Unescape(reader.getAttribute("name"));
+            if(reader.getAttribute("type") == "class")
+            {
+                Node &member = members.add(memberName, Node::Kind::Object);
+                return ReadChildren(reader, [&](std::string_view childName)
+                {
+                    return (childName == "properties") ? ReadClassMembers(reader, member) : reader.skipElement();
+                });
+            }
+
+            if(reader.hasAttribute("value"))
+            {
+                members.set(memberName, XmlReader::Unescape(reader.getAttribute("value")));
+                return reader.skipElement();
+            }
+            std::string_view const text = reader.readText();
+            members.set(memberName, XmlReader::Unescape(text));
+            return reader.getToken() == XmlReader::Token::EndElement;
+        });
+    }
+
+    /*!
+     * Reads an <image> into the fields its owner has in json
+     */
+    bool TmxJson::ReadImage(XmlReader &reader, Node &node)
+    {
+        for(const auto &[name, text] : reader.getAttributes())
+        {
+            if(name == "source")
+                node.set("image", XmlReader::Unescape(text));
+            else if(name == "width")
+                node.set("imagewidth", text);
+            else if(name == "height")
+                node.set("imageheight", text);
+            else if(name == "trans")
+                node.set("transparentcolor", (!text.empty() && text[0] == '#') ? std::string(text) : "#" + std::string(text));
+        }
+        return reader.skipElement();
+    }
+
+    /*!
+     * Calls readChild for each child element of the current element, with the reader at the start of the child.
+     * readChild must read the whole child, or skip it. Text is skipped.
+     * @return false if readChild returns false, or the data is not well-formed
+     */
+    bool TmxJson::ReadChildren(XmlReader &reader, const std::function<bool(std::string_view)> &readChild)
+    {
+        while(true)
+        {
+            XmlReader::Token const token = reader.nextStartElement();
+            if(token == XmlReader::Token::EndElement)
+                return true;
+            if(token != XmlReader::Token::StartElement || !readChild(reader.getName()))
+                return false;
+        }
+    }
+
+    void TmxJson::ReadAttributes(const XmlReader &reader, Node &node)
+    {
+        for(const auto &[name, text] : reader.getAttributes())
+        {
+            if(text.find('&') != std::string_view::npos)
+                node.set(name, XmlReader::Unescape(text));
+            else
+                node.set(name, text);
+        }
+    }
+
+    void TmxJson::SetDefault(Node &node, std::string_view key, std::string_view text)
+    {
+        if(node.find(key) == nullptr)
+            node.set(key, text);
+    }
+
+    /*!
+     * Reads the points of a polygon or polyline ("x,y x,y ...") as an array of {x, y}
+     */
+    void TmxJson::ReadPoints(std::string_view points, Node &array)
+    {
+        size_t start = 0;
+        while(start < points.size())
+        {
+            size_t end = points.find(' ', start);
+            if(end == std::string_view::npos)
+                end = points.size();
+
+            std::string_view const point = points.substr(start, end - start);
+            size_t const comma = point.find(',');
+            if(comma != std::string_view::npos)
+            {
+                Node &item = array.push(Node::Kind::Object);
+                item.set("x", point.substr(0, comma));
+                item.set("y", point.substr(comma + 1));
+            }
+            start = end + 1;
+        }
+    }
+
+    /*!
+     * Reads the 'wangid' of a wang tile. Tiled 1.5 writes eight comma-separated colors, starting at the top edge and going clockwise.
+     * Older versions write the same eight colors as the nibbles of a hexadecimal number, starting with the lowest.
+     */
+    void TmxJson::ReadWangId(std::string_view wangid, Node &array)
+    {
+        if(wangid.size() > 2 && wangid[0] == '0' && (wangid[1] == 'x' || wangid[1] == 'X'))
+        {
+            uint32_t const value = static_cast<uint32_t>(std::strtoul(std::string(wangid.substr(2)).c_str(), nullptr, 16));
+            for(int i = 0; i < 8; ++i)
+                array.push(Node::Kind::Value).value = std::to_string((value >> (i * 4)) & 0xFu);
+            return;
+        }
+
+        size_t start = 0;
+        while(start <= wangid.size())
+        {
+            size_t end = wangid.find(',', start);
+            if(end == std::string_view::npos)
+                end = wangid.size();
+            array.push(Node::Kind::Value).value = std::string(wangid.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    /*!
+     * Decodes the text of a <data> or <chunk> into gids
+     * @return false if the encoding or compression is unsupported, or the data is invalid
+     */
+    bool TmxJson::DecodeTiles(std::string_view text, std::string_view encoding, std::string_view compression, std::vector<uint32_t> &tiles)
+    {
+        if(encoding == "csv")
+        {
+            uint32_t value = 0;
+            bool hasDigits = false;
+            for(char const c : text)
+            {
+                if(c >= '0' && c <= '9')
+                {
+                    value = value * 10 + static_cast<uint32_t>(c - '0');
+                    hasDigits = true;
+                }
+                else if(c == ',')
+                {
+                    tiles.push_back(value);
+                    value = 0;
+                    hasDigits = false;
+                }
+            }
+            if(hasDigits)
+                tiles.push_back(value);
+            return true;
+        }
+
+        if(encoding != "base64")
+            return text.find_first_not_of(" \t\r\n") == std::string_view::npos; //<tile> elements are separated by whitespace
+
+        static constexpr uint8_t Invalid = 0xFF;
+        static const auto Table = []()
+        {
+            std::array<uint8_t, 256> table {};
+            table.fill(Invalid);
+            const char *const chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for(uint8_t i = 0; i < 64; ++i)
+                table[static_cast<uint8_t>(chars[i])] = i;
+            return table;
+        }();
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(text.size() / 4 * 3);
+        uint32_t buffer = 0;
+        int bits = 0;
+        for(char const c : text)
+        {
+            uint8_t const sextet = Table[static_cast<uint8_t>(c)];
+            if(sextet == Invalid)
+                continue; //Whitespace and padding
+            buffer = (buffer << 6) | sextet;
+            bits += 6;
+            if(bits >= 8)
+            {
+                bits -= 8;
+                bytes.push_back(static_cast<uint8_t>(buffer >> bits));
+            }
+        }
+
+        if(!compression.empty())
+        {
+            std::vector<uint8_t> decompressed;
+            decompressed.reserve(bytes.size() * 4);
+            bool ok = false;
+            if(compression == "zlib")
+                ok = Inflate::Zlib(bytes.data(), bytes.size(), decompressed);
+            else if(compression == "gzip")
+                ok = Inflate::Gzip(bytes.data(), bytes.size(), decompressed);
+            if(!ok)
+                return false;
+            bytes = std::move(decompressed);
+        }
+
+        size_t const count = bytes.size() / 4;
+        tiles.reserve(tiles.size() + count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            const uint8_t *tile = bytes.data() + i * 4;
+            tiles.push_back(static_cast<uint32_t>(tile[0]) | (static_cast<uint32_t>(tile[1]) << 8) |
+                            (static_cast<uint32_t>(tile[2]) << 16) | (static_cast<uint32_t>(tile[3]) << 24));
+        }
+        return true;
+    }
+}
+
+#endif //TILESON_TMXJSON_HPP
@@ -0,0 +1,255 @@
+#ifndef TILESON_ANIMATIONCLOCK_HPP
+#define TILESON_ANIMATIONCLOCK_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace tson
+{
+    /*!
+     * Keeps track of all the tile animations of a map, without touching the tson::Animation of each tson::Tile.
+     *
+     * Every animated tile of every tileset is collected once, and the state of all animations is kept in flat arrays,
+     * so update() advances everything in one pass. The result is a table with the gid to draw for each gid,
+     * which renderers can index directly:
+     *
+     * tson::AnimationClock &clock = map->getAnimationClock();
+     * clock.update(deltaMs);
+     * uint32_t gidToDraw = clock.getCurrentGid(cell.gid);
+     *
+     * All animations share the same clock, which starts at 0 when the map is loaded. getGidAt() gives the gid for any point in time
+     * without changing the state of the clock, so it can be used from multiple threads at once.
+     */
+    class AnimationClock
+    {
+        public:
+            inline AnimationClock() = default;
+
+            inline void build(std::vector<tson::Tileset> &tilesets);
+            inline void update(float timeDeltaMs);
+            inline void reset();
+
+            [[nodiscard]] inline double getTime() const;
+            [[nodiscard]] inline const std::vector<uint32_t> &getCurrentGids() const;
+            [[nodiscard]] inline uint32_t getCurrentGid(uint32_t gid) const;
+            [[nodiscard]] inline uint32_t getGidAt(uint32_t gid, double timeMs) const;
+            [[nodiscard]] inline bool isAnimated(uint32_t gid) const;
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline bool empty() const;
+
+        private:
+            static constexpr uint32_t FLIP_FLAGS = FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG;
+            inline uint32_t frameAt(size_t animation, double timeMs) const;
+            inline static uint32_t findFrame(const uint32_t *frameEnds, uint32_t frameCount, double loopTimeMs);
+
+            double                  m_time {};              /*! Time since build() or reset() in milliseconds */
+            std::vector<uint32_t>   m_currentGids;          /*! index: gid without flip flags. Value: gid of the current frame */
+            std::vector<int32_t>    m_animationIndices;     /*! index: gid without flip flags. Value: index of the animation, or -1 */
+
+            //One element per animation
+            std::vector<uint32_t>   m_animatedGids;         /*! The gid of the animated tile */
+            std::vector<uint32_t>   m_firstFrames;          /*! Index of the first frame in m_frameGids and m_frameEnds */
+            std::vector<uint32_t>   m_frameCounts;
+            std::vector<uint32_t>   m_totalDurations;       /*! Sum of all frame durations in milliseconds */
+            std::vector<uint32_t>   m_currentFrames;        /*! Current frame, relative to the first frame */
+            std::vector<float>      m_loopTimes;            /*! Time since the start of the current loop in milliseconds */
+
+            //One element per frame of every animation
+            std::vector<uint32_t>   m_frameGids;
+            std::vector<uint32_t>   m_frameEnds;            /*! Prefix sum of the frame durations of each animation */
+    };
+
+    /*!
+     * Collects the animations of all tiles in the tilesets, and sets the clock to 0.
+     * @param tilesets The tilesets of a map
+     */
+    void AnimationClock::build(std::vector<tson::Tileset> &tilesets)
+    {
+        m_animatedGids.clear();
+        m_firstFrames.clear();
+        m_frameCounts.clear();
+        m_totalDurations.clear();
+        m_frameGids.clear();
+        m_frameEnds.clear();
+
+        uint32_t maxGid = 0;
+        for(auto &tileset : tilesets)
+        {
+            if(tileset.getTileCount() > 0)
+                maxGid = std::max(maxGid, static_cast<uint32_t>(tileset.getFirstgid() + tileset.getTileCount() - 1));
+
+            for(auto &tile : tileset.getTiles())
+            {
+                maxGid = std::max(maxGid, tile.getGid());
+                if(!tile.getAnimation().any())
+                    continue;
+
+                uint32_t total = 0;
+                m_firstFrames.push_back(static_cast<uint32_t>(m_frameGids.size()));
+                for(const auto &frame : tile.getAnimation().getFrames())
+                {
+                    //The tile id of a frame is the local id + 1
+                    m_frameGids.push_back(static_cast<uint32_t>(tileset.getFirstgid()) + frame.getTileId() - 1);
+                    total += static_cast<uint32_t>(std::max(frame.getDuration(), 0));
+                    m_frameEnds.push_back(total);
+                }
+                m_animatedGids.push_back(tile.getGid());
+                m_frameCounts.push_back(static_cast<uint32_t>(tile.getAnimation().size()));
+                m_totalDurations.push_back(total);
+            }
+        }
+
+        m_animationIndices.assign(m_animatedGids.empty() ? 0 : static_cast<size_t>(maxGid) + 1, -1);
+        for(size_t i = 0; i < m_animatedGids.size(); ++i)
+            m_animationIndices[m_animatedGids[i]] = static_cast<int32_t>(i);
+
+        reset();
+    }
+
+    /*!
+     * Advances all animations. Large time deltas skip as many frames as needed.
+     * @param timeDeltaMs Time in milliseconds since the last update
+     */
+    void AnimationClock::update(float timeDeltaMs)
+    {
+        if(timeDeltaMs <= 0.f)
+            return;
+
+        m_time += timeDeltaMs;
+        size_t const count = m_animatedGids.size();
+        for(size_t i = 0; i < count; ++i)
+        {
+            uint32_t const total = m_totalDurations[i];
+            if(total == 0)
+                continue;
+
+            //Whole loops of the animation end up at the same frame, so only the remainder matters
+            float time = m_loopTimes[i] + timeDeltaMs;
+            if(time >= static_cast<float>(total))
+                time = std::fmod(time, static_cast<float>(total));
+            m_loopTimes[i] = time;
+
+            //Most updates stay within the current frame. Otherwise: binary search in the prefix sum
+            const uint32_t *ends = m_frameEnds.data() + m_firstFrames[i];
+            uint32_t frame = m_currentFrames[i];
+            if(time >= static_cast<float>(ends[frame]) || (frame > 0 && time < static_cast<float>(ends[frame - 1])))
+                frame = findFrame(ends, m_frameCounts[i], time);
+
+            m_currentFrames[i] = frame;
+            m_currentGids[m_animatedGids[i]] = m_frameGids[m_firstFrames[i] + frame];
+        }
+    }
+
+    /*!
+     * Sets the clock back to 0, which is the first frame of every animation.
+     */
+    void AnimationClock::reset()
+    {
+        m_time = 0.0;
+        m_currentGids.resize(m_animationIndices.size());
+        for(size_t gid = 0; gid < m_currentGids.size(); ++gid)
+            m_currentGids[gid] = static_cast<uint32_t>(gid);
+
+        m_currentFrames.assign(m_animatedGids.size(), 0);
+        m_loopTimes.assign(m_animatedGids.size(), 0.f);
+        for(size_t i = 0; i < m_animatedGids.size(); ++i)
+        {
+            if(m_frameCounts[i] > 0)
+                m_currentGids[m_animatedGids[i]] = m_frameGids[m_firstFrames[i]];
+        }
+    }
+
+    /*!
+     * Time since the animations started, in milliseconds
+     */
+    double AnimationClock::getTime() const
+    {
+        return m_time;
+    }
+
+    /*!
+     * A table with the gid to draw for every gid, where the index is a gid without flip flags.
+     * Gids that are not animated point to themselves. Gids outside the table are not animated.
+     * @return The table of current gids
+     */
+    const std::vector<uint32_t> &AnimationClock::getCurrentGids() const
+    {
+        return m_currentGids;
+    }
+
+    /*!
+     * Gets the gid to draw right now for a gid.
+     * @param gid Gid with or without flip flags
+     * @return The gid of the current frame, with the flip flags of the input. The input itself if the gid is not animated.
+     */
+    uint32_t AnimationClock::getCurrentGid(uint32_t gid) const
+    {
+        uint32_t const id = gid & ~FLIP_FLAGS;
+        return (id < m_currentGids.size()) ? (m_currentGids[id] | (gid & FLIP_FLAGS)) : gid;
+    }
+
+    /*!
+     * Gets the gid to draw at any point in time, where 0 is the first frame of all animations.
+     * Does not change the clock, and is safe to call from multiple threads.
+     * @param gid Gid with or without flip flags
+     * @param timeMs Time in milliseconds
+     * @return The gid of the frame at the given time, with the flip flags of the input. The input itself if the gid is not animated.
+     */
+    uint32_t AnimationClock::getGidAt(uint32_t gid, double timeMs) const
+    {
+        uint32_t const id = gid & ~FLIP_FLAGS;
+        if(id >= m_animationIndices.size() || m_animationIndices[id] < 0)
+            return gid;
+
+        auto const animation = static_cast<size_t>(m_animationIndices[id]);
+        if(m_frameCounts[animation] == 0)
+            return gid;
+
+        return m_frameGids[m_firstFrames[animation] + frameAt(animation, timeMs)] | (gid & FLIP_FLAGS);
+    }
+
+    /*!
+     * true if the gid has an animation
+     */
+    bool AnimationClock::isAnimated(uint32_t gid) const
+    {
+        uint32_t const id = gid & ~FLIP_FLAGS;
+        return id < m_animationIndices.size() && m_animationIndices[id] >= 0;
+    }
+
+    /*!
+     * Number of animations
+     */
+    size_t AnimationClock::size() const
+    {
+        return m_animatedGids.size();
+    }
+
+    bool AnimationClock::empty() const
+    {
+        return m_animatedGids.empty();
+    }
+
+    uint32_t AnimationClock::frameAt(size_t animation, double timeMs) const
+    {
+        uint32_t const total = m_totalDurations[animation];
+        if(total == 0 || timeMs <= 0.0)
+            return 0;
+
+        return findFrame(m_frameEnds.data() + m_firstFrames[animation], m_frameCounts[animation], std::fmod(timeMs, static_cast<double>(total)));
+    }
+
+    /*!
+     * The first frame ending after the given time, found by binary search in the prefix sum of the frame durations.
+     */
+    uint32_t AnimationClock::findFrame(const uint32_t *frameEnds, uint32_t frameCount, double loopTimeMs)
+    {
+        const uint32_t *end = frameEnds + frameCount;
+        const uint32_t *frame = std::upper_bound(frameEnds, end, loopTimeMs, [](double time, uint32_t frameEnd) { return time < static_cast<double>(frameEnd); });
+        return (frame == end) ? 0 : static_cast<uint32_t>(frame - frameEnds);
+    }
+}
+
+#endif //TILESON_ANIMATIONCLOCK_HPP
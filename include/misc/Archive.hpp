@@ -0,0 +1,561 @@
+#ifndef TILESON_ARCHIVE_HPP
+#define TILESON_ARCHIVE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tson
+{
+    /*!
+     * Compresses the content of one archive entry. Returns an empty vector if it could not be compressed.
+     */
+    using ArchiveCompressor = std::function<std::vector<uint8_t>(const std::vector<uint8_t> &input)>;
+
+    /*!
+     * A packed archive (.tsonpak) of Tiled files: maps, tilesets, templates, worlds and projects, read without opening each file.
+     *
+     * The archive has a central index of paths, sorted so a path is found with a binary search, pointing to blobs of content.
+     * Files with the same content, like a tileset or a template copied to several folders, share one blob. Each blob is compressed
+     * on its own, so any file is read without decompressing the others.
+     *
+     * tson::Tileson, tson::World and tson::Project load files from the archive. Linked files (external tilesets and templates)
+     * are read from the archive through the tson::LinkedFileParser of the map, relative to the map.
+     *
+     * Every const function is thread safe, so one archive can be read by many threads at once. Decompressors must be added before
+     * the archive is shared, and must be safe to call from several threads (tson::Lzma is).
+     *
+     * Example:
+     * tson::Archive archive {"maps.tsonpak"};
+     * tson::Tileson t;
+     * std::unique_ptr<tson::Map> map = t.parse(archive, "maps/level1.json");
+     */
+    class Archive
+    {
+        public:
+            static constexpr char Magic[8] {'T', 'S', 'O', 'N', 'P', 'A', 'K', '\0'};
+            static constexpr uint32_t Version = 1;
+
+            class Header
+            {
+                public:
+                    char            magic[8];
+                    uint32_t        version;
+                    uint32_t        byteOrder;      /*! FlatMap::ByteOrderMark, as written by the host */
+                    uint32_t        size;           /*! Size of the archive */
+                    FlatMap::Table  entries;        /*! EntryRecords, sorted by path */
+                    FlatMap::Table  blobs;          /*! BlobRecords */
+                    uint32_t        strings;        /*! Offset of the string section */
+                    uint32_t        stringsSize;
+            };
+
+            class EntryRecord
+            {
+                public:
+                    FlatMap::String path;           /*! Normalized path, see NormalizePath() */
+                    uint32_t        blob;           /*! Index of the BlobRecord with the content */
+            };
+
+            class BlobRecord
+            {
+                public:
+                    uint32_t        offset;
+                    uint32_t        size;           /*! Stored size */
+                    uint32_t        originalSize;   /*! Size of the content, when decompressed */
+                    FlatMap::String compression;    /*! Name of the decompressor. Empty when the content is stored as is. */
+                    uint32_t        hashLow;        /*! FNV-1a hash of the content */
+                    uint32_t        hashHigh;
+            };
+
+            inline Archive() = default;
+            inline explicit Archive(const fs::path &path);
+
+            inline bool open(const fs::path &path);
+            inline bool open(const void *data, size_t size);
+            inline void addDecompressor(std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor);
+
+            [[nodiscard]] inline bool isOpen() const;
+            [[nodiscard]] inline bool contains(const fs::path &path) const;
+            inline bool read(const fs::path &path, std::vector<uint8_t> &out) const;
+            [[nodiscard]] inline std::vector<std::string> getPaths() const;
+            [[nodiscard]] inline std::vector<std::string> getFileNames(const fs::path &folder) const;
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline size_t getBlobCount() const;
+            [[nodiscard]] inline tson::LinkedFileParser createLinkedFileParser(IJson &json, const fs::path &path) const;
+
+            inline static std::string NormalizePath(const fs::path &path);
+
+        private:
+            [[nodiscard]] inline bool find(const std::string &path, EntryRecord &entry) const;
+
+            tson::MappedFile                m_file;
+            FlatMap::Data                   m_data;
+            Header                          m_header {};
+            bool                            m_isOpen {false};
+            std::vector<std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>>> m_decompressors;
+    };
+
+    /*!
+     * Builds a tson::Archive. Files are added with their path in the archive, and written when the archive is saved.
+     *
+     * Example:
+     * tson::ArchiveWriter writer;
+     * writer.addDirectory("content");
+     * writer.save("content.tsonpak");
+     */
+    class ArchiveWriter
+    {
+        public:
+            inline ArchiveWriter() = default;
+
+            inline void add(const fs::path &archivePath, std::vector<uint8_t> content);
+            inline bool addFile(const fs::path &file, const fs::path &archivePath);
+            inline size_t addDirectory(const fs::path &folder, const std::vector<std::string> &extensions = {".json", ".tmj", ".tsj", ".tj", ".world", ".tiled-project"});
+            inline void setCompressor(std::string name, tson::ArchiveCompressor compressor);
+
+            [[nodiscard]] inline std::vector<uint8_t> serialize() const;
+            [[nodiscard]] inline bool save(const fs::path &path) const;
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline size_t getBlobCount() const;
+
+        private:
+            class Blob
+            {
+                public:
+                    std::vector<uint8_t>    content;
+                    uint64_t                hash;
+            };
+
+            std::map<std::string, size_t>               m_entries;      /*! Normalized path -> index in m_blobs. Sorted like the index of the archive */
+            std::vector<Blob>                           m_blobs;
+            std::unordered_multimap<uint64_t, size_t>   m_blobsByHash;  /*! Content hash -> index in m_blobs */
+            std::string                                 m_compressorName;
+            tson::ArchiveCompressor                     m_compressor;
+    };
+
+    static_assert(sizeof(Archive::Header) == 44 && sizeof(Archive::BlobRecord) % 4 == 0, "Archive records must not be padded");
+
+    Archive::Archive(const fs::path &path)
+    {
+        open(path);
+    }
+
+    /*!
+     * Maps an archive file
+     * @return false if the file could not be opened, or is not an archive
+     */
+    bool Archive::open(const fs::path &path)
+    {
+        m_isOpen = false;
+        if(!m_file.open(path))
+            return false;
+        return open(m_file.data(), m_file.size());
+    }
+
+    /*!
+     * Opens an archive in memory. The memory is not copied, and must outlive the archive.
+     * @return false if the data is not an archive of this version and byte order
+     */
+    bool Archive::open(const void *data, size_t size)
+    {
+        m_isOpen = false;
+        if(data == nullptr || size < sizeof(Header))
+            return false;
+
+        std::memcpy(&m_header, data, sizeof(Header));
+        if(std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0 || m_header.version != Version || m_header.byteOrder != FlatMap::ByteOrderMark ||
+           m_header.size > size || m_header.strings > m_header.size || m_header.stringsSize > m_header.size - m_header.strings)
+            return false;
+
+        m_data = FlatMap::Data(static_cast<const uint8_t *>(data), m_header.size, m_header.strings, m_header.stringsSize);
+        m_isOpen = m_data.count<EntryRecord>(m_header.entries) == m_header.entries.count &&
+                   m_data.count<BlobRecord>(m_header.blobs) == m_header.blobs.count;
+        return m_isOpen;
+    }
+
+    /*!
+     * Adds a decompressor for compressed entries. Entries are decompressed with the decompressor of the same name().
+     * Not thread safe: Add every decompressor before reading from several threads.
+     */
+    void Archive::addDecompressor(std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor)
+    {
+        m_decompressors.push_back(std::move(decompressor));
+    }
+
+    bool Archive::isOpen() const
+    {
+        return m_isOpen;
+    }
+
+    bool Archive::contains(const fs::path &path) const
+    {
+        EntryRecord entry {};
+        return find(NormalizePath(path), entry);
+    }
+
+    /*!
+     * Reads the content of a file in the archive
+     * @param path Path of the file in the archive. "a/../b.json" and "./b.json" are the same as "b.json".
+     * @param out The content
+     * @return false if the file is not in the archive, or could not be decompressed
+     */
+    bool Archive::read(const fs::path &path, std::vector<uint8_t> &out) const
+    {
+        out.clear();
+        EntryRecord entry {};
+        if(!find(NormalizePath(path), entry) || entry.blob >= m_header.blobs.count)
+            return false;
+
+        auto const blob = m_data.record<BlobRecord>(m_header.blobs, entry.blob);
+        if(blob.offset > m_header.size || blob.size > m_header.size - blob.offset)
+            return false;
+
+        const uint8_t *content = m_data.data() + blob.offset;
+        std::string_view const compression = m_data.string(blob.compression);
+        if(compression.empty())
+        {
+            out.assign(content, content + blob.size);
+            return true;
+        }
+
+        for(const auto &decompressor : m_decompressors)
+        {
+            if(decompressor->name() == compression)
+            {
+                out = decompressor->decompress(content, blob.size);
+                return out.size() == blob.originalSize;
+            }
+        }
+        return false;
+    }
+
+    /*!
+     * The paths of every file in the archive, sorted
+     */
+    std::vector<std::string> Archive::getPaths() const
+    {
+        std::vector<std::string> paths;
+        paths.reserve(m_header.entries.count);
+        for(size_t i = 0; i < size(); ++i)
+            paths.emplace_back(m_data.string(m_data.record<EntryRecord>(m_header.entries, i).path));
+        return paths;
+    }
+
+    /*!
+     * The names of the files directly in a folder of the archive, sorted. Like listing a folder on disk.
+     */
+    std::vector<std::string> Archive::getFileNames(const fs::path &folder) const
+    {
+        std::string prefix = NormalizePath(folder);
+        if(!prefix.empty())
+            prefix += '/';
+
+        std::vector<std::string> fileNames;
+        for(size_t i = 0; i < size(); ++i)
+        {
+            std::string_view const path = m_data.string(m_data.record<EntryRecord>(m_header.entries, i).path);
+            if(path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0 && path.find('/', prefix.size()) == std::string_view::npos)
+                fileNames.emplace_back(path.substr(prefix.size()));
+        }
+        return fileNames;
+    }
+
+    /*!
+     * Number of files in the archive
+     */
+    size_t Archive::size() const
+    {
+        return (m_isOpen) ? m_header.entries.count : 0;
+    }
+
+    /*!
+     * Number of distinct contents in the archive. Less than size() when files share their content.
+     */
+    size_t Archive::getBlobCount() const
+    {
+        return (m_isOpen) ? m_header.blobs.count : 0;
+    }
+
+    /*!
+     * Creates a tson::LinkedFileParser that reads the files linked by a file of the archive, relative to it.
+     * The archive must outlive the parser.
+     * @param json Used to create the json parsers of the linked files. Must outlive the parser.
+     * @param path Path of the file in the archive that links to the other files
+     */
+    tson::LinkedFileParser Archive::createLinkedFileParser(IJson &json, const fs::path &path) const
+    {
+        fs::path const folder = fs::path(NormalizePath(path)).parent_path();
+        return [this, &json, folder](std::string relativePath) -> std::unique_ptr<IJson>
+        {
+            std::vector<uint8_t> content;
+            if(!read(folder / relativePath, content))
+                return nullptr;
+
+            std::unique_ptr<IJson> linkedFileJson = json.create();
+            if(!linkedFileJson->parse(content.data(), content.size()))
+                return nullptr;
+            return linkedFileJson;
+        };
+    }
+
+    /*!
+     * The path as it is stored in the archive: with '/' as separator, and without '.', '..' or empty parts.
+     * '..' parts leaving the root of the archive are dropped.
+     */
+    std::string Archive::NormalizePath(const fs::path &path)
+    {
+        std::vector<std::string> parts;
+        std::string const generic = path.generic_string();
+        size_t start = 0;
+        while(start <= generic.size())
+        {
+            size_t end = generic.find('/', start);
+            if(end == std::string::npos)
+                end = generic.size();
+
+            std::string part = generic.substr(start, end - start);
+            if(part == "..")
+            {
+                if(!parts.empty())
+                    parts.pop_back();
+            }
+            else if(!part.empty() && part != ".")
+                parts.push_back(std::move(part));
+            start = end + 1;
+        }
+
+        std::string normalized;
+        for(const auto &part : parts)
+        {
+            if(!normalized.empty())
+                normalized += '/';
+            normalized += part;
+        }
+        return normalized;
+    }
+
+    /*!
+     * Finds an entry by its normalized path. Entries are sorted by path, so this is a binary search.
+     */
+    bool Archive::find(const std::string &path, EntryRecord &entry) const
+    {
+        size_t first = 0;
+        size_t last = size();
+        while(first < last)
+        {
+            size_t const middle = first + (last - first) / 2;
+            auto const current = m_data.record<EntryRecord>(m_header.entries, middle);
+            int const compared = m_data.string(current.path).compare(path);
+            if(compared == 0)
+            {
+                entry = current;
+                return true;
+            }
+            if(compared < 0)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return false;
+    }
+
+    /*!
+     * Adds a file to the archive, replacing any file with the same path.
+     * When another file has the same content, the content is only stored once.
+     * @param archivePath Path of the file in the archive
+     * @param content The content of the file
+     */
+    void ArchiveWriter::add(const fs::path &archivePath, std::vector<uint8_t> content)
+    {
+        uint64_t const hash = tson::MapSnapshot::Hash(content.data(), content.size());
+        size_t blob = m_blobs.size();
+        auto [first, last] = m_blobsByHash.equal_range(hash);
+        for(auto it = first; it != last; ++it)
+        {
+            if(m_blobs[it->second].content == content)
+            {
+                blob = it->second;
+                break;
+            }
+        }
+
+        if(blob == m_blobs.size())
+        {
+            m_blobs.push_back({std::move(content), hash});
+            m_blobsByHash.emplace(hash, blob);
+        }
+        m_entries[Archive::NormalizePath(archivePath)] = blob;
+    }
+
+    /*!
+     * Adds a file from disk
+     * @param file The file to add
+     * @param archivePath Path of the file in the archive
+     * @return false if the file could not be read
+     */
+    bool ArchiveWriter::addFile(const fs::path &file, const fs::path &archivePath)
+    {
+        std::vector<uint8_t> content;
+        if(!tson::MapSnapshot::ReadFile(file, content))
+            return false;
+        add(archivePath, std::move(content));
+        return true;
+    }
+
+    /*!
+     * Adds the files of a folder and its subfolders, with their paths relative to the folder
+     * @param extensions The extensions of the files to add. Every file is added when empty.
+     * @return Number of files added
+     */
+    size_t ArchiveWriter::addDirectory(const fs::path &folder, const std::vector<std::string> &extensions)
+    {
+        size_t added = 0;
+        std::error_code error;
+        std::string const root = folder.generic_string();
+        for(const auto &entry : fs::recursive_directory_iterator(folder, error))
+        {
+            if(!fs::is_regular_file(entry.status()))
+                continue;
+
+            std::string const extension = entry.path().extension().generic_string();
+            if(!extensions.empty() && std::find(extensions.begin(), extensions.end(), extension) == extensions.end())
+                continue;
+
+            std::string const path = entry.path().generic_string();
+            if(addFile(entry.path(), path.substr(std::min(path.size(), root.size() + 1))))
+                ++added;
+        }
+        return added;
+    }
+
+    /*!
+     * Compresses the files of the archive when it is written. Files that do not get smaller are stored as they are.
+     * @param name Name of the compression. Readers need a decompressor with this name(), like "lzma" for tson::Lzma.
+     * @param compressor Compresses the content of one file
+     */
+    void ArchiveWriter::setCompressor(std::string name, tson::ArchiveCompressor compressor)
+    {
+        m_compressorName = std::move(name);
+        m_compressor = std::move(compressor);
+    }
+
+    /*!
+     * Writes the archive
+     */
+    std::vector<uint8_t> ArchiveWriter::serialize() const
+    {
+        std::vector<uint8_t> data(sizeof(Archive::Header));
+        std::vector<uint8_t> strings;
+        auto addString = [&](const std::string &value) -> FlatMap::String
+        {
+            FlatMap::String result {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+            strings.insert(strings.end(), value.begin(), value.end());
+            return result;
+        };
+        auto pad = [&]()
+        {
+            data.resize((data.size() + 3) & ~size_t(3));
+        };
+
+        //Only the blobs still used by a file are written, in the order of the files
+        std::vector<size_t> order;
+        std::vector<uint32_t> indices(m_blobs.size(), std::numeric_limits<uint32_t>::max());
+        for(const auto &[path, blob] : m_entries)
+        {
+            if(indices[blob] == std::numeric_limits<uint32_t>::max())
+            {
+                indices[blob] = static_cast<uint32_t>(order.size());
+                order.push_back(blob);
+            }
+        }
+
+        FlatMap::String const compression = (m_compressor) ? addString(m_compressorName) : FlatMap::String {0, 0};
+        std::vector<Archive::BlobRecord> blobs;
+        blobs.reserve(order.size());
+        for(size_t index : order)
+        {
+            const Blob &blob = m_blobs[index];
+            std::vector<uint8_t> compressed;
+            if(m_compressor)
+                compressed = m_compressor(blob.content);
+            bool const isCompressed = !compressed.empty() && compressed.size() < blob.content.size();
+            const std::vector<uint8_t> &stored = (isCompressed) ? compressed : blob.content;
+
+            Archive::BlobRecord record {};
+            record.offset = static_cast<uint32_t>(data.size());
+            record.size = static_cast<uint32_t>(stored.size());
+            record.originalSize = static_cast<uint32_t>(blob.content.size());
+            record.compression = (isCompressed) ? compression : FlatMap::String {0, 0};
+            record.hashLow = static_cast<uint32_t>(blob.hash);
+            record.hashHigh = static_cast<uint32_t>(blob.hash >> 32);
+            blobs.push_back(record);
+            data.insert(data.end(), stored.begin(), stored.end());
+            pad();
+        }
+
+        Archive::Header header {};
+        std::memcpy(header.magic, Archive::Magic, sizeof(header.magic));
+        header.version = Archive::Version;
+        header.byteOrder = FlatMap::ByteOrderMark;
+
+        header.blobs = {static_cast<uint32_t>(data.size()), static_cast<uint32_t>(blobs.size())};
+        data.resize(data.size() + blobs.size() * sizeof(Archive::BlobRecord));
+        if(!blobs.empty())
+            std::memcpy(data.data() + header.blobs.offset, blobs.data(), blobs.size() * sizeof(Archive::BlobRecord));
+
+        header.entries = {static_cast<uint32_t>(data.size()), static_cast<uint32_t>(m_entries.size())};
+        data.resize(data.size() + m_entries.size() * sizeof(Archive::EntryRecord));
+        size_t i = 0;
+        for(const auto &[path, blob] : m_entries)
+        {
+            Archive::EntryRecord record {addString(path), indices[blob]};
+            std::memcpy(data.data() + header.entries.offset + (i++) * sizeof(Archive::EntryRecord), &record, sizeof(record));
+        }
+
+        header.strings = static_cast<uint32_t>(data.size());
+        header.stringsSize = static_cast<uint32_t>(strings.size());
+        data.insert(data.end(), strings.begin(), strings.end());
+        pad();
+        header.size = static_cast<uint32_t>(data.size());
+        std::memcpy(data.data(), &header, sizeof(header));
+        return data;
+    }
+
+    /*!
+     * Writes the archive to a file
+     * @return true if the file was written
+     */
+    bool ArchiveWriter::save(const fs::path &path) const
+    {
+        std::vector<uint8_t> data = serialize();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    /*!
+     * Number of files added
+     */
+    size_t ArchiveWriter::size() const
+    {
+        return m_entries.size();
+    }
+
+    /*!
+     * Number of distinct contents added, including those of files that were replaced
+     */
+    size_t ArchiveWriter::getBlobCount() const
+    {
+        return m_blobs.size();
+    }
+}
+
+#endif //TILESON_ARCHIVE_HPP
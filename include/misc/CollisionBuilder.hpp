@@ -0,0 +1,404 @@
+#ifndef TILESON_COLLISIONBUILDER_HPP
+#define TILESON_COLLISIONBUILDER_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <set>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+namespace tson
+{
+    /*!
+     * A collision shape from the objectgroup of a tile, in pixels, with the flip flags of the tile applied.
+     */
+    class CollisionShape
+    {
+        public:
+            /*! Rectangle, Ellipse, Polygon, Polyline or Point */
+            tson::ObjectType type {tson::ObjectType::Undefined};
+            /*! The corners of rectangles and ellipse bounds (clockwise from the top-left corner before any transformation),
+             *  the points of polygons and polylines, or a single point. */
+            std::vector<tson::Vector2f> points;
+            /*! The object in the objectgroup of the tile */
+            tson::Object *object {nullptr};
+            /*! The tile the shape belongs to */
+            tson::Tile *tile {nullptr};
+            /*! Position of the tile in tile units */
+            tson::Vector2i tilePosition;
+    };
+
+    /*!
+     * Creates collision geometry from a tile layer.
+     *
+     * Solid tiles are merged into as few axis aligned rectangles as possible (greedy meshing), which keeps the number of
+     * bodies in a physics engine low. Tiles are solid when they match the predicate given in the constructor (a property or a set of gids),
+     * or when their objectgroup is a single rectangle covering the whole tile (see setMergeFullTileShapes()).
+     * Other tiles with an objectgroup give their shapes through buildShapes().
+     *
+     * The layer is split in horizontal bands of rows that are processed in parallel. Rectangles are merged across bands afterwards,
+     * so the result does not depend on the number of threads.
+     *
+     * Example:
+     * tson::CollisionBuilder builder {"solid"};
+     * for(const tson::Rect &rect : builder.buildRects(*layer))
+     *     world.addBox(rect.x * tileWidth, rect.y * tileHeight, rect.width * tileWidth, rect.height * tileHeight);
+     */
+    class CollisionBuilder
+    {
+        public:
+            inline CollisionBuilder() = default;
+            inline explicit CollisionBuilder(std::string propertyName);
+            inline explicit CollisionBuilder(std::set<uint32_t> gids);
+
+            inline void setThreadCount(size_t threadCount);
+            inline void setMergeFullTileShapes(bool mergeFullTileShapes);
+
+            inline const std::vector<tson::Rect> &buildRects(tson::Layer &layer);
+            inline const std::vector<tson::CollisionShape> &buildShapes(tson::Layer &layer);
+
+            [[nodiscard]] inline const std::vector<tson::Rect> &getRects() const;
+            [[nodiscard]] inline const std::vector<tson::CollisionShape> &getShapes() const;
+
+            inline static tson::Vector2f TransformTilePoint(const tson::Vector2f &point, const tson::Vector2f &tileSize, uint32_t gid);
+
+            static constexpr int BandRows = 64;     /*! Number of rows in each band that is meshed on its own */
+
+        private:
+            inline void prepare(tson::Layer &layer);
+            inline bool isFullTileShape(tson::Tile &tile, const tson::Map &map) const;
+            inline static void MergeBand(uint8_t *mask, int width, int height, const tson::Vector2i &origin, std::vector<tson::Rect> &rects);
+            inline static void StitchBands(std::vector<std::vector<tson::Rect>> &bands, std::vector<tson::Rect> &rects);
+
+            std::string                     m_propertyName;
+            std::set<uint32_t>              m_gids;
+            size_t                          m_threadCount {0};
+            bool                            m_mergeFullTileShapes {true};
+
+            std::vector<uint8_t>            m_solidGids;        /*! index: gid without flip flags. 1 if the tile is solid */
+            std::vector<tson::Rect>         m_rects;
+            std::vector<tson::CollisionShape> m_shapes;
+    };
+
+    /*!
+     * Tiles having a property with this name are solid. Boolean properties must also be true.
+     * @param propertyName Name of the property
+     */
+    CollisionBuilder::CollisionBuilder(std::string propertyName) : m_propertyName {std::move(propertyName)}
+    {
+
+    }
+
+    /*!
+     * Tiles with one of these gids are solid.
+     * @param gids Gids without flip flags
+     */
+    CollisionBuilder::CollisionBuilder(std::set<uint32_t> gids) : m_gids {std::move(gids)}
+    {
+
+    }
+
+    /*!
+     * Number of threads used by buildRects(). 0 (default) uses the number of hardware threads.
+     */
+    void CollisionBuilder::setThreadCount(size_t threadCount)
+    {
+        m_threadCount = threadCount;
+    }
+
+    /*!
+     * Whether tiles having a single rectangle in their objectgroup that covers the whole tile are solid. Default: true
+     */
+    void CollisionBuilder::setMergeFullTileShapes(bool mergeFullTileShapes)
+    {
+        m_mergeFullTileShapes = mergeFullTileShapes;
+    }
+
+    /*!
+     * Merges all solid tiles of the layer into axis aligned rectangles, with greedy meshing.
+     * Every solid tile is covered by exactly one rectangle.
+     * @param layer A tile layer
+     * @return Rectangles in tile units, sorted by y and then x. For orthogonal maps, multiply by the tile size of the map to get pixels.
+     */
+    const std::vector<tson::Rect> &CollisionBuilder::buildRects(tson::Layer &layer)
+    {
+        m_rects.clear();
+        prepare(layer);
+        if(layer.getType() != tson::LayerType::TileLayer || m_solidGids.empty())
+            return m_rects;
+
+        tson::Rect const bounds = layer.getTileBounds();
+        if(bounds.width <= 0 || bounds.height <= 0)
+            return m_rects;
+
+        size_t const bandCount = static_cast<size_t>((bounds.height + BandRows - 1) / BandRows);
+        std::vector<std::vector<tson::Rect>> bands(bandCount);
+        std::atomic<size_t> nextBand {0};
+
+        auto worker = [&]()
+        {
+            std::vector<uint8_t> mask;
+            for(size_t band = nextBand++; band < bandCount; band = nextBand++)
+            {
+                int const y = bounds.y + static_cast<int>(band) * BandRows;
+                int const rows = std::min(BandRows, bounds.y + bounds.height - y);
+                mask.assign(static_cast<size_t>(bounds.width) * static_cast<size_t>(rows), 0);
+                layer.forEachTileInRegion({bounds.x, y, bounds.width, rows}, [&](const tson::TileCell &cell)
+                {
+                    uint32_t const gid = cell.gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+                    if(gid < m_solidGids.size() && m_solidGids[gid] != 0)
+                        mask[static_cast<size_t>(cell.posInTileUnits.y - y) * bounds.width + (cell.posInTileUnits.x - bounds.x)] = 1;
+                });
+                MergeBand(mask.data(), bounds.width, rows, {bounds.x, y}, bands[band]);
+            }
+        };
+
+        size_t threadCount = (m_threadCount == 0) ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : m_threadCount;
+        threadCount = std::min(threadCount, bandCount);
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for(auto &thread : threads)
+            thread.join();
+
+        StitchBands(bands, m_rects);
+        return m_rects;
+    }
+
+    /*!
+     * Gets the objectgroup shapes of all tiles in the layer that are not solid, in pixels.
+     * The shapes are rotated by the rotation of the objects, flipped by the flip flags of the tiles,
+     * and placed where the tile is drawn: At the bottom-left corner of its cell, moved by the offsets of the layer and tileset.
+     * @param layer A tile layer
+     * @return The shapes, in the order of the tiles (row-major), and then in the order of the objects in each objectgroup.
+     */
+    const std::vector<tson::CollisionShape> &CollisionBuilder::buildShapes(tson::Layer &layer)
+    {
+        m_shapes.clear();
+        prepare(layer);
+        tson::Map *map = layer.getMap();
+        if(layer.getType() != tson::LayerType::TileLayer || map == nullptr)
+            return m_shapes;
+
+        float const cellHeight = static_cast<float>(map->getTileSize().y);
+        layer.forEachTileInRegion(layer.getTileBounds(), [&](const tson::TileCell &cell)
+        {
+            const tson::TileDrawInfo *info = map->getTileDrawInfo(cell.gid);
+            uint32_t const gid = cell.gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+            if(info == nullptr || info->tile == nullptr || (gid < m_solidGids.size() && m_solidGids[gid] != 0))
+                return;
+
+            std::vector<tson::Object> &objects = info->tile->getObjectgroup().getObjects();
+            if(objects.empty())
+                return;
+
+            tson::Vector2f const tileSize {static_cast<float>(info->drawingRect.width), static_cast<float>(info->drawingRect.height)};
+            bool const diagonal = (cell.gid & FLIPPED_DIAGONALLY_FLAG) != 0;
+            float const drawnHeight = (diagonal) ? tileSize.x : tileSize.y;
+            tson::Vector2f const origin {cell.position.x + static_cast<float>(info->tileOffset.x),
+                                         cell.position.y + cellHeight - drawnHeight + static_cast<float>(info->tileOffset.y)};
+
+            for(auto &obj : objects)
+            {
+                tson::CollisionShape shape;
+                shape.type = obj.getObjectType();
+                shape.object = &obj;
+                shape.tile = info->tile;
+                shape.tilePosition = cell.posInTileUnits;
+
+                std::vector<tson::Vector2f> local;
+                auto const width = static_cast<float>(obj.getSize().x);
+                auto const height = static_cast<float>(obj.getSize().y);
+                if(shape.type == tson::ObjectType::Rectangle || shape.type == tson::ObjectType::Ellipse)
+                    local = {{0.f, 0.f}, {width, 0.f}, {width, height}, {0.f, height}};
+                else if(shape.type == tson::ObjectType::Polygon || shape.type == tson::ObjectType::Polyline)
+                {
+                    const auto &points = (shape.type == tson::ObjectType::Polygon) ? obj.getPolygons() : obj.getPolylines();
+                    for(const auto &point : points)
+                        local.emplace_back(static_cast<float>(point.x), static_cast<float>(point.y));
+                }
+                else if(shape.type == tson::ObjectType::Point)
+                    local = {{0.f, 0.f}};
+                else
+                    continue;
+
+                //Rotation is clockwise around the position of the object, as in Tiled
+                float const radians = obj.getRotation() * 3.14159265358979323846f / 180.f;
+                float const cosR = std::cos(radians);
+                float const sinR = std::sin(radians);
+                shape.points.reserve(local.size());
+                for(const auto &point : local)
+                {
+                    tson::Vector2f const inTile {point.x * cosR - point.y * sinR + static_cast<float>(obj.getPosition().x),
+                                                 point.x * sinR + point.y * cosR + static_cast<float>(obj.getPosition().y)};
+                    tson::Vector2f const transformed = TransformTilePoint(inTile, tileSize, cell.gid);
+                    shape.points.emplace_back(transformed.x + origin.x, transformed.y + origin.y);
+                }
+                m_shapes.push_back(std::move(shape));
+            }
+        });
+
+        return m_shapes;
+    }
+
+    /*!
+     * The rectangles of the last call to buildRects()
+     */
+    const std::vector<tson::Rect> &CollisionBuilder::getRects() const
+    {
+        return m_rects;
+    }
+
+    /*!
+     * The shapes of the last call to buildShapes()
+     */
+    const std::vector<tson::CollisionShape> &CollisionBuilder::getShapes() const
+    {
+        return m_shapes;
+    }
+
+    /*!
+     * Applies the flip flags of a gid to a point inside a tile, the same way Tiled flips the image of the tile:
+     * Diagonally (swapping x and y) first, then horizontally and vertically.
+     * @param point Point relative to the top-left corner of the tile
+     * @param tileSize Size of the tile image before flipping
+     * @param gid Gid with flip flags
+     * @return The point relative to the top-left corner of the flipped tile
+     */
+    tson::Vector2f CollisionBuilder::TransformTilePoint(const tson::Vector2f &point, const tson::Vector2f &tileSize, uint32_t gid)
+    {
+        tson::Vector2f result = point;
+        tson::Vector2f size = tileSize;
+        if((gid & FLIPPED_DIAGONALLY_FLAG) != 0)
+        {
+            std::swap(result.x, result.y);
+            std::swap(size.x, size.y);
+        }
+        if((gid & FLIPPED_HORIZONTALLY_FLAG) != 0)
+            result.x = size.x - result.x;
+        if((gid & FLIPPED_VERTICALLY_FLAG) != 0)
+            result.y = size.y - result.y;
+
+        return result;
+    }
+
+    /*!
+     * Evaluates the predicate once for every gid of the map
+     */
+    void CollisionBuilder::prepare(tson::Layer &layer)
+    {
+        m_solidGids.clear();
+        tson::Map *map = layer.getMap();
+        if(map == nullptr)
+            return;
+
+        const std::vector<tson::TileDrawInfo> &table = map->getTileDrawTable();
+        m_solidGids.assign(table.size(), 0);
+        for(size_t gid = 0; gid < table.size(); ++gid)
+        {
+            tson::Tile *tile = table[gid].tile;
+            bool solid = m_gids.count(static_cast<uint32_t>(gid)) > 0;
+            if(!solid && tile != nullptr && !m_propertyName.empty())
+            {
+                tson::Property *property = tile->getProp(m_propertyName);
+                solid = property != nullptr && (property->getType() != tson::Type::Boolean || property->getValue<bool>());
+            }
+            if(!solid && tile != nullptr && m_mergeFullTileShapes)
+                solid = isFullTileShape(*tile, *map);
+
+            m_solidGids[gid] = (solid) ? 1 : 0;
+        }
+    }
+
+    /*!
+     * true if the objectgroup of the tile is a single unrotated rectangle covering the whole cell
+     */
+    bool CollisionBuilder::isFullTileShape(tson::Tile &tile, const tson::Map &map) const
+    {
+        const std::vector<tson::Object> &objects = tile.getObjectgroup().getObjects();
+        if(objects.size() != 1 || tile.getTileset() == nullptr)
+            return false;
+
+        const tson::Object &obj = objects[0];
+        const tson::Vector2i &tileSize = tile.getTileset()->getTileSize();
+        return obj.getObjectType() == tson::ObjectType::Rectangle && obj.getRotation() == 0.f &&
+               obj.getPosition() == tson::Vector2i(0, 0) && obj.getSize() == tileSize && tileSize == map.getTileSize() &&
+               tile.getTileset()->getTileOffset() == tson::Vector2i(0, 0);
+    }
+
+    /*!
+     * Greedy meshing of one band: Each unused solid tile starts a rectangle that grows to the right as far as possible,
+     * and then downwards as long as the whole row below is solid and unused.
+     * @param mask One byte per tile: 1 = solid. Changed to 2 for tiles that are used.
+     */
+    void CollisionBuilder::MergeBand(uint8_t *mask, int width, int height, const tson::Vector2i &origin, std::vector<tson::Rect> &rects)
+    {
+        for(int y = 0; y < height; ++y)
+        {
+            uint8_t *row = mask + static_cast<size_t>(y) * width;
+            for(int x = 0; x < width; ++x)
+            {
+                if(row[x] != 1)
+                    continue;
+
+                int w = 1;
+                while(x + w < width && row[x + w] == 1)
+                    ++w;
+
+                int h = 1;
+                for(; y + h < height; ++h)
+                {
+                    const uint8_t *below = mask + static_cast<size_t>(y + h) * width + x;
+                    if(!std::all_of(below, below + w, [](uint8_t value) { return value == 1; }))
+                        break;
+                }
+
+                for(int fillY = y; fillY < y + h; ++fillY)
+                    std::fill_n(mask + static_cast<size_t>(fillY) * width + x, w, static_cast<uint8_t>(2));
+
+                rects.emplace_back(origin.x + x, origin.y + y, w, h);
+                x += w - 1;
+            }
+        }
+    }
+
+    /*!
+     * Joins rectangles ending at the bottom of a band with rectangles starting at the top of the next band,
+     * when they have the same x and width.
+     */
+    void CollisionBuilder::StitchBands(std::vector<std::vector<tson::Rect>> &bands, std::vector<tson::Rect> &rects)
+    {
+        //key: x, width and bottom. Value: index in rects
+        std::map<std::tuple<int, int, int>, size_t> previous;
+        std::map<std::tuple<int, int, int>, size_t> current;
+        for(const auto &band : bands)
+        {
+            current.clear();
+            for(const auto &rect : band)
+            {
+                size_t index = rects.size();
+                auto iter = previous.find({rect.x, rect.width, rect.y});
+                if(iter != previous.end())
+                {
+                    index = iter->second;
+                    rects[index].height += rect.height;
+                    previous.erase(iter);
+                }
+                else
+                    rects.push_back(rect);
+
+                current[{rects[index].x, rects[index].width, rects[index].y + rects[index].height}] = index;
+            }
+            std::swap(previous, current);
+        }
+
+        std::sort(rects.begin(), rects.end(), [](const tson::Rect &a, const tson::Rect &b) { return (a.y != b.y) ? a.y < b.y : a.x < b.x; });
+    }
+}
+
+#endif //TILESON_COLLISIONBUILDER_HPP
@@ -0,0 +1,660 @@
+#ifndef TILESON_FLATMAP_HPP
+#define TILESON_FLATMAP_HPP
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tson
+{
+    /*!
+     * A read-only map format (.tsonf) that is used where it is, without being parsed: Mapped with tson::MappedFile, and read through
+     * tson::MapView. Nothing is allocated when a map is opened, and processes mapping the same file share it in the page cache.
+     *
+     * The file is a set of tables of fixed size records. Records point to their children with the offset and count of a table,
+     * and to strings with an offset and length in the string section, where every distinct string is stored once.
+     * Gids are stored as a plain uint32_t array per layer. Everything is 4-byte aligned, and stored in the byte order of the host
+     * that wrote it, which the header tells: Files written on a host with another byte order are rejected.
+     *
+     * Unlike tson::MapSnapshot, this is not a full tson::Map: Wang sets, terrains and tile collision layers other than their objects are left out.
+     *
+     * Example:
+     * tson::FlatMap::Save(*map, "map.tsonf");
+     */
+    class FlatMap
+    {
+        public:
+            static constexpr char Magic[8] {'T', 'S', 'O', 'N', 'F', 'L', 'A', 'T'};
+            static constexpr uint32_t Version = 2;
+            static constexpr uint32_t ByteOrderMark = 0x01020304;
+
+            /*! The string at 'offset' in the string section */
+            class String
+            {
+                public:
+                    uint32_t offset;
+                    uint32_t length;
+            };
+
+            /*! 'count' records starting at 'offset' in the file */
+            class Table
+            {
+                public:
+                    uint32_t offset;
+                    uint32_t count;
+            };
+
+            class Header
+            {
+                public:
+                    char     magic[8];
+                    uint32_t version;
+                    uint32_t byteOrder;     /*! ByteOrderMark, as written by the host */
+                    uint32_t size;          /*! Size of the file */
+                    uint32_t map;           /*! Offset of the MapRecord */
+                    uint32_t strings;       /*! Offset of the string section */
+                    uint32_t stringsSize;
+            };
+
+            class MapRecord
+            {
+                public:
+                    int32_t  width, height, tileWidth, tileHeight;
+                    String   orientation, renderOrder, staggerAxis, staggerIndex, tiledVersion, type, classType;
+                    uint32_t infinite;
+                    uint32_t backgroundColor;
+                    int32_t  hexsideLength, nextLayerId, nextObjectId;
+                    float    parallaxOriginX, parallaxOriginY;
+                    Table    layers, tilesets, properties;
+            };
+
+            class LayerRecord
+            {
+                public:
+                    int32_t  id;
+                    uint32_t type;          /*! tson::LayerType */
+                    String   name, typeStr, classType, image, drawOrder;
+                    int32_t  x, y, width, height;
+                    int32_t  regionX, regionY;  /*! Position of the first tile of 'data' in the map, when the layer has LayerHasRegion */
+                    float    offsetX, offsetY, opacity, parallaxX, parallaxY;
+                    uint32_t flags;         /*! LayerVisible, LayerHasTintColor... */
+                    uint32_t tintColor, transparentColor;
+                    Table    data, chunks, objects, layers, properties;
+            };
+
+            class ChunkRecord
+            {
+                public:
+                    int32_t  x, y, width, height;
+                    Table    data;
+            };
+
+            class ObjectRecord
+            {
+                public:
+                    int32_t  id;
+                    uint32_t objectType;    /*! tson::ObjectType */
+                    String   name, type, templ, text;
+                    int32_t  x, y, width, height;
+                    float    rotation;
+                    uint32_t gid, flipFlags;
+                    uint32_t flags;         /*! ObjectVisible, ObjectEllipse, ObjectPoint */
+                    Table    polygon, polyline, properties;
+            };
+
+            class TilesetRecord
+            {
+                public:
+                    int32_t  firstgid;
+                    uint32_t type;          /*! tson::TilesetType */
+                    String   name, image, fullImagePath, classType;
+                    int32_t  imageWidth, imageHeight, tileWidth, tileHeight, tileCount, columns, margin, spacing, tileOffsetX, tileOffsetY;
+                    uint32_t transparentColor;
+                    Table    tiles, properties;
+            };
+
+            /*! Only tiles with an image, a class, an animation, objects or properties are stored */
+            class TileRecord
+            {
+                public:
+                    uint32_t id, gid;
+                    String   image, type;
+                    int32_t  imageWidth, imageHeight;
+                    int32_t  subX, subY, subWidth, subHeight;
+                    Table    animation, objects, properties;
+            };
+
+            class FrameRecord
+            {
+                public:
+                    uint32_t tileId;
+                    int32_t  duration;
+            };
+
+            class PointRecord
+            {
+                public:
+                    int32_t  x, y;
+            };
+
+            class PropertyRecord
+            {
+                public:
+                    String   name;
+                    uint32_t type;          /*! tson::Type */
+                    String   propertyType;
+                    uint32_t kind;          /*! ValueKind */
+                    uint32_t value;         /*! int, uint, bool, float bits, color or enum value */
+                    String   string;        /*! string and file values, the value name of enums and the name of classes */
+                    Table    members;       /*! PropertyRecords of class values */
+            };
+
+            enum class ValueKind : uint32_t
+            {
+                None = 0,
+                Int = 1,
+                UInt = 2,
+                Bool = 3,
+                Float = 4,
+                String = 5,
+                Path = 6,
+                Color = 7,
+                Enum = 8,
+                Class = 9
+            };
+
+            /*! Flags of LayerRecord::flags */
+            static constexpr uint32_t LayerVisible = 1 << 0;
+            static constexpr uint32_t LayerHasTintColor = 1 << 1;
+            static constexpr uint32_t LayerRepeatX = 1 << 2;
+            static constexpr uint32_t LayerRepeatY = 1 << 3;
+            static constexpr uint32_t LayerHasRegion = 1 << 4;   /*! Only a region of the layer was decoded. See tson::Layer::hasRegion() */
+
+            /*! Flags of ObjectRecord::flags */
+            static constexpr uint32_t ObjectVisible = 1 << 0;
+            static constexpr uint32_t ObjectEllipse = 1 << 1;
+            static constexpr uint32_t ObjectPoint = 1 << 2;
+
+            /*!
+             * Bounds checked access to the records of a flat map in memory
+             */
+            class Data
+            {
+                public:
+                    inline Data() = default;
+                    inline Data(const uint8_t *data, size_t size, uint32_t strings, uint32_t stringsSize);
+
+                    template <typename T>
+                    inline T record(uint32_t offset) const;
+                    template <typename T>
+                    inline T record(const Table &table, size_t index) const;
+                    template <typename T>
+                    [[nodiscard]] inline size_t count(const Table &table) const;
+                    [[nodiscard]] inline std::string_view string(const String &string) const;
+                    [[nodiscard]] inline const uint8_t *data() const { return m_data; }
+
+                private:
+                    const uint8_t *m_data {nullptr};
+                    size_t m_size {0};
+                    uint32_t m_strings {0};
+                    uint32_t m_stringsSize {0};
+            };
+
+            inline static std::vector<uint8_t> Serialize(tson::Map &map);
+            inline static bool Save(tson::Map &map, const fs::path &path);
+            inline static bool ReadHeader(const void *data, size_t size, Header &header);
+
+            inline static uint32_t PackColor(const tson::Colori &color);
+            inline static tson::Colori UnpackColor(uint32_t color);
+
+        private:
+            class Writer
+            {
+                public:
+                    template <typename T>
+                    inline uint32_t allocate(size_t count);
+                    template <typename T>
+                    inline void store(uint32_t offset, size_t index, const T &record);
+                    inline String string(const std::string &value);
+
+                    std::vector<uint8_t> data;
+                    std::vector<uint8_t> strings;
+                    std::unordered_map<std::string, String> stringOffsets; /*! Every distinct string is only stored once */
+            };
+
+            inline static void WriteMap(Writer &out, tson::Map &map, uint32_t offset);
+            inline static Table WriteLayers(Writer &out, std::vector<tson::Layer> &layers);
+            inline static Table WriteObjects(Writer &out, std::vector<tson::Object> &objects);
+            inline static Table WriteTilesets(Writer &out, std::vector<tson::Tileset> &tilesets);
+            inline static Table WriteTiles(Writer &out, std::vector<tson::Tile> &tiles);
+            inline static Table WriteProperties(Writer &out, tson::PropertyCollection &properties);
+            inline static Table WritePoints(Writer &out, const std::vector<tson::Vector2i> &points);
+            template <typename T>
+            inline static Table WriteArray(Writer &out, const std::vector<T> &values);
+            inline static void WriteValue(Writer &out, const std::any &value, PropertyRecord &record);
+    };
+
+    static_assert(sizeof(FlatMap::Header) == 32, "FlatMap records must not be padded");
+    static_assert(sizeof(FlatMap::MapRecord) % 4 == 0 && sizeof(FlatMap::LayerRecord) % 4 == 0 && sizeof(FlatMap::ObjectRecord) % 4 == 0,
+                  "FlatMap records must keep the file 4-byte aligned");
+
+    FlatMap::Data::Data(const uint8_t *data, size_t size, uint32_t strings, uint32_t stringsSize) : m_data {data}, m_size {size},
+                                                                                                     m_strings {strings}, m_stringsSize {stringsSize}
+    {
+
+    }
+
+    /*!
+     * Reads the record at an offset. A default record if it is outside the data.
+     */
+    template<typename T>
+    T FlatMap::Data::record(uint32_t offset) const
+    {
+        T value {};
+        if(m_data != nullptr && offset <= m_size && sizeof(T) <= m_size - offset)
+            std::memcpy(&value, m_data + offset, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    T FlatMap::Data::record(const Table &table, size_t index) const
+    {
+        if(index >= count<T>(table))
+            return T {};
+        return record<T>(static_cast<uint32_t>(table.offset + index * sizeof(T)));
+    }
+
+    /*!
+     * The number of records in a table. 0 if the table does not fit in the data.
+     */
+    template<typename T>
+    size_t FlatMap::Data::count(const Table &table) const
+    {
+        if(table.offset > m_size || table.count > (m_size - table.offset) / sizeof(T))
+            return 0;
+        return table.count;
+    }
+
+    std::string_view FlatMap::Data::string(const String &string) const
+    {
+        if(m_data == nullptr || string.offset > m_stringsSize || string.length > m_stringsSize - string.offset)
+            return {};
+        return {reinterpret_cast<const char *>(m_data + m_strings + string.offset), string.length};
+    }
+
+    /*!
+     * Writes a parsed map to the flat format
+     */
+    std::vector<uint8_t> FlatMap::Serialize(tson::Map &map)
+    {
+        Writer out;
+        uint32_t const header = out.allocate<Header>(1);
+        uint32_t const mapOffset = out.allocate<MapRecord>(1);
+        WriteMap(out, map, mapOffset);
+
+        Header record {};
+        std::memcpy(record.magic, Magic, sizeof(record.magic));
+        record.version = Version;
+        record.byteOrder = ByteOrderMark;
+        record.map = mapOffset;
+        record.strings = static_cast<uint32_t>(out.data.size());
+        record.stringsSize = static_cast<uint32_t>(out.strings.size());
+        out.data.insert(out.data.end(), out.strings.begin(), out.strings.end());
+        out.data.resize((out.data.size() + 3) & ~size_t(3));
+        record.size = static_cast<uint32_t>(out.data.size());
+        out.store(header, 0, record);
+        return std::move(out.data);
+    }
+
+    /*!
+     * Writes a parsed map to a flat map file
+     * @return true if the file was written
+     */
+    bool FlatMap::Save(tson::Map &map, const fs::path &path)
+    {
+        std::vector<uint8_t> data = Serialize(map);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    /*!
+     * Reads and checks the header of a flat map
+     * @return false if the data is not a flat map of this version and byte order, or is smaller than the header says
+     */
+    bool FlatMap::ReadHeader(const void *data, size_t size, Header &header)
+    {
+        if(data == nullptr || size < sizeof(Header))
+            return false;
+
+        std::memcpy(&header, data, sizeof(Header));
+        return std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version && header.byteOrder == ByteOrderMark &&
+               header.size <= size && header.strings <= header.size && header.stringsSize <= header.size - header.strings;
+    }
+
+    uint32_t FlatMap::PackColor(const tson::Colori &color)
+    {
+        return static_cast<uint32_t>(color.r) | static_cast<uint32_t>(color.g) << 8 | static_cast<uint32_t>(color.b) << 16 |
+               static_cast<uint32_t>(color.a) << 24;
+    }
+
+    tson::Colori FlatMap::UnpackColor(uint32_t color)
+    {
+        return {static_cast<uint8_t>(color), static_cast<uint8_t>(color >> 8), static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 24)};
+    }
+
+    /*!
+     * Adds room for 'count' records at the end of the data
+     * @return The offset of the first record
+     */
+    template<typename T>
+    uint32_t FlatMap::Writer::allocate(size_t count)
+    {
+        auto const offset = static_cast<uint32_t>(data.size());
+        data.resize(data.size() + count * sizeof(T));
+        return offset;
+    }
+
+    template<typename T>
+    void FlatMap::Writer::store(uint32_t offset, size_t index, const T &record)
+    {
+        std::memcpy(data.data() + offset + index * sizeof(T), &record, sizeof(T));
+    }
+
+    FlatMap::String FlatMap::Writer::string(const std::string &value)
+    {
+        if(value.empty())
+            return {0, 0};
+
+        auto it = stringOffsets.find(value);
+        if(it != stringOffsets.end())
+            return it->second;
+
+        String result {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+        strings.insert(strings.end(), value.begin(), value.end());
+        stringOffsets.emplace(value, result);
+        return result;
+    }
+
+    void FlatMap::WriteMap(Writer &out, tson::Map &map, uint32_t offset)
+    {
+        MapRecord record {};
+        record.width = map.getSize().x;
+        record.height = map.getSize().y;
+        record.tileWidth = map.getTileSize().x;
+        record.tileHeight = map.getTileSize().y;
+        record.orientation = out.string(map.getOrientation());
+        record.renderOrder = out.string(map.getRenderOrder());
+        record.staggerAxis = out.string(map.getStaggerAxis());
+        record.staggerIndex = out.string(map.getStaggerIndex());
+        record.tiledVersion = out.string(map.getTiledVersion());
+        record.type = out.string(map.getType());
+        record.classType = out.string(map.getClassType());
+        record.infinite = map.isInfinite() ? 1 : 0;
+        record.backgroundColor = PackColor(map.getBackgroundColor());
+        record.hexsideLength = map.getHexsideLength();
+        record.nextLayerId = map.getNextLayerId();
+        record.nextObjectId = map.getNextObjectId();
+        record.parallaxOriginX = map.getParallaxOrigin().x;
+        record.parallaxOriginY = map.getParallaxOrigin().y;
+        record.layers = WriteLayers(out, map.getLayers());
+        record.tilesets = WriteTilesets(out, map.getTilesets());
+        record.properties = WriteProperties(out, map.getProperties());
+        out.store(offset, 0, record);
+    }
+
+    FlatMap::Table FlatMap::WriteLayers(Writer &out, std::vector<tson::Layer> &layers)
+    {
+        Table const table {out.allocate<LayerRecord>(layers.size()), static_cast<uint32_t>(layers.size())};
+        for(size_t i = 0; i < layers.size(); ++i)
+        {
+            tson::Layer &layer = layers[i];
+            LayerRecord record {};
+            record.id = layer.getId();
+            record.type = static_cast<uint32_t>(layer.getType());
+            record.name = out.string(layer.getName());
+            record.typeStr = out.string(layer.getTypeStr());
+            record.classType = out.string(layer.getClassType());
+            record.image = out.string(layer.getImage());
+            record.drawOrder = out.string(layer.getDrawOrder());
+            record.x = layer.getX();
+            record.y = layer.getY();
+            record.width = layer.getSize().x;
+            record.height = layer.getSize().y;
+            record.regionX = layer.getRegionOrigin().x;
+            record.regionY = layer.getRegionOrigin().y;
+            record.offsetX = layer.getOffset().x;
+            record.offsetY = layer.getOffset().y;
+            record.opacity = layer.getOpacity();
+            record.parallaxX = layer.getParallax().x;
+            record.parallaxY = layer.getParallax().y;
+            record.flags = (layer.isVisible() ? LayerVisible : 0u) | (layer.hasTintColor() ? LayerHasTintColor : 0u) |
+                           (layer.hasRepeatX() ? LayerRepeatX : 0u) | (layer.hasRepeatY() ? LayerRepeatY : 0u) |
+                           (layer.hasRegion() ? LayerHasRegion : 0u);
+            record.tintColor = PackColor(layer.getTintColor());
+            record.transparentColor = PackColor(layer.getTransparentColor());
+            record.data = WriteArray(out, layer.getData());
+
+            std::vector<tson::Chunk> &chunks = layer.getChunks();
+            record.chunks = {out.allocate<ChunkRecord>(chunks.size()), static_cast<uint32_t>(chunks.size())};
+            for(size_t c = 0; c < chunks.size(); ++c)
+            {
+                ChunkRecord chunk {chunks[c].getPosition().x, chunks[c].getPosition().y, chunks[c].getSize().x, chunks[c].getSize().y, {}};
+                std::vector<uint32_t> gids(chunks[c].getData().begin(), chunks[c].getData().end());
+                chunk.data = WriteArray(out, gids);
+                out.store(record.chunks.offset, c, chunk);
+            }
+
+            record.objects = WriteObjects(out, layer.getObjects());
+            record.layers = WriteLayers(out, layer.getLayers());
+            record.properties = WriteProperties(out, layer.getProperties());
+            out.store(table.offset, i, record);
+        }
+        return table;
+    }
+
+    FlatMap::Table FlatMap::WriteObjects(Writer &out, std::vector<tson::Object> &objects)
+    {
+        Table const table {out.allocate<ObjectRecord>(objects.size()), static_cast<uint32_t>(objects.size())};
+        for(size_t i = 0; i < objects.size(); ++i)
+        {
+            tson::Object &object = objects[i];
+            ObjectRecord record {};
+            record.id = object.getId();
+            record.objectType = static_cast<uint32_t>(object.getObjectType());
+            record.name = out.string(object.getName());
+            record.type = out.string(object.getType());
+            record.templ = out.string(object.getTemplate());
+            record.text = out.string(object.getText().text);
+            record.x = object.getPosition().x;
+            record.y = object.getPosition().y;
+            record.width = object.getSize().x;
+            record.height = object.getSize().y;
+            record.rotation = object.getRotation();
+            record.gid = object.getGid();
+            record.flipFlags = static_cast<uint32_t>(object.getFlipFlags());
+            record.flags = (object.isVisible() ? ObjectVisible : 0u) | (object.isEllipse() ? ObjectEllipse : 0u) | (object.isPoint() ? ObjectPoint : 0u);
+            record.polygon = WritePoints(out, object.getPolygons());
+            record.polyline = WritePoints(out, object.getPolylines());
+            record.properties = WriteProperties(out, object.getProperties());
+            out.store(table.offset, i, record);
+        }
+        return table;
+    }
+
+    FlatMap::Table FlatMap::WriteTilesets(Writer &out, std::vector<tson::Tileset> &tilesets)
+    {
+        Table const table {out.allocate<TilesetRecord>(tilesets.size()), static_cast<uint32_t>(tilesets.size())};
+        for(size_t i = 0; i < tilesets.size(); ++i)
+        {
+            tson::Tileset &tileset = tilesets[i];
+            TilesetRecord record {};
+            record.firstgid = tileset.getFirstgid();
+            record.type = static_cast<uint32_t>(tileset.getType());
+            record.name = out.string(tileset.getName());
+            record.image = out.string(tileset.getImage().generic_string());
+            record.fullImagePath = out.string(tileset.getFullImagePath().generic_string());
+            record.classType = out.string(tileset.getClassType());
+            record.imageWidth = tileset.getImageSize().x;
+            record.imageHeight = tileset.getImageSize().y;
+            record.tileWidth = tileset.getTileSize().x;
+            record.tileHeight = tileset.getTileSize().y;
+            record.tileCount = tileset.getTileCount();
+            record.columns = tileset.getColumns();
+            record.margin = tileset.getMargin();
+            record.spacing = tileset.getSpacing();
+            record.tileOffsetX = tileset.getTileOffset().x;
+            record.tileOffsetY = tileset.getTileOffset().y;
+            record.transparentColor = PackColor(tileset.getTransparentColor());
+            record.tiles = WriteTiles(out, tileset.getTiles());
+            record.properties = WriteProperties(out, tileset.getProperties());
+            out.store(table.offset, i, record);
+        }
+        return table;
+    }
+
+    /*!
+     * Writes the tiles that have more than their id, sorted by id so they can be binary searched
+     */
+    FlatMap::Table FlatMap::WriteTiles(Writer &out, std::vector<tson::Tile> &tiles)
+    {
+        std::vector<tson::Tile *> stored;
+        for(auto &tile : tiles)
+        {
+            if(!tile.getImage().empty() || !tile.getClassType().empty() || tile.getAnimation().any() || tile.getProperties().getSize() > 0 ||
+               !tile.getObjectgroup().getObjects().empty())
+                stored.push_back(&tile);
+        }
+        std::sort(stored.begin(), stored.end(), [](const tson::Tile *a, const tson::Tile *b) { return a->getId() < b->getId(); });
+
+        Table const table {out.allocate<TileRecord>(stored.size()), static_cast<uint32_t>(stored.size())};
+        for(size_t i = 0; i < stored.size(); ++i)
+        {
+            tson::Tile &tile = *stored[i];
+            TileRecord record {};
+            record.id = tile.getId();
+            record.gid = tile.getGid();
+            record.image = out.string(tile.getImage().generic_string());
+            record.type = out.string(tile.getClassType());
+            record.imageWidth = tile.getImageSize().x;
+            record.imageHeight = tile.getImageSize().y;
+            record.subX = tile.getSubRectangle().x;
+            record.subY = tile.getSubRectangle().y;
+            record.subWidth = tile.getSubRectangle().width;
+            record.subHeight = tile.getSubRectangle().height;
+
+            std::vector<FrameRecord> frames;
+            for(const auto &frame : tile.getAnimation().getFrames())
+                frames.push_back({frame.getTileId(), frame.getDuration()});
+            record.animation = WriteArray(out, frames);
+            record.objects = WriteObjects(out, tile.getObjectgroup().getObjects());
+            record.properties = WriteProperties(out, tile.getProperties());
+            out.store(table.offset, i, record);
+        }
+        return table;
+    }
+
+    /*!
+     * Writes properties sorted by name, so they can be binary searched
+     */
+    FlatMap::Table FlatMap::WriteProperties(Writer &out, tson::PropertyCollection &properties)
+    {
+        std::map<std::string, tson::Property> &values = properties.getProperties();
+        Table const table {out.allocate<PropertyRecord>(values.size()), static_cast<uint32_t>(values.size())};
+        size_t i = 0;
+        for(auto &[name, property] : values)
+        {
+            PropertyRecord record {};
+            record.name = out.string(name);
+            record.type = static_cast<uint32_t>(property.getType());
+            record.propertyType = out.string(property.getPropertyType());
+            WriteValue(out, property.getValue(), record);
+            out.store(table.offset, i++, record);
+        }
+        return table;
+    }
+
+    FlatMap::Table FlatMap::WritePoints(Writer &out, const std::vector<tson::Vector2i> &points)
+    {
+        std::vector<PointRecord> records;
+        records.reserve(points.size());
+        for(const auto &point : points)
+            records.push_back({point.x, point.y});
+        return WriteArray(out, records);
+    }
+
+    template<typename T>
+    FlatMap::Table FlatMap::WriteArray(Writer &out, const std::vector<T> &values)
+    {
+        Table const table {out.allocate<T>(values.size()), static_cast<uint32_t>(values.size())};
+        if(!values.empty())
+            std::memcpy(out.data.data() + table.offset, values.data(), values.size() * sizeof(T));
+        return table;
+    }
+
+    void FlatMap::WriteValue(Writer &out, const std::any &value, PropertyRecord &record)
+    {
+        const std::type_info &type = value.type();
+        ValueKind kind = ValueKind::None;
+        if(type == typeid(int))
+        {
+            kind = ValueKind::Int;
+            record.value = static_cast<uint32_t>(std::any_cast<int>(value));
+        }
+        else if(type == typeid(uint32_t))
+        {
+            kind = ValueKind::UInt;
+            record.value = std::any_cast<uint32_t>(value);
+        }
+        else if(type == typeid(bool))
+        {
+            kind = ValueKind::Bool;
+            record.value = std::any_cast<bool>(value) ? 1 : 0;
+        }
+        else if(type == typeid(float))
+        {
+            kind = ValueKind::Float;
+            float const f = std::any_cast<float>(value);
+            std::memcpy(&record.value, &f, sizeof(f));
+        }
+        else if(type == typeid(std::string))
+        {
+            kind = ValueKind::String;
+            record.string = out.string(std::any_cast<const std::string &>(value));
+        }
+        else if(type == typeid(fs::path))
+        {
+            kind = ValueKind::Path;
+            record.string = out.string(std::any_cast<const fs::path &>(value).generic_string());
+        }
+        else if(type == typeid(tson::Colori))
+        {
+            kind = ValueKind::Color;
+            record.value = PackColor(std::any_cast<const tson::Colori &>(value));
+        }
+        else if(type == typeid(tson::EnumValue))
+        {
+            const auto &enumValue = std::any_cast<const tson::EnumValue &>(value);
+            kind = ValueKind::Enum;
+            record.value = enumValue.getValue();
+            record.string = out.string(enumValue.getValueName());
+        }
+        else if(type == typeid(tson::TiledClass))
+        {
+            kind = ValueKind::Class;
+            tson::TiledClass tiledClass = std::any_cast<tson::TiledClass>(value);
+            record.string = out.string(tiledClass.getName());
+            record.members = WriteProperties(out, tiledClass.getMembers());
+        }
+        record.kind = static_cast<uint32_t>(kind);
+    }
+}
+
+#endif //TILESON_FLATMAP_HPP
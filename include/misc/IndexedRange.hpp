@@ -0,0 +1,61 @@
+#ifndef TILESON_INDEXEDRANGE_HPP
+#define TILESON_INDEXEDRANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace tson
+{
+    /*!
+     * A non-owning view of the elements of a container selected by a list of indices.
+     * Used to return query results without copying the elements themselves.
+     *
+     * The view is only valid as long as both the container and the list of indices stay unchanged.
+     *
+     * Example:
+     * for(tson::Object &obj : layer.getObjsByType(tson::ObjectType::Polygon)) { ... }
+     */
+    template <typename T>
+    class IndexedRange
+    {
+        public:
+            class Iterator
+            {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = T;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = T*;
+                    using reference = T&;
+
+                    inline Iterator(T *data, const size_t *index) : m_data {data}, m_index {index} {}
+                    inline T &operator*() const { return m_data[*m_index]; }
+                    inline T *operator->() const { return &m_data[*m_index]; }
+                    inline Iterator &operator++() { ++m_index; return *this; }
+                    inline Iterator operator++(int) { Iterator it = *this; ++m_index; return it; }
+                    inline bool operator==(const Iterator &rhs) const { return m_index == rhs.m_index; }
+                    inline bool operator!=(const Iterator &rhs) const { return m_index != rhs.m_index; }
+
+                private:
+                    T *m_data;
+                    const size_t *m_index;
+            };
+
+            inline IndexedRange() = default;
+            inline IndexedRange(T *data, const size_t *first, const size_t *last) : m_data {data}, m_first {first}, m_last {last} {}
+
+            [[nodiscard]] inline Iterator begin() const { return {m_data, m_first}; }
+            [[nodiscard]] inline Iterator end() const { return {m_data, m_last}; }
+            [[nodiscard]] inline size_t size() const { return static_cast<size_t>(m_last - m_first); }
+            [[nodiscard]] inline bool empty() const { return m_first == m_last; }
+            [[nodiscard]] inline T &operator[](size_t pos) const { return m_data[m_first[pos]]; }
+            [[nodiscard]] inline size_t indexAt(size_t pos) const { return m_first[pos]; }
+
+        private:
+            T *m_data {nullptr};
+            const size_t *m_first {nullptr};
+            const size_t *m_last {nullptr};
+    };
+}
+
+#endif //TILESON_INDEXEDRANGE_HPP
@@ -0,0 +1,649 @@
+#ifndef TILESON_MAPPROBE_HPP
+#define TILESON_MAPPROBE_HPP
+
+#include <atomic>
+#include <cctype>
+#include <thread>
+#include <system_error>
+#include <algorithm>
+
+namespace tson
+{
+    /*!
+     * Reads the size, layers, tilesets and properties of maps without parsing them, for tools that list many maps.
+     *
+     * Json maps (.json/.tmj) and .tmx maps are read as a stream, straight from a mapped file: Tile data, objects, chunks and
+     * the tiles of tilesets are skipped without being decoded, and json stops being read as soon as everything has been found.
+     * Only the properties are parsed, with the json parser given to the constructor (json) or tson::TmxJson (tmx).
+     *
+     * Example:
+     * tson::MapProbe probe;
+     * for(const tson::MapInfo &info : probe.probeDirectory("maps"))
+     *     std::cout << info.path << ": " << info.size.x << "x" << info.size.y << "\n";
+     */
+    class MapProbe
+    {
+        public:
+            #ifdef JSON11_IS_DEFINED
+            inline MapProbe();
+            #endif
+            inline explicit MapProbe(std::unique_ptr<tson::IJson> json);
+
+            inline tson::MapInfo probe(const fs::path &path);
+            inline tson::MapInfo probe(const void *data, size_t size);
+            inline std::vector<tson::MapInfo> probeDirectory(const fs::path &folder, size_t threadCount = 0, bool recursive = true);
+
+            inline static bool IsMapFile(const fs::path &path);
+
+        private:
+            /*!
+             * Reads json one value at a time. Values that are not needed are skipped by matching brackets and quotes only.
+             */
+            class JsonCursor
+            {
+                public:
+                    inline JsonCursor(const char *data, size_t size);
+
+                    template <typename Func>
+                    inline bool readObject(Func &&readValue);
+                    template <typename Func>
+                    inline bool readArray(Func &&readItem);
+                    inline bool readString(std::string &value);
+                    inline bool readNumber(double &value);
+                    inline bool readBool(bool &value);
+                    inline bool skipValue();
+                    inline bool skipValue(std::string_view &raw);
+
+                    [[nodiscard]] inline bool isAtEnd();
+
+                private:
+                    inline void skipWhitespace();
+                    inline bool consume(char c);
+                    inline bool readKey(std::string_view &key);
+                    inline bool skipString();
+
+                    const char *    m_data;
+                    size_t          m_size;
+                    size_t          m_pos {0};
+            };
+
+            inline bool probeJson(const char *data, size_t size, tson::MapInfo &info);
+            inline bool probeXml(const char *data, size_t size, tson::MapInfo &info);
+            inline bool readJsonLayers(JsonCursor &cursor, std::vector<tson::MapInfo::LayerInfo> &layers);
+            inline bool readXmlLayer(XmlReader &reader, tson::MapInfo::LayerInfo &layer);
+            inline static void ReadProperties(IJson &json, tson::PropertyCollection &properties);
+            inline static tson::LayerType ToLayerType(std::string_view type);
+            inline static int ToInt(std::string_view text);
+
+            std::unique_ptr<tson::IJson> m_json;        /*! Parses the properties of json maps */
+            tson::TmxJson m_tmxJson;                    /*! Parses the properties of tmx maps */
+    };
+
+    MapProbe::JsonCursor::JsonCursor(const char *data, size_t size) : m_data {data}, m_size {size}
+    {
+
+    }
+
+    void MapProbe::JsonCursor::skipWhitespace()
+    {
+        while(m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\n' || m_data[m_pos] == '\r' || m_data[m_pos] == '\t'))
+            ++m_pos;
+    }
+
+    bool MapProbe::JsonCursor::consume(char c)
+    {
+        skipWhitespace();
+        if(m_pos < m_size && m_data[m_pos] == c)
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool MapProbe::JsonCursor::isAtEnd()
+    {
+        skipWhitespace();
+        return m_pos == m_size;
+    }
+
+    /*!
+     * Moves past a string. m_pos is at its opening quote.
+     */
+    bool MapProbe::JsonCursor::skipString()
+    {
+        ++m_pos;
+        while(true)
+        {
+            const void *quote = std::memchr(m_data + m_pos, '"', m_size - m_pos);
+            if(quote == nullptr)
+                return false;
+
+            size_t const end = static_cast<size_t>(static_cast<const char *>(quote) - m_data);
+            size_t backslashes = 0;
+            while(end - backslashes > m_pos && m_data[end - backslashes - 1] == '\\')
+                ++backslashes;
+            m_pos = end + 1;
+            if(backslashes % 2 == 0)
+                return true;
+        }
+    }
+
+    /*!
+     * Reads a key and its colon. Keys are compared as they are in the json, so keys with escapes never match.
+     */
+    bool MapProbe::JsonCursor::readKey(std::string_view &key)
+    {
+        skipWhitespace();
+        if(m_pos >= m_size || m_data[m_pos] != '"')
+            return false;
+
+        size_t const start = m_pos + 1;
+        if(!skipString())
+            return false;
+        key = std::string_view(m_data + start, m_pos - 1 - start);
+        return consume(':');
+    }
+
+    /*!
+     * Calls readValue(key) for each key of an object. readValue must read or skip the value, and return false on errors.
+     */
+    template<typename Func>
+    bool MapProbe::JsonCursor::readObject(Func &&readValue)
+    {
+        if(!consume('{'))
+            return false;
+        if(consume('}'))
+            return true;
+
+        do
+        {
+            std::string_view key;
+            if(!readKey(key) || !readValue(key))
+                return false;
+        } while(consume(','));
+        return consume('}');
+    }
+
+    /*!
+     * Calls readItem() for each item of an array. readItem must read or skip the item, and return false on errors.
+     */
+    template<typename Func>
+    bool MapProbe::JsonCursor::readArray(Func &&readItem)
+    {
+        if(!consume('['))
+            return false;
+        if(consume(']'))
+            return true;
+
+        do
+        {
+            if(!readItem())
+                return false;
+        } while(consume(','));
+        return consume(']');
+    }
+
+    bool MapProbe::JsonCursor::readString(std::string &value)
+    {
+        skipWhitespace();
+        if(m_pos >= m_size || m_data[m_pos] != '"')
+            return skipValue();
+
+        size_t const start = m_pos + 1;
+        if(!skipString())
+            return false;
+
+        size_t const end = m_pos - 1; //The closing quote
+        value.clear();
+        for(size_t i = start; i < end; ++i)
+        {
+            char const c = m_data[i];
+            if(c != '\\')
+            {
+                value += c;
+                continue;
+            }
+
+            char const escaped = m_data[++i];
+            switch(escaped)
+            {
+                case 'b': value += '\b'; break;
+                case 'f': value += '\f'; break;
+                case 'n': value += '\n'; break;
+                case 'r': value += '\r'; break;
+                case 't': value += '\t'; break;
+                case 'u':
+                {
+                    if(i + 4 >= end)
+                        return false;
+                    auto codepoint = static_cast<uint32_t>(std::strtoul(std::string(m_data + i + 1, 4).c_str(), nullptr, 16));
+                    i += 4;
+                    //A surrogate pair
+                    if(codepoint >= 0xd800 && codepoint <= 0xdbff && i + 6 < end && m_data[i + 1] == '\\' && m_data[i + 2] == 'u')
+                    {
+                        auto const low = static_cast<uint32_t>(std::strtoul(std::string(m_data + i + 3, 4).c_str(), nullptr, 16));
+                        codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+                        i += 6;
+                    }
+                    value += XmlReader::Unescape("&#" + std::to_string(codepoint) + ";");
+                    break;
+                }
+                default: value += escaped; break;
+            }
+        }
+        return true;
+    }
+
+    bool MapProbe::JsonCursor::readNumber(double &value)
+    {
+        skipWhitespace();
+        size_t const start = m_pos;
+        if(!skipValue())
+            return false;
+
+        std::string const text(m_data + start, m_pos - start);
+        char *end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return end != text.c_str();
+    }
+
+    bool MapProbe::JsonCursor::readBool(bool &value)
+    {
+        skipWhitespace();
+        value = m_pos < m_size && m_data[m_pos] == 't';
+        return skipValue();
+    }
+
+    bool MapProbe::JsonCursor::skipValue()
+    {
+        std::string_view raw;
+        return skipValue(raw);
+    }
+
+    /*!
+     * Moves past a value without reading it.
+     * @param raw The json text of the value
+     */
+    bool MapProbe::JsonCursor::skipValue(std::string_view &raw)
+    {
+        skipWhitespace();
+        if(m_pos >= m_size)
+            return false;
+
+        size_t const start = m_pos;
+        char const first = m_data[m_pos];
+        if(first == '"')
+        {
+            if(!skipString())
+                return false;
+        }
+        else if(first == '{' || first == '[')
+        {
+            size_t depth = 0;
+            while(m_pos < m_size)
+            {
+                char const c = m_data[m_pos];
+                if(c == '"')
+                {
+                    if(!skipString())
+                        return false;
+                    continue;
+                }
+
+                ++m_pos;
+                if(c == '{' || c == '[')
+                    ++depth;
+                else if((c == '}' || c == ']') && --depth == 0)
+                    break;
+            }
+            if(depth != 0)
+                return false;
+        }
+        else
+        {
+            while(m_pos < m_size && std::strchr(",}] \n\r\t", m_data[m_pos]) == nullptr)
+                ++m_pos;
+            if(m_pos == start)
+                return false;
+        }
+
+        raw = std::string_view(m_data + start, m_pos - start);
+        return true;
+    }
+
+    #ifdef JSON11_IS_DEFINED
+    /*!
+     * Parses the properties of json maps with tson::Json11
+     */
+    MapProbe::MapProbe() : MapProbe(std::make_unique<tson::Json11>())
+    {
+
+    }
+    #endif
+
+    /*!
+     * @param json Parses the properties of json maps. If nullptr, the properties of json maps are not read.
+     */
+    MapProbe::MapProbe(std::unique_ptr<tson::IJson> json) : m_json {std::move(json)}
+    {
+
+    }
+
+    tson::MapInfo MapProbe::probe(const fs::path &path)
+    {
+        tson::MappedFile file;
+        if(!fs::exists(path) || !fs::is_regular_file(path) || !file.open(path))
+        {
+            tson::MapInfo info;
+            info.path = path;
+            info.status = tson::ParseStatus::FileNotFound;
+            return info;
+        }
+
+        tson::MapInfo info = probe(file.data(), file.size());
+        info.path = path;
+        return info;
+    }
+
+    /*!
+     * Probes a json map (starts with '{') or a tmx map (starts with '<'). Other data gives ParseStatus::ParseError.
+     */
+    tson::MapInfo MapProbe::probe(const void *data, size_t size)
+    {
+        tson::MapInfo info;
+        const char *text = static_cast<const char *>(data);
+        size_t start = (size >= 3 && std::memcmp(text, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+        while(start < size && (text[start] == ' ' || text[start] == '\n' || text[start] == '\r' || text[start] == '\t'))
+            ++start;
+
+        bool ok = false;
+        if(start < size && text[start] == '{')
+            ok = probeJson(text + start, size - start, info);
+        else if(start < size && text[start] == '<')
+            ok = probeXml(text + start, size - start, info);
+
+        if(!ok)
+            info.status = tson::ParseStatus::ParseError;
+        return info;
+    }
+
+    /*!
+     * Probes every .json, .tmj and .tmx file in a folder on several threads.
+     * @param threadCount Number of threads. 0 uses the number of hardware threads.
+     * @param recursive Include subfolders
+     * @return Maps, and files that could not be read, sorted by path. Other json files, like tilesets and worlds, are left out.
+     */
+    std::vector<tson::MapInfo> MapProbe::probeDirectory(const fs::path &folder, size_t threadCount, bool recursive)
+    {
+        //Folders that cannot be read are skipped, and an error while iterating ends the search with the files found so far
+        std::vector<fs::path> files;
+        std::error_code error;
+        auto const collect = [&](auto it)
+        {
+            for(decltype(it) const last; !error && it != last; it.increment(error))
+            {
+                std::error_code statusError;
+                if(it->is_regular_file(statusError) && IsMapFile(it->path()))
+                    files.push_back(it->path());
+            }
+        };
+
+        if(fs::is_directory(folder, error))
+        {
+            if(recursive)
+                collect(fs::recursive_directory_iterator(folder, fs::directory_options::skip_permission_denied, error));
+            else
+                collect(fs::directory_iterator(folder, fs::directory_options::skip_permission_denied, error));
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<tson::MapInfo> infos(files.size());
+        std::atomic<size_t> next {0};
+        auto work = [&](MapProbe &probe)
+        {
+            for(size_t i = next++; i < files.size(); i = next++)
+                infos[i] = probe.probe(files[i]);
+        };
+
+        if(threadCount == 0)
+            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, std::max<size_t>(1, files.size()));
+
+        //Every thread has its own probe, as the json parsers are not thread safe
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back([&, json = (m_json != nullptr) ? m_json->create() : nullptr]() mutable
+            {
+                MapProbe probe {std::move(json)};
+                work(probe);
+            });
+        }
+        work(*this);
+        for(std::thread &thread : threads)
+            thread.join();
+
+        infos.erase(std::remove_if(infos.begin(), infos.end(), [](const tson::MapInfo &info)
+        {
+            return info.status == tson::ParseStatus::OK && !info.isMap();
+        }), infos.end());
+        return infos;
+    }
+
+    bool MapProbe::IsMapFile(const fs::path &path)
+    {
+        std::string extension = path.extension().u8string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".json" || extension == ".tmj" || extension == ".tmx";
+    }
+
+    bool MapProbe::probeJson(const char *data, size_t size, tson::MapInfo &info)
+    {
+        enum Found : uint32_t
+        {
+            Width = 1, Height = 2, TileWidth = 4, TileHeight = 8, Orientation = 16, Infinite = 32,
+            Layers = 64, Tilesets = 128, Properties = 256, Type = 512, Class = 1024, All = 2047
+        };
+
+        JsonCursor cursor {data, size};
+        uint32_t found = 0;
+        bool stopped = false;
+        double number = 0.0;
+        std::string_view properties;
+
+        bool ok = cursor.readObject([&](std::string_view key)
+        {
+            bool result;
+            if(key == "width") { result = cursor.readNumber(number); info.size.x = static_cast<int>(number); found |= Width; }
+            else if(key == "height") { result = cursor.readNumber(number); info.size.y = static_cast<int>(number); found |= Height; }
+            else if(key == "tilewidth") { result = cursor.readNumber(number); info.tileSize.x = static_cast<int>(number); found |= TileWidth; }
+            else if(key == "tileheight") { result = cursor.readNumber(number); info.tileSize.y = static_cast<int>(number); found |= TileHeight; }
+            else if(key == "orientation") { result = cursor.readString(info.orientation); found |= Orientation; }
+            else if(key == "infinite") { result = cursor.readBool(info.infinite); found |= Infinite; }
+            else if(key == "layers") { result = readJsonLayers(cursor, info.layers); found |= Layers; }
+            else if(key == "type") { result = cursor.readString(info.type); found |= Type; }
+            else if(key == "class") { result = cursor.readString(info.classType); found |= Class; }
+            else if(key == "properties") { result = cursor.skipValue(properties); found |= Properties; }
+            else if(key == "tilesets")
+            {
+                found |= Tilesets;
+                result = cursor.readArray([&]()
+                {
+                    tson::MapInfo::TilesetInfo &tileset = info.tilesets.emplace_back();
+                    return cursor.readObject([&](std::string_view tilesetKey)
+                    {
+                        if(tilesetKey == "firstgid")
+                        {
+                            bool const read = cursor.readNumber(number);
+                            tileset.firstgid = static_cast<int>(number);
+                            return read;
+                        }
+                        if(tilesetKey == "name")
+                            return cursor.readString(tileset.name);
+                        if(tilesetKey == "source")
+                            return cursor.readString(tileset.source);
+                        return cursor.skipValue();
+                    });
+                });
+            }
+            else
+                result = cursor.skipValue();
+
+            //Everything has been found: Returning false stops reading
+            stopped = result && found == All;
+            return result && !stopped;
+        });
+
+        if(!stopped && (!ok || !cursor.isAtEnd()))
+            return false;
+
+        if(info.type.empty() && (found & Layers) != 0)
+            info.type = "map";
+        if(!properties.empty() && m_json != nullptr)
+        {
+            std::string const wrapped = "{\"properties\":" + std::string(properties) + "}";
+            if(m_json->parse(wrapped.data(), wrapped.size()))
+                ReadProperties(*m_json, info.properties);
+        }
+        return true;
+    }
+
+    bool MapProbe::readJsonLayers(JsonCursor &cursor, std::vector<tson::MapInfo::LayerInfo> &layers)
+    {
+        return cursor.readArray([&]()
+        {
+            tson::MapInfo::LayerInfo &layer = layers.emplace_back();
+            return cursor.readObject([&](std::string_view key)
+            {
+                if(key == "id")
+                {
+                    double id = 0.0;
+                    bool const read = cursor.readNumber(id);
+                    layer.id = static_cast<int>(id);
+                    return read;
+                }
+                if(key == "name")
+                    return cursor.readString(layer.name);
+                if(key == "type")
+                {
+                    std::string type;
+                    bool const read = cursor.readString(type);
+                    layer.type = ToLayerType(type);
+                    return read;
+                }
+                if(key == "layers")
+                    return readJsonLayers(cursor, layer.layers);
+                return cursor.skipValue();
+            });
+        });
+    }
+
+    bool MapProbe::probeXml(const char *data, size_t size, tson::MapInfo &info)
+    {
+        XmlReader reader {data, size};
+        if(reader.nextStartElement() != XmlReader::Token::StartElement)
+            return false;
+
+        info.type = reader.getName();
+        if(info.type != "map")
+            return true;
+
+        info.size = {ToInt(reader.getAttribute("width")), ToInt(reader.getAttribute("height"))};
+        info.tileSize = {ToInt(reader.getAttribute("tilewidth")), ToInt(reader.getAttribute("tileheight"))};
+        info.orientation = XmlReader::Unescape(reader.getAttribute("orientation"));
+        info.classType = XmlReader::Unescape(reader.getAttribute("class"));
+        info.infinite = reader.getAttribute("infinite") == "1";
+
+        while(true)
+        {
+            XmlReader::Token const token = reader.nextStartElement();
+            if(token == XmlReader::Token::EndElement)
+                return true;
+            if(token != XmlReader::Token::StartElement)
+                return false;
+
+            std::string_view const name = reader.getName();
+            if(name == "tileset")
+            {
+                tson::MapInfo::TilesetInfo &tileset = info.tilesets.emplace_back();
+                tileset.firstgid = ToInt(reader.getAttribute("firstgid"));
+                tileset.name = XmlReader::Unescape(reader.getAttribute("name"));
+                tileset.source = XmlReader::Unescape(reader.getAttribute("source"));
+                if(!reader.skipElement())
+                    return false;
+            }
+            else if(ToLayerType(name) != tson::LayerType::Undefined)
+            {
+                if(!readXmlLayer(reader, info.layers.emplace_back()))
+                    return false;
+            }
+            else if(name == "properties")
+            {
+                size_t const start = reader.getTokenOffset();
+                if(!reader.skipElement())
+                    return false;
+
+                std::string const wrapped = "<map>" + std::string(data + start, reader.getOffset() - start) + "</map>";
+                if(m_tmxJson.parse(wrapped.data(), wrapped.size()))
+                    ReadProperties(m_tmxJson, info.properties);
+            }
+            else if(!reader.skipElement())
+                return false;
+        }
+    }
+
+    /*!
+     * Reads a layer element. Its content is skipped, except the layers of a group.
+     */
+    bool MapProbe::readXmlLayer(XmlReader &reader, tson::MapInfo::LayerInfo &layer)
+    {
+        layer.id = ToInt(reader.getAttribute("id"));
+        layer.name = XmlReader::Unescape(reader.getAttribute("name"));
+        layer.type = ToLayerType(reader.getName());
+        if(layer.type != tson::LayerType::Group)
+            return reader.skipElement();
+
+        while(true)
+        {
+            XmlReader::Token const token = reader.nextStartElement();
+            if(token == XmlReader::Token::EndElement)
+                return true;
+            if(token != XmlReader::Token::StartElement)
+                return false;
+
+            if(ToLayerType(reader.getName()) != tson::LayerType::Undefined)
+            {
+                if(!readXmlLayer(reader, layer.layers.emplace_back()))
+                    return false;
+            }
+            else if(!reader.skipElement())
+                return false;
+        }
+    }
+
+    void MapProbe::ReadProperties(IJson &json, tson::PropertyCollection &properties)
+    {
+        for(std::unique_ptr<IJson> &property : json.array("properties"))
+            properties.add(*property);
+    }
+
+    /*!
+     * The type of a layer from its json 'type' or its tmx element name
+     */
+    tson::LayerType MapProbe::ToLayerType(std::string_view type)
+    {
+        if(type == "tilelayer" || type == "layer") return tson::LayerType::TileLayer;
+        if(type == "objectgroup") return tson::LayerType::ObjectGroup;
+        if(type == "imagelayer") return tson::LayerType::ImageLayer;
+        if(type == "group") return tson::LayerType::Group;
+        return tson::LayerType::Undefined;
+    }
+
+    int MapProbe::ToInt(std::string_view text)
+    {
+        return static_cast<int>(std::strtol(std::string(text).c_str(), nullptr, 10));
+    }
+}
+
+#endif //TILESON_MAPPROBE_HPP
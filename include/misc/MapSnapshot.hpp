@@ -0,0 +1,1049 @@
+#ifndef TILESON_MAPSNAPSHOT_HPP
+#define TILESON_MAPSNAPSHOT_HPP
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <system_error>
+
+namespace tson
+{
+    /*!
+     * Saves a parsed tson::Map to a versioned binary snapshot (.tsonb), and loads it again without any json backend.
+     *
+     * A snapshot has everything a parsed map has: Layers with their gids already decoded, tilesets (external tilesets included),
+     * tiles, objects (template instances included), and properties. Enum values and classes are stored with the name of their type,
+     * and are resolved against the tson::Project given when loading, like when parsing. Everything derived from the parsed data,
+     * like the tile map and the tile draw table, is created again when loading.
+     *
+     * The header stores a hash of the source json, and the tileset and template files the map depends on, so a snapshot can be checked
+     * against its sources before it is used. tson::Tileson does that when a snapshot mode is set.
+     *
+     * All numbers are stored as little endian.
+     */
+    class MapSnapshot
+    {
+        public:
+            static constexpr uint32_t Version = 2;
+            static constexpr char Magic[6] {'T', 'S', 'O', 'N', 'B', '\0'};
+
+            /*!
+             * The beginning of a snapshot
+             */
+            class Header
+            {
+                public:
+                    uint32_t                    version {};
+                    uint64_t                    sourceHash {};      /*! Hash() of the source json */
+                    std::vector<fs::path>       dependencies;       /*! External tilesets and templates */
+            };
+
+            inline static std::vector<uint8_t> Serialize(tson::Map &map, uint64_t sourceHash = 0, const fs::path &directory = {});
+            inline static std::unique_ptr<tson::Map> Deserialize(const void *data, size_t size, tson::Project *project = nullptr,
+                                                                 tson::DecompressorContainer *decompressors = nullptr);
+            inline static bool ReadHeader(const void *data, size_t size, Header &header);
+
+            inline static bool Save(tson::Map &map, const fs::path &path, uint64_t sourceHash = 0, const fs::path &directory = {});
+            inline static std::unique_ptr<tson::Map> Load(const fs::path &path, tson::Project *project = nullptr,
+                                                          tson::DecompressorContainer *decompressors = nullptr);
+            inline static std::unique_ptr<tson::Map> LoadIfCurrent(const fs::path &path, uint64_t sourceHash, const fs::file_time_type &sourceModified,
+                                                                   tson::Project *project = nullptr, tson::DecompressorContainer *decompressors = nullptr);
+
+            inline static fs::path GetPath(const fs::path &sourcePath);
+            inline static uint64_t Hash(const void *data, size_t size);
+            inline static bool ReadFile(const fs::path &path, std::vector<uint8_t> &data);
+
+        private:
+            class Writer
+            {
+                public:
+                    inline void u8(uint8_t value) { data.push_back(value); }
+                    inline void boolean(bool value) { u8(value ? 1 : 0); }
+                    inline void u32(uint32_t value) { for(int i = 0; i < 4; ++i) u8(static_cast<uint8_t>(value >> (8 * i))); }
+                    inline void i32(int32_t value) { u32(static_cast<uint32_t>(value)); }
+                    inline void u64(uint64_t value) { for(int i = 0; i < 8; ++i) u8(static_cast<uint8_t>(value >> (8 * i))); }
+                    inline void f32(float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); u32(bits); }
+                    inline void size(size_t value) { u32(static_cast<uint32_t>(value)); }
+                    inline void string(const std::string &value) { size(value.size()); data.insert(data.end(), value.begin(), value.end()); }
+                    inline void path(const fs::path &value) { string(value.generic_string()); }
+                    inline void vector2i(const tson::Vector2i &value) { i32(value.x); i32(value.y); }
+                    inline void vector2f(const tson::Vector2f &value) { f32(value.x); f32(value.y); }
+                    inline void color(const tson::Colori &value) { u8(value.r); u8(value.g); u8(value.b); u8(value.a); }
+                    inline void rect(const tson::Rect &value) { i32(value.x); i32(value.y); i32(value.width); i32(value.height); }
+
+                    std::vector<uint8_t> data;
+            };
+
+            class Reader
+            {
+                public:
+                    inline Reader(const uint8_t *data, size_t size) : m_data {data}, m_size {size} {}
+
+                    inline uint8_t u8() { return (has(1)) ? m_data[m_pos++] : 0; }
+                    inline bool boolean() { return u8() != 0; }
+                    inline uint32_t u32();
+                    inline int32_t i32() { return static_cast<int32_t>(u32()); }
+                    inline uint64_t u64();
+                    inline float f32() { uint32_t bits = u32(); float value; std::memcpy(&value, &bits, sizeof(value)); return value; }
+                    inline size_t size(size_t minElementSize);
+                    inline std::string string();
+                    inline fs::path path() { return fs::path(string()); }
+                    inline tson::Vector2i vector2i() { int32_t x = i32(); return {x, i32()}; }
+                    inline tson::Vector2f vector2f() { float x = f32(); return {x, f32()}; }
+                    inline tson::Colori color() { uint8_t r = u8(); uint8_t g = u8(); uint8_t b = u8(); return {r, g, b, u8()}; }
+                    inline tson::Rect rect() { int32_t x = i32(); int32_t y = i32(); int32_t w = i32(); return {x, y, w, i32()}; }
+
+                    [[nodiscard]] inline bool ok() const { return m_ok; }
+
+                private:
+                    inline bool has(size_t bytes);
+
+                    const uint8_t *m_data;
+                    size_t m_size;
+                    size_t m_pos {0};
+                    bool m_ok {true};
+            };
+
+            /*! The C++ type of a property value */
+            enum class ValueKind : uint8_t
+            {
+                None = 0,
+                Int = 1,
+                UInt = 2,
+                Bool = 3,
+                Float = 4,
+                String = 5,
+                Path = 6,
+                Color = 7,
+                Enum = 8,
+                Class = 9
+            };
+
+            inline static void WriteHeader(Writer &out, tson::Map &map, uint64_t sourceHash, const fs::path &directory);
+            inline static bool ReadHeader(Reader &in, Header &header);
+            inline static void CollectDependencies(tson::Map &map, const fs::path &directory, std::vector<fs::path> &dependencies);
+            inline static void CollectTemplates(std::vector<tson::Layer> &layers, std::vector<std::string> &templates);
+
+            inline static void WriteMap(Writer &out, tson::Map &map);
+            inline static void WriteLayer(Writer &out, tson::Layer &layer);
+            inline static void WriteObject(Writer &out, tson::Object &object);
+            inline static void WriteTileset(Writer &out, tson::Tileset &tileset);
+            inline static void WriteTile(Writer &out, tson::Tile &tile);
+            inline static void WriteWangSet(Writer &out, const tson::WangSet &wangset);
+            inline static void WriteWangColor(Writer &out, const tson::WangColor &color);
+            inline static void WriteProperties(Writer &out, const tson::PropertyCollection &properties);
+            inline static void WriteValue(Writer &out, const std::any &value);
+
+            inline static void ReadMap(Reader &in, tson::Map &map);
+            inline static void ReadLayer(Reader &in, tson::Layer &layer, tson::Map *map);
+            inline static void ReadObject(Reader &in, tson::Object &object, tson::Map *map);
+            inline static void ReadTileset(Reader &in, tson::Tileset &tileset, tson::Map *map);
+            inline static void ReadTile(Reader &in, tson::Tile &tile, tson::Tileset *tileset, tson::Map *map);
+            inline static void ReadWangSet(Reader &in, tson::WangSet &wangset, tson::Map *map);
+            inline static void ReadWangColor(Reader &in, tson::WangColor &color, tson::Map *map);
+            inline static void ReadProperties(Reader &in, tson::PropertyCollection &properties, tson::Project *project);
+            inline static std::any ReadValue(Reader &in, tson::Project *project);
+    };
+
+    uint32_t MapSnapshot::Reader::u32()
+    {
+        uint32_t value = 0;
+        for(int i = 0; i < 4; ++i)
+            value |= static_cast<uint32_t>(u8()) << (8 * i);
+        return value;
+    }
+
+    uint64_t MapSnapshot::Reader::u64()
+    {
+        uint64_t value = 0;
+        for(int i = 0; i < 8; ++i)
+            value |= static_cast<uint64_t>(u8()) << (8 * i);
+        return value;
+    }
+
+    /*!
+     * Reads the number of elements of a list. Fails when the rest of the data is too small for that many elements.
+     */
+    size_t MapSnapshot::Reader::size(size_t minElementSize)
+    {
+        size_t const count = u32();
+        if(!has(count * minElementSize))
+            return 0;
+        return count;
+    }
+
+    std::string MapSnapshot::Reader::string()
+    {
+        size_t const length = size(1);
+        std::string value(reinterpret_cast<const char *>(m_data + m_pos), length);
+        m_pos += length;
+        return value;
+    }
+
+    bool MapSnapshot::Reader::has(size_t bytes)
+    {
+        if(!m_ok || bytes > m_size - m_pos)
+        {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+
+
+    /*!
+     * Writes a parsed map to a snapshot.
+     * @param map A map with tson::ParseStatus::OK
+     * @param sourceHash Hash() of the json the map was parsed from
+     * @param directory The directory of the map file. Templates are found relative to it.
+     */
+    std::vector<uint8_t> MapSnapshot::Serialize(tson::Map &map, uint64_t sourceHash, const fs::path &directory)
+    {
+        //The snapshot holds every layer, so lazy layers must be read first
+        map.loadLayers();
+
+        Writer out;
+        WriteHeader(out, map, sourceHash, directory);
+        WriteMap(out, map);
+        return std::move(out.data);
+    }
+
+    /*!
+     * Creates a map from a snapshot
+     * @param project The project to resolve classes and enums with. Should be the one the map was parsed with.
+     * @param decompressors Given to the map, like when it is parsed
+     * @return The map. Has tson::ParseStatus::ParseError if the snapshot is invalid or has another version.
+     */
+    std::unique_ptr<tson::Map> MapSnapshot::Deserialize(const void *data, size_t size, tson::Project *project, tson::DecompressorContainer *decompressors)
+    {
+        Reader in {static_cast<const uint8_t *>(data), size};
+        Header header;
+        if(!ReadHeader(in, header))
+            return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Not a tileson snapshot, or a snapshot of another version");
+
+        std::unique_ptr<tson::Map> map = std::make_unique<tson::Map>();
+        map->m_decompressors = decompressors;
+        map->m_project = project;
+        ReadMap(in, *map);
+        if(!in.ok())
+            return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Snapshot is corrupt");
+
+        return map;
+    }
+
+    /*!
+     * Reads only the header of a snapshot
+     * @return false if the data is not a snapshot of this version
+     */
+    bool MapSnapshot::ReadHeader(const void *data, size_t size, Header &header)
+    {
+        Reader in {static_cast<const uint8_t *>(data), size};
+        return ReadHeader(in, header);
+    }
+
+    /*!
+     * Writes a snapshot of a map to a file
+     * @return true if the file was written
+     */
+    bool MapSnapshot::Save(tson::Map &map, const fs::path &path, uint64_t sourceHash, const fs::path &directory)
+    {
+        std::vector<uint8_t> data = Serialize(map, sourceHash, directory);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    /*!
+     * Loads a snapshot file without checking it against its sources
+     */
+    std::unique_ptr<tson::Map> MapSnapshot::Load(const fs::path &path, tson::Project *project, tson::DecompressorContainer *decompressors)
+    {
+        std::vector<uint8_t> data;
+        if(!ReadFile(path, data))
+            return std::make_unique<tson::Map>(tson::ParseStatus::FileNotFound, "File not found: " + path.generic_string());
+
+        return Deserialize(data.data(), data.size(), project, decompressors);
+    }
+
+    /*!
+     * Loads a snapshot file if it is still valid: It must be newer than its source and every file the map depends on,
+     * and it must have been made from a json with the same hash.
+     * @param path The snapshot
+     * @param sourceHash Hash() of the current source json
+     * @param sourceModified When the source json was last written to
+     * @return The map. nullptr if the snapshot does not exist, or is out of date.
+     */
+    std::unique_ptr<tson::Map> MapSnapshot::LoadIfCurrent(const fs::path &path, uint64_t sourceHash, const fs::file_time_type &sourceModified,
+                                                          tson::Project *project, tson::DecompressorContainer *decompressors)
+    {
+        std::error_code error;
+        fs::file_time_type const modified = fs::last_write_time(path, error);
+        if(error || modified < sourceModified)
+            return nullptr;
+
+        std::vector<uint8_t> data;
+        Header header;
+        if(!ReadFile(path, data) || !ReadHeader(data.data(), data.size(), header) || header.sourceHash != sourceHash)
+            return nullptr;
+
+        for(const fs::path &dependency : header.dependencies)
+        {
+            fs::file_time_type const dependencyModified = fs::last_write_time(dependency, error);
+            if(error || dependencyModified > modified)
+                return nullptr;
+        }
+
+        std::unique_ptr<tson::Map> map = Deserialize(data.data(), data.size(), project, decompressors);
+        if(map->getStatus() != tson::ParseStatus::OK)
+            return nullptr;
+        return map;
+    }
+
+    /*!
+     * The snapshot path used by tson::Tileson for a map: The path of the map with the extension '.tsonb'
+     */
+    fs::path MapSnapshot::GetPath(const fs::path &sourcePath)
+    {
+        fs::path path = sourcePath;
+        path.replace_extension(".tsonb");
+        return path;
+    }
+
+    /*!
+     * 64-bit FNV-1a hash of the source json
+     */
+    uint64_t MapSnapshot::Hash(const void *data, size_t size)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        uint64_t hash = 14695981039346656037ull;
+        for(size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /*!
+     * Reads a whole file
+     * @return false if the file could not be read
+     */
+    bool MapSnapshot::ReadFile(const fs::path &path, std::vector<uint8_t> &data)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file)
+            return false;
+
+        std::streamoff const size = file.tellg();
+        if(size < 0)
+            return false;
+        data.resize(static_cast<size_t>(size));
+        file.seekg(0, std::ios::beg);
+        return static_cast<bool>(file.read(reinterpret_cast<char *>(data.data()), size));
+    }
+
+    void MapSnapshot::WriteHeader(Writer &out, tson::Map &map, uint64_t sourceHash, const fs::path &directory)
+    {
+        for(char c : Magic)
+            out.u8(static_cast<uint8_t>(c));
+        out.u32(Version);
+        out.u64(sourceHash);
+
+        std::vector<fs::path> dependencies;
+        CollectDependencies(map, directory, dependencies);
+        out.size(dependencies.size());
+        for(const fs::path &dependency : dependencies)
+            out.path(dependency);
+    }
+
+    bool MapSnapshot::ReadHeader(Reader &in, Header &header)
+    {
+        for(char c : Magic)
+        {
+            if(in.u8() != static_cast<uint8_t>(c))
+                return false;
+        }
+        header.version = in.u32();
+        if(header.version != Version)
+            return false;
+        header.sourceHash = in.u64();
+        size_t const count = in.size(4);
+        header.dependencies.clear();
+        for(size_t i = 0; i < count; ++i)
+            header.dependencies.emplace_back(in.path());
+        return in.ok();
+    }
+
+    /*!
+     * The files of the external tilesets and templates of a map
+     */
+    void MapSnapshot::CollectDependencies(tson::Map &map, const fs::path &directory, std::vector<fs::path> &dependencies)
+    {
+        for(auto &tileset : map.m_tilesets)
+        {
+            if(!tileset.m_source.empty())
+                dependencies.push_back(tileset.m_path);
+        }
+
+        std::vector<std::string> templates;
+        CollectTemplates(map.m_layers, templates);
+        std::sort(templates.begin(), templates.end());
+        templates.erase(std::unique(templates.begin(), templates.end()), templates.end());
+        for(const std::string &templatePath : templates)
+            dependencies.push_back(directory / templatePath);
+    }
+
+    void MapSnapshot::CollectTemplates(std::vector<tson::Layer> &layers, std::vector<std::string> &templates)
+    {
+        for(auto &layer : layers)
+        {
+            for(auto &object : layer.m_objects)
+            {
+                if(!object.m_template.empty())
+                    templates.push_back(object.m_template);
+            }
+            CollectTemplates(layer.m_layers, templates);
+        }
+    }
+
+    void MapSnapshot::WriteMap(Writer &out, tson::Map &map)
+    {
+        out.color(map.m_backgroundColor);
+        out.vector2i(map.m_size);
+        out.i32(map.m_hexsideLength);
+        out.boolean(map.m_isInfinite);
+        out.i32(map.m_nextLayerId);
+        out.i32(map.m_nextObjectId);
+        out.string(map.m_orientation);
+        out.string(map.m_renderOrder);
+        out.string(map.m_staggerAxis);
+        out.string(map.m_staggerIndex);
+        out.string(map.m_tiledVersion);
+        out.vector2i(map.m_tileSize);
+        out.string(map.m_type);
+        out.string(map.m_classType);
+        out.vector2f(map.m_parallaxOrigin);
+        out.i32(map.m_compressionLevel);
+        WriteProperties(out, map.m_properties);
+
+        out.size(map.m_tilesets.size());
+        for(auto &tileset : map.m_tilesets)
+            WriteTileset(out, tileset);
+
+        out.size(map.m_layers.size());
+        for(auto &layer : map.m_layers)
+            WriteLayer(out, layer);
+    }
+
+    /*!
+     * Reads the map, then creates the data a parsed map creates from its json
+     */
+    void MapSnapshot::ReadMap(Reader &in, tson::Map &map)
+    {
+        map.m_backgroundColor = in.color();
+        map.m_size = in.vector2i();
+        map.m_hexsideLength = in.i32();
+        map.m_isInfinite = in.boolean();
+        map.m_nextLayerId = in.i32();
+        map.m_nextObjectId = in.i32();
+        map.m_orientation = in.string();
+        map.m_renderOrder = in.string();
+        map.m_staggerAxis = in.string();
+        map.m_staggerIndex = in.string();
+        map.m_tiledVersion = in.string();
+        map.m_tileSize = in.vector2i();
+        map.m_type = in.string();
+        map.m_classType = in.string();
+        map.m_parallaxOrigin = in.vector2f();
+        map.m_compressionLevel = in.i32();
+        ReadProperties(in, map.m_properties, map.m_project);
+
+        //The tiles point to their tileset, so every tileset must be in place before they are read
+        map.m_tilesets.resize(in.size(1));
+        for(auto &tileset : map.m_tilesets)
+            ReadTileset(in, tileset, &map);
+
+        map.m_layers.resize(in.size(1));
+        for(auto &layer : map.m_layers)
+            ReadLayer(in, layer, &map);
+
+        if(!in.ok())
+            return;
+
+        map.processData();
+        map.buildObjectLookup();
+    }
+
+    void MapSnapshot::WriteLayer(Writer &out, tson::Layer &layer)
+    {
+        out.string(layer.m_typeStr);
+        out.string(layer.m_classType);
+        out.i32(layer.m_id);
+        out.string(layer.m_name);
+        out.string(layer.m_compression);
+        out.string(layer.m_encoding);
+        out.string(layer.m_drawOrder);
+        out.string(layer.m_image);
+        out.vector2f(layer.m_offset);
+        out.f32(layer.m_opacity);
+        out.vector2i(layer.m_size);
+        out.color(layer.m_transparentColor);
+        out.boolean(layer.m_hasTintColor);
+        out.color(layer.m_tintColor);
+        out.boolean(layer.m_visible);
+        out.i32(layer.m_x);
+        out.i32(layer.m_y);
+        out.vector2f(layer.m_parallax);
+        out.boolean(layer.m_repeatX);
+        out.boolean(layer.m_repeatY);
+        out.boolean(layer.m_hasRegion);
+        out.vector2i(layer.m_regionOrigin);
+
+        //Already decoded and decompressed gids
+        out.size(layer.m_data.size());
+        for(uint32_t gid : layer.m_data)
+            out.u32(gid);
+        out.string(layer.m_base64Data);
+
+        out.size(layer.m_chunks.size());
+        for(auto &chunk : layer.m_chunks)
+        {
+            out.vector2i(chunk.m_size);
+            out.vector2i(chunk.m_position);
+            out.size(chunk.m_data.size());
+            for(int gid : chunk.m_data)
+                out.i32(gid);
+            out.string(chunk.m_base64Data);
+        }
+
+        WriteProperties(out, layer.m_properties);
+
+        out.size(layer.m_objects.size());
+        for(auto &object : layer.m_objects)
+            WriteObject(out, object);
+
+        out.size(layer.m_layers.size());
+        for(auto &child : layer.m_layers)
+            WriteLayer(out, child);
+    }
+
+    void MapSnapshot::ReadLayer(Reader &in, tson::Layer &layer, tson::Map *map)
+    {
+        layer.m_map = map;
+        layer.m_typeStr = in.string();
+        layer.m_classType = in.string();
+        layer.m_id = in.i32();
+        layer.m_name = in.string();
+        layer.m_compression = in.string();
+        layer.m_encoding = in.string();
+        layer.m_drawOrder = in.string();
+        layer.m_image = in.string();
+        layer.m_offset = in.vector2f();
+        layer.m_opacity = in.f32();
+        layer.m_size = in.vector2i();
+        layer.m_transparentColor = in.color();
+        layer.m_hasTintColor = in.boolean();
+        layer.m_tintColor = in.color();
+        layer.m_visible = in.boolean();
+        layer.m_x = in.i32();
+        layer.m_y = in.i32();
+        layer.m_parallax = in.vector2f();
+        layer.m_repeatX = in.boolean();
+        layer.m_repeatY = in.boolean();
+        layer.m_hasRegion = in.boolean();
+        layer.m_regionOrigin = in.vector2i();
+
+        layer.m_data.resize(in.size(4));
+        for(uint32_t &gid : layer.m_data)
+            gid = in.u32();
+        layer.m_base64Data = in.string();
+
+        layer.m_chunks.resize(in.size(20));
+        for(auto &chunk : layer.m_chunks)
+        {
+            chunk.m_size = in.vector2i();
+            chunk.m_position = in.vector2i();
+            chunk.m_data.resize(in.size(4));
+            for(int &gid : chunk.m_data)
+                gid = in.i32();
+            chunk.m_base64Data = in.string();
+        }
+
+        ReadProperties(in, layer.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+
+        layer.m_objects.resize(in.size(1));
+        for(auto &object : layer.m_objects)
+            ReadObject(in, object, map);
+
+        layer.m_layers.resize(in.size(1));
+        for(auto &child : layer.m_layers)
+            ReadLayer(in, child, map);
+
+        layer.setTypeByString();
+        layer.buildObjectBuckets();
+    }
+
+    void MapSnapshot::WriteObject(Writer &out, tson::Object &object)
+    {
+        out.u8(static_cast<uint8_t>(object.m_objectType));
+        out.boolean(object.m_ellipse);
+        out.u32(object.m_gid);
+        out.u32(static_cast<uint32_t>(object.m_flipFlags));
+        out.vector2i(object.m_size);
+        out.i32(object.m_id);
+        out.string(object.m_name);
+        out.boolean(object.m_point);
+        for(const auto *points : {&object.m_polygon, &object.m_polyline})
+        {
+            out.size(points->size());
+            for(const auto &point : *points)
+                out.vector2i(point);
+        }
+        out.f32(object.m_rotation);
+        out.string(object.m_template);
+        out.string(object.m_type);
+        out.boolean(object.m_visible);
+        out.vector2i(object.m_position);
+
+        const tson::Text &text = object.m_text;
+        out.string(text.text);
+        out.color(text.color);
+        out.boolean(text.wrap);
+        out.boolean(text.bold);
+        out.string(text.fontFamily);
+        out.u8(static_cast<uint8_t>(text.horizontalAlignment));
+        out.boolean(text.italic);
+        out.boolean(text.kerning);
+        out.i32(text.pixelSize);
+        out.boolean(text.strikeout);
+        out.boolean(text.underline);
+        out.u8(static_cast<uint8_t>(text.verticalAlignment));
+
+        WriteProperties(out, object.m_properties);
+    }
+
+    void MapSnapshot::ReadObject(Reader &in, tson::Object &object, tson::Map *map)
+    {
+        object.m_map = map;
+        object.m_objectType = static_cast<tson::ObjectType>(in.u8());
+        object.m_ellipse = in.boolean();
+        object.m_gid = in.u32();
+        object.m_flipFlags = static_cast<tson::TileFlipFlags>(in.u32());
+        object.m_size = in.vector2i();
+        object.m_id = in.i32();
+        object.m_name = in.string();
+        object.m_point = in.boolean();
+        for(auto *points : {&object.m_polygon, &object.m_polyline})
+        {
+            points->resize(in.size(8));
+            for(auto &point : *points)
+                point = in.vector2i();
+        }
+        object.m_rotation = in.f32();
+        object.m_template = in.string();
+        object.m_type = in.string();
+        object.m_visible = in.boolean();
+        object.m_position = in.vector2i();
+
+        tson::Text &text = object.m_text;
+        text.text = in.string();
+        text.color = in.color();
+        text.wrap = in.boolean();
+        text.bold = in.boolean();
+        text.fontFamily = in.string();
+        text.horizontalAlignment = static_cast<tson::TextAlignment>(in.u8());
+        text.italic = in.boolean();
+        text.kerning = in.boolean();
+        text.pixelSize = in.i32();
+        text.strikeout = in.boolean();
+        text.underline = in.boolean();
+        text.verticalAlignment = static_cast<tson::TextAlignment>(in.u8());
+
+        ReadProperties(in, object.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+    }
+
+    /*!
+     * Writes a tileset, with every tile. External tilesets are stored like embedded ones, but keep their 'source'.
+     */
+    void MapSnapshot::WriteTileset(Writer &out, tson::Tileset &tileset)
+    {
+        out.i32(tileset.m_firstgid);
+        out.path(tileset.m_source);
+        out.path(tileset.m_path);
+        out.i32(tileset.m_columns);
+        out.u8(static_cast<uint8_t>(tileset.m_type));
+        out.string(tileset.m_typeStr);
+        out.path(tileset.m_image);
+        out.path(tileset.m_imagePath);
+        out.vector2i(tileset.m_imageSize);
+        out.i32(tileset.m_margin);
+        out.string(tileset.m_name);
+        out.i32(tileset.m_spacing);
+        out.i32(tileset.m_tileCount);
+        out.vector2i(tileset.m_tileSize);
+        out.color(tileset.m_transparentColor);
+        out.string(tileset.m_grid.m_orientation);
+        out.vector2i(tileset.m_grid.m_size);
+        out.string(tileset.m_classType);
+        out.vector2i(tileset.m_tileOffset);
+        out.u8(static_cast<uint8_t>(tileset.m_tileRenderSize));
+        out.u8(static_cast<uint8_t>(tileset.m_fillMode));
+        out.u8(static_cast<uint8_t>(tileset.m_objectAlignment));
+        out.boolean(tileset.m_transformations.m_hflip);
+        out.boolean(tileset.m_transformations.m_preferuntransformed);
+        out.boolean(tileset.m_transformations.m_rotate);
+        out.boolean(tileset.m_transformations.m_vflip);
+        WriteProperties(out, tileset.m_properties);
+
+        out.size(tileset.m_terrains.size());
+        for(auto &terrain : tileset.m_terrains)
+        {
+            out.string(terrain.getName());
+            out.i32(terrain.getTile());
+            WriteProperties(out, terrain.getProperties());
+        }
+
+        out.size(tileset.m_wangsets.size());
+        for(const auto &wangset : tileset.m_wangsets)
+            WriteWangSet(out, wangset);
+
+        out.size(tileset.m_tiles.size());
+        for(auto &tile : tileset.m_tiles)
+            WriteTile(out, tile);
+    }
+
+    void MapSnapshot::ReadTileset(Reader &in, tson::Tileset &tileset, tson::Map *map)
+    {
+        tileset.m_map = map;
+        tileset.m_firstgid = in.i32();
+        tileset.m_source = in.path();
+        tileset.m_path = in.path();
+        tileset.m_columns = in.i32();
+        tileset.m_type = static_cast<tson::TilesetType>(in.u8());
+        tileset.m_typeStr = in.string();
+        tileset.m_image = in.path();
+        tileset.m_imagePath = in.path();
+        tileset.m_imageSize = in.vector2i();
+        tileset.m_margin = in.i32();
+        tileset.m_name = in.string();
+        tileset.m_spacing = in.i32();
+        tileset.m_tileCount = in.i32();
+        tileset.m_tileSize = in.vector2i();
+        tileset.m_transparentColor = in.color();
+        tileset.m_grid.m_orientation = in.string();
+        tileset.m_grid.m_size = in.vector2i();
+        tileset.m_classType = in.string();
+        tileset.m_tileOffset = in.vector2i();
+        tileset.m_tileRenderSize = static_cast<tson::TileRenderSize>(in.u8());
+        tileset.m_fillMode = static_cast<tson::FillMode>(in.u8());
+        tileset.m_objectAlignment = static_cast<tson::ObjectAlignment>(in.u8());
+        tileset.m_transformations.m_hflip = in.boolean();
+        tileset.m_transformations.m_preferuntransformed = in.boolean();
+        tileset.m_transformations.m_rotate = in.boolean();
+        tileset.m_transformations.m_vflip = in.boolean();
+        ReadProperties(in, tileset.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+
+        size_t const terrainCount = in.size(8);
+        tileset.m_terrains.clear();
+        for(size_t i = 0; i < terrainCount; ++i)
+        {
+            std::string name = in.string();
+            int const tile = in.i32();
+            tson::Terrain &terrain = tileset.m_terrains.emplace_back(std::move(name), tile);
+            ReadProperties(in, terrain.getProperties(), (map != nullptr) ? map->getProject() : nullptr);
+        }
+
+        tileset.m_wangsets.resize(in.size(1));
+        for(auto &wangset : tileset.m_wangsets)
+            ReadWangSet(in, wangset, map);
+
+        tileset.m_tiles.resize(in.size(1));
+        for(auto &tile : tileset.m_tiles)
+            ReadTile(in, tile, &tileset, map);
+
+        if(!in.ok())
+            return;
+
+        tileset.bind(map, tileset.m_firstgid);
+        for(auto &wangset : tileset.m_wangsets)
+            wangset.buildLookup(tileset.m_transformations, static_cast<uint32_t>(tileset.m_firstgid));
+    }
+
+    void MapSnapshot::WriteTile(Writer &out, tson::Tile &tile)
+    {
+        out.u32(tile.m_id);
+        out.path(tile.m_image);
+        out.vector2i(tile.m_imageSize);
+        out.rect(tile.m_subRect);
+        out.string(tile.m_type);
+        out.size(tile.m_terrain.size());
+        for(int terrain : tile.m_terrain)
+            out.i32(terrain);
+
+        const std::vector<tson::Frame> &frames = tile.m_animation.getFrames();
+        out.size(frames.size());
+        for(const auto &frame : frames)
+        {
+            out.i32(frame.getDuration());
+            out.u32(frame.getTileId());
+        }
+
+        WriteProperties(out, tile.m_properties);
+        WriteLayer(out, tile.m_objectgroup);
+    }
+
+    /*!
+     * Reads a tile. Its gid and drawing rect are calculated when its tileset is bound to the map.
+     */
+    void MapSnapshot::ReadTile(Reader &in, tson::Tile &tile, tson::Tileset *tileset, tson::Map *map)
+    {
+        tile.m_tileset = tileset;
+        tile.m_map = map;
+        tile.m_id = in.u32();
+        tile.m_image = in.path();
+        tile.m_imageSize = in.vector2i();
+        tile.m_subRect = in.rect();
+        tile.m_type = in.string();
+        tile.m_terrain.resize(in.size(4));
+        for(int &terrain : tile.m_terrain)
+            terrain = in.i32();
+
+        size_t const frameCount = in.size(8);
+        std::vector<tson::Frame> frames;
+        frames.reserve(frameCount);
+        for(size_t i = 0; i < frameCount; ++i)
+        {
+            int const duration = in.i32();
+            frames.emplace_back(duration, in.u32());
+        }
+        if(!frames.empty())
+            tile.m_animation.setFrames(frames);
+
+        ReadProperties(in, tile.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+        ReadLayer(in, tile.m_objectgroup, map);
+    }
+
+    void MapSnapshot::WriteWangSet(Writer &out, const tson::WangSet &wangset)
+    {
+        out.string(wangset.m_name);
+        out.i32(wangset.m_tile);
+        out.string(wangset.m_classType);
+        out.size(wangset.m_wangTiles.size());
+        for(const auto &wangTile : wangset.m_wangTiles)
+        {
+            out.boolean(wangTile.m_dflip);
+            out.boolean(wangTile.m_hflip);
+            out.u32(wangTile.m_tileid);
+            out.boolean(wangTile.m_vflip);
+            out.size(wangTile.m_wangId.size());
+            for(uint32_t id : wangTile.m_wangId)
+                out.u32(id);
+        }
+
+        for(const auto *colors : {&wangset.m_cornerColors, &wangset.m_edgeColors, &wangset.m_colors})
+        {
+            out.size(colors->size());
+            for(const auto &color : *colors)
+                WriteWangColor(out, color);
+        }
+        WriteProperties(out, wangset.m_properties);
+    }
+
+    /*!
+     * Reads a wang set. Its lookup is built when its tileset is read.
+     */
+    void MapSnapshot::ReadWangSet(Reader &in, tson::WangSet &wangset, tson::Map *map)
+    {
+        wangset.m_map = map;
+        wangset.m_name = in.string();
+        wangset.m_tile = in.i32();
+        wangset.m_classType = in.string();
+        wangset.m_wangTiles.resize(in.size(11));
+        for(auto &wangTile : wangset.m_wangTiles)
+        {
+            wangTile.m_dflip = in.boolean();
+            wangTile.m_hflip = in.boolean();
+            wangTile.m_tileid = in.u32();
+            wangTile.m_vflip = in.boolean();
+            wangTile.m_wangId.resize(in.size(4));
+            for(uint32_t &id : wangTile.m_wangId)
+                id = in.u32();
+        }
+
+        for(auto *colors : {&wangset.m_cornerColors, &wangset.m_edgeColors, &wangset.m_colors})
+        {
+            colors->resize(in.size(1));
+            for(auto &color : *colors)
+                ReadWangColor(in, color, map);
+        }
+        ReadProperties(in, wangset.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+    }
+
+    void MapSnapshot::WriteWangColor(Writer &out, const tson::WangColor &color)
+    {
+        out.color(color.m_color);
+        out.string(color.m_name);
+        out.f32(color.m_probability);
+        out.i32(color.m_tile);
+        out.string(color.m_classType);
+        WriteProperties(out, color.m_properties);
+    }
+
+    void MapSnapshot::ReadWangColor(Reader &in, tson::WangColor &color, tson::Map *map)
+    {
+        color.m_map = map;
+        color.m_color = in.color();
+        color.m_name = in.string();
+        color.m_probability = in.f32();
+        color.m_tile = in.i32();
+        color.m_classType = in.string();
+        ReadProperties(in, color.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+    }
+
+    void MapSnapshot::WriteProperties(Writer &out, const tson::PropertyCollection &properties)
+    {
+        out.string(properties.m_id);
+        out.size(properties.m_properties.size());
+        for(const auto &[name, property] : properties.m_properties)
+        {
+            out.string(name);
+            out.u8(static_cast<uint8_t>(property.m_type));
+            out.string(property.m_propertyType);
+            WriteValue(out, property.m_value);
+        }
+    }
+
+    void MapSnapshot::ReadProperties(Reader &in, tson::PropertyCollection &properties, tson::Project *project)
+    {
+        properties.m_id = in.string();
+        properties.m_properties.clear();
+        size_t const count = in.size(7);
+        for(size_t i = 0; i < count && in.ok(); ++i)
+        {
+            std::string name = in.string();
+            auto const type = static_cast<tson::Type>(in.u8());
+            std::string propertyType = in.string();
+            tson::Property property {name, ReadValue(in, project), type};
+            property.m_propertyType = std::move(propertyType);
+            property.m_project = project;
+            properties.m_properties[name] = std::move(property);
+        }
+    }
+
+    /*!
+     * Writes the value of a property, by its C++ type.
+     * Enum values store the name of their definition, and classes their members, so both can be resolved with the project when loading.
+     */
+    void MapSnapshot::WriteValue(Writer &out, const std::any &value)
+    {
+        const std::type_info &type = value.type();
+        if(type == typeid(int))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::Int));
+            out.i32(std::any_cast<int>(value));
+        }
+        else if(type == typeid(uint32_t))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::UInt));
+            out.u32(std::any_cast<uint32_t>(value));
+        }
+        else if(type == typeid(bool))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::Bool));
+            out.boolean(std::any_cast<bool>(value));
+        }
+        else if(type == typeid(float))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::Float));
+            out.f32(std::any_cast<float>(value));
+        }
+        else if(type == typeid(std::string))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::String));
+            out.string(std::any_cast<const std::string &>(value));
+        }
+        else if(type == typeid(fs::path))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::Path));
+            out.path(std::any_cast<const fs::path &>(value));
+        }
+        else if(type == typeid(tson::Colori))
+        {
+            out.u8(static_cast<uint8_t>(ValueKind::Color));
+            out.color(std::any_cast<const tson::Colori &>(value));
+        }
+        else if(type == typeid(tson::EnumValue))
+        {
+            const auto &enumValue = std::any_cast<const tson::EnumValue &>(value);
+            out.u8(static_cast<uint8_t>(ValueKind::Enum));
+            out.u32(enumValue.getValue());
+            out.string((enumValue.getDefinition() != nullptr) ? enumValue.getDefinition()->getName() : std::string());
+        }
+        else if(type == typeid(tson::TiledClass))
+        {
+            const auto &tiledClass = std::any_cast<const tson::TiledClass &>(value);
+            out.u8(static_cast<uint8_t>(ValueKind::Class));
+            out.u32(tiledClass.m_id);
+            out.string(tiledClass.m_name);
+            out.string(tiledClass.m_type);
+            WriteProperties(out, tiledClass.m_members);
+        }
+        else
+            out.u8(static_cast<uint8_t>(ValueKind::None));
+    }
+
+    std::any MapSnapshot::ReadValue(Reader &in, tson::Project *project)
+    {
+        switch(static_cast<ValueKind>(in.u8()))
+        {
+            case ValueKind::Int:
+                return in.i32();
+
+            case ValueKind::UInt:
+                return in.u32();
+
+            case ValueKind::Bool:
+                return in.boolean();
+
+            case ValueKind::Float:
+                return in.f32();
+
+            case ValueKind::String:
+                return in.string();
+
+            case ValueKind::Path:
+                return in.path();
+
+            case ValueKind::Color:
+                return in.color();
+
+            case ValueKind::Enum:
+            {
+                uint32_t const value = in.u32();
+                std::string definitionName = in.string();
+                tson::EnumDefinition *definition = (project != nullptr) ? project->getEnumDefinition(definitionName) : nullptr;
+                return (definition != nullptr) ? tson::EnumValue(value, definition) : tson::EnumValue();
+            }
+
+            case ValueKind::Class:
+            {
+                tson::TiledClass tiledClass;
+                tiledClass.m_id = in.u32();
+                tiledClass.m_name = in.string();
+                tiledClass.m_type = in.string();
+                ReadProperties(in, tiledClass.m_members, project);
+                return tiledClass;
+            }
+
+            default:
+                return {};
+        }
+    }
+}
+
+#endif //TILESON_MAPSNAPSHOT_HPP
@@ -0,0 +1,510 @@
+#ifndef TILESON_MAPVIEW_HPP
+#define TILESON_MAPVIEW_HPP
+
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace tson
+{
+    /*!
+     * The records of a table in a flat map, as views. Views are created when they are accessed.
+     * @tparam View A view with a 'Record' type, constructed from the data and a record
+     */
+    template <typename View>
+    class TableView
+    {
+        public:
+            using Record = typename View::Record;
+
+            class Iterator
+            {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = View;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = View;
+
+                    inline Iterator(const TableView *table, size_t index) : m_table {table}, m_index {index} {}
+                    inline View operator*() const { return (*m_table)[m_index]; }
+                    inline Iterator &operator++() { ++m_index; return *this; }
+                    inline Iterator operator++(int) { Iterator it = *this; ++m_index; return it; }
+                    inline bool operator==(const Iterator &other) const { return m_index == other.m_index && m_table == other.m_table; }
+                    inline bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+                private:
+                    const TableView *m_table;
+                    size_t m_index;
+            };
+
+            inline TableView() = default;
+            inline TableView(const FlatMap::Data &data, const FlatMap::Table &table) : m_data {data}, m_table {table}, m_size {data.count<Record>(table)} {}
+
+            [[nodiscard]] inline size_t size() const { return m_size; }
+            [[nodiscard]] inline bool empty() const { return m_size == 0; }
+            inline View operator[](size_t index) const { return View(m_data, m_data.record<Record>(m_table, index)); }
+            [[nodiscard]] inline Iterator begin() const { return Iterator(this, 0); }
+            [[nodiscard]] inline Iterator end() const { return Iterator(this, m_size); }
+
+        private:
+            FlatMap::Data m_data;
+            FlatMap::Table m_table {};
+            size_t m_size {0};
+    };
+
+    /*!
+     * A property in a flat map. Like tson::Property, but the value is read with the getter of its type.
+     */
+    class PropertyView
+    {
+        public:
+            using Record = FlatMap::PropertyRecord;
+
+            inline PropertyView() = default;
+            inline PropertyView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+            inline static PropertyView Find(const TableView<PropertyView> &properties, std::string_view name);
+
+            [[nodiscard]] inline bool isValid() const { return m_valid; }
+            [[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+            [[nodiscard]] inline tson::Type getType() const { return static_cast<tson::Type>(m_record.type); }
+            [[nodiscard]] inline std::string_view getPropertyType() const { return m_data.string(m_record.propertyType); }
+            [[nodiscard]] inline FlatMap::ValueKind getValueKind() const { return static_cast<FlatMap::ValueKind>(m_record.kind); }
+
+            [[nodiscard]] inline int getInt() const { return static_cast<int>(m_record.value); }
+            [[nodiscard]] inline uint32_t getUInt() const { return m_record.value; }
+            [[nodiscard]] inline bool getBool() const { return m_record.value != 0; }
+            [[nodiscard]] inline float getFloat() const;
+            [[nodiscard]] inline tson::Colori getColor() const { return FlatMap::UnpackColor(m_record.value); }
+            [[nodiscard]] inline std::string_view getString() const { return m_data.string(m_record.string); }
+            [[nodiscard]] inline uint32_t getEnumValue() const { return m_record.value; }
+
+            [[nodiscard]] inline TableView<PropertyView> getMembers() const { return {m_data, m_record.members}; }
+            [[nodiscard]] inline PropertyView getMember(std::string_view name) const { return Find(getMembers(), name); }
+
+        private:
+            FlatMap::Data m_data;
+            Record m_record {};
+            bool m_valid {false};
+    };
+
+    /*!
+     * An object in a flat map
+     */
+    class ObjectView
+    {
+        public:
+            using Record = FlatMap::ObjectRecord;
+
+            inline ObjectView() = default;
+            inline ObjectView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+            [[nodiscard]] inline bool isValid() const { return m_valid; }
+            [[nodiscard]] inline int getId() const { return m_record.id; }
+            [[nodiscard]] inline tson::ObjectType getObjectType() const { return static_cast<tson::ObjectType>(m_record.objectType); }
+            [[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+            [[nodiscard]] inline std::string_view getType() const { return m_data.string(m_record.type); }
+            [[nodiscard]] inline std::string_view getClassType() const { return getType(); }
+            [[nodiscard]] inline std::string_view getTemplate() const { return m_data.string(m_record.templ); }
+            [[nodiscard]] inline std::string_view getText() const { return m_data.string(m_record.text); }
+            [[nodiscard]] inline tson::Vector2i getPosition() const { return {m_record.x, m_record.y}; }
+            [[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+            [[nodiscard]] inline float getRotation() const { return m_record.rotation; }
+            [[nodiscard]] inline uint32_t getGid() const { return m_record.gid; }
+            [[nodiscard]] inline tson::TileFlipFlags getFlipFlags() const { return static_cast<tson::TileFlipFlags>(m_record.flipFlags); }
+            [[nodiscard]] inline bool isVisible() const { return (m_record.flags & FlatMap::ObjectVisible) != 0; }
+            [[nodiscard]] inline bool isEllipse() const { return (m_record.flags & FlatMap::ObjectEllipse) != 0; }
+            [[nodiscard]] inline bool isPoint() const { return (m_record.flags & FlatMap::ObjectPoint) != 0; }
+            [[nodiscard]] inline std::vector<tson::Vector2i> getPolygons() const { return getPoints(m_record.polygon); }
+            [[nodiscard]] inline std::vector<tson::Vector2i> getPolylines() const { return getPoints(m_record.polyline); }
+
+            [[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+            [[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
+
+        private:
+            inline std::vector<tson::Vector2i> getPoints(const FlatMap::Table &table) const;
+
+            FlatMap::Data m_data;
+            Record m_record {};
+            bool m_valid {false};
+    };
+
+    /*!
+     * A chunk of a tile layer of an infinite map
+     */
+    class ChunkView
+    {
+        public:
+            using Record = FlatMap::ChunkRecord;
+
+            inline ChunkView() = default;
+            inline ChunkView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record} {}
+
+            [[nodiscard]] inline tson::Vector2i getPosition() const { return {m_record.x, m_record.y}; }
+            [[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+            [[nodiscard]] inline size_t getDataSize() const { return m_data.count<uint32_t>(m_record.data); }
+            [[nodiscard]] inline uint32_t getGid(size_t index) const { return m_data.record<uint32_t>(m_record.data, index); }
+
+        private:
+            FlatMap::Data m_data;
+            Record m_record {};
+    };
+
+    /*!
+     * A layer in a flat map. The gids are read directly from the mapped data.
+     */
+    class LayerView
+    {
+        public:
+            using Record = FlatMap::LayerRecord;
+
+            inline LayerView() = default;
+            inline LayerView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+            [[nodiscard]] inline bool isValid() const { return m_valid; }
+            [[nodiscard]] inline int getId() const { return m_record.id; }
+            [[nodiscard]] inline tson::LayerType getType() const { return static_cast<tson::LayerType>(m_record.type); }
+            [[nodiscard]] inline std::string_view getTypeStr() const { return m_data.string(m_record.typeStr); }
+            [[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+            [[nodiscard]] inline std::string_view getClassType() const { return m_data.string(m_record.classType); }
+            [[nodiscard]] inline std::string_view getImage() const { return m_data.string(m_record.image); }
+            [[nodiscard]] inline std::string_view getDrawOrder() const { return m_data.string(m_record.drawOrder); }
+            [[nodiscard]] inline int getX() const { return m_record.x; }
+            [[nodiscard]] inline int getY() const { return m_record.y; }
+            [[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+            [[nodiscard]] inline tson::Vector2f getOffset() const { return {m_record.offsetX, m_record.offsetY}; }
+            [[nodiscard]] inline float getOpacity() const { return m_record.opacity; }
+            [[nodiscard]] inline tson::Vector2f getParallax() const { return {m_record.parallaxX, m_record.parallaxY}; }
+            [[nodiscard]] inline bool isVisible() const { return (m_record.flags & FlatMap::LayerVisible) != 0; }
+            [[nodiscard]] inline bool hasTintColor() const { return (m_record.flags & FlatMap::LayerHasTintColor) != 0; }
+            [[nodiscard]] inline bool hasRepeatX() const { return (m_record.flags & FlatMap::LayerRepeatX) != 0; }
+            [[nodiscard]] inline bool hasRepeatY() const { return (m_record.flags & FlatMap::LayerRepeatY) != 0; }
+            [[nodiscard]] inline bool hasRegion() const { return (m_record.flags & FlatMap::LayerHasRegion) != 0; }
+            [[nodiscard]] inline tson::Vector2i getRegionOrigin() const { return {m_record.regionX, m_record.regionY}; }
+            [[nodiscard]] inline tson::Colori getTintColor() const { return FlatMap::UnpackColor(m_record.tintColor); }
+            [[nodiscard]] inline tson::Colori getTransparentColor() const { return FlatMap::UnpackColor(m_record.transparentColor); }
+
+            [[nodiscard]] inline size_t getDataSize() const { return m_data.count<uint32_t>(m_record.data); }
+            [[nodiscard]] inline uint32_t getGid(size_t index) const { return m_data.record<uint32_t>(m_record.data, index); }
+            [[nodiscard]] inline uint32_t getGid(int x, int y) const;
+
+            [[nodiscard]] inline TableView<ChunkView> getChunks() const { return {m_data, m_record.chunks}; }
+            [[nodiscard]] inline TableView<ObjectView> getObjects() const { return {m_data, m_record.objects}; }
+            [[nodiscard]] inline TableView<LayerView> getLayers() const { return {m_data, m_record.layers}; }
+            [[nodiscard]] inline ObjectView firstObj(std::string_view name) const;
+            [[nodiscard]] inline LayerView getLayer(std::string_view name) const;
+
+            [[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+            [[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
+
+        private:
+            FlatMap::Data m_data;
+            Record m_record {};
+            bool m_valid {false};
+    };
+
+    /*!
+     * A tile of a tileset in a flat map. Only exists for tiles with more data than their id.
+     */
+    class TileView
+    {
+        public:
+            using Record = FlatMap::TileRecord;
+
+            inline TileView() = default;
+            inline TileView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+            [[nodiscard]] inline bool isValid() const { return m_valid; }
+            [[nodiscard]] inline uint32_t getId() const { return m_record.id; }
+            [[nodiscard]] inline uint32_t getGid() const { return m_record.gid; }
+            [[nodiscard]] inline std::string_view getImage() const { return m_data.string(m_record.image); }
+            [[nodiscard]] inline std::string_view getType() const { return m_data.string(m_record.type); }
+            [[nodiscard]] inline std::string_view getClassType() const { return getType(); }
+            [[nodiscard]] inline tson::Vector2i getImageSize() const { return {m_record.imageWidth, m_record.imageHeight}; }
+            [[nodiscard]] inline tson::Rect getSubRectangle() const { return {m_record.subX, m_record.subY, m_record.subWidth, m_record.subHeight}; }
+            [[nodiscard]] inline std::vector<tson::Frame> getFrames() const;
+            [[nodiscard]] inline TableView<ObjectView> getObjects() const { return {m_data, m_record.objects}; }
+
+            [[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+            [[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
+
+        private:
+            FlatMap::Data m_data;
+            Record m_record {};
+            bool m_valid {false};
+    };
+
+    /*!
+     * A tileset in a flat map
+     */
+    class TilesetView
+    {
+        public:
+            using Record = FlatMap::TilesetRecord;
+
+            inline TilesetView() = default;
+            inline TilesetView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+            [[nodiscard]] inline bool isValid() const { return m_valid; }
+            [[nodiscard]] inline int getFirstgid() const { return m_record.firstgid; }
+            [[nodiscard]] inline tson::TilesetType getType() const { return static_cast<tson::TilesetType>(m_record.type); }
+            [[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+            [[nodiscard]] inline std::string_view getImage() const { return m_data.string(m_record.image); }
+            [[nodiscard]] inline std::string_view getFullImagePath() const { return m_data.string(m_record.fullImagePath); }
+            [[nodiscard]] inline std::string_view getClassType() const { return m_data.string(m_record.classType); }
+            [[nodiscard]] inline tson::Vector2i getImageSize() const { return {m_record.imageWidth, m_record.imageHeight}; }
+            [[nodiscard]] inline tson::Vector2i getTileSize() const { return {m_record.tileWidth, m_record.tileHeight}; }
+            [[nodiscard]] inline int getTileCount() const { return m_record.tileCount; }
+            [[nodiscard]] inline int getColumns() const { return m_record.columns; }
+            [[nodiscard]] inline int getMargin() const { return m_record.margin; }
+            [[nodiscard]] inline int getSpacing() const { return m_record.spacing; }
+            [[nodiscard]] inline tson::Vector2i getTileOffset() const { return {m_record.tileOffsetX, m_record.tileOffsetY}; }
+            [[nodiscard]] inline tson::Colori getTransparentColor() const { return FlatMap::UnpackColor(m_record.transparentColor); }
+
+            [[nodiscard]] inline TableView<TileView> getTiles() const { return {m_data, m_record.tiles}; }
+            [[nodiscard]] inline TileView getTile(uint32_t id) const;
+
+            [[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+            [[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
+
+        private:
+            FlatMap::Data m_data;
+            Record m_record {};
+            bool m_valid {false};
+    };
+
+    /*!
+     * A flat map (tson::FlatMap), used where it is in memory. Nothing is copied or allocated when it is opened:
+     * Every view reads its record when it is accessed.
+     *
+     * The view does not own the memory, which must outlive the view and every view created from it.
+     *
+     * Example:
+     * tson::MappedFile file {"map.tsonf"};
+     * tson::MapView map {file.data(), file.size()};
+     * if(map.isValid())
+     * {
+     *     for(tson::LayerView layer : map.getLayers())
+     *         ...
+     * }
+     */
+    class MapView
+    {
+        public:
+            inline MapView() = default;
+            inline MapView(const void *data, size_t size);
+
+            [[nodiscard]] inline bool isValid() const { return m_valid; }
+            [[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+            [[nodiscard]] inline tson::Vector2i getTileSize() const { return {m_record.tileWidth, m_record.tileHeight}; }
+            [[nodiscard]] inline std::string_view getOrientation() const { return m_data.string(m_record.orientation); }
+            [[nodiscard]] inline std::string_view getRenderOrder() const { return m_data.string(m_record.renderOrder); }
+            [[nodiscard]] inline std::string_view getStaggerAxis() const { return m_data.string(m_record.staggerAxis); }
+            [[nodiscard]] inline std::string_view getStaggerIndex() const { return m_data.string(m_record.staggerIndex); }
+            [[nodiscard]] inline std::string_view getTiledVersion() const { return m_data.string(m_record.tiledVersion); }
+            [[nodiscard]] inline std::string_view getType() const { return m_data.string(m_record.type); }
+            [[nodiscard]] inline std::string_view getClassType() const { return m_data.string(m_record.classType); }
+            [[nodiscard]] inline bool isInfinite() const { return m_record.infinite != 0; }
+            [[nodiscard]] inline tson::Colori getBackgroundColor() const { return FlatMap::UnpackColor(m_record.backgroundColor); }
+            [[nodiscard]] inline int getHexsideLength() const { return m_record.hexsideLength; }
+            [[nodiscard]] inline int getNextLayerId() const { return m_record.nextLayerId; }
+            [[nodiscard]] inline int getNextObjectId() const { return m_record.nextObjectId; }
+            [[nodiscard]] inline tson::Vector2f getParallaxOrigin() const { return {m_record.parallaxOriginX, m_record.parallaxOriginY}; }
+
+            [[nodiscard]] inline TableView<LayerView> getLayers() const { return {m_data, m_record.layers}; }
+            [[nodiscard]] inline LayerView getLayer(std::string_view name) const;
+            [[nodiscard]] inline TableView<TilesetView> getTilesets() const { return {m_data, m_record.tilesets}; }
+            [[nodiscard]] inline TilesetView getTileset(std::string_view name) const;
+            [[nodiscard]] inline TilesetView getTilesetByGid(uint32_t gid) const;
+
+            [[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+            [[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
+
+        private:
+            FlatMap::Data m_data;
+            FlatMap::MapRecord m_record {};
+            bool m_valid {false};
+    };
+
+    /*!
+     * Finds a property by name. Properties are sorted by name, so this is a binary search.
+     * @return The property. Not valid if it does not exist.
+     */
+    PropertyView PropertyView::Find(const TableView<PropertyView> &properties, std::string_view name)
+    {
+        size_t first = 0;
+        size_t last = properties.size();
+        while(first < last)
+        {
+            size_t const middle = first + (last - first) / 2;
+            PropertyView property = properties[middle];
+            std::string_view const current = property.getName();
+            if(current == name)
+                return property;
+            if(current < name)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return {};
+    }
+
+    float PropertyView::getFloat() const
+    {
+        float value;
+        std::memcpy(&value, &m_record.value, sizeof(value));
+        return value;
+    }
+
+    std::vector<tson::Vector2i> ObjectView::getPoints(const FlatMap::Table &table) const
+    {
+        size_t const count = m_data.count<FlatMap::PointRecord>(table);
+        std::vector<tson::Vector2i> points;
+        points.reserve(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            auto const point = m_data.record<FlatMap::PointRecord>(table, i);
+            points.emplace_back(point.x, point.y);
+        }
+        return points;
+    }
+
+    /*!
+     * The gid at a tile position in the map, flip flags included. 0 if the position is outside the layer,
+     * or outside the decoded region when hasRegion() is true.
+     */
+    uint32_t LayerView::getGid(int x, int y) const
+    {
+        x -= m_record.regionX;
+        y -= m_record.regionY;
+        if(x < 0 || y < 0 || x >= m_record.width || y >= m_record.height)
+            return 0;
+        return getGid(static_cast<size_t>(y) * static_cast<size_t>(m_record.width) + static_cast<size_t>(x));
+    }
+
+    /*!
+     * The first object with a name. Not valid if there is none.
+     */
+    ObjectView LayerView::firstObj(std::string_view name) const
+    {
+        for(ObjectView object : getObjects())
+        {
+            if(object.getName() == name)
+                return object;
+        }
+        return {};
+    }
+
+    /*!
+     * A child layer of a group layer, by name. Not valid if there is none.
+     */
+    LayerView LayerView::getLayer(std::string_view name) const
+    {
+        for(LayerView layer : getLayers())
+        {
+            if(layer.getName() == name)
+                return layer;
+        }
+        return {};
+    }
+
+    /*!
+     * The animation of the tile, copied to tson::Frames
+     */
+    std::vector<tson::Frame> TileView::getFrames() const
+    {
+        size_t const count = m_data.count<FlatMap::FrameRecord>(m_record.animation);
+        std::vector<tson::Frame> frames;
+        frames.reserve(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            auto const frame = m_data.record<FlatMap::FrameRecord>(m_record.animation, i);
+            frames.emplace_back(frame.duration, frame.tileId);
+        }
+        return frames;
+    }
+
+    /*!
+     * A tile by id (the local id + 1, like tson::Tileset::getTile()). Tiles are sorted by id, so this is a binary search.
+     * @return The tile. Not valid if the tile has no data other than its id.
+     */
+    TileView TilesetView::getTile(uint32_t id) const
+    {
+        TableView<TileView> tiles = getTiles();
+        size_t first = 0;
+        size_t last = tiles.size();
+        while(first < last)
+        {
+            size_t const middle = first + (last - first) / 2;
+            TileView tile = tiles[middle];
+            if(tile.getId() == id)
+                return tile;
+            if(tile.getId() < id)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return {};
+    }
+
+    /*!
+     * Opens a flat map in memory
+     * @param data The flat map. Must outlive the view.
+     * @param size Size of the data
+     */
+    MapView::MapView(const void *data, size_t size)
+    {
+        FlatMap::Header header {};
+        if(!FlatMap::ReadHeader(data, size, header))
+            return;
+
+        m_data = FlatMap::Data(static_cast<const uint8_t *>(data), header.size, header.strings, header.stringsSize);
+        m_record = m_data.record<FlatMap::MapRecord>(header.map);
+        m_valid = true;
+    }
+
+    /*!
+     * A layer by name. Not valid if there is none.
+     */
+    LayerView MapView::getLayer(std::string_view name) const
+    {
+        for(LayerView layer : getLayers())
+        {
+            if(layer.getName() == name)
+                return layer;
+        }
+        return {};
+    }
+
+    /*!
+     * A tileset by name. Not valid if there is none.
+     */
+    TilesetView MapView::getTileset(std::string_view name) const
+    {
+        for(TilesetView tileset : getTilesets())
+        {
+            if(tileset.getName() == name)
+                return tileset;
+        }
+        return {};
+    }
+
+    /*!
+     * The tileset a gid (without flip flags) belongs to. Not valid if there is none.
+     */
+    TilesetView MapView::getTilesetByGid(uint32_t gid) const
+    {
+        for(TilesetView tileset : getTilesets())
+        {
+            auto const firstId = static_cast<uint32_t>(tileset.getFirstgid());
+            auto const lastId = static_cast<uint32_t>(firstId + tileset.getTileCount()) - 1;
+            if(gid >= firstId && gid <= lastId)
+                return tileset;
+        }
+        return {};
+    }
+}
+
+#endif //TILESON_MAPVIEW_HPP
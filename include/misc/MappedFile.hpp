@@ -0,0 +1,190 @@
+#ifndef TILESON_MAPPEDFILE_HPP
+#define TILESON_MAPPEDFILE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define TILESON_HAS_MMAP 1
+#endif
+
+namespace tson
+{
+    /*!
+     * A read-only file mapped into memory. Processes mapping the same file share its pages through the page cache,
+     * so the file is only in memory once, however many processes use it.
+     *
+     * On platforms without mmap() the file is read into memory instead.
+     *
+     * Example:
+     * tson::MappedFile file {"map.tsonf"};
+     * tson::MapView map {file.data(), file.size()};
+     */
+    class MappedFile
+    {
+        public:
+            inline MappedFile() = default;
+            inline explicit MappedFile(const fs::path &path);
+            inline ~MappedFile();
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+            inline MappedFile(MappedFile &&other) noexcept;
+            inline MappedFile &operator=(MappedFile &&other) noexcept;
+
+            inline bool open(const fs::path &path);
+            inline void close();
+
+            [[nodiscard]] inline const uint8_t *data() const;
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline bool isOpen() const;
+            [[nodiscard]] inline bool isMapped() const;
+
+        private:
+            inline bool read(const fs::path &path);
+
+            const uint8_t *         m_data {nullptr};
+            size_t                  m_size {0};
+            bool                    m_isMapped {false};   /*! true if m_data is mapped, false if it points to m_buffer */
+            std::vector<uint8_t>    m_buffer;             /*! The file, when it could not be mapped */
+    };
+
+    MappedFile::MappedFile(const fs::path &path)
+    {
+        open(path);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            m_buffer = std::move(other.m_buffer);
+            m_data = (other.m_isMapped) ? other.m_data : m_buffer.data();
+            m_size = other.m_size;
+            m_isMapped = other.m_isMapped;
+            other.m_data = nullptr;
+            other.m_size = 0;
+            other.m_isMapped = false;
+        }
+        return *this;
+    }
+
+    /*!
+     * Maps a file, closing the file that was open
+     * @return false if the file could not be opened
+     */
+    bool MappedFile::open(const fs::path &path)
+    {
+        close();
+        #ifdef TILESON_HAS_MMAP
+        int const file = ::open(path.c_str(), O_RDONLY);
+        if(file < 0)
+            return false;
+
+        struct stat status {};
+        if(::fstat(file, &status) != 0)
+        {
+            ::close(file);
+            return false;
+        }
+
+        //An empty file cannot be mapped
+        if(status.st_size > 0)
+        {
+            void *mapped = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+            if(mapped != MAP_FAILED)
+            {
+                m_data = static_cast<const uint8_t *>(mapped);
+                m_size = static_cast<size_t>(status.st_size);
+                m_isMapped = true;
+            }
+        }
+        ::close(file);
+        if(m_isMapped)
+            return true;
+        #endif
+
+        return read(path);
+    }
+
+    /*!
+     * Unmaps the file
+     */
+    void MappedFile::close()
+    {
+        #ifdef TILESON_HAS_MMAP
+        if(m_isMapped)
+            ::munmap(const_cast<uint8_t *>(m_data), m_size);
+        #endif
+        m_data = nullptr;
+        m_size = 0;
+        m_isMapped = false;
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+    }
+
+    bool MappedFile::read(const fs::path &path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file)
+            return false;
+
+        std::streamoff const size = file.tellg();
+        if(size < 0)
+            return false;
+        m_buffer.resize(static_cast<size_t>(size));
+        file.seekg(0, std::ios::beg);
+        if(!file.read(reinterpret_cast<char *>(m_buffer.data()), size))
+        {
+            m_buffer.clear();
+            return false;
+        }
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+    /*!
+     * The contents of the file. nullptr if no file is open.
+     */
+    const uint8_t *MappedFile::data() const
+    {
+        return m_data;
+    }
+
+    size_t MappedFile::size() const
+    {
+        return m_size;
+    }
+
+    bool MappedFile::isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    /*!
+     * true if the file is mapped, and not read into memory
+     */
+    bool MappedFile::isMapped() const
+    {
+        return m_isMapped;
+    }
+}
+
+#endif //TILESON_MAPPEDFILE_HPP
@@ -0,0 +1,742 @@
+#ifndef TILESON_NAVIGATIONGRID_HPP
+#define TILESON_NAVIGATIONGRID_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace tson
+{
+    class NavigationGrid;
+
+    /*!
+     * The memory used by a path search of tson::NavigationGrid.
+     *
+     * The buffers are sized on the first search, and reused afterwards without being cleared (a generation counter tells which
+     * entries belong to the current search), so searches on the same grid do not allocate.
+     * A context may only be used by one search at a time: Give every worker thread its own context.
+     */
+    class NavigationContext
+    {
+        public:
+            inline NavigationContext() = default;
+
+            [[nodiscard]] inline size_t getExpandedNodes() const;
+
+        private:
+            friend class NavigationGrid;
+
+            inline void prepare(size_t cellCount);
+            inline void push(uint32_t estimatedCost, uint32_t node);
+            inline uint32_t pop();
+            inline void relax(uint32_t node, uint32_t parent, uint32_t cost, uint32_t estimatedCost);
+            [[nodiscard]] inline bool isClosed(uint32_t node) const;
+
+            std::vector<uint32_t>   m_costs;        /*! Cost from the start to each node */
+            std::vector<uint32_t>   m_parents;
+            std::vector<uint32_t>   m_seen;         /*! Generation in which the node got a cost */
+            std::vector<uint32_t>   m_closed;       /*! Generation in which the node was expanded */
+            std::vector<std::pair<uint32_t, uint32_t>> m_open; /*! Binary min-heap of (estimated total cost, node) */
+            uint32_t                m_generation {0};
+            size_t                  m_expandedNodes {0};
+    };
+
+    /*!
+     * Number of nodes expanded by the last search
+     */
+    size_t NavigationContext::getExpandedNodes() const
+    {
+        return m_expandedNodes;
+    }
+
+    void NavigationContext::prepare(size_t cellCount)
+    {
+        if(m_costs.size() != cellCount)
+        {
+            m_costs.assign(cellCount, 0);
+            m_parents.assign(cellCount, 0);
+            m_seen.assign(cellCount, 0);
+            m_closed.assign(cellCount, 0);
+            m_generation = 0;
+        }
+
+        if(++m_generation == 0)
+        {
+            std::fill(m_seen.begin(), m_seen.end(), 0);
+            std::fill(m_closed.begin(), m_closed.end(), 0);
+            m_generation = 1;
+        }
+        m_open.clear();
+        m_expandedNodes = 0;
+    }
+
+    void NavigationContext::push(uint32_t estimatedCost, uint32_t node)
+    {
+        m_open.emplace_back(estimatedCost, node);
+        std::push_heap(m_open.begin(), m_open.end(), std::greater<>());
+    }
+
+    uint32_t NavigationContext::pop()
+    {
+        std::pop_heap(m_open.begin(), m_open.end(), std::greater<>());
+        uint32_t const node = m_open.back().second;
+        m_open.pop_back();
+        return node;
+    }
+
+    /*!
+     * Gives the node a new cost when it is cheaper than what it had. Nodes are pushed again rather than updated in the heap,
+     * and the outdated entries are skipped when they come out.
+     */
+    void NavigationContext::relax(uint32_t node, uint32_t parent, uint32_t cost, uint32_t estimatedCost)
+    {
+        if(m_closed[node] == m_generation || (m_seen[node] == m_generation && m_costs[node] <= cost))
+            return;
+
+        m_seen[node] = m_generation;
+        m_costs[node] = cost;
+        m_parents[node] = parent;
+        push(cost + estimatedCost, node);
+    }
+
+    bool NavigationContext::isClosed(uint32_t node) const
+    {
+        return m_closed[node] == m_generation;
+    }
+
+    /*!
+     * A walkability grid in tile units, compiled from the tile layers of a map, with A* and Jump Point Search.
+     *
+     * A cell is blocked when a tile in one of the selected layers matches the predicate given in the constructor
+     * (a property, "solid" by default, or a set of gids). Empty cells are walkable. The grid is stored as a bitset.
+     *
+     * Isometric maps are searched in tile coordinates, just like orthogonal maps. Staggered and hexagonal maps use the
+     * neighbours of their stagger axis and index. Searches only read the grid, so any number of threads can search at once,
+     * as long as every thread has its own tson::NavigationContext.
+     *
+     * Example:
+     * tson::NavigationGrid grid;
+     * grid.build(*map, {"Walls"});
+     * tson::NavigationContext context;
+     * std::vector<tson::Vector2i> path;
+     * if(grid.findPath(context, {1, 1}, {20, 14}, path))
+     *     ...
+     */
+    class NavigationGrid
+    {
+        public:
+            inline NavigationGrid() = default;
+            inline explicit NavigationGrid(std::string propertyName);
+            inline explicit NavigationGrid(std::set<uint32_t> gids);
+
+            inline void build(tson::Map &map, const std::vector<std::string> &layerNames = {});
+            inline void create(const tson::Rect &bounds, tson::NavigationTopology topology = tson::NavigationTopology::Orthogonal,
+                               bool staggerX = false, bool staggerEven = false);
+
+            inline void setWalkable(int x, int y, bool walkable);
+            inline void setDiagonalMovement(bool diagonalMovement);
+
+            [[nodiscard]] inline bool isWalkable(int x, int y) const;
+            [[nodiscard]] inline bool isDiagonalMovement() const;
+            [[nodiscard]] inline const tson::Rect &getBounds() const;
+            [[nodiscard]] inline tson::NavigationTopology getTopology() const;
+
+            inline bool findPath(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+                                 std::vector<tson::Vector2i> &path) const;
+            inline bool findPathJps(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+                                    std::vector<tson::Vector2i> &path) const;
+
+            static constexpr uint32_t StraightCost = 10;    /*! Cost of a move to a neighbour sharing an edge */
+            static constexpr uint32_t DiagonalCost = 14;    /*! Cost of a move to a neighbour sharing a corner */
+
+        private:
+            inline void collectLayers(std::vector<tson::Layer> &layers, const std::vector<std::string> &layerNames, std::vector<tson::Layer *> &result);
+            inline void createBlockingTable(tson::Map &map, std::vector<uint8_t> &blockingGids) const;
+
+            [[nodiscard]] inline uint32_t toIndex(int x, int y) const;
+            [[nodiscard]] inline tson::Vector2i toPosition(uint32_t index) const;
+            [[nodiscard]] inline bool isShifted(int row) const;
+            [[nodiscard]] inline uint32_t getEstimatedCost(const tson::Vector2i &from, const tson::Vector2i &to) const;
+            [[nodiscard]] inline uint32_t getOctileCost(int dx, int dy) const;
+
+            template <typename Func>
+            inline void forEachNeighbour(int x, int y, Func &&func) const;
+
+            inline bool jump(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const;
+            inline bool jumpStraight(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const;
+            inline void createPath(const tson::NavigationContext &context, uint32_t start, uint32_t goal, bool fillGaps,
+                                   std::vector<tson::Vector2i> &path) const;
+
+            std::string                 m_propertyName {"solid"};
+            std::set<uint32_t>          m_gids;
+
+            tson::Rect                  m_bounds {};
+            tson::NavigationTopology    m_topology {tson::NavigationTopology::Orthogonal};
+            bool                        m_staggerX {false};
+            bool                        m_staggerEven {false};
+            bool                        m_diagonalMovement {true};
+            std::vector<uint64_t>       m_walkable;     /*! One bit per cell, row-major. 1 = walkable */
+    };
+
+    /*!
+     * Tiles having a property with this name block the cell. Boolean properties must also be true.
+     * @param propertyName Name of the property
+     */
+    NavigationGrid::NavigationGrid(std::string propertyName) : m_propertyName {std::move(propertyName)}
+    {
+
+    }
+
+    /*!
+     * Tiles with one of these gids block the cell.
+     * @param gids Gids without flip flags
+     */
+    NavigationGrid::NavigationGrid(std::set<uint32_t> gids) : m_gids {std::move(gids)}
+    {
+
+    }
+
+    /*!
+     * Compiles the grid from the tile layers of a map. The topology is taken from the orientation and stagger settings of the map,
+     * and the bounds are the size of the map (or all chunks of the selected layers, for infinite maps).
+     * @param map The map
+     * @param layerNames Names of the tile layers to use, including layers inside groups. Empty (default) uses all tile layers.
+     */
+    void NavigationGrid::build(tson::Map &map, const std::vector<std::string> &layerNames)
+    {
+        tson::NavigationTopology topology = tson::NavigationTopology::Orthogonal;
+        if(map.getOrientation() == "staggered")
+            topology = tson::NavigationTopology::Staggered;
+        else if(map.getOrientation() == "hexagonal")
+            topology = tson::NavigationTopology::Hexagonal;
+
+        std::vector<tson::Layer *> layers;
+        collectLayers(map.getLayers(), layerNames, layers);
+
+        tson::Rect bounds {0, 0, map.getSize().x, map.getSize().y};
+        if(map.isInfinite())
+        {
+            bool first = true;
+            for(tson::Layer *layer : layers)
+            {
+                tson::Rect const layerBounds = layer->getTileBounds();
+                if(layerBounds.width <= 0 || layerBounds.height <= 0)
+                    continue;
+
+                if(first)
+                    bounds = layerBounds;
+                else
+                {
+                    int const right = std::max(bounds.x + bounds.width, layerBounds.x + layerBounds.width);
+                    int const bottom = std::max(bounds.y + bounds.height, layerBounds.y + layerBounds.height);
+                    bounds.x = std::min(bounds.x, layerBounds.x);
+                    bounds.y = std::min(bounds.y, layerBounds.y);
+                    bounds.width = right - bounds.x;
+                    bounds.height = bottom - bounds.y;
+                }
+                first = false;
+            }
+            if(first)
+                bounds = {};
+        }
+
+        create(bounds, topology, map.getStaggerAxis() == "x", map.getStaggerIndex() == "even");
+
+        std::vector<uint8_t> blockingGids;
+        createBlockingTable(map, blockingGids);
+        if(blockingGids.empty())
+            return;
+
+        for(tson::Layer *layer : layers)
+        {
+            layer->forEachTileInRegion(m_bounds, [&](const tson::TileCell &cell)
+            {
+                uint32_t const gid = cell.gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+                if(gid < blockingGids.size() && blockingGids[gid] != 0)
+                    setWalkable(cell.posInTileUnits.x, cell.posInTileUnits.y, false);
+            });
+        }
+    }
+
+    /*!
+     * Creates a grid where every cell is walkable. Use setWalkable() to block cells.
+     * @param bounds The cells of the grid, in tile units
+     * @param topology How the cells are connected
+     * @param staggerX true if the stagger axis is x (staggered and hexagonal only)
+     * @param staggerEven true if the even rows/columns are shifted (staggered and hexagonal only)
+     */
+    void NavigationGrid::create(const tson::Rect &bounds, tson::NavigationTopology topology, bool staggerX, bool staggerEven)
+    {
+        m_bounds = bounds;
+        if(m_bounds.width < 0 || m_bounds.height < 0)
+            m_bounds = {};
+
+        m_topology = topology;
+        m_staggerX = staggerX;
+        m_staggerEven = staggerEven;
+
+        size_t const cellCount = static_cast<size_t>(m_bounds.width) * static_cast<size_t>(m_bounds.height);
+        m_walkable.assign((cellCount + 63) / 64, ~uint64_t(0));
+    }
+
+    /*!
+     * Changes a cell. Positions outside the grid are ignored.
+     */
+    void NavigationGrid::setWalkable(int x, int y, bool walkable)
+    {
+        if(x < m_bounds.x || y < m_bounds.y || x >= m_bounds.x + m_bounds.width || y >= m_bounds.y + m_bounds.height)
+            return;
+
+        uint32_t const index = toIndex(x, y);
+        if(walkable)
+            m_walkable[index >> 6] |= uint64_t(1) << (index & 63);
+        else
+            m_walkable[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+
+    /*!
+     * Whether moves to neighbours sharing only a corner are allowed (orthogonal and staggered maps). Default: true
+     * Diagonal moves never cut corners: Both cells next to the move must be walkable.
+     */
+    void NavigationGrid::setDiagonalMovement(bool diagonalMovement)
+    {
+        m_diagonalMovement = diagonalMovement;
+    }
+
+    /*!
+     * @return true if the cell is inside the grid and walkable
+     */
+    bool NavigationGrid::isWalkable(int x, int y) const
+    {
+        if(x < m_bounds.x || y < m_bounds.y || x >= m_bounds.x + m_bounds.width || y >= m_bounds.y + m_bounds.height)
+            return false;
+
+        uint32_t const index = toIndex(x, y);
+        return ((m_walkable[index >> 6] >> (index & 63)) & 1) != 0;
+    }
+
+    bool NavigationGrid::isDiagonalMovement() const
+    {
+        return m_diagonalMovement;
+    }
+
+    /*!
+     * The cells of the grid, in tile units
+     */
+    const tson::Rect &NavigationGrid::getBounds() const
+    {
+        return m_bounds;
+    }
+
+    tson::NavigationTopology NavigationGrid::getTopology() const
+    {
+        return m_topology;
+    }
+
+    /*!
+     * Finds the cheapest path with A*.
+     * @param context Memory for the search. Must not be used by another search at the same time.
+     * @param start Start cell in tile units
+     * @param goal Goal cell in tile units
+     * @param path Receives all cells of the path, from start to goal. Cleared when no path exists.
+     * @return true if a path was found
+     */
+    bool NavigationGrid::findPath(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+                                  std::vector<tson::Vector2i> &path) const
+    {
+        path.clear();
+        if(!isWalkable(start.x, start.y) || !isWalkable(goal.x, goal.y))
+            return false;
+
+        context.prepare(static_cast<size_t>(m_bounds.width) * static_cast<size_t>(m_bounds.height));
+        uint32_t const startIndex = toIndex(start.x, start.y);
+        uint32_t const goalIndex = toIndex(goal.x, goal.y);
+        context.relax(startIndex, startIndex, 0, getEstimatedCost(start, goal));
+
+        while(!context.m_open.empty())
+        {
+            uint32_t const node = context.pop();
+            if(context.isClosed(node))
+                continue;
+
+            context.m_closed[node] = context.m_generation;
+            ++context.m_expandedNodes;
+            if(node == goalIndex)
+            {
+                createPath(context, startIndex, goalIndex, false, path);
+                return true;
+            }
+
+            tson::Vector2i const position = toPosition(node);
+            uint32_t const cost = context.m_costs[node];
+            forEachNeighbour(position.x, position.y, [&](int x, int y, uint32_t moveCost)
+            {
+                context.relax(toIndex(x, y), node, cost + moveCost, getEstimatedCost({x, y}, goal));
+            });
+        }
+        return false;
+    }
+
+    /*!
+     * Finds the cheapest path with Jump Point Search, which expands far fewer nodes than A* on open areas.
+     * The result has the same cost as findPath(), and contains every cell of the path as well.
+     *
+     * Jump Point Search needs the symmetry of an orthogonal grid with diagonal movement: On staggered and hexagonal grids,
+     * or without diagonal movement, this is the same as findPath().
+     * @param context Memory for the search. Must not be used by another search at the same time.
+     * @param start Start cell in tile units
+     * @param goal Goal cell in tile units
+     * @param path Receives all cells of the path, from start to goal. Cleared when no path exists.
+     * @return true if a path was found
+     */
+    bool NavigationGrid::findPathJps(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+                                     std::vector<tson::Vector2i> &path) const
+    {
+        if(m_topology != tson::NavigationTopology::Orthogonal || !m_diagonalMovement)
+            return findPath(context, start, goal, path);
+
+        path.clear();
+        if(!isWalkable(start.x, start.y) || !isWalkable(goal.x, goal.y))
+            return false;
+
+        context.prepare(static_cast<size_t>(m_bounds.width) * static_cast<size_t>(m_bounds.height));
+        uint32_t const startIndex = toIndex(start.x, start.y);
+        uint32_t const goalIndex = toIndex(goal.x, goal.y);
+        context.relax(startIndex, startIndex, 0, getEstimatedCost(start, goal));
+
+        int directions[8][2];
+        while(!context.m_open.empty())
+        {
+            uint32_t const node = context.pop();
+            if(context.isClosed(node))
+                continue;
+
+            context.m_closed[node] = context.m_generation;
+            ++context.m_expandedNodes;
+            if(node == goalIndex)
+            {
+                createPath(context, startIndex, goalIndex, true, path);
+                return true;
+            }
+
+            int const x = toPosition(node).x;
+            int const y = toPosition(node).y;
+            size_t count = 0;
+            auto add = [&](int dx, int dy) { directions[count][0] = dx; directions[count][1] = dy; ++count; };
+
+            if(node == startIndex)
+            {
+                //No parent: Every direction
+                for(int dy = -1; dy <= 1; ++dy)
+                    for(int dx = -1; dx <= 1; ++dx)
+                        if((dx != 0 || dy != 0) && (dx == 0 || dy == 0 || (isWalkable(x + dx, y) && isWalkable(x, y + dy))))
+                            add(dx, dy);
+            }
+            else
+            {
+                //Only the natural and forced neighbours in the direction of travel
+                tson::Vector2i const parent = toPosition(context.m_parents[node]);
+                int const dx = (x > parent.x) - (x < parent.x);
+                int const dy = (y > parent.y) - (y < parent.y);
+                if(dx != 0 && dy != 0)
+                {
+                    bool const vertical = isWalkable(x, y + dy);
+                    bool const horizontal = isWalkable(x + dx, y);
+                    if(vertical)
+                        add(0, dy);
+                    if(horizontal)
+                        add(dx, 0);
+                    if(vertical && horizontal)
+                        add(dx, dy);
+                }
+                else if(dx != 0)
+                {
+                    bool const up = isWalkable(x, y - 1);
+                    bool const down = isWalkable(x, y + 1);
+                    if(isWalkable(x + dx, y))
+                    {
+                        add(dx, 0);
+                        if(up)
+                            add(dx, -1);
+                        if(down)
+                            add(dx, 1);
+                    }
+                    if(up)
+                        add(0, -1);
+                    if(down)
+                        add(0, 1);
+                }
+                else
+                {
+                    bool const left = isWalkable(x - 1, y);
+                    bool const right = isWalkable(x + 1, y);
+                    if(isWalkable(x, y + dy))
+                    {
+                        add(0, dy);
+                        if(left)
+                            add(-1, dy);
+                        if(right)
+                            add(1, dy);
+                    }
+                    if(left)
+                        add(-1, 0);
+                    if(right)
+                        add(1, 0);
+                }
+            }
+
+            uint32_t const cost = context.m_costs[node];
+            for(size_t i = 0; i < count; ++i)
+            {
+                tson::Vector2i jumpPoint;
+                if(!jump(x + directions[i][0], y + directions[i][1], directions[i][0], directions[i][1], goal, jumpPoint))
+                    continue;
+
+                context.relax(toIndex(jumpPoint.x, jumpPoint.y), node, cost + getOctileCost(jumpPoint.x - x, jumpPoint.y - y),
+                              getEstimatedCost(jumpPoint, goal));
+            }
+        }
+        return false;
+    }
+
+    void NavigationGrid::collectLayers(std::vector<tson::Layer> &layers, const std::vector<std::string> &layerNames, std::vector<tson::Layer *> &result)
+    {
+        for(auto &layer : layers)
+        {
+            if(layer.getType() == tson::LayerType::Group)
+                collectLayers(layer.getLayers(), layerNames, result);
+            else if(layer.getType() == tson::LayerType::TileLayer &&
+                    (layerNames.empty() || std::find(layerNames.begin(), layerNames.end(), layer.getName()) != layerNames.end()))
+                result.push_back(&layer);
+        }
+    }
+
+    /*!
+     * One byte per gid (without flip flags): 1 if tiles with the gid block the cell.
+     */
+    void NavigationGrid::createBlockingTable(tson::Map &map, std::vector<uint8_t> &blockingGids) const
+    {
+        const std::vector<tson::TileDrawInfo> &table = map.getTileDrawTable();
+        blockingGids.assign(table.size(), 0);
+        for(size_t gid = 0; gid < table.size(); ++gid)
+        {
+            tson::Tile *tile = table[gid].tile;
+            bool blocking = m_gids.count(static_cast<uint32_t>(gid)) > 0;
+            if(!blocking && tile != nullptr && !m_propertyName.empty())
+            {
+                tson::Property *property = tile->getProp(m_propertyName);
+                blocking = property != nullptr && (property->getType() != tson::Type::Boolean || property->getValue<bool>());
+            }
+            blockingGids[gid] = (blocking) ? 1 : 0;
+        }
+    }
+
+    uint32_t NavigationGrid::toIndex(int x, int y) const
+    {
+        return static_cast<uint32_t>((y - m_bounds.y) * m_bounds.width + (x - m_bounds.x));
+    }
+
+    tson::Vector2i NavigationGrid::toPosition(uint32_t index) const
+    {
+        int const i = static_cast<int>(index);
+        return {m_bounds.x + i % m_bounds.width, m_bounds.y + i / m_bounds.width};
+    }
+
+    /*!
+     * true if the row (or column, when the stagger axis is x) is shifted by half a tile
+     */
+    bool NavigationGrid::isShifted(int row) const
+    {
+        return ((row & 1) != 0) != m_staggerEven;
+    }
+
+    uint32_t NavigationGrid::getOctileCost(int dx, int dy) const
+    {
+        uint32_t const ax = static_cast<uint32_t>(std::abs(dx));
+        uint32_t const ay = static_cast<uint32_t>(std::abs(dy));
+        if(!m_diagonalMovement)
+            return (ax + ay) * StraightCost;
+
+        uint32_t const diagonal = std::min(ax, ay);
+        return diagonal * DiagonalCost + (std::max(ax, ay) - diagonal) * StraightCost;
+    }
+
+    /*!
+     * The cost of the cheapest path without any blocked cells. Never more than the real cost, so A* finds the cheapest path.
+     */
+    uint32_t NavigationGrid::getEstimatedCost(const tson::Vector2i &from, const tson::Vector2i &to) const
+    {
+        if(m_topology == tson::NavigationTopology::Orthogonal)
+            return getOctileCost(to.x - from.x, to.y - from.y);
+
+        //Positions in half tiles: The shifted rows are half a tile further along the row
+        int const fromRow = (m_staggerX) ? from.x : from.y;
+        int const toRow = (m_staggerX) ? to.x : to.y;
+        int const fromColumn = 2 * ((m_staggerX) ? from.y : from.x) + (isShifted(fromRow) ? 1 : 0);
+        int const toColumn = 2 * ((m_staggerX) ? to.y : to.x) + (isShifted(toRow) ? 1 : 0);
+        int const dColumn = toColumn - fromColumn;
+        int const dRow = toRow - fromRow;
+
+        if(m_topology == tson::NavigationTopology::Hexagonal)
+        {
+            uint32_t const rows = static_cast<uint32_t>(std::abs(dRow));
+            uint32_t const columns = static_cast<uint32_t>(std::abs(dColumn));
+            return (rows + ((columns > rows) ? (columns - rows) / 2 : 0)) * StraightCost;
+        }
+
+        //Staggered tiles form an orthogonal grid rotated by 45 degrees
+        return getOctileCost((dColumn + dRow) / 2, (dRow - dColumn) / 2);
+    }
+
+    /*!
+     * Calls func(x, y, cost) for each walkable neighbour of a cell.
+     */
+    template<typename Func>
+    void NavigationGrid::forEachNeighbour(int x, int y, Func &&func) const
+    {
+        if(m_topology == tson::NavigationTopology::Orthogonal)
+        {
+            static constexpr int Straight[4][2] {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+            for(const auto &d : Straight)
+            {
+                if(isWalkable(x + d[0], y + d[1]))
+                    func(x + d[0], y + d[1], StraightCost);
+            }
+
+            if(!m_diagonalMovement)
+                return;
+
+            static constexpr int Diagonal[4][2] {{1, -1}, {1, 1}, {-1, 1}, {-1, -1}};
+            for(const auto &d : Diagonal)
+            {
+                if(isWalkable(x + d[0], y + d[1]) && isWalkable(x + d[0], y) && isWalkable(x, y + d[1]))
+                    func(x + d[0], y + d[1], DiagonalCost);
+            }
+            return;
+        }
+
+        //Staggered and hexagonal maps: Work in rows and columns along the stagger axis, and swap back for the result
+        int const row = (m_staggerX) ? x : y;
+        int const column = (m_staggerX) ? y : x;
+        auto cell = [&](int c, int r) { return (m_staggerX) ? tson::Vector2i {r, c} : tson::Vector2i {c, r}; };
+        auto visit = [&](const tson::Vector2i &p, uint32_t cost) { if(isWalkable(p.x, p.y)) func(p.x, p.y, cost); };
+
+        //The neighbours in the rows before and after share an edge
+        int const left = (isShifted(row)) ? column : column - 1;
+        tson::Vector2i const previousLeft = cell(left, row - 1);
+        tson::Vector2i const previousRight = cell(left + 1, row - 1);
+        tson::Vector2i const nextLeft = cell(left, row + 1);
+        tson::Vector2i const nextRight = cell(left + 1, row + 1);
+        visit(previousLeft, StraightCost);
+        visit(previousRight, StraightCost);
+        visit(nextLeft, StraightCost);
+        visit(nextRight, StraightCost);
+
+        if(m_topology == tson::NavigationTopology::Hexagonal)
+        {
+            visit(cell(column - 1, row), StraightCost);
+            visit(cell(column + 1, row), StraightCost);
+            return;
+        }
+
+        if(!m_diagonalMovement)
+            return;
+
+        //Staggered tiles also touch four tiles with a corner, which are reached through the two tiles in between
+        auto walkable = [&](const tson::Vector2i &p) { return isWalkable(p.x, p.y); };
+        if(walkable(previousLeft) && walkable(nextLeft))
+            visit(cell(column - 1, row), DiagonalCost);
+        if(walkable(previousRight) && walkable(nextRight))
+            visit(cell(column + 1, row), DiagonalCost);
+        if(walkable(previousLeft) && walkable(previousRight))
+            visit(cell(column, row - 2), DiagonalCost);
+        if(walkable(nextLeft) && walkable(nextRight))
+            visit(cell(column, row + 2), DiagonalCost);
+    }
+
+    /*!
+     * Moves from a cell in one direction until a jump point is found: The goal, or a cell with a forced neighbour.
+     * Diagonal moves stop where a straight move from the cell finds a jump point.
+     * @return true if a jump point was found before running into a blocked cell
+     */
+    bool NavigationGrid::jump(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const
+    {
+        if(dx == 0 || dy == 0)
+            return jumpStraight(x, y, dx, dy, goal, result);
+
+        tson::Vector2i found;
+        while(isWalkable(x, y))
+        {
+            if((x == goal.x && y == goal.y) || jumpStraight(x + dx, y, dx, 0, goal, found) || jumpStraight(x, y + dy, 0, dy, goal, found))
+            {
+                result = {x, y};
+                return true;
+            }
+
+            //No corner cutting
+            if(!isWalkable(x + dx, y) || !isWalkable(x, y + dy))
+                return false;
+
+            x += dx;
+            y += dy;
+        }
+        return false;
+    }
+
+    bool NavigationGrid::jumpStraight(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const
+    {
+        while(isWalkable(x, y))
+        {
+            //A neighbour next to the move is forced when the cell behind it is blocked, since it cannot be reached diagonally from behind
+            bool forced = (x == goal.x && y == goal.y);
+            if(!forced && dx != 0)
+                forced = (isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1)) || (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1));
+            else if(!forced)
+                forced = (isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy)) || (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy));
+
+            if(forced)
+            {
+                result = {x, y};
+                return true;
+            }
+
+            x += dx;
+            y += dy;
+        }
+        return false;
+    }
+
+    /*!
+     * Follows the parents from the goal back to the start.
+     * @param fillGaps true to add the cells between jump points, which are on a straight or diagonal line
+     */
+    void NavigationGrid::createPath(const tson::NavigationContext &context, uint32_t start, uint32_t goal, bool fillGaps,
+                                    std::vector<tson::Vector2i> &path) const
+    {
+        path.clear();
+        for(uint32_t node = goal; ; node = context.m_parents[node])
+        {
+            tson::Vector2i const position = toPosition(node);
+            if(fillGaps && !path.empty())
+            {
+                tson::Vector2i current = path.back();
+                int const dx = (position.x > current.x) - (position.x < current.x);
+                int const dy = (position.y > current.y) - (position.y < current.y);
+                for(current = {current.x + dx, current.y + dy}; current != position; current = {current.x + dx, current.y + dy})
+                    path.push_back(current);
+            }
+            path.push_back(position);
+
+            if(node == start)
+                break;
+        }
+        std::reverse(path.begin(), path.end());
+    }
+}
+
+#endif //TILESON_NAVIGATIONGRID_HPP
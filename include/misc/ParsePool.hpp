@@ -0,0 +1,154 @@
+#ifndef TILESON_PARSEPOOL_HPP
+#define TILESON_PARSEPOOL_HPP
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <condition_variable>
+
+namespace tson
+{
+    /*!
+     * The background threads of tson::Tileson::parseAsync() and tson::Tileson::parseMany().
+     *
+     * Each thread owns a tson::Tileson with its own json backend and decompressors, so maps are parsed without sharing any parse state.
+     * Jobs are run in the order they are pushed, by whichever thread is free first.
+     * An exception thrown by a job does not stop its thread. The first one is rethrown by wait().
+     */
+    class ParsePool
+    {
+        public:
+            /*! Runs on a background thread, with the parser owned by that thread */
+            using Job = std::function<void(tson::Tileson &parser)>;
+
+            inline explicit ParsePool(std::vector<std::unique_ptr<tson::Tileson>> parsers); //tileson_forward.hpp
+            inline ~ParsePool(); //tileson_forward.hpp
+
+            ParsePool(const ParsePool &) = delete;
+            ParsePool &operator=(const ParsePool &) = delete;
+
+            inline void push(Job job);
+            inline void wait();
+
+            [[nodiscard]] inline size_t getThreadCount() const;
+
+            inline static size_t GetThreadCount(size_t threadCount);
+
+        private:
+            /*! Counts a job as finished when it goes out of scope, even when the job throws */
+            class ActiveJob
+            {
+                public:
+                    inline explicit ActiveJob(ParsePool &pool) : m_pool {pool} {}
+                    inline ~ActiveJob();
+
+                    ActiveJob(const ActiveJob &) = delete;
+                    ActiveJob &operator=(const ActiveJob &) = delete;
+
+                private:
+                    ParsePool &m_pool;
+            };
+
+            inline void workerLoop(tson::Tileson &parser);
+
+            std::vector<std::unique_ptr<tson::Tileson>> m_parsers;
+
+            //Shared with the background threads. Guarded by m_mutex.
+            std::mutex                          m_mutex;
+            std::condition_variable             m_workAvailable;
+            std::condition_variable             m_workDone;
+            std::deque<Job>                     m_queue;
+            size_t                              m_activeJobs {};
+            std::exception_ptr                  m_error;                /*! The first exception thrown by a job, until wait() rethrows it */
+            bool                                m_stop {false};
+            std::vector<std::thread>            m_threads;
+    };
+
+    /*!
+     * Queues a job, which is run by the first background thread that is free
+     */
+    void ParsePool::push(Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(job));
+        }
+        m_workAvailable.notify_one();
+    }
+
+    /*!
+     * Blocks until every queued job has finished. Rethrows the first exception thrown by a job since the last call.
+     */
+    void ParsePool::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workDone.wait(lock, [&]() { return m_queue.empty() && m_activeJobs == 0; });
+
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        lock.unlock();
+        if(error != nullptr)
+            std::rethrow_exception(error);
+    }
+
+    size_t ParsePool::getThreadCount() const
+    {
+        return m_threads.size();
+    }
+
+    /*!
+     * @param threadCount A requested number of threads. 0 means the number of hardware threads.
+     * @return The number of threads to start. At least 1.
+     */
+    size_t ParsePool::GetThreadCount(size_t threadCount)
+    {
+        return (threadCount == 0) ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : threadCount;
+    }
+
+    void ParsePool::workerLoop(tson::Tileson &parser)
+    {
+        while(true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_workAvailable.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+                //Queued jobs are finished before stopping, so every future gets its map
+                if(m_queue.empty())
+                    return;
+
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+                ++m_activeJobs;
+            }
+
+            ActiveJob const active {*this};
+            try
+            {
+                job(parser);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_error == nullptr)
+                    m_error = std::current_exception();
+            }
+        }
+    }
+
+    ParsePool::ActiveJob::~ActiveJob()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pool.m_mutex);
+            --m_pool.m_activeJobs;
+        }
+        m_pool.m_workDone.notify_all();
+    }
+}
+
+#endif //TILESON_PARSEPOOL_HPP
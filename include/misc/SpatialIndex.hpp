@@ -0,0 +1,326 @@
+#ifndef TILESON_SPATIALINDEX_HPP
+#define TILESON_SPATIALINDEX_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include "../objects/Vector2.hpp"
+#include "../tiled/Object.hpp"
+
+namespace tson
+{
+    /*!
+     * A uniform grid over the bounding boxes of the objects in an object layer.
+     * Each object is stored in every cell its bounding box touches, and the queries return the indices of
+     * the objects (in the order of Layer::getObjects()) whose bounding box intersects the query shape.
+     *
+     * The bounds take position, size, rotation and polygon/polyline points into account.
+     * Tile objects (objects with a gid) are anchored at their bottom-left corner, like in Tiled.
+     *
+     * All queries are const and do not allocate when the output vector has enough capacity,
+     * so one index may be queried from several threads at once.
+     */
+    class SpatialIndex
+    {
+        public:
+            inline SpatialIndex() = default;
+            inline explicit SpatialIndex(const std::vector<tson::Object> &objects, float cellSize = 0.f);
+            inline void build(const std::vector<tson::Object> &objects, float cellSize = 0.f);
+            inline void clear();
+
+            inline size_t queryRect(float x, float y, float width, float height, std::vector<size_t> &out) const;
+            inline size_t queryPoint(float x, float y, std::vector<size_t> &out) const;
+            inline size_t queryRadius(float x, float y, float radius, std::vector<size_t> &out) const;
+
+            [[nodiscard]] inline bool empty() const;
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline float getCellSize() const;
+            [[nodiscard]] inline const Vector2i &getGridSize() const;
+
+            inline static void CalculateBounds(const tson::Object &obj, float &minX, float &minY, float &maxX, float &maxY);
+
+        private:
+            template <typename Func>
+            inline size_t forEachCandidate(float minX, float minY, float maxX, float maxY, Func &&func) const;
+            [[nodiscard]] inline int cellX(float x) const;
+            [[nodiscard]] inline int cellY(float y) const;
+
+            float                 m_cellSize {};
+            tson::Vector2f        m_origin;            /*! Top-left corner of the grid in pixels */
+            tson::Vector2i        m_gridSize;          /*! Number of columns and rows */
+
+            //Bounds of every object, stored as separate arrays to keep the tests in the queries tight
+            std::vector<float>    m_minX;
+            std::vector<float>    m_minY;
+            std::vector<float>    m_maxX;
+            std::vector<float>    m_maxY;
+
+            std::vector<uint32_t> m_cellStart;         /*! Offset into m_cellItems for each cell. Has one extra element at the end */
+            std::vector<uint32_t> m_cellItems;         /*! Object indices, grouped by cell */
+    };
+
+    SpatialIndex::SpatialIndex(const std::vector<tson::Object> &objects, float cellSize)
+    {
+        build(objects, cellSize);
+    }
+
+    /*!
+     * Calculates the axis aligned bounding box of an object in pixels.
+     * Rotation is done clockwise around the position of the object, as in Tiled.
+     */
+    void SpatialIndex::CalculateBounds(const tson::Object &obj, float &minX, float &minY, float &maxX, float &maxY)
+    {
+        const tson::Vector2i &pos = obj.getPosition();
+        const tson::Vector2i &size = obj.getSize();
+
+        float const radians = obj.getRotation() * 3.14159265358979323846f / 180.f;
+        float const cosR = std::cos(radians);
+        float const sinR = std::sin(radians);
+        bool const rotated = obj.getRotation() != 0.f;
+
+        minX = minY = std::numeric_limits<float>::max();
+        maxX = maxY = std::numeric_limits<float>::lowest();
+
+        auto addPoint = [&](float x, float y)
+        {
+            float px = (rotated) ? (x * cosR) - (y * sinR) : x;
+            float py = (rotated) ? (x * sinR) + (y * cosR) : y;
+            px += static_cast<float>(pos.x);
+            py += static_cast<float>(pos.y);
+            minX = std::min(minX, px);
+            minY = std::min(minY, py);
+            maxX = std::max(maxX, px);
+            maxY = std::max(maxY, py);
+        };
+
+        const std::vector<tson::Vector2i> *points = nullptr;
+        if(obj.getObjectType() == ObjectType::Polygon)
+            points = &obj.getPolygons();
+        else if(obj.getObjectType() == ObjectType::Polyline)
+            points = &obj.getPolylines();
+
+        if(points != nullptr && !points->empty())
+        {
+            for(const auto &p : *points)
+                addPoint(static_cast<float>(p.x), static_cast<float>(p.y));
+        }
+        else
+        {
+            float const w = static_cast<float>(size.x);
+            float const h = static_cast<float>(size.y);
+            float const top = (obj.getGid() > 0) ? -h : 0.f; //Tile objects are placed by their bottom-left corner
+            addPoint(0.f, top);
+            addPoint(w, top);
+            addPoint(0.f, top + h);
+            addPoint(w, top + h);
+        }
+    }
+
+    /*!
+     * Builds the grid.
+     * @param objects The objects to index. The index stores positions in this vector, so it must be rebuilt if the vector changes.
+     * @param cellSize Size of a grid cell in pixels. If 0 or less, a cell size based on the average object size is used.
+     */
+    void SpatialIndex::build(const std::vector<tson::Object> &objects, float cellSize)
+    {
+        clear();
+        if(objects.empty())
+            return;
+
+        size_t const count = objects.size();
+        m_minX.resize(count);
+        m_minY.resize(count);
+        m_maxX.resize(count);
+        m_maxY.resize(count);
+
+        float worldMinX = std::numeric_limits<float>::max();
+        float worldMinY = std::numeric_limits<float>::max();
+        float worldMaxX = std::numeric_limits<float>::lowest();
+        float worldMaxY = std::numeric_limits<float>::lowest();
+        double extentSum = 0.0;
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            CalculateBounds(objects[i], m_minX[i], m_minY[i], m_maxX[i], m_maxY[i]);
+            worldMinX = std::min(worldMinX, m_minX[i]);
+            worldMinY = std::min(worldMinY, m_minY[i]);
+            worldMaxX = std::max(worldMaxX, m_maxX[i]);
+            worldMaxY = std::max(worldMaxY, m_maxY[i]);
+            extentSum += std::max(m_maxX[i] - m_minX[i], m_maxY[i] - m_minY[i]);
+        }
+
+        float const worldWidth = worldMaxX - worldMinX;
+        float const worldHeight = worldMaxY - worldMinY;
+
+        if(cellSize <= 0.f)
+            cellSize = std::max(static_cast<float>(extentSum / static_cast<double>(count)) * 2.f, 1.f);
+
+        //Keep the amount of cells in the same order of magnitude as the amount of objects
+        double const maxCells = std::max<double>(static_cast<double>(count) * 4.0, 64.0);
+        while((std::floor(worldWidth / cellSize) + 1.0) * (std::floor(worldHeight / cellSize) + 1.0) > maxCells)
+            cellSize *= 2.f;
+
+        m_cellSize = cellSize;
+        m_origin = {worldMinX, worldMinY};
+        m_gridSize = {static_cast<int>(worldWidth / cellSize) + 1, static_cast<int>(worldHeight / cellSize) + 1};
+
+        //Counting sort of the object indices into the cells
+        size_t const cellCount = static_cast<size_t>(m_gridSize.x) * static_cast<size_t>(m_gridSize.y);
+        m_cellStart.assign(cellCount + 1, 0);
+        for(size_t i = 0; i < count; ++i)
+        {
+            for(int y = cellY(m_minY[i]); y <= cellY(m_maxY[i]); ++y)
+                for(int x = cellX(m_minX[i]); x <= cellX(m_maxX[i]); ++x)
+                    ++m_cellStart[static_cast<size_t>(y) * m_gridSize.x + x + 1];
+        }
+        for(size_t c = 0; c < cellCount; ++c)
+            m_cellStart[c + 1] += m_cellStart[c];
+
+        m_cellItems.resize(m_cellStart[cellCount]);
+        std::vector<uint32_t> fill {m_cellStart.begin(), m_cellStart.end() - 1};
+        for(size_t i = 0; i < count; ++i)
+        {
+            for(int y = cellY(m_minY[i]); y <= cellY(m_maxY[i]); ++y)
+                for(int x = cellX(m_minX[i]); x <= cellX(m_maxX[i]); ++x)
+                    m_cellItems[fill[static_cast<size_t>(y) * m_gridSize.x + x]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    void SpatialIndex::clear()
+    {
+        m_cellSize = 0.f;
+        m_origin = {0.f, 0.f};
+        m_gridSize = {0, 0};
+        m_minX.clear();
+        m_minY.clear();
+        m_maxX.clear();
+        m_maxY.clear();
+        m_cellStart.clear();
+        m_cellItems.clear();
+    }
+
+    int SpatialIndex::cellX(float x) const
+    {
+        return std::clamp(static_cast<int>(std::floor((x - m_origin.x) / m_cellSize)), 0, m_gridSize.x - 1);
+    }
+
+    int SpatialIndex::cellY(float y) const
+    {
+        return std::clamp(static_cast<int>(std::floor((y - m_origin.y) / m_cellSize)), 0, m_gridSize.y - 1);
+    }
+
+    /*!
+     * Calls func(index) once for every object whose bounding box overlaps the given box.
+     * Objects spanning several cells are only reported from the first cell shared with the query,
+     * which removes duplicates without having to keep any state between the queries.
+     */
+    template<typename Func>
+    size_t SpatialIndex::forEachCandidate(float minX, float minY, float maxX, float maxY, Func &&func) const
+    {
+        if(m_cellStart.empty() || maxX < m_origin.x || maxY < m_origin.y ||
+           minX > m_origin.x + m_cellSize * m_gridSize.x || minY > m_origin.y + m_cellSize * m_gridSize.y)
+            return 0;
+
+        int const startX = cellX(minX);
+        int const startY = cellY(minY);
+        int const endX = cellX(maxX);
+        int const endY = cellY(maxY);
+
+        size_t found = 0;
+        for(int y = startY; y <= endY; ++y)
+        {
+            for(int x = startX; x <= endX; ++x)
+            {
+                size_t const cell = static_cast<size_t>(y) * m_gridSize.x + x;
+                for(uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+                {
+                    uint32_t const item = m_cellItems[i];
+                    if(m_minX[item] > maxX || m_maxX[item] < minX || m_minY[item] > maxY || m_maxY[item] < minY)
+                        continue;
+                    if(std::max(cellX(m_minX[item]), startX) != x || std::max(cellY(m_minY[item]), startY) != y)
+                        continue;
+                    if(func(item))
+                        ++found;
+                }
+            }
+        }
+        return found;
+    }
+
+    /*!
+     * Finds all objects with a bounding box that intersects the rectangle.
+     * @param out Indices of the objects found are appended to this vector
+     * @return The number of objects found
+     */
+    size_t SpatialIndex::queryRect(float x, float y, float width, float height, std::vector<size_t> &out) const
+    {
+        return forEachCandidate(x, y, x + width, y + height, [&](uint32_t item)
+        {
+            out.push_back(item);
+            return true;
+        });
+    }
+
+    /*!
+     * Finds all objects with a bounding box that contains the point.
+     * @param out Indices of the objects found are appended to this vector
+     * @return The number of objects found
+     */
+    size_t SpatialIndex::queryPoint(float x, float y, std::vector<size_t> &out) const
+    {
+        return forEachCandidate(x, y, x, y, [&](uint32_t item)
+        {
+            out.push_back(item);
+            return true;
+        });
+    }
+
+    /*!
+     * Finds all objects with a bounding box that intersects the circle.
+     * @param out Indices of the objects found are appended to this vector
+     * @return The number of objects found
+     */
+    size_t SpatialIndex::queryRadius(float x, float y, float radius, std::vector<size_t> &out) const
+    {
+        float const radiusSq = radius * radius;
+        return forEachCandidate(x - radius, y - radius, x + radius, y + radius, [&](uint32_t item)
+        {
+            float const dx = x - std::clamp(x, m_minX[item], m_maxX[item]);
+            float const dy = y - std::clamp(y, m_minY[item], m_maxY[item]);
+            if((dx * dx) + (dy * dy) > radiusSq)
+                return false;
+
+            out.push_back(item);
+            return true;
+        });
+    }
+
+    bool SpatialIndex::empty() const
+    {
+        return m_minX.empty();
+    }
+
+    /*!
+     * @return The number of indexed objects
+     */
+    size_t SpatialIndex::size() const
+    {
+        return m_minX.size();
+    }
+
+    float SpatialIndex::getCellSize() const
+    {
+        return m_cellSize;
+    }
+
+    /*!
+     * @return The number of columns (x) and rows (y) in the grid
+     */
+    const Vector2i &SpatialIndex::getGridSize() const
+    {
+        return m_gridSize;
+    }
+}
+
+#endif //TILESON_SPATIALINDEX_HPP
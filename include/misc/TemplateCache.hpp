@@ -0,0 +1,187 @@
+#ifndef TILESON_TEMPLATECACHE_HPP
+#define TILESON_TEMPLATECACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <system_error>
+
+namespace tson
+{
+    /*!
+     * The object of a template file (.tj or .json), parsed once. Template instances copy it and only read their overrides.
+     */
+    class ObjectTemplate
+    {
+        public:
+            inline ObjectTemplate() = default;
+            inline bool parse(IJson &json, tson::Map *map);
+
+            [[nodiscard]] inline const tson::Object &getObject() const;
+            [[nodiscard]] inline bool hasField(const std::string &name) const;
+
+        private:
+            tson::Object            m_object;   /*! Not bound to a map */
+            std::set<std::string>   m_fields;   /*! The fields of the object that exist in the template file */
+    };
+
+    /*!
+     * Keeps parsed object templates, so maps using the same template files only read and parse them once.
+     *
+     * Templates are keyed by their canonical path and the time they were last written to, so a template changed on disk is parsed again.
+     * All functions are thread safe, so one cache can be shared by several tson::Tileson instances using the same tson::Project.
+     * Only templates read from files are cached: Maps parsed with a custom tson::LinkedFileParser parse their templates as before.
+     *
+     * Example:
+     * tson::Tileson t;
+     * t.setTemplateCache(std::make_shared<tson::TemplateCache>());
+     */
+    class TemplateCache
+    {
+        public:
+            inline TemplateCache() = default;
+
+            inline std::shared_ptr<const tson::ObjectTemplate> get(const fs::path &path, IJson &json, tson::Map *map);
+            inline void clear();
+
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline size_t getHits() const;
+            [[nodiscard]] inline size_t getMisses() const;
+
+        private:
+            class Entry
+            {
+                public:
+                    fs::file_time_type                          modified {};
+                    std::shared_ptr<const tson::ObjectTemplate> objectTemplate;
+            };
+
+            mutable std::mutex                      m_mutex;
+            std::unordered_map<std::string, Entry>  m_entries;  /*! Canonical path -> template */
+            size_t                                  m_hits {};
+            size_t                                  m_misses {};
+    };
+
+    /*!
+     * Parses the 'object' of a template file
+     * @param json The template file
+     * @param map The map asking for the template. Only used while parsing, for its tson::Project.
+     * @return false if the file has no 'object'
+     */
+    bool ObjectTemplate::parse(IJson &json, tson::Map *map)
+    {
+        IJson *object = readField("object", json);
+        if(object == nullptr)
+            return false;
+
+        static const char *const Fields[] {"ellipse", "point", "text", "gid", "id", "name", "rotation", "type", "class", "visible",
+                                           "width", "height", "x", "y", "polygon", "polyline"};
+        for(const char *field : Fields)
+        {
+            if(object->count(field) > 0)
+                m_fields.emplace(field);
+        }
+
+        m_object.parse(*object, map);
+        m_object.m_map = nullptr;
+        return true;
+    }
+
+    /*!
+     * The template object, with every field of the template file applied
+     */
+    const tson::Object &ObjectTemplate::getObject() const
+    {
+        return m_object;
+    }
+
+    /*!
+     * true if the template file has a field, so instances without it use the one of the template
+     */
+    bool ObjectTemplate::hasField(const std::string &name) const
+    {
+        return m_fields.count(name) > 0;
+    }
+
+    /*!
+     * Gets a template file, parsing it if it is not cached or has been changed since it was parsed.
+     * The template is parsed outside the lock, so different templates can be parsed at the same time.
+     * @param path Path to the template file
+     * @param json Used to create the json parser of the template file
+     * @param map The map asking for the template. Only used while parsing.
+     * @return The parsed template. nullptr if the file could not be read, or has no object.
+     */
+    std::shared_ptr<const tson::ObjectTemplate> TemplateCache::get(const fs::path &path, IJson &json, tson::Map *map)
+    {
+        std::error_code error;
+        fs::path canonical = fs::canonical(path, error);
+        if(error)
+            return nullptr;
+        fs::file_time_type modified = fs::last_write_time(canonical, error);
+        if(error)
+            return nullptr;
+
+        std::string key = canonical.generic_string();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(key);
+            if(it != m_entries.end() && it->second.modified == modified)
+            {
+                ++m_hits;
+                return it->second.objectTemplate;
+            }
+            ++m_misses;
+        }
+
+        std::unique_ptr<IJson> file = json.create();
+        std::shared_ptr<tson::ObjectTemplate> objectTemplate = std::make_shared<tson::ObjectTemplate>();
+        if(!file->parse(path) || !objectTemplate->parse(*file, map))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry &entry = m_entries[key];
+        if(entry.objectTemplate == nullptr || entry.modified != modified)
+            entry = {modified, std::move(objectTemplate)};
+        return entry.objectTemplate;
+    }
+
+    /*!
+     * Removes every cached template
+     */
+    void TemplateCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+
+    /*!
+     * Number of cached template files
+     */
+    size_t TemplateCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    /*!
+     * Number of times a template was found in the cache
+     */
+    size_t TemplateCache::getHits() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    /*!
+     * Number of times a template had to be parsed
+     */
+    size_t TemplateCache::getMisses() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+}
+
+#endif //TILESON_TEMPLATECACHE_HPP
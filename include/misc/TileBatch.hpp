@@ -0,0 +1,312 @@
+#ifndef TILESON_TILEBATCH_HPP
+#define TILESON_TILEBATCH_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+namespace tson
+{
+    /*!
+     * A single vertex of a tile quad.
+     * 'color' is the tint of the layer as RGBA8: red in the lowest byte and alpha in the highest byte.
+     */
+    class TileVertex
+    {
+        public:
+            float x {};
+            float y {};
+            float u {};
+            float v {};
+            uint32_t color {0xffffffff};
+    };
+
+    /*!
+     * All the tiles of a layer that are drawn with the same texture.
+     * Every tile is a quad of 4 vertices in the order top-left, top-right, bottom-right, bottom-left,
+     * and the UVs are normalized to the size of the texture. Use TileBatchBuilder::CreateQuadIndices() to
+     * get an index buffer for the quads.
+     */
+    class TileBatch
+    {
+        public:
+            [[nodiscard]] inline const fs::path &getImage() const;
+            [[nodiscard]] inline const tson::Vector2i &getImageSize() const;
+            [[nodiscard]] inline size_t getTileCount() const;
+
+            /*! The tileset of all the tiles in the batch */
+            tson::Tileset *tileset {nullptr};
+            /*! The tile holding the image of this batch. Only set for image collection tilesets, where every tile has its own image. */
+            tson::Tile *imageTile {nullptr};
+            /*! 4 vertices per tile */
+            std::vector<tson::TileVertex> vertices;
+    };
+
+    /*!
+     * Turns the tiles of a tile layer into vertices, with one tson::TileBatch per texture.
+     * The result can be uploaded as one vertex buffer per tileset, instead of drawing every tile as a sprite.
+     *
+     * Tiles are looked up in the drawing table of the map (tson::Map::getTileDrawTable()).
+     * Vertex positions are in pixels, with the offset of the layer (and parallax, when a camera is used),
+     * the tile offset of the tileset and oversized tiles (drawn from the bottom-left corner of the cell) taken into account.
+     * Flipped tiles get their UVs swapped, and the quad of a diagonally flipped tile has its width and height swapped.
+     *
+     * The builder keeps its buffers between calls to build(), so a builder should be reused every frame to avoid allocations.
+     *
+     * Example:
+     * tson::TileBatchBuilder builder;
+     * for(const tson::TileBatch &batch : builder.build(*layer, camera))
+     *     renderer.draw(batch.getImage(), batch.vertices);
+     */
+    class TileBatchBuilder
+    {
+        public:
+            inline const std::vector<tson::TileBatch> &build(tson::Layer &layer);
+            inline const std::vector<tson::TileBatch> &build(tson::Layer &layer, const tson::Rect &camera);
+
+            [[nodiscard]] inline const std::vector<tson::TileBatch> &getBatches() const;
+            [[nodiscard]] inline size_t getTileCount() const;
+            inline void clear();
+
+            inline static void CreateQuadIndices(size_t tileCount, std::vector<uint32_t> &indices);
+
+        private:
+            /*! Per tile data of a batch, waiting to be turned into vertices */
+            struct Staging
+            {
+                std::vector<float> left, top, right, bottom;
+                std::vector<float> u0, v0, u1, v1;
+                std::vector<uint8_t> flip;
+            };
+
+            inline void begin(tson::Layer &layer);
+            inline void add(const tson::TileCell &cell);
+            inline void end();
+            inline size_t getBatchIndex(tson::Tileset *tileset, tson::Tile *imageTile);
+
+            std::vector<tson::TileBatch>            m_batches;
+            std::vector<Staging>                    m_staging;
+            std::unordered_map<const void *, size_t> m_batchIndices;    /*! Key: tileset (image tilesets) or tile (image collection tilesets) */
+            tson::Map                               *m_map {nullptr};
+            uint32_t                                m_color {0xffffffff};
+            float                                   m_cellHeight {};
+    };
+
+    const fs::path &TileBatch::getImage() const
+    {
+        return (imageTile != nullptr) ? imageTile->getImage() : tileset->getImage();
+    }
+
+    const tson::Vector2i &TileBatch::getImageSize() const
+    {
+        return (imageTile != nullptr) ? imageTile->getImageSize() : tileset->getImageSize();
+    }
+
+    size_t TileBatch::getTileCount() const
+    {
+        return vertices.size() / 4;
+    }
+
+    /*!
+     * Creates vertices for every tile in the layer.
+     * @param layer A tile layer. Any other kind of layer gives no batches.
+     * @return One batch per texture used by the layer. Batches keep their order between builds.
+     */
+    const std::vector<tson::TileBatch> &TileBatchBuilder::build(tson::Layer &layer)
+    {
+        begin(layer);
+        if(layer.getType() == tson::LayerType::TileLayer)
+            layer.forEachTileInRegion(layer.getTileBounds(), [&](const tson::TileCell &cell) { add(cell); });
+        end();
+        return m_batches;
+    }
+
+    /*!
+     * Creates vertices for the tiles of the layer that are visible inside the camera. See tson::Layer::forEachVisibleTile().
+     * @param layer A tile layer. Any other kind of layer gives no batches.
+     * @param camera The visible area in pixels.
+     * @return One batch per texture used by the visible tiles. Batches keep their order between builds.
+     */
+    const std::vector<tson::TileBatch> &TileBatchBuilder::build(tson::Layer &layer, const tson::Rect &camera)
+    {
+        begin(layer);
+        if(layer.getType() == tson::LayerType::TileLayer)
+            layer.forEachVisibleTile(camera, [&](const tson::TileCell &cell) { add(cell); });
+        end();
+        return m_batches;
+    }
+
+    /*!
+     * The batches of the last call to build()
+     */
+    const std::vector<tson::TileBatch> &TileBatchBuilder::getBatches() const
+    {
+        return m_batches;
+    }
+
+    /*!
+     * Number of tiles in all the batches of the last call to build()
+     */
+    size_t TileBatchBuilder::getTileCount() const
+    {
+        size_t count = 0;
+        for(const auto &batch : m_batches)
+            count += batch.getTileCount();
+        return count;
+    }
+
+    /*!
+     * Removes all batches, and frees the memory used by them.
+     */
+    void TileBatchBuilder::clear()
+    {
+        m_batches.clear();
+        m_staging.clear();
+        m_batchIndices.clear();
+    }
+
+    /*!
+     * Creates the indices of two triangles per quad, for tiles created by this builder.
+     * The same indices can be used for every batch with the same number of tiles or fewer.
+     * @param tileCount Number of tiles (quads)
+     * @param indices Output. Gets 6 indices per tile.
+     */
+    void TileBatchBuilder::CreateQuadIndices(size_t tileCount, std::vector<uint32_t> &indices)
+    {
+        indices.resize(tileCount * 6);
+        for(size_t i = 0; i < tileCount; ++i)
+        {
+            uint32_t const first = static_cast<uint32_t>(i * 4);
+            uint32_t *index = indices.data() + i * 6;
+            index[0] = first;
+            index[1] = first + 1;
+            index[2] = first + 2;
+            index[3] = first;
+            index[4] = first + 2;
+            index[5] = first + 3;
+        }
+    }
+
+    void TileBatchBuilder::begin(tson::Layer &layer)
+    {
+        //Only empty the buffers, so their memory can be reused by the next build
+        for(size_t i = 0; i < m_batches.size(); ++i)
+        {
+            m_batches[i].vertices.clear();
+            Staging &staging = m_staging[i];
+            for(auto *values : {&staging.left, &staging.top, &staging.right, &staging.bottom, &staging.u0, &staging.v0, &staging.u1, &staging.v1})
+                values->clear();
+            staging.flip.clear();
+        }
+
+        tson::Colori tint = (layer.hasTintColor()) ? layer.getTintColor() : tson::Colori(255, 255, 255, 255);
+        float const alpha = static_cast<float>(tint.a) * std::clamp(layer.getOpacity(), 0.f, 1.f);
+        m_color = static_cast<uint32_t>(tint.r) | (static_cast<uint32_t>(tint.g) << 8) | (static_cast<uint32_t>(tint.b) << 16) |
+                  (static_cast<uint32_t>(alpha + 0.5f) << 24);
+
+        m_map = layer.getMap();
+        m_cellHeight = (m_map != nullptr) ? static_cast<float>(m_map->getTileSize().y) : 0.f;
+    }
+
+    void TileBatchBuilder::add(const tson::TileCell &cell)
+    {
+        const tson::TileDrawInfo *info = (m_map != nullptr) ? m_map->getTileDrawInfo(cell.gid) : nullptr;
+        if(info == nullptr)
+            return;
+
+        //Every tile of an image collection tileset has its own image. Flipped tiles use the image of the original tile.
+        tson::Tileset *tileset = info->tileset;
+        tson::Tile *imageTile = (tileset->getType() == tson::TilesetType::ImageCollectionTileset) ? info->tile : nullptr;
+        const tson::Vector2i &imageSize = (imageTile != nullptr) ? imageTile->getImageSize() : tileset->getImageSize();
+        if(imageSize.x <= 0 || imageSize.y <= 0)
+            return;
+
+        //Flip flags are bits 32, 31 and 30 of the gid: horizontal = 4, vertical = 2 and diagonal = 1
+        uint8_t const flip = static_cast<uint8_t>((cell.gid >> 29) & 7);
+        float width = static_cast<float>(info->drawingRect.width);
+        float height = static_cast<float>(info->drawingRect.height);
+        if((flip & 1) != 0)
+            std::swap(width, height);
+
+        Staging &staging = m_staging[getBatchIndex(tileset, imageTile)];
+        float const left = cell.position.x + static_cast<float>(info->tileOffset.x);
+        float const bottom = cell.position.y + m_cellHeight + static_cast<float>(info->tileOffset.y);
+        staging.left.push_back(left);
+        staging.top.push_back(bottom - height);
+        staging.right.push_back(left + width);
+        staging.bottom.push_back(bottom);
+        staging.u0.push_back(info->uvTopLeft.x);
+        staging.v0.push_back(info->uvTopLeft.y);
+        staging.u1.push_back(info->uvBottomRight.x);
+        staging.v1.push_back(info->uvBottomRight.y);
+        staging.flip.push_back(flip);
+    }
+
+    void TileBatchBuilder::end()
+    {
+        //For each flip combination: which corner of the texture rect (0 = top-left, 1 = top-right, 2 = bottom-right, 3 = bottom-left)
+        //goes to each corner of the quad. Tiled flips diagonally first, then horizontally and vertically.
+        static constexpr uint8_t FlipCorners[8][4] = {{0, 1, 2, 3}, {0, 3, 2, 1}, {3, 2, 1, 0}, {1, 2, 3, 0},
+                                                      {1, 0, 3, 2}, {3, 0, 1, 2}, {2, 3, 0, 1}, {2, 1, 0, 3}};
+
+        for(size_t i = 0; i < m_batches.size(); ++i)
+        {
+            const Staging &staging = m_staging[i];
+            std::vector<tson::TileVertex> &vertices = m_batches[i].vertices;
+            size_t const count = staging.flip.size();
+            vertices.resize(count * 4);
+
+            tson::TileVertex *vertex = vertices.data();
+            uint32_t const color = m_color;
+            for(size_t t = 0; t < count; ++t, vertex += 4)
+            {
+                float const us[4] = {staging.u0[t], staging.u1[t], staging.u1[t], staging.u0[t]};
+                float const vs[4] = {staging.v0[t], staging.v0[t], staging.v1[t], staging.v1[t]};
+                const uint8_t *corners = FlipCorners[staging.flip[t]];
+
+                vertex[0] = {staging.left[t], staging.top[t], us[corners[0]], vs[corners[0]], color};
+                vertex[1] = {staging.right[t], staging.top[t], us[corners[1]], vs[corners[1]], color};
+                vertex[2] = {staging.right[t], staging.bottom[t], us[corners[2]], vs[corners[2]], color};
+                vertex[3] = {staging.left[t], staging.bottom[t], us[corners[3]], vs[corners[3]], color};
+            }
+        }
+
+        //Batches without tiles are removed, but the others keep their order and memory
+        size_t used = 0;
+        for(size_t i = 0; i < m_batches.size(); ++i)
+        {
+            if(m_batches[i].vertices.empty())
+                continue;
+            if(used != i)
+            {
+                std::swap(m_batches[used], m_batches[i]);
+                std::swap(m_staging[used], m_staging[i]);
+            }
+            ++used;
+        }
+        m_batches.resize(used);
+        m_staging.resize(used);
+
+        m_batchIndices.clear();
+        for(size_t i = 0; i < m_batches.size(); ++i)
+            m_batchIndices[(m_batches[i].imageTile != nullptr) ? static_cast<const void *>(m_batches[i].imageTile) : m_batches[i].tileset] = i;
+    }
+
+    size_t TileBatchBuilder::getBatchIndex(tson::Tileset *tileset, tson::Tile *imageTile)
+    {
+        const void *key = (imageTile != nullptr) ? static_cast<const void *>(imageTile) : tileset;
+        auto iter = m_batchIndices.find(key);
+        if(iter != m_batchIndices.end())
+            return iter->second;
+
+        m_batches.emplace_back();
+        m_batches.back().tileset = tileset;
+        m_batches.back().imageTile = imageTile;
+        m_staging.emplace_back();
+        m_batchIndices[key] = m_batches.size() - 1;
+        return m_batches.size() - 1;
+    }
+}
+
+#endif //TILESON_TILEBATCH_HPP
@@ -0,0 +1,140 @@
+#ifndef TILESON_TILESETCACHE_HPP
+#define TILESON_TILESETCACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <system_error>
+
+namespace tson
+{
+    /*!
+     * Keeps parsed external tilesets ('source' in a map), so maps sharing a tileset file only read and parse it once.
+     *
+     * Tilesets are keyed by their canonical path and the time they were last written to, so a tileset changed on disk is parsed again.
+     * The cached tileset is never handed out directly: Each map gets a copy bound to the map and to its own 'firstgid'.
+     * All functions are thread safe, so one cache can be shared by several tson::Tileson instances using the same tson::Project.
+     * The class and enum properties of a cached tileset are resolved against the project of the map that parsed it first.
+     *
+     * Example:
+     * tson::Tileson t;
+     * t.setTilesetCache(std::make_shared<tson::TilesetCache>());
+     * for(const auto &data : world.getMapData())
+     *     maps.push_back(t.parse(data.path));
+     */
+    class TilesetCache
+    {
+        public:
+            /*!
+             * A parsed tileset file
+             */
+            class Entry
+            {
+                public:
+                    std::shared_ptr<const tson::Tileset> tileset;
+                    fs::file_time_type                   modified {};
+                    bool                                 allFound {false}; /*! true if all mandatory fields were found */
+            };
+
+            inline TilesetCache() = default;
+
+            inline std::shared_ptr<const Entry> get(const fs::path &path, IJson &json, tson::Map *map);
+            inline void clear();
+
+            [[nodiscard]] inline size_t size() const;
+            [[nodiscard]] inline size_t getHits() const;
+            [[nodiscard]] inline size_t getMisses() const;
+
+        private:
+            mutable std::mutex                                              m_mutex;
+            std::unordered_map<std::string, std::shared_ptr<const Entry>>   m_entries;  /*! Canonical path -> tileset */
+            size_t                                                          m_hits {};
+            size_t                                                          m_misses {};
+    };
+
+    /*!
+     * Gets a tileset file, parsing it if it is not cached or has been changed since it was parsed.
+     * The tileset is parsed outside the lock, so different tilesets can be parsed at the same time.
+     * @param path Path to the tileset file
+     * @param json Used to create the json parser of the tileset file
+     * @param map The map asking for the tileset. Only used while parsing, for its tson::Project.
+     * @return The parsed tileset. nullptr if the file could not be read.
+     */
+    std::shared_ptr<const TilesetCache::Entry> TilesetCache::get(const fs::path &path, IJson &json, tson::Map *map)
+    {
+        std::error_code error;
+        fs::path canonical = fs::canonical(path, error);
+        if(error)
+            return nullptr;
+        fs::file_time_type modified = fs::last_write_time(canonical, error);
+        if(error)
+            return nullptr;
+
+        std::string key = canonical.generic_string();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(key);
+            if(it != m_entries.end() && it->second->modified == modified)
+            {
+                ++m_hits;
+                return it->second;
+            }
+            ++m_misses;
+        }
+
+        std::unique_ptr<IJson> file = json.create();
+        if(!file->parse(path))
+            return nullptr;
+
+        std::shared_ptr<tson::Tileset> tileset = std::make_shared<tson::Tileset>();
+        auto entry = std::make_shared<Entry>();
+        entry->modified = modified;
+        entry->allFound = tileset->parseSource(*file, path, map);
+        entry->tileset = std::move(tileset);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::shared_ptr<const Entry> &cached = m_entries[key];
+        if(cached == nullptr || cached->modified != modified)
+            cached = std::move(entry);
+        return cached;
+    }
+
+    /*!
+     * Removes every cached tileset. Maps that are already parsed keep their own copies.
+     */
+    void TilesetCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+
+    /*!
+     * Number of cached tileset files
+     */
+    size_t TilesetCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    /*!
+     * Number of times a tileset was found in the cache
+     */
+    size_t TilesetCache::getHits() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    /*!
+     * Number of times a tileset had to be parsed
+     */
+    size_t TilesetCache::getMisses() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+}
+
+#endif //TILESON_TILESETCACHE_HPP
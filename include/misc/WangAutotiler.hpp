@@ -0,0 +1,320 @@
+#ifndef TILESON_WANGAUTOTILER_HPP
+#define TILESON_WANGAUTOTILER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace tson
+{
+    /*!
+     * Picks tiles from a tson::WangSet for a grid of terrain colors, for terrain that changes at runtime.
+     *
+     * Colors are stored where Tiled stores them: on the corners between cells and on the edges between cells.
+     * Changing a color only resolves the cells touching it, each with a single hash lookup in the tson::WangLookup of the wang set,
+     * so an edit costs the same no matter how large the grid is. Cells whose tile changed are collected in getChangedCells().
+     *
+     * When several tiles match, one is picked by the position of the cell, so the same terrain always gives the same tiles.
+     * When no tile matches exactly, the tile matching the most colors is used. Those searches are remembered.
+     *
+     * Example:
+     * tson::WangAutotiler autotiler {*tileset->getWangset("Terrain")};
+     * autotiler.create(*map->getLayer("Ground"));
+     * autotiler.paint(10, 4, 2);
+     * for(const tson::Vector2i &cell : autotiler.getChangedCells())
+     *     renderer.setTile(cell, autotiler.getGid(cell.x, cell.y));
+     * autotiler.clearChangedCells();
+     */
+    class WangAutotiler
+    {
+        public:
+            inline WangAutotiler() = default;
+            inline explicit WangAutotiler(const tson::WangSet &wangset);
+
+            inline void create(int width, int height);
+            inline void create(tson::Layer &layer);
+
+            inline void paint(int x, int y, uint8_t color);
+            inline void setCornerColor(int x, int y, uint8_t color);
+
+            [[nodiscard]] inline uint32_t getGid(int x, int y) const;
+            [[nodiscard]] inline uint64_t getWangId(int x, int y) const;
+            [[nodiscard]] inline const std::vector<uint32_t> &getGids() const;
+            [[nodiscard]] inline const tson::Vector2i &getSize() const;
+            [[nodiscard]] inline const std::vector<tson::Vector2i> &getChangedCells() const;
+            inline void clearChangedCells();
+
+        private:
+            [[nodiscard]] inline bool contains(int x, int y) const;
+            inline void resolve(int x, int y);
+            inline uint32_t findBestMatch(uint64_t wangId);
+
+            const tson::WangLookup                  *m_lookup {nullptr};
+            bool                                    m_usesCorners {false};
+            bool                                    m_usesEdges {false};
+
+            tson::Vector2i                          m_size;
+            std::vector<uint8_t>                    m_corners;          /*! (width + 1) * (height + 1): The corners of the cells */
+            std::vector<uint8_t>                    m_horizontalEdges;  /*! width * (height + 1): The top and bottom edges of the cells */
+            std::vector<uint8_t>                    m_verticalEdges;    /*! (width + 1) * height: The left and right edges of the cells */
+            std::vector<uint32_t>                   m_gids;             /*! width * height: The resolved gids, with flip flags */
+            std::vector<uint8_t>                    m_changed;          /*! width * height: 1 if the cell is in m_changedCells */
+            std::vector<tson::Vector2i>             m_changedCells;
+            std::unordered_map<uint64_t, uint32_t>  m_bestMatches;      /*! Wang id without an exact match -> gid */
+    };
+
+    /*!
+     * @param wangset The wang set to pick tiles from. Must outlive the autotiler.
+     */
+    WangAutotiler::WangAutotiler(const tson::WangSet &wangset) : m_lookup {&wangset.getLookup()}
+    {
+        m_usesCorners = m_lookup->usesCorners();
+        m_usesEdges = m_lookup->usesEdges();
+    }
+
+    /*!
+     * Creates an empty grid, where no cell has a tile.
+     * @param width Width in tiles
+     * @param height Height in tiles
+     */
+    void WangAutotiler::create(int width, int height)
+    {
+        m_size = {std::max(width, 0), std::max(height, 0)};
+        size_t const w = static_cast<size_t>(m_size.x);
+        size_t const h = static_cast<size_t>(m_size.y);
+        m_corners.assign((w + 1) * (h + 1), 0);
+        m_horizontalEdges.assign(w * (h + 1), 0);
+        m_verticalEdges.assign((w + 1) * h, 0);
+        m_gids.assign(w * h, 0);
+        m_changed.assign(w * h, 0);
+        m_changedCells.clear();
+    }
+
+    /*!
+     * Creates the grid from the tiles of a (finite) tile layer. The colors are taken from the tiles of the wang set,
+     * including their flip flags, and the tiles of the layer are kept as they are until the terrain around them changes.
+     * @param layer A tile layer
+     */
+    void WangAutotiler::create(tson::Layer &layer)
+    {
+        create(layer.getSize().x, layer.getSize().y);
+        const std::vector<uint32_t> &data = layer.getData();
+        if(m_lookup == nullptr || data.size() != m_gids.size())
+            return;
+
+        int const w = m_size.x;
+        for(int y = 0; y < m_size.y; ++y)
+        {
+            for(int x = 0; x < w; ++x)
+            {
+                size_t const index = static_cast<size_t>(y * w + x);
+                m_gids[index] = data[index];
+                uint64_t const wangId = m_lookup->getWangId(data[index]);
+                if(wangId == 0)
+                    continue;
+
+                m_horizontalEdges[static_cast<size_t>(y * w + x)] = tson::WangLookup::GetColor(wangId, 0);
+                m_verticalEdges[static_cast<size_t>(y * (w + 1) + x + 1)] = tson::WangLookup::GetColor(wangId, 2);
+                m_horizontalEdges[static_cast<size_t>((y + 1) * w + x)] = tson::WangLookup::GetColor(wangId, 4);
+                m_verticalEdges[static_cast<size_t>(y * (w + 1) + x)] = tson::WangLookup::GetColor(wangId, 6);
+                m_corners[static_cast<size_t>(y * (w + 1) + x + 1)] = tson::WangLookup::GetColor(wangId, 1);
+                m_corners[static_cast<size_t>((y + 1) * (w + 1) + x + 1)] = tson::WangLookup::GetColor(wangId, 3);
+                m_corners[static_cast<size_t>((y + 1) * (w + 1) + x)] = tson::WangLookup::GetColor(wangId, 5);
+                m_corners[static_cast<size_t>(y * (w + 1) + x)] = tson::WangLookup::GetColor(wangId, 7);
+            }
+        }
+    }
+
+    /*!
+     * Gives a whole cell a color: Its four corners and/or its four edges, depending on what the wang set uses.
+     * The cell and its eight neighbours are resolved again.
+     * @param x X position of the cell in tiles
+     * @param y Y position of the cell in tiles
+     * @param color The wang color (1-based, as in Tiled). 0 removes the terrain.
+     */
+    void WangAutotiler::paint(int x, int y, uint8_t color)
+    {
+        if(!contains(x, y))
+            return;
+
+        int const w = m_size.x;
+        if(m_usesCorners)
+        {
+            m_corners[static_cast<size_t>(y * (w + 1) + x)] = color;
+            m_corners[static_cast<size_t>(y * (w + 1) + x + 1)] = color;
+            m_corners[static_cast<size_t>((y + 1) * (w + 1) + x)] = color;
+            m_corners[static_cast<size_t>((y + 1) * (w + 1) + x + 1)] = color;
+        }
+        if(m_usesEdges)
+        {
+            m_horizontalEdges[static_cast<size_t>(y * w + x)] = color;
+            m_horizontalEdges[static_cast<size_t>((y + 1) * w + x)] = color;
+            m_verticalEdges[static_cast<size_t>(y * (w + 1) + x)] = color;
+            m_verticalEdges[static_cast<size_t>(y * (w + 1) + x + 1)] = color;
+        }
+
+        for(int ny = y - 1; ny <= y + 1; ++ny)
+            for(int nx = x - 1; nx <= x + 1; ++nx)
+                resolve(nx, ny);
+    }
+
+    /*!
+     * Sets the color of a single corner, like the terrain brush of Tiled. The four cells sharing the corner are resolved again.
+     * @param x X position of the corner: 0 is the left side of the grid, and width the right side
+     * @param y Y position of the corner: 0 is the top of the grid, and height the bottom
+     * @param color The wang color (1-based, as in Tiled). 0 removes the terrain.
+     */
+    void WangAutotiler::setCornerColor(int x, int y, uint8_t color)
+    {
+        if(x < 0 || y < 0 || x > m_size.x || y > m_size.y)
+            return;
+
+        m_corners[static_cast<size_t>(y * (m_size.x + 1) + x)] = color;
+        resolve(x - 1, y - 1);
+        resolve(x, y - 1);
+        resolve(x - 1, y);
+        resolve(x, y);
+    }
+
+    /*!
+     * Gets the tile of a cell.
+     * @return The gid with flip flags. 0 if the cell has no tile, or is outside the grid.
+     */
+    uint32_t WangAutotiler::getGid(int x, int y) const
+    {
+        return (contains(x, y)) ? m_gids[static_cast<size_t>(y * m_size.x + x)] : 0;
+    }
+
+    /*!
+     * Gets the colors around a cell as a packed wang id (see tson::WangLookup).
+     */
+    uint64_t WangAutotiler::getWangId(int x, int y) const
+    {
+        if(!contains(x, y))
+            return 0;
+
+        int const w = m_size.x;
+        uint64_t wangId = 0;
+        if(m_usesEdges)
+        {
+            wangId |= static_cast<uint64_t>(m_horizontalEdges[static_cast<size_t>(y * w + x)]);
+            wangId |= static_cast<uint64_t>(m_verticalEdges[static_cast<size_t>(y * (w + 1) + x + 1)]) << 16;
+            wangId |= static_cast<uint64_t>(m_horizontalEdges[static_cast<size_t>((y + 1) * w + x)]) << 32;
+            wangId |= static_cast<uint64_t>(m_verticalEdges[static_cast<size_t>(y * (w + 1) + x)]) << 48;
+        }
+        if(m_usesCorners)
+        {
+            wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>(y * (w + 1) + x + 1)]) << 8;
+            wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>((y + 1) * (w + 1) + x + 1)]) << 24;
+            wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>((y + 1) * (w + 1) + x)]) << 40;
+            wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>(y * (w + 1) + x)]) << 56;
+        }
+        return wangId;
+    }
+
+    /*!
+     * The gids of all cells (row-major), with flip flags
+     */
+    const std::vector<uint32_t> &WangAutotiler::getGids() const
+    {
+        return m_gids;
+    }
+
+    /*!
+     * Size of the grid in tiles
+     */
+    const tson::Vector2i &WangAutotiler::getSize() const
+    {
+        return m_size;
+    }
+
+    /*!
+     * The cells whose gid changed since the last call to clearChangedCells(), each listed once.
+     */
+    const std::vector<tson::Vector2i> &WangAutotiler::getChangedCells() const
+    {
+        return m_changedCells;
+    }
+
+    void WangAutotiler::clearChangedCells()
+    {
+        for(const auto &cell : m_changedCells)
+            m_changed[static_cast<size_t>(cell.y * m_size.x + cell.x)] = 0;
+        m_changedCells.clear();
+    }
+
+    bool WangAutotiler::contains(int x, int y) const
+    {
+        return x >= 0 && y >= 0 && x < m_size.x && y < m_size.y;
+    }
+
+    /*!
+     * Picks the tile for the colors around a cell
+     */
+    void WangAutotiler::resolve(int x, int y)
+    {
+        if(!contains(x, y) || m_lookup == nullptr)
+            return;
+
+        uint64_t const wangId = getWangId(x, y);
+        uint32_t gid = 0;
+        if(wangId != 0)
+        {
+            tson::WangCandidates const candidates = m_lookup->find(wangId);
+            if(!candidates.empty())
+            {
+                //A hash of the position gives variation between cells, while staying the same for each cell
+                uint32_t const hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+                gid = candidates.gids[hash % candidates.count];
+            }
+            else
+                gid = findBestMatch(wangId);
+        }
+
+        size_t const index = static_cast<size_t>(y * m_size.x + x);
+        if(m_gids[index] == gid)
+            return;
+
+        m_gids[index] = gid;
+        if(m_changed[index] == 0)
+        {
+            m_changed[index] = 1;
+            m_changedCells.emplace_back(x, y);
+        }
+    }
+
+    /*!
+     * The first tile with the most colors in common with the wang id. Searches all wang ids once, and remembers the result.
+     */
+    uint32_t WangAutotiler::findBestMatch(uint64_t wangId)
+    {
+        auto it = m_bestMatches.find(wangId);
+        if(it != m_bestMatches.end())
+            return it->second;
+
+        uint32_t gid = 0;
+        int bestScore = 0;
+        for(uint64_t other : m_lookup->getWangIds())
+        {
+            int score = 0;
+            for(int i = 0; i < 8; ++i)
+            {
+                uint8_t const color = tson::WangLookup::GetColor(wangId, i);
+                if(color != 0 && color == tson::WangLookup::GetColor(other, i))
+                    ++score;
+            }
+
+            tson::WangCandidates const candidates = m_lookup->find(other);
+            if(score > bestScore && !candidates.empty())
+            {
+                bestScore = score;
+                gid = candidates.gids[0];
+            }
+        }
+
+        m_bestMatches[wangId] = gid;
+        return gid;
+    }
+}
+
+#endif //TILESON_WANGAUTOTILER_HPP
@@ -0,0 +1,265 @@
+#ifndef TILESON_WANGLOOKUP_HPP
+#define TILESON_WANGLOOKUP_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "../tiled/WangTile.hpp"
+#include "../tiled/Transformations.hpp"
+
+namespace tson
+{
+    /*!
+     * The tiles matching a packed wang id. Gids include the flip flags of the transformation.
+     */
+    class WangCandidates
+    {
+        public:
+            /*! First gid. nullptr when nothing matches */
+            const uint32_t *gids {nullptr};
+            /*! Number of gids */
+            uint32_t count {0};
+
+            [[nodiscard]] inline bool empty() const { return count == 0; }
+    };
+
+    /*!
+     * A hash from wang ids to tiles, created by tson::Tileset for each of its tson::WangSet.
+     *
+     * A wang id is packed into 64 bits: one byte per color, in the order of Tiled (top, top-right, right, bottom-right, bottom,
+     * bottom-left, left, top-left), with the top in the lowest byte. When the tileset allows transformations, the flipped and rotated
+     * variants of every wang tile are added as well, with the flip flags in their gid.
+     */
+    class WangLookup
+    {
+        public:
+            inline WangLookup() = default;
+
+            inline void build(const std::vector<tson::WangTile> &wangTiles, const tson::Transformations &transformations, uint32_t firstgid);
+
+            [[nodiscard]] inline tson::WangCandidates find(uint64_t wangId) const;
+            [[nodiscard]] inline uint64_t getWangId(uint32_t gid) const;
+            [[nodiscard]] inline const std::vector<uint64_t> &getWangIds() const;
+            [[nodiscard]] inline bool usesCorners() const;
+            [[nodiscard]] inline bool usesEdges() const;
+            [[nodiscard]] inline size_t size() const;
+
+            inline static uint64_t Pack(const std::vector<uint32_t> &wangId);
+            inline static uint8_t GetColor(uint64_t wangId, int index);
+            inline static uint64_t Transform(uint64_t wangId, uint32_t flipFlags);
+
+            static constexpr uint64_t CornerMask = 0xFF00FF00FF00FF00;  /*! The bytes of the corners */
+            static constexpr uint64_t EdgeMask = 0x00FF00FF00FF00FF;    /*! The bytes of the edges */
+
+        private:
+            static constexpr uint32_t FLIP_FLAGS = FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG;
+
+            class Entry
+            {
+                public:
+                    uint32_t first {};          /*! Index of the first gid in m_gids */
+                    uint32_t count {};
+                    uint32_t untransformed {};  /*! Number of gids without flip flags, which come first */
+            };
+
+            inline static uint64_t Permute(uint64_t wangId, const int (&sourceIndices)[8]);
+
+            bool                                    m_preferUntransformed {false};
+            std::unordered_map<uint64_t, Entry>     m_entries;
+            std::vector<uint64_t>                   m_wangIds;      /*! Every wang id in m_entries */
+            std::vector<uint32_t>                   m_gids;
+            std::unordered_map<uint32_t, uint64_t>  m_tileWangIds;  /*! Gid without flip flags -> wang id */
+    };
+
+    /*!
+     * Creates the lookup. Wang ids with one or more colors set only match tiles having exactly the same colors.
+     * @param wangTiles The wang tiles of a wang set
+     * @param transformations The transformations allowed by the tileset
+     * @param firstgid The first gid of the tileset
+     */
+    void WangLookup::build(const std::vector<tson::WangTile> &wangTiles, const tson::Transformations &transformations, uint32_t firstgid)
+    {
+        m_entries.clear();
+        m_wangIds.clear();
+        m_gids.clear();
+        m_tileWangIds.clear();
+        m_preferUntransformed = transformations.allowPreferuntransformed();
+
+        //Flip flags of every allowed transformation. Rotations by 90 degrees are diagonal flips combined with a horizontal or vertical flip.
+        std::vector<uint32_t> flags {0};
+        bool const hflip = transformations.allowHflip();
+        bool const vflip = transformations.allowVflip();
+        if(transformations.allowRotation())
+        {
+            flags.insert(flags.end(), {FLIPPED_DIAGONALLY_FLAG | FLIPPED_HORIZONTALLY_FLAG, FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG,
+                                       FLIPPED_DIAGONALLY_FLAG | FLIPPED_VERTICALLY_FLAG});
+            if(hflip || vflip)
+                flags.insert(flags.end(), {FLIPPED_HORIZONTALLY_FLAG, FLIPPED_VERTICALLY_FLAG, FLIPPED_DIAGONALLY_FLAG,
+                                           FLIPPED_DIAGONALLY_FLAG | FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG});
+        }
+        else
+        {
+            if(hflip)
+                flags.push_back(FLIPPED_HORIZONTALLY_FLAG);
+            if(vflip)
+                flags.push_back(FLIPPED_VERTICALLY_FLAG);
+            if(hflip && vflip)
+                flags.push_back(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG);
+        }
+
+        //(wang id, gid) of every variant, grouped by wang id with the untransformed tiles first
+        std::vector<std::pair<uint64_t, uint32_t>> variants;
+        variants.reserve(wangTiles.size() * flags.size());
+        for(const auto &wangTile : wangTiles)
+        {
+            uint64_t const wangId = Pack(wangTile.getWangIds());
+            if(wangId == 0)
+                continue;
+
+            uint32_t const gid = firstgid + wangTile.getTileid();
+            m_tileWangIds[gid] = wangId;
+            for(uint32_t flag : flags)
+                variants.emplace_back(Transform(wangId, flag), gid | flag);
+        }
+        std::stable_sort(variants.begin(), variants.end(), [](const auto &a, const auto &b)
+        {
+            if(a.first != b.first)
+                return a.first < b.first;
+            return (a.second & FLIP_FLAGS) == 0 && (b.second & FLIP_FLAGS) != 0;
+        });
+
+        m_gids.reserve(variants.size());
+        for(const auto &[wangId, gid] : variants)
+        {
+            auto [entry, inserted] = m_entries.try_emplace(wangId);
+            if(inserted)
+            {
+                entry->second.first = static_cast<uint32_t>(m_gids.size());
+                m_wangIds.push_back(wangId);
+            }
+
+            //Symmetric tiles look the same with different flags. Only the first one is kept.
+            uint32_t const tileGid = gid & ~FLIP_FLAGS;
+            const uint32_t *begin = m_gids.data() + entry->second.first;
+            if(std::any_of(begin, begin + entry->second.count, [&](uint32_t other) { return (other & ~FLIP_FLAGS) == tileGid; }))
+                continue;
+
+            m_gids.push_back(gid);
+            ++entry->second.count;
+            if(gid == tileGid)
+                ++entry->second.untransformed;
+        }
+    }
+
+    /*!
+     * Gets the tiles that match a wang id exactly.
+     * When the tileset prefers untransformed tiles, transformed variants are only given when no untransformed tile matches.
+     * @param wangId A packed wang id
+     */
+    tson::WangCandidates WangLookup::find(uint64_t wangId) const
+    {
+        auto it = m_entries.find(wangId);
+        if(it == m_entries.end())
+            return {};
+
+        const Entry &entry = it->second;
+        uint32_t const count = (m_preferUntransformed && entry.untransformed > 0) ? entry.untransformed : entry.count;
+        return {m_gids.data() + entry.first, count};
+    }
+
+    /*!
+     * Gets the wang id of a gid, as it looks with its flip flags.
+     * @param gid Gid with or without flip flags
+     * @return The packed wang id. 0 if the gid is not part of the wang set.
+     */
+    uint64_t WangLookup::getWangId(uint32_t gid) const
+    {
+        uint32_t const flags = gid & FLIP_FLAGS;
+        auto it = m_tileWangIds.find(gid & ~flags);
+        return (it == m_tileWangIds.end()) ? 0 : Transform(it->second, flags);
+    }
+
+    /*!
+     * Every distinct wang id, including those of transformed tiles
+     */
+    const std::vector<uint64_t> &WangLookup::getWangIds() const
+    {
+        return m_wangIds;
+    }
+
+    /*!
+     * true if any tile has a corner color
+     */
+    bool WangLookup::usesCorners() const
+    {
+        return std::any_of(m_wangIds.begin(), m_wangIds.end(), [](uint64_t wangId) { return (wangId & CornerMask) != 0; });
+    }
+
+    /*!
+     * true if any tile has an edge color
+     */
+    bool WangLookup::usesEdges() const
+    {
+        return std::any_of(m_wangIds.begin(), m_wangIds.end(), [](uint64_t wangId) { return (wangId & EdgeMask) != 0; });
+    }
+
+    /*!
+     * Number of distinct wang ids
+     */
+    size_t WangLookup::size() const
+    {
+        return m_wangIds.size();
+    }
+
+    /*!
+     * Packs the 'wangid' of a tson::WangTile into 64 bits. Colors above 255 are not supported by Tiled, and are cut off.
+     */
+    uint64_t WangLookup::Pack(const std::vector<uint32_t> &wangId)
+    {
+        uint64_t packed = 0;
+        for(size_t i = 0; i < wangId.size() && i < 8; ++i)
+            packed |= static_cast<uint64_t>(wangId[i] & 0xFF) << (8 * i);
+        return packed;
+    }
+
+    /*!
+     * Gets one color of a packed wang id.
+     * @param index 0 = top, 1 = top-right ... 7 = top-left
+     */
+    uint8_t WangLookup::GetColor(uint64_t wangId, int index)
+    {
+        return static_cast<uint8_t>(wangId >> (8 * index));
+    }
+
+    /*!
+     * Gets the wang id of a tile as it looks when drawn with flip flags. Tiled applies the diagonal flip first,
+     * then the horizontal flip, and then the vertical flip.
+     */
+    uint64_t WangLookup::Transform(uint64_t wangId, uint32_t flipFlags)
+    {
+        static constexpr int Diagonal[8] {6, 5, 4, 3, 2, 1, 0, 7};
+        static constexpr int Horizontal[8] {0, 7, 6, 5, 4, 3, 2, 1};
+        static constexpr int Vertical[8] {4, 3, 2, 1, 0, 7, 6, 5};
+        if((flipFlags & FLIPPED_DIAGONALLY_FLAG) != 0)
+            wangId = Permute(wangId, Diagonal);
+        if((flipFlags & FLIPPED_HORIZONTALLY_FLAG) != 0)
+            wangId = Permute(wangId, Horizontal);
+        if((flipFlags & FLIPPED_VERTICALLY_FLAG) != 0)
+            wangId = Permute(wangId, Vertical);
+        return wangId;
+    }
+
+    /*!
+     * Byte i of the result is byte sourceIndices[i] of the input
+     */
+    uint64_t WangLookup::Permute(uint64_t wangId, const int (&sourceIndices)[8])
+    {
+        uint64_t result = 0;
+        for(int i = 0; i < 8; ++i)
+            result |= static_cast<uint64_t>(GetColor(wangId, sourceIndices[i])) << (8 * i);
+        return result;
+    }
+}
+
+#endif //TILESON_WANGLOOKUP_HPP
@@ -0,0 +1,445 @@
+#ifndef TILESON_WORLDSTREAMER_HPP
+#define TILESON_WORLDSTREAMER_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <condition_variable>
+
+namespace tson
+{
+    /*!
+     * Keeps the maps of a tson::World near a focus point loaded, for worlds with far more maps than fit in memory.
+     *
+     * Maps whose rectangle (position and size from tson::WorldMapData) is within the focus radius are parsed on background threads,
+     * nearest first. The memory of the loaded maps is kept within a byte budget: Maps outside the focus stay loaded as a cache,
+     * and the least recently used of them are evicted first when room is needed. Maps inside the focus are only loaded when they fit.
+     *
+     * Everything except the background parsing happens in update(), which is meant to be called once per frame from the game thread.
+     * Finished maps are published there as a whole, so the game thread never sees a map that is still being parsed.
+     * Pointers from getMap() stay valid until the next call to update().
+     *
+     * Example:
+     * tson::World world {"worlds/overworld.world"};
+     * tson::WorldStreamer streamer {world, 2};
+     * streamer.setByteBudget(256 * 1024 * 1024);
+     * //Every frame:
+     * streamer.setFocus(player.position, 2000.f);
+     * streamer.update();
+     * for(size_t i : streamer.getLoadedMaps())
+     *     draw(*streamer.getMap(i), streamer.getMapData()[i].position);
+     */
+    class WorldStreamer
+    {
+        public:
+            /*! Creates the parser of a background thread. Each thread gets its own. */
+            using ParserFactory = std::function<std::unique_ptr<tson::Tileson>()>;
+
+            #ifdef JSON11_IS_DEFINED
+            inline explicit WorldStreamer(const tson::World &world, size_t threadCount = 1); //tileson_forward.hpp
+            #endif
+            inline WorldStreamer(const tson::World &world, ParserFactory parserFactory, size_t threadCount = 1);
+            inline ~WorldStreamer();
+
+            WorldStreamer(const WorldStreamer &) = delete;
+            WorldStreamer &operator=(const WorldStreamer &) = delete;
+
+            inline void setByteBudget(size_t bytes);
+            inline void setFocus(const tson::Vector2f &center, float radius);
+            inline size_t update();
+            inline void flush();
+
+            [[nodiscard]] inline tson::Map *getMap(size_t index);
+            [[nodiscard]] inline bool isLoaded(size_t index) const;
+            [[nodiscard]] inline bool isPending(size_t index) const;
+            [[nodiscard]] inline const std::vector<size_t> &getLoadedMaps() const;
+            [[nodiscard]] inline const std::vector<tson::WorldMapData> &getMapData() const;
+            [[nodiscard]] inline size_t getByteBudget() const;
+            [[nodiscard]] inline size_t getUsedBytes() const;
+
+            inline static size_t EstimateBytes(tson::Map &map);
+
+        private:
+            enum class SlotState : uint8_t
+            {
+                Unloaded = 0,
+                Pending = 1,    //Queued or being parsed
+                Loaded = 2,
+                Failed = 3      //The file does not exist, could not be parsed, or parsing threw
+            };
+
+            class Slot
+            {
+                public:
+                    SlotState                   state {SlotState::Unloaded};
+                    std::unique_ptr<tson::Map>  map;
+                    size_t                      bytes {};           /*! Memory of the loaded map */
+                    size_t                      estimate {};        /*! Expected memory before loading. 0 = unknown */
+                    uint64_t                    lastUsed {};        /*! Last update in which the map was inside the focus */
+            };
+
+            /*! Counts a job as finished when it goes out of scope, even when parsing throws */
+            class ActiveJob
+            {
+                public:
+                    inline explicit ActiveJob(WorldStreamer &streamer) : m_streamer {streamer} {}
+                    inline ~ActiveJob();
+
+                    ActiveJob(const ActiveJob &) = delete;
+                    ActiveJob &operator=(const ActiveJob &) = delete;
+
+                private:
+                    WorldStreamer &m_streamer;
+            };
+
+            inline void start(size_t threadCount);
+            inline void workerLoop(); //tileson_forward.hpp
+            inline size_t publishFinished();
+            inline void scheduleLoads(const std::vector<size_t> &wanted);
+            inline bool evictLeastRecentlyUsed();
+            inline void evict(size_t index);
+            [[nodiscard]] inline float getDistance(size_t index) const;
+            inline static void EstimateLayerBytes(std::vector<tson::Layer> &layers, size_t &bytes);
+
+            std::vector<tson::WorldMapData>     m_mapData;
+            std::vector<Slot>                   m_slots;
+            std::vector<size_t>                 m_loadedMaps;
+            ParserFactory                       m_parserFactory;
+
+            size_t                              m_byteBudget {std::numeric_limits<size_t>::max()};
+            size_t                              m_usedBytes {};         /*! Memory of the loaded maps */
+            size_t                              m_reservedBytes {};     /*! Expected memory of the pending maps */
+            tson::Vector2f                      m_focusCenter;
+            float                               m_focusRadius {};
+            uint64_t                            m_tick {};
+
+            //Shared with the background threads. Guarded by m_mutex.
+            std::mutex                          m_mutex;
+            std::condition_variable             m_workAvailable;
+            std::condition_variable             m_workDone;
+            std::vector<size_t>                 m_queue;                /*! Maps to parse, nearest last */
+            std::vector<std::pair<size_t, std::unique_ptr<tson::Map>>> m_finished;
+            size_t                              m_activeJobs {};
+            bool                                m_stop {false};
+            std::vector<std::thread>            m_threads;
+    };
+
+    /*!
+     * @param world The world. Its map data is copied, so the world does not have to outlive the streamer.
+     * @param parserFactory Creates a tson::Tileson for each background thread
+     * @param threadCount Number of background threads. 0 uses the number of hardware threads.
+     */
+    WorldStreamer::WorldStreamer(const tson::World &world, ParserFactory parserFactory, size_t threadCount)
+        : m_mapData {world.getMapData()}, m_slots(world.getMapData().size()), m_parserFactory {std::move(parserFactory)}
+    {
+        start(threadCount);
+    }
+
+    /*!
+     * Stops the background threads. Maps that are being parsed are finished first.
+     */
+    WorldStreamer::~WorldStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_workAvailable.notify_all();
+        for(auto &thread : m_threads)
+            thread.join();
+    }
+
+    /*!
+     * Maximum memory of all loaded maps, as estimated by EstimateBytes(). Default: No limit
+     */
+    void WorldStreamer::setByteBudget(size_t bytes)
+    {
+        m_byteBudget = bytes;
+    }
+
+    /*!
+     * Maps within the radius of the center are loaded by the next update().
+     * @param center Center in pixels, in the coordinates of the world
+     * @param radius Radius in pixels
+     */
+    void WorldStreamer::setFocus(const tson::Vector2f &center, float radius)
+    {
+        m_focusCenter = center;
+        m_focusRadius = radius;
+    }
+
+    /*!
+     * Publishes the maps that finished loading, and decides which maps to load and evict for the current focus.
+     * @return Number of maps that were published
+     */
+    size_t WorldStreamer::update()
+    {
+        ++m_tick;
+        size_t const published = publishFinished();
+
+        std::vector<size_t> wanted;
+        for(size_t i = 0; i < m_slots.size(); ++i)
+        {
+            if(getDistance(i) <= m_focusRadius)
+            {
+                wanted.push_back(i);
+                m_slots[i].lastUsed = m_tick;
+            }
+        }
+        std::sort(wanted.begin(), wanted.end(), [&](size_t a, size_t b) { return getDistance(a) < getDistance(b); });
+
+        scheduleLoads(wanted);
+        while(m_usedBytes + m_reservedBytes > m_byteBudget && evictLeastRecentlyUsed()) {}
+
+        return published;
+    }
+
+    /*!
+     * Blocks until every map inside the focus that fits in the budget is loaded and published. Useful for loading screens.
+     */
+    void WorldStreamer::flush()
+    {
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_workDone.wait(lock, [&]() { return m_queue.empty() && m_activeJobs == 0; });
+            }
+            update();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_queue.empty() && m_activeJobs == 0 && m_finished.empty())
+                return;
+        }
+    }
+
+    /*!
+     * Gets a loaded map.
+     * @param index Index of the map in getMapData()
+     * @return The map, or nullptr if it is not loaded. Valid until the next update().
+     */
+    tson::Map *WorldStreamer::getMap(size_t index)
+    {
+        return (index < m_slots.size() && m_slots[index].state == SlotState::Loaded) ? m_slots[index].map.get() : nullptr;
+    }
+
+    bool WorldStreamer::isLoaded(size_t index) const
+    {
+        return index < m_slots.size() && m_slots[index].state == SlotState::Loaded;
+    }
+
+    /*!
+     * true if the map is waiting to be parsed, or is being parsed
+     */
+    bool WorldStreamer::isPending(size_t index) const
+    {
+        return index < m_slots.size() && m_slots[index].state == SlotState::Pending;
+    }
+
+    /*!
+     * Indices (in getMapData()) of all loaded maps
+     */
+    const std::vector<size_t> &WorldStreamer::getLoadedMaps() const
+    {
+        return m_loadedMaps;
+    }
+
+    /*!
+     * The map data of the world, in the same order as in tson::World
+     */
+    const std::vector<tson::WorldMapData> &WorldStreamer::getMapData() const
+    {
+        return m_mapData;
+    }
+
+    size_t WorldStreamer::getByteBudget() const
+    {
+        return m_byteBudget;
+    }
+
+    /*!
+     * Estimated memory of all loaded maps
+     */
+    size_t WorldStreamer::getUsedBytes() const
+    {
+        return m_usedBytes;
+    }
+
+    /*!
+     * Estimates the memory used by a parsed map: The map, its tilesets and tiles, and the tiles and objects of all layers.
+     * Strings and properties are not included.
+     */
+    size_t WorldStreamer::EstimateBytes(tson::Map &map)
+    {
+        size_t bytes = sizeof(tson::Map) + map.getTileDrawTable().size() * sizeof(tson::TileDrawInfo) +
+                       map.getTileMap().size() * (sizeof(std::pair<uint32_t, tson::Tile *>) + 2 * sizeof(void *));
+        for(auto &tileset : map.getTilesets())
+            bytes += sizeof(tson::Tileset) + tileset.getTiles().size() * sizeof(tson::Tile);
+
+        EstimateLayerBytes(map.getLayers(), bytes);
+        return bytes;
+    }
+
+    void WorldStreamer::EstimateLayerBytes(std::vector<tson::Layer> &layers, size_t &bytes)
+    {
+        //Nodes of std::map have three pointers and a color besides the value
+        size_t const nodeBytes = 4 * sizeof(void *);
+        for(auto &layer : layers)
+        {
+            bytes += sizeof(tson::Layer) + layer.getData().size() * sizeof(uint32_t) + layer.getObjects().size() * sizeof(tson::Object);
+            bytes += layer.getTileData().size() * (sizeof(std::pair<std::tuple<int, int>, tson::Tile *>) + nodeBytes);
+            bytes += layer.getTileObjects().size() * (sizeof(std::pair<std::tuple<int, int>, tson::TileObject>) + nodeBytes);
+            for(auto &chunk : layer.getChunks())
+                bytes += sizeof(tson::Chunk) + chunk.getData().size() * sizeof(int);
+
+            EstimateLayerBytes(layer.getLayers(), bytes);
+        }
+    }
+
+    void WorldStreamer::start(size_t threadCount)
+    {
+        if(threadCount == 0)
+            threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        for(size_t i = 0; i < threadCount; ++i)
+            m_threads.emplace_back([this]() { workerLoop(); });
+    }
+
+    WorldStreamer::ActiveJob::~ActiveJob()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_streamer.m_mutex);
+            --m_streamer.m_activeJobs;
+        }
+        m_streamer.m_workDone.notify_all();
+    }
+
+    /*!
+     * Moves the maps parsed by the background threads into their slots
+     * @return Number of maps that were loaded
+     */
+    size_t WorldStreamer::publishFinished()
+    {
+        std::vector<std::pair<size_t, std::unique_ptr<tson::Map>>> finished;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            finished.swap(m_finished);
+        }
+
+        size_t published = 0;
+        for(auto &[index, map] : finished)
+        {
+            Slot &slot = m_slots[index];
+            m_reservedBytes -= std::min(m_reservedBytes, slot.estimate);
+            if(map == nullptr || map->getStatus() != tson::ParseStatus::OK)
+            {
+                slot.state = SlotState::Failed;
+                continue;
+            }
+
+            slot.bytes = EstimateBytes(*map);
+            slot.estimate = slot.bytes;
+            slot.map = std::move(map);
+            slot.state = SlotState::Loaded;
+            m_usedBytes += slot.bytes;
+            m_loadedMaps.push_back(index);
+            ++published;
+        }
+        return published;
+    }
+
+    /*!
+     * Replaces the queue with the wanted maps that are not loaded yet, as long as they fit in the budget.
+     * @param wanted Maps inside the focus, nearest first
+     */
+    void WorldStreamer::scheduleLoads(const std::vector<size_t> &wanted)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            //Queued maps that have not been picked up yet are cancelled. The others are being parsed, and stay pending.
+            for(size_t index : m_queue)
+            {
+                m_slots[index].state = SlotState::Unloaded;
+                m_reservedBytes -= std::min(m_reservedBytes, m_slots[index].estimate);
+            }
+            m_queue.clear();
+
+            for(size_t index : wanted)
+            {
+                Slot &slot = m_slots[index];
+                if(slot.state != SlotState::Unloaded)
+                    continue;
+
+                //Before the first load, the size of the file is the best guess
+                if(slot.estimate == 0)
+                {
+                    std::error_code error;
+                    auto const fileSize = fs::file_size(m_mapData[index].path, error);
+                    slot.estimate = (error) ? 0 : static_cast<size_t>(fileSize);
+                }
+
+                while(m_usedBytes + m_reservedBytes + slot.estimate > m_byteBudget && evictLeastRecentlyUsed()) {}
+                if(m_usedBytes + m_reservedBytes + slot.estimate > m_byteBudget)
+                    break;
+
+                slot.state = SlotState::Pending;
+                m_reservedBytes += slot.estimate;
+                m_queue.push_back(index);
+            }
+            //Workers take from the back
+            std::reverse(m_queue.begin(), m_queue.end());
+        }
+        m_workAvailable.notify_all();
+    }
+
+    /*!
+     * Evicts the loaded map outside the focus that was inside it the longest time ago.
+     * @return false if every loaded map is inside the focus
+     */
+    bool WorldStreamer::evictLeastRecentlyUsed()
+    {
+        size_t best = m_slots.size();
+        for(size_t index : m_loadedMaps)
+        {
+            if(m_slots[index].lastUsed < m_tick && (best == m_slots.size() || m_slots[index].lastUsed < m_slots[best].lastUsed))
+                best = index;
+        }
+
+        if(best == m_slots.size())
+            return false;
+
+        evict(best);
+        return true;
+    }
+
+    void WorldStreamer::evict(size_t index)
+    {
+        Slot &slot = m_slots[index];
+        slot.map.reset();
+        slot.state = SlotState::Unloaded;
+        m_usedBytes -= std::min(m_usedBytes, slot.bytes);
+        slot.bytes = 0;
+        m_loadedMaps.erase(std::find(m_loadedMaps.begin(), m_loadedMaps.end(), index));
+    }
+
+    /*!
+     * Distance from the focus center to the rectangle of a map. 0 when the center is inside the map.
+     */
+    float WorldStreamer::getDistance(size_t index) const
+    {
+        const tson::WorldMapData &data = m_mapData[index];
+        float const left = static_cast<float>(data.position.x);
+        float const top = static_cast<float>(data.position.y);
+        float const dx = std::max({left - m_focusCenter.x, 0.f, m_focusCenter.x - (left + static_cast<float>(data.size.x))});
+        float const dy = std::max({top - m_focusCenter.y, 0.f, m_focusCenter.y - (top + static_cast<float>(data.size.y))});
+        return std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+#endif //TILESON_WORLDSTREAMER_HPP
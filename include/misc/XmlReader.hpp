@@ -0,0 +1,461 @@
+#ifndef TILESON_XMLREADER_HPP
+#define TILESON_XMLREADER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tson
+{
+    /*!
+     * A pull parser for XML: Each call to next() reads one element tag or one piece of text, and nothing is kept of what has been read.
+     * Names, attribute values and text are views into the data, so the data must outlive them.
+     *
+     * The XML declaration, processing instructions, comments and the DOCTYPE are skipped. Entities are left as they are
+     * in attribute values and text. Use Unescape() to resolve them.
+     *
+     * Example:
+     * tson::XmlReader reader {data, size};
+     * while(reader.next() == tson::XmlReader::Token::StartElement)
+     *     std::cout << reader.getName() << "\n";
+     */
+    class XmlReader
+    {
+        public:
+            enum class Token : uint8_t
+            {
+                StartElement = 0,   /*! <name attributes> or <name attributes/> */
+                EndElement = 1,     /*! </name>, also reported after an empty element */
+                Text = 2,           /*! Text, or the content of a CDATA section */
+                EndOfDocument = 3,
+                Error = 4
+            };
+
+            inline XmlReader(const char *data, size_t size);
+
+            inline Token next();
+            inline Token nextStartElement();
+            inline bool skipElement();
+            inline std::string_view readText();
+
+            [[nodiscard]] inline Token getToken() const;
+            [[nodiscard]] inline std::string_view getName() const;
+            [[nodiscard]] inline std::string_view getText() const;
+            [[nodiscard]] inline const std::vector<std::pair<std::string_view, std::string_view>> &getAttributes() const;
+            [[nodiscard]] inline std::string_view getAttribute(std::string_view name) const;
+            [[nodiscard]] inline bool hasAttribute(std::string_view name) const;
+            [[nodiscard]] inline bool isEmptyElement() const;
+            [[nodiscard]] inline size_t getDepth() const;
+            [[nodiscard]] inline size_t getTokenOffset() const;
+            [[nodiscard]] inline size_t getOffset() const;
+
+            inline static std::string Unescape(std::string_view text);
+
+        private:
+            inline Token fail();
+            inline bool skipPast(std::string_view terminator);
+            inline bool readTag();
+            inline void skipWhitespace();
+            [[nodiscard]] inline static bool IsNameChar(char c);
+
+            const char *            m_data;
+            size_t                  m_size;
+            size_t                  m_pos {0};
+            size_t                  m_depth {0};
+            size_t                  m_tokenStart {0};       /*! Offset of the '<' of the current tag */
+            Token                   m_token {Token::EndOfDocument};
+            bool                    m_isEmptyElement {false};
+            bool                    m_pendingEnd {false};    /*! An empty element has been reported, but not its end */
+            std::string_view        m_name;
+            std::string_view        m_text;
+            std::vector<std::pair<std::string_view, std::string_view>> m_attributes;
+    };
+
+    XmlReader::XmlReader(const char *data, size_t size) : m_data {data}, m_size {size}
+    {
+        //Skip the UTF-8 byte order mark
+        if(m_size >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+            m_pos = 3;
+    }
+
+    /*!
+     * Reads the next element tag or text
+     * @return Token::EndOfDocument when all the data has been read, Token::Error if the data is not well-formed
+     */
+    XmlReader::Token XmlReader::next()
+    {
+        if(m_token == Token::Error)
+            return m_token;
+
+        if(m_pendingEnd)
+        {
+            m_pendingEnd = false;
+            m_isEmptyElement = false;
+            m_attributes.clear();
+            --m_depth;
+            return m_token = Token::EndElement;
+        }
+
+        while(m_pos < m_size)
+        {
+            if(m_data[m_pos] != '<')
+            {
+                size_t const start = m_pos;
+                const void *end = std::memchr(m_data + m_pos, '<', m_size - m_pos);
+                m_pos = (end != nullptr) ? static_cast<size_t>(static_cast<const char *>(end) - m_data) : m_size;
+                m_text = std::string_view(m_data + start, m_pos - start);
+                return m_token = Token::Text;
+            }
+
+            std::string_view const rest(m_data + m_pos, m_size - m_pos);
+            if(rest.compare(0, 4, "<!--") == 0)
+            {
+                if(!skipPast("-->"))
+                    return fail();
+            }
+            else if(rest.compare(0, 9, "<![CDATA[") == 0)
+            {
+                size_t const start = m_pos + 9;
+                if(!skipPast("]]>"))
+                    return fail();
+                m_text = std::string_view(m_data + start, m_pos - 3 - start);
+                return m_token = Token::Text;
+            }
+            else if(rest.compare(0, 2, "<?") == 0)
+            {
+                if(!skipPast("?>"))
+                    return fail();
+            }
+            else if(rest.compare(0, 2, "<!") == 0)
+            {
+                //DOCTYPE. An internal subset in brackets may contain '>'
+                size_t const bracket = rest.find('[');
+                size_t const close = rest.find('>');
+                if(bracket != std::string_view::npos && bracket < close && !skipPast("]"))
+                    return fail();
+                if(!skipPast(">"))
+                    return fail();
+            }
+            else
+            {
+                m_tokenStart = m_pos;
+                return (readTag()) ? m_token : fail();
+            }
+        }
+
+        return m_token = (m_depth == 0) ? Token::EndOfDocument : fail();
+    }
+
+    /*!
+     * Reads until the next start element of the current element, skipping text.
+     * @return Token::StartElement, or Token::EndElement when the current element has no more children.
+     */
+    XmlReader::Token XmlReader::nextStartElement()
+    {
+        Token token = next();
+        while(token == Token::Text)
+            token = next();
+        return token;
+    }
+
+    /*!
+     * Skips the rest of the current element, including all its children. Call after Token::StartElement.
+     * @return false if the data ended before the element
+     */
+    bool XmlReader::skipElement()
+    {
+        size_t const depth = m_depth;
+        while(m_depth >= depth)
+        {
+            Token const token = next();
+            if(token == Token::Error || token == Token::EndOfDocument)
+                return false;
+        }
+        return true;
+    }
+
+    /*!
+     * Reads the text of the current element, and its end. Call after Token::StartElement.
+     * Only the first piece of text is returned if the element also has children, which are skipped.
+     */
+    std::string_view XmlReader::readText()
+    {
+        size_t const depth = m_depth;
+        std::string_view text;
+        bool hasText = false;
+        while(true)
+        {
+            Token const token = next();
+            if(token == Token::Error || token == Token::EndOfDocument)
+                return std::string_view();
+            if(m_depth < depth)
+                return text;
+            if(token == Token::Text && m_depth == depth && !hasText)
+            {
+                text = m_text;
+                hasText = true;
+            }
+        }
+    }
+
+    XmlReader::Token XmlReader::getToken() const
+    {
+        return m_token;
+    }
+
+    /*!
+     * The name of the element of Token::StartElement and Token::EndElement
+     */
+    std::string_view XmlReader::getName() const
+    {
+        return m_name;
+    }
+
+    /*!
+     * The text of Token::Text, with entities unresolved
+     */
+    std::string_view XmlReader::getText() const
+    {
+        return m_text;
+    }
+
+    /*!
+     * The attributes of Token::StartElement, in the order they appear. Values have their entities unresolved.
+     */
+    const std::vector<std::pair<std::string_view, std::string_view>> &XmlReader::getAttributes() const
+    {
+        return m_attributes;
+    }
+
+    /*!
+     * The value of an attribute of Token::StartElement, with entities unresolved. Empty if it does not exist.
+     */
+    std::string_view XmlReader::getAttribute(std::string_view name) const
+    {
+        for(const auto &[attributeName, value] : m_attributes)
+        {
+            if(attributeName == name)
+                return value;
+        }
+        return std::string_view();
+    }
+
+    bool XmlReader::hasAttribute(std::string_view name) const
+    {
+        for(const auto &attribute : m_attributes)
+        {
+            if(attribute.first == name)
+                return true;
+        }
+        return false;
+    }
+
+    /*!
+     * true if the element of Token::StartElement is written as <name/>. Its Token::EndElement is still reported.
+     */
+    bool XmlReader::isEmptyElement() const
+    {
+        return m_isEmptyElement;
+    }
+
+    /*!
+     * The number of elements that are open. The root element is at depth 1.
+     */
+    size_t XmlReader::getDepth() const
+    {
+        return m_depth;
+    }
+
+    /*!
+     * Offset in the data of the '<' of the current start or end tag.
+     * Together with getOffset() after skipElement(), this gives the whole text of an element.
+     */
+    size_t XmlReader::getTokenOffset() const
+    {
+        return m_tokenStart;
+    }
+
+    /*!
+     * Offset in the data right after what has been read
+     */
+    size_t XmlReader::getOffset() const
+    {
+        return m_pos;
+    }
+
+    /*!
+     * Resolves the predefined entities (&amp; &lt; &gt; &quot; &apos;) and character references (&#10; &#x20AC;) of a text.
+     * Unknown entities are kept as they are.
+     */
+    std::string XmlReader::Unescape(std::string_view text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        size_t pos = 0;
+        while(pos < text.size())
+        {
+            size_t const amp = text.find('&', pos);
+            if(amp == std::string_view::npos)
+            {
+                result.append(text.substr(pos));
+                break;
+            }
+            result.append(text.substr(pos, amp - pos));
+            size_t const semicolon = text.find(';', amp);
+            if(semicolon == std::string_view::npos)
+            {
+                result.append(text.substr(amp));
+                break;
+            }
+
+            std::string_view const entity = text.substr(amp + 1, semicolon - amp - 1);
+            pos = semicolon + 1;
+            if(entity == "amp") result += '&';
+            else if(entity == "lt") result += '<';
+            else if(entity == "gt") result += '>';
+            else if(entity == "quot") result += '"';
+            else if(entity == "apos") result += '\'';
+            else if(entity.size() > 1 && entity[0] == '#')
+            {
+                bool const isHex = entity[1] == 'x' || entity[1] == 'X';
+                uint32_t code = std::strtoul(std::string(entity.substr(isHex ? 2 : 1)).c_str(), nullptr, isHex ? 16 : 10);
+
+                //Encoded as UTF-8
+                if(code < 0x80)
+                    result += static_cast<char>(code);
+                else if(code < 0x800)
+                {
+                    result += static_cast<char>(0xC0 | (code >> 6));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if(code < 0x10000)
+                {
+                    result += static_cast<char>(0xE0 | (code >> 12));
+                    result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    result += static_cast<char>(0xF0 | (code >> 18));
+                    result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+            else
+                result.append(text.substr(amp, pos - amp));
+        }
+        return result;
+    }
+
+    XmlReader::Token XmlReader::fail()
+    {
+        m_pendingEnd = false;
+        return m_token = Token::Error;
+    }
+
+    /*!
+     * Moves past the next occurrence of 'terminator'
+     */
+    bool XmlReader::skipPast(std::string_view terminator)
+    {
+        size_t const found = std::string_view(m_data, m_size).find(terminator, m_pos);
+        if(found == std::string_view::npos)
+            return false;
+        m_pos = found + terminator.size();
+        return true;
+    }
+
+    void XmlReader::skipWhitespace()
+    {
+        while(m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\t' || m_data[m_pos] == '\n' || m_data[m_pos] == '\r'))
+            ++m_pos;
+    }
+
+    bool XmlReader::IsNameChar(char c)
+    {
+        return c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '/' && c != '>' && c != '=';
+    }
+
+    /*!
+     * Reads a start or end tag. m_pos is at its '<'.
+     */
+    bool XmlReader::readTag()
+    {
+        ++m_pos;
+        m_attributes.clear();
+        m_isEmptyElement = false;
+        bool const isEnd = m_pos < m_size && m_data[m_pos] == '/';
+        if(isEnd)
+            ++m_pos;
+
+        size_t const nameStart = m_pos;
+        while(m_pos < m_size && IsNameChar(m_data[m_pos]))
+            ++m_pos;
+        m_name = std::string_view(m_data + nameStart, m_pos - nameStart);
+        if(m_name.empty())
+            return false;
+
+        if(isEnd)
+        {
+            skipWhitespace();
+            if(m_pos >= m_size || m_data[m_pos] != '>' || m_depth == 0)
+                return false;
+            ++m_pos;
+            --m_depth;
+            m_token = Token::EndElement;
+            return true;
+        }
+
+        while(true)
+        {
+            skipWhitespace();
+            if(m_pos >= m_size)
+                return false;
+
+            char const c = m_data[m_pos];
+            if(c == '>')
+            {
+                ++m_pos;
+                break;
+            }
+            if(c == '/')
+            {
+                if(m_pos + 1 >= m_size || m_data[m_pos + 1] != '>')
+                    return false;
+                m_pos += 2;
+                m_isEmptyElement = true;
+                m_pendingEnd = true;
+                break;
+            }
+
+            size_t const attributeStart = m_pos;
+            while(m_pos < m_size && IsNameChar(m_data[m_pos]))
+                ++m_pos;
+            std::string_view const attributeName(m_data + attributeStart, m_pos - attributeStart);
+            skipWhitespace();
+            if(attributeName.empty() || m_pos >= m_size || m_data[m_pos] != '=')
+                return false;
+            ++m_pos;
+            skipWhitespace();
+            if(m_pos >= m_size || (m_data[m_pos] != '"' && m_data[m_pos] != '\''))
+                return false;
+
+            char const quote = m_data[m_pos++];
+            const void *end = std::memchr(m_data + m_pos, quote, m_size - m_pos);
+            if(end == nullptr)
+                return false;
+            size_t const valueEnd = static_cast<size_t>(static_cast<const char *>(end) - m_data);
+            m_attributes.emplace_back(attributeName, std::string_view(m_data + m_pos, valueEnd - m_pos));
+            m_pos = valueEnd + 1;
+        }
+
+        ++m_depth;
+        m_token = Token::StartElement;
+        return true;
+    }
+}
+
+#endif //TILESON_XMLREADER_HPP
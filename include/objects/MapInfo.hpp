@@ -0,0 +1,50 @@
+#ifndef TILESON_MAPINFO_HPP
+#define TILESON_MAPINFO_HPP
+
+namespace tson
+{
+    /*!
+     * What tson::MapProbe reads about a map without parsing it: Its size, layers, tilesets and properties.
+     */
+    class MapInfo
+    {
+        public:
+            class LayerInfo
+            {
+                public:
+                    int id {0};
+                    std::string name;
+                    tson::LayerType type {tson::LayerType::Undefined};
+                    std::vector<LayerInfo> layers;      /*! The layers of a group */
+            };
+
+            class TilesetInfo
+            {
+                public:
+                    int firstgid {0};
+                    std::string name;                   /*! Only set for tilesets that are part of the map */
+                    std::string source;                 /*! Only set for external tilesets */
+            };
+
+            fs::path path;
+            tson::ParseStatus status {tson::ParseStatus::OK};
+            std::string type;                           /*! 'map' for maps. Tilesets, templates etc. can be probed, but have no map data */
+            std::string classType;
+            std::string orientation;
+            tson::Vector2i size;
+            tson::Vector2i tileSize;
+            bool infinite {false};
+            std::vector<LayerInfo> layers;
+            std::vector<TilesetInfo> tilesets;
+            tson::PropertyCollection properties;
+
+            [[nodiscard]] inline bool isMap() const;
+    };
+
+    bool MapInfo::isMap() const
+    {
+        return status == tson::ParseStatus::OK && type == "map";
+    }
+}
+
+#endif //TILESON_MAPINFO_HPP
@@ -21,6 +21,7 @@ namespace tson
 
     class Property
     {
+        friend class MapSnapshot;
         public:
             inline Property();
             inline explicit Property(IJson &json, tson::Project *project = nullptr);
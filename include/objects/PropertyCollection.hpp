@@ -13,6 +13,7 @@ namespace tson
 {
     class PropertyCollection
     {
+        friend class MapSnapshot;
         public:
             inline PropertyCollection() = default;
 
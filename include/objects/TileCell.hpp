@@ -0,0 +1,30 @@
+#ifndef TILESON_TILECELL_HPP
+#define TILESON_TILECELL_HPP
+
+#include <cstdint>
+#include "Vector2.hpp"
+
+namespace tson
+{
+    class Tile;
+
+    /*!
+     * A single non-empty cell of a tile layer, as given by the region functions of tson::Layer.
+     * Unlike tson::TileObject, this is a plain value, and works for infinite maps as well.
+     */
+    class TileCell
+    {
+        public:
+            /*! The tile in this cell. Flip flagged tiles point to the flipped version of the tile when it exists.
+             *  nullptr if no tile exists for the gid. */
+            tson::Tile *tile {nullptr};
+            /*! The gid of the cell, including flip flags */
+            uint32_t gid {};
+            /*! Position of the cell in tile units */
+            tson::Vector2i posInTileUnits;
+            /*! Top-left corner of the cell in pixels, including layer offset (and parallax, when a camera is involved) */
+            tson::Vector2f position;
+    };
+}
+
+#endif //TILESON_TILECELL_HPP
@@ -0,0 +1,33 @@
+#ifndef TILESON_TILEDRAWINFO_HPP
+#define TILESON_TILEDRAWINFO_HPP
+
+#include "Rect.hpp"
+#include "Vector2.hpp"
+
+namespace tson
+{
+    class Tile;
+    class Tileset;
+
+    /*!
+     * Everything needed to draw a tile, precalculated once per gid by tson::Map. See tson::Map::getTileDrawTable().
+     */
+    class TileDrawInfo
+    {
+        public:
+            /*! The tile of the gid. nullptr if no tileset contains the gid. */
+            tson::Tile *tile {nullptr};
+            /*! The tileset of the tile */
+            tson::Tileset *tileset {nullptr};
+            /*! The part of the image used by the tile, in pixels, with margin and spacing taken into account */
+            tson::Rect drawingRect;
+            /*! drawingRect normalized to the size of the image: top-left corner */
+            tson::Vector2f uvTopLeft;
+            /*! drawingRect normalized to the size of the image: bottom-right corner */
+            tson::Vector2f uvBottomRight;
+            /*! 'tileoffset' of the tileset */
+            tson::Vector2i tileOffset;
+    };
+}
+
+#endif //TILESON_TILEDRAWINFO_HPP
@@ -11,11 +11,8 @@ namespace tson
     {
         public:
             inline WorldMapData(const fs::path &folder_, IJson &json);
+            inline WorldMapData(const fs::path &folder_, std::string fileName_, const tson::Vector2i &position_, const tson::Vector2i &size_);
             inline void parse(const fs::path &folder_, IJson &json);
-            //inline WorldMapData(fs::path folder_, std::string fileName_) : folder {std::move(folder_)}, fileName {fileName_}
-            //{
-            //    path = folder / fileName;
-            //}
 
             fs::path folder;
             fs::path path;
@@ -29,6 +26,15 @@ namespace tson
         parse(folder_, json);
     }
 
+    /*!
+     * Map data of a map that is not listed in the world file, like those matching a pattern.
+     */
+    WorldMapData::WorldMapData(const fs::path &folder_, std::string fileName_, const tson::Vector2i &position_, const tson::Vector2i &size_)
+        : folder {folder_}, path {folder_ / fileName_}, fileName {std::move(fileName_)}, size {size_}, position {position_}
+    {
+
+    }
+
     void WorldMapData::parse(const fs::path &folder_, IJson &json)
     {
         folder = folder_;
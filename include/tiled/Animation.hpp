@@ -5,16 +5,20 @@
 #ifndef TILESON_ANIMATION_HPP
 #define TILESON_ANIMATION_HPP
 
+#include <cmath>
+#include <algorithm>
+
 namespace tson
 {
     class Animation
     {
         public:
             inline Animation() = default;
-            inline Animation(const std::vector<tson::Frame> &frames) : m_frames {frames} {};
+            inline Animation(const std::vector<tson::Frame> &frames) : m_frames {frames} { calculateFrameEnds(); };
 
             inline void update(float timeDeltaMs);
             inline void reset();
+            [[nodiscard]] inline uint32_t frameAt(double timeMs) const;
 
             inline void setFrames(const std::vector<tson::Frame> &frames);
             inline void setCurrentFrame(uint32_t currentFrame);
@@ -25,13 +29,17 @@ namespace tson
             inline uint32_t getCurrentFrameNumber() const;
             inline uint32_t getCurrentTileId() const;
             inline float getTimeDelta() const;
+            [[nodiscard]] inline uint32_t getTotalDuration() const;
 
             inline bool any() const;
             inline size_t size() const;
 
         private:
-            inline int nextFrame();
+            inline void calculateFrameEnds();
+            inline uint32_t findFrame(double loopTimeMs) const;
+
             std::vector<tson::Frame> m_frames;
+            std::vector<uint32_t> m_frameEnds;      /*! Prefix sum of the frame durations: the time each frame ends, from the start of the animation */
             uint32_t m_currentFrame {0};
             float m_timeDelta {0};
     };
@@ -65,26 +73,73 @@ namespace tson
     }
 
     /*!
-     * Update animation based on the fra
+     * Update animation based on the time since the last update.
+     * Any number of frames may be skipped, so animations stay in sync even with very large time deltas.
+     * O(log n) of the number of frames.
      * @param timedeltaMs Time in milliseconds
      */
     void Animation::update(float timeDeltaMs)
     {
         const tson::Frame *frame = getCurrentFrame();
-        if(frame != nullptr)
+        uint32_t const total = getTotalDuration();
+        if(frame == nullptr || total == 0 || timeDeltaMs <= 0.f)
+            return;
+
+        //Time since the start of the animation, limited to a single loop
+        uint32_t const frameStart = m_frameEnds[m_currentFrame] - static_cast<uint32_t>(std::max(frame->getDuration(), 0));
+        double const loopTime = std::fmod(static_cast<double>(frameStart) + static_cast<double>(m_timeDelta) + static_cast<double>(timeDeltaMs),
+                                          static_cast<double>(total));
+
+        m_currentFrame = findFrame(loopTime);
+        uint32_t const newFrameStart = m_frameEnds[m_currentFrame] - static_cast<uint32_t>(std::max(m_frames[m_currentFrame].getDuration(), 0));
+        m_timeDelta = static_cast<float>(loopTime - static_cast<double>(newFrameStart));
+    }
+
+    /*!
+     * Gets the frame number at any point in time, where 0 is the start of the animation.
+     * Does not change the state of the animation. O(log n) of the number of frames.
+     * @param timeMs Time in milliseconds since the start of the animation
+     * @return The frame number at the given time. 0 if there are no frames.
+     */
+    uint32_t Animation::frameAt(double timeMs) const
+    {
+        uint32_t const total = getTotalDuration();
+        if(total == 0 || timeMs <= 0.0)
+            return 0;
+
+        return findFrame(std::fmod(timeMs, static_cast<double>(total)));
+    }
+
+    /*!
+     * Sum of the duration of all frames in milliseconds
+     */
+    uint32_t Animation::getTotalDuration() const
+    {
+        return (m_frameEnds.empty()) ? 0 : m_frameEnds.back();
+    }
+
+    void Animation::calculateFrameEnds()
+    {
+        m_frameEnds.resize(m_frames.size());
+        uint32_t end = 0;
+        for(size_t i = 0; i < m_frames.size(); ++i)
         {
-            m_timeDelta += timeDeltaMs;
-            if(m_timeDelta >= frame->getDuration())
-            {
-                m_timeDelta = static_cast<float>((int32_t)m_timeDelta % frame->getDuration());
-                m_currentFrame = nextFrame();
-            }
+            end += static_cast<uint32_t>(std::max(m_frames[i].getDuration(), 0));
+            m_frameEnds[i] = end;
         }
     }
 
-    int Animation::nextFrame()
+    /*!
+     * The first frame ending after the given time. Frames with no duration are never selected.
+     */
+    uint32_t Animation::findFrame(double loopTimeMs) const
     {
-        return (m_currentFrame+1 >= m_frames.size()) ? 0 : m_currentFrame + 1;
+        auto iter = std::upper_bound(m_frameEnds.begin(), m_frameEnds.end(), loopTimeMs,
+                                     [](double time, uint32_t end) { return time < static_cast<double>(end); });
+        if(iter == m_frameEnds.end())
+            return 0;
+
+        return static_cast<uint32_t>(iter - m_frameEnds.begin());
     }
 
     float Animation::getTimeDelta() const
@@ -105,6 +160,7 @@ namespace tson
     void Animation::setFrames(const std::vector<tson::Frame> &frames)
     {
         m_frames = frames;
+        calculateFrameEnds();
     }
 
     void Animation::setCurrentFrame(uint32_t currentFrame)
@@ -12,6 +12,7 @@ namespace tson
 {
     class Chunk
     {
+        friend class MapSnapshot;
         public:
             inline Chunk() = default;
             inline explicit Chunk(IJson &json);
@@ -60,8 +61,9 @@ bool tson::Chunk::parse(IJson &json)
     {
         if(json["data"].isArray())
         {
-            auto &data = json.array("data");
-            std::for_each(data.begin(), data.end(), [&](std::unique_ptr<IJson> &item) { m_data.push_back(item->get<int>()); });
+            std::vector<uint32_t> data;
+            json.readArray("data", data);
+            m_data.assign(data.begin(), data.end());
         }
         else
             m_base64Data = json["data"].get<std::string>();
@@ -13,6 +13,7 @@ namespace tson
 {
     class Grid
     {
+        friend class MapSnapshot;
         public:
             inline Grid() = default;
             inline explicit Grid(IJson &json);
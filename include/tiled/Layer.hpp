@@ -6,12 +6,17 @@
 #define TILESON_LAYER_HPP
 
 #include <set>
+#include <unordered_map>
+#include <functional>
 //#include "../external/json.hpp"
 #include "../objects/Vector2.hpp"
 #include "../objects/Color.hpp"
 #include "Chunk.hpp"
 #include "Object.hpp"
+#include "../misc/SpatialIndex.hpp"
+#include "../misc/IndexedRange.hpp"
 #include "../objects/TileObject.hpp"
+#include "../objects/TileCell.hpp"
 #include "../objects/Property.hpp"
 #include "../objects/PropertyCollection.hpp"
 #include "../common/Enums.hpp"
@@ -21,14 +26,45 @@ namespace tson
 {
     class Tile;
     class Map;
+    class Layer;
 
-    class Layer
+    /*!
+     * Decides which layers of a map are parsed. Gets a layer where only the fields of the layer itself are read,
+     * like the name, type and class. Must return true to keep the layer.
+     */
+    using LayerFilter = std::function<bool(const tson::Layer &layer)>;
+
+    /*!
+     * The json of a lazy layer until it is loaded. The json is owned by the map, which releases it when every layer is loaded.
+     * Copying a lazy layer loads the source first, so a copy never points into the json of the map. Moving hands the json over.
+     */
+    class LazyLayerJson
+    {
+        public:
+            inline LazyLayerJson() = default;
+            inline LazyLayerJson(const LazyLayerJson &other);
+            inline LazyLayerJson(LazyLayerJson &&other) noexcept;
+            inline LazyLayerJson &operator=(const LazyLayerJson &other);
+            inline LazyLayerJson &operator=(LazyLayerJson &&other) noexcept;
+            inline ~LazyLayerJson() = default;
+
+            IJson *                                             m_lazyJson {nullptr};       /*! The json of the data, chunks and objects until they are loaded. Owned by the map */
+    };
+
+    class Layer : private LazyLayerJson
     {
+        friend class LazyLayerJson;
+        friend class Map;
+        friend class Tileset;
+        friend class MapSnapshot;
         public:
             inline Layer() = default;
             inline Layer(IJson &json, tson::Map *map);
             inline bool parse(IJson &json, tson::Map *map); //Defined in tileson_forward
 
+            [[nodiscard]] inline bool isLoaded() const;
+            inline void load(); //Defined in tileson_forward
+
             [[nodiscard]] inline const std::string &getCompression() const;
             [[nodiscard]] inline const std::vector<uint32_t> &getData() const;
             [[nodiscard]] inline const std::string &getBase64Data() const;
@@ -63,6 +99,10 @@ namespace tson
             inline tson::Object *firstObj(const std::string &name);
             inline std::vector<tson::Object> getObjectsByName(const std::string &name);
             inline std::vector<tson::Object> getObjectsByType(tson::ObjectType type);
+            inline tson::IndexedRange<tson::Object> getObjsByName(const std::string &name);
+            inline tson::IndexedRange<tson::Object> getObjsByType(tson::ObjectType type);
+            inline tson::IndexedRange<tson::Object> getObjsByClass(const std::string &classType);
+            inline void buildObjectBuckets();
 
             template <typename T>
             inline T get(const std::string &name);
@@ -76,6 +116,7 @@ namespace tson
 
             //v1.2.0-stuff
             [[nodiscard]] inline const Colori &getTintColor() const;
+            [[nodiscard]] inline bool hasTintColor() const;
             [[nodiscard]] inline tson::Map *getMap() const;
 
             [[nodiscard]] inline std::map<std::tuple<int, int>, tson::TileObject> &getTileObjects();
@@ -83,9 +124,55 @@ namespace tson
             [[nodiscard]] inline const std::set<uint32_t> &getUniqueFlaggedTiles() const;
             inline void resolveFlaggedTiles();
 
+            inline const tson::SpatialIndex &buildSpatialIndex(float cellSize = 0.f);
+            [[nodiscard]] inline const tson::SpatialIndex &getSpatialIndex() const;
+            inline std::vector<tson::Object *> queryRect(const tson::Rect &rect);
+            inline std::vector<tson::Object *> queryPoint(const tson::Vector2f &point);
+            inline std::vector<tson::Object *> queryRadius(const tson::Vector2f &center, float radius);
+
+            template <typename Func>
+            inline void forEachVisibleTile(const tson::Rect &camera, Func &&func);
+            template <typename Func>
+            inline void forEachTileInRegion(const tson::Rect &tileRect, Func &&func);
+            inline std::vector<tson::TileCell> getVisibleTiles(const tson::Rect &camera);
+            [[nodiscard]] inline tson::Rect getTileBounds() const;
+            [[nodiscard]] inline const Vector2i &getRegionOrigin() const;
+            [[nodiscard]] inline bool hasRegion() const;
+            [[nodiscard]] inline tson::Vector2f getParallaxOffset(const tson::Rect &camera) const; /*! Defined in tileson_forward.hpp */
+
         private:
+            /*!
+             * Everything needed to iterate a rectangle of tiles. Created by createTileRegion().
+             */
+            struct TileRegion
+            {
+                int x0 {}, y0 {}, x1 {-1}, y1 {-1};           /*! Inclusive range in tile units */
+                tson::Vector2f origin;                        /*! Added to the position of every tile */
+                bool cull {false};                            /*! Whether each tile must be checked against the pixel rect below */
+                float minX {}, minY {}, maxX {}, maxY {};     /*! Pixel rect, in the coordinates of the tiles without origin */
+                int orientation {};                           /*! 0 = orthogonal, 1 = isometric, 2 = staggered/hexagonal */
+                float tileWidth {}, tileHeight {};
+                float isoOriginX {};
+                bool staggerX {}, staggerEven {};
+                float sideLengthX {}, sideLengthY {}, columnWidth {}, rowHeight {};
+            };
+
+            template <typename Func>
+            inline void iterateTileRegion(const TileRegion &region, Func &&func);
+            inline TileRegion createTileRegion(const tson::Rect &rect, bool inPixels);   /*! Defined in tileson_forward.hpp */
+            inline tson::Vector2f tileToPixel(int x, int y, const TileRegion &region) const;
+            inline tson::Tile *resolveTile(uint32_t gid);                                  /*! Defined in tileson_forward.hpp */
+
             inline void setTypeByString();
 
+            inline static void ParseLayers(IJson &json, tson::Map *map, std::vector<tson::Layer> &layers, const tson::LayerFilter &filter, bool lazy); /*! Defined in tileson_forward.hpp */
+            inline bool parseHeader(IJson &json, tson::Map *map);     /*! Defined in tileson_forward.hpp */
+            inline void parseProperties(IJson &json);                 /*! Defined in tileson_forward.hpp */
+            inline void parseData(IJson &json);                       /*! Defined in tileson_forward.hpp */
+            inline bool getDataRegion(tson::Rect &region) const;      /*! Defined in tileson_forward.hpp */
+            inline void decodeRegion(const tson::Rect &region);       /*! Defined in tileson_forward.hpp */
+            inline void ensureLoaded() const;
+
             std::vector<tson::Chunk>                       m_chunks; 	                      /*! 'chunks': Array of chunks (optional). tilelayer only. */
             std::string                                    m_compression;                     /*! 'compression': zlib, gzip or empty (default). tilelayer only. */
             std::vector<uint32_t>                          m_data;                            /*! 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded
@@ -116,13 +203,14 @@ namespace tson
             bool                                           m_repeatX {};                         /*! 'repeatx': Whether the image drawn by this layer is repeated along the X axis. (since Tiled 1.8)*/
             bool                                           m_repeatY {};                         /*! 'repeaty': Whether the image drawn by this layer is repeated along the Y axis. (since Tiled 1.8)*/
 
-            std::map<uint32_t, tson::Tile*>                *m_tileMap;
+            std::map<uint32_t, tson::Tile*>                *m_tileMap {nullptr};
             std::map<std::tuple<int, int>, tson::Tile*>    m_tileData;                        /*! Key: Tuple of x and y pos in tile units. */
 
             //v1.2.0-stuff
             tson::Colori                                        m_tintColor;                  /*! 'tintcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) that is multiplied with
                                                                                                *        any graphics drawn by this layer or any child layers (optional). */
-            inline void decompressData();                                                     /*! Defined in tileson_forward.hpp */
+            bool                                                m_hasTintColor {false};       /*! true if 'tintcolor' is set */
+            inline void decompressData(const tson::Rect *region = nullptr);                   /*! Defined in tileson_forward.hpp */
             inline void queueFlaggedTile(size_t x, size_t y, uint32_t id);                    /*! Queue a flagged tile */
 
             tson::Map *                                         m_map;                        /*! The map who owns this layer */
@@ -132,6 +220,17 @@ namespace tson
 
             std::string                                         m_classType{};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
             std::shared_ptr<tson::TiledClass>                   m_class {};
+
+            tson::SpatialIndex                                  m_spatialIndex;             /*! Optional grid over the bounds of m_objects. Built by buildSpatialIndex() */
+            inline std::vector<tson::Object *> indicesToObjects(const std::vector<size_t> &indices);
+
+            inline tson::IndexedRange<tson::Object> bucketToRange(const std::vector<size_t> *bucket);
+            std::vector<std::vector<size_t>>                         m_objectsByType;       /*! Indices of m_objects, grouped by tson::ObjectType */
+            std::unordered_map<std::string, std::vector<size_t>>     m_objectsByClass;      /*! Indices of m_objects, grouped by 'type'/'class' */
+            std::unordered_map<std::string, std::vector<size_t>>     m_objectsByName;       /*! Indices of m_objects, grouped by 'name' */
+
+            tson::Vector2i                                      m_regionOrigin;             /*! Position of the first tile of m_data in the map, when only a region is decoded */
+            bool                                                m_hasRegion {false};        /*! true if m_data is only a region of the layer. See tson::Map::setTileRegion() */
     };
 
     /*!
@@ -147,6 +246,121 @@ namespace tson
     }
 }
 
+/*!
+ * Calls func(const tson::TileCell &) for every non-empty tile of this tile layer that is visible inside the camera rectangle,
+ * in row-major order. The layer offset, the parallax factor of the layer and the parallax origin of the map are taken into account,
+ * as well as the orientation of the map (orthogonal, isometric, staggered and hexagonal).
+ * The TileCell::position of each tile is the top-left corner of its cell in the same coordinates as the camera.
+ *
+ * For finite maps, the cost is proportional to the number of visible tiles. Infinite maps are handled by iterating
+ * the chunks that overlap the camera. Only chunks with csv data are supported.
+ *
+ * NOTE: The parallax factor of parent group layers is not included.
+ *
+ * @param camera The visible area in pixels.
+ * @param func Function called for each visible tile.
+ */
+template<typename Func>
+void tson::Layer::forEachVisibleTile(const tson::Rect &camera, Func &&func)
+{
+    iterateTileRegion(createTileRegion(camera, true), std::forward<Func>(func));
+}
+
+/*!
+ * Calls func(const tson::TileCell &) for every non-empty tile of this tile layer inside the rectangle, in row-major order.
+ * The TileCell::position of each tile includes the offset of the layer, but not parallax.
+ *
+ * @param tileRect The rectangle in tile units.
+ * @param func Function called for each tile.
+ */
+template<typename Func>
+void tson::Layer::forEachTileInRegion(const tson::Rect &tileRect, Func &&func)
+{
+    iterateTileRegion(createTileRegion(tileRect, false), std::forward<Func>(func));
+}
+
+template<typename Func>
+void tson::Layer::iterateTileRegion(const TileRegion &region, Func &&func)
+{
+    ensureLoaded();
+
+    if(region.x1 < region.x0 || region.y1 < region.y0)
+        return;
+
+    tson::TileCell cell;
+    auto emit = [&](int x, int y, uint32_t gid)
+    {
+        tson::Vector2f pos = tileToPixel(x, y, region);
+        if(region.cull && (pos.x + region.tileWidth <= region.minX || pos.x >= region.maxX ||
+                           pos.y + region.tileHeight <= region.minY || pos.y >= region.maxY))
+            return;
+
+        cell.gid = gid;
+        cell.tile = resolveTile(gid);
+        cell.posInTileUnits = {x, y};
+        cell.position = {pos.x + region.origin.x, pos.y + region.origin.y};
+        func(static_cast<const tson::TileCell &>(cell));
+    };
+
+    if(m_chunks.empty())
+    {
+        //m_data starts at m_regionOrigin when only a region of the layer is decoded
+        int const x0 = std::max(region.x0, m_regionOrigin.x);
+        int const y0 = std::max(region.y0, m_regionOrigin.y);
+        int const x1 = std::min(region.x1, m_regionOrigin.x + m_size.x - 1);
+        int const y1 = std::min(region.y1, m_regionOrigin.y + m_size.y - 1);
+        if(m_data.size() < static_cast<size_t>(m_size.x) * static_cast<size_t>(m_size.y))
+            return;
+
+        for(int y = y0; y <= y1; ++y)
+        {
+            const uint32_t *row = m_data.data() + static_cast<size_t>(y - m_regionOrigin.y) * m_size.x;
+            for(int x = x0; x <= x1; ++x)
+            {
+                uint32_t const gid = row[x - m_regionOrigin.x];
+                if(gid != 0)
+                    emit(x, y, gid);
+            }
+        }
+    }
+    else
+    {
+        //Only the chunks overlapping the region, sorted by x, so every row can be visited from left to right
+        std::vector<const tson::Chunk *> chunks;
+        for(const auto &chunk : m_chunks)
+        {
+            const tson::Vector2i &pos = chunk.getPosition();
+            const tson::Vector2i &size = chunk.getSize();
+            if(pos.x > region.x1 || pos.x + size.x <= region.x0 || pos.y > region.y1 || pos.y + size.y <= region.y0)
+                continue;
+            if(chunk.getData().size() < static_cast<size_t>(size.x) * static_cast<size_t>(size.y))
+                continue;
+            chunks.push_back(&chunk);
+        }
+        std::sort(chunks.begin(), chunks.end(), [](const tson::Chunk *a, const tson::Chunk *b) { return a->getPosition().x < b->getPosition().x; });
+
+        for(int y = region.y0; y <= region.y1; ++y)
+        {
+            for(const tson::Chunk *chunk : chunks)
+            {
+                const tson::Vector2i &pos = chunk->getPosition();
+                const tson::Vector2i &size = chunk->getSize();
+                if(y < pos.y || y >= pos.y + size.y)
+                    continue;
+
+                const int *row = chunk->getData().data() + static_cast<size_t>(y - pos.y) * size.x;
+                int const x1 = std::min(region.x1, pos.x + size.x - 1);
+                for(int x = std::max(region.x0, pos.x); x <= x1; ++x)
+                {
+                    uint32_t const gid = static_cast<uint32_t>(row[x - pos.x]);
+                    if(gid != 0)
+                        emit(x, y, gid);
+                }
+            }
+        }
+    }
+}
+
 /*!
  * Parses a Tiled layer from json
  * @param json
@@ -156,6 +370,52 @@ tson::Layer::Layer(IJson &json, tson::Map *map)
     parse(json, map);
 }
 
+/*!
+ * Whether the tile data, chunks and objects of this layer have been read. Only layers of maps parsed with
+ * tson::Tileson::setLazyLayers() can be unloaded, until one of the functions that need the data are used, or load() is called.
+ * @return false if the layer is still waiting to be loaded
+ */
+bool tson::Layer::isLoaded() const
+{
+    return m_lazyJson == nullptr;
+}
+
+void tson::Layer::ensureLoaded() const
+{
+    //Loading is part of reading the layer, like with the lazily built spatial index
+    if(m_lazyJson != nullptr)
+        const_cast<tson::Layer *>(this)->load();
+}
+
+/*!
+ * Loads the source layer, which is the tson::Layer this is a part of, before its members are copied
+ */
+tson::LazyLayerJson::LazyLayerJson(const LazyLayerJson &other)
+{
+    static_cast<const tson::Layer &>(other).ensureLoaded();
+}
+
+tson::LazyLayerJson::LazyLayerJson(LazyLayerJson &&other) noexcept : m_lazyJson {other.m_lazyJson}
+{
+    other.m_lazyJson = nullptr;
+}
+
+tson::LazyLayerJson &tson::LazyLayerJson::operator=(const LazyLayerJson &other)
+{
+    if(this != &other)
+    {
+        static_cast<const tson::Layer &>(other).ensureLoaded();
+        static_cast<tson::Layer &>(*this).ensureLoaded();
+    }
+    return *this;
+}
+
+tson::LazyLayerJson &tson::LazyLayerJson::operator=(LazyLayerJson &&other) noexcept
+{
+    std::swap(m_lazyJson, other.m_lazyJson);
+    return *this;
+}
+
 void tson::Layer::queueFlaggedTile(size_t x, size_t y, uint32_t id)
 {
     uint32_t tileId = id;
@@ -171,6 +431,7 @@ void tson::Layer::queueFlaggedTile(size_t x, size_t y, uint32_t id)
  */
 std::vector<tson::Object> tson::Layer::getObjectsByName(const std::string &name)
 {
+    ensureLoaded();
     std::vector<tson::Object> found;
 
     std::copy_if(m_objects.begin(), m_objects.end(), std::back_inserter(found), [&](const tson::Object &item)
@@ -190,6 +451,7 @@ std::vector<tson::Object> tson::Layer::getObjectsByName(const std::string &name)
  */
 std::vector<tson::Object> tson::Layer::getObjectsByType(tson::ObjectType type)
 {
+    ensureLoaded();
     std::vector<tson::Object> found;
 
     std::copy_if(m_objects.begin(), m_objects.end(), std::back_inserter(found), [&](const tson::Object &item)
@@ -200,6 +462,77 @@ std::vector<tson::Object> tson::Layer::getObjectsByType(tson::ObjectType type)
     return found;
 }
 
+/*!
+ * Groups the indices of all objects by object type, class and name, so getObjsByType(), getObjsByClass() and getObjsByName()
+ * can return the matching objects without searching or copying.
+ * Called automatically when the layer is parsed, but must be called again if objects are added or removed afterwards.
+ */
+void tson::Layer::buildObjectBuckets()
+{
+    m_objectsByType.clear();
+    m_objectsByClass.clear();
+    m_objectsByName.clear();
+
+    for(size_t i = 0; i < m_objects.size(); ++i)
+    {
+        const tson::Object &obj = m_objects[i];
+        auto type = static_cast<size_t>(obj.getObjectType());
+        if(type >= m_objectsByType.size())
+            m_objectsByType.resize(type + 1);
+
+        m_objectsByType[type].push_back(i);
+        m_objectsByClass[obj.getClassType()].push_back(i);
+        m_objectsByName[obj.getName()].push_back(i);
+    }
+}
+
+tson::IndexedRange<tson::Object> tson::Layer::bucketToRange(const std::vector<size_t> *bucket)
+{
+    if(bucket == nullptr || bucket->empty())
+        return {};
+
+    return {m_objects.data(), bucket->data(), bucket->data() + bucket->size()};
+}
+
+/*!
+ * Gets all objects with a name that equals the parameter, without copying them.
+ * The result is only valid as long as the objects of this layer are unchanged.
+ * @param name Name of the objects to return
+ * @return A view of all objects with a matching name, in the same order as getObjects().
+ */
+tson::IndexedRange<tson::Object> tson::Layer::getObjsByName(const std::string &name)
+{
+    ensureLoaded();
+    auto iter = m_objectsByName.find(name);
+    return bucketToRange((iter != m_objectsByName.end()) ? &iter->second : nullptr);
+}
+
+/*!
+ * Gets all objects of the given object type, without copying them.
+ * The result is only valid as long as the objects of this layer are unchanged.
+ * @param type ObjectType of the objects to return
+ * @return A view of all objects with a matching type, in the same order as getObjects().
+ */
+tson::IndexedRange<tson::Object> tson::Layer::getObjsByType(tson::ObjectType type)
+{
+    ensureLoaded();
+    auto pos = static_cast<size_t>(type);
+    return bucketToRange((pos < m_objectsByType.size()) ? &m_objectsByType[pos] : nullptr);
+}
+
+/*!
+ * Gets all objects with a 'class' (previously 'type') that equals the parameter, without copying them.
+ * The result is only valid as long as the objects of this layer are unchanged.
+ * @param classType Class of the objects to return
+ * @return A view of all objects with a matching class, in the same order as getObjects().
+ */
+tson::IndexedRange<tson::Object> tson::Layer::getObjsByClass(const std::string &classType)
+{
+    ensureLoaded();
+    auto iter = m_objectsByClass.find(classType);
+    return bucketToRange((iter != m_objectsByClass.end()) ? &iter->second : nullptr);
+}
+
 /*!
  * Returns the first object with the given name
  * @param name Name of the object to find.
@@ -207,6 +540,7 @@ std::vector<tson::Object> tson::Layer::getObjectsByType(tson::ObjectType type)
  */
 tson::Object *tson::Layer::firstObj(const std::string &name)
 {
+    ensureLoaded();
     auto result = std::find_if(m_objects.begin(), m_objects.end(), [&](const tson::Object &obj){return obj.getName() == name; });
     if(result == m_objects.end())
         return nullptr;
@@ -221,6 +555,7 @@ tson::Object *tson::Layer::firstObj(const std::string &name)
  */
 tson::Object *tson::Layer::getObj(int id)
 {
+    ensureLoaded();
     auto result = std::find_if(m_objects.begin(), m_objects.end(), [&](const tson::Object &obj){return obj.getId() == id; });
     if(result == m_objects.end())
         return nullptr;
@@ -256,6 +591,7 @@ const std::string &tson::Layer::getCompression() const
  */
 const std::vector<uint32_t> &tson::Layer::getData() const
 {
+    ensureLoaded();
     return m_data;
 }
 
@@ -265,6 +601,7 @@ const std::vector<uint32_t> &tson::Layer::getData() const
  */
 const std::string &tson::Layer::getBase64Data() const
 {
+    ensureLoaded();
     return m_base64Data;
 }
 
@@ -392,6 +729,7 @@ int tson::Layer::getY() const
  */
 std::vector<tson::Chunk> &tson::Layer::getChunks()
 {
+    ensureLoaded();
     return m_chunks;
 }
 
@@ -410,6 +748,7 @@ std::vector<tson::Layer> &tson::Layer::getLayers()
  */
 std::vector<tson::Object> &tson::Layer::getObjects()
 {
+    ensureLoaded();
     return m_objects;
 }
 
@@ -464,6 +803,7 @@ void tson::Layer::assignTileMap(std::map<uint32_t, tson::Tile *> *tileMap)
  */
 const std::map<std::tuple<int, int>, tson::Tile *> &tson::Layer::getTileData() const
 {
+    ensureLoaded();
     return m_tileData;
 }
 
@@ -481,6 +821,7 @@ const std::map<std::tuple<int, int>, tson::Tile *> &tson::Layer::getTileData() c
  */
 tson::Tile *tson::Layer::getTileData(int x, int y)
 {
+    ensureLoaded();
     return (m_tileData.count({x, y}) > 0) ? m_tileData[{x,y}] : nullptr;
 }
 
@@ -502,16 +843,18 @@ tson::Map *tson::Layer::getMap() const
  */
 void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
 {
-    size_t x = 0;
-    size_t y = 0;
+    //A decoded region has its own width, and its tiles keep their position in the map
+    int const width = (m_hasRegion) ? m_size.x : mapSize.x;
+    size_t x = m_regionOrigin.x;
+    size_t y = m_regionOrigin.y;
     if(!isInfiniteMap)
     {
         std::for_each(m_data.begin(), m_data.end(), [&](uint32_t tileId)
         {
-            if (static_cast<int>(x) == mapSize.x)
+            if (static_cast<int>(x) == m_regionOrigin.x + width)
             {
                 ++y;
-                x = 0;
+                x = m_regionOrigin.x;
             }
 
             if (tileId > 0 && m_tileMap->count(tileId) > 0)
@@ -531,16 +874,19 @@ void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
 
 std::map<std::tuple<int, int>, tson::TileObject> &tson::Layer::getTileObjects()
 {
+    ensureLoaded();
     return m_tileObjects;
 }
 
 tson::TileObject *tson::Layer::getTileObject(int x, int y)
 {
+    ensureLoaded();
     return (m_tileObjects.count({x, y}) > 0) ? &m_tileObjects[{x,y}] : nullptr;
 }
 
 const std::set<uint32_t> &tson::Layer::getUniqueFlaggedTiles() const
 {
+    ensureLoaded();
     return m_uniqueFlaggedTiles;
 }
 
@@ -566,6 +912,15 @@ const tson::Colori &tson::Layer::getTintColor() const
     return m_tintColor;
 }
 
+/*!
+ * Whether the layer has a 'tintcolor'. If false, getTintColor() is just the default color and should not be applied.
+ * @return true if 'tintcolor' is set
+ */
+bool tson::Layer::hasTintColor() const
+{
+    return m_hasTintColor;
+}
+
 /*!
  * New in Tiled v1.5
  * Gets the parallax factor for current layer. Defaults to 1.
@@ -601,5 +956,177 @@ const std::string &tson::Layer::getClassType() const
     return m_classType;
 }
 
+/*!
+ * Builds a spatial index (uniform grid) over the bounding boxes of the objects in this layer.
+ * This is optional, but makes queryRect(), queryPoint() and queryRadius() run in roughly constant time instead
+ * of checking every object. The queries will build the index automatically the first time they are used, but if the layer
+ * is going to be queried from several threads, this function should be called first.
+ *
+ * The index must be rebuilt if the objects of the layer are changed.
+ *
+ * @param cellSize Size of a grid cell in pixels. If 0 or less, a cell size based on the average object size is used.
+ * @return The built index, which also offers queries that return indices without allocating.
+ */
+const tson::SpatialIndex &tson::Layer::buildSpatialIndex(float cellSize)
+{
+    ensureLoaded();
+    m_spatialIndex.build(m_objects, cellSize);
+    return m_spatialIndex;
+}
+
+/*!
+ * Gets the spatial index of the objects in this layer. Empty until buildSpatialIndex() or one of the queries has been called.
+ * @return The spatial index
+ */
+const tson::SpatialIndex &tson::Layer::getSpatialIndex() const
+{
+    ensureLoaded();
+    return m_spatialIndex;
+}
+
+/*!
+ * Gets all objects with a bounding box intersecting the rectangle. Position, size, rotation and polygon points of the objects are
+ * taken into account.
+ * @param rect The rectangle in pixels
+ * @return Pointers to the objects found, in no particular order.
+ */
+std::vector<tson::Object *> tson::Layer::queryRect(const tson::Rect &rect)
+{
+    ensureLoaded();
+    if(m_spatialIndex.size() != m_objects.size())
+        buildSpatialIndex();
+
+    std::vector<size_t> indices;
+    m_spatialIndex.queryRect((float)rect.x, (float)rect.y, (float)rect.width, (float)rect.height, indices);
+    return indicesToObjects(indices);
+}
+
+/*!
+ * Gets all objects with a bounding box containing the point.
+ * @param point The point in pixels
+ * @return Pointers to the objects found, in no particular order.
+ */
+std::vector<tson::Object *> tson::Layer::queryPoint(const tson::Vector2f &point)
+{
+    ensureLoaded();
+    if(m_spatialIndex.size() != m_objects.size())
+        buildSpatialIndex();
+
+    std::vector<size_t> indices;
+    m_spatialIndex.queryPoint(point.x, point.y, indices);
+    return indicesToObjects(indices);
+}
+
+/*!
+ * Gets all objects with a bounding box intersecting the circle.
+ * @param center Center of the circle in pixels
+ * @param radius Radius of the circle in pixels
+ * @return Pointers to the objects found, in no particular order.
+ */
+std::vector<tson::Object *> tson::Layer::queryRadius(const tson::Vector2f &center, float radius)
+{
+    ensureLoaded();
+    if(m_spatialIndex.size() != m_objects.size())
+        buildSpatialIndex();
+
+    std::vector<size_t> indices;
+    m_spatialIndex.queryRadius(center.x, center.y, radius, indices);
+    return indicesToObjects(indices);
+}
+
+/*!
+ * Gets every non-empty tile visible inside the camera rectangle, in row-major order.
+ * See forEachVisibleTile() for details. Use forEachVisibleTile() directly to avoid the allocation.
+ * @param camera The visible area in pixels.
+ * @return The visible tiles.
+ */
+std::vector<tson::TileCell> tson::Layer::getVisibleTiles(const tson::Rect &camera)
+{
+    std::vector<tson::TileCell> tiles;
+    forEachVisibleTile(camera, [&](const tson::TileCell &cell) { tiles.push_back(cell); });
+    return tiles;
+}
+
+/*!
+ * The rectangle in tile units that contains all the tile data of this layer.
+ * For finite layers this is the size of the layer, or the decoded region (see hasRegion()). For infinite layers it is the union of all chunks, which may start at negative positions.
+ * @return Bounds in tile units
+ */
+tson::Rect tson::Layer::getTileBounds() const
+{
+    ensureLoaded();
+    if(m_chunks.empty())
+        return {m_regionOrigin.x, m_regionOrigin.y, m_size.x, m_size.y};
+
+    int minX = std::numeric_limits<int>::max(), minY = std::numeric_limits<int>::max();
+    int maxX = std::numeric_limits<int>::min(), maxY = std::numeric_limits<int>::min();
+    for(const auto &chunk : m_chunks)
+    {
+        minX = std::min(minX, chunk.getPosition().x);
+        minY = std::min(minY, chunk.getPosition().y);
+        maxX = std::max(maxX, chunk.getPosition().x + chunk.getSize().x);
+        maxY = std::max(maxY, chunk.getPosition().y + chunk.getSize().y);
+    }
+    return {minX, minY, maxX - minX, maxY - minY};
+}
+
+/*!
+ * Position in the map, in tile units, of the first tile of getData(). Only differs from {0, 0} when hasRegion() is true.
+ * @return Origin of the data in tile units
+ */
+const tson::Vector2i &tson::Layer::getRegionOrigin() const
+{
+    return m_regionOrigin;
+}
+
+/*!
+ * Whether only a region of this tile layer was decoded (see tson::Tileson::setTileRegion()). getData() then only holds
+ * the tiles of the region, row by row, getSize() is the size of the region and getRegionOrigin() is where it starts in the map.
+ * getTileData(), forEachVisibleTile() etc. still use positions in the map.
+ * @return true if the data is only a region of the layer
+ */
+bool tson::Layer::hasRegion() const
+{
+    return m_hasRegion;
+}
+
+/*!
+ * Position of the top-left corner of the bounding box of a cell, relative to the layer.
+ * Follows the renderers of Tiled for each orientation.
+ */
+tson::Vector2f tson::Layer::tileToPixel(int x, int y, const TileRegion &region) const
+{
+    if(region.orientation == 1) //isometric
+    {
+        return {static_cast<float>(x - y) * region.tileWidth / 2.f + region.isoOriginX, static_cast<float>(x + y) * region.tileHeight / 2.f};
+    }
+    else if(region.orientation == 2) //staggered and hexagonal
+    {
+        if(region.staggerX)
+        {
+            float pixelY = static_cast<float>(y) * (region.tileHeight + region.sideLengthY);
+            if(((x & 1) != 0) != region.staggerEven)
+                pixelY += region.rowHeight;
+            return {static_cast<float>(x) * region.columnWidth, pixelY};
+        }
+
+        float pixelX = static_cast<float>(x) * (region.tileWidth + region.sideLengthX);
+        if(((y & 1) != 0) != region.staggerEven)
+            pixelX += region.columnWidth;
+        return {pixelX, static_cast<float>(y) * region.rowHeight};
+    }
+
+    return {static_cast<float>(x) * region.tileWidth, static_cast<float>(y) * region.tileHeight};
+}
+
+std::vector<tson::Object *> tson::Layer::indicesToObjects(const std::vector<size_t> &indices)
+{
+    std::vector<tson::Object *> objects;
+    objects.reserve(indices.size());
+    for(size_t i : indices)
+        objects.push_back(&m_objects[i]);
+    return objects;
+}
+
 
 #endif //TILESON_LAYER_HPP
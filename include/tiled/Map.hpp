@@ -6,18 +6,23 @@
 #define TILESON_MAP_HPP
 
 #include <functional>
+#include <unordered_map>
 
 #include "../objects/Color.hpp"
 #include "../objects/Vector2.hpp"
+#include "../objects/TileDrawInfo.hpp"
 //#include "../external/json.hpp"
 #include "../interfaces/IJson.hpp"
 #include "../json/NlohmannJson.hpp"
 #include "../json/PicoJson.hpp"
 //#include "../json/Gason.hpp" //Unsupported
 #include "../json/Json11.hpp"
+#include "../json/TmxJson.hpp"
+#include "../json/BinaryJson.hpp"
 
 #include "Layer.hpp"
 #include "Tileset.hpp"
+#include "../misc/AnimationClock.hpp"
 
 #include "../common/Enums.hpp"
 
@@ -25,9 +30,14 @@ namespace tson
 {
     using LinkedFileParser = std::function<std::unique_ptr<IJson>(std::string relativePath)>;
     class Object;
+    class TemplateCache;
     class Map
     {
         friend class Object;
+        friend class Layer;
+        friend class Tileset;
+        friend class MapSnapshot;
+        friend class Tileson;
         public:
             inline Map() = default;
             inline Map(ParseStatus status, std::string description);
@@ -59,6 +69,9 @@ namespace tson
             [[nodiscard]] inline ParseStatus getStatus() const;
             [[nodiscard]] inline const std::string &getStatusMessage() const;
             [[nodiscard]] inline const std::map<uint32_t, tson::Tile *> &getTileMap() const;
+            [[nodiscard]] inline const std::vector<tson::TileDrawInfo> &getTileDrawTable() const;
+            [[nodiscard]] inline const tson::TileDrawInfo *getTileDrawInfo(uint32_t gid) const;
+            [[nodiscard]] inline tson::AnimationClock &getAnimationClock();
 
             inline Layer * getLayer(const std::string &name);
             inline Tileset * getTileset(const std::string &name);
@@ -72,12 +85,32 @@ namespace tson
             inline DecompressorContainer *getDecompressors();
             inline Project * getProject();
             inline Tileset * getTilesetByGid(uint32_t gid);
+            inline void setTilesetCache(tson::TilesetCache *tilesetCache);
+            inline void setTemplateCache(tson::TemplateCache *templateCache);
+            inline void setLayerFilter(tson::LayerFilter layerFilter);
+            inline void setTileRegion(const tson::Rect &tileRegion);
+            [[nodiscard]] inline const tson::Rect &getTileRegion() const;
+            inline void loadLayers();
+            [[nodiscard]] inline bool hasUnloadedLayers() const;
+
+            inline tson::Object * getObj(int id);
+            inline tson::Layer * getObjLayer(int id);
+            inline tson::Object * firstObj(const std::string &name);
+            inline std::vector<tson::Object *> getObjsByName(const std::string &name);
+            inline tson::Object * resolveObjectRef(const tson::Property *property);
+            inline void buildObjectLookup();
 
 
         private:
             inline IJson* parseLinkedFile(const std::string& path);
+            inline std::shared_ptr<const tson::ObjectTemplate> getTemplate(const std::string &relativePath); /*! Declared in tileson_forward.hpp */
             inline bool createTilesetData(IJson &json);
             inline void processData();
+            inline void processLayer(tson::Layer &layer);
+            inline void loadLayer(tson::Layer &layer);
+            inline void loadLayers(std::vector<tson::Layer> &layers);
+            inline void buildTileDrawTable();
+            inline void addObjectsToLookup(std::vector<tson::Layer> &layers);
 
             Colori                                 m_backgroundColor;   /*! 'backgroundcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) (optional)*/;
             Vector2i                               m_size;              /*! 'width' and 'height' of a Tiled map */
@@ -102,6 +135,8 @@ namespace tson
             std::string                            m_statusMessage {"OK"};
 
             std::map<uint32_t, tson::Tile*>        m_tileMap{};           /*! key: Tile ID. Value: Pointer to Tile*/
+            std::vector<tson::TileDrawInfo>        m_tileDrawTable;       /*! index: gid without flip flags */
+            tson::AnimationClock                   m_animationClock;      /*! All tile animations of the map */
 
             //v1.2.0
             int                                    m_compressionLevel {-1};  /*! 'compressionlevel': The compression level to use for tile layer
@@ -109,6 +144,10 @@ namespace tson
                                                                               *     Introduced in Tiled 1.3*/
             tson::DecompressorContainer *          m_decompressors {nullptr};
             tson::Project *                        m_project {nullptr};
+            tson::TilesetCache *                   m_tilesetCache {nullptr};  /*! External tilesets are copied from here when set */
+            tson::TemplateCache *                  m_templateCache {nullptr}; /*! Object templates are copied from here when set */
+            IJson *                                m_parsingJson {nullptr};   /*! The json of the map. Only set while parsing */
+            bool                                   m_hasCustomLinkedFileParser {false};
             std::map<uint32_t, tson::Tile>         m_flaggedTileMap{};    /*! key: Tile ID. Value: Tile*/
 
             std::string                            m_classType{};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
@@ -116,6 +155,16 @@ namespace tson
 
             tson::LinkedFileParser                 m_linkedFileParser;     /*! callback function to parse linked files */
             std::map<std::string, std::unique_ptr<IJson>> m_linkedFiles;  /*! key: relative path to linked file. Value: Pointer to loaded JSON */
+
+            std::unordered_map<int, std::pair<tson::Layer *, size_t>> m_objectIds;      /*! key: Object ID. Value: Layer containing the object and its index in that layer */
+            std::unordered_multimap<std::string, int>                  m_objectNames;    /*! key: Object name. Value: Object ID */
+
+            tson::LayerFilter                      m_layerFilter;          /*! Layers rejected by the filter are skipped while parsing */
+            tson::Rect                             m_tileRegion;           /*! If not empty, only the tiles inside it are decoded. In tile units */
+            std::unique_ptr<IJson>                 m_json;                 /*! Owns the json of the map while it has lazy layers that are not loaded */
+            std::unique_ptr<tson::DecompressorContainer> m_lazyDecompressors;  /*! Copy of the decompressors of the parser, used by lazy layers */
+            std::shared_ptr<tson::TemplateCache>   m_lazyTemplateCache;    /*! Keeps the template cache of the parser alive for lazy layers */
+            size_t                                 m_unloadedLayers {0};   /*! Number of lazy layers that are not loaded yet */
     };
 
     /*!
@@ -163,6 +212,8 @@ bool tson::Map::parse(IJson &json, tson::DecompressorContainer *decompressors, t
     m_decompressors = decompressors;
     m_project = project;
     m_linkedFileParser = linkedFileParser;
+    m_hasCustomLinkedFileParser = static_cast<bool>(linkedFileParser);
+    m_parsingJson = &json;
 
     if(!m_linkedFileParser)
     {  // build a default linked file parser out of processing relative paths to
@@ -206,15 +257,9 @@ bool tson::Map::parse(IJson &json, tson::DecompressorContainer *decompressors, t
     //Reason for removal is that it seems to have no real use, as TiledVersion is stored in another variable.
     //if(json.count("version") > 0) m_version = json["version"].get<int>(); else allFound = false;
 
-    //More advanced data
+    //More advanced data. Layers are only lazy when the map owns the json, which tson::Tileson does with setLazyLayers()
     if(json.count("layers") > 0 && json["layers"].isArray())
-    {
-        auto &array = json.array("layers");
-        std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
-        {
-            m_layers.emplace_back(*item, this);
-        });
-    }
+        tson::Layer::ParseLayers(json, this, m_layers, m_layerFilter, m_json != nullptr && m_json.get() == &json);
 
     if(json.count("properties") > 0 && json["properties"].isArray())
     {
@@ -237,8 +282,14 @@ bool tson::Map::parse(IJson &json, tson::DecompressorContainer *decompressors, t
         allFound = false;
 
     processData();
+    buildObjectLookup();
 
-    m_linkedFiles.clear(); // close all open linked json files
+    m_parsingJson = nullptr;
+    if(m_unloadedLayers == 0)
+    {
+        m_linkedFiles.clear(); // close all open linked json files
+        m_json.reset();
+    }
 
     return allFound;
 }
@@ -284,7 +335,7 @@ bool tson::Map::createTilesetData(IJson &json)
         std::for_each(tilesets.begin(), tilesets.end(), [&](std::unique_ptr<IJson> &item)
         {
             item->directory(json.directory());
-            if(!m_tilesets[i].parse(*item, this))
+            if(!m_tilesets[i].parse(*item, this, m_tilesetCache))
                 ok = false;
 
             ++i;
@@ -315,22 +366,146 @@ void tson::Map::processData()
     std::for_each(m_layers.begin(), m_layers.end(), [&](tson::Layer &layer)
     {
         layer.assignTileMap(&m_tileMap);
-        layer.createTileData(m_size, m_isInfinite);
-        const std::set<uint32_t> &flaggedTiles = layer.getUniqueFlaggedTiles();
-        for(uint32_t ftile : flaggedTiles)
+        if(layer.isLoaded())
+            processLayer(layer);
+    });
+
+    buildTileDrawTable();
+    m_animationClock.build(m_tilesets);
+}
+
+/*!
+ * Creates the tile data of a layer, and adds the flipped tiles it uses to the tile map.
+ */
+void tson::Map::processLayer(tson::Layer &layer)
+{
+    layer.createTileData(m_size, m_isInfinite);
+    const std::set<uint32_t> &flaggedTiles = layer.getUniqueFlaggedTiles();
+    for(uint32_t ftile : flaggedTiles)
+    {
+        tson::Tile tile = tson::Tile::CreateFlippedTile(ftile, layer.getMap());
+        if(m_tileMap.count(tile.getGid()))
         {
-            tson::Tile tile = tson::Tile::CreateFlippedTile(ftile, layer.getMap());
-            if(m_tileMap.count(tile.getGid()))
+            tson::Tile *originalTile = m_tileMap[tile.getGid()];
+            tile.addTilesetAndPerformCalculations(originalTile->getTileset());
+            tile.setProperties(originalTile->getProperties());
+            m_flaggedTileMap[ftile] = tile;
+            m_tileMap[ftile] = &m_flaggedTileMap[ftile];
+        }
+    }
+    layer.resolveFlaggedTiles();
+}
+
+/*!
+ * Reads the deferred part of a lazy layer, and does what parse() does for the layers that are not lazy.
+ * The json of the map is released when the last layer is loaded.
+ */
+void tson::Map::loadLayer(tson::Layer &layer)
+{
+    IJson *json = layer.m_lazyJson;
+    layer.m_lazyJson = nullptr;
+
+    m_parsingJson = m_json.get();
+    layer.parseData(*json);
+    m_parsingJson = nullptr;
+
+    //Only the top level layers have tile data, like in processData()
+    if(layer.m_tileMap != nullptr)
+        processLayer(layer);
+    if(!layer.m_objects.empty())
+        buildObjectLookup();
+
+    if(--m_unloadedLayers == 0)
+    {
+        m_linkedFiles.clear();
+        m_json.reset();
+    }
+}
+
+void tson::Map::loadLayers(std::vector<tson::Layer> &layers)
+{
+    for(auto &layer : layers)
+    {
+        layer.load();
+        loadLayers(layer.m_layers);
+    }
+}
+
+/*!
+ * Precalculates the drawing rect, UVs and tile offset of every gid of every tileset, so they can be found with a single array lookup.
+ * Unlike tson::Tile::getDrawingRect(), the tile size of the tileset is used for the position of a tile in the image,
+ * which matches Tiled when the tilesets have a different tile size than the map.
+ */
+void tson::Map::buildTileDrawTable()
+{
+    m_tileDrawTable.clear();
+
+    uint32_t maxGid = 0;
+    for(auto &tileset : m_tilesets)
+    {
+        if(tileset.getTileCount() > 0)
+            maxGid = std::max(maxGid, static_cast<uint32_t>(tileset.getFirstgid() + tileset.getTileCount() - 1));
+        for(auto &tile : tileset.getTiles())
+            maxGid = std::max(maxGid, tile.getGid());
+    }
+    if(maxGid == 0)
+        return;
+
+    m_tileDrawTable.resize(static_cast<size_t>(maxGid) + 1);
+    for(auto &tileset : m_tilesets)
+    {
+        tson::Vector2i const tileOffset = tileset.getTileOffset();
+        if(tileset.getType() == tson::TilesetType::ImageCollectionTileset)
+        {
+            for(auto &tile : tileset.getTiles())
             {
-                tson::Tile *originalTile = m_tileMap[tile.getGid()];
-                tile.addTilesetAndPerformCalculations(originalTile->getTileset());
-                tile.setProperties(originalTile->getProperties());
-                m_flaggedTileMap[ftile] = tile;
-                m_tileMap[ftile] = &m_flaggedTileMap[ftile];
+                tson::TileDrawInfo &info = m_tileDrawTable[tile.getGid()];
+                const tson::Vector2i &imageSize = tile.getImageSize();
+                info.tile = &tile;
+                info.tileset = &tileset;
+                info.tileOffset = tileOffset;
+                info.drawingRect = tile.getSubRectangle();
+                if(imageSize.x > 0 && imageSize.y > 0)
+                {
+                    info.uvTopLeft = {static_cast<float>(info.drawingRect.x) / static_cast<float>(imageSize.x),
+                                      static_cast<float>(info.drawingRect.y) / static_cast<float>(imageSize.y)};
+                    info.uvBottomRight = {static_cast<float>(info.drawingRect.x + info.drawingRect.width) / static_cast<float>(imageSize.x),
+                                          static_cast<float>(info.drawingRect.y + info.drawingRect.height) / static_cast<float>(imageSize.y)};
+                }
             }
+            continue;
         }
-        layer.resolveFlaggedTiles();
-    });
+
+        int const columns = tileset.getColumns();
+        const tson::Vector2i &tileSize = tileset.getTileSize();
+        const tson::Vector2i &imageSize = tileset.getImageSize();
+        if(columns <= 0)
+            continue;
+
+        auto const firstGid = static_cast<uint32_t>(tileset.getFirstgid());
+        for(int id = 0; id < tileset.getTileCount(); ++id)
+        {
+            tson::TileDrawInfo &info = m_tileDrawTable[firstGid + static_cast<uint32_t>(id)];
+            info.tileset = &tileset;
+            info.tileOffset = tileOffset;
+            info.drawingRect = {tileset.getMargin() + (id % columns) * (tileSize.x + tileset.getSpacing()),
+                                tileset.getMargin() + (id / columns) * (tileSize.y + tileset.getSpacing()),
+                                tileSize.x, tileSize.y};
+            if(imageSize.x > 0 && imageSize.y > 0)
+            {
+                info.uvTopLeft = {static_cast<float>(info.drawingRect.x) / static_cast<float>(imageSize.x),
+                                  static_cast<float>(info.drawingRect.y) / static_cast<float>(imageSize.y)};
+                info.uvBottomRight = {static_cast<float>(info.drawingRect.x + tileSize.x) / static_cast<float>(imageSize.x),
+                                      static_cast<float>(info.drawingRect.y + tileSize.y) / static_cast<float>(imageSize.y)};
+            }
+        }
+
+        for(auto &tile : tileset.getTiles())
+        {
+            if(tile.getGid() < m_tileDrawTable.size() && m_tileDrawTable[tile.getGid()].tileset == &tileset)
+                m_tileDrawTable[tile.getGid()].tile = &tile;
+        }
+    }
 }
 
 /*!
@@ -495,6 +670,73 @@ tson::Layer *tson::Map::getLayer(const std::string &name)
     return &result.operator*();
 }
 
+/*!
+ * Makes external tilesets be copied from a cache instead of being parsed. Must be set before parsing.
+ * tson::Tileson sets this when it has a tileset cache.
+ * @param tilesetCache The cache. nullptr parses every external tileset.
+ */
+void tson::Map::setTilesetCache(tson::TilesetCache *tilesetCache)
+{
+    m_tilesetCache = tilesetCache;
+}
+
+/*!
+ * Makes template instances be copied from a cache of parsed templates, instead of merging the template file into every instance.
+ * Must be set before parsing. tson::Tileson sets this when it has a template cache.
+ * @param templateCache The cache. nullptr reads the template file for every instance.
+ */
+void tson::Map::setTemplateCache(tson::TemplateCache *templateCache)
+{
+    m_templateCache = templateCache;
+}
+
+/*!
+ * Skips the layers rejected by the filter. Must be set before parsing. tson::Tileson sets this when it has a layer filter.
+ * A rejected group layer is kept if any of its child layers are accepted. All child layers of an accepted group are kept.
+ * @param layerFilter The filter. An empty filter keeps every layer.
+ */
+void tson::Map::setLayerFilter(tson::LayerFilter layerFilter)
+{
+    m_layerFilter = std::move(layerFilter);
+}
+
+/*!
+ * Makes the tile layers of a finite map only decode the tiles inside a rectangle. Must be set before parsing.
+ * tson::Tileson sets this when it has a tile region. See tson::Layer::hasRegion() for how such layers are stored.
+ * Infinite maps only read the chunks that overlap the rectangle.
+ * @param tileRegion The rectangle in tile units. An empty rectangle decodes every tile.
+ */
+void tson::Map::setTileRegion(const tson::Rect &tileRegion)
+{
+    m_tileRegion = tileRegion;
+}
+
+/*!
+ * The rectangle the tile layers were decoded with. Empty if every tile was decoded.
+ */
+const tson::Rect &tson::Map::getTileRegion() const
+{
+    return m_tileRegion;
+}
+
+/*!
+ * Loads every lazy layer of the map that is not loaded yet (see tson::Tileson::setLazyLayers()).
+ * Does nothing for maps without lazy layers.
+ */
+void tson::Map::loadLayers()
+{
+    if(m_unloadedLayers > 0)
+        loadLayers(m_layers);
+}
+
+/*!
+ * Whether any lazy layer of the map has not been loaded yet. See tson::Tileson::setLazyLayers().
+ */
+bool tson::Map::hasUnloadedLayers() const
+{
+    return m_unloadedLayers > 0;
+}
+
 /*!
  * Gets a tileset by name
  *
@@ -562,6 +804,40 @@ const std::map<uint32_t, tson::Tile *> &tson::Map::getTileMap() const
     return m_tileMap;
 }
 
+/*!
+ * A table with drawing information for each gid, where the index is the gid without flip flags.
+ * Index 0 and gids not used by any tileset have a nullptr tile and tileset.
+ * @return The table of drawing information
+ */
+const std::vector<tson::TileDrawInfo> &tson::Map::getTileDrawTable() const
+{
+    return m_tileDrawTable;
+}
+
+/*!
+ * The animations of all animated tiles in the map, sharing one clock.
+ * Call update() on it once per frame, and use getCurrentGid() to find the gid to draw for an animated tile.
+ * @return The animation clock of the map
+ */
+tson::AnimationClock &tson::Map::getAnimationClock()
+{
+    return m_animationClock;
+}
+
+/*!
+ * Gets the drawing information of a gid. Flip flags are ignored.
+ * @param gid The gid, with or without flip flags
+ * @return The drawing information, or nullptr if no tileset contains the gid.
+ */
+const tson::TileDrawInfo *tson::Map::getTileDrawInfo(uint32_t gid) const
+{
+    gid &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+    if(gid >= m_tileDrawTable.size() || m_tileDrawTable[gid].tileset == nullptr)
+        return nullptr;
+
+    return &m_tileDrawTable[gid];
+}
+
 tson::DecompressorContainer *tson::Map::getDecompressors()
 {
     return m_decompressors;
@@ -597,5 +873,119 @@ const std::string &tson::Map::getClassType() const
     return m_classType;
 }
 
+/*!
+ * Builds the map-wide lookup tables used by getObj(), getObjLayer(), firstObj(), getObjsByName() and resolveObjectRef().
+ * Objects in every layer are included, also the ones inside group layers. Lazy layers are loaded by those functions, not by this one.
+ * This is done automatically at the end of parse(), but must be called again if objects or layers are added or removed afterwards.
+ */
+void tson::Map::buildObjectLookup()
+{
+    m_objectIds.clear();
+    m_objectNames.clear();
+    addObjectsToLookup(m_layers);
+}
+
+void tson::Map::addObjectsToLookup(std::vector<tson::Layer> &layers)
+{
+    for(auto &layer : layers)
+    {
+        //Not through getObjects(), which would load lazy layers
+        std::vector<tson::Object> &objects = layer.m_objects;
+        for(size_t i = 0; i < objects.size(); ++i)
+        {
+            //If an id exists more than once, the first one wins, like with Layer::getObj()
+            if(m_objectIds.emplace(objects[i].getId(), std::make_pair(&layer, i)).second)
+                m_objectNames.emplace(objects[i].getName(), objects[i].getId());
+        }
+        addObjectsToLookup(layer.m_layers);
+    }
+}
+
+/*!
+ * Get an object by ID, no matter which layer it belongs to. Runs in constant time.
+ * @param id Unique ID of the object
+ * @return A pointer to the object if found. nullptr otherwise.
+ */
+tson::Object *tson::Map::getObj(int id)
+{
+    loadLayers();
+    auto iter = m_objectIds.find(id);
+    if(iter == m_objectIds.end())
+        return nullptr;
+
+    return &iter->second.first->getObjects()[iter->second.second];
+}
+
+/*!
+ * Get the layer containing the object with the given ID. Runs in constant time.
+ * @param id Unique ID of the object
+ * @return A pointer to the layer if an object with the ID was found. nullptr otherwise.
+ */
+tson::Layer *tson::Map::getObjLayer(int id)
+{
+    loadLayers();
+    auto iter = m_objectIds.find(id);
+    return (iter == m_objectIds.end()) ? nullptr : iter->second.first;
+}
+
+/*!
+ * Returns the object with the given name and the lowest ID, searching all layers.
+ * @param name Name of the object to find.
+ * @return A pointer to the object if found. nullptr otherwise.
+ */
+tson::Object *tson::Map::firstObj(const std::string &name)
+{
+    loadLayers();
+    auto range = m_objectNames.equal_range(name);
+    if(range.first == range.second)
+        return nullptr;
+
+    int id = range.first->second;
+    for(auto iter = range.first; iter != range.second; ++iter)
+        id = std::min(id, iter->second);
+
+    return getObj(id);
+}
+
+/*!
+ * Gets all objects with a name that equals the parameter, searching all layers.
+ * @param name Name of the objects to return
+ * @return Pointers to all objects with a matching name, sorted by ID.
+ */
+std::vector<tson::Object *> tson::Map::getObjsByName(const std::string &name)
+{
+    loadLayers();
+    auto range = m_objectNames.equal_range(name);
+    std::vector<int> ids;
+    for(auto iter = range.first; iter != range.second; ++iter)
+        ids.push_back(iter->second);
+    std::sort(ids.begin(), ids.end());
+
+    std::vector<tson::Object *> found;
+    found.reserve(ids.size());
+    for(int id : ids)
+        found.push_back(getObj(id));
+
+    return found;
+}
+
+/*!
+ * Resolves a property of the 'object' type into the object it refers to.
+ * @param property A property of type tson::Type::Object
+ * @return A pointer to the referenced object. nullptr if the property is not an object reference or the object does not exist.
+ */
+tson::Object *tson::Map::resolveObjectRef(const tson::Property *property)
+{
+    if(property == nullptr || property->getType() != tson::Type::Object || !property->getValue().has_value())
+        return nullptr;
+
+    if(property->getValueType() == typeid(uint32_t))
+        return getObj(static_cast<int>(property->getValue<uint32_t>()));
+    else if(property->getValueType() == typeid(int))
+        return getObj(property->getValue<int>());
+
+    return nullptr;
+}
+
 
 #endif //TILESON_MAP_HPP
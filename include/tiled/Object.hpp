@@ -12,13 +12,18 @@
 
 #include "../common/Enums.hpp"
 #include <optional>
+#include <functional>
 
 namespace tson
 {
     class TiledClass;
     class Map;
+    class ObjectTemplate;
     class Object
     {
+        friend class Tileset;
+        friend class ObjectTemplate;
+        friend class MapSnapshot;
         public:
             //enum class Type : uint8_t
             //{
@@ -69,6 +74,8 @@ namespace tson
 
         private:
             inline void setObjectTypeByJson(IJson &json, IJson* templ);
+            inline void setObjectType(const std::function<bool(const std::string &)> &hasField, bool isTemplateInstance);
+            inline bool parseInstance(IJson &json, const tson::ObjectTemplate &objectTemplate); /*! Declared in tileson_forward.hpp */
 
             ObjectType                        m_objectType = ObjectType::Undefined;    /*! Says with object type this is */
             bool                              m_ellipse {};                            /*! 'ellipse': Used to mark an object as an ellipse */
@@ -194,21 +201,31 @@ tson::Object::Object(IJson &json, tson::Map *map)
  * @param json
  */
 void tson::Object::setObjectTypeByJson(IJson &json, IJson* templ)
+{
+    setObjectType([&](const std::string &name) { return readField(name, json, templ) != nullptr; }, json.count("template") > 0);
+}
+
+/*!
+ * Sets the object type from the fields the object has
+ * @param hasField true if the object, or its template, has a field
+ * @param isTemplateInstance true if the object has a 'template'
+ */
+void tson::Object::setObjectType(const std::function<bool(const std::string &)> &hasField, bool isTemplateInstance)
 {
     m_objectType = ObjectType::Undefined;
     if(m_ellipse)
         m_objectType = ObjectType::Ellipse;
     else if(m_point)
         m_objectType = ObjectType::Point;
-    else if(readField("polygon", json, templ))
+    else if(hasField("polygon"))
         m_objectType = ObjectType::Polygon;
-    else if(readField("polyline", json, templ))
+    else if(hasField("polyline"))
         m_objectType = ObjectType::Polyline;
-    else if(readField("text", json, templ))
+    else if(hasField("text"))
         m_objectType = ObjectType::Text;
-    else if(readField("gid", json, templ))
+    else if(hasField("gid"))
         m_objectType = ObjectType::Object;
-    else if(json.count("template") > 0)
+    else if(isTemplateInstance)
         m_objectType = ObjectType::Template;
     else
         m_objectType = ObjectType::Rectangle;
@@ -16,6 +16,7 @@
 
 namespace tson
 {
+    class Archive;
     class Project
     {
         public:
@@ -33,6 +34,7 @@ namespace tson
             inline explicit Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser);
             #endif
             inline bool parse(const fs::path &path);
+            inline bool parse(const tson::Archive &archive, const fs::path &path); //tileson_forward.hpp
             inline void parse();
 
             [[nodiscard]] inline const ProjectData &getData() const;
@@ -43,7 +45,7 @@ namespace tson
 
 
         private:
-            inline void parseJson(IJson &json);
+            inline void parseJson(IJson &json, bool loadFolders = true);
             fs::path m_path;
             std::vector<ProjectFolder> m_folders;
             ProjectData m_data;
@@ -81,7 +83,10 @@ namespace tson
         return m_data;
     }
 
-    void Project::parseJson(IJson &json)
+    /*!
+     * @param loadFolders Loads the tson::ProjectFolders of 'folders' from disk
+     */
+    void Project::parseJson(IJson &json, bool loadFolders)
     {
         m_data.basePath = (m_path.empty()) ? fs::path() : m_path.parent_path(); //The directory of the project file
 
@@ -111,8 +116,11 @@ namespace tson
             {
                 std::string folder = item->get<std::string>();
                 m_data.folders.emplace_back(folder);
-                m_data.folderPaths.emplace_back(m_data.basePath / folder);
-                m_folders.emplace_back(m_data.basePath / folder);
+                if(loadFolders)
+                {
+                    m_data.folderPaths.emplace_back(m_data.basePath / folder);
+                    m_folders.emplace_back(m_data.basePath / folder);
+                }
             });
         }
         if(json.count("objectTypesFile") > 0) m_data.objectTypesFile = json["objectTypesFile"].get<std::string>();
@@ -21,6 +21,7 @@ namespace tson
 
     class Tile
     {
+        friend class MapSnapshot;
         public:
             inline Tile() = default;
             inline Tile(IJson &json, tson::Tileset *tileset, tson::Map *map);
@@ -87,6 +88,7 @@ namespace tson
             inline void performDataCalculations();                                   /*! Declared in tileson_forward.hpp - Calculate all the values used in the tile class. */
             inline void manageFlipFlagsByIdThenRemoveFlags(uint32_t &id);
             friend class Layer;
+            friend class Tileset;
             std::shared_ptr<tson::TiledClass> m_class {};
     };
 
@@ -9,6 +9,7 @@ namespace tson
 {
     class TiledClass
     {
+        friend class MapSnapshot;
         public:
             inline explicit TiledClass() = default;
             inline explicit TiledClass(IJson &json, tson::Project *project = nullptr);
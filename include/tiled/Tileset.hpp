@@ -21,12 +21,15 @@ namespace tson
 {
     class Map;
     class Project;
+    class TilesetCache;
     class Tileset
     {
+        friend class TilesetCache;
+        friend class MapSnapshot;
         public:
             inline Tileset() = default;
-            inline explicit Tileset(IJson &json, tson::Map *map);
-            inline bool parse(IJson &json, tson::Map *map);
+            inline explicit Tileset(IJson &json, tson::Map *map, tson::TilesetCache *cache = nullptr);
+            inline bool parse(IJson &json, tson::Map *map, tson::TilesetCache *cache = nullptr);
 
             [[nodiscard]] inline int getColumns() const;
             [[nodiscard]] inline int getFirstgid() const;
@@ -80,6 +83,12 @@ namespace tson
             [[nodiscard]] inline tson::Project *getProject() const;
 
             inline void generateMissingTiles();
+            inline bool parseData(IJson &json);
+            inline bool parseSource(IJson &json, const fs::path &path, tson::Map *map);
+            inline bool parseFromCache(IJson &json, tson::TilesetCache &cache); /*! Declared in tileson_forward.hpp */
+            inline IJson *parseLinkedFile(); /*! Declared in tileson_forward.hpp */
+            inline void bind(tson::Map *map, int firstgid);
+            inline static void BindLayer(tson::Layer &layer, tson::Map *map);
 
             int                           m_columns {};       /*! 'columns': The number of tile columns in the tileset */
             int                           m_firstgid {};      /*! 'firstgid': GID corresponding to the first tile in the set */
@@ -139,12 +148,19 @@ namespace tson
     }
 }
 
-tson::Tileset::Tileset(IJson &json, tson::Map *map)
+tson::Tileset::Tileset(IJson &json, tson::Map *map, tson::TilesetCache *cache)
 {
-    parse(json, map);
+    parse(json, map, cache);
 }
 
-bool tson::Tileset::parse(IJson &json, tson::Map *map)
+/*!
+ * Parses a tileset of a map.
+ * @param json A json object with the format of Tileset
+ * @param map The map who owns the tileset
+ * @param cache When not nullptr, external tilesets ('source') are copied from the cache instead of being parsed
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Tileset::parse(IJson &json, tson::Map *map, tson::TilesetCache *cache)
 {
     m_map = map;
     bool allFound = true;
@@ -161,10 +177,46 @@ bool tson::Tileset::parse(IJson &json, tson::Map *map)
         m_source = fs::path(sourceStr);
         m_path = json.directory() / m_source;
 
+        //Maps with a custom tson::LinkedFileParser, like maps in a tson::Archive, read external tilesets through it
+        IJson *linkedFile = parseLinkedFile();
+        if(linkedFile != nullptr)
+            return parseData(*linkedFile);
+
+        if(cache != nullptr)
+            return parseFromCache(json, *cache);
+
         if(!json.parse(m_path))
             return false;
     }
 
+    bool const dataFound = parseData(json);
+    return allFound && dataFound;
+}
+
+/*!
+ * Parses an external tileset file on its own, to be kept in a tson::TilesetCache.
+ * It is parsed with 'firstgid' 1, and is not bound to a map afterwards.
+ * @param json The tileset file
+ * @param path Path to the tileset file
+ * @param map The map asking for the tileset. Only used while parsing.
+ */
+bool tson::Tileset::parseSource(IJson &json, const fs::path &path, tson::Map *map)
+{
+    m_map = map;
+    m_firstgid = 1;
+    m_source = path;
+    m_path = path;
+    bool const allFound = parseData(json);
+    bind(nullptr, m_firstgid);
+    return allFound;
+}
+
+/*!
+ * Parses everything but 'firstgid' and 'source'
+ */
+bool tson::Tileset::parseData(IJson &json)
+{
+    bool allFound = true;
 
     if (json.count("columns") > 0)
     {
@@ -268,6 +320,9 @@ bool tson::Tileset::parse(IJson &json, tson::Map *map)
         m_transformations.parse(json["transformations"]);
     }
 
+    for(auto &wangset : m_wangsets)
+        wangset.buildLookup(m_transformations, static_cast<uint32_t>(m_firstgid));
+
     generateMissingTiles();
 
     return allFound;
@@ -489,6 +544,60 @@ tson::Property *tson::Tileset::getProp(const std::string &name)
     return nullptr;
 }
 
+/*!
+ * Points a copied tileset, and everything in it, to a map and a 'firstgid'.
+ * Values that depend on them, like gids and drawing rects, are calculated again.
+ */
+void tson::Tileset::bind(tson::Map *map, int firstgid)
+{
+    bool const firstgidChanged = firstgid != m_firstgid;
+    m_map = map;
+    m_firstgid = firstgid;
+    m_class = nullptr;
+
+    for(auto &wangset : m_wangsets)
+    {
+        wangset.m_map = map;
+        wangset.m_class = nullptr;
+        for(auto *colors : {&wangset.m_cornerColors, &wangset.m_edgeColors, &wangset.m_colors})
+        {
+            for(auto &color : *colors)
+            {
+                color.m_map = map;
+                color.m_class = nullptr;
+            }
+        }
+        if(firstgidChanged)
+            wangset.buildLookup(m_transformations, static_cast<uint32_t>(firstgid));
+    }
+
+    for(auto &tile : m_tiles)
+    {
+        tile.m_tileset = this;
+        tile.m_map = map;
+        tile.m_gid = static_cast<uint32_t>(firstgid) + tile.m_id - 1;
+        tile.m_class = nullptr;
+        BindLayer(tile.m_objectgroup, map);
+        tile.performDataCalculations();
+    }
+}
+
+/*!
+ * Points a layer, its objects and its sub layers to a map
+ */
+void tson::Tileset::BindLayer(tson::Layer &layer, tson::Map *map)
+{
+    layer.m_map = map;
+    layer.m_class = nullptr;
+    for(auto &object : layer.m_objects)
+    {
+        object.m_map = map;
+        object.m_class = nullptr;
+    }
+    for(auto &child : layer.m_layers)
+        BindLayer(child, map);
+}
+
 /*!
  * Tiled only has tiles with a property stored in the map. This function makes sure even the ones with no properties will exist.
  */
@@ -9,6 +9,7 @@ namespace tson
 {
     class Transformations
     {
+        friend class MapSnapshot;
         public:
             inline Transformations() = default;
             inline explicit Transformations(IJson &json);
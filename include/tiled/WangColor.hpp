@@ -12,6 +12,8 @@ namespace tson
 {
     class WangColor
     {
+        friend class Tileset;
+        friend class MapSnapshot;
         public:
             inline WangColor() = default;
             inline explicit WangColor(IJson &json, tson::Map *map);
@@ -9,11 +9,14 @@
 #include "WangColor.hpp"
 #include "WangTile.hpp"
 #include "../objects/PropertyCollection.hpp"
+#include "../misc/WangLookup.hpp"
 
 namespace tson
 {
     class WangSet
     {
+        friend class Tileset;
+        friend class MapSnapshot;
         public:
             inline WangSet() = default;
             inline explicit WangSet(IJson &json, tson::Map *map);
@@ -37,6 +40,9 @@ namespace tson
             [[nodiscard]] inline const std::string &getClassType() const;
             [[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
 
+            [[nodiscard]] inline const tson::WangLookup &getLookup() const;
+            inline void buildLookup(const tson::Transformations &transformations, uint32_t firstgid);
+
         private:
 
             inline bool parseTiled15Props(IJson &json);
@@ -53,6 +59,7 @@ namespace tson
 
             tson::Map *                  m_map;
             std::string                  m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
+            tson::WangLookup             m_lookup;                    /*! Wang id -> tiles. Built by the tileset */
             std::shared_ptr<tson::TiledClass> m_class {};
 
     };
@@ -227,6 +234,25 @@ const std::string &tson::WangSet::getClassType() const
     return m_classType;
 }
 
+/*!
+ * A hash from packed wang ids to the tiles (and their allowed transformations) having them.
+ * Built by tson::Tileset when the tileset is loaded.
+ */
+const tson::WangLookup &tson::WangSet::getLookup() const
+{
+    return m_lookup;
+}
+
+/*!
+ * Creates the lookup of getLookup(). Called by tson::Tileset after parsing.
+ * @param transformations The transformations allowed by the tileset
+ * @param firstgid The first gid of the tileset
+ */
+void tson::WangSet::buildLookup(const tson::Transformations &transformations, uint32_t firstgid)
+{
+    m_lookup.build(m_wangTiles, transformations, firstgid);
+}
+
 
 
 
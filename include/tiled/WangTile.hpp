@@ -11,6 +11,7 @@ namespace tson
 {
     class WangTile
     {
+        friend class MapSnapshot;
         public:
             inline WangTile() = default;
             inline explicit WangTile(IJson &json);
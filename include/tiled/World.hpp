@@ -7,9 +7,16 @@
 
 #include "../objects/WorldMapData.hpp"
 #include <memory>
+#include <set>
+#include <regex>
+#include <limits>
+#include <unordered_map>
 namespace tson
 {
     class Tileson;
+    class Archive;
+    class TilesetCache;
+    class TemplateCache;
     class World
     {
         public:
@@ -27,9 +34,12 @@ namespace tson
             inline explicit World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser);
             #endif
             inline bool parse(const fs::path &path);
+            inline bool parse(const tson::Archive &archive, const fs::path &path); //tileson_forward.hpp
             inline std::size_t loadMaps(tson::Tileson *parser); //tileson_forward.hpp
             inline bool contains(std::string_view filename);
             inline const WorldMapData *get(std::string_view filename) const;
+            inline size_t mapsIntersecting(const tson::Rect &rect, std::vector<size_t> &out) const;
+            inline const WorldMapData *mapAt(const tson::Vector2i &point) const;
 
             [[nodiscard]] inline const fs::path &getPath() const;
             [[nodiscard]] inline const fs::path &getFolder() const;
@@ -37,17 +47,37 @@ namespace tson
             [[nodiscard]] inline bool onlyShowAdjacentMaps() const;
             [[nodiscard]] inline const std::string &getType() const;
             [[nodiscard]] inline const std::vector<std::unique_ptr<tson::Map>> &getMaps() const;
+            [[nodiscard]] inline const std::vector<size_t> &getFailedMaps() const;
+
+            static constexpr size_t MaxIndexCells = 1 << 20;   /*! The cells of the map index grow until there are no more than this */
 
         private:
             inline void parseJson(IJson &json);
+            inline void parsePatterns(IJson &json);
+            inline void buildIndex();
+            [[nodiscard]] inline std::vector<std::string> getFileNamesInArchive() const; //tileson_forward.hpp
+            [[nodiscard]] inline int cellX(int x) const;
+            [[nodiscard]] inline int cellY(int y) const;
 
             std::unique_ptr<IJson> m_json = nullptr;
             fs::path m_path;
             fs::path m_folder;
             std::vector<WorldMapData> m_mapData;
+            std::shared_ptr<tson::TilesetCache> m_tilesetCache;     /*! Shared by the maps of loadMaps(), when the parser has no cache of its own */
+            std::shared_ptr<tson::TemplateCache> m_templateCache;
             std::vector<std::unique_ptr<tson::Map>> m_maps;
-            bool m_onlyShowAdjacentMaps;
+            std::vector<size_t> m_failedMaps;                       /*! Indices in m_maps of the maps that failed to load */
+            bool m_onlyShowAdjacentMaps {false};
             std::string m_type;
+            const tson::Archive *m_archive {nullptr};               /*! The archive the world and its maps are in. nullptr when they are files */
+
+            //Index over the map rectangles: A uniform grid where every map is stored in each cell it touches
+            std::unordered_map<std::string, size_t> m_fileIndices;  /*! fileName -> index in m_mapData */
+            tson::Vector2i m_cellSize {1, 1};
+            tson::Vector2i m_gridOrigin;
+            tson::Vector2i m_gridSize;
+            std::vector<uint32_t> m_cellStart;                      /*! Offset into m_cellItems for each cell. Has one extra element at the end */
+            std::vector<uint32_t> m_cellItems;                      /*! Map indices, grouped by cell */
     };
 
     World::World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
@@ -59,6 +89,7 @@ namespace tson
     {
         m_path = path;
         m_folder = m_path.parent_path();
+        m_archive = nullptr;
 
         if(!m_json->parse(path))
             return false;
@@ -97,6 +128,73 @@ namespace tson
             auto &maps = json.array("maps");
             std::for_each(maps.begin(), maps.end(), [&](std::unique_ptr<IJson> &item) { m_mapData.emplace_back(m_folder, *item); });
         }
+        if(json.count("patterns") > 0 && json["patterns"].isArray())
+            parsePatterns(json);
+
+        buildIndex();
+    }
+
+    /*!
+     * Adds the maps in the folder of the world whose filename matches one of the 'patterns'.
+     * As in Tiled, the first two captures of the 'regexp' are the x and y of the map, which are multiplied by
+     * 'multiplierX'/'multiplierY' and moved by 'offsetX'/'offsetY'. The folder is only listed once, and maps that
+     * are listed in 'maps' are not added again.
+     */
+    void World::parsePatterns(IJson &json)
+    {
+        std::vector<std::string> fileNames;
+        if(m_archive != nullptr)
+            fileNames = getFileNamesInArchive();
+        else
+        {
+            std::error_code error;
+            for(const auto &entry : fs::directory_iterator(m_folder, error))
+            {
+                if(fs::is_regular_file(entry.status()))
+                    fileNames.push_back(entry.path().filename().generic_string());
+            }
+        }
+        std::sort(fileNames.begin(), fileNames.end());
+
+        std::set<std::string> known;
+        for(const auto &data : m_mapData)
+            known.insert(data.fileName);
+
+        auto &patterns = json.array("patterns");
+        for(auto &pattern : patterns)
+        {
+            if(pattern->count("regexp") == 0)
+                continue;
+
+            std::regex regexp;
+            try
+            {
+                regexp = std::regex((*pattern)["regexp"].get<std::string>());
+            }
+            catch(const std::regex_error &)
+            {
+                continue;
+            }
+
+            int const multiplierX = (pattern->count("multiplierX") > 0) ? (*pattern)["multiplierX"].get<int>() : 1;
+            int const multiplierY = (pattern->count("multiplierY") > 0) ? (*pattern)["multiplierY"].get<int>() : 1;
+            tson::Vector2i const offset {(pattern->count("offsetX") > 0) ? (*pattern)["offsetX"].get<int>() : 0,
+                                         (pattern->count("offsetY") > 0) ? (*pattern)["offsetY"].get<int>() : 0};
+            tson::Vector2i const mapSize {(pattern->count("mapWidth") > 0) ? (*pattern)["mapWidth"].get<int>() : multiplierX,
+                                          (pattern->count("mapHeight") > 0) ? (*pattern)["mapHeight"].get<int>() : multiplierY};
+
+            std::smatch match;
+            for(const auto &fileName : fileNames)
+            {
+                if(known.count(fileName) > 0 || !std::regex_search(fileName, match, regexp) || match.size() < 3)
+                    continue;
+
+                tson::Vector2i const position {std::atoi(match[1].str().c_str()) * multiplierX + offset.x,
+                                               std::atoi(match[2].str().c_str()) * multiplierY + offset.y};
+                m_mapData.emplace_back(m_folder, fileName, position, mapSize);
+                known.insert(fileName);
+            }
+        }
     }
 
     const fs::path &World::getFolder() const
@@ -112,8 +210,7 @@ namespace tson
      */
     bool World::contains(std::string_view filename)
     {
-        //Note: might be moved to std::ranges from C++20.
-        return std::any_of(m_mapData.begin(), m_mapData.end(), [&](const auto &item) { return item.fileName == filename; });
+        return m_fileIndices.count(std::string(filename)) > 0;
     }
 
     /*!
@@ -123,21 +220,166 @@ namespace tson
      */
     const WorldMapData * World::get(std::string_view filename) const
     {
-        auto iter = std::find_if(m_mapData.begin(), m_mapData.end(), [&](const auto &item) { return item.fileName == filename; });
-        return (iter == m_mapData.end()) ? nullptr : iter.operator->();
+        auto iter = m_fileIndices.find(std::string(filename));
+        return (iter == m_fileIndices.end()) ? nullptr : &m_mapData[iter->second];
+    }
+
+    /*!
+     * Gets all maps whose rectangle overlaps a rectangle. Maps that only touch the rectangle are not included,
+     * so the neighbours of a map are found by growing its rectangle by one pixel.
+     * Does not allocate when out has enough capacity.
+     * @param rect Rectangle in pixels, in the coordinates of the world
+     * @param out Receives the indices of the maps in getMapData(), in ascending order
+     * @return Number of maps found
+     */
+    size_t World::mapsIntersecting(const tson::Rect &rect, std::vector<size_t> &out) const
+    {
+        out.clear();
+        if(m_cellItems.empty() || rect.width <= 0 || rect.height <= 0)
+            return 0;
+
+        int const firstX = std::max(cellX(rect.x), 0);
+        int const firstY = std::max(cellY(rect.y), 0);
+        int const lastX = std::min(cellX(rect.x + rect.width - 1), m_gridSize.x - 1);
+        int const lastY = std::min(cellY(rect.y + rect.height - 1), m_gridSize.y - 1);
+        for(int y = firstY; y <= lastY; ++y)
+        {
+            for(int x = firstX; x <= lastX; ++x)
+            {
+                size_t const cell = static_cast<size_t>(y) * static_cast<size_t>(m_gridSize.x) + static_cast<size_t>(x);
+                for(uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+                {
+                    const WorldMapData &data = m_mapData[m_cellItems[i]];
+                    if(data.position.x >= rect.x + rect.width || rect.x >= data.position.x + data.size.x ||
+                       data.position.y >= rect.y + rect.height || rect.y >= data.position.y + data.size.y)
+                        continue;
+
+                    //Maps spanning several cells are only reported in the first cell they share with the rectangle
+                    if(x == std::max(firstX, cellX(data.position.x)) && y == std::max(firstY, cellY(data.position.y)))
+                        out.push_back(m_cellItems[i]);
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+        return out.size();
+    }
+
+    /*!
+     * Gets the map containing a point.
+     * @param point Position in pixels, in the coordinates of the world
+     * @return The first map (in the order of getMapData()) containing the point, or nullptr
+     */
+    const WorldMapData *World::mapAt(const tson::Vector2i &point) const
+    {
+        int const x = cellX(point.x);
+        int const y = cellY(point.y);
+        if(m_cellItems.empty() || x < 0 || y < 0 || x >= m_gridSize.x || y >= m_gridSize.y)
+            return nullptr;
+
+        const WorldMapData *result = nullptr;
+        size_t const cell = static_cast<size_t>(y) * static_cast<size_t>(m_gridSize.x) + static_cast<size_t>(x);
+        for(uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+        {
+            const WorldMapData &data = m_mapData[m_cellItems[i]];
+            if(point.x >= data.position.x && point.y >= data.position.y &&
+               point.x < data.position.x + data.size.x && point.y < data.position.y + data.size.y && (result == nullptr || &data < result))
+                result = &data;
+        }
+        return result;
+    }
+
+    /*!
+     * Creates the lookup by filename and the grid over the map rectangles.
+     * The cells are as large as the average map, so most maps touch no more than four cells.
+     */
+    void World::buildIndex()
+    {
+        m_fileIndices.clear();
+        m_cellStart.clear();
+        m_cellItems.clear();
+        m_gridSize = {0, 0};
+        for(size_t i = 0; i < m_mapData.size(); ++i)
+            m_fileIndices.emplace(m_mapData[i].fileName, i);
+
+        std::vector<uint32_t> maps;
+        int64_t totalWidth = 0;
+        int64_t totalHeight = 0;
+        tson::Vector2i min {std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+        tson::Vector2i max {std::numeric_limits<int>::min(), std::numeric_limits<int>::min()};
+        for(size_t i = 0; i < m_mapData.size(); ++i)
+        {
+            const WorldMapData &data = m_mapData[i];
+            if(data.size.x <= 0 || data.size.y <= 0)
+                continue;
+
+            maps.push_back(static_cast<uint32_t>(i));
+            totalWidth += data.size.x;
+            totalHeight += data.size.y;
+            min = {std::min(min.x, data.position.x), std::min(min.y, data.position.y)};
+            max = {std::max(max.x, data.position.x + data.size.x), std::max(max.y, data.position.y + data.size.y)};
+        }
+        if(maps.empty())
+            return;
+
+        m_gridOrigin = min;
+        m_cellSize = {std::max(1, static_cast<int>(totalWidth / static_cast<int64_t>(maps.size()))),
+                      std::max(1, static_cast<int>(totalHeight / static_cast<int64_t>(maps.size())))};
+        auto gridSize = [&]() -> tson::Vector2i
+        {
+            return {(max.x - min.x + m_cellSize.x - 1) / m_cellSize.x, (max.y - min.y + m_cellSize.y - 1) / m_cellSize.y};
+        };
+        for(m_gridSize = gridSize(); static_cast<size_t>(m_gridSize.x) * static_cast<size_t>(m_gridSize.y) > MaxIndexCells; m_gridSize = gridSize())
+            m_cellSize = {m_cellSize.x * 2, m_cellSize.y * 2};
+
+        //Counting sort of the maps by cell
+        auto forEachCell = [&](const WorldMapData &data, auto &&func)
+        {
+            for(int y = cellY(data.position.y); y <= cellY(data.position.y + data.size.y - 1); ++y)
+                for(int x = cellX(data.position.x); x <= cellX(data.position.x + data.size.x - 1); ++x)
+                    func(static_cast<size_t>(y) * static_cast<size_t>(m_gridSize.x) + static_cast<size_t>(x));
+        };
+        m_cellStart.assign(static_cast<size_t>(m_gridSize.x) * static_cast<size_t>(m_gridSize.y) + 1, 0);
+        for(uint32_t i : maps)
+            forEachCell(m_mapData[i], [&](size_t cell) { ++m_cellStart[cell + 1]; });
+        for(size_t cell = 1; cell < m_cellStart.size(); ++cell)
+            m_cellStart[cell] += m_cellStart[cell - 1];
+
+        std::vector<uint32_t> next(m_cellStart.begin(), m_cellStart.end() - 1);
+        m_cellItems.resize(m_cellStart.back());
+        for(uint32_t i : maps)
+            forEachCell(m_mapData[i], [&](size_t cell) { m_cellItems[next[cell]++] = i; });
+    }
+
+    int World::cellX(int x) const
+    {
+        int const offset = x - m_gridOrigin.x;
+        return (offset >= 0) ? offset / m_cellSize.x : -1;
+    }
+
+    int World::cellY(int y) const
+    {
+        int const offset = y - m_gridOrigin.y;
+        return (offset >= 0) ? offset / m_cellSize.y : -1;
     }
 
     /*!
      * Get all maps that have been loaded by loadMaps().
-     * NOTE: This is untested, and was a last second addition to Tileson 1.2.0, as I had forgot about the loadMaps() functionality (also untested)
-     * If you find anything malfunctioning - please report.
-     * @return All maps loaded by loadMaps()
+     * @return All maps loaded by loadMaps(), in the order of getMapData(). Maps that failed to load have the status of the failure.
      */
     const std::vector<std::unique_ptr<tson::Map>> &World::getMaps() const
     {
         return m_maps;
     }
 
+    /*!
+     * The maps of the last loadMaps() that did not load, like maps whose file does not exist.
+     * @return Indices in getMaps() and getMapData(), in ascending order
+     */
+    const std::vector<size_t> &World::getFailedMaps() const
+    {
+        return m_failedMaps;
+    }
+
 }
 
 #endif //TILESON_WORLD_HPP
@@ -38,6 +38,7 @@
 #include <fstream>
 #include <sstream>
 #include <memory>
+#include <future>
 
 #include "common/Tools.hpp"
 #include "common/Base64Decompressor.hpp"
@@ -45,9 +46,24 @@
 #include "common/DecompressorContainer.hpp"
 #include "misc/MemoryStream.hpp"
 #include "tiled/Map.hpp"
+#include "misc/TilesetCache.hpp"
+#include "misc/TemplateCache.hpp"
 #include "tiled/TiledEnum.hpp"
 #include "tiled/TiledClass.hpp"
 #include "tiled/Project.hpp"
+#include "misc/TileBatch.hpp"
+#include "misc/CollisionBuilder.hpp"
+#include "misc/NavigationGrid.hpp"
+#include "misc/WangAutotiler.hpp"
+#include "misc/WorldStreamer.hpp"
+#include "misc/MapSnapshot.hpp"
+#include "misc/MappedFile.hpp"
+#include "misc/FlatMap.hpp"
+#include "misc/MapView.hpp"
+#include "misc/Archive.hpp"
+#include "objects/MapInfo.hpp"
+#include "misc/MapProbe.hpp"
+#include "misc/ParsePool.hpp"
 
 
 namespace tson
@@ -55,6 +71,9 @@ namespace tson
     class Tileson
     {
         public:
+            /*! Gets each map parsed by parseMany(). Called from the background threads. */
+            using ParseCallback = std::function<void(size_t index, std::unique_ptr<tson::Map> map)>;
+
             #ifdef JSON11_IS_DEFINED
             inline explicit Tileson(std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>(), bool includeBase64Decoder = true);
             inline explicit Tileson(tson::Project *project, std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>(), bool includeBase64Decoder = true);
@@ -65,13 +84,55 @@ namespace tson
 
             inline std::unique_ptr<tson::Map> parse(const fs::path &path, std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor = nullptr);
             inline std::unique_ptr<tson::Map> parse(const void * data, size_t size, std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor = nullptr);
+            inline std::unique_ptr<tson::Map> parse(const tson::Archive &archive, const fs::path &path);
+            inline std::future<std::unique_ptr<tson::Map>> parseAsync(const fs::path &path);
+            inline std::future<std::unique_ptr<tson::Map>> parseAsync(const tson::Archive &archive, const fs::path &path);
+            inline std::vector<std::future<std::unique_ptr<tson::Map>>> parseMany(const std::vector<fs::path> &paths);
+            inline void parseMany(const std::vector<fs::path> &paths, ParseCallback callback);
+            inline void waitForParses();
             inline tson::DecompressorContainer *decompressors();
+            inline void setTilesetCache(std::shared_ptr<tson::TilesetCache> tilesetCache);
+            [[nodiscard]] inline const std::shared_ptr<tson::TilesetCache> &getTilesetCache() const;
+            inline void setTemplateCache(std::shared_ptr<tson::TemplateCache> templateCache);
+            [[nodiscard]] inline const std::shared_ptr<tson::TemplateCache> &getTemplateCache() const;
+            inline void setSnapshotMode(tson::SnapshotMode snapshotMode);
+            [[nodiscard]] inline tson::SnapshotMode getSnapshotMode() const;
+            inline void setLayerFilter(tson::LayerFilter layerFilter);
+            [[nodiscard]] inline const tson::LayerFilter &getLayerFilter() const;
+            inline void setLazyLayers(bool lazyLayers);
+            [[nodiscard]] inline bool hasLazyLayers() const;
+            inline void setTileRegion(const tson::Rect &tileRegion);
+            [[nodiscard]] inline const tson::Rect &getTileRegion() const;
+            inline void setThreadCount(size_t threadCount);
+            [[nodiscard]] inline size_t getThreadCount() const;
+
+            inline static std::unique_ptr<tson::Map> CreateFailedMap(const std::exception_ptr &error);
 
         private:
-            inline std::unique_ptr<tson::Map> parseJson();
+            inline std::unique_ptr<tson::Map> parseJson(tson::LinkedFileParser linkedFileParser = nullptr);
+            inline std::unique_ptr<tson::Map> parseWithSnapshot(const fs::path &path);
+            /*! Parses a map with the parser of a background thread */
+            using ParseFunction = std::function<std::unique_ptr<tson::Map>(tson::Tileson &parser)>;
+            /*! Gets the map of a job, or the exception thrown while parsing it */
+            using ParseResult = std::function<void(std::unique_ptr<tson::Map> map, std::exception_ptr error)>;
+
+            inline void pushParseJob(ParseFunction parse, ParseResult result);
+            inline std::future<std::unique_ptr<tson::Map>> pushAsyncParseJob(ParseFunction parse);
             std::unique_ptr<tson::IJson> m_json;
             tson::DecompressorContainer m_decompressors;
             tson::Project *m_project {nullptr};
+            std::shared_ptr<tson::TilesetCache> m_tilesetCache;
+            std::shared_ptr<tson::TemplateCache> m_templateCache;
+            tson::SnapshotMode m_snapshotMode {tson::SnapshotMode::Disabled};
+            tson::LayerFilter m_layerFilter;
+            bool m_lazyLayers {false};
+            tson::Rect m_tileRegion;
+            size_t m_threadCount {0};
+            std::unique_ptr<tson::ParsePool> m_pool;    //Created by the first background parse
+            //The decompressors the background parsers clone. Replaced when decompressors() changes.
+            //In a background parser: The decompressors its own were cloned from.
+            std::shared_ptr<const tson::DecompressorContainer> m_poolDecompressors;
+            uint64_t m_poolDecompressorsRevision {0};
     };
 }
 
@@ -115,6 +176,10 @@ std::unique_ptr<tson::Map> tson::Tileson::parse(const fs::path &path, std::uniqu
         if(result)
             return parseJson();
     }
+    else if(m_snapshotMode != tson::SnapshotMode::Disabled && !m_layerFilter && m_tileRegion.width <= 0)
+    {
+        return parseWithSnapshot(path);
+    }
     else if(m_json->parse(path))
     {
         return parseJson();
@@ -153,25 +218,96 @@ std::unique_ptr<tson::Map> tson::Tileson::parse(const void *data, size_t size, s
     return parseJson();
 }
 
+/*!
+ * Parses a map in a tson::Archive. External tilesets and templates are read from the archive, relative to the map.
+ * @param archive The archive. Must stay open while parsing.
+ * @param path Path of the map in the archive
+ * @return parsed data as Map
+ */
+std::unique_ptr<tson::Map> tson::Tileson::parse(const tson::Archive &archive, const fs::path &path)
+{
+    std::vector<uint8_t> content;
+    if(!archive.read(path, content))
+        return std::make_unique<tson::Map>(tson::ParseStatus::FileNotFound, "File not found in archive: " + path.generic_string());
+
+    if(!m_json->parse(content.data(), content.size()))
+        return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Parse error: " + path.generic_string());
+
+    //Paths of the map, like the images of tilesets, are relative to the root of the archive
+    m_json->directory(fs::path(tson::Archive::NormalizePath(path)).parent_path());
+    return parseJson(archive.createLinkedFileParser(*m_json, path));
+}
+
 /*!
  * Common parsing functionality for doing the json parsing
  * @param json Tiled json to parse
  * @return parsed data as Map
  */
-std::unique_ptr<tson::Map> tson::Tileson::parseJson()
+std::unique_ptr<tson::Map> tson::Tileson::parseJson(tson::LinkedFileParser linkedFileParser)
 {
     std::unique_ptr<tson::Map> map = std::make_unique<tson::Map>();
+    map->setTilesetCache(m_tilesetCache.get());
+    map->setTemplateCache(m_templateCache.get());
+    map->setLayerFilter(m_layerFilter);
+    map->setTileRegion(m_tileRegion);
+
+    tson::IJson *json = m_json.get();
+    tson::DecompressorContainer *decompressors = &m_decompressors;
+    if(m_lazyLayers)
+    {
+        //The lazy layers of the map read from its json until they are loaded, so the map takes it and a new one is used for the next parse
+        map->m_json = std::move(m_json);
+        m_json = json->create();
 
-    if(map->parse(*m_json, &m_decompressors, m_project))
+        //The map can outlive this parser, so it gets its own decompressors and keeps the template cache alive
+        map->m_lazyDecompressors = std::make_unique<tson::DecompressorContainer>(m_decompressors.clone());
+        map->m_lazyTemplateCache = m_templateCache;
+        decompressors = map->m_lazyDecompressors.get();
+    }
+
+    if(map->parse(*json, decompressors, m_project, std::move(linkedFileParser)))
         return map;
 
     return std::make_unique<tson::Map> (tson::ParseStatus::MissingData, "Missing map data...");
 }
 
+/*!
+ * Parses a map file through its .tsonb snapshot (see tson::MapSnapshot): The snapshot is loaded instead of the json
+ * when it was made from the same json, and none of the files the map depends on have changed since.
+ * Otherwise the json is parsed, and a new snapshot is written when the mode is tson::SnapshotMode::ReadWrite.
+ * @param path path to file
+ * @return parsed data as Map
+ */
+std::unique_ptr<tson::Map> tson::Tileson::parseWithSnapshot(const fs::path &path)
+{
+    std::vector<uint8_t> source;
+    std::error_code error;
+    fs::file_time_type const modified = fs::last_write_time(path, error);
+    if(error || !tson::MapSnapshot::ReadFile(path, source) || source.empty())
+        return std::make_unique<tson::Map>(tson::ParseStatus::FileNotFound, "File not found: " + path.generic_string());
+
+    uint64_t const hash = tson::MapSnapshot::Hash(source.data(), source.size());
+    fs::path const snapshotPath = tson::MapSnapshot::GetPath(path);
+    std::unique_ptr<tson::Map> map = tson::MapSnapshot::LoadIfCurrent(snapshotPath, hash, modified, m_project, &m_decompressors);
+    if(map != nullptr)
+        return map;
+
+    if(!m_json->parse(source.data(), source.size()))
+        return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Parse error: " + path.generic_string());
+    m_json->directory(path.parent_path());
+
+    map = parseJson();
+    if(m_snapshotMode == tson::SnapshotMode::ReadWrite && map->getStatus() == tson::ParseStatus::OK)
+        tson::MapSnapshot::Save(*map, snapshotPath, hash, path.parent_path());
+
+    return map;
+}
+
 /*!
  * Gets the decompressor container used when something is either encoded or compressed (regardless: IDecompressor is used as base).
  * These are used specifically for tile layers, and are connected by checking the name of the IDecompressor. If the name of a decompressor
  * matches with an encoding or a compression, its decompress() function will be used.
+ * Changes are also used by the maps parseAsync() and parseMany() queue after them, as the background threads clone the decompressors again.
  *
  * @return The container including all decompressors.
  */
@@ -180,4 +316,307 @@ tson::DecompressorContainer *tson::Tileson::decompressors()
     return &m_decompressors;
 }
 
+/*!
+ * Attaches a cache of external tilesets. Maps parsed afterwards copy their external tilesets from the cache,
+ * so a tileset file shared by many maps is only parsed once. The cache can be shared by several tson::Tileson instances.
+ * @param tilesetCache The cache. nullptr parses every external tileset again.
+ */
+void tson::Tileson::setTilesetCache(std::shared_ptr<tson::TilesetCache> tilesetCache)
+{
+    m_tilesetCache = std::move(tilesetCache);
+}
+
+/*!
+ * The attached tileset cache. nullptr if there is none.
+ */
+const std::shared_ptr<tson::TilesetCache> &tson::Tileson::getTilesetCache() const
+{
+    return m_tilesetCache;
+}
+
+/*!
+ * Attaches a cache of object templates. Maps parsed afterwards parse each template file once, and their template instances
+ * only read the fields they override. The cache can be shared by several tson::Tileson instances.
+ * @param templateCache The cache. nullptr reads the template file for every instance.
+ */
+void tson::Tileson::setTemplateCache(std::shared_ptr<tson::TemplateCache> templateCache)
+{
+    m_templateCache = std::move(templateCache);
+}
+
+/*!
+ * The attached template cache. nullptr if there is none.
+ */
+const std::shared_ptr<tson::TemplateCache> &tson::Tileson::getTemplateCache() const
+{
+    return m_templateCache;
+}
+
+/*!
+ * Lets parse() of a file use a binary snapshot of the map ('<map>.tsonb' next to it), which loads without any json parsing.
+ * Snapshots are only used for files parsed without a decompressor, a layer filter or a tile region.
+ * @param snapshotMode tson::SnapshotMode::Read only loads snapshots that exist. tson::SnapshotMode::ReadWrite also writes them.
+ */
+void tson::Tileson::setSnapshotMode(tson::SnapshotMode snapshotMode)
+{
+    m_snapshotMode = snapshotMode;
+}
+
+/*!
+ * How parse() of a file uses snapshots. tson::SnapshotMode::Disabled by default.
+ */
+tson::SnapshotMode tson::Tileson::getSnapshotMode() const
+{
+    return m_snapshotMode;
+}
+
+/*!
+ * Makes maps parsed afterwards skip the layers rejected by the filter, without reading their data or objects.
+ * The filter gets each layer with only its own fields read, so layers can be chosen by name, type, class, visibility etc.
+ * A rejected group layer is kept if any of its child layers are accepted. All child layers of an accepted group are kept.
+ *
+ * Example: t.setLayerFilter([](const tson::Layer &layer) { return layer.getType() == tson::LayerType::ObjectGroup; });
+ *
+ * NOTE: Snapshots (see setSnapshotMode()) are not read or written while a layer filter is set, as they hold every layer.
+ * @param layerFilter The filter. An empty filter keeps every layer.
+ */
+void tson::Tileson::setLayerFilter(tson::LayerFilter layerFilter)
+{
+    m_layerFilter = std::move(layerFilter);
+}
+
+/*!
+ * The layer filter. Empty if every layer is kept.
+ */
+const tson::LayerFilter &tson::Tileson::getLayerFilter() const
+{
+    return m_layerFilter;
+}
+
+/*!
+ * Makes maps parsed afterwards only read the fields and properties of their layers. The tile data, chunks and objects of a layer
+ * are read the first time something needs them (like Layer::getData() or Layer::getObjects()), or when Layer::load() or Map::loadLayers() is called.
+ * Map-wide object lookups like Map::getObj() load all layers.
+ * The map keeps its json until every layer is loaded. Linked files, like external templates, must also be readable until then.
+ * The map gets its own copy of the decompressors, and shares the template cache, so it does not depend on this parser.
+ * The project (see the constructor), which holds the classes and enums of properties, must outlive the map's lazy layers.
+ *
+ * NOTE: Loading changes the map, so a map with lazy layers must not be used from several threads until Map::loadLayers() has been called.
+ * @param lazyLayers true to defer reading the layers
+ */
+void tson::Tileson::setLazyLayers(bool lazyLayers)
+{
+    m_lazyLayers = lazyLayers;
+}
+
+/*!
+ * Whether maps are parsed with lazy layers. false by default.
+ */
+bool tson::Tileson::hasLazyLayers() const
+{
+    return m_lazyLayers;
+}
+
+/*!
+ * Makes maps parsed afterwards only decode the tiles inside a rectangle of each tile layer, like the part of a big map a server
+ * shard is responsible for. The other tiles are skipped without being stored:
+ * csv data skips the items outside the rectangle, uncompressed base64 data is decoded from the position of each row,
+ * and zlib/gzip data is decompressed as a stream where only the rows inside the rectangle are kept.
+ *
+ * The data of such layers only holds the region. See tson::Layer::hasRegion(). Infinite maps only read the chunks overlapping the rectangle.
+ * Snapshots (see setSnapshotMode()) are not read or written while a region is set, as they hold every tile.
+ * @param tileRegion The rectangle in tile units. An empty rectangle decodes every tile, which is the default.
+ */
+void tson::Tileson::setTileRegion(const tson::Rect &tileRegion)
+{
+    m_tileRegion = tileRegion;
+}
+
+/*!
+ * The rectangle of tiles that is decoded. Empty if every tile is decoded.
+ */
+const tson::Rect &tson::Tileson::getTileRegion() const
+{
+    return m_tileRegion;
+}
+
+/*!
+ * Parses a map on a background thread. See parseMany().
+ * @param path path to file
+ * @return The parsed map, once it is ready. Holds the exception if parsing threw one, like std::bad_alloc.
+ */
+std::future<std::unique_ptr<tson::Map>> tson::Tileson::parseAsync(const fs::path &path)
+{
+    return pushAsyncParseJob([path](tson::Tileson &parser) { return parser.parse(path); });
+}
+
+/*!
+ * Parses a map in a tson::Archive on a background thread. See parseMany().
+ * @param archive The archive. Must outlive the parsing of the map.
+ * @param path Path of the map in the archive
+ * @return The parsed map, once it is ready. Holds the exception if parsing threw one, like std::bad_alloc.
+ */
+std::future<std::unique_ptr<tson::Map>> tson::Tileson::parseAsync(const tson::Archive &archive, const fs::path &path)
+{
+    return pushAsyncParseJob([&archive, path](tson::Tileson &parser) { return parser.parse(archive, path); });
+}
+
+/*!
+ * Parses maps on background threads, like the maps of a tson::World or the files of a tson::ProjectFolder.
+ * The number of threads is set by setThreadCount(). Each thread has its own json backend (created by IJson::create())
+ * and its own copy of the decompressors (see DecompressorContainer::clone()), so the maps are parsed without sharing any parse state.
+ * The tileset cache, template cache and project are shared by all threads.
+ *
+ * The options of this parser (caches, decompressors, snapshot mode, layer filter, lazy layers, tile region) are copied when the maps are queued.
+ * A map that failed to parse has the status of the failure, like tson::ParseStatus::FileNotFound.
+ * @param paths The files to parse
+ * @return The parsed maps, once they are ready, in the order of the paths. A future holds the exception if parsing threw one.
+ */
+std::vector<std::future<std::unique_ptr<tson::Map>>> tson::Tileson::parseMany(const std::vector<fs::path> &paths)
+{
+    std::vector<std::future<std::unique_ptr<tson::Map>>> futures;
+    futures.reserve(paths.size());
+    for(const fs::path &path : paths)
+        futures.push_back(parseAsync(path));
+    return futures;
+}
+
+/*!
+ * Parses maps on background threads, like parseMany() without a callback, but gives each map to the callback as soon as it is parsed.
+ * Returns right away. Use waitForParses() to block until every map has been given to the callback.
+ * When parsing throws, the callback gets a map with tson::ParseStatus::ParseError and the message of the exception.
+ * @param paths The files to parse
+ * @param callback Gets the index of the path and the parsed map. Called from the background threads, so several calls can run at the same time.
+ * An exception thrown by the callback is rethrown by waitForParses().
+ */
+void tson::Tileson::parseMany(const std::vector<fs::path> &paths, ParseCallback callback)
+{
+    for(size_t i = 0; i < paths.size(); ++i)
+    {
+        pushParseJob([path = paths[i]](tson::Tileson &parser) { return parser.parse(path); },
+                     [i, callback](std::unique_ptr<tson::Map> map, std::exception_ptr error)
+        {
+            callback(i, (error != nullptr) ? CreateFailedMap(error) : std::move(map));
+        });
+    }
+}
+
+/*!
+ * Blocks until every map queued by parseAsync() or parseMany() has been parsed.
+ * Rethrows the first exception thrown by a parseMany() callback since the last call.
+ */
+void tson::Tileson::waitForParses()
+{
+    if(m_pool != nullptr)
+        m_pool->wait();
+}
+
+/*!
+ * Number of background threads used by parseAsync() and parseMany(). Default: 0, which is the number of hardware threads.
+ * Maps that are already queued are parsed before the threads are replaced.
+ * @param threadCount Number of threads. 0 uses the number of hardware threads.
+ */
+void tson::Tileson::setThreadCount(size_t threadCount)
+{
+    m_threadCount = threadCount;
+    m_pool.reset();
+}
+
+size_t tson::Tileson::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+/*!
+ * Queues the parsing of a map. The options of this parser are copied into the job, so they can be changed while it is queued.
+ * @param parse Parses the map with the parser of the background thread
+ * @param result Gets the parsed map, or the exception thrown while parsing it
+ */
+void tson::Tileson::pushParseJob(ParseFunction parse, ParseResult result)
+{
+    if(m_pool == nullptr)
+    {
+        std::vector<std::unique_ptr<tson::Tileson>> parsers;
+        for(size_t i = 0; i < tson::ParsePool::GetThreadCount(m_threadCount); ++i)
+            parsers.push_back(std::make_unique<tson::Tileson>(m_json->create(), false));
+        m_pool = std::make_unique<tson::ParsePool>(std::move(parsers));
+    }
+
+    //Decompressors added or removed since the last job are cloned again by the background parsers
+    if(m_poolDecompressors == nullptr || m_poolDecompressorsRevision != m_decompressors.getRevision())
+    {
+        m_poolDecompressors = std::make_shared<const tson::DecompressorContainer>(m_decompressors.clone());
+        m_poolDecompressorsRevision = m_decompressors.getRevision();
+    }
+
+    m_pool->push([parse = std::move(parse), result = std::move(result), decompressors = m_poolDecompressors, project = m_project, tilesetCache = m_tilesetCache,
+                  templateCache = m_templateCache, snapshotMode = m_snapshotMode, layerFilter = m_layerFilter,
+                  lazyLayers = m_lazyLayers, tileRegion = m_tileRegion](tson::Tileson &parser)
+    {
+        parser.m_project = project;
+        parser.m_tilesetCache = tilesetCache;
+        parser.m_templateCache = templateCache;
+        parser.m_snapshotMode = snapshotMode;
+        parser.m_layerFilter = layerFilter;
+        parser.m_lazyLayers = lazyLayers;
+        parser.m_tileRegion = tileRegion;
+
+        std::unique_ptr<tson::Map> map;
+        std::exception_ptr error;
+        try
+        {
+            if(parser.m_poolDecompressors != decompressors)
+            {
+                parser.m_decompressors = decompressors->clone();
+                parser.m_poolDecompressors = decompressors;
+            }
+            map = parse(parser);
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+        result(std::move(map), error);
+    });
+}
+
+/*!
+ * Queues the parsing of a map, and gives the result to the returned future
+ */
+std::future<std::unique_ptr<tson::Map>> tson::Tileson::pushAsyncParseJob(ParseFunction parse)
+{
+    auto promise = std::make_shared<std::promise<std::unique_ptr<tson::Map>>>();
+    std::future<std::unique_ptr<tson::Map>> future = promise->get_future();
+    pushParseJob(std::move(parse), [promise](std::unique_ptr<tson::Map> map, std::exception_ptr error)
+    {
+        if(error != nullptr)
+            promise->set_exception(error);
+        else
+            promise->set_value(std::move(map));
+    });
+    return future;
+}
+
+/*!
+ * A map with the status tson::ParseStatus::ParseError, for a map whose parsing threw an exception.
+ * Used by parseMany() and tson::World::loadMaps() to report the exception as a failed map.
+ * @param error The exception
+ * @return A map with the message of the exception as its status message
+ */
+std::unique_ptr<tson::Map> tson::Tileson::CreateFailedMap(const std::exception_ptr &error)
+{
+    try
+    {
+        std::rethrow_exception(error);
+    }
+    catch(const std::exception &e)
+    {
+        return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, std::string("Exception while parsing: ") + e.what());
+    }
+    catch(...)
+    {
+        return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Unknown exception while parsing");
+    }
+}
+
 #endif //TILESON_TILESON_PARSER_HPP
@@ -34,4 +34,121 @@ TEST_CASE( "Create simple animation with 3 frames. Expect right values after upd
     REQUIRE(a.getCurrentFrameNumber() == 0);
     REQUIRE(a.getCurrentFrame()->getTileId() == 1);
     REQUIRE((int)a.getTimeDelta() == 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE( "Animation - large time steps skip any number of frames", "[animation]" )
+{
+    tson::Animation a {{{100, 1}, {200, 2}, {100, 3}}};
+    REQUIRE(a.getTotalDuration() == 400);
+
+    a.update(350.f);
+    REQUIRE(a.getCurrentFrameNumber() == 2);
+    REQUIRE(tson::Tools::Equal(a.getTimeDelta(), 50.f));
+
+    //A hitch of 10 seconds and 125 ms from 350 ms ends up 75 ms into the first frame
+    a.update(10125.f);
+    REQUIRE(a.getCurrentFrameNumber() == 0);
+    REQUIRE(tson::Tools::Equal(a.getTimeDelta(), 75.f));
+
+    //Fractions of a millisecond are kept
+    a.update(25.5f);
+    REQUIRE(a.getCurrentFrameNumber() == 1);
+    REQUIRE(tson::Tools::Equal(a.getTimeDelta(), 0.5f));
+}
+
+TEST_CASE( "Animation - frame at any point in time", "[animation]" )
+{
+    tson::Animation a {{{100, 1}, {0, 2}, {200, 3}, {100, 4}}};
+    REQUIRE(a.frameAt(0.0) == 0);
+    REQUIRE(a.frameAt(99.0) == 0);
+    REQUIRE(a.frameAt(100.0) == 2); //Frames without duration are never shown
+    REQUIRE(a.frameAt(350.0) == 3);
+    REQUIRE(a.frameAt(400.0) == 0);
+    REQUIRE(a.frameAt(400.0 * 100000.0 + 120.0) == 2);
+    REQUIRE(a.getCurrentFrameNumber() == 0);
+
+    tson::Animation empty;
+    REQUIRE(empty.frameAt(100.0) == 0);
+    empty.update(100.f);
+    REQUIRE(empty.getCurrentFrame() == nullptr);
+}
+
+static const std::string ANIMATED_MAP_JSON = R"({
+    "width": 2, "height": 1, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 1,
+    "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map",
+    "tilesets": [
+        {"firstgid": 5, "name": "tiles", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+         "image": "tiles.png", "imagewidth": 32, "imageheight": 32,
+         "tiles": [{"id": 0, "animation": [{"tileid": 0, "duration": 100}, {"tileid": 1, "duration": 200}, {"tileid": 2, "duration": 100}]},
+                   {"id": 3, "animation": [{"tileid": 3, "duration": 50}, {"tileid": 1, "duration": 50}]}]}
+    ],
+    "layers": [
+        {"name": "tiles", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "width": 2, "height": 1, "data": [5, 8]}
+    ]
+})";
+
+TEST_CASE( "Animation clock - advance all animations of a map without changing the tiles", "[animation]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(ANIMATED_MAP_JSON.data(), ANIMATED_MAP_JSON.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::AnimationClock &clock = map->getAnimationClock();
+    REQUIRE(clock.size() == 2);
+    REQUIRE(clock.isAnimated(5));
+    REQUIRE(clock.isAnimated(8 | tson::FLIPPED_VERTICALLY_FLAG));
+    REQUIRE(!clock.isAnimated(6));
+    REQUIRE(!clock.isAnimated(1000));
+    REQUIRE(clock.getCurrentGid(5) == 5);
+    REQUIRE(clock.getCurrentGid(6) == 6);
+    REQUIRE(clock.getCurrentGid(1000) == 1000);
+
+    clock.update(99.f);
+    REQUIRE(clock.getCurrentGid(5) == 5);
+    REQUIRE(clock.getCurrentGid(8) == 6);
+
+    clock.update(6.f);
+    REQUIRE(clock.getCurrentGid(5) == 6);
+    REQUIRE(clock.getCurrentGids()[5] == 6);
+    REQUIRE(clock.getCurrentGid(5 | tson::FLIPPED_HORIZONTALLY_FLAG) == (6 | tson::FLIPPED_HORIZONTALLY_FLAG));
+
+    //Skips several frames and whole loops in one update
+    clock.update(4000.f + 200.f);
+    REQUIRE(clock.getCurrentGid(5) == 7);
+    REQUIRE(tson::Tools::Equal(static_cast<float>(clock.getTime()), 4305.f));
+
+    //Tiles are left untouched
+    REQUIRE(map->getTileMap().at(5)->getAnimation().getCurrentFrameNumber() == 0);
+
+    clock.reset();
+    REQUIRE(clock.getCurrentGid(5) == 5);
+    REQUIRE(clock.getTime() == 0.0);
+}
+
+TEST_CASE( "Animation clock - frame for any point in time", "[animation]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(ANIMATED_MAP_JSON.data(), ANIMATED_MAP_JSON.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    const tson::AnimationClock &clock = map->getAnimationClock();
+
+    REQUIRE(clock.getGidAt(5, 0.0) == 5);
+    REQUIRE(clock.getGidAt(5, 99.9) == 5);
+    REQUIRE(clock.getGidAt(5, 100.0) == 6);
+    REQUIRE(clock.getGidAt(5, 299.0) == 6);
+    REQUIRE(clock.getGidAt(5, 300.0) == 7);
+    REQUIRE(clock.getGidAt(5, 400.0) == 5);
+    REQUIRE(clock.getGidAt(5, 400.0 * 1000.0 + 150.0) == 6);
+    REQUIRE(clock.getGidAt(8 | tson::FLIPPED_DIAGONALLY_FLAG, 75.0) == (6 | tson::FLIPPED_DIAGONALLY_FLAG));
+    REQUIRE(clock.getGidAt(6, 150.0) == 6);
+
+    //Same result as updating the clock step by step
+    tson::AnimationClock stepped = clock;
+    for(int i = 1; i <= 100; ++i)
+    {
+        stepped.update(17.f);
+        REQUIRE(stepped.getCurrentGid(5) == clock.getGidAt(5, i * 17.0));
+        REQUIRE(stepped.getCurrentGid(8) == clock.getGidAt(8, i * 17.0));
+    }
+}
@@ -87,6 +87,343 @@ TEST_CASE( "Run benchmarks on all supported json-backends", "[json][benchmarks]"
 }
 #endif
 
+//Gason is left out, as it is unsupported and cannot parse this map
+TEST_CASE( "Run benchmarks on loading a map snapshot against all supported json-backends", "[json][snapshot][benchmarks]" )
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    constexpr int runs = 20;
+
+    auto measure = [&](const std::function<std::unique_ptr<tson::Map>()> &load)
+    {
+        std::unique_ptr<tson::Map> map;
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < runs; ++i)
+            map = load();
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> ms = (end - start) * 1000 / runs;
+        return std::make_pair(ms.count(), std::move(map));
+    };
+
+    tson::Tileson nlohmann{std::make_unique<tson::NlohmannJson>()};
+    tson::Tileson picojson{std::make_unique<tson::PicoJson>()};
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+
+    auto [msNlohmann, nlohmannMap] = measure([&]() { return nlohmann.parse(pathToUse); });
+    auto [msPicoJson, picojsonMap] = measure([&]() { return picojson.parse(pathToUse); });
+    auto [msJ11, j11Map] = measure([&]() { return j11.parse(pathToUse); });
+
+    fs::path snapshotPath = fs::temp_directory_path() / "tileson_benchmark.tsonb";
+    REQUIRE(tson::MapSnapshot::Save(*j11Map, snapshotPath));
+    std::vector<uint8_t> snapshot = tson::MapSnapshot::Serialize(*j11Map);
+
+    auto [msSnapshotFile, snapshotFileMap] = measure([&]() { return tson::MapSnapshot::Load(snapshotPath, nullptr, j11.decompressors()); });
+    auto [msSnapshotMemory, snapshotMemoryMap] = measure([&]() { return tson::MapSnapshot::Deserialize(snapshot.data(), snapshot.size(), nullptr, j11.decompressors()); });
+
+    std::cout << "Nlohmann parse time:             " << msNlohmann << " ms\n";
+    std::cout << "PicoJson parse time:             " << msPicoJson << " ms\n";
+    std::cout << "Json11 parse time:               " << msJ11 << " ms\n";
+    std::cout << "Snapshot load time:              " << msSnapshotFile << " ms (" << snapshot.size() << " bytes)\n";
+    std::cout << "Snapshot memory load time:       " << msSnapshotMemory << " ms\n";
+
+    REQUIRE(nlohmannMap->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(picojsonMap->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(j11Map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(snapshotFileMap->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(snapshotMemoryMap->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(snapshotMemoryMap->getTileMap().size() == j11Map->getTileMap().size());
+    fs::remove(snapshotPath);
+}
+
+TEST_CASE( "Run benchmarks on opening a mapped flat map against parsing its json", "[json][flatmap][benchmarks]" )
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    fs::path flatPath = fs::temp_directory_path() / "tileson_benchmark.tsonf";
+    constexpr int runs = 20;
+
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+    std::unique_ptr<tson::Map> map;
+    auto startParse = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        map = j11.parse(pathToUse);
+    std::chrono::duration<double> msParse = (std::chrono::steady_clock::now() - startParse) * 1000 / runs;
+    REQUIRE(tson::FlatMap::Save(*map, flatPath));
+
+    //Opening maps the file and reads every gid, which is what a parsed map has ready
+    uint64_t sum = 0;
+    auto startOpen = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+    {
+        tson::MappedFile file {flatPath};
+        tson::MapView view {file.data(), file.size()};
+        for(tson::LayerView layer : view.getLayers())
+        {
+            for(size_t gid = 0; gid < layer.getDataSize(); ++gid)
+                sum += layer.getGid(gid);
+        }
+    }
+    std::chrono::duration<double> msOpen = (std::chrono::steady_clock::now() - startOpen) * 1000 / runs;
+
+    uint64_t expected = 0;
+    for(auto &layer : map->getLayers())
+    {
+        for(uint32_t gid : layer.getData())
+            expected += gid;
+    }
+
+    std::cout << "Json11 parse time:               " << msParse.count() << " ms\n";
+    std::cout << "Flat map open + gid walk time:   " << msOpen.count() << " ms (" << fs::file_size(flatPath) << " bytes)\n";
+    REQUIRE(sum == expected * runs);
+    fs::remove(flatPath);
+}
+
+TEST_CASE( "Run benchmarks on parsing tmx maps against their json", "[tmx][benchmarks]" )
+{
+    constexpr int runs = 20;
+    tson::Tileson tmx{std::make_unique<tson::TmxJson>()};
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+
+    for(const char *name : {"ultimate_test", "simple_map", "infinite"})
+    {
+        fs::path tmxPath = GetPathWithBase(fs::path("test-maps") / (std::string(name) + ".tmx"));
+        fs::path jsonPath = GetPathWithBase(fs::path("test-maps") / (std::string(name) + ".json"));
+
+        std::unique_ptr<tson::Map> tmxMap;
+        auto startTmx = std::chrono::steady_clock::now();
+        for(int i = 0; i < runs; ++i)
+            tmxMap = tmx.parse(tmxPath);
+        std::chrono::duration<double> msTmx = (std::chrono::steady_clock::now() - startTmx) * 1000 / runs;
+
+        std::unique_ptr<tson::Map> jsonMap;
+        auto startJson = std::chrono::steady_clock::now();
+        for(int i = 0; i < runs; ++i)
+            jsonMap = j11.parse(jsonPath);
+        std::chrono::duration<double> msJson = (std::chrono::steady_clock::now() - startJson) * 1000 / runs;
+
+        std::cout << name << " tmx parse time:    " << msTmx.count() << " ms\n";
+        std::cout << name << " Json11 parse time: " << msJson.count() << " ms\n";
+        REQUIRE(tmxMap->getStatus() == tson::ParseStatus::OK);
+        REQUIRE(jsonMap->getStatus() == tson::ParseStatus::OK);
+    }
+}
+
+TEST_CASE( "Run benchmarks on parsing CBOR and MessagePack maps against their json", "[json][binary][benchmarks]" )
+{
+    constexpr int runs = 20;
+    fs::path folder = fs::temp_directory_path() / "tileson_binary_benchmark";
+    fs::create_directories(folder);
+
+    std::vector<std::pair<std::string, std::unique_ptr<tson::Tileson>>> parsers;
+    parsers.emplace_back("Json11", std::make_unique<tson::Tileson>(std::make_unique<tson::Json11>()));
+    parsers.emplace_back("Nlohmann", std::make_unique<tson::Tileson>(std::make_unique<tson::NlohmannJson>()));
+    parsers.emplace_back("CBOR", std::make_unique<tson::Tileson>(std::make_unique<tson::CborJson>()));
+    parsers.emplace_back("MessagePack", std::make_unique<tson::Tileson>(std::make_unique<tson::MessagePackJson>()));
+
+    for(const char *name : {"ultimate_test", "simple_map", "infinite"})
+    {
+        fs::path jsonPath = GetPathWithBase(fs::path("test-maps") / (std::string(name) + ".json"));
+        fs::path cborPath = folder / (std::string(name) + ".cbor");
+        fs::path msgpackPath = folder / (std::string(name) + ".msgpack");
+        REQUIRE(tson::BinaryJson::ConvertJson(jsonPath, cborPath, tson::BinaryJson::Format::Cbor));
+        REQUIRE(tson::BinaryJson::ConvertJson(jsonPath, msgpackPath, tson::BinaryJson::Format::MessagePack));
+
+        for(auto &[parserName, parser] : parsers)
+        {
+            fs::path const &path = (parserName == "CBOR") ? cborPath : (parserName == "MessagePack") ? msgpackPath : jsonPath;
+            std::unique_ptr<tson::Map> map;
+            auto start = std::chrono::steady_clock::now();
+            for(int i = 0; i < runs; ++i)
+                map = parser->parse(path);
+            std::chrono::duration<double> ms = (std::chrono::steady_clock::now() - start) * 1000 / runs;
+
+            std::cout << name << " " << parserName << " parse time: " << ms.count() << " ms (" << fs::file_size(path) << " bytes)\n";
+            REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+        }
+    }
+    fs::remove_all(folder);
+}
+
+TEST_CASE( "Run benchmarks on probing maps against parsing them", "[probe][benchmarks]" )
+{
+    constexpr int runs = 20;
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+    tson::MapProbe probe;
+
+    auto startParse = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(j11.parse(pathToUse)->getStatus() == tson::ParseStatus::OK);
+    std::chrono::duration<double> msParse = (std::chrono::steady_clock::now() - startParse) * 1000 / runs;
+
+    auto startProbe = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(probe.probe(pathToUse).isMap());
+    std::chrono::duration<double> msProbe = (std::chrono::steady_clock::now() - startProbe) * 1000 / runs;
+
+    auto startDirectory = std::chrono::steady_clock::now();
+    std::vector<tson::MapInfo> infos = probe.probeDirectory(GetPathWithBase(fs::path("test-maps")));
+    std::chrono::duration<double> msDirectory = (std::chrono::steady_clock::now() - startDirectory) * 1000;
+
+    std::cout << "Json11 parse time:               " << msParse.count() << " ms\n";
+    std::cout << "Probe time:                      " << msProbe.count() << " ms\n";
+    std::cout << "Probe directory time:            " << msDirectory.count() << " ms (" << infos.size() << " maps)\n";
+}
+
+TEST_CASE( "Run benchmarks on parsing maps with lazy layers and a layer filter", "[lazy][benchmarks]" )
+{
+    constexpr int runs = 20;
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+
+    auto startEager = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(j11.parse(pathToUse)->getStatus() == tson::ParseStatus::OK);
+    std::chrono::duration<double> msEager = (std::chrono::steady_clock::now() - startEager) * 1000 / runs;
+
+    j11.setLazyLayers(true);
+    auto startLazy = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(j11.parse(pathToUse)->getStatus() == tson::ParseStatus::OK);
+    std::chrono::duration<double> msLazy = (std::chrono::steady_clock::now() - startLazy) * 1000 / runs;
+
+    auto startOneLayer = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(!j11.parse(pathToUse)->getLayer("Main Layer")->getData().empty());
+    std::chrono::duration<double> msOneLayer = (std::chrono::steady_clock::now() - startOneLayer) * 1000 / runs;
+
+    j11.setLazyLayers(false);
+    j11.setLayerFilter([](const tson::Layer &layer) { return layer.getType() == tson::LayerType::ObjectGroup; });
+    auto startFiltered = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(j11.parse(pathToUse)->getLayers().size() == 1);
+    std::chrono::duration<double> msFiltered = (std::chrono::steady_clock::now() - startFiltered) * 1000 / runs;
+
+    std::cout << "Json11 parse time:               " << msEager.count() << " ms\n";
+    std::cout << "Json11 lazy parse time:          " << msLazy.count() << " ms\n";
+    std::cout << "Json11 lazy parse + 1 layer:     " << msOneLayer.count() << " ms\n";
+    std::cout << "Json11 object layers only:       " << msFiltered.count() << " ms\n";
+}
+
+TEST_CASE( "Run benchmarks on decoding a region of large tile layers against the full layers", "[region][benchmarks]" )
+{
+    constexpr int runs = 20;
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/region/large.json"));
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+    j11.decompressors()->add<tson::ZlibDecompressor>();
+    j11.decompressors()->add<tson::GzipDecompressor>();
+
+    auto startFull = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(j11.parse(pathToUse)->getLayer("Zlib")->getData().size() == 256 * 160);
+    std::chrono::duration<double> msFull = (std::chrono::steady_clock::now() - startFull) * 1000 / runs;
+
+    j11.setTileRegion({64, 8, 32, 18});
+    auto startRegion = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i)
+        REQUIRE(j11.parse(pathToUse)->getLayer("Zlib")->getData().size() == 32 * 18);
+    std::chrono::duration<double> msRegion = (std::chrono::steady_clock::now() - startRegion) * 1000 / runs;
+
+    std::cout << "Json11 full layers (256x160):    " << msFull.count() << " ms\n";
+    std::cout << "Json11 region (32x18):           " << msRegion.count() << " ms\n";
+}
+
+TEST_CASE( "Run benchmarks on parsing many maps on background threads against one by one", "[parse][async][benchmarks]" )
+{
+    std::vector<fs::path> const paths(64, GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+
+    auto startSequential = std::chrono::steady_clock::now();
+    for(const fs::path &path : paths)
+        REQUIRE(j11.parse(path)->getStatus() == tson::ParseStatus::OK);
+    std::chrono::duration<double> msSequential = (std::chrono::steady_clock::now() - startSequential) * 1000;
+
+    auto startParallel = std::chrono::steady_clock::now();
+    for(auto &future : j11.parseMany(paths))
+        REQUIRE(future.get()->getStatus() == tson::ParseStatus::OK);
+    std::chrono::duration<double> msParallel = (std::chrono::steady_clock::now() - startParallel) * 1000;
+
+    std::cout << "Json11 64 maps one by one:       " << msSequential.count() << " ms\n";
+    std::cout << "Json11 64 maps parseMany:        " << msParallel.count() << " ms (" << std::thread::hardware_concurrency() << " threads)\n";
+}
+
+TEST_CASE( "Run benchmarks on loading the maps of a world on one thread against all threads", "[world][async][benchmarks]" )
+{
+    //A world of 64 maps
+    fs::path const mapPath = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    fs::path const worldPath = fs::temp_directory_path() / "tileson_benchmark.world";
+    {
+        std::ofstream file(worldPath);
+        file << R"({"type": "world", "maps": [)";
+        for(int i = 0; i < 64; ++i)
+            file << ((i > 0) ? ", " : "") << R"({"fileName": ")" << mapPath.generic_string() << R"(", "x": )" << i * 512 << R"(, "y": 0, "width": 512, "height": 512})";
+        file << "]}";
+    }
+    tson::World world {worldPath};
+    tson::Tileson j11{std::make_unique<tson::Json11>()};
+
+    j11.setThreadCount(1);
+    auto startOne = std::chrono::steady_clock::now();
+    REQUIRE(world.loadMaps(&j11) == 64);
+    std::chrono::duration<double> msOne = (std::chrono::steady_clock::now() - startOne) * 1000;
+
+    j11.setThreadCount(0);
+    auto startAll = std::chrono::steady_clock::now();
+    REQUIRE(world.loadMaps(&j11) == 64);
+    std::chrono::duration<double> msAll = (std::chrono::steady_clock::now() - startAll) * 1000;
+
+    std::cout << "World 64 maps, 1 thread:         " << msOne.count() << " ms\n";
+    std::cout << "World 64 maps, all threads:      " << msAll.count() << " ms (" << std::thread::hardware_concurrency() << " threads)\n";
+    fs::remove(worldPath);
+}
+
+TEST_CASE( "Run benchmarks on updating 100 000 animated tiles", "[animation][benchmarks]" )
+{
+    constexpr size_t count = 100000;
+    std::vector<tson::Animation> animations;
+    animations.reserve(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        std::vector<tson::Frame> frames;
+        size_t const frameCount = 2 + i % 15;
+        for(size_t f = 0; f < frameCount; ++f)
+            frames.emplace_back(static_cast<int>(50 + (i + f * 37) % 200), static_cast<uint32_t>(f + 1));
+        animations.emplace_back(frames);
+    }
+
+    //60 frames of normal updates
+    auto startUpdate = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < 60; ++frame)
+    {
+        for(auto &animation : animations)
+            animation.update(16.6f);
+    }
+    auto endUpdate = std::chrono::steady_clock::now();
+    std::chrono::duration<double> msUpdate = (endUpdate - startUpdate) * 1000;
+
+    //A single hitch of one hour, which used to need a call per frame to catch up
+    auto startHitch = std::chrono::steady_clock::now();
+    for(auto &animation : animations)
+        animation.update(3600000.f);
+    auto endHitch = std::chrono::steady_clock::now();
+    std::chrono::duration<double> msHitch = (endHitch - startHitch) * 1000;
+
+    auto startFrameAt = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for(size_t i = 0; i < count; ++i)
+        sum += animations[i].frameAt(static_cast<double>(i) * 1234.5);
+    auto endFrameAt = std::chrono::steady_clock::now();
+    std::chrono::duration<double> msFrameAt = (endFrameAt - startFrameAt) * 1000;
+
+    std::cout << "Animation update x60 (100k tiles):   " << msUpdate.count() << " ms\n";
+    std::cout << "Animation update 1h hitch (100k):    " << msHitch.count() << " ms\n";
+    std::cout << "Animation frameAt (100k tiles):      " << msFrameAt.count() << " ms\n";
+
+    //The state after the hitch must match the frame for the same point in time
+    double const elapsed = 60.0 * 16.6 + 3600000.0;
+    for(size_t i = 0; i < count; i += 997)
+        REQUIRE(animations[i].getCurrentFrameNumber() == animations[i].frameAt(elapsed));
+    REQUIRE(sum > 0);
+}
+
 //
 // Removed due to Gason being unsupported and thus unknown errors during parsing are expected
 //
@@ -0,0 +1,235 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+/*!
+ * Converts json files from the test maps into a temporary folder, keeping their names, so references between them still work
+ */
+static fs::path ConvertTestFiles(const std::vector<std::string> &files, tson::BinaryJson::Format format)
+{
+    fs::path folder = fs::temp_directory_path() / ((format == tson::BinaryJson::Format::Cbor) ? "tileson_cbor" : "tileson_msgpack");
+    fs::create_directories(folder);
+    for(const std::string &file : files)
+        REQUIRE(tson::BinaryJson::ConvertJson(GetPathWithBase(fs::path("test-maps") / file), folder / file, format));
+    return folder;
+}
+
+static std::unique_ptr<tson::IJson> MakeBinaryJson(tson::BinaryJson::Format format)
+{
+    if(format == tson::BinaryJson::Format::Cbor)
+        return std::make_unique<tson::CborJson>();
+    return std::make_unique<tson::MessagePackJson>();
+}
+
+static void CheckSameObjects(std::vector<tson::Object> &a, std::vector<tson::Object> &b)
+{
+    REQUIRE(a.size() == b.size());
+    for(size_t i = 0; i < b.size(); ++i)
+    {
+        REQUIRE(a[i].getId() == b[i].getId());
+        REQUIRE(a[i].getName() == b[i].getName());
+        REQUIRE(a[i].getType() == b[i].getType());
+        REQUIRE(a[i].getObjectType() == b[i].getObjectType());
+        REQUIRE(a[i].getGid() == b[i].getGid());
+        REQUIRE(a[i].getPosition() == b[i].getPosition());
+        REQUIRE(a[i].getSize() == b[i].getSize());
+        REQUIRE(a[i].getRotation() == b[i].getRotation());
+        REQUIRE(a[i].isVisible() == b[i].isVisible());
+        REQUIRE(a[i].getPolygons() == b[i].getPolygons());
+        REQUIRE(a[i].getText().text == b[i].getText().text);
+        REQUIRE(a[i].getProperties().getSize() == b[i].getProperties().getSize());
+    }
+}
+
+static void CheckSameMap(tson::Map &binary, tson::Map &json)
+{
+    REQUIRE(binary.getStatus() == tson::ParseStatus::OK);
+    REQUIRE(binary.getSize() == json.getSize());
+    REQUIRE(binary.getTileSize() == json.getTileSize());
+    REQUIRE(binary.getBackgroundColor() == json.getBackgroundColor());
+    REQUIRE(binary.getProperties().getSize() == json.getProperties().getSize());
+
+    REQUIRE(binary.getTilesets().size() == json.getTilesets().size());
+    for(size_t i = 0; i < json.getTilesets().size(); ++i)
+    {
+        tson::Tileset &a = binary.getTilesets()[i];
+        tson::Tileset &b = json.getTilesets()[i];
+        REQUIRE(a.getName() == b.getName());
+        REQUIRE(a.getFirstgid() == b.getFirstgid());
+        REQUIRE(a.getImage() == b.getImage());
+        REQUIRE(a.getTiles().size() == b.getTiles().size());
+        REQUIRE(a.getWangsets().size() == b.getWangsets().size());
+        for(size_t tile = 0; tile < b.getTiles().size(); ++tile)
+        {
+            REQUIRE(a.getTiles()[tile].getAnimation().size() == b.getTiles()[tile].getAnimation().size());
+            REQUIRE(a.getTiles()[tile].getProperties().getSize() == b.getTiles()[tile].getProperties().getSize());
+        }
+    }
+
+    REQUIRE(binary.getLayers().size() == json.getLayers().size());
+    for(size_t i = 0; i < json.getLayers().size(); ++i)
+    {
+        tson::Layer &a = binary.getLayers()[i];
+        tson::Layer &b = json.getLayers()[i];
+        REQUIRE(a.getName() == b.getName());
+        REQUIRE(a.getType() == b.getType());
+        REQUIRE(a.getOpacity() == b.getOpacity());
+        REQUIRE(a.getOffset() == b.getOffset());
+        REQUIRE(a.getData() == b.getData());
+        REQUIRE(a.getBase64Data() == b.getBase64Data());
+        REQUIRE(a.getChunks().size() == b.getChunks().size());
+        for(size_t chunk = 0; chunk < b.getChunks().size(); ++chunk)
+            REQUIRE(a.getChunks()[chunk].getData() == b.getChunks()[chunk].getData());
+        CheckSameObjects(a.getObjects(), b.getObjects());
+        REQUIRE(a.getProperties().getSize() == b.getProperties().getSize());
+    }
+}
+
+TEST_CASE( "Parse maps converted to CBOR and MessagePack - expects the same maps as the json", "[binary][parse]" )
+{
+    tson::BinaryJson::Format format = GENERATE(tson::BinaryJson::Format::Cbor, tson::BinaryJson::Format::MessagePack);
+    tson::Tileson j11 {std::make_unique<tson::Json11>()};
+    tson::Tileson binary {MakeBinaryJson(format)};
+
+    SECTION("Maps with embedded tilesets, tile layer data and chunks")
+    {
+        std::vector<std::string> const files {"ultimate_test.json", "ultimate_test_base64.json", "simple_map.json", "infinite.json"};
+        fs::path folder = ConvertTestFiles(files, format);
+        for(const std::string &file : files)
+        {
+            std::unique_ptr<tson::Map> json = j11.parse(GetPathWithBase(fs::path("test-maps") / file));
+            std::unique_ptr<tson::Map> map = binary.parse(folder / file);
+            CheckSameMap(*map, *json);
+        }
+
+        std::unique_ptr<tson::Map> map = binary.parse(folder / "ultimate_test.json");
+        std::unique_ptr<tson::Map> json = j11.parse(GetPathWithBase("test-maps/ultimate_test.json"));
+        tson::Tile *tile = map->getTileset("demo-tileset")->getTile(31);
+        tson::Tile *jsonTile = json->getTileset("demo-tileset")->getTile(31);
+        REQUIRE(tile->get<tson::Colori>("color") == jsonTile->get<tson::Colori>("color"));
+        REQUIRE(tile->get<int>("hp") == jsonTile->get<int>("hp"));
+        REQUIRE(tile->get<bool>("is_player"));
+        REQUIRE(tile->get<float>("jump_force") == jsonTile->get<float>("jump_force"));
+        REQUIRE(tile->get<std::string>("name") == jsonTile->get<std::string>("name"));
+        REQUIRE(map->getLayer("Main Layer")->getTileData().size() == json->getLayer("Main Layer")->getTileData().size());
+    }
+
+    SECTION("Maps with external tilesets and templates")
+    {
+        fs::path folder = ConvertTestFiles({"ultimate_test_v1.5.json", "demo-tileset.json", "withtemplates.json", "template1.json", "template2.json", "template3.json"}, format);
+        for(const char *file : {"ultimate_test_v1.5.json", "withtemplates.json"})
+        {
+            std::unique_ptr<tson::Map> json = j11.parse(GetPathWithBase(fs::path("test-maps") / file));
+            std::unique_ptr<tson::Map> map = binary.parse(folder / file);
+            CheckSameMap(*map, *json);
+        }
+    }
+
+    SECTION("Parse from memory")
+    {
+        fs::path folder = ConvertTestFiles({"simple_map.json"}, format);
+        std::ifstream file(folder / "simple_map.json", std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::unique_ptr<tson::Map> map = binary.parse(data.data(), data.size());
+        std::unique_ptr<tson::Map> json = j11.parse(GetPathWithBase("test-maps/simple_map.json"));
+        CheckSameMap(*map, *json);
+    }
+}
+
+TEST_CASE( "Convert json to CBOR and MessagePack - expects tile data as typed arrays", "[binary][convert]" )
+{
+    std::string error;
+    json11::Json const json = json11::Json::parse(R"({"data":[1,2,3000000000],"list":[1,2],"x":-1,"f":0.5,"d":0.1,"s":"tile"})", error);
+    REQUIRE(error.empty());
+
+    std::vector<uint8_t> const cbor = tson::BinaryJson::FromJson(json, tson::BinaryJson::Format::Cbor);
+    //Map of 6 items, then "d" : 0.1 as a double
+    REQUIRE(cbor[0] == 0xa6);
+    REQUIRE(cbor[1] == 0x61);
+    REQUIRE(cbor[2] == 'd');
+    REQUIRE(cbor[3] == 0xfb);
+    //"data" : Tag 70 with 12 bytes
+    std::vector<uint8_t> const tag {0x64, 'd', 'a', 't', 'a', 0xd8, 70, 0x4c, 1, 0, 0, 0};
+    REQUIRE(std::search(cbor.begin(), cbor.end(), tag.begin(), tag.end()) != cbor.end());
+
+    std::vector<uint8_t> const msgpack = tson::BinaryJson::FromJson(json, tson::BinaryJson::Format::MessagePack);
+    std::vector<uint8_t> const ext {0xa4, 'd', 'a', 't', 'a', 0xc7, 12, static_cast<uint8_t>(tson::BinaryJson::MessagePackUInt32Array), 1, 0, 0, 0};
+    REQUIRE(msgpack[0] == 0x86);
+    REQUIRE(std::search(msgpack.begin(), msgpack.end(), ext.begin(), ext.end()) != msgpack.end());
+
+    for(tson::BinaryJson::Format format : {tson::BinaryJson::Format::Cbor, tson::BinaryJson::Format::MessagePack})
+    {
+        const std::vector<uint8_t> &data = (format == tson::BinaryJson::Format::Cbor) ? cbor : msgpack;
+        tson::BinaryJson reader {format};
+        REQUIRE(reader.parse(data.data(), data.size()));
+
+        std::vector<uint32_t> gids;
+        REQUIRE(reader.readArray("data", gids));
+        REQUIRE(gids == std::vector<uint32_t>{1, 2, 3000000000});
+        REQUIRE(reader["data"].isArray());
+        REQUIRE(reader["data"].size() == 3);
+        REQUIRE(reader["data"].at(2).get<uint32_t>() == 3000000000);
+        REQUIRE(reader["list"].at(1).get<int>() == 2);
+        REQUIRE(reader.get<int>("x") == -1);
+        REQUIRE(reader.get<float>("f") == 0.5f);
+        REQUIRE(reader.get<double>("d") == 0.1);
+        REQUIRE(reader.get<std::string>("s") == "tile");
+        REQUIRE(reader.count("missing") == 0);
+        REQUIRE(reader["missing"].isNull());
+    }
+}
+
+TEST_CASE( "Parse hand-written CBOR - expects indefinite lengths, half floats and big endian typed arrays", "[binary][parse]" )
+{
+    //{_ "a": [_ 1, -2], "h": 1.5 (half float), "t": 66(h'00000001 80000002'), "n": null}
+    std::vector<uint8_t> const data {0xbf, 0x61, 'a', 0x9f, 0x01, 0x21, 0xff, 0x61, 'h', 0xf9, 0x3e, 0x00,
+                                     0x61, 't', 0xd8, 66, 0x48, 0, 0, 0, 1, 0x80, 0, 0, 2, 0x61, 'n', 0xf6, 0xff};
+    tson::CborJson cbor;
+    REQUIRE(cbor.parse(data.data(), data.size()));
+    REQUIRE(cbor["a"].size() == 2);
+    REQUIRE(cbor["a"].at(1).get<int>() == -2);
+    REQUIRE(cbor.get<float>("h") == 1.5f);
+    REQUIRE(cbor["n"].isNull());
+
+    std::vector<uint32_t> gids;
+    REQUIRE(cbor.readArray("t", gids));
+    REQUIRE(gids == std::vector<uint32_t>{1, 0x80000002});
+}
+
+TEST_CASE( "Parse broken CBOR and MessagePack - expects a parse error", "[binary][parse]" )
+{
+    tson::Tileson cbor {std::make_unique<tson::CborJson>()};
+    tson::Tileson msgpack {std::make_unique<tson::MessagePackJson>()};
+
+    //Truncated: A map of one item, with only the key
+    std::vector<uint8_t> const truncatedCbor {0xa1, 0x61, 'a'};
+    std::vector<uint8_t> const truncatedMsgpack {0x81, 0xa1, 'a'};
+    REQUIRE(cbor.parse(truncatedCbor.data(), truncatedCbor.size())->getStatus() == tson::ParseStatus::ParseError);
+    REQUIRE(msgpack.parse(truncatedMsgpack.data(), truncatedMsgpack.size())->getStatus() == tson::ParseStatus::ParseError);
+
+    //A string length far beyond the data
+    std::vector<uint8_t> const hugeString {0xa1, 0x7b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    REQUIRE(cbor.parse(hugeString.data(), hugeString.size())->getStatus() == tson::ParseStatus::ParseError);
+
+    //Not an object
+    std::vector<uint8_t> const number {0x01};
+    REQUIRE(cbor.parse(number.data(), number.size())->getStatus() == tson::ParseStatus::ParseError);
+    REQUIRE(msgpack.parse(number.data(), number.size())->getStatus() == tson::ParseStatus::ParseError);
+
+    //Deeply nested arrays
+    std::vector<uint8_t> nestedCbor(100000, 0x81);
+    std::vector<uint8_t> nestedMsgpack(100000, 0x91);
+    nestedCbor[0] = 0xa1;
+    nestedCbor[1] = 0x60;
+    nestedMsgpack[0] = 0x81;
+    nestedMsgpack[1] = 0xa0;
+    REQUIRE(cbor.parse(nestedCbor.data(), nestedCbor.size())->getStatus() == tson::ParseStatus::ParseError);
+    REQUIRE(msgpack.parse(nestedMsgpack.data(), nestedMsgpack.size())->getStatus() == tson::ParseStatus::ParseError);
+}
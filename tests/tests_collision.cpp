@@ -0,0 +1,155 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+#include <sstream>
+
+static std::string CreateCollisionMapJson(int width, int height, const std::vector<int> &data, const std::string &layerExtras = "")
+{
+    std::stringstream json;
+    json << R"({"width": )" << width << R"(, "height": )" << height << R"(, "tilewidth": 16, "tileheight": 16, "infinite": false,
+        "nextobjectid": 1, "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map",
+        "tilesets": [{"firstgid": 1, "name": "tiles", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+            "image": "tiles.png", "imagewidth": 32, "imageheight": 32,
+            "tiles": [{"id": 1, "properties": [{"name": "solid", "type": "bool", "value": true}]},
+                      {"id": 2, "properties": [{"name": "solid", "type": "bool", "value": false}],
+                       "objectgroup": {"name": "", "type": "objectgroup", "opacity": 1, "visible": true, "x": 0, "y": 0, "draworder": "index",
+                         "objects": [{"id": 1, "name": "", "type": "", "x": 0, "y": 0, "width": 16, "height": 16, "rotation": 0, "visible": true}]}},
+                      {"id": 3,
+                       "objectgroup": {"name": "", "type": "objectgroup", "opacity": 1, "visible": true, "x": 0, "y": 0, "draworder": "index",
+                         "objects": [{"id": 1, "name": "", "type": "", "x": 2, "y": 4, "width": 0, "height": 0, "rotation": 0, "visible": true,
+                                      "polygon": [{"x": 0, "y": 0}, {"x": 6, "y": 0}, {"x": 0, "y": 10}]}]}}]}],
+        "layers": [{"name": "collision", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0)" << layerExtras << R"(,
+            "width": )" << width << R"(, "height": )" << height << R"(, "data": [)";
+    for(size_t i = 0; i < data.size(); ++i)
+        json << ((i > 0) ? "," : "") << data[i];
+    json << "]}]}";
+    return json.str();
+}
+
+/*!
+ * Every solid tile must be covered by exactly one rect, and nothing else may be covered
+ */
+static bool CoversExactly(const std::vector<tson::Rect> &rects, const std::vector<int> &data, int width, const std::set<int> &solid)
+{
+    std::vector<int> covered(data.size(), 0);
+    for(const auto &rect : rects)
+    {
+        for(int y = rect.y; y < rect.y + rect.height; ++y)
+            for(int x = rect.x; x < rect.x + rect.width; ++x)
+                ++covered[static_cast<size_t>(y * width + x)];
+    }
+    for(size_t i = 0; i < data.size(); ++i)
+    {
+        if(covered[i] != (solid.count(data[i]) > 0 ? 1 : 0))
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE( "Collision - greedy meshing of solid tiles by gid and by property", "[collision]" )
+{
+    std::vector<int> data = {
+        1, 1, 1, 0, 2, 2,
+        1, 1, 1, 0, 2, 2,
+        0, 3, 0, 0, 2, 0,
+        1, 1, 0, 4, 0, 0
+    };
+    std::string json = CreateCollisionMapJson(6, 4, data);
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("collision");
+
+    tson::CollisionBuilder byGid {std::set<uint32_t>{1}};
+    byGid.setMergeFullTileShapes(false);
+    const std::vector<tson::Rect> &rects = byGid.buildRects(*layer);
+    REQUIRE(rects.size() == 2);
+    REQUIRE(rects[0] == tson::Rect(0, 0, 3, 2));
+    REQUIRE(rects[1] == tson::Rect(0, 3, 2, 1));
+
+    //gid 2 has solid = true, gid 3 has solid = false, but a full tile rectangle in its objectgroup
+    tson::CollisionBuilder byProperty {std::string("solid")};
+    byProperty.setMergeFullTileShapes(false);
+    REQUIRE(CoversExactly(byProperty.buildRects(*layer), data, 6, {2}));
+    REQUIRE(byProperty.getRects().size() == 2);
+
+    byProperty.setMergeFullTileShapes(true);
+    REQUIRE(CoversExactly(byProperty.buildRects(*layer), data, 6, {2, 3}));
+    REQUIRE(byProperty.getRects().size() == 3);
+}
+
+TEST_CASE( "Collision - bands give the same result with any number of threads", "[collision]" )
+{
+    int const width = 50;
+    int const height = tson::CollisionBuilder::BandRows * 3 + 7;
+    std::vector<int> data(static_cast<size_t>(width * height), 0);
+    uint32_t random = 12345;
+    for(auto &gid : data)
+    {
+        random = random * 1103515245u + 12345u;
+        gid = ((random >> 16) % 5 == 0) ? 0 : 1;
+    }
+    //A solid column crossing all bands must become a single rect
+    for(int y = 0; y < height; ++y)
+    {
+        data[static_cast<size_t>(y * width + 20)] = 1;
+        data[static_cast<size_t>(y * width + 19)] = 0;
+        data[static_cast<size_t>(y * width + 21)] = 0;
+    }
+
+    std::string json = CreateCollisionMapJson(width, height, data);
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("collision");
+
+    tson::CollisionBuilder single {std::set<uint32_t>{1}};
+    single.setThreadCount(1);
+    std::vector<tson::Rect> expected = single.buildRects(*layer);
+    REQUIRE(CoversExactly(expected, data, width, {1}));
+    REQUIRE(expected.size() < data.size() / 2);
+    REQUIRE(std::count(expected.begin(), expected.end(), tson::Rect(20, 0, 1, height)) == 1);
+
+    tson::CollisionBuilder parallel {std::set<uint32_t>{1}};
+    parallel.setThreadCount(4);
+    REQUIRE(parallel.buildRects(*layer) == expected);
+}
+
+TEST_CASE( "Collision - objectgroup shapes of tiles are flipped and placed in the world", "[collision]" )
+{
+    std::vector<int> data = {4, 0, static_cast<int>(4u | tson::FLIPPED_HORIZONTALLY_FLAG), static_cast<int>(4u | tson::FLIPPED_DIAGONALLY_FLAG)};
+    std::string json = CreateCollisionMapJson(2, 2, data, R"(, "offsetx": 100, "offsety": 50)");
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::CollisionBuilder builder {std::string("solid")};
+    const std::vector<tson::CollisionShape> &shapes = builder.buildShapes(*map->getLayer("collision"));
+    REQUIRE(shapes.size() == 3);
+    REQUIRE(shapes[0].type == tson::ObjectType::Polygon);
+    REQUIRE(shapes[0].tilePosition == tson::Vector2i(0, 0));
+    REQUIRE(shapes[0].points.size() == 3);
+    REQUIRE(shapes[0].points[0] == tson::Vector2f(102.f, 54.f));
+    REQUIRE(shapes[0].points[1] == tson::Vector2f(108.f, 54.f));
+    REQUIRE(shapes[0].points[2] == tson::Vector2f(102.f, 64.f));
+
+    //Flipped horizontally: x = 16 - x
+    REQUIRE(shapes[1].tilePosition == tson::Vector2i(0, 1));
+    REQUIRE(shapes[1].points[0] == tson::Vector2f(114.f, 70.f));
+    REQUIRE(shapes[1].points[1] == tson::Vector2f(108.f, 70.f));
+
+    //Flipped diagonally: x and y swapped
+    REQUIRE(shapes[2].points[0] == tson::Vector2f(120.f, 68.f));
+    REQUIRE(shapes[2].points[1] == tson::Vector2f(120.f, 74.f));
+    REQUIRE(shapes[2].points[2] == tson::Vector2f(130.f, 68.f));
+
+    REQUIRE(tson::CollisionBuilder::TransformTilePoint({2.f, 4.f}, {16.f, 16.f}, 4u | tson::FLIPPED_VERTICALLY_FLAG) == tson::Vector2f(2.f, 12.f));
+}
@@ -0,0 +1,290 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+static const std::string LayeredMap = R"({"type": "map", "width": 2, "height": 2, "tilewidth": 16, "tileheight": 16, "nextobjectid": 3,
+    "orientation": "orthogonal", "tiledversion": "1.9.0",
+    "tilesets": [{"firstgid": 1, "name": "tiles", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "image": "tiles.png",
+                  "imagewidth": 32, "imageheight": 32, "margin": 0, "spacing": 0}],
+    "layers": [
+        {"id": 1, "name": "Ground", "type": "tilelayer", "width": 2, "height": 2, "data": [1, 0, 0, 1], "opacity": 1, "visible": true, "x": 0, "y": 0},
+        {"id": 2, "name": "Group", "type": "group", "class": "Decor", "opacity": 1, "visible": true, "x": 0, "y": 0, "layers": [
+            {"id": 3, "name": "Trees", "type": "tilelayer", "width": 2, "height": 2, "data": [0, 2, 2, 0], "opacity": 1, "visible": true, "x": 0, "y": 0},
+            {"id": 4, "name": "Spawns", "type": "objectgroup", "class": "Logic", "opacity": 1, "visible": true, "x": 0, "y": 0,
+             "objects": [{"id": 1, "name": "player", "type": "", "x": 8, "y": 8, "width": 0, "height": 0, "rotation": 0, "visible": true, "point": true}]}]},
+        {"id": 5, "name": "Triggers", "type": "objectgroup", "class": "Logic", "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "properties": [{"name": "active", "type": "bool", "value": true}],
+         "objects": [{"id": 2, "name": "exit", "type": "", "x": 16, "y": 0, "width": 16, "height": 16, "rotation": 0, "visible": true}]}]})";
+
+static std::vector<std::string> GetLayerNames(std::vector<tson::Layer> &layers)
+{
+    std::vector<std::string> names;
+    for(auto &layer : layers)
+    {
+        names.push_back(layer.getName());
+        for(const std::string &name : GetLayerNames(layer.getLayers()))
+            names.push_back(layer.getName() + "/" + name);
+    }
+    return names;
+}
+
+TEST_CASE( "Parse a map with lazy layers - expects the same layers as an eager parse, loaded on first use", "[lazy]" )
+{
+    fs::path path = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> eager = t.parse(path);
+
+    t.setLazyLayers(true);
+    REQUIRE(t.hasLazyLayers());
+    std::unique_ptr<tson::Map> lazy = t.parse(path);
+    REQUIRE(lazy->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(lazy->hasUnloadedLayers());
+    REQUIRE(lazy->getLayers().size() == eager->getLayers().size());
+
+    //Only the fields of the layers are read until they are used
+    for(auto &layer : lazy->getLayers())
+        REQUIRE(!layer.isLoaded());
+
+    tson::Layer *main = lazy->getLayer("Main Layer");
+    REQUIRE(main->getName() == "Main Layer");
+    REQUIRE(main->getType() == tson::LayerType::TileLayer);
+    REQUIRE(main->getSize() == eager->getLayer("Main Layer")->getSize());
+    REQUIRE(!main->isLoaded());
+
+    REQUIRE(main->getData() == eager->getLayer("Main Layer")->getData());
+    REQUIRE(main->isLoaded());
+    REQUIRE(main->getTileData().size() == eager->getLayer("Main Layer")->getTileData().size());
+    REQUIRE(main->getTileData(4, 4)->getGid() == eager->getLayer("Main Layer")->getTileData(4, 4)->getGid());
+    REQUIRE(!lazy->getLayer("Object Layer")->isLoaded());
+
+    //Map-wide object lookups load every layer
+    tson::Object *obj = lazy->getObj(2);
+    REQUIRE(obj != nullptr);
+    REQUIRE(obj->getName() == eager->getObj(2)->getName());
+    REQUIRE(!lazy->hasUnloadedLayers());
+
+    for(size_t i = 0; i < eager->getLayers().size(); ++i)
+    {
+        tson::Layer &a = lazy->getLayers()[i];
+        tson::Layer &b = eager->getLayers()[i];
+        REQUIRE(a.isLoaded());
+        REQUIRE(a.getData() == b.getData());
+        REQUIRE(a.getObjects().size() == b.getObjects().size());
+        REQUIRE(a.getObjsByType(tson::ObjectType::Polygon).size() == b.getObjsByType(tson::ObjectType::Polygon).size());
+        REQUIRE(a.getUniqueFlaggedTiles() == b.getUniqueFlaggedTiles());
+        REQUIRE(a.getTileData().size() == b.getTileData().size());
+        REQUIRE(a.getProperties().getSize() == b.getProperties().getSize());
+    }
+    REQUIRE(lazy->getTileMap().size() == eager->getTileMap().size());
+
+    //The parser is still usable after giving its json to the lazy map
+    t.setLazyLayers(false);
+    std::unique_ptr<tson::Map> again = t.parse(path);
+    REQUIRE(again->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(!again->hasUnloadedLayers());
+    REQUIRE(again->getLayers()[0].isLoaded());
+}
+
+TEST_CASE( "Parse maps with lazy layers and templates or tmx - expects the same objects after loading", "[lazy]" )
+{
+    tson::Tileson t;
+    t.setLazyLayers(true);
+    std::unique_ptr<tson::Map> map = t.parse(GetPathWithBase(fs::path("test-maps/withtemplates.json")));
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::Tileson eagerParser;
+    std::unique_ptr<tson::Map> eager = eagerParser.parse(GetPathWithBase(fs::path("test-maps/withtemplates.json")));
+    std::vector<tson::Object> &objects = map->getLayer("Object Layer")->getObjects();
+    std::vector<tson::Object> &expected = eager->getLayer("Object Layer")->getObjects();
+    REQUIRE(objects.size() == expected.size());
+    for(size_t i = 0; i < objects.size(); ++i)
+    {
+        REQUIRE(objects[i].getName() == expected[i].getName());
+        REQUIRE(objects[i].getSize() == expected[i].getSize());
+        REQUIRE(objects[i].getGid() == expected[i].getGid());
+    }
+
+    tson::Tileson tmx {std::make_unique<tson::TmxJson>()};
+    tmx.setLazyLayers(true);
+    map = tmx.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.tmx")));
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->hasUnloadedLayers());
+    map->loadLayers();
+    REQUIRE(!map->hasUnloadedLayers());
+    tson::Tileson eagerTmx {std::make_unique<tson::TmxJson>()};
+    eager = eagerTmx.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.tmx")));
+    REQUIRE(map->getLayer("Main Layer")->getData() == eager->getLayer("Main Layer")->getData());
+    REQUIRE(map->getLayer("Object Layer")->getObjects().size() == eager->getLayer("Object Layer")->getObjects().size());
+}
+
+TEST_CASE( "Parse a map with lazy group layers - expects child layers to load on their own", "[lazy]" )
+{
+    tson::Tileson t;
+    t.setLazyLayers(true);
+    std::unique_ptr<tson::Map> map = t.parse(LayeredMap.data(), LayeredMap.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    //Group layers and properties are read right away
+    tson::Layer &group = map->getLayers()[1];
+    REQUIRE(group.getLayers().size() == 2);
+    REQUIRE(map->getLayers()[2].get<bool>("active"));
+
+    tson::Layer &spawns = group.getLayers()[1];
+    REQUIRE(!spawns.isLoaded());
+    REQUIRE(spawns.firstObj("player") != nullptr);
+    REQUIRE(spawns.isLoaded());
+    REQUIRE(map->hasUnloadedLayers());
+
+    REQUIRE(map->firstObj("exit")->getId() == 2);
+    REQUIRE(map->getObjLayer(1) == &spawns);
+    REQUIRE(!map->hasUnloadedLayers());
+
+    //Only top level layers have tile data, like with an eager parse
+    REQUIRE(map->getLayers()[0].getTileData(1, 1)->getGid() == 1);
+    REQUIRE(group.getLayers()[0].getData() == std::vector<uint32_t>{0, 2, 2, 0});
+}
+
+TEST_CASE( "Parse a map with a layer filter - expects only the accepted layers and the groups containing them", "[lazy][filter]" )
+{
+    tson::Tileson t;
+    auto parse = [&](tson::LayerFilter filter)
+    {
+        t.setLayerFilter(std::move(filter));
+        std::unique_ptr<tson::Map> map = t.parse(LayeredMap.data(), LayeredMap.size());
+        REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+        return map;
+    };
+
+    std::unique_ptr<tson::Map> map = parse(nullptr);
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Ground", "Group", "Group/Trees", "Group/Spawns", "Triggers"});
+
+    map = parse([](const tson::Layer &layer) { return layer.getClassType() == "Logic"; });
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Group", "Group/Spawns", "Triggers"});
+    REQUIRE(map->getObj(1)->getName() == "player");
+
+    map = parse([](const tson::Layer &layer) { return layer.getName() == "Group"; });
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Group", "Group/Trees", "Group/Spawns"});
+    REQUIRE(map->getObj(2) == nullptr);
+
+    map = parse([](const tson::Layer &layer) { return layer.getType() == tson::LayerType::TileLayer; });
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Ground", "Group", "Group/Trees"});
+    REQUIRE(map->getLayers()[0].getTileData().size() == 2);
+
+    map = parse([](const tson::Layer &) { return false; });
+    REQUIRE(map->getLayers().empty());
+
+    //Filters and lazy layers can be combined
+    t.setLazyLayers(true);
+    map = parse([](const tson::Layer &layer) { return layer.getName() == "Triggers"; });
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Triggers"});
+    REQUIRE(map->hasUnloadedLayers());
+    REQUIRE(map->getLayers()[0].getObjects().size() == 1);
+    REQUIRE(!map->hasUnloadedLayers());
+}
+
+TEST_CASE( "Parse a map with a layer filter and snapshots - expects the filtered map to neither write nor read a snapshot", "[lazy][filter][snapshot]" )
+{
+    fs::path folder = fs::temp_directory_path() / "tileson_filter_snapshot";
+    fs::remove_all(folder);
+    fs::create_directories(folder);
+    fs::path mapPath = folder / "map.json";
+    {
+        std::ofstream out(mapPath);
+        out << LayeredMap;
+    }
+    fs::path snapshotPath = tson::MapSnapshot::GetPath(mapPath);
+
+    tson::Tileson t;
+    t.setSnapshotMode(tson::SnapshotMode::ReadWrite);
+    t.setLayerFilter([](const tson::Layer &layer) { return layer.getName() == "Triggers"; });
+    std::unique_ptr<tson::Map> map = t.parse(mapPath);
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Triggers"});
+    REQUIRE(!fs::exists(snapshotPath));
+
+    //Without a filter, every layer is parsed and the snapshot is written
+    t.setLayerFilter(nullptr);
+    map = t.parse(mapPath);
+    REQUIRE(GetLayerNames(map->getLayers()).size() == 5);
+    REQUIRE(fs::exists(snapshotPath));
+    map = t.parse(mapPath);
+    REQUIRE(GetLayerNames(map->getLayers()).size() == 5);
+
+    //The snapshot with every layer is not used for a filtered parse
+    t.setLayerFilter([](const tson::Layer &layer) { return layer.getName() == "Ground"; });
+    map = t.parse(mapPath);
+    REQUIRE(GetLayerNames(map->getLayers()) == std::vector<std::string>{"Ground"});
+
+    fs::remove_all(folder);
+}
+
+TEST_CASE( "Load lazy layers after the parser is gone - expects the map to own its decompressors and template cache", "[lazy]" )
+{
+    auto parseLazy = [](const fs::path &path)
+    {
+        tson::Tileson t;
+        t.setLazyLayers(true);
+        t.setTemplateCache(std::make_shared<tson::TemplateCache>());
+        return t.parse(path);
+    };
+
+    std::unique_ptr<tson::Map> map = parseLazy(GetPathWithBase(fs::path("test-maps/ultimate_test_base64.json")));
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->hasUnloadedLayers());
+    tson::Tileson eagerParser;
+    std::unique_ptr<tson::Map> eager = eagerParser.parse(GetPathWithBase(fs::path("test-maps/ultimate_test_base64.json")));
+    REQUIRE(!map->getLayer("Main Layer")->getData().empty());
+    REQUIRE(map->getLayer("Main Layer")->getData() == eager->getLayer("Main Layer")->getData());
+
+    map = parseLazy(GetPathWithBase(fs::path("test-maps/withtemplates.json")));
+    eager = eagerParser.parse(GetPathWithBase(fs::path("test-maps/withtemplates.json")));
+    map->loadLayers();
+    std::vector<tson::Object> &objects = map->getLayer("Object Layer")->getObjects();
+    REQUIRE(objects.size() == eager->getLayer("Object Layer")->getObjects().size());
+    for(size_t i = 0; i < objects.size(); ++i)
+        REQUIRE(objects[i].getName() == eager->getLayer("Object Layer")->getObjects()[i].getName());
+}
+
+TEST_CASE( "Copy a lazy layer - expects the copy to be loaded, and the json of the map to outlive the other layers", "[lazy]" )
+{
+    fs::path path = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> eager = t.parse(path);
+    t.setLazyLayers(true);
+    std::unique_ptr<tson::Map> lazy = t.parse(path);
+    REQUIRE(lazy->getStatus() == tson::ParseStatus::OK);
+
+    tson::Layer *main = lazy->getLayer("Main Layer");
+    tson::Layer copy = *main;
+    REQUIRE(main->isLoaded());
+    REQUIRE(copy.isLoaded());
+    REQUIRE(copy.getData() == eager->getLayer("Main Layer")->getData());
+    REQUIRE(lazy->hasUnloadedLayers());
+
+    //Assigning loads both layers, so each layer of the map is still loaded once
+    tson::Layer assigned = *main;
+    assigned = lazy->getLayers().back();
+    REQUIRE(lazy->getLayers().back().isLoaded());
+    REQUIRE(assigned.getName() == lazy->getLayers().back().getName());
+
+    for(auto &layer : lazy->getLayers())
+        layer.load();
+    REQUIRE(!lazy->hasUnloadedLayers());
+    for(size_t i = 0; i < eager->getLayers().size(); ++i)
+    {
+        REQUIRE(lazy->getLayers()[i].getObjects().size() == eager->getLayers()[i].getObjects().size());
+        REQUIRE(lazy->getLayers()[i].getData() == eager->getLayers()[i].getData());
+    }
+
+    //Moving hands an unloaded layer over
+    lazy = t.parse(path);
+    tson::Layer moved = std::move(lazy->getLayers()[0]);
+    REQUIRE(!moved.isLoaded());
+    REQUIRE(moved.getData() == eager->getLayers()[0].getData());
+}
@@ -26,6 +26,8 @@
 #include <memory>
 #include <map>
 #include <functional>
+#include <thread>
+#include <atomic>
 
 //#include "../include/json/NlohmannJson.hpp"
 
@@ -377,6 +379,58 @@ TEST_CASE("Parse objects with templates", "[parse]")
     }
 }
 
+TEST_CASE("Parse objects with templates from a template cache - Expect the same objects as without the cache", "[parse][cache]")
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/withtemplates.json"));
+    tson::Tileson uncached;
+    tson::Tileson cached;
+    cached.setTemplateCache(std::make_shared<tson::TemplateCache>());
+
+    std::unique_ptr<tson::Map> expected = uncached.parse(pathToUse);
+    std::unique_ptr<tson::Map> first = cached.parse(pathToUse);
+    REQUIRE(cached.getTemplateCache()->size() == 3);
+    REQUIRE(cached.getTemplateCache()->getMisses() == 3);
+    first.reset();
+    std::unique_ptr<tson::Map> map = cached.parse(pathToUse);
+    REQUIRE(cached.getTemplateCache()->getMisses() == 3);
+    REQUIRE(cached.getTemplateCache()->getHits() == 5);
+    REQUIRE(expected->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    std::vector<tson::Object> &expectedObjects = expected->getLayer("Object Layer")->getObjects();
+    std::vector<tson::Object> &objects = map->getLayer("Object Layer")->getObjects();
+    REQUIRE(objects.size() == expectedObjects.size());
+    for(size_t i = 0; i < objects.size(); ++i)
+    {
+        tson::Object &object = objects[i];
+        tson::Object &expectedObject = expectedObjects[i];
+        REQUIRE(object.getId() == expectedObject.getId());
+        REQUIRE(object.getName() == expectedObject.getName());
+        REQUIRE(object.getType() == expectedObject.getType());
+        REQUIRE(object.getObjectType() == expectedObject.getObjectType());
+        REQUIRE(object.getTemplate() == expectedObject.getTemplate());
+        REQUIRE(object.getPosition() == expectedObject.getPosition());
+        REQUIRE(object.getSize() == expectedObject.getSize());
+        REQUIRE(object.getGid() == expectedObject.getGid());
+        REQUIRE(object.getFlipFlags() == expectedObject.getFlipFlags());
+        REQUIRE(object.getRotation() == expectedObject.getRotation());
+        REQUIRE(object.isVisible() == expectedObject.isVisible());
+        REQUIRE(object.isEllipse() == expectedObject.isEllipse());
+        REQUIRE(object.isPoint() == expectedObject.isPoint());
+        REQUIRE(object.getPolygons() == expectedObject.getPolygons());
+        REQUIRE(object.getPolylines() == expectedObject.getPolylines());
+        REQUIRE(object.getText().text == expectedObject.getText().text);
+        REQUIRE(object.getProperties().getSize() == expectedObject.getProperties().getSize());
+        for(auto &[name, property] : expectedObject.getProperties().getProperties())
+        {
+            REQUIRE(object.getProperties().hasProperty(name));
+            REQUIRE(object.getProp(name)->getType() == property.getType());
+        }
+    }
+    REQUIRE(objects[0].get<int>("armor") == 75);
+    REQUIRE(objects[0].get<int>("hit points") == 100);
+}
+
 
 TEST_CASE( "Parse a Tiled v1.5 map with external tileset by file - Expect no errors and correct data", "[complete][parse][file]" )
 {
@@ -438,6 +492,508 @@ TEST_CASE( "Parse a Tiled v1.9 map with external tileset by file - Expect no err
     }
 }
 
+TEST_CASE( "Parse maps sharing an external tileset with a tileset cache - Expect the tileset to be parsed once", "[complete][parse][file][cache]" )
+{
+    tson::Tileson t;
+    t.setTilesetCache(std::make_shared<tson::TilesetCache>());
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test_v1.5.json"));
+
+    std::unique_ptr<tson::Map> first = t.parse(pathToUse);
+    REQUIRE(first->getStatus() == tson::ParseStatus::OK);
+    first.reset();
+
+    //The second map gets its own copy, which must not point to the first map
+    std::unique_ptr<tson::Map> map = t.parse(pathToUse);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    performMainAsserts(map.get(), false);
+    checkChangesAfterTiledVersion124(map.get());
+    performAssertsOnTiled15Changes(map.get());
+
+    tson::Tileset *tileset = map->getTileset("demo-tileset");
+    REQUIRE(tileset->getMap() == map.get());
+    REQUIRE(std::all_of(tileset->getTiles().begin(), tileset->getTiles().end(), [&](tson::Tile &tile)
+    {
+        return tile.getMap() == map.get() && tile.getTileset() == tileset;
+    }));
+    REQUIRE(t.getTilesetCache()->size() == 1);
+    REQUIRE(t.getTilesetCache()->getMisses() == 1);
+    REQUIRE(t.getTilesetCache()->getHits() == 1);
+}
+
+TEST_CASE( "Parse an external tileset from a tileset cache - Expect the same data as without the cache", "[complete][parse][memory][cache]" )
+{
+    fs::path folder = fs::temp_directory_path() / "tileson_tileset_cache_test";
+    fs::create_directories(folder);
+    fs::path tilesetPath = folder / "tileset.json";
+    fs::copy_file(GetPathWithBase(fs::path("test-maps/demo-tileset.json")), tilesetPath, fs::copy_options::overwrite_existing);
+
+    //The external tileset comes after an embedded one, so its 'firstgid' is not the one it was cached with
+    std::string json = R"({"width": 2, "height": 1, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 1,
+        "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map",
+        "tilesets": [{"firstgid": 1, "name": "embedded", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+                      "image": "embedded.png", "imagewidth": 32, "imageheight": 32},
+                     {"firstgid": 5, "source": ")" + tilesetPath.generic_string() + R"("}],
+        "layers": [{"name": "ground", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0, "width": 2, "height": 1, "data": [1, 6]}]})";
+
+    tson::Tileson uncached;
+    tson::Tileson cached;
+    cached.setTilesetCache(std::make_shared<tson::TilesetCache>());
+    std::unique_ptr<tson::Map> expected = uncached.parse(json.data(), json.size());
+    std::unique_ptr<tson::Map> warmup = cached.parse(json.data(), json.size());
+    std::unique_ptr<tson::Map> map = cached.parse(json.data(), json.size());
+    REQUIRE(expected->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(cached.getTilesetCache()->getHits() == 1);
+
+    tson::Tileset *expectedTileset = expected->getTileset("demo-tileset");
+    tson::Tileset *tileset = map->getTileset("demo-tileset");
+    REQUIRE(tileset->getFirstgid() == 5);
+    REQUIRE(tileset->getFullImagePath() == expectedTileset->getFullImagePath());
+    REQUIRE(tileset->getTiles().size() == expectedTileset->getTiles().size());
+    for(size_t i = 0; i < tileset->getTiles().size(); ++i)
+    {
+        tson::Tile &tile = tileset->getTiles()[i];
+        tson::Tile &expectedTile = expectedTileset->getTiles()[i];
+        REQUIRE(tile.getGid() == expectedTile.getGid());
+        REQUIRE(tile.getDrawingRect() == expectedTile.getDrawingRect());
+        REQUIRE(tile.getProperties().getSize() == expectedTile.getProperties().getSize());
+        REQUIRE(tile.getObjectgroup().getObjects().size() == expectedTile.getObjectgroup().getObjects().size());
+    }
+    REQUIRE(map->getTileMap().at(6)->getTileset() == tileset);
+    for(size_t i = 0; i < tileset->getWangsets().size(); ++i)
+    {
+        const tson::WangLookup &lookup = tileset->getWangsets()[i].getLookup();
+        const tson::WangLookup &expectedLookup = expectedTileset->getWangsets()[i].getLookup();
+        REQUIRE(lookup.getWangIds() == expectedLookup.getWangIds());
+        for(uint64_t wangId : lookup.getWangIds())
+            REQUIRE(std::vector<uint32_t>(lookup.find(wangId).gids, lookup.find(wangId).gids + lookup.find(wangId).count) ==
+                    std::vector<uint32_t>(expectedLookup.find(wangId).gids, expectedLookup.find(wangId).gids + expectedLookup.find(wangId).count));
+    }
+
+    //A tileset changed on disk is parsed again
+    {
+        std::ifstream in(tilesetPath);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        content.replace(content.find("\"demo-tileset\""), 14, "\"demo-changed\"");
+        std::ofstream out(tilesetPath, std::ios::trunc);
+        out << content;
+    }
+    fs::last_write_time(tilesetPath, fs::last_write_time(tilesetPath) + std::chrono::seconds(10));
+    std::unique_ptr<tson::Map> changed = cached.parse(json.data(), json.size());
+    REQUIRE(changed->getTileset("demo-changed") != nullptr);
+    REQUIRE(cached.getTilesetCache()->getMisses() == 2);
+    REQUIRE(cached.getTilesetCache()->size() == 1);
+    fs::remove_all(folder);
+}
+
+TEST_CASE( "Load a map from a snapshot - Expect the same data as the parsed map", "[complete][parse][file][snapshot]" )
+{
+    tson::Tileson t;
+
+    for(const char *file : {"test-maps/ultimate_test.json", "test-maps/ultimate_test_v1.5.json"})
+    {
+        fs::path pathToUse = GetPathWithBase(fs::path(file));
+        std::unique_ptr<tson::Map> parsed = t.parse(pathToUse);
+        REQUIRE(parsed->getStatus() == tson::ParseStatus::OK);
+
+        std::vector<uint8_t> snapshot = tson::MapSnapshot::Serialize(*parsed);
+        std::unique_ptr<tson::Map> map = tson::MapSnapshot::Deserialize(snapshot.data(), snapshot.size(), nullptr, t.decompressors());
+        REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+        bool const isOldMap = std::string(file) == "test-maps/ultimate_test.json";
+        performMainAsserts(map.get(), isOldMap);
+        checkChangesAfterTiledVersion124(map.get());
+        if(!isOldMap)
+            performAssertsOnTiled15Changes(map.get());
+
+        REQUIRE(map->getTileMap().size() == parsed->getTileMap().size());
+        REQUIRE(map->getTileDrawTable().size() == parsed->getTileDrawTable().size());
+        for(auto &[gid, tile] : parsed->getTileMap())
+        {
+            REQUIRE(map->getTileMap().at(gid)->getDrawingRect() == tile->getDrawingRect());
+            REQUIRE(map->getTileMap().at(gid)->getFlipFlags() == tile->getFlipFlags());
+        }
+        REQUIRE(map->getAnimationClock().size() == parsed->getAnimationClock().size());
+
+        //Everything that was stored is loaded again
+        REQUIRE(tson::MapSnapshot::Serialize(*map) == snapshot);
+    }
+}
+
+TEST_CASE( "Parse a map through its snapshot - Expect the snapshot to be used until the map or its tileset changes", "[parse][file][snapshot]" )
+{
+    fs::path folder = fs::temp_directory_path() / "tileson_snapshot_test";
+    fs::remove_all(folder);
+    fs::create_directories(folder);
+    fs::path tilesetPath = folder / "tileset.json";
+    fs::path mapPath = folder / "map.json";
+    fs::copy_file(GetPathWithBase(fs::path("test-maps/demo-tileset.json")), tilesetPath);
+
+    auto writeMap = [&](int gid)
+    {
+        std::ofstream out(mapPath, std::ios::trunc);
+        out << R"({"width": 2, "height": 1, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 1,
+            "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map", "tilesets": [{"firstgid": 1, "source": "tileset.json"}],
+            "layers": [{"name": "ground", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0, "width": 2, "height": 1,
+                        "data": [1, )" << gid << "]}]}";
+    };
+    auto later = [](const fs::path &path, const fs::path &than)
+    {
+        fs::last_write_time(path, fs::last_write_time(than) + std::chrono::seconds(10));
+    };
+    writeMap(2);
+
+    tson::Tileson writer;
+    writer.setSnapshotMode(tson::SnapshotMode::ReadWrite);
+    std::unique_ptr<tson::Map> written = writer.parse(mapPath);
+    fs::path snapshotPath = tson::MapSnapshot::GetPath(mapPath);
+    REQUIRE(written->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(fs::exists(snapshotPath));
+
+    std::vector<uint8_t> data;
+    tson::MapSnapshot::Header header;
+    REQUIRE(tson::MapSnapshot::ReadFile(snapshotPath, data));
+    REQUIRE(tson::MapSnapshot::ReadHeader(data.data(), data.size(), header));
+    REQUIRE(header.version == tson::MapSnapshot::Version);
+    REQUIRE(header.dependencies.size() == 1);
+    REQUIRE(fs::equivalent(header.dependencies[0], tilesetPath));
+
+    //The external tileset is never read when the snapshot is used
+    tson::Tileson reader;
+    reader.setSnapshotMode(tson::SnapshotMode::Read);
+    reader.setTilesetCache(std::make_shared<tson::TilesetCache>());
+    std::unique_ptr<tson::Map> map = reader.parse(mapPath);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(reader.getTilesetCache()->getMisses() == 0);
+    REQUIRE(map->getLayer("ground")->getData() == std::vector<uint32_t> {1, 2});
+    REQUIRE(map->getLayer("ground")->getTileData(1, 0) == map->getTileMap().at(2));
+    REQUIRE(map->getTileset("demo-tileset")->getTiles().size() == written->getTileset("demo-tileset")->getTiles().size());
+
+    //A changed map is parsed again. Read mode does not replace the snapshot.
+    writeMap(3);
+    later(mapPath, snapshotPath);
+    map = reader.parse(mapPath);
+    REQUIRE(map->getLayer("ground")->getData() == std::vector<uint32_t> {1, 3});
+    REQUIRE(reader.getTilesetCache()->getMisses() == 1);
+
+    //A snapshot of another json is not used, even when it is newer
+    later(snapshotPath, mapPath);
+    map = reader.parse(mapPath);
+    REQUIRE(map->getLayer("ground")->getData() == std::vector<uint32_t> {1, 3});
+    REQUIRE(reader.getTilesetCache()->getHits() == 1);
+
+    //ReadWrite replaces it, and a changed tileset makes it out of date again
+    map = writer.parse(mapPath);
+    later(snapshotPath, mapPath);
+    map = reader.parse(mapPath);
+    REQUIRE(map->getLayer("ground")->getData() == std::vector<uint32_t> {1, 3});
+    REQUIRE(reader.getTilesetCache()->getHits() == 1);
+
+    later(tilesetPath, snapshotPath);
+    map = reader.parse(mapPath);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(reader.getTilesetCache()->getMisses() == 2);
+
+    fs::remove_all(folder);
+}
+
+TEST_CASE( "Load a broken snapshot - Expect a parse error", "[parse][memory][snapshot]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> parsed = t.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+    std::vector<uint8_t> snapshot = tson::MapSnapshot::Serialize(*parsed);
+
+    std::unique_ptr<tson::Map> truncated = tson::MapSnapshot::Deserialize(snapshot.data(), snapshot.size() / 2);
+    REQUIRE(truncated->getStatus() == tson::ParseStatus::ParseError);
+
+    std::string const json = "{\"width\": 2}";
+    std::unique_ptr<tson::Map> notSnapshot = tson::MapSnapshot::Deserialize(json.data(), json.size());
+    REQUIRE(notSnapshot->getStatus() == tson::ParseStatus::ParseError);
+
+    snapshot[6] = static_cast<uint8_t>(tson::MapSnapshot::Version + 1);
+    std::unique_ptr<tson::Map> otherVersion = tson::MapSnapshot::Deserialize(snapshot.data(), snapshot.size());
+    REQUIRE(otherVersion->getStatus() == tson::ParseStatus::ParseError);
+}
+
+void checkPropertyView(tson::PropertyCollection &properties, const tson::TableView<tson::PropertyView> &views)
+{
+    REQUIRE(views.size() == properties.getSize());
+    for(auto &[name, property] : properties.getProperties())
+    {
+        tson::PropertyView view = tson::PropertyView::Find(views, name);
+        REQUIRE(view.isValid());
+        REQUIRE(view.getType() == property.getType());
+        switch(view.getValueKind())
+        {
+            case tson::FlatMap::ValueKind::Int: REQUIRE(view.getInt() == property.getValue<int>()); break;
+            case tson::FlatMap::ValueKind::Bool: REQUIRE(view.getBool() == property.getValue<bool>()); break;
+            case tson::FlatMap::ValueKind::Float: REQUIRE(view.getFloat() == property.getValue<float>()); break;
+            case tson::FlatMap::ValueKind::String: REQUIRE(view.getString() == property.getValue<std::string>()); break;
+            case tson::FlatMap::ValueKind::Color: REQUIRE(view.getColor() == property.getValue<tson::Colori>()); break;
+            default: break;
+        }
+    }
+}
+
+void checkObjectViews(std::vector<tson::Object> &objects, const tson::TableView<tson::ObjectView> &views)
+{
+    REQUIRE(views.size() == objects.size());
+    for(size_t i = 0; i < objects.size(); ++i)
+    {
+        tson::ObjectView view = views[i];
+        REQUIRE(view.getId() == objects[i].getId());
+        REQUIRE(view.getName() == objects[i].getName());
+        REQUIRE(view.getObjectType() == objects[i].getObjectType());
+        REQUIRE(view.getPosition() == objects[i].getPosition());
+        REQUIRE(view.getSize() == objects[i].getSize());
+        REQUIRE(view.getGid() == objects[i].getGid());
+        REQUIRE(view.getFlipFlags() == objects[i].getFlipFlags());
+        REQUIRE(view.isVisible() == objects[i].isVisible());
+        REQUIRE(view.getText() == objects[i].getText().text);
+        REQUIRE(view.getPolygons() == objects[i].getPolygons());
+        REQUIRE(view.getPolylines() == objects[i].getPolylines());
+        checkPropertyView(objects[i].getProperties(), view.getProperties());
+    }
+}
+
+void checkLayerViews(std::vector<tson::Layer> &layers, const tson::TableView<tson::LayerView> &views)
+{
+    REQUIRE(views.size() == layers.size());
+    size_t i = 0;
+    for(tson::LayerView view : views)
+    {
+        tson::Layer &layer = layers[i++];
+        REQUIRE(view.getName() == layer.getName());
+        REQUIRE(view.getType() == layer.getType());
+        REQUIRE(view.getSize() == layer.getSize());
+        REQUIRE(view.getOpacity() == layer.getOpacity());
+        REQUIRE(view.isVisible() == layer.isVisible());
+        REQUIRE(view.getDataSize() == layer.getData().size());
+        for(size_t gid = 0; gid < layer.getData().size(); ++gid)
+            REQUIRE(view.getGid(gid) == layer.getData()[gid]);
+        REQUIRE(view.getChunks().size() == layer.getChunks().size());
+        checkObjectViews(layer.getObjects(), view.getObjects());
+        checkLayerViews(layer.getLayers(), view.getLayers());
+        checkPropertyView(layer.getProperties(), view.getProperties());
+    }
+}
+
+TEST_CASE( "Open a flat map - Expect the views to have the data of the parsed map", "[complete][parse][memory][flatmap]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    std::vector<uint8_t> data = tson::FlatMap::Serialize(*map);
+    REQUIRE(data.size() % 4 == 0);
+    tson::MapView view {data.data(), data.size()};
+    REQUIRE(view.isValid());
+    REQUIRE(view.getSize() == map->getSize());
+    REQUIRE(view.getTileSize() == map->getTileSize());
+    REQUIRE(view.getOrientation() == map->getOrientation());
+    REQUIRE(view.getBackgroundColor() == map->getBackgroundColor());
+    REQUIRE(view.isInfinite() == map->isInfinite());
+    checkPropertyView(map->getProperties(), view.getProperties());
+    checkLayerViews(map->getLayers(), view.getLayers());
+
+    tson::Layer *main = map->getLayer("Main Layer");
+    REQUIRE(view.getLayer("Main Layer").isValid());
+    REQUIRE(!view.getLayer("No such layer").isValid());
+    for(int y = 0; y < main->getSize().y; ++y)
+    {
+        for(int x = 0; x < main->getSize().x; ++x)
+            REQUIRE(view.getLayer("Main Layer").getGid(x, y) == main->getData()[static_cast<size_t>(y * main->getSize().x + x)]);
+    }
+    REQUIRE(view.getLayer("Main Layer").getGid(-1, 0) == 0);
+
+    REQUIRE(view.getTilesets().size() == map->getTilesets().size());
+    for(auto &tileset : map->getTilesets())
+    {
+        tson::TilesetView tilesetView = view.getTileset(tileset.getName());
+        REQUIRE(tilesetView.isValid());
+        REQUIRE(tilesetView.getFirstgid() == tileset.getFirstgid());
+        REQUIRE(tilesetView.getTileCount() == tileset.getTileCount());
+        REQUIRE(tilesetView.getImage() == tileset.getImage().generic_string());
+        REQUIRE(view.getTilesetByGid(static_cast<uint32_t>(tileset.getFirstgid())).getName() == tileset.getName());
+        checkPropertyView(tileset.getProperties(), tilesetView.getProperties());
+        for(auto &tile : tileset.getTiles())
+        {
+            tson::TileView tileView = tilesetView.getTile(tile.getId());
+            if(!tileView.isValid())
+                continue;
+            REQUIRE(tileView.getGid() == tile.getGid());
+            REQUIRE(tileView.getClassType() == tile.getClassType());
+            REQUIRE(tileView.getFrames().size() == tile.getAnimation().size());
+            checkObjectViews(tile.getObjectgroup().getObjects(), tileView.getObjects());
+            checkPropertyView(tile.getProperties(), tileView.getProperties());
+        }
+    }
+    REQUIRE(!view.getTilesetByGid(100000).isValid());
+}
+
+TEST_CASE( "Map a flat map file - Expect the same data as in memory, and broken files to be rejected", "[parse][file][flatmap]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+    fs::path path = fs::temp_directory_path() / "tileson_flatmap_test.tsonf";
+    REQUIRE(tson::FlatMap::Save(*map, path));
+
+    {
+        tson::MappedFile file {path};
+        REQUIRE(file.isOpen());
+        tson::MappedFile moved = std::move(file);
+        REQUIRE(!file.isOpen());
+        tson::MapView view {moved.data(), moved.size()};
+        REQUIRE(view.isValid());
+        REQUIRE(std::vector<uint8_t>(moved.data(), moved.data() + moved.size()) == tson::FlatMap::Serialize(*map));
+        REQUIRE(view.getLayers().size() == map->getLayers().size());
+    }
+    fs::remove(path);
+    REQUIRE(!tson::MappedFile(path).isOpen());
+
+    std::vector<uint8_t> data = tson::FlatMap::Serialize(*map);
+    REQUIRE(!tson::MapView(data.data(), data.size() / 2).isValid());
+    REQUIRE(!tson::MapView(nullptr, 0).isValid());
+
+    //Offsets outside the data give empty tables and strings, never reads outside it
+    tson::FlatMap::Header header {};
+    REQUIRE(tson::FlatMap::ReadHeader(data.data(), data.size(), header));
+    std::vector<uint8_t> broken(data.begin(), data.begin() + header.strings);
+    header.size = static_cast<uint32_t>(broken.size());
+    header.stringsSize = 0;
+    std::memcpy(broken.data(), &header, sizeof(header));
+    tson::MapView brokenView {broken.data(), broken.size()};
+    REQUIRE(brokenView.isValid());
+    REQUIRE(brokenView.getOrientation().empty());
+    REQUIRE(brokenView.getLayers().size() == map->getLayers().size());
+
+    data[0] = 'X';
+    REQUIRE(!tson::MapView(data.data(), data.size()).isValid());
+}
+
+TEST_CASE( "Parse maps, worlds and projects from an archive - Expect the same data as from the files", "[parse][file][archive]" )
+{
+    fs::path folder = GetPathWithBase(fs::path("test-maps"));
+    tson::ArchiveWriter writer;
+    size_t const files = writer.addDirectory(folder);
+    REQUIRE(files > 10);
+    writer.addFile(folder / "project-v1.10/tilesets/tileset1.json", "copies/tileset1.json");
+    REQUIRE(writer.size() == files + 1);
+    REQUIRE(writer.getBlobCount() < writer.size());
+
+    std::vector<uint8_t> data = writer.serialize();
+    tson::Archive archive;
+    REQUIRE(archive.open(data.data(), data.size()));
+    REQUIRE(archive.size() == writer.size());
+    REQUIRE(archive.contains("withtemplates.json"));
+    REQUIRE(archive.contains("./project/../project/maps/map1.json"));
+    REQUIRE(!archive.contains("project/maps/map4.json"));
+    REQUIRE(archive.getFileNames("project/maps") == std::vector<std::string> {"map1.json", "map2.json", "map3.json"});
+
+    std::vector<uint8_t> copy;
+    std::vector<uint8_t> original;
+    REQUIRE(archive.read("copies/tileset1.json", copy));
+    REQUIRE(tson::MapSnapshot::ReadFile(folder / "project-v1.10/tilesets/tileset1.json", original));
+    REQUIRE(copy == original);
+
+    //Templates are read through the archive
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> expected = t.parse(folder / "withtemplates.json");
+    std::unique_ptr<tson::Map> map = t.parse(archive, "withtemplates.json");
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    std::vector<tson::Object> &expectedObjects = expected->getLayer("Object Layer")->getObjects();
+    std::vector<tson::Object> &objects = map->getLayer("Object Layer")->getObjects();
+    REQUIRE(objects.size() == expectedObjects.size());
+    for(size_t i = 0; i < objects.size(); ++i)
+    {
+        REQUIRE(objects[i].getName() == expectedObjects[i].getName());
+        REQUIRE(objects[i].getObjectType() == expectedObjects[i].getObjectType());
+        REQUIRE(objects[i].getSize() == expectedObjects[i].getSize());
+        REQUIRE(objects[i].getPolygons() == expectedObjects[i].getPolygons());
+        REQUIRE(objects[i].getProperties().getSize() == expectedObjects[i].getProperties().getSize());
+    }
+    REQUIRE(t.parse(archive, "not_in_archive.json")->getStatus() == tson::ParseStatus::FileNotFound);
+
+    //External tilesets are read through the archive, with classes of the project in the archive
+    tson::Project project;
+    REQUIRE(project.parse(archive, "project-v1.10/test.tiled-project"));
+    REQUIRE(project.getFolders().empty());
+    REQUIRE(project.getData().folders.size() == 2);
+    tson::Tileson projectParser {&project};
+    std::unique_ptr<tson::Map> projectMap = projectParser.parse(archive, "project-v1.10/maps/map1.json");
+    REQUIRE(projectMap->getStatus() == tson::ParseStatus::OK);
+    tson::Tileset *tileset = projectMap->getTileset("tileset1");
+    REQUIRE(tileset != nullptr);
+    REQUIRE(tileset->getClass() != nullptr);
+    REQUIRE(tileset->getClass()->get<float>("Health") == 200.f);
+    REQUIRE(tson::Archive::NormalizePath(tileset->getFullImagePath()) == "project-v1.10/images/demo-tileset.png");
+
+    //Worlds find their pattern maps in the archive, and load them from it
+    tson::World world;
+    REQUIRE(world.parse(archive, "world-patterns/patterns.world"));
+    REQUIRE(world.getMapData().size() == 5);
+    REQUIRE(world.loadMaps(&t) == 5);
+    for(const auto &worldMap : world.getMaps())
+        REQUIRE(worldMap->getStatus() == tson::ParseStatus::OK);
+}
+
+TEST_CASE( "Read a compressed archive file from many threads - Expect every file to be read", "[parse][file][archive][compression]" )
+{
+    fs::path folder = GetPathWithBase(fs::path("test-maps"));
+    fs::path path = fs::temp_directory_path() / "tileson_archive_test.tsonpak";
+    tson::ArchiveWriter writer;
+    for(const char *file : {"simple_map.json", "withtemplates.json", "template1.json", "template2.json", "template3.json"})
+        REQUIRE(writer.addFile(folder / file, fs::path("maps") / file));
+    writer.setCompressor("lzma", [](const std::vector<uint8_t> &input)
+    {
+        std::vector<uint8_t> output;
+        plz::PocketLzma p;
+        p.compress(input, output);
+        return output;
+    });
+    REQUIRE(writer.save(path));
+    REQUIRE(fs::file_size(path) < fs::file_size(folder / "simple_map.json") + fs::file_size(folder / "withtemplates.json"));
+
+    tson::Archive archive {path};
+    REQUIRE(archive.isOpen());
+    std::vector<uint8_t> content;
+    REQUIRE(!archive.read("maps/simple_map.json", content));
+    archive.addDecompressor(std::make_unique<tson::Lzma>());
+
+    std::vector<std::thread> threads;
+    std::atomic<int> parsed {0};
+    for(int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&]()
+        {
+            tson::Tileson t;
+            for(int run = 0; run < 5; ++run)
+            {
+                std::unique_ptr<tson::Map> simple = t.parse(archive, "maps/simple_map.json");
+                std::unique_ptr<tson::Map> templates = t.parse(archive, "maps/withtemplates.json");
+                if(simple->getStatus() == tson::ParseStatus::OK && templates->getStatus() == tson::ParseStatus::OK &&
+                   templates->getLayer("Object Layer")->getObj(1)->getClassType() == "CIRCLE")
+                    ++parsed;
+            }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+    REQUIRE(parsed == 40);
+    fs::remove(path);
+
+    //Broken archives are not opened
+    std::vector<uint8_t> data = writer.serialize();
+    tson::Archive broken;
+    REQUIRE(!broken.open(data.data(), data.size() - 8));
+    data[0] = 'X';
+    REQUIRE(!broken.open(data.data(), data.size()));
+    REQUIRE(broken.size() == 0);
+    REQUIRE(!broken.contains("maps/simple_map.json"));
+}
+
+
 #if __clang_major__ < 10
 TEST_CASE( "Parse a whole COMPRESSED map by file", "[complete][parse][file][compression]" )
 {
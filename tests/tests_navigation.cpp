@@ -0,0 +1,257 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+#include <sstream>
+#include <thread>
+
+static std::string CreateNavigationMapJson(int width, int height, const std::vector<int> &data, const std::string &orientation = "orthogonal",
+                                           const std::string &mapExtras = "")
+{
+    std::stringstream json;
+    json << R"({"width": )" << width << R"(, "height": )" << height << R"(, "tilewidth": 16, "tileheight": 16, "infinite": false,
+        "nextobjectid": 1, "orientation": ")" << orientation << R"(", "tiledversion": "1.9.2", "type": "map")" << mapExtras << R"(,
+        "tilesets": [{"firstgid": 1, "name": "tiles", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+            "image": "tiles.png", "imagewidth": 32, "imageheight": 32,
+            "tiles": [{"id": 1, "properties": [{"name": "solid", "type": "bool", "value": true}]},
+                      {"id": 2, "properties": [{"name": "solid", "type": "bool", "value": false}]}]}],
+        "layers": [{"name": "ground", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0,
+            "width": )" << width << R"(, "height": )" << height << R"(, "data": [)";
+    for(size_t i = 0; i < data.size(); ++i)
+        json << ((i > 0) ? "," : "") << data[i];
+    json << "]},";
+    json << R"({"name": "decoration", "type": "tilelayer", "id": 2, "opacity": 1, "visible": true, "x": 0, "y": 0,
+            "width": )" << width << R"(, "height": )" << height << R"(, "data": [)";
+    for(size_t i = 0; i < data.size(); ++i)
+        json << ((i > 0) ? "," : "") << ((i == 1) ? 2 : 0);
+    json << "]}]}";
+    return json.str();
+}
+
+/*!
+ * Cost of an orthogonal path, or 0 when a move is not between walkable neighbours without cutting corners
+ */
+static uint32_t GetOrthogonalPathCost(const tson::NavigationGrid &grid, const std::vector<tson::Vector2i> &path)
+{
+    uint32_t cost = 0;
+    for(size_t i = 1; i < path.size(); ++i)
+    {
+        int const dx = path[i].x - path[i - 1].x;
+        int const dy = path[i].y - path[i - 1].y;
+        if(std::abs(dx) > 1 || std::abs(dy) > 1 || (dx == 0 && dy == 0) || !grid.isWalkable(path[i].x, path[i].y))
+            return 0;
+        if(dx != 0 && dy != 0 && (!grid.isWalkable(path[i - 1].x + dx, path[i - 1].y) || !grid.isWalkable(path[i - 1].x, path[i - 1].y + dy)))
+            return 0;
+        cost += (dx != 0 && dy != 0) ? tson::NavigationGrid::DiagonalCost : tson::NavigationGrid::StraightCost;
+    }
+    return cost;
+}
+
+TEST_CASE( "Navigation - build a grid from the solid tiles of selected layers", "[navigation]" )
+{
+    //gid 2 has solid = true, gid 3 has solid = false
+    std::vector<int> data = {
+        0, 0, 0, 0, 0,
+        2, 2, 2, 2, 0,
+        0, 0, 3, 0, 0,
+        0, 2, 2, 2, 2,
+        0, 0, 0, 0, 0
+    };
+    std::string json = CreateNavigationMapJson(5, 5, data);
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::NavigationGrid grid;
+    grid.build(*map, {"ground"});
+    REQUIRE(grid.getBounds() == tson::Rect(0, 0, 5, 5));
+    REQUIRE(grid.getTopology() == tson::NavigationTopology::Orthogonal);
+    REQUIRE(grid.isWalkable(0, 0));
+    REQUIRE(!grid.isWalkable(0, 1));
+    REQUIRE(grid.isWalkable(2, 2));
+    REQUIRE(!grid.isWalkable(-1, 0));
+    REQUIRE(!grid.isWalkable(5, 0));
+
+    tson::NavigationContext context;
+    std::vector<tson::Vector2i> path;
+    REQUIRE(grid.findPath(context, {0, 0}, {0, 4}, path));
+    REQUIRE(path.front() == tson::Vector2i(0, 0));
+    REQUIRE(path.back() == tson::Vector2i(0, 4));
+    uint32_t const cost = GetOrthogonalPathCost(grid, path);
+    //No diagonal shortcuts: They would cut the corners of the walls
+    REQUIRE(cost == 12 * tson::NavigationGrid::StraightCost);
+
+    std::vector<tson::Vector2i> jpsPath;
+    REQUIRE(grid.findPathJps(context, {0, 0}, {0, 4}, jpsPath));
+    REQUIRE(GetOrthogonalPathCost(grid, jpsPath) == cost);
+
+    //Blocked goal, and a wall without a gap
+    REQUIRE(!grid.findPath(context, {0, 0}, {0, 1}, path));
+    REQUIRE(path.empty());
+    grid.setWalkable(4, 1, false);
+    REQUIRE(!grid.findPath(context, {0, 0}, {0, 4}, path));
+    REQUIRE(!grid.findPathJps(context, {0, 0}, {0, 4}, path));
+
+    //The decoration layer has a solid tile at (1, 0)
+    tson::NavigationGrid decoration;
+    decoration.build(*map, {"decoration"});
+    REQUIRE(!decoration.isWalkable(1, 0));
+    REQUIRE(decoration.isWalkable(0, 1));
+
+    tson::NavigationGrid all;
+    all.build(*map);
+    REQUIRE(!all.isWalkable(1, 0));
+    REQUIRE(!all.isWalkable(0, 1));
+}
+
+TEST_CASE( "Navigation - Jump Point Search finds paths as cheap as A*", "[navigation]" )
+{
+    int const size = 64;
+    tson::NavigationGrid grid;
+    grid.create({0, 0, size, size});
+    uint32_t random = 777;
+    for(int y = 0; y < size; ++y)
+    {
+        for(int x = 0; x < size; ++x)
+        {
+            random = random * 1103515245u + 12345u;
+            if((random >> 16) % 4 == 0)
+                grid.setWalkable(x, y, false);
+        }
+    }
+
+    tson::NavigationContext context;
+    std::vector<tson::Vector2i> path;
+    std::vector<tson::Vector2i> jpsPath;
+    int found = 0;
+    for(int i = 0; i < 200; ++i)
+    {
+        random = random * 1103515245u + 12345u;
+        tson::Vector2i start {static_cast<int>((random >> 8) % size), static_cast<int>((random >> 20) % size)};
+        random = random * 1103515245u + 12345u;
+        tson::Vector2i goal {static_cast<int>((random >> 8) % size), static_cast<int>((random >> 20) % size)};
+
+        bool const aStar = grid.findPath(context, start, goal, path);
+        bool const jps = grid.findPathJps(context, start, goal, jpsPath);
+        REQUIRE(aStar == jps);
+        if(!aStar)
+            continue;
+
+        ++found;
+        REQUIRE(jpsPath.front() == start);
+        REQUIRE(jpsPath.back() == goal);
+        uint32_t const cost = GetOrthogonalPathCost(grid, path);
+        REQUIRE((cost > 0 || start == goal));
+        REQUIRE(GetOrthogonalPathCost(grid, jpsPath) == cost);
+    }
+    REQUIRE(found > 50);
+
+    //On an open grid, JPS expands a handful of nodes
+    tson::NavigationGrid open;
+    open.create({-10, -10, 100, 100});
+    REQUIRE(open.findPath(context, {-10, -10}, {89, 50}, path));
+    size_t const aStarExpanded = context.getExpandedNodes();
+    REQUIRE(open.findPathJps(context, {-10, -10}, {89, 50}, jpsPath));
+    REQUIRE(context.getExpandedNodes() < aStarExpanded);
+    REQUIRE(jpsPath.size() == path.size());
+    REQUIRE(GetOrthogonalPathCost(open, jpsPath) == 60 * tson::NavigationGrid::DiagonalCost + 39 * tson::NavigationGrid::StraightCost);
+
+    //Without diagonal movement
+    open.setDiagonalMovement(false);
+    REQUIRE(open.findPathJps(context, {0, 0}, {5, 3}, path));
+    REQUIRE(path.size() == 9);
+}
+
+TEST_CASE( "Navigation - hexagonal and staggered neighbours", "[navigation]" )
+{
+    tson::NavigationContext context;
+    std::vector<tson::Vector2i> path;
+
+    //Stagger axis y, odd rows shifted: (1, 1) touches (1, 0), (2, 0), (1, 2), (2, 2), (0, 1) and (2, 1)
+    tson::NavigationGrid hex;
+    hex.create({0, 0, 8, 8}, tson::NavigationTopology::Hexagonal, false, false);
+    REQUIRE(hex.findPath(context, {1, 1}, {2, 0}, path));
+    REQUIRE(path.size() == 2);
+    REQUIRE(hex.findPath(context, {1, 1}, {0, 0}, path));
+    REQUIRE(path.size() == 3);
+    REQUIRE(hex.findPath(context, {0, 0}, {0, 4}, path));
+    REQUIRE(path.size() == 5);
+    REQUIRE(hex.findPath(context, {0, 0}, {5, 0}, path));
+    REQUIRE(path.size() == 6);
+    //Jump Point Search is the same as A* on hexagonal maps
+    REQUIRE(hex.findPathJps(context, {0, 0}, {5, 0}, path));
+    REQUIRE(path.size() == 6);
+
+    //Stagger axis x, even columns shifted: (2, 1) touches (1, 1), (1, 2), (3, 1), (3, 2), (2, 0) and (2, 2)
+    tson::NavigationGrid hexX;
+    hexX.create({0, 0, 8, 8}, tson::NavigationTopology::Hexagonal, true, true);
+    REQUIRE(hexX.findPath(context, {2, 1}, {1, 2}, path));
+    REQUIRE(path.size() == 2);
+    REQUIRE(hexX.findPath(context, {2, 1}, {1, 0}, path));
+    REQUIRE(path.size() == 3);
+
+    //A wall of hexagons with one gap
+    for(int x = 0; x < 8; ++x)
+        hex.setWalkable(x, 3, x == 7);
+    REQUIRE(hex.findPath(context, {0, 2}, {0, 4}, path));
+    REQUIRE(std::find(path.begin(), path.end(), tson::Vector2i(7, 3)) != path.end());
+
+    //Staggered: Rows are half a tile apart, so (2, 0) to (2, 4) is two moves through the corners, or four over the edges
+    tson::NavigationGrid staggered;
+    staggered.create({0, 0, 8, 8}, tson::NavigationTopology::Staggered, false, false);
+    REQUIRE(staggered.findPath(context, {2, 0}, {2, 4}, path));
+    REQUIRE(path.size() == 3);
+    REQUIRE(staggered.findPath(context, {1, 1}, {2, 1}, path));
+    REQUIRE(path.size() == 2);
+    //The corner move from (1, 1) to (2, 1) passes between (2, 0) and (2, 2)
+    staggered.setWalkable(2, 0, false);
+    REQUIRE(staggered.findPath(context, {1, 1}, {2, 1}, path));
+    REQUIRE(path.size() == 3);
+    staggered.setDiagonalMovement(false);
+    REQUIRE(staggered.findPath(context, {4, 0}, {4, 4}, path));
+    REQUIRE(path.size() == 5);
+}
+
+TEST_CASE( "Navigation - topology from the map, and one context per thread", "[navigation]" )
+{
+    std::vector<int> data(16 * 16, 1);
+    for(int y = 0; y < 15; ++y)
+        data[static_cast<size_t>(y * 16 + 8)] = 2;
+
+    std::string json = CreateNavigationMapJson(16, 16, data, "hexagonal", R"(, "hexsidelength": 8, "staggeraxis": "x", "staggerindex": "even")");
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::NavigationGrid grid;
+    grid.build(*map, {"ground"});
+    REQUIRE(grid.getTopology() == tson::NavigationTopology::Hexagonal);
+
+    tson::NavigationContext context;
+    std::vector<tson::Vector2i> expected;
+    REQUIRE(grid.findPath(context, {0, 0}, {15, 0}, expected));
+
+    std::vector<std::vector<tson::Vector2i>> paths(4);
+    std::vector<std::thread> threads;
+    for(auto &path : paths)
+    {
+        threads.emplace_back([&grid, &path]()
+        {
+            tson::NavigationContext threadContext;
+            for(int i = 0; i < 20; ++i)
+                grid.findPath(threadContext, {0, 0}, {15, 0}, path);
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+
+    for(const auto &path : paths)
+        REQUIRE(path == expected);
+}
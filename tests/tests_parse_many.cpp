@@ -0,0 +1,171 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+static std::vector<fs::path> GetParseManyPaths()
+{
+    std::vector<fs::path> paths;
+    for(const char *file : {"ultimate_test.json", "ultimate_test_base64.json", "withtemplates.json", "simple_map.json", "not_exists.json", "infinite.json"})
+        paths.push_back(GetPathWithBase(fs::path("test-maps") / file));
+
+    tson::World world {GetPathWithBase(fs::path("test-maps/project/world/test.world"))};
+    for(const auto &data : world.getMapData())
+        paths.push_back(data.path);
+    return paths;
+}
+
+static void CheckSameMap(tson::Map &map, tson::Map &expected)
+{
+    REQUIRE(map.getStatus() == expected.getStatus());
+    REQUIRE(map.getSize() == expected.getSize());
+    REQUIRE(map.getLayers().size() == expected.getLayers().size());
+    for(size_t i = 0; i < expected.getLayers().size(); ++i)
+    {
+        REQUIRE(map.getLayers()[i].getName() == expected.getLayers()[i].getName());
+        REQUIRE(map.getLayers()[i].getData() == expected.getLayers()[i].getData());
+        REQUIRE(map.getLayers()[i].getObjects().size() == expected.getLayers()[i].getObjects().size());
+    }
+    REQUIRE(map.getTilesets().size() == expected.getTilesets().size());
+}
+
+TEST_CASE( "Parse many maps on background threads - expects the same maps as parsing them one by one", "[parse][async]" )
+{
+    std::vector<fs::path> const paths = GetParseManyPaths();
+    tson::Tileson t;
+    t.setThreadCount(4);
+    REQUIRE(t.getThreadCount() == 4);
+
+    std::vector<std::future<std::unique_ptr<tson::Map>>> futures = t.parseMany(paths);
+    REQUIRE(futures.size() == paths.size());
+
+    tson::Tileson sequential;
+    for(size_t i = 0; i < paths.size(); ++i)
+    {
+        std::unique_ptr<tson::Map> map = futures[i].get();
+        REQUIRE(map != nullptr);
+        CheckSameMap(*map, *sequential.parse(paths[i]));
+    }
+
+    //Failures are reported through the status of the map
+    std::unique_ptr<tson::Map> missing = t.parseAsync(GetPathWithBase(fs::path("test-maps/not_exists.json"))).get();
+    REQUIRE(missing->getStatus() == tson::ParseStatus::FileNotFound);
+}
+
+TEST_CASE( "Parse many maps with a callback - expects every map once, with its index", "[parse][async]" )
+{
+    std::vector<fs::path> const paths = GetParseManyPaths();
+    tson::Tileson t;
+    t.setThreadCount(3);
+    t.setTilesetCache(std::make_shared<tson::TilesetCache>());
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<tson::Map>> maps(paths.size());
+    size_t calls = 0;
+    t.parseMany(paths, [&](size_t index, std::unique_ptr<tson::Map> map)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maps[index] = std::move(map);
+        ++calls;
+    });
+    t.waitForParses();
+
+    REQUIRE(calls == paths.size());
+    tson::Tileson sequential;
+    for(size_t i = 0; i < paths.size(); ++i)
+        CheckSameMap(*maps[i], *sequential.parse(paths[i]));
+}
+
+TEST_CASE( "Parse maps on background threads with options and decompressors - expects the options at the time they were queued", "[parse][async]" )
+{
+    fs::path const path = GetPathWithBase(fs::path("test-maps/region/large.json"));
+    tson::Tileson t;
+    t.setThreadCount(2);
+    t.decompressors()->add<tson::ZlibDecompressor>();
+    t.decompressors()->add<tson::GzipDecompressor>();
+
+    t.setTileRegion({10, 20, 30, 40});
+    std::future<std::unique_ptr<tson::Map>> region = t.parseAsync(path);
+    t.setTileRegion({});
+    t.setLayerFilter([](const tson::Layer &layer) { return layer.getName() == "Gzip"; });
+    std::future<std::unique_ptr<tson::Map>> filtered = t.parseAsync(path);
+
+    std::unique_ptr<tson::Map> map = region.get();
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->getLayers().size() == 3);
+    REQUIRE(map->getLayer("Zlib")->getData().size() == 30 * 40);
+    REQUIRE(map->getLayer("Zlib")->getData() == map->getLayer("Csv")->getData());
+
+    map = filtered.get();
+    REQUIRE(map->getLayers().size() == 1);
+    REQUIRE(map->getLayer("Gzip")->getData().size() == 256 * 160);
+
+    //Each thread has its own copy of the decompressors
+    tson::DecompressorContainer copy = t.decompressors()->clone();
+    REQUIRE(copy.size() == t.decompressors()->size());
+    REQUIRE(copy.contains("zlib"));
+    REQUIRE(copy.get("gzip") != t.decompressors()->get("gzip"));
+    copy.remove("zlib");
+    REQUIRE(!copy.contains("zlib"));
+    REQUIRE(copy.clone().size() == 2);
+}
+
+TEST_CASE( "Add decompressors after parsing on background threads - expects the threads to use them", "[parse][async]" )
+{
+    fs::path const path = GetPathWithBase(fs::path("test-maps/region/large.json"));
+    tson::Tileson t;
+    t.setThreadCount(2);
+    REQUIRE(t.parseAsync(GetPathWithBase(fs::path("test-maps/simple_map.json"))).get()->getStatus() == tson::ParseStatus::OK);
+
+    //The threads were started without these
+    t.decompressors()->add<tson::ZlibDecompressor>();
+    t.decompressors()->add<tson::GzipDecompressor>();
+    std::vector<std::future<std::unique_ptr<tson::Map>>> futures = t.parseMany({path, path, path});
+    for(auto &future : futures)
+    {
+        std::unique_ptr<tson::Map> map = future.get();
+        REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+        REQUIRE(map->getLayer("Zlib")->getData() == map->getLayer("Csv")->getData());
+        REQUIRE(map->getLayer("Gzip")->getData() == map->getLayer("Csv")->getData());
+    }
+
+    //Every change is a new revision, so the threads clone the decompressors again
+    uint64_t const revision = t.decompressors()->getRevision();
+    t.decompressors()->remove("gzip");
+    REQUIRE(t.decompressors()->getRevision() != revision);
+}
+
+TEST_CASE( "Parse maps on background threads that throw - expects the exceptions to be reported, and the threads to keep working", "[parse][async]" )
+{
+    fs::path const path = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    t.setThreadCount(2);
+
+    //The layer filter runs while parsing, so it can make parse() throw
+    t.setLayerFilter([](const tson::Layer &) -> bool { throw std::runtime_error("filter failed"); });
+    std::future<std::unique_ptr<tson::Map>> future = t.parseAsync(path);
+    REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+
+    std::vector<std::unique_ptr<tson::Map>> maps(3);
+    t.parseMany({path, path, path}, [&](size_t index, std::unique_ptr<tson::Map> map) { maps[index] = std::move(map); });
+    t.waitForParses();
+    for(const auto &map : maps)
+    {
+        REQUIRE(map->getStatus() == tson::ParseStatus::ParseError);
+        REQUIRE(map->getStatusMessage() == "Exception while parsing: filter failed");
+    }
+
+    //An exception from the callback is rethrown by waitForParses(), once
+    t.setLayerFilter(nullptr);
+    t.parseMany({path}, [](size_t, std::unique_ptr<tson::Map>) { throw std::logic_error("callback failed"); });
+    REQUIRE_THROWS_AS(t.waitForParses(), std::logic_error);
+    REQUIRE_NOTHROW(t.waitForParses());
+
+    REQUIRE(t.parseAsync(path).get()->getStatus() == tson::ParseStatus::OK);
+}
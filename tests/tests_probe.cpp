@@ -0,0 +1,153 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+static void CheckSameLayers(const std::vector<tson::MapInfo::LayerInfo> &info, std::vector<tson::Layer> &layers)
+{
+    REQUIRE(info.size() == layers.size());
+    for(size_t i = 0; i < layers.size(); ++i)
+    {
+        REQUIRE(info[i].id == layers[i].getId());
+        REQUIRE(info[i].name == layers[i].getName());
+        REQUIRE(info[i].type == layers[i].getType());
+        CheckSameLayers(info[i].layers, layers[i].getLayers());
+    }
+}
+
+static void CheckSameMap(const tson::MapInfo &info, tson::Map &map)
+{
+    REQUIRE(info.status == tson::ParseStatus::OK);
+    REQUIRE(info.isMap());
+    REQUIRE(info.size == map.getSize());
+    REQUIRE(info.tileSize == map.getTileSize());
+    REQUIRE(info.orientation == map.getOrientation());
+    REQUIRE(info.infinite == map.isInfinite());
+    REQUIRE(info.classType == map.getClassType());
+    CheckSameLayers(info.layers, map.getLayers());
+
+    REQUIRE(info.tilesets.size() == map.getTilesets().size());
+    for(size_t i = 0; i < info.tilesets.size(); ++i)
+    {
+        REQUIRE(info.tilesets[i].firstgid == map.getTilesets()[i].getFirstgid());
+        if(info.tilesets[i].source.empty())
+            REQUIRE(info.tilesets[i].name == map.getTilesets()[i].getName());
+    }
+}
+
+TEST_CASE( "Probe json maps - expects the same info as a full parse", "[probe][json]" )
+{
+    tson::MapProbe probe;
+    tson::Tileson t;
+
+    for(const char *file : {"ultimate_test.json", "ultimate_test_v1.9.json", "infinite.json", "ultimate_test_v1.5.json", "withtemplates.json"})
+    {
+        fs::path path = GetPathWithBase(fs::path("test-maps") / file);
+        std::unique_ptr<tson::Map> map = t.parse(path);
+        tson::MapInfo info = probe.probe(path);
+        REQUIRE(info.path == path);
+        CheckSameMap(info, *map);
+    }
+
+    tson::MapInfo info = probe.probe(GetPathWithBase("test-maps/ultimate_test_v1.9.json"));
+    REQUIRE(info.classType == "DummyClass");
+    REQUIRE(info.properties.getSize() == 1);
+    REQUIRE(info.properties.getValue<bool>("isDummy"));
+
+    info = probe.probe(GetPathWithBase("test-maps/ultimate_test_v1.5.json"));
+    REQUIRE(info.tilesets[0].source == "demo-tileset.json");
+}
+
+TEST_CASE( "Probe tmx maps - expects the same info as a full parse", "[probe][tmx]" )
+{
+    tson::MapProbe probe;
+    tson::Tileson t {std::make_unique<tson::TmxJson>()};
+
+    for(const char *file : {"ultimate_test.tmx", "infinite.tmx", "tmx/features.tmx", "tmx/simple_map_zlib.tmx"})
+    {
+        fs::path path = GetPathWithBase(fs::path("test-maps") / file);
+        std::unique_ptr<tson::Map> map = t.parse(path);
+        CheckSameMap(probe.probe(path), *map);
+    }
+
+    tson::MapInfo info = probe.probe(GetPathWithBase("test-maps/tmx/features.tmx"));
+    REQUIRE(info.classType == "Level");
+    REQUIRE(info.tilesets[0].source == "demo-tileset.tsx");
+    REQUIRE(info.layers[1].type == tson::LayerType::Group);
+    REQUIRE(info.layers[1].layers[0].name == "Shapes");
+    REQUIRE(info.properties.getSize() == 3);
+    REQUIRE(info.properties.getValue<std::string>("description") == "First line & more\nSecond line");
+    REQUIRE(info.properties.getValue<int>("level") == 3);
+
+    //Tilesets are not maps
+    info = probe.probe(GetPathWithBase("test-maps/tmx/demo-tileset.tsx"));
+    REQUIRE(info.status == tson::ParseStatus::OK);
+    REQUIRE(info.type == "tileset");
+    REQUIRE(!info.isMap());
+}
+
+TEST_CASE( "Probe broken and missing maps - expects an error status", "[probe]" )
+{
+    tson::MapProbe probe;
+    REQUIRE(probe.probe(GetPathWithBase("test-maps/missing.json")).status == tson::ParseStatus::FileNotFound);
+
+    for(std::string const data : {R"({"width": 10, "layers": [{"name": "a", "data": [1, 2})", R"({"orientation": "orth)", "<map width=\"2\"><layer></map>", "not a map"})
+        REQUIRE(probe.probe(data.data(), data.size()).status == tson::ParseStatus::ParseError);
+
+    //Strings with escapes and brackets are skipped and read correctly
+    std::string const json = R"({"type": "map", "layers": [{"name": "a\"[{\\", "type": "tilelayer", "data": ["}", "\\"]}], "orientation": "isometric", "width": 3})";
+    tson::MapInfo info = probe.probe(json.data(), json.size());
+    REQUIRE(info.status == tson::ParseStatus::OK);
+    REQUIRE(info.layers[0].name == "a\"[{\\");
+    REQUIRE(info.orientation == "isometric");
+    REQUIRE(info.size.x == 3);
+
+    //A \u escape needs four digits before the closing quote
+    std::string const unicode = R"({"type": "map", "orientation": "\u00e9", "layers": [{"name": "\u00e"}], "width": 3})";
+    REQUIRE(probe.probe(unicode.data(), unicode.size()).status == tson::ParseStatus::ParseError);
+    std::string const valid = R"({"type": "map", "orientation": "\u00e9", "width": 3})";
+    info = probe.probe(valid.data(), valid.size());
+    REQUIRE(info.status == tson::ParseStatus::OK);
+    REQUIRE(info.orientation == "\xc3\xa9");
+}
+
+TEST_CASE( "Probe a directory of maps on several threads - expects every map in path order", "[probe]" )
+{
+    tson::MapProbe probe;
+    fs::path folder = GetPathWithBase("test-maps");
+
+    std::vector<tson::MapInfo> infos = probe.probeDirectory(folder, 4);
+    std::vector<tson::MapInfo> single = probe.probeDirectory(folder, 1);
+    REQUIRE(infos.size() == single.size());
+    REQUIRE(infos.size() >= 20);
+
+    for(size_t i = 0; i < infos.size(); ++i)
+    {
+        REQUIRE(infos[i].path == single[i].path);
+        REQUIRE(infos[i].size == single[i].size);
+        REQUIRE(infos[i].layers.size() == single[i].layers.size());
+        REQUIRE((infos[i].isMap() || infos[i].status != tson::ParseStatus::OK));
+        if(i > 0)
+            REQUIRE(infos[i - 1].path < infos[i].path);
+    }
+
+    auto find = [&](const fs::path &path)
+    {
+        return std::find_if(infos.begin(), infos.end(), [&](const tson::MapInfo &info) { return info.path == folder / path; });
+    };
+    REQUIRE(find("ultimate_test.json") != infos.end());
+    REQUIRE(find("tmx/features.tmx") != infos.end());
+    REQUIRE(find("demo-tileset.json") == infos.end());
+
+    std::vector<tson::MapInfo> topLevel = probe.probeDirectory(folder, 2, false);
+    REQUIRE(topLevel.size() < infos.size());
+
+    //A folder that cannot be read has no maps
+    REQUIRE(probe.probeDirectory(folder / "missing", 2).empty());
+}
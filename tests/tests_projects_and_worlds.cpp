@@ -31,6 +31,200 @@ TEST_CASE("Parse world - Expect 4 maps and parsed data", "[project][world]")
     REQUIRE(world.getType() == "world");
 }
 
+TEST_CASE("World streamer - load the maps near the focus within a byte budget", "[project][world]")
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/project/world/test.world"));
+    tson::World world{pathToUse};
+    REQUIRE(world.getMapData().size() == 4);
+
+    //Memory of each map, measured up front
+    std::vector<size_t> bytes;
+    tson::Tileson t;
+    for(const auto &data : world.getMapData())
+    {
+        std::unique_ptr<tson::Map> map = t.parse(data.path);
+        REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+        bytes.push_back(tson::WorldStreamer::EstimateBytes(*map));
+    }
+
+    //Centers of w1, w2, w3 and w4
+    std::vector<tson::Vector2f> centers {{-128.f, -64.f}, {128.f, -64.f}, {-128.f, 64.f}, {128.f, 64.f}};
+
+    tson::WorldStreamer streamer {world, 2};
+    streamer.setFocus(centers[1], 10.f);
+    streamer.flush();
+    REQUIRE(streamer.getLoadedMaps() == std::vector<size_t>{1});
+    REQUIRE(streamer.getMap(1) != nullptr);
+    REQUIRE(streamer.getMap(1)->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(streamer.getMap(0) == nullptr);
+    REQUIRE(streamer.getUsedBytes() == bytes[1]);
+
+    streamer.setFocus(centers[0], 10.f);
+    streamer.flush();
+    REQUIRE(streamer.isLoaded(0));
+    REQUIRE(streamer.isLoaded(1));
+
+    //w2 was in focus longer ago than w1, so it is evicted first to make room for w4
+    streamer.setByteBudget(bytes[0] + bytes[3]);
+    streamer.setFocus(centers[3], 10.f);
+    streamer.update();
+    REQUIRE(!streamer.isLoaded(1));
+    REQUIRE(streamer.isLoaded(0));
+    streamer.flush();
+    REQUIRE(streamer.isLoaded(3));
+    REQUIRE(streamer.getUsedBytes() == bytes[0] + bytes[3]);
+
+    //Maps in focus that do not fit are not loaded
+    streamer.setByteBudget(1);
+    streamer.setFocus(centers[2], 10.f);
+    streamer.update();
+    REQUIRE(streamer.getLoadedMaps().empty());
+    REQUIRE(!streamer.isPending(2));
+    REQUIRE(streamer.getUsedBytes() == 0);
+
+    //A radius covering everything, with enough room
+    streamer.setByteBudget(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+    streamer.setFocus({0.f, 0.f}, 1000.f);
+    streamer.flush();
+    REQUIRE(streamer.getLoadedMaps().size() == 4);
+    for(size_t i = 0; i < 4; ++i)
+        REQUIRE(streamer.getMap(i)->getSize() == t.parse(world.getMapData()[i].path)->getSize());
+}
+
+TEST_CASE("World streamer - a map that fails to parse is not loaded, and not counted against the budget", "[project][world]")
+{
+    //A world with w1 and a map that is not valid json
+    fs::path mapPath = GetPathWithBase(fs::path("test-maps/project/world/w1.json"));
+    fs::path corruptPath = fs::temp_directory_path() / "tileson_streamer_corrupt.json";
+    fs::path worldPath = fs::temp_directory_path() / "tileson_streamer_corrupt.world";
+    {
+        std::ofstream file(corruptPath);
+        file << R"({"type": "map", "layers": [)";
+    }
+    {
+        std::ofstream file(worldPath);
+        file << R"({"type": "world", "onlyShowAdjacentMaps": false, "maps": [)";
+        file << R"({"fileName": ")" << corruptPath.generic_string() << R"(", "x": 0, "y": 0, "width": 256, "height": 128}, )";
+        file << R"({"fileName": ")" << mapPath.generic_string() << R"(", "x": 256, "y": 0, "width": 256, "height": 128})";
+        file << "]}";
+    }
+
+    tson::World world {worldPath};
+    REQUIRE(world.getMapData().size() == 2);
+
+    tson::Tileson t;
+    size_t bytes = tson::WorldStreamer::EstimateBytes(*t.parse(mapPath));
+
+    tson::WorldStreamer streamer {world, 2};
+    streamer.setByteBudget(bytes);
+    streamer.setFocus({256.f, 64.f}, 1000.f);
+    streamer.flush();
+    REQUIRE(streamer.getLoadedMaps() == std::vector<size_t>{1});
+    REQUIRE(streamer.getMap(0) == nullptr);
+    REQUIRE(!streamer.isLoaded(0));
+    REQUIRE(streamer.getUsedBytes() == bytes);
+
+    //It is not queued again
+    streamer.update();
+    REQUIRE(!streamer.isPending(0));
+
+    fs::remove(worldPath);
+    fs::remove(corruptPath);
+}
+
+TEST_CASE("World streamer - a map whose parsing throws fails, and the threads keep going", "[project][world]")
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/project/world/test.world"));
+    tson::World world{pathToUse};
+    REQUIRE(world.getMapData().size() == 4);
+
+    //Throws while parsing every map
+    tson::WorldStreamer throwingParser {world, []()
+    {
+        auto parser = std::make_unique<tson::Tileson>();
+        parser->setLayerFilter([](const tson::Layer &) -> bool { throw std::runtime_error("Filter failed"); });
+        return parser;
+    }, 2};
+
+    //Throws when the parser of a thread is created
+    tson::WorldStreamer throwingFactory {world, []() -> std::unique_ptr<tson::Tileson>
+    {
+        throw std::runtime_error("Factory failed");
+    }, 2};
+
+    for(tson::WorldStreamer *streamer : {&throwingParser, &throwingFactory})
+    {
+        streamer->setFocus({0.f, 0.f}, 1000.f);
+        streamer->flush();
+        REQUIRE(streamer->getLoadedMaps().empty());
+        REQUIRE(streamer->getUsedBytes() == 0);
+        for(size_t i = 0; i < 4; ++i)
+        {
+            REQUIRE(streamer->getMap(i) == nullptr);
+            REQUIRE(!streamer->isPending(i));
+        }
+    }
+}
+
+TEST_CASE("Load the maps of a world in parallel - expect the maps in the order of the map data, and failed maps reported", "[project][world]")
+{
+    //A world with the maps of test.world in reverse, and one that does not exist
+    fs::path folder = GetPathWithBase(fs::path("test-maps/project/world"));
+    fs::path worldPath = fs::temp_directory_path() / "tileson_parallel.world";
+    {
+        std::ofstream file(worldPath);
+        file << R"({"type": "world", "onlyShowAdjacentMaps": false, "maps": [)";
+        for(const char *name : {"w4.json", "w3.json", "missing.json", "w2.json", "w1.json"})
+        {
+            file << R"({"fileName": ")" << (folder / name).generic_string() << R"(", "x": 0, "y": 0, "width": 256, "height": 128})";
+            file << ((std::string_view(name) == "w1.json") ? "" : ", ");
+        }
+        file << "]}";
+    }
+
+    tson::World world {worldPath};
+    REQUIRE(world.getMapData().size() == 5);
+
+    tson::Tileson t;
+    t.setThreadCount(3);
+    REQUIRE(world.loadMaps(&t) == 4);
+    REQUIRE(world.getMaps().size() == 5);
+    REQUIRE(world.getFailedMaps() == std::vector<size_t>{2});
+    REQUIRE(world.getMaps()[2]->getStatus() == tson::ParseStatus::FileNotFound);
+
+    tson::Tileson sequential;
+    for(size_t i : {0, 1, 3, 4})
+    {
+        std::unique_ptr<tson::Map> expected = sequential.parse(world.getMapData()[i].path);
+        REQUIRE(world.getMaps()[i]->getStatus() == tson::ParseStatus::OK);
+        REQUIRE(world.getMaps()[i]->getLayers().size() == expected->getLayers().size());
+        REQUIRE(world.getMaps()[i]->getLayers()[0].getData() == expected->getLayers()[0].getData());
+        REQUIRE(world.getMaps()[i]->getTilesets().size() == expected->getTilesets().size());
+    }
+
+    //The parser gets its own caches back
+    REQUIRE(t.getTilesetCache() == nullptr);
+    REQUIRE(t.getTemplateCache() == nullptr);
+
+    //A cache of the parser is used instead of the world's own
+    auto tilesetCache = std::make_shared<tson::TilesetCache>();
+    t.setTilesetCache(tilesetCache);
+    t.setThreadCount(1);
+    REQUIRE(world.loadMaps(&t) == 4);
+    REQUIRE(t.getTilesetCache() == tilesetCache);
+
+    //Maps whose parsing throws are reported as failed, and every map is still loaded
+    t.setThreadCount(3);
+    t.setLayerFilter([](const tson::Layer &) -> bool { throw std::runtime_error("filter failed"); });
+    REQUIRE(world.loadMaps(&t) == 0);
+    REQUIRE(world.getMaps().size() == 5);
+    REQUIRE(world.getFailedMaps() == std::vector<size_t>{0, 1, 2, 3, 4});
+    REQUIRE(world.getMaps()[0]->getStatus() == tson::ParseStatus::ParseError);
+    REQUIRE(world.getMaps()[0]->getStatusMessage() == "Exception while parsing: filter failed");
+    REQUIRE(world.getMaps()[2]->getStatus() == tson::ParseStatus::FileNotFound);
+    fs::remove(worldPath);
+}
+
 TEST_CASE("Parse project - expect right number of files and folders", "[project][world]")
 {
     
@@ -377,6 +571,34 @@ TEST_CASE("Parse Tiled v1.10 - classes used as property values",
     REQUIRE(tilesetClass->get<tson::TiledClass>("Transform").get<float>("Y") == 10.);
 }
 
+TEST_CASE("Load a project map from a snapshot - expect classes and enums resolved with the project", "[project][map][enum][class][snapshot]")
+{
+    tson::Project project{GetPathWithBase(fs::path("test-maps/project-v1.9/test.tiled-project"))};
+    tson::Tileson t{&project};
+    std::unique_ptr<tson::Map> parsed = t.parse(GetPathWithBase(fs::path("test-maps/project-v1.9/maps/map1.json")));
+    REQUIRE(parsed->getStatus() == tson::ParseStatus::OK);
+
+    std::vector<uint8_t> snapshot = tson::MapSnapshot::Serialize(*parsed);
+    std::unique_ptr<tson::Map> m = tson::MapSnapshot::Deserialize(snapshot.data(), snapshot.size(), &project, t.decompressors());
+    tiledProjectEnumAndClassBaseTest(m.get());
+
+    tson::Layer *objectLayer = m->getLayer("Da Object Layer");
+    tson::TiledClass *objectClass = objectLayer->firstObj("TestObject")->getClass();
+    REQUIRE(objectClass != nullptr);
+    REQUIRE(objectClass->getName() == "Enemy");
+    REQUIRE(objectClass->get<int>("hp") == 10);
+    REQUIRE(objectClass->get<std::string>("name") == "Galderino");
+
+    tson::EnumValue numEnum = objectLayer->firstObj("TestObjectEnum")->get<tson::EnumValue>("num_enum");
+    tson::EnumValue parsedNumEnum = parsed->getLayer("Da Object Layer")->firstObj("TestObjectEnum")->get<tson::EnumValue>("num_enum");
+    REQUIRE(numEnum.getDefinition() == parsedNumEnum.getDefinition());
+    REQUIRE(numEnum.getValue() == parsedNumEnum.getValue());
+
+    tson::TiledClass *tileClass = m->getTileset("demo-tileset")->getTile(1)->getClass();
+    REQUIRE(tileClass != nullptr);
+    REQUIRE(tileClass->getName() == parsed->getTileset("demo-tileset")->getTile(1)->getClass()->getName());
+}
+
 TEST_CASE("Parse Tiled v1.10 - tile DrawingRect is respected when different from the map tile grid",
           "[project][map][tileset][tile]")
 {
@@ -419,3 +641,76 @@ TEST_CASE("Parse Tiled v1.10 - tileset full image path resolves to the image fil
 
     REQUIRE(fs::exists(tileset->getFullImagePath()));
 }
+
+TEST_CASE("Parse world - Expect maps from patterns, and spatial queries", "[project][world]")
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/world-patterns/patterns.world"));
+    tson::World world{pathToUse};
+    REQUIRE(world.getMapData().size() == 5);
+    REQUIRE(world.contains("start.json"));
+    REQUIRE(world.contains("chunk-1-1.json"));
+    REQUIRE(!world.contains("patterns.world"));
+    REQUIRE(world.get("chunk-1-0.json")->position == tson::Vector2i(256, 0));
+    REQUIRE(world.get("chunk-0-1.json")->position == tson::Vector2i(0, 128));
+    REQUIRE(world.get("chunk-1-1.json")->size == tson::Vector2i(256, 128));
+    REQUIRE(fs::exists(world.get("chunk-1-1.json")->path));
+
+    std::vector<size_t> maps;
+    REQUIRE(world.mapsIntersecting({0, 0, 256, 128}, maps) == 1);
+    REQUIRE(world.getMapData()[maps[0]].fileName == "chunk-0-0.json");
+    //Growing a map by one pixel gives its neighbours
+    REQUIRE(world.mapsIntersecting({-1, -1, 258, 130}, maps) == 5);
+    REQUIRE(world.mapsIntersecting({1000, 1000, 10, 10}, maps) == 0);
+
+    REQUIRE(world.mapAt({300, 10})->fileName == "chunk-1-0.json");
+    REQUIRE(world.mapAt({-10, 5})->fileName == "start.json");
+    REQUIRE(world.mapAt({-10, -10}) == nullptr);
+    REQUIRE(world.mapAt({512, 0}) == nullptr);
+}
+
+TEST_CASE("Parse world - Spatial queries give the same maps as a linear search", "[project][world]")
+{
+    uint32_t random = 4242;
+    auto next = [&](int range) { random = random * 1103515245u + 12345u; return static_cast<int>((random >> 8) % static_cast<uint32_t>(range)); };
+
+    fs::path path = fs::temp_directory_path() / "tileson_spatial_test.world";
+    {
+        std::ofstream file(path);
+        file << R"({"type": "world", "onlyShowAdjacentMaps": false, "maps": [)";
+        for(int i = 0; i < 2000; ++i)
+            file << ((i > 0) ? "," : "") << R"({"fileName": "m)" << i << R"(.json", "x": )" << next(20000) - 10000 << R"(, "y": )" << next(20000) - 10000
+                 << R"(, "width": )" << 1 + next(1500) << R"(, "height": )" << 1 + next(800) << "}";
+        file << "]}";
+    }
+    tson::World world{path};
+    fs::remove(path);
+    const std::vector<tson::WorldMapData> &data = world.getMapData();
+    REQUIRE(data.size() == 2000);
+
+    std::vector<size_t> maps;
+    for(int i = 0; i < 200; ++i)
+    {
+        tson::Rect rect {next(24000) - 12000, next(24000) - 12000, 1 + next(3000), 1 + next(3000)};
+        std::vector<size_t> expected;
+        for(size_t m = 0; m < data.size(); ++m)
+        {
+            if(data[m].position.x < rect.x + rect.width && rect.x < data[m].position.x + data[m].size.x &&
+               data[m].position.y < rect.y + rect.height && rect.y < data[m].position.y + data[m].size.y)
+                expected.push_back(m);
+        }
+        world.mapsIntersecting(rect, maps);
+        REQUIRE(maps == expected);
+
+        tson::Vector2i point {rect.x, rect.y};
+        const tson::WorldMapData *first = nullptr;
+        for(const auto &item : data)
+        {
+            if(point.x >= item.position.x && point.y >= item.position.y && point.x < item.position.x + item.size.x && point.y < item.position.y + item.size.y)
+            {
+                first = &item;
+                break;
+            }
+        }
+        REQUIRE(world.mapAt(point) == first);
+    }
+}
@@ -0,0 +1,516 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+#include <algorithm>
+
+static std::unique_ptr<tson::Layer> CreateLayerFromString(const std::string &str)
+{
+    tson::Json11 json;
+    if(!json.parse(str.data(), str.size()))
+        return nullptr;
+
+    return std::make_unique<tson::Layer>(json, nullptr);
+}
+
+static std::vector<int> ToIds(const std::vector<tson::Object *> &objects)
+{
+    std::vector<int> ids;
+    for(const auto *obj : objects)
+        ids.push_back(obj->getId());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static const std::string OBJECT_LAYER_JSON = R"({
+    "name": "objects", "type": "objectgroup", "opacity": 1, "visible": true, "x": 0, "y": 0,
+    "objects": [
+        {"id": 1, "name": "box", "type": "", "x": 0, "y": 0, "width": 10, "height": 10, "rotation": 0, "visible": true},
+        {"id": 2, "name": "poly", "type": "", "x": 100, "y": 100, "width": 0, "height": 0, "rotation": 0, "visible": true,
+         "polygon": [{"x": 0, "y": 0}, {"x": 50, "y": 0}, {"x": 25, "y": -40}]},
+        {"id": 3, "name": "rotated", "type": "", "x": 300, "y": 300, "width": 20, "height": 10, "rotation": 90, "visible": true},
+        {"id": 4, "name": "tile", "type": "", "gid": 1, "x": 50, "y": 50, "width": 16, "height": 16, "rotation": 0, "visible": true},
+        {"id": 5, "name": "point", "type": "", "x": 200, "y": 200, "width": 0, "height": 0, "rotation": 0, "visible": true, "point": true},
+        {"id": 6, "name": "box", "type": "", "x": 5, "y": 5, "width": 400, "height": 2, "rotation": 0, "visible": true}
+    ]
+})";
+
+TEST_CASE( "Spatial index - bounds take rotation, polygons and tile objects into account", "[spatial][object]" )
+{
+    auto layer = CreateLayerFromString(OBJECT_LAYER_JSON);
+    REQUIRE(layer != nullptr);
+    REQUIRE(layer->getObjects().size() == 6);
+
+    float minX, minY, maxX, maxY;
+    tson::SpatialIndex::CalculateBounds(*layer->getObj(2), minX, minY, maxX, maxY);
+    REQUIRE(tson::Tools::Equal(minX, 100.f));
+    REQUIRE(tson::Tools::Equal(minY, 60.f));
+    REQUIRE(tson::Tools::Equal(maxX, 150.f));
+    REQUIRE(tson::Tools::Equal(maxY, 100.f));
+
+    //Rotated 90 degrees clockwise around its position: width goes downwards, height goes to the left
+    tson::SpatialIndex::CalculateBounds(*layer->getObj(3), minX, minY, maxX, maxY);
+    REQUIRE(std::abs(minX - 290.f) < 0.001f);
+    REQUIRE(std::abs(minY - 300.f) < 0.001f);
+    REQUIRE(std::abs(maxX - 300.f) < 0.001f);
+    REQUIRE(std::abs(maxY - 320.f) < 0.001f);
+
+    //Tile objects are anchored at the bottom-left corner
+    tson::SpatialIndex::CalculateBounds(*layer->getObj(4), minX, minY, maxX, maxY);
+    REQUIRE(tson::Tools::Equal(minY, 34.f));
+    REQUIRE(tson::Tools::Equal(maxY, 50.f));
+}
+
+TEST_CASE( "Spatial index - rect, point and radius queries give the same result as a linear scan", "[spatial][object]" )
+{
+    auto layer = CreateLayerFromString(OBJECT_LAYER_JSON);
+    REQUIRE(layer != nullptr);
+
+    const tson::SpatialIndex &index = layer->buildSpatialIndex(16.f);
+    REQUIRE(index.size() == 6);
+    REQUIRE(index.getCellSize() >= 16.f);
+
+    REQUIRE(ToIds(layer->queryRect({0, 0, 20, 20})) == std::vector<int>{1, 6});
+    REQUIRE(ToIds(layer->queryRect({40, 30, 80, 50})) == std::vector<int>{2, 4});
+    REQUIRE(ToIds(layer->queryRect({1000, 1000, 20, 20})).empty());
+    REQUIRE(ToIds(layer->queryPoint({295.f, 310.f})) == std::vector<int>{3});
+    REQUIRE(ToIds(layer->queryPoint({200.f, 200.f})) == std::vector<int>{5});
+    REQUIRE(ToIds(layer->queryPoint({300.f, 6.f})) == std::vector<int>{6});
+    REQUIRE(ToIds(layer->queryRadius({20.f, 20.f}, 5.f)).empty());
+    REQUIRE(ToIds(layer->queryRadius({20.f, 20.f}, 15.f)) == std::vector<int>{1, 6});
+
+    //Brute force comparison on a grid of query rects
+    for(int y = -50; y < 400; y += 37)
+    {
+        for(int x = -50; x < 500; x += 41)
+        {
+            std::vector<int> expected;
+            for(auto &obj : layer->getObjects())
+            {
+                float minX, minY, maxX, maxY;
+                tson::SpatialIndex::CalculateBounds(obj, minX, minY, maxX, maxY);
+                if(minX <= x + 60 && maxX >= x && minY <= y + 45 && maxY >= y)
+                    expected.push_back(obj.getId());
+            }
+            std::sort(expected.begin(), expected.end());
+            REQUIRE(ToIds(layer->queryRect({x, y, 60, 45})) == expected);
+        }
+    }
+}
+
+TEST_CASE( "Spatial index - query objects of a parsed map", "[spatial][object]" )
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(pathToUse);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::Layer *layer = map->getLayer("Object Layer");
+    REQUIRE(layer != nullptr);
+    REQUIRE(layer->getSpatialIndex().empty());
+
+    //The coins are tile objects placed along y = 48, from x = 144 to x = 256
+    auto coins = layer->queryRect({150, 40, 40, 4});
+    REQUIRE(!layer->getSpatialIndex().empty());
+    REQUIRE(ToIds(coins) == std::vector<int>{1, 2, 3});
+
+    std::vector<size_t> indices;
+    layer->getSpatialIndex().queryPoint(196.f, 120.f, indices);
+    REQUIRE(indices.size() == 1);
+    REQUIRE(layer->getObjects()[indices[0]].getName() == "spike");
+}
+
+static const std::string MAP_WITH_GROUPS_JSON = R"({
+    "width": 4, "height": 4, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 6,
+    "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map", "tilesets": [],
+    "layers": [
+        {"name": "spawns", "type": "objectgroup", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "objects": [
+            {"id": 1, "name": "door", "type": "", "x": 0, "y": 0, "width": 8, "height": 8, "rotation": 0, "visible": true},
+            {"id": 2, "name": "lever", "type": "", "x": 8, "y": 8, "width": 8, "height": 8, "rotation": 0, "visible": true,
+             "properties": [{"name": "target", "type": "object", "value": 5}, {"name": "broken", "type": "object", "value": 99}]}
+         ]},
+        {"name": "group", "type": "group", "id": 2, "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "layers": [
+            {"name": "nested", "type": "objectgroup", "id": 3, "opacity": 1, "visible": true, "x": 0, "y": 0,
+             "objects": [
+                {"id": 4, "name": "door", "type": "", "x": 32, "y": 32, "width": 8, "height": 8, "rotation": 0, "visible": true},
+                {"id": 5, "name": "gate", "type": "", "x": 48, "y": 48, "width": 8, "height": 8, "rotation": 0, "visible": true}
+             ]}
+         ]}
+    ]
+})";
+
+TEST_CASE( "Map-wide object lookup - find objects by id and name in all layers, including groups", "[object][lookup]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(MAP_WITH_GROUPS_JSON.data(), MAP_WITH_GROUPS_JSON.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::Object *gate = map->getObj(5);
+    REQUIRE(gate != nullptr);
+    REQUIRE(gate->getName() == "gate");
+    REQUIRE(map->getObjLayer(5) != nullptr);
+    REQUIRE(map->getObjLayer(5)->getName() == "nested");
+    REQUIRE(map->getObjLayer(1)->getName() == "spawns");
+    REQUIRE(map->getObj(3) == nullptr);
+    REQUIRE(map->getObjLayer(3) == nullptr);
+
+    REQUIRE(map->firstObj("door") == map->getObj(1));
+    REQUIRE(map->firstObj("nothing") == nullptr);
+    std::vector<tson::Object *> doors = map->getObjsByName("door");
+    REQUIRE(doors.size() == 2);
+    REQUIRE(doors[0]->getId() == 1);
+    REQUIRE(doors[1]->getId() == 4);
+    REQUIRE(map->getObjsByName("nothing").empty());
+
+    tson::Object *lever = map->getObj(2);
+    REQUIRE(map->resolveObjectRef(lever->getProp("target")) == gate);
+    REQUIRE(map->resolveObjectRef(lever->getProp("broken")) == nullptr);
+    REQUIRE(map->resolveObjectRef(lever->getProp("not_existing")) == nullptr);
+}
+
+TEST_CASE( "Object buckets - get objects by name, type and class without copying", "[object][lookup]" )
+{
+    auto layer = CreateLayerFromString(OBJECT_LAYER_JSON);
+    REQUIRE(layer != nullptr);
+
+    tson::IndexedRange<tson::Object> boxes = layer->getObjsByName("box");
+    REQUIRE(boxes.size() == 2);
+    REQUIRE(&boxes[0] == layer->getObj(1));
+    REQUIRE(&boxes[1] == layer->getObj(6));
+    REQUIRE(boxes.indexAt(1) == 5);
+    REQUIRE(layer->getObjsByName("nothing").empty());
+    REQUIRE(layer->getObjsByName("nothing").begin() == layer->getObjsByName("nothing").end());
+
+    std::vector<int> ids;
+    for(tson::Object &obj : layer->getObjsByType(tson::ObjectType::Rectangle))
+        ids.push_back(obj.getId());
+    REQUIRE(ids == std::vector<int>{1, 3, 6});
+    REQUIRE(layer->getObjsByType(tson::ObjectType::Polygon).size() == 1);
+    REQUIRE(layer->getObjsByType(tson::ObjectType::Polygon).begin()->getName() == "poly");
+    REQUIRE(layer->getObjsByType(tson::ObjectType::Text).empty());
+    REQUIRE(layer->getObjsByType(tson::ObjectType::Template).empty());
+    REQUIRE(layer->getObjsByType(tson::ObjectType::Polygon).size() == layer->getObjectsByType(tson::ObjectType::Polygon).size());
+
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(pathToUse);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::Layer *objectLayer = map->getLayer("Object Layer");
+    REQUIRE(objectLayer->getObjsByClass("Coin").size() == 8);
+    REQUIRE(objectLayer->getObjsByClass("Enemy").size() == 2);
+    REQUIRE(objectLayer->getObjsByClass("Spike")[0].getName() == "spike");
+    REQUIRE(objectLayer->getObjsByName("goomba").size() == objectLayer->getObjectsByName("goomba").size());
+}
+
+TEST_CASE( "Tile regions - iterate the tiles of a finite layer in row-major order", "[tile][region]" )
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(pathToUse);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::Layer *layer = map->getLayer("Main Layer");
+    REQUIRE(layer != nullptr);
+
+    size_t count = 0;
+    int lastIndex = -1;
+    bool inOrder = true;
+    bool samePositions = true;
+    layer->forEachTileInRegion({0, 0, map->getSize().x, map->getSize().y}, [&](const tson::TileCell &cell)
+    {
+        int index = cell.posInTileUnits.y * map->getSize().x + cell.posInTileUnits.x;
+        inOrder = inOrder && index > lastIndex;
+        lastIndex = index;
+        auto &tileObject = layer->getTileObjects().at({cell.posInTileUnits.x, cell.posInTileUnits.y});
+        samePositions = samePositions && tileObject.getPosition() == cell.position && tileObject.getTile() == cell.tile;
+        ++count;
+    });
+    REQUIRE(count == layer->getTileObjects().size());
+    REQUIRE(inOrder);
+    REQUIRE(samePositions);
+
+    //Everything overlapping the camera must be there, and nothing far away from it
+    tson::Rect camera {40, 24, 100, 70};
+    std::vector<tson::TileCell> visible = layer->getVisibleTiles(camera);
+    size_t overlapping = 0;
+    for(auto &[pos, tileObject] : layer->getTileObjects())
+    {
+        tson::Vector2f p = tileObject.getPosition();
+        if(p.x + 16 > camera.x && p.x < camera.x + camera.width && p.y + 16 > camera.y && p.y < camera.y + camera.height)
+        {
+            ++overlapping;
+            REQUIRE(std::any_of(visible.begin(), visible.end(), [&](const tson::TileCell &cell) { return cell.posInTileUnits == tileObject.getPositionInTileUnits(); }));
+        }
+    }
+    REQUIRE(overlapping > 0);
+    for(auto &cell : visible)
+    {
+        REQUIRE(cell.position.x + 64 >= camera.x);
+        REQUIRE(cell.position.x <= camera.x + camera.width);
+        REQUIRE(cell.position.y + 16 >= camera.y);
+        REQUIRE(cell.position.y - 64 <= camera.y + camera.height);
+    }
+    REQUIRE(layer->getVisibleTiles({-5000, -5000, 100, 100}).empty());
+}
+
+static const std::string PARALLAX_MAP_JSON = R"({
+    "width": 8, "height": 8, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 1,
+    "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map", "tilesets": [
+        {"firstgid": 1, "name": "tiles", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+         "image": "tiles.png", "imagewidth": 32, "imageheight": 32}
+    ],
+    "layers": [
+        {"name": "background", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "width": 8, "height": 8, "offsetx": 4, "offsety": 2, "parallaxx": 0.5, "parallaxy": 1,
+         "data": [1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,
+                  1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1]},
+        {"name": "iso", "type": "tilelayer", "id": 2, "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "width": 8, "height": 8,
+         "data": [1,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+                  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,2]}
+    ]
+})";
+
+TEST_CASE( "Tile regions - camera takes layer offset and parallax into account", "[tile][region]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(PARALLAX_MAP_JSON.data(), PARALLAX_MAP_JSON.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("background");
+
+    //Camera centered at the parallax origin: Only the layer offset is applied
+    tson::Rect camera {-16, -16, 32, 32};
+    REQUIRE(layer->getParallaxOffset(camera) == tson::Vector2f(0.f, 0.f));
+    std::vector<tson::TileCell> visible = layer->getVisibleTiles(camera);
+    REQUIRE(visible.size() == 1);
+    REQUIRE(visible[0].position == tson::Vector2f(4.f, 2.f));
+
+    //The camera moved 64 pixels to the right: The layer with parallax 0.5 moves along with half of that
+    camera = {48, 0, 16, 16};
+    REQUIRE(layer->getParallaxOffset(camera) == tson::Vector2f(28.f, 0.f));
+    visible = layer->getVisibleTiles(camera);
+    REQUIRE(!visible.empty());
+    REQUIRE(visible.front().posInTileUnits == tson::Vector2i(1, 0));
+    REQUIRE(visible.front().position == tson::Vector2f(48.f, 2.f));
+    for(auto &cell : visible)
+        REQUIRE(cell.position.x + 16 >= 48.f);
+}
+
+TEST_CASE( "Tile regions - isometric maps", "[tile][region]" )
+{
+    std::string json = PARALLAX_MAP_JSON;
+    json.replace(json.find("\"orthogonal\""), 12, "\"isometric\"");
+    json.replace(json.find("\"tilewidth\": 16"), 15, "\"tilewidth\": 32");
+
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("iso");
+
+    //The map is a diamond 256 pixels wide and 128 pixels high, with tile 0,0 at the top
+    std::vector<tson::TileCell> all = layer->getVisibleTiles({0, 0, 256, 128});
+    REQUIRE(all.size() == 2);
+    REQUIRE(all[0].position == tson::Vector2f(112.f, 0.f));
+    REQUIRE(all[1].position == tson::Vector2f(112.f, 112.f));
+
+    std::vector<tson::TileCell> top = layer->getVisibleTiles({100, 0, 40, 20});
+    REQUIRE(top.size() == 1);
+    REQUIRE(top[0].gid == 1);
+    REQUIRE(layer->getVisibleTiles({0, 0, 60, 60}).empty());
+}
+
+TEST_CASE( "Tile regions - iterate the chunks of an infinite layer", "[tile][region]" )
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/infinite.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(pathToUse);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("Tile Layer 1");
+    REQUIRE(layer != nullptr);
+    REQUIRE(!layer->getChunks().empty());
+
+    tson::Rect region {-5, -3, 12, 9};
+    std::vector<std::tuple<int, int, uint32_t>> expected;
+    for(int y = region.y; y < region.y + region.height; ++y)
+    {
+        for(int x = region.x; x < region.x + region.width; ++x)
+        {
+            for(auto &chunk : layer->getChunks())
+            {
+                const tson::Vector2i &pos = chunk.getPosition();
+                const tson::Vector2i &size = chunk.getSize();
+                if(x >= pos.x && x < pos.x + size.x && y >= pos.y && y < pos.y + size.y)
+                {
+                    int gid = chunk.getData()[(y - pos.y) * size.x + (x - pos.x)];
+                    if(gid != 0)
+                        expected.emplace_back(x, y, static_cast<uint32_t>(gid));
+                }
+            }
+        }
+    }
+    REQUIRE(!expected.empty());
+
+    std::vector<std::tuple<int, int, uint32_t>> actual;
+    layer->forEachTileInRegion(region, [&](const tson::TileCell &cell)
+    {
+        actual.emplace_back(cell.posInTileUnits.x, cell.posInTileUnits.y, cell.gid);
+        REQUIRE(cell.position == tson::Vector2f(static_cast<float>(cell.posInTileUnits.x * 16), static_cast<float>(cell.posInTileUnits.y * 16)));
+        REQUIRE(cell.tile != nullptr);
+    });
+    REQUIRE(actual == expected);
+}
+
+static const std::string FLIPPED_TILES_MAP_JSON = R"({
+    "width": 3, "height": 1, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 1,
+    "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map",
+    "tilesets": [
+        {"firstgid": 1, "name": "tiles", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+         "image": "tiles.png", "imagewidth": 32, "imageheight": 32}
+    ],
+    "layers": [
+        {"name": "tiles", "type": "tilelayer", "id": 1, "opacity": 0.5, "visible": true, "x": 0, "y": 0,
+         "width": 3, "height": 1, "tintcolor": "#ff0000", "data": [1, 2147483650, 536870913]}
+    ]
+})";
+
+static bool IsVertex(const tson::TileVertex &vertex, float x, float y, float u, float v)
+{
+    return tson::Tools::Equal(vertex.x, x) && tson::Tools::Equal(vertex.y, y) && tson::Tools::Equal(vertex.u, u) && tson::Tools::Equal(vertex.v, v);
+}
+
+TEST_CASE( "Tile batches - vertices with normalized UVs, flips and tint", "[tile][batch]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(FLIPPED_TILES_MAP_JSON.data(), FLIPPED_TILES_MAP_JSON.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("tiles");
+
+    tson::TileBatchBuilder builder;
+    const std::vector<tson::TileBatch> &batches = builder.build(*layer);
+    REQUIRE(batches.size() == 1);
+    REQUIRE(batches[0].tileset == &map->getTilesets()[0]);
+    REQUIRE(batches[0].getImage() == fs::path("tiles.png"));
+    REQUIRE(batches[0].getTileCount() == 3);
+
+    const std::vector<tson::TileVertex> &vertices = batches[0].vertices;
+    REQUIRE(vertices[0].color == 0x800000ffu);
+
+    //Not flipped
+    REQUIRE(IsVertex(vertices[0], 0.f, 0.f, 0.f, 0.f));
+    REQUIRE(IsVertex(vertices[1], 16.f, 0.f, 0.5f, 0.f));
+    REQUIRE(IsVertex(vertices[2], 16.f, 16.f, 0.5f, 0.5f));
+    REQUIRE(IsVertex(vertices[3], 0.f, 16.f, 0.f, 0.5f));
+
+    //Flipped horizontally
+    REQUIRE(IsVertex(vertices[4], 16.f, 0.f, 1.f, 0.f));
+    REQUIRE(IsVertex(vertices[5], 32.f, 0.f, 0.5f, 0.f));
+    REQUIRE(IsVertex(vertices[6], 32.f, 16.f, 0.5f, 0.5f));
+    REQUIRE(IsVertex(vertices[7], 16.f, 16.f, 1.f, 0.5f));
+
+    //Flipped diagonally: x and y are swapped
+    REQUIRE(IsVertex(vertices[8], 32.f, 0.f, 0.f, 0.f));
+    REQUIRE(IsVertex(vertices[9], 48.f, 0.f, 0.f, 0.5f));
+    REQUIRE(IsVertex(vertices[10], 48.f, 16.f, 0.5f, 0.5f));
+    REQUIRE(IsVertex(vertices[11], 32.f, 16.f, 0.5f, 0.f));
+
+    //Buffers are reused between builds
+    const tson::TileVertex *data = vertices.data();
+    builder.build(*layer, {0, 0, 20, 16});
+    REQUIRE(builder.getTileCount() == 2);
+    REQUIRE(builder.getBatches()[0].vertices.data() == data);
+
+    std::vector<uint32_t> indices;
+    tson::TileBatchBuilder::CreateQuadIndices(2, indices);
+    REQUIRE(indices == std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7});
+}
+
+TEST_CASE( "Tile batches - one batch per tileset of a parsed map", "[tile][batch]" )
+{
+    fs::path pathToUse = GetPathWithBase(fs::path("test-maps/ultimate_test.json"));
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(pathToUse);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    tson::Layer *layer = map->getLayer("Main Layer");
+
+    tson::TileBatchBuilder builder;
+    const std::vector<tson::TileBatch> &batches = builder.build(*layer);
+    REQUIRE(!batches.empty());
+    REQUIRE(builder.getTileCount() == layer->getTileObjects().size());
+
+    for(const auto &batch : batches)
+    {
+        for(size_t i = 0; i < batch.getTileCount(); ++i)
+        {
+            const tson::TileVertex &topLeft = batch.vertices[i * 4];
+            const tson::TileVertex &bottomRight = batch.vertices[i * 4 + 2];
+            REQUIRE(topLeft.u >= 0.f);
+            REQUIRE(bottomRight.u <= 1.f);
+            REQUIRE(bottomRight.x > topLeft.x);
+            REQUIRE(bottomRight.y > topLeft.y);
+        }
+    }
+}
+
+static const std::string DRAW_TABLE_MAP_JSON = R"({
+    "width": 2, "height": 1, "tilewidth": 16, "tileheight": 16, "infinite": false, "nextobjectid": 1,
+    "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map",
+    "tilesets": [
+        {"firstgid": 1, "name": "spaced", "tilewidth": 16, "tileheight": 16, "tilecount": 6, "columns": 3, "margin": 1, "spacing": 2,
+         "image": "spaced.png", "imagewidth": 54, "imageheight": 36, "tileoffset": {"x": 2, "y": -4}},
+        {"firstgid": 7, "name": "collection", "tilewidth": 20, "tileheight": 30, "tilecount": 2, "columns": 0, "margin": 0, "spacing": 0,
+         "tiles": [{"id": 0, "image": "a.png", "imagewidth": 20, "imageheight": 30},
+                   {"id": 1, "image": "b.png", "imagewidth": 10, "imageheight": 10, "x": 5, "y": 0, "width": 5, "height": 10}]}
+    ],
+    "layers": [
+        {"name": "tiles", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0,
+         "width": 2, "height": 1, "data": [5, 8]}
+    ]
+})";
+
+TEST_CASE( "Tile draw table - drawing rect and UVs per gid, with margin, spacing and tile offset", "[tile][batch]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(DRAW_TABLE_MAP_JSON.data(), DRAW_TABLE_MAP_JSON.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->getTileDrawTable().size() == 9);
+    REQUIRE(map->getTileDrawInfo(0) == nullptr);
+    REQUIRE(map->getTileDrawInfo(100) == nullptr);
+
+    const tson::TileDrawInfo *info = map->getTileDrawInfo(5);
+    REQUIRE(info != nullptr);
+    REQUIRE(info->tileset == map->getTileset("spaced"));
+    REQUIRE(info->tile != nullptr);
+    REQUIRE(info->tile->getGid() == 5);
+    REQUIRE(info->drawingRect == tson::Rect(19, 19, 16, 16));
+    REQUIRE(tson::Tools::Equal(info->uvTopLeft.x, 19.f / 54.f));
+    REQUIRE(tson::Tools::Equal(info->uvTopLeft.y, 19.f / 36.f));
+    REQUIRE(tson::Tools::Equal(info->uvBottomRight.x, 35.f / 54.f));
+    REQUIRE(tson::Tools::Equal(info->uvBottomRight.y, 35.f / 36.f));
+    REQUIRE(info->tileOffset == tson::Vector2i(2, -4));
+    REQUIRE(map->getTileDrawInfo(5 | tson::FLIPPED_HORIZONTALLY_FLAG) == info);
+
+    //Image collection tiles use their own image and sub-rectangle
+    const tson::TileDrawInfo *collectionInfo = map->getTileDrawInfo(8);
+    REQUIRE(collectionInfo != nullptr);
+    REQUIRE(collectionInfo->tile->getImage() == fs::path("b.png"));
+    REQUIRE(collectionInfo->drawingRect == tson::Rect(5, 0, 5, 10));
+    REQUIRE(tson::Tools::Equal(collectionInfo->uvTopLeft.x, 0.5f));
+    REQUIRE(tson::Tools::Equal(collectionInfo->uvBottomRight.x, 1.f));
+
+    tson::TileBatchBuilder builder;
+    const std::vector<tson::TileBatch> &batches = builder.build(*map->getLayer("tiles"));
+    REQUIRE(batches.size() == 2);
+    REQUIRE(IsVertex(batches[0].vertices[0], 2.f, -4.f, 19.f / 54.f, 19.f / 36.f));
+    REQUIRE(batches[1].getImage() == fs::path("b.png"));
+    REQUIRE(IsVertex(batches[1].vertices[0], 16.f, 6.f, 0.5f, 0.f));
+}
@@ -0,0 +1,252 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+/*!
+ * The gid of every tile in test-maps/region/large.json, which is 256x160 tiles
+ */
+static uint32_t GetLargeMapGid(int x, int y)
+{
+    return static_cast<uint32_t>((x * 7 + y * 13 + (x * y) % 5) % 40) + 1;
+}
+
+static void CheckLargeMapRegion(tson::Layer &layer, const tson::Rect &region)
+{
+    REQUIRE(layer.hasRegion());
+    REQUIRE(layer.getRegionOrigin() == tson::Vector2i(region.x, region.y));
+    REQUIRE(layer.getSize() == tson::Vector2i(region.width, region.height));
+    REQUIRE(layer.getTileBounds() == region);
+
+    const std::vector<uint32_t> &data = layer.getData();
+    REQUIRE(data.size() == static_cast<size_t>(region.width * region.height));
+    for(int y = 0; y < region.height; ++y)
+    {
+        for(int x = 0; x < region.width; ++x)
+            REQUIRE(data[static_cast<size_t>(y * region.width + x)] == GetLargeMapGid(region.x + x, region.y + y));
+    }
+}
+
+static std::unique_ptr<tson::Map> ParseLargeMap(tson::Tileson &t, const tson::Rect &region, const fs::path &path = GetPathWithBase(fs::path("test-maps/region/large.json")))
+{
+    t.setTileRegion(region);
+    std::unique_ptr<tson::Map> map = t.parse(path);
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    return map;
+}
+
+TEST_CASE( "Decode a region of csv, zlib and gzip tile layers - expects only the tiles inside the region", "[region]" )
+{
+    tson::Tileson t;
+    t.decompressors()->add<tson::ZlibDecompressor>();
+    t.decompressors()->add<tson::GzipDecompressor>();
+
+    //The decompressed layers are larger than what the streaming decompression keeps in memory
+    for(const tson::Rect &region : {tson::Rect(37, 101, 50, 40), tson::Rect(0, 0, 8, 2), tson::Rect(0, 159, 256, 1)})
+    {
+        std::unique_ptr<tson::Map> map = ParseLargeMap(t, region);
+        REQUIRE(map->getTileRegion() == region);
+        for(const char *name : {"Csv", "Zlib", "Gzip"})
+            CheckLargeMapRegion(*map->getLayer(name), region);
+    }
+
+    //Clipped to the size of the map
+    std::unique_ptr<tson::Map> map = ParseLargeMap(t, {240, 150, 100, 100});
+    for(const char *name : {"Csv", "Zlib", "Gzip"})
+        CheckLargeMapRegion(*map->getLayer(name), {240, 150, 16, 10});
+
+    map = ParseLargeMap(t, {300, 0, 10, 10});
+    REQUIRE(map->getLayer("Zlib")->getData().empty());
+    REQUIRE(map->getLayer("Zlib")->getSize() == tson::Vector2i(0, 10));
+
+    //Without a region, every tile is decoded
+    map = ParseLargeMap(t, {});
+    REQUIRE(!map->getLayer("Gzip")->hasRegion());
+    REQUIRE(map->getLayer("Gzip")->getData().size() == 256 * 160);
+    REQUIRE(map->getLayer("Gzip")->getData() == map->getLayer("Csv")->getData());
+}
+
+TEST_CASE( "Decode a region of a tile layer - expects tiles at their position in the map", "[region]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = ParseLargeMap(t, {37, 101, 50, 40});
+    tson::Layer &layer = *map->getLayer("Csv");
+
+    REQUIRE(layer.getTileData(40, 110) != nullptr);
+    REQUIRE(layer.getTileData(40, 110)->getGid() == GetLargeMapGid(40, 110));
+    REQUIRE(layer.getTileData(36, 110) == nullptr);
+    REQUIRE(layer.getTileData(0, 0) == nullptr);
+    REQUIRE(layer.getTileData().size() == 50 * 40);
+
+    //Only the part of the rectangle inside the region has tiles
+    std::vector<tson::TileCell> cells;
+    layer.forEachTileInRegion({30, 95, 10, 10}, [&](const tson::TileCell &cell) { cells.push_back(cell); });
+    REQUIRE(cells.size() == 3 * 4);
+    REQUIRE(cells.front().posInTileUnits == tson::Vector2i(37, 101));
+    REQUIRE(cells.front().gid == GetLargeMapGid(37, 101));
+    REQUIRE(cells.front().position == tson::Vector2f(37 * 16, 101 * 16));
+    REQUIRE(cells.back().posInTileUnits == tson::Vector2i(39, 104));
+}
+
+TEST_CASE( "Decode a region of base64, tmx and CBOR maps - expects the same tiles as csv", "[region]" )
+{
+    tson::Rect const region {5, 3, 10, 7};
+    tson::Tileson full;
+    std::unique_ptr<tson::Map> expected = full.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+
+    auto check = [&](tson::Map &map)
+    {
+        REQUIRE(map.getStatus() == tson::ParseStatus::OK);
+        for(auto &layer : expected->getLayers())
+        {
+            if(layer.getType() != tson::LayerType::TileLayer)
+                continue;
+
+            tson::Layer *cropped = map.getLayer(layer.getName());
+            REQUIRE(cropped->hasRegion());
+            REQUIRE(cropped->getSize() == tson::Vector2i(region.width, region.height));
+            for(int y = 0; y < region.height; ++y)
+            {
+                for(int x = 0; x < region.width; ++x)
+                {
+                    size_t const i = static_cast<size_t>(region.x + x + (region.y + y) * layer.getSize().x);
+                    REQUIRE(cropped->getData()[static_cast<size_t>(x + y * region.width)] == layer.getData()[i]);
+                }
+            }
+        }
+    };
+
+    tson::Tileson t;
+    t.setTileRegion(region);
+    check(*t.parse(GetPathWithBase(fs::path("test-maps/ultimate_test_base64.json"))));
+    check(*t.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.json"))));
+
+    tson::Tileson tmx {std::make_unique<tson::TmxJson>()};
+    tmx.setTileRegion(region);
+    std::unique_ptr<tson::Map> tmxMap = tmx.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.tmx")));
+    tson::Tileson fullTmx {std::make_unique<tson::TmxJson>()};
+    expected = fullTmx.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.tmx")));
+    check(*tmxMap);
+
+    std::ifstream file(GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+    std::string error;
+    json11::Json const json = json11::Json::parse(std::string(std::istreambuf_iterator<char>(file), {}), error);
+    REQUIRE(error.empty());
+    std::vector<uint8_t> const cbor = tson::BinaryJson::FromJson(json, tson::BinaryJson::Format::Cbor);
+    tson::Tileson cborParser {std::make_unique<tson::CborJson>()};
+    cborParser.setTileRegion(region);
+    expected = full.parse(GetPathWithBase(fs::path("test-maps/ultimate_test.json")));
+    check(*cborParser.parse(cbor.data(), cbor.size()));
+}
+
+TEST_CASE( "Decode a region of an infinite map - expects only the chunks overlapping the region", "[region]" )
+{
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> full = t.parse(GetPathWithBase(fs::path("test-maps/infinite.json")));
+    tson::Layer &fullLayer = full->getLayers()[0];
+    REQUIRE(fullLayer.getChunks().size() > 1);
+
+    const tson::Chunk &first = fullLayer.getChunks()[0];
+    tson::Rect const region {first.getPosition().x, first.getPosition().y, 1, 1};
+    t.setTileRegion(region);
+    std::unique_ptr<tson::Map> map = t.parse(GetPathWithBase(fs::path("test-maps/infinite.json")));
+    tson::Layer &layer = map->getLayers()[0];
+    REQUIRE(!layer.hasRegion());
+    REQUIRE(layer.getChunks().size() == 1);
+    REQUIRE(layer.getChunks()[0].getPosition() == first.getPosition());
+    REQUIRE(layer.getChunks()[0].getData() == first.getData());
+}
+
+TEST_CASE( "Decode a region with snapshots - expects the region to neither write nor read a snapshot", "[region][snapshot]" )
+{
+    fs::path folder = fs::temp_directory_path() / "tileson_region_snapshot";
+    fs::remove_all(folder);
+    fs::create_directories(folder);
+    fs::path mapPath = folder / "large.json";
+    fs::copy_file(GetPathWithBase(fs::path("test-maps/region/large.json")), mapPath);
+    fs::path snapshotPath = tson::MapSnapshot::GetPath(mapPath);
+
+    tson::Tileson t;
+    t.decompressors()->add<tson::ZlibDecompressor>();
+    t.decompressors()->add<tson::GzipDecompressor>();
+    t.setSnapshotMode(tson::SnapshotMode::ReadWrite);
+    std::unique_ptr<tson::Map> map = ParseLargeMap(t, {37, 101, 50, 40}, mapPath);
+    CheckLargeMapRegion(*map->getLayer("Csv"), {37, 101, 50, 40});
+    REQUIRE(!fs::exists(snapshotPath));
+
+    //The snapshot of the whole map is not used while a region is set
+    map = ParseLargeMap(t, {}, mapPath);
+    REQUIRE(fs::exists(snapshotPath));
+    REQUIRE(map->getLayer("Csv")->getData().size() == 256 * 160);
+    map = ParseLargeMap(t, {0, 0, 8, 2}, mapPath);
+    CheckLargeMapRegion(*map->getLayer("Csv"), {0, 0, 8, 2});
+
+    fs::remove_all(folder);
+}
+
+TEST_CASE( "Save a map decoded as a region - expects snapshots and flat maps to keep the position of the region", "[region][snapshot]" )
+{
+    tson::Tileson t;
+    t.decompressors()->add<tson::ZlibDecompressor>();
+    t.decompressors()->add<tson::GzipDecompressor>();
+    tson::Rect const region {37, 101, 50, 40};
+    std::unique_ptr<tson::Map> map = ParseLargeMap(t, region);
+
+    std::vector<uint8_t> snapshot = tson::MapSnapshot::Serialize(*map);
+    std::unique_ptr<tson::Map> loaded = tson::MapSnapshot::Deserialize(snapshot.data(), snapshot.size(), nullptr, t.decompressors());
+    REQUIRE(loaded->getStatus() == tson::ParseStatus::OK);
+    CheckLargeMapRegion(*loaded->getLayer("Csv"), region);
+    REQUIRE(loaded->getLayer("Csv")->getTileData(40, 110) != nullptr);
+    REQUIRE(loaded->getLayer("Csv")->getTileData(40, 110)->getGid() == GetLargeMapGid(40, 110));
+    REQUIRE(loaded->getLayer("Csv")->getTileData(0, 0) == nullptr);
+
+    std::vector<uint8_t> flat = tson::FlatMap::Serialize(*map);
+    tson::MapView view {flat.data(), flat.size()};
+    REQUIRE(view.isValid());
+    tson::LayerView layer = view.getLayer("Csv");
+    REQUIRE(layer.hasRegion());
+    REQUIRE(layer.getRegionOrigin() == tson::Vector2i(region.x, region.y));
+    REQUIRE(layer.getSize() == tson::Vector2i(region.width, region.height));
+    REQUIRE(layer.getGid(40, 110) == GetLargeMapGid(40, 110));
+    REQUIRE(layer.getGid(36, 110) == 0);
+    REQUIRE(layer.getGid(0, 0) == 0);
+
+    //Layers without a region start at the origin of the map
+    map = ParseLargeMap(t, {});
+    flat = tson::FlatMap::Serialize(*map);
+    tson::MapView whole {flat.data(), flat.size()};
+    REQUIRE(!whole.getLayer("Csv").hasRegion());
+    REQUIRE(whole.getLayer("Csv").getGid(40, 110) == GetLargeMapGid(40, 110));
+}
+
+TEST_CASE( "Stream zlib data through a sink - expects the same bytes as decompressing everything", "[region][inflate]" )
+{
+    //"Hello Hello Hello!" compressed with zlib
+    std::string const base64 = "eJzzSM3JyVfwQJCKADxMBj4=";
+    std::string const compressed = tson::Base64Decompressor().decompress(base64);
+    const auto *data = reinterpret_cast<const uint8_t *>(compressed.data());
+
+    std::vector<uint8_t> all;
+    REQUIRE(tson::Inflate::Zlib(data, compressed.size(), all));
+    REQUIRE(std::string(all.begin(), all.end()) == "Hello Hello Hello!");
+
+    std::vector<uint8_t> streamed;
+    REQUIRE(tson::Inflate::Zlib(data, compressed.size(), [&](const uint8_t *bytes, size_t size)
+    {
+        streamed.insert(streamed.end(), bytes, bytes + size);
+        return true;
+    }));
+    REQUIRE(streamed == all);
+
+    uint8_t out[4] {};
+    REQUIRE(tson::Tools::Base64DecodeRange("AQIDBAUGBwg=", 2, 4, out));
+    REQUIRE(out[0] == 3);
+    REQUIRE(out[3] == 6);
+    REQUIRE(!tson::Tools::Base64DecodeRange("AQIDBAUGBwg=", 7, 4, out));
+}
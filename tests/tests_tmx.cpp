@@ -0,0 +1,343 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+static std::unique_ptr<tson::Map> ParseTmx(const fs::path &path)
+{
+    tson::Tileson t {std::make_unique<tson::TmxJson>()};
+    return t.parse(GetPathWithBase(path));
+}
+
+static std::unique_ptr<tson::Map> ParseJson(const fs::path &path)
+{
+    tson::Tileson t {std::make_unique<tson::Json11>()};
+    return t.parse(GetPathWithBase(path));
+}
+
+static void CheckSameTileset(tson::Tileset &tmx, tson::Tileset &json)
+{
+    REQUIRE(tmx.getName() == json.getName());
+    REQUIRE(tmx.getImage() == json.getImage());
+    REQUIRE(tmx.getImageSize() == json.getImageSize());
+    REQUIRE(tmx.getColumns() == json.getColumns());
+    REQUIRE(tmx.getTileCount() == json.getTileCount());
+    REQUIRE(tmx.getTileSize() == json.getTileSize());
+    REQUIRE(tmx.getMargin() == json.getMargin());
+    REQUIRE(tmx.getSpacing() == json.getSpacing());
+    REQUIRE(tmx.getType() == json.getType());
+    REQUIRE(tmx.getTiles().size() == json.getTiles().size());
+
+    for(size_t i = 0; i < json.getTiles().size(); ++i)
+    {
+        tson::Tile &a = tmx.getTiles()[i];
+        tson::Tile &b = json.getTiles()[i];
+        REQUIRE(a.getId() == b.getId());
+        REQUIRE(a.getTerrain() == b.getTerrain());
+        REQUIRE(a.getObjectgroup().getObjects().size() == b.getObjectgroup().getObjects().size());
+        REQUIRE(a.getAnimation().size() == b.getAnimation().size());
+        for(size_t frame = 0; frame < b.getAnimation().size(); ++frame)
+        {
+            REQUIRE(a.getAnimation().getFrames()[frame].getTileId() == b.getAnimation().getFrames()[frame].getTileId());
+            REQUIRE(a.getAnimation().getFrames()[frame].getDuration() == b.getAnimation().getFrames()[frame].getDuration());
+        }
+        for(size_t obj = 0; obj < b.getObjectgroup().getObjects().size(); ++obj)
+        {
+            tson::Object &objA = a.getObjectgroup().getObjects()[obj];
+            tson::Object &objB = b.getObjectgroup().getObjects()[obj];
+            REQUIRE(objA.getObjectType() == objB.getObjectType());
+            REQUIRE(objA.getPosition() == objB.getPosition());
+            REQUIRE(objA.getSize() == objB.getSize());
+            REQUIRE(objA.getPolygons() == objB.getPolygons());
+        }
+    }
+
+    tson::Tile *tmxTile = tmx.getTile(31);
+    tson::Tile *jsonTile = json.getTile(31);
+    REQUIRE(tmxTile != nullptr);
+    REQUIRE(jsonTile != nullptr);
+    REQUIRE(tmxTile->get<tson::Colori>("color") == jsonTile->get<tson::Colori>("color"));
+    REQUIRE(tmxTile->get<fs::path>("file_ref") == jsonTile->get<fs::path>("file_ref"));
+    REQUIRE(tmxTile->get<int>("hp") == jsonTile->get<int>("hp"));
+    REQUIRE(tmxTile->get<bool>("is_player") == jsonTile->get<bool>("is_player"));
+    REQUIRE(tmxTile->get<float>("jump_force") == jsonTile->get<float>("jump_force"));
+    REQUIRE(tmxTile->get<std::string>("name") == jsonTile->get<std::string>("name"));
+}
+
+TEST_CASE( "Parse a tmx map - expects the same map as its json", "[tmx][parse]" )
+{
+    std::unique_ptr<tson::Map> tmx = ParseTmx("test-maps/ultimate_test.tmx");
+    std::unique_ptr<tson::Map> json = ParseJson("test-maps/ultimate_test.json");
+    REQUIRE(tmx->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(json->getStatus() == tson::ParseStatus::OK);
+
+    REQUIRE(tmx->getSize() == json->getSize());
+    REQUIRE(tmx->getTileSize() == json->getTileSize());
+    REQUIRE(tmx->getBackgroundColor() == json->getBackgroundColor());
+    REQUIRE(tmx->getOrientation() == json->getOrientation());
+    REQUIRE(tmx->isInfinite() == json->isInfinite());
+    REQUIRE(tmx->getType() == "map");
+
+    //The json is a later version of the map: Wang sets and tile 31 are the same, but not 'Main Layer' and 'Object Layer'
+    REQUIRE(tmx->getTilesets().size() == 1);
+    tson::Tileset &tmxTileset = tmx->getTilesets()[0];
+    tson::Tileset &jsonTileset = json->getTilesets()[0];
+    CheckSameTileset(tmxTileset, jsonTileset);
+
+    REQUIRE(tmxTileset.getTerrains().size() == jsonTileset.getTerrains().size());
+    tson::Terrain *terrain = tmxTileset.getTerrain("test_terrain");
+    REQUIRE(terrain != nullptr);
+    REQUIRE(terrain->get<std::string>("description") == jsonTileset.getTerrain("test_terrain")->get<std::string>("description"));
+    REQUIRE(terrain->get<bool>("i_like_this"));
+
+    REQUIRE(tmxTileset.getWangsets().size() == 1);
+    const tson::WangSet &tmxWangset = tmxTileset.getWangsets()[0];
+    const tson::WangSet &jsonWangset = jsonTileset.getWangsets()[0];
+    REQUIRE(tmxWangset.getName() == jsonWangset.getName());
+    REQUIRE(tmxWangset.getEdgeColors().size() == 4);
+    REQUIRE(tmxWangset.getEdgeColors()[3].getColor() == jsonWangset.getEdgeColors()[3].getColor());
+    REQUIRE(tmxWangset.getWangTiles().size() == jsonWangset.getWangTiles().size());
+    for(size_t i = 0; i < jsonWangset.getWangTiles().size(); ++i)
+    {
+        REQUIRE(tmxWangset.getWangTiles()[i].getTileid() == jsonWangset.getWangTiles()[i].getTileid());
+        REQUIRE(tmxWangset.getWangTiles()[i].getWangIds() == jsonWangset.getWangTiles()[i].getWangIds());
+    }
+
+    REQUIRE(tmx->getLayers().size() == json->getLayers().size());
+    for(size_t i = 0; i < json->getLayers().size(); ++i)
+    {
+        tson::Layer &a = tmx->getLayers()[i];
+        tson::Layer &b = json->getLayers()[i];
+        REQUIRE(a.getName() == b.getName());
+        REQUIRE(a.getId() == b.getId());
+        REQUIRE(a.getType() == b.getType());
+        REQUIRE(a.getSize() == b.getSize());
+        REQUIRE(a.getOffset() == b.getOffset());
+        REQUIRE(a.isVisible() == b.isVisible());
+        REQUIRE(a.getOpacity() == Approx(b.getOpacity()));
+        REQUIRE(a.getEncoding() == b.getEncoding());
+        if(a.getName() != "Main Layer")
+            REQUIRE(a.getData() == b.getData());
+    }
+
+    tson::Layer *background = tmx->getLayer("Background Image");
+    REQUIRE(background->getImage() == "../demo-background.png");
+    REQUIRE(background->get<bool>("repeat_bg"));
+    REQUIRE(background->get<float>("scroll_speed") == Approx(1.f));
+
+    tson::Layer *objectLayer = tmx->getLayer("Object Layer");
+    REQUIRE(objectLayer->getObjects().size() == 15);
+    tson::Object *goomba = objectLayer->getObj(10);
+    tson::Object *jsonGoomba = json->getLayer("Object Layer")->getObj(10);
+    REQUIRE(goomba->getObjectType() == tson::ObjectType::Object);
+    REQUIRE(goomba->getGid() == jsonGoomba->getGid());
+    REQUIRE(goomba->getPosition() == jsonGoomba->getPosition());
+    REQUIRE(goomba->getName() == "goomba");
+    REQUIRE(goomba->getType() == "Enemy");
+    REQUIRE(goomba->getProperties().getSize() == jsonGoomba->getProperties().getSize());
+
+    tson::Object *text = objectLayer->getObj(12);
+    REQUIRE(text->getObjectType() == tson::ObjectType::Text);
+    REQUIRE(text->getText().text == "Tileson - Demo Map");
+    REQUIRE(text->getText().wrap);
+    REQUIRE(text->getText().color == tson::Colori("#ffffff"));
+
+    tson::Object *instance = objectLayer->getObj(14);
+    REQUIRE(instance->getTemplate() == "useless_template_object.tx");
+    REQUIRE(instance->getPosition() == tson::Vector2i(144, 96));
+    REQUIRE(instance->getSize() == tson::Vector2i(32, 32));
+    REQUIRE(instance->getName() == "useless_template_object");
+    REQUIRE(instance->get<std::string>("dummy") == "Dumdum");
+    REQUIRE(instance->get<tson::Colori>("colorini") == tson::Colori("#ffdc007d"));
+}
+
+TEST_CASE( "Parse tmx maps with every tile layer encoding - expects the same tiles", "[tmx][parse]" )
+{
+    std::unique_ptr<tson::Map> json = ParseJson("test-maps/simple_map.json");
+    REQUIRE(json->getStatus() == tson::ParseStatus::OK);
+    const std::vector<uint32_t> &expected = json->getLayers()[0].getData();
+
+    SECTION("csv")
+    {
+        std::unique_ptr<tson::Map> map = ParseTmx("test-maps/simple_map.tmx");
+        REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+        REQUIRE(map->getLayers()[0].getData() == expected);
+        REQUIRE(map->getLayers()[0].getEncoding().empty());
+        CheckSameTileset(map->getTilesets()[0], json->getTilesets()[0]);
+    }
+
+    for(const char *name : {"base64", "zlib", "gzip"})
+    {
+        SECTION(name)
+        {
+            std::unique_ptr<tson::Map> map = ParseTmx(fs::path("test-maps/tmx") / (std::string("simple_map_") + name + ".tmx"));
+            REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+            tson::Layer &layer = map->getLayers()[0];
+            REQUIRE(layer.getData() == expected);
+            REQUIRE(layer.getEncoding() == "base64");
+            REQUIRE(layer.getCompression() == ((std::string(name) == "base64") ? "" : name));
+            REQUIRE(layer.getTileData().size() == json->getLayers()[0].getTileData().size());
+        }
+    }
+}
+
+TEST_CASE( "Parse a tmx map with an external tsx tileset", "[tmx][parse]" )
+{
+    std::unique_ptr<tson::Map> map = ParseTmx("test-maps/tmx/simple_map_zlib.tmx");
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::Tileset *tileset = map->getTileset("demo-tileset");
+    REQUIRE(tileset != nullptr);
+    REQUIRE(tileset->getFirstgid() == 1);
+    REQUIRE(tileset->getColumns() == 8);
+    REQUIRE(tileset->getImage() == "../../demo-tileset.png");
+
+    tson::Tile *animated = tileset->getTile(36);
+    REQUIRE(animated->getAnimation().size() == 2);
+    REQUIRE(animated->getAnimation().getFrames()[1].getTileId() == 44);
+    REQUIRE(animated->getAnimation().getFrames()[1].getDuration() == 250);
+
+    REQUIRE(tileset->getWangsets().size() == 1);
+    const tson::WangSet &wangset = tileset->getWangsets()[0];
+    REQUIRE(wangset.getColors().size() == 2);
+    REQUIRE(wangset.getColors()[1].getName() == "Dirt");
+    REQUIRE(wangset.getColors()[1].getProbability() == Approx(0.5f));
+    REQUIRE(wangset.getWangTiles()[0].getWangIds() == std::vector<uint32_t>{1, 0, 2, 0, 1, 0, 1, 0});
+}
+
+TEST_CASE( "Parse an infinite tmx map - expects the same chunks as its json", "[tmx][parse]" )
+{
+    std::unique_ptr<tson::Map> tmx = ParseTmx("test-maps/infinite.tmx");
+    std::unique_ptr<tson::Map> json = ParseJson("test-maps/infinite.json");
+    REQUIRE(tmx->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(tmx->isInfinite());
+
+    std::vector<tson::Chunk> &tmxChunks = tmx->getLayers()[0].getChunks();
+    std::vector<tson::Chunk> &jsonChunks = json->getLayers()[0].getChunks();
+    REQUIRE(tmxChunks.size() == jsonChunks.size());
+    for(size_t i = 0; i < jsonChunks.size(); ++i)
+    {
+        REQUIRE(tmxChunks[i].getPosition() == jsonChunks[i].getPosition());
+        REQUIRE(tmxChunks[i].getSize() == jsonChunks[i].getSize());
+        REQUIRE(tmxChunks[i].getData().size() == 256);
+    }
+
+    //The json is a later version of the map, where one tile of the first chunk is set
+    REQUIRE(tmxChunks[0].getData()[0] == 5);
+    REQUIRE(tmxChunks[1].getData() == jsonChunks[1].getData());
+    REQUIRE(tmxChunks[3].getData() == jsonChunks[3].getData());
+}
+
+TEST_CASE( "Parse a tmx map with groups, shapes, text and old tile data", "[tmx][parse]" )
+{
+    std::unique_ptr<tson::Map> map = ParseTmx("test-maps/tmx/features.tmx");
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+    REQUIRE(map->getClassType() == "Level");
+    REQUIRE(map->getParallaxOrigin() == tson::Vector2f(8.f, 4.f));
+    REQUIRE(map->get<std::string>("description") == "First line & more\nSecond line");
+    REQUIRE(map->get<int>("level") == 3);
+    REQUIRE(map->get<tson::Colori>("tint") == tson::Colori("#ff102030"));
+
+    tson::Layer *legacy = map->getLayer("Legacy");
+    REQUIRE(legacy->getData() == std::vector<uint32_t>{1, 2, 0, 2147483652, 5, 6, 7, 8});
+    REQUIRE(legacy->getOpacity() == Approx(0.5f));
+    REQUIRE(!legacy->isVisible());
+    REQUIRE(legacy->getOffset() == tson::Vector2f(2.f, -3.f));
+    REQUIRE(legacy->getParallax() == tson::Vector2f(0.5f, 1.f));
+    REQUIRE(legacy->getTintColor() == tson::Colori("#80ff0000"));
+    REQUIRE(legacy->getTileData(3, 0)->getId() == 4);
+    REQUIRE(legacy->getTileData(3, 0)->hasFlipFlags(tson::TileFlipFlags::Horizontally));
+
+    tson::Layer *group = map->getLayer("Group");
+    REQUIRE(group->getType() == tson::LayerType::Group);
+    REQUIRE(group->getClassType() == "Container");
+    REQUIRE(group->get<bool>("in_group"));
+    REQUIRE(group->getLayers().size() == 1);
+
+    tson::Layer &shapes = group->getLayers()[0];
+    REQUIRE(shapes.getType() == tson::LayerType::ObjectGroup);
+    REQUIRE(shapes.getDrawOrder() == "topdown");
+    REQUIRE(shapes.getObjects().size() == 7);
+
+    tson::Object *ellipse = shapes.getObj(1);
+    REQUIRE(ellipse->getObjectType() == tson::ObjectType::Ellipse);
+    REQUIRE(ellipse->getType() == "Round");
+    REQUIRE(ellipse->getRotation() == Approx(45.f));
+    REQUIRE(ellipse->getSize() == tson::Vector2i(30, 40));
+    REQUIRE(shapes.getObj(2)->getObjectType() == tson::ObjectType::Point);
+    REQUIRE(shapes.getObj(3)->getObjectType() == tson::ObjectType::Polygon);
+    REQUIRE(shapes.getObj(3)->getPolygons() == std::vector<tson::Vector2i>{{0, 0}, {16, 0}, {16, 8}});
+    REQUIRE(shapes.getObj(4)->getObjectType() == tson::ObjectType::Polyline);
+    REQUIRE(shapes.getObj(4)->getPolylines().size() == 2);
+    REQUIRE(!shapes.getObj(4)->isVisible());
+
+    const tson::Text &text = shapes.getObj(5)->getText();
+    REQUIRE(shapes.getObj(5)->getObjectType() == tson::ObjectType::Text);
+    REQUIRE(text.text == "Tom & Jerry <3");
+    REQUIRE(text.fontFamily == "serif");
+    REQUIRE(text.pixelSize == 12);
+    REQUIRE(text.bold);
+    REQUIRE(text.horizontalAlignment == tson::TextAlignment::Center);
+
+    tson::Object *instance = shapes.getObj(6);
+    REQUIRE(instance->getName() == "useless_template_object");
+    REQUIRE(instance->getPosition() == tson::Vector2i(32, 16));
+    REQUIRE(instance->get<std::string>("dummy") == "Dumdum");
+
+    tson::Object *coin = shapes.getObj(7);
+    REQUIRE(coin->getType() == "Coin");
+    REQUIRE(coin->getGid() == 21);
+
+    tson::Layer *sky = map->getLayer("Sky");
+    REQUIRE(sky->getType() == tson::LayerType::ImageLayer);
+    REQUIRE(sky->getImage() == "../../demo-background.png");
+    REQUIRE(sky->getTransparentColor() == tson::Colori("#ff00ff"));
+    REQUIRE(sky->hasRepeatX());
+    REQUIRE(!sky->hasRepeatY());
+}
+
+TEST_CASE( "Parse broken tmx files - expects a parse error", "[tmx][parse]" )
+{
+    tson::Tileson t {std::make_unique<tson::TmxJson>()};
+    std::string const truncated = "<?xml version=\"1.0\"?><map width=\"2\" height=\"1\"><layer name=\"a\"><data encoding=\"csv\">1,2</data>";
+    REQUIRE(t.parse(truncated.data(), truncated.size())->getStatus() == tson::ParseStatus::ParseError);
+
+    std::string const notTiled = "<world/>";
+    REQUIRE(t.parse(notTiled.data(), notTiled.size())->getStatus() == tson::ParseStatus::ParseError);
+
+    std::string const badZlib = "<map><layer name=\"a\"><data encoding=\"base64\" compression=\"zlib\">eJxjZGBgYAI=</data></layer></map>";
+    REQUIRE(t.parse(badZlib.data(), badZlib.size())->getStatus() == tson::ParseStatus::ParseError);
+
+    REQUIRE(t.parse(GetPathWithBase("test-maps/tmx/missing.tmx"))->getStatus() == tson::ParseStatus::FileNotFound);
+}
+
+TEST_CASE( "Read xml with the pull parser", "[tmx][xml]" )
+{
+    std::string const xml = "<?xml version=\"1.0\"?>\n<!-- comment --><a x='1' y=\"&lt;2&gt;\"><b/>text<![CDATA[<raw>]]></a>";
+    tson::XmlReader reader {xml.data(), xml.size()};
+
+    REQUIRE(reader.nextStartElement() == tson::XmlReader::Token::StartElement);
+    REQUIRE(reader.getName() == "a");
+    REQUIRE(reader.getAttribute("x") == "1");
+    REQUIRE(tson::XmlReader::Unescape(reader.getAttribute("y")) == "<2>");
+    REQUIRE(!reader.hasAttribute("z"));
+
+    REQUIRE(reader.next() == tson::XmlReader::Token::StartElement);
+    REQUIRE(reader.isEmptyElement());
+    REQUIRE(reader.getDepth() == 2);
+    REQUIRE(reader.next() == tson::XmlReader::Token::EndElement);
+    REQUIRE(reader.next() == tson::XmlReader::Token::Text);
+    REQUIRE(reader.getText() == "text");
+    REQUIRE(reader.next() == tson::XmlReader::Token::Text);
+    REQUIRE(reader.getText() == "<raw>");
+    REQUIRE(reader.next() == tson::XmlReader::Token::EndElement);
+    REQUIRE(reader.next() == tson::XmlReader::Token::EndOfDocument);
+
+    REQUIRE(tson::XmlReader::Unescape("&#65;&#x20AC;&unknown;") == "A\xE2\x82\xAC&unknown;");
+}
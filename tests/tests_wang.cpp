@@ -0,0 +1,134 @@
+#include "../external_libs/catch.hpp"
+#include "../TilesonConfig.h"
+
+#ifdef TILESON_UNIT_TEST_USE_SINGLE_HEADER
+    #include "../tileson.hpp"
+#else
+    #include "../include/tileson.h"
+#endif
+
+#include "TestTools.hpp"
+
+#include <sstream>
+
+/*!
+ * A corner wang set with grass (1) and sand (2). Tile 0 is grass, tile 1 is sand, tile 2 is grass with sand in the top-left corner,
+ * and tile 3 has sand in the top half.
+ */
+static std::string CreateWangMapJson(const std::string &transformations, int width = 1, int height = 1, const std::vector<uint32_t> &data = {0})
+{
+    std::stringstream json;
+    json << R"({"width": )" << width << R"(, "height": )" << height << R"(, "tilewidth": 16, "tileheight": 16, "infinite": false,
+        "nextobjectid": 1, "orientation": "orthogonal", "tiledversion": "1.9.2", "type": "map",
+        "tilesets": [{"firstgid": 1, "name": "terrain", "tilewidth": 16, "tileheight": 16, "tilecount": 4, "columns": 2, "margin": 0, "spacing": 0,
+            "image": "terrain.png", "imagewidth": 32, "imageheight": 32,
+            "transformations": )" << transformations << R"(,
+            "wangsets": [{"name": "Terrain", "tile": -1, "type": "corner",
+                "colors": [{"name": "Grass", "color": "#00ff00", "tile": -1, "probability": 1},
+                           {"name": "Sand", "color": "#ffff00", "tile": -1, "probability": 1}],
+                "wangtiles": [{"tileid": 0, "wangid": [0, 1, 0, 1, 0, 1, 0, 1]},
+                              {"tileid": 1, "wangid": [0, 2, 0, 2, 0, 2, 0, 2]},
+                              {"tileid": 2, "wangid": [0, 1, 0, 1, 0, 1, 0, 2]},
+                              {"tileid": 3, "wangid": [0, 2, 0, 1, 0, 1, 0, 2]}]}]}],
+        "layers": [{"name": "ground", "type": "tilelayer", "id": 1, "opacity": 1, "visible": true, "x": 0, "y": 0,
+            "width": )" << width << R"(, "height": )" << height << R"(, "data": [)";
+    for(size_t i = 0; i < data.size(); ++i)
+        json << ((i > 0) ? "," : "") << data[i];
+    json << "]}]}";
+    return json.str();
+}
+
+static uint64_t WangId(uint32_t top, uint32_t topRight, uint32_t right, uint32_t bottomRight, uint32_t bottom, uint32_t bottomLeft, uint32_t left, uint32_t topLeft)
+{
+    return tson::WangLookup::Pack({top, topRight, right, bottomRight, bottom, bottomLeft, left, topLeft});
+}
+
+TEST_CASE( "Wang - lookup with transformed variants", "[wang]" )
+{
+    std::string json = CreateWangMapJson(R"({"hflip": false, "vflip": false, "rotate": true, "preferuntransformed": false})");
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    const tson::WangLookup &lookup = map->getTileset("terrain")->getWangset("Terrain")->getLookup();
+    REQUIRE(lookup.usesCorners());
+    REQUIRE(!lookup.usesEdges());
+
+    //Symmetric tiles are only listed once
+    tson::WangCandidates grass = lookup.find(WangId(0, 1, 0, 1, 0, 1, 0, 1));
+    REQUIRE(grass.count == 1);
+    REQUIRE(grass.gids[0] == 1);
+
+    //Rotating the sand corner by 90 degrees clockwise moves it from the top-left to the top-right
+    tson::WangCandidates topRight = lookup.find(WangId(0, 2, 0, 1, 0, 1, 0, 1));
+    REQUIRE(topRight.count == 1);
+    REQUIRE(topRight.gids[0] == (3 | tson::FLIPPED_DIAGONALLY_FLAG | tson::FLIPPED_HORIZONTALLY_FLAG));
+    tson::WangCandidates bottomHalf = lookup.find(WangId(0, 1, 0, 2, 0, 2, 0, 1));
+    REQUIRE(bottomHalf.count == 1);
+    REQUIRE(bottomHalf.gids[0] == (4 | tson::FLIPPED_HORIZONTALLY_FLAG | tson::FLIPPED_VERTICALLY_FLAG));
+
+    //A wang id without a tile, and the wang id of a flipped gid
+    REQUIRE(lookup.find(WangId(0, 2, 0, 1, 0, 2, 0, 1)).empty());
+    REQUIRE(lookup.getWangId(3 | tson::FLIPPED_DIAGONALLY_FLAG | tson::FLIPPED_HORIZONTALLY_FLAG) == WangId(0, 2, 0, 1, 0, 1, 0, 1));
+    REQUIRE(lookup.getWangId(3 | tson::FLIPPED_HORIZONTALLY_FLAG) == WangId(0, 2, 0, 1, 0, 1, 0, 1));
+    REQUIRE(lookup.getWangId(4 | tson::FLIPPED_VERTICALLY_FLAG) == WangId(0, 1, 0, 2, 0, 2, 0, 1));
+
+    //Only horizontal flips: The sand corner can be in the top-left or the top-right
+    json = CreateWangMapJson(R"({"hflip": true, "vflip": false, "rotate": false, "preferuntransformed": false})");
+    map = t.parse(json.data(), json.size());
+    const tson::WangLookup &flipOnly = map->getTileset("terrain")->getWangset("Terrain")->getLookup();
+    REQUIRE(flipOnly.find(WangId(0, 2, 0, 1, 0, 1, 0, 1)).gids[0] == (3 | tson::FLIPPED_HORIZONTALLY_FLAG));
+    REQUIRE(flipOnly.find(WangId(0, 1, 0, 2, 0, 1, 0, 1)).empty());
+}
+
+TEST_CASE( "Wang - autotiler resolves the neighbours of a change", "[wang]" )
+{
+    std::string json = CreateWangMapJson(R"({"hflip": false, "vflip": false, "rotate": true, "preferuntransformed": false})");
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = t.parse(json.data(), json.size());
+    REQUIRE(map->getStatus() == tson::ParseStatus::OK);
+
+    tson::WangAutotiler autotiler {*map->getTileset("terrain")->getWangset("Terrain")};
+    autotiler.create(5, 5);
+    REQUIRE(autotiler.getGid(0, 0) == 0);
+    for(int y = 0; y < 5; ++y)
+        for(int x = 0; x < 5; ++x)
+            autotiler.paint(x, y, 1);
+    REQUIRE(autotiler.getChangedCells().size() == 25);
+    REQUIRE(std::all_of(autotiler.getGids().begin(), autotiler.getGids().end(), [](uint32_t gid) { return gid == 1; }));
+    autotiler.clearChangedCells();
+
+    autotiler.paint(2, 2, 2);
+    REQUIRE(autotiler.getChangedCells().size() == 9);
+    REQUIRE(autotiler.getGid(2, 2) == 2);
+    REQUIRE(autotiler.getGid(1, 1) == (3 | tson::FLIPPED_HORIZONTALLY_FLAG | tson::FLIPPED_VERTICALLY_FLAG));
+    REQUIRE(autotiler.getGid(3, 3) == 3);
+    REQUIRE(autotiler.getGid(2, 3) == 4);
+    REQUIRE(autotiler.getGid(2, 1) == (4 | tson::FLIPPED_HORIZONTALLY_FLAG | tson::FLIPPED_VERTICALLY_FLAG));
+    REQUIRE(autotiler.getGid(0, 0) == 1);
+    autotiler.clearChangedCells();
+
+    //Painting the same color again changes nothing
+    autotiler.paint(2, 2, 2);
+    REQUIRE(autotiler.getChangedCells().empty());
+
+    //Sand in two opposite corners has no tile: The closest match is used
+    autotiler.setCornerColor(4, 4, 2);
+    REQUIRE(autotiler.getWangId(3, 3) == WangId(0, 1, 0, 2, 0, 1, 0, 2));
+    REQUIRE(autotiler.getGid(3, 3) != 0);
+    REQUIRE(autotiler.getChangedCells().size() == 4);
+
+    //The terrain of a layer is taken from its tiles
+    std::vector<uint32_t> data = autotiler.getGids();
+    std::string layerJson = CreateWangMapJson(R"({"hflip": false, "vflip": false, "rotate": true, "preferuntransformed": false})", 5, 5, data);
+    std::unique_ptr<tson::Map> layerMap = t.parse(layerJson.data(), layerJson.size());
+    REQUIRE(layerMap->getStatus() == tson::ParseStatus::OK);
+    tson::WangAutotiler fromLayer {*layerMap->getTileset("terrain")->getWangset("Terrain")};
+    fromLayer.create(*layerMap->getLayer("ground"));
+    REQUIRE(fromLayer.getGids() == data);
+    REQUIRE(fromLayer.getWangId(1, 1) == WangId(0, 1, 0, 2, 0, 1, 0, 1));
+
+    fromLayer.paint(2, 2, 1);
+    REQUIRE(fromLayer.getGid(1, 1) == 1);
+    REQUIRE(fromLayer.getGid(2, 2) == 1);
+}
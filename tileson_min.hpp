@@ -76,6 +76,7 @@
 #include <fstream>
 #include <sstream>
 #include <memory>
+#include <future>
 
 
 /*** Start of inlined file: Tools.hpp ***/
@@ -86,6 +87,7 @@
 #ifndef TILESON_TOOLS_HPP
 #define TILESON_TOOLS_HPP
 
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <string_view>
@@ -99,6 +101,7 @@ namespace tson
 			~Tools() = delete;
 			inline static std::vector<uint8_t> Base64DecodedStringToBytes(std::string_view str);
 			inline static std::vector<uint32_t> BytesToUnsignedInts(const std::vector<uint8_t> &bytes);
+			inline static bool Base64DecodeRange(std::string_view base64, size_t offset, size_t size, uint8_t *out);
 			inline static std::vector<std::string> SplitString(const std::string &s, char delim);
 			inline static bool Equal(float a, float b, float precision = 8192.f);
 
@@ -158,6 +161,52 @@ namespace tson
 		return uints;
 	}
 
+	/*!
+	 * Decodes 'size' bytes starting at byte 'offset' of the data encoded in a base64 string, without decoding what comes before.
+	 * Every 4 characters hold 3 bytes, so the characters of a byte can be found directly. The string must not contain whitespace.
+	 * @param out Receives the decoded bytes. Must have room for 'size' bytes.
+	 * @return false if the string is too short or has invalid characters
+	 */
+	bool Tools::Base64DecodeRange(std::string_view base64, size_t offset, size_t size, uint8_t *out)
+	{
+		static constexpr uint8_t Invalid = 0xff;
+		static const std::array<uint8_t, 256> Table = []()
+		{
+			std::array<uint8_t, 256> table {};
+			table.fill(Invalid);
+			const char *chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			for(uint8_t i = 0; i < 64; ++i)
+				table[static_cast<uint8_t>(chars[i])] = i;
+			table['='] = 0;
+			return table;
+		}();
+
+		size_t group = offset / 3;
+		size_t skip = offset % 3;
+		while(size > 0)
+		{
+			size_t const pos = group * 4;
+			if(pos + 4 > base64.size())
+				return false;
+
+			uint32_t value = 0;
+			for(size_t i = pos; i < pos + 4; ++i)
+			{
+				uint8_t const sextet = Table[static_cast<uint8_t>(base64[i])];
+				if(sextet == Invalid)
+					return false;
+				value = (value << 6) | sextet;
+			}
+
+			uint8_t const bytes[3] {static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+			for(size_t i = skip; i < 3 && size > 0; ++i, --size)
+				*out++ = bytes[i];
+			skip = 0;
+			++group;
+		}
+		return true;
+	}
+
 	std::vector<std::string> Tools::SplitString(const std::string &s, char delim)
 	{
 		std::vector<std::string> elems;
@@ -445,6 +494,7 @@ namespace tson
 #define TILESON_DECOMPRESSORCONTAINER_HPP
 
 #include <memory>
+#include <cstdint>
 #include <vector>
 #include <string_view>
 #include <functional>
@@ -461,17 +511,24 @@ namespace tson
 			inline bool empty() const;
 			inline size_t size() const;
 			inline void clear();
+			[[nodiscard]] inline DecompressorContainer clone() const;
+			[[nodiscard]] inline uint64_t getRevision() const;
 
 			inline IDecompressor<std::string_view, std::string> *get(std::string_view name);
 		private:
 			//Key: name,
 			std::vector<std::unique_ptr<IDecompressor<std::string_view, std::string>>> m_decompressors;
+			//Creates a new instance of the decompressor at the same index. Used by clone()
+			std::vector<std::function<IDecompressor<std::string_view, std::string> *()>> m_factories;
+			uint64_t m_revision {0};
 	};
 
 	template<typename T, typename... Args>
 	void DecompressorContainer::add(Args &&... args)
 	{
 		m_decompressors.emplace_back(new T(args...));
+		m_factories.emplace_back([args...]() -> IDecompressor<std::string_view, std::string> * { return new T(args...); });
+		++m_revision;
 	}
 
 	/*!
@@ -495,11 +552,15 @@ namespace tson
 	 */
 	void DecompressorContainer::remove(std::string_view name)
 	{
-		auto iter = std::remove_if(m_decompressors.begin(), m_decompressors.end(), [&](const auto &item)
+		for(size_t i = m_decompressors.size(); i > 0; --i)
 		{
-			return item->name() == name;
-		});
-		m_decompressors.erase(iter);
+			if(m_decompressors[i - 1]->name() == name)
+			{
+				m_decompressors.erase(m_decompressors.begin() + static_cast<std::ptrdiff_t>(i - 1));
+				m_factories.erase(m_factories.begin() + static_cast<std::ptrdiff_t>(i - 1));
+				++m_revision;
+			}
+		}
 	}
 
 	size_t DecompressorContainer::size() const
@@ -537,6 +598,32 @@ namespace tson
 	void DecompressorContainer::clear()
 	{
 		m_decompressors.clear();
+		m_factories.clear();
+		++m_revision;
+	}
+
+	/*!
+	 * Creates a container with new instances of the same decompressors, constructed with the same arguments as in add().
+	 * Maps with lazy layers get their own copy, as they can decompress their layers after the parser is gone.
+	 * Decompressors are not thread safe, so each thread parsing maps at the same time needs its own.
+	 * @return A container with the same decompressors, in the same order
+	 */
+	DecompressorContainer DecompressorContainer::clone() const
+	{
+		DecompressorContainer container;
+		for(const auto &factory : m_factories)
+			container.m_decompressors.emplace_back(factory());
+		container.m_factories = m_factories;
+		return container;
+	}
+
+	/*!
+	 * Changes every time a decompressor is added or removed, so copies made by clone() can be told apart from the current decompressors
+	 * @return The number of changes to the container
+	 */
+	uint64_t DecompressorContainer::getRevision() const
+	{
+		return m_revision;
 	}
 }
 #endif //TILESON_DECOMPRESSORCONTAINER_HPP
@@ -606,6 +693,7 @@ namespace tson
 #define TILESON_MAP_HPP
 
 #include <functional>
+#include <unordered_map>
 
 
 /*** Start of inlined file: Color.hpp ***/
@@ -837,6 +925,94 @@ namespace tson
 
 /*** End of inlined file: Vector2.hpp ***/
 
+
+/*** Start of inlined file: TileDrawInfo.hpp ***/
+#ifndef TILESON_TILEDRAWINFO_HPP
+#define TILESON_TILEDRAWINFO_HPP
+
+
+/*** Start of inlined file: Rect.hpp ***/
+//
+// Created by robin on 24.07.2020.
+//
+
+#ifndef TILESON_RECT_HPP
+#define TILESON_RECT_HPP
+
+namespace tson
+{
+	class Rect
+	{
+		public:
+
+			inline Rect() = default;
+			inline Rect(int x_, int y_, int width_, int height_);
+
+			inline bool operator==(const Rect &rhs) const;
+			inline bool operator!=(const Rect &rhs) const;
+
+			int x{};
+			int y{};
+			int width{};
+			int height{};
+	};
+
+	Rect::Rect(int x_, int y_, int width_, int height_)
+	{
+		x = x_;
+		y = y_;
+		width = width_;
+		height = height_;
+	}
+
+	bool Rect::operator==(const Rect &rhs) const
+	{
+		return x == rhs.x &&
+			   y == rhs.y &&
+			   width == rhs.width &&
+			   height == rhs.height;
+	}
+
+	bool Rect::operator!=(const Rect &rhs) const
+	{
+		return !(rhs == *this);
+	}
+}
+
+#endif //TILESON_RECT_HPP
+
+/*** End of inlined file: Rect.hpp ***/
+
+namespace tson
+{
+	class Tile;
+	class Tileset;
+
+	/*!
+	 * Everything needed to draw a tile, precalculated once per gid by tson::Map. See tson::Map::getTileDrawTable().
+	 */
+	class TileDrawInfo
+	{
+		public:
+			/*! The tile of the gid. nullptr if no tileset contains the gid. */
+			tson::Tile *tile {nullptr};
+			/*! The tileset of the tile */
+			tson::Tileset *tileset {nullptr};
+			/*! The part of the image used by the tile, in pixels, with margin and spacing taken into account */
+			tson::Rect drawingRect;
+			/*! drawingRect normalized to the size of the image: top-left corner */
+			tson::Vector2f uvTopLeft;
+			/*! drawingRect normalized to the size of the image: bottom-right corner */
+			tson::Vector2f uvBottomRight;
+			/*! 'tileoffset' of the tileset */
+			tson::Vector2i tileOffset;
+	};
+}
+
+#endif //TILESON_TILEDRAWINFO_HPP
+
+/*** End of inlined file: TileDrawInfo.hpp ***/
+
 //#include "../external/json.hpp"
 
 /*** Start of inlined file: IJson.hpp ***/
@@ -880,6 +1056,9 @@ namespace tson
 			[[nodiscard]] virtual bool isArray() const = 0;
 			[[nodiscard]] virtual bool isObject() const = 0;
 			[[nodiscard]] virtual bool isNull() const = 0;
+			inline virtual bool readArray(std::string_view key, std::vector<uint32_t> &values);
+			inline virtual bool readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength,
+												size_t x, size_t y, size_t width, size_t height);
 
 			/*!
 			 * Get the directory where the json was loaded.
@@ -924,7 +1103,7 @@ namespace tson
 	{
 		if constexpr (std::is_same<T, double>::value)
 			return getDouble(key);
-		if constexpr (std::is_same<T, float>::value)
+		else if constexpr (std::is_same<T, float>::value)
 			return getFloat(key);
 		else if constexpr (std::is_same<T, int32_t>::value)
 			return getInt32(key);
@@ -947,7 +1126,7 @@ namespace tson
 	{
 		if constexpr (std::is_same<T, double>::value)
 			return getDouble();
-		if constexpr (std::is_same<T, float>::value)
+		else if constexpr (std::is_same<T, float>::value)
 			return getFloat();
 		else if constexpr (std::is_same<T, int32_t>::value)
 			return getInt32();
@@ -965,6 +1144,44 @@ namespace tson
 			return nullptr;
 	}
 
+	/*!
+	 * Appends the items of an array of unsigned integers, like the tile data of a layer, to 'values'.
+	 * Reads one item at a time. Backends that store such arrays as plain integers override it to copy them directly.
+	 * @return false if 'key' is not an array
+	 */
+	bool IJson::readArray(std::string_view key, std::vector<uint32_t> &values)
+	{
+		if(count(key) == 0 || !operator[](key).isArray())
+			return false;
+
+		auto &items = array(key);
+		values.reserve(values.size() + items.size());
+		for(std::unique_ptr<IJson> &item : items)
+			values.push_back(item->get<uint32_t>());
+		return true;
+	}
+
+	/*!
+	 * Appends a rectangle of an array of unsigned integers stored row by row, like the tile data of a layer, to 'values'.
+	 * The items outside the rectangle are skipped. Items past the end of the array are read as 0.
+	 * @param rowLength Number of items in each row of the array
+	 * @return false if 'key' is not an array
+	 */
+	bool IJson::readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength, size_t x, size_t y, size_t width, size_t height)
+	{
+		if(count(key) == 0 || !operator[](key).isArray())
+			return false;
+
+		auto &items = array(key);
+		values.reserve(values.size() + width * height);
+		for(size_t row = y; row < y + height; ++row)
+		{
+			for(size_t i = row * rowLength + x; i < row * rowLength + x + width; ++i)
+				values.push_back((i < items.size()) ? items[i]->get<uint32_t>() : 0);
+		}
+		return true;
+	}
+
 }
 
 #endif //TILESON_IJSON_HPP
@@ -1927,5530 +2144,17657 @@ namespace tson
 
 
 
-/*** Start of inlined file: Layer.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
-
-#ifndef TILESON_LAYER_HPP
-#define TILESON_LAYER_HPP
-
-#include <set>
-//#include "../external/json.hpp"
-
+/*** Start of inlined file: TmxJson.hpp ***/
+#ifndef TILESON_TMXJSON_HPP
+#define TILESON_TMXJSON_HPP
 
-/*** Start of inlined file: Chunk.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+#include <array>
+#include <cstdlib>
+#include <functional>
 
-#ifndef TILESON_CHUNK_HPP
-#define TILESON_CHUNK_HPP
+/*** Start of inlined file: XmlReader.hpp ***/
+#ifndef TILESON_XMLREADER_HPP
+#define TILESON_XMLREADER_HPP
 
-//#include "../external/json.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace tson
 {
-	class Chunk
+	/*!
+	 * A pull parser for XML: Each call to next() reads one element tag or one piece of text, and nothing is kept of what has been read.
+	 * Names, attribute values and text are views into the data, so the data must outlive them.
+	 *
+	 * The XML declaration, processing instructions, comments and the DOCTYPE are skipped. Entities are left as they are
+	 * in attribute values and text. Use Unescape() to resolve them.
+	 *
+	 * Example:
+	 * tson::XmlReader reader {data, size};
+	 * while(reader.next() == tson::XmlReader::Token::StartElement)
+	 *     std::cout << reader.getName() << "\n";
+	 */
+	class XmlReader
 	{
 		public:
-			inline Chunk() = default;
-			inline explicit Chunk(IJson &json);
-			inline bool parse(IJson &json);
+			enum class Token : uint8_t
+			{
+				StartElement = 0,   /*! <name attributes> or <name attributes/> */
+				EndElement = 1,     /*! </name>, also reported after an empty element */
+				Text = 2,           /*! Text, or the content of a CDATA section */
+				EndOfDocument = 3,
+				Error = 4
+			};
 
-			[[nodiscard]] inline const std::vector<int> &getData() const;
-			[[nodiscard]] inline const std::string &getBase64Data() const;
-			[[nodiscard]] inline const Vector2i &getSize() const;
-			[[nodiscard]] inline const Vector2i &getPosition() const;
+			inline XmlReader(const char *data, size_t size);
+
+			inline Token next();
+			inline Token nextStartElement();
+			inline bool skipElement();
+			inline std::string_view readText();
+
+			[[nodiscard]] inline Token getToken() const;
+			[[nodiscard]] inline std::string_view getName() const;
+			[[nodiscard]] inline std::string_view getText() const;
+			[[nodiscard]] inline const std::vector<std::pair<std::string_view, std::string_view>> &getAttributes() const;
+			[[nodiscard]] inline std::string_view getAttribute(std::string_view name) const;
+			[[nodiscard]] inline bool hasAttribute(std::string_view name) const;
+			[[nodiscard]] inline bool isEmptyElement() const;
+			[[nodiscard]] inline size_t getDepth() const;
+			[[nodiscard]] inline size_t getTokenOffset() const;
+			[[nodiscard]] inline size_t getOffset() const;
+
+			inline static std::string Unescape(std::string_view text);
 
 		private:
-			std::vector<int> m_data;        /*! 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only. */
-			std::string      m_base64Data;  /*! 'data' (when string): Array of unsigned int (GIDs) or base64-encoded data. */
-			tson::Vector2i   m_size;        /*!  x='width' (in tiles) and y='height' (in tiles): */
-			tson::Vector2i   m_position;    /*! 'x' and 'y' position in tiles */
+			inline Token fail();
+			inline bool skipPast(std::string_view terminator);
+			inline bool readTag();
+			inline void skipWhitespace();
+			[[nodiscard]] inline static bool IsNameChar(char c);
+
+			const char *            m_data;
+			size_t                  m_size;
+			size_t                  m_pos {0};
+			size_t                  m_depth {0};
+			size_t                  m_tokenStart {0};       /*! Offset of the '<' of the current tag */
+			Token                   m_token {Token::EndOfDocument};
+			bool                    m_isEmptyElement {false};
+			bool                    m_pendingEnd {false};    /*! An empty element has been reported, but not its end */
+			std::string_view        m_name;
+			std::string_view        m_text;
+			std::vector<std::pair<std::string_view, std::string_view>> m_attributes;
 	};
-}
 
-#endif //TILESON_CHUNK_HPP
+	XmlReader::XmlReader(const char *data, size_t size) : m_data {data}, m_size {size}
+	{
+		//Skip the UTF-8 byte order mark
+		if(m_size >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+			m_pos = 3;
+	}
 
-/*!
- * Parses 'chunk' data from Tiled json and stores the values in this class
- * @param json json-data
- */
-tson::Chunk::Chunk(IJson &json)
-{
-	parse(json);
-}
+	/*!
+	 * Reads the next element tag or text
+	 * @return Token::EndOfDocument when all the data has been read, Token::Error if the data is not well-formed
+	 */
+	XmlReader::Token XmlReader::next()
+	{
+		if(m_token == Token::Error)
+			return m_token;
 
-/*!
- * Parses 'chunk' data from Tiled json and stores the values in this class
- * @param json json-data
- * @return true if all mandatory fields was found. false otherwise.
- */
-bool tson::Chunk::parse(IJson &json)
-{
-	bool allFound = true;
+		if(m_pendingEnd)
+		{
+			m_pendingEnd = false;
+			m_isEmptyElement = false;
+			m_attributes.clear();
+			--m_depth;
+			return m_token = Token::EndElement;
+		}
 
-	if(json.count("width") > 0 && json.count("height") > 0)
-		m_size = {json["width"].get<int>(), json["height"].get<int>()}; else allFound = false;
-	if(json.count("x") > 0 && json.count("y") > 0)
-		m_position = {json["x"].get<int>(), json["y"].get<int>()}; else allFound = false;
+		while(m_pos < m_size)
+		{
+			if(m_data[m_pos] != '<')
+			{
+				size_t const start = m_pos;
+				const void *end = std::memchr(m_data + m_pos, '<', m_size - m_pos);
+				m_pos = (end != nullptr) ? static_cast<size_t>(static_cast<const char *>(end) - m_data) : m_size;
+				m_text = std::string_view(m_data + start, m_pos - start);
+				return m_token = Token::Text;
+			}
 
-	//Handle DATA (Optional)
-	if(json.count("data") > 0)
+			std::string_view const rest(m_data + m_pos, m_size - m_pos);
+			if(rest.compare(0, 4, "<!--") == 0)
+			{
+				if(!skipPast("-->"))
+					return fail();
+			}
+			else if(rest.compare(0, 9, "<![CDATA[") == 0)
+			{
+				size_t const start = m_pos + 9;
+				if(!skipPast("]]>"))
+					return fail();
+				m_text = std::string_view(m_data + start, m_pos - 3 - start);
+				return m_token = Token::Text;
+			}
+			else if(rest.compare(0, 2, "<?") == 0)
+			{
+				if(!skipPast("?>"))
+					return fail();
+			}
+			else if(rest.compare(0, 2, "<!") == 0)
+			{
+				//DOCTYPE. An internal subset in brackets may contain '>'
+				size_t const bracket = rest.find('[');
+				size_t const close = rest.find('>');
+				if(bracket != std::string_view::npos && bracket < close && !skipPast("]"))
+					return fail();
+				if(!skipPast(">"))
+					return fail();
+			}
+			else
+			{
+				m_tokenStart = m_pos;
+				return (readTag()) ? m_token : fail();
+			}
+		}
+
+		return m_token = (m_depth == 0) ? Token::EndOfDocument : fail();
+	}
+
+	/*!
+	 * Reads until the next start element of the current element, skipping text.
+	 * @return Token::StartElement, or Token::EndElement when the current element has no more children.
+	 */
+	XmlReader::Token XmlReader::nextStartElement()
 	{
-		if(json["data"].isArray())
+		Token token = next();
+		while(token == Token::Text)
+			token = next();
+		return token;
+	}
+
+	/*!
+	 * Skips the rest of the current element, including all its children. Call after Token::StartElement.
+	 * @return false if the data ended before the element
+	 */
+	bool XmlReader::skipElement()
+	{
+		size_t const depth = m_depth;
+		while(m_depth >= depth)
 		{
-			auto &data = json.array("data");
-			std::for_each(data.begin(), data.end(), [&](std::unique_ptr<IJson> &item) { m_data.push_back(item->get<int>()); });
+			Token const token = next();
+			if(token == Token::Error || token == Token::EndOfDocument)
+				return false;
 		}
-		else
-			m_base64Data = json["data"].get<std::string>();
+		return true;
 	}
 
-	return allFound;
-}
-
-/*!
- * 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only.
- * @return list of tile ids
- */
-const std::vector<int> &tson::Chunk::getData() const
-{
-	return m_data;
-}
+	/*!
+	 * Reads the text of the current element, and its end. Call after Token::StartElement.
+	 * Only the first piece of text is returned if the element also has children, which are skipped.
+	 */
+	std::string_view XmlReader::readText()
+	{
+		size_t const depth = m_depth;
+		std::string_view text;
+		bool hasText = false;
+		while(true)
+		{
+			Token const token = next();
+			if(token == Token::Error || token == Token::EndOfDocument)
+				return std::string_view();
+			if(m_depth < depth)
+				return text;
+			if(token == Token::Text && m_depth == depth && !hasText)
+			{
+				text = m_text;
+				hasText = true;
+			}
+		}
+	}
 
-/*!
- * 'data' (when string): Array of unsigned int (GIDs) or base64-encoded data.
- * @return base64 string
- */
-const std::string &tson::Chunk::getBase64Data() const
-{
-	return m_base64Data;
-}
+	XmlReader::Token XmlReader::getToken() const
+	{
+		return m_token;
+	}
 
-/*!
- * x='width' (in tiles) and y='height' (in tiles).
- * @return Size (x and y), containing the values from the fields 'width' and 'height' in Tiled
- */
-const tson::Vector2i &tson::Chunk::getSize() const
-{
-	return m_size;
-}
+	/*!
+	 * The name of the element of Token::StartElement and Token::EndElement
+	 */
+	std::string_view XmlReader::getName() const
+	{
+		return m_name;
+	}
 
-/*!
- * 'x' and 'y' position in tiles
- * @return Position in int
- */
-const tson::Vector2i &tson::Chunk::getPosition() const
-{
-	return m_position;
-}
-/*** End of inlined file: Chunk.hpp ***/
+	/*!
+	 * The text of Token::Text, with entities unresolved
+	 */
+	std::string_view XmlReader::getText() const
+	{
+		return m_text;
+	}
 
+	/*!
+	 * The attributes of Token::StartElement, in the order they appear. Values have their entities unresolved.
+	 */
+	const std::vector<std::pair<std::string_view, std::string_view>> &XmlReader::getAttributes() const
+	{
+		return m_attributes;
+	}
 
-/*** Start of inlined file: Object.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	/*!
+	 * The value of an attribute of Token::StartElement, with entities unresolved. Empty if it does not exist.
+	 */
+	std::string_view XmlReader::getAttribute(std::string_view name) const
+	{
+		for(const auto &[attributeName, value] : m_attributes)
+		{
+			if(attributeName == name)
+				return value;
+		}
+		return std::string_view();
+	}
 
-#ifndef TILESON_OBJECT_HPP
-#define TILESON_OBJECT_HPP
+	bool XmlReader::hasAttribute(std::string_view name) const
+	{
+		for(const auto &attribute : m_attributes)
+		{
+			if(attribute.first == name)
+				return true;
+		}
+		return false;
+	}
 
-//#include "../external/json.hpp"
+	/*!
+	 * true if the element of Token::StartElement is written as <name/>. Its Token::EndElement is still reported.
+	 */
+	bool XmlReader::isEmptyElement() const
+	{
+		return m_isEmptyElement;
+	}
 
+	/*!
+	 * The number of elements that are open. The root element is at depth 1.
+	 */
+	size_t XmlReader::getDepth() const
+	{
+		return m_depth;
+	}
 
-/*** Start of inlined file: PropertyCollection.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	/*!
+	 * Offset in the data of the '<' of the current start or end tag.
+	 * Together with getOffset() after skipElement(), this gives the whole text of an element.
+	 */
+	size_t XmlReader::getTokenOffset() const
+	{
+		return m_tokenStart;
+	}
 
-#ifndef TILESON_PROPERTYCOLLECTION_HPP
-#define TILESON_PROPERTYCOLLECTION_HPP
+	/*!
+	 * Offset in the data right after what has been read
+	 */
+	size_t XmlReader::getOffset() const
+	{
+		return m_pos;
+	}
 
+	/*!
+	 * Resolves the predefined entities (&amp; &lt; &gt; &quot; &apos;) and character references (&#10; &#x20AC;) of a text.
+	 * Unknown entities are kept as they are.
+	 */
+	std::string XmlReader::Unescape(std::string_view text)
+	{
+		std::string result;
+		result.reserve(text.size());
+		size_t pos = 0;
+		while(pos < text.size())
+		{
+			size_t const amp = text.find('&', pos);
+			if(amp == std::string_view::npos)
+			{
+				result.append(text.substr(pos));
+				break;
+			}
+			result.append(text.substr(pos, amp - pos));
+			size_t const semicolon = text.find(';', amp);
+			if(semicolon == std::string_view::npos)
+			{
+				result.append(text.substr(amp));
+				break;
+			}
 
-/*** Start of inlined file: Property.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+			std::string_view const entity = text.substr(amp + 1, semicolon - amp - 1);
+			pos = semicolon + 1;
+			if(entity == "amp") result += '&';
+			else if(entity == "lt") result += '<';
+			else if(entity == "gt") result += '>';
+			else if(entity == "quot") result += '"';
+			else if(entity == "apos") result += '\'';
+			else if(entity.size() > 1 && entity[0] == '#')
+			{
+				bool const isHex = entity[1] == 'x' || entity[1] == 'X';
+				uint32_t code = std::strtoul(std::string(entity.substr(isHex ? 2 : 1)).c_str(), nullptr, isHex ? 16 : 10);
 
-#ifndef TILESON_PROPERTY_HPP
-#define TILESON_PROPERTY_HPP
+				//Encoded as UTF-8
+				if(code < 0x80)
+					result += static_cast<char>(code);
+				else if(code < 0x800)
+				{
+					result += static_cast<char>(0xC0 | (code >> 6));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else if(code < 0x10000)
+				{
+					result += static_cast<char>(0xE0 | (code >> 12));
+					result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else
+				{
+					result += static_cast<char>(0xF0 | (code >> 18));
+					result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+					result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+			}
+			else
+				result.append(text.substr(amp, pos - amp));
+		}
+		return result;
+	}
 
-//#include "../../TilesonConfig.h"
+	XmlReader::Token XmlReader::fail()
+	{
+		m_pendingEnd = false;
+		return m_token = Token::Error;
+	}
 
-//#if USE_CPP17_FILESYSTEM
+	/*!
+	 * Moves past the next occurrence of 'terminator'
+	 */
+	bool XmlReader::skipPast(std::string_view terminator)
+	{
+		size_t const found = std::string_view(m_data, m_size).find(terminator, m_pos);
+		if(found == std::string_view::npos)
+			return false;
+		m_pos = found + terminator.size();
+		return true;
+	}
 
-#include <any>
-#include <string>
+	void XmlReader::skipWhitespace()
+	{
+		while(m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\t' || m_data[m_pos] == '\n' || m_data[m_pos] == '\r'))
+			++m_pos;
+	}
 
-/*** Start of inlined file: Enums.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	bool XmlReader::IsNameChar(char c)
+	{
+		return c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '/' && c != '>' && c != '=';
+	}
 
-#ifndef TILESON_ENUMS_HPP
-#define TILESON_ENUMS_HPP
-#include <cstdint>
+	/*!
+	 * Reads a start or end tag. m_pos is at its '<'.
+	 */
+	bool XmlReader::readTag()
+	{
+		++m_pos;
+		m_attributes.clear();
+		m_isEmptyElement = false;
+		bool const isEnd = m_pos < m_size && m_data[m_pos] == '/';
+		if(isEnd)
+			++m_pos;
+
+		size_t const nameStart = m_pos;
+		while(m_pos < m_size && IsNameChar(m_data[m_pos]))
+			++m_pos;
+		m_name = std::string_view(m_data + nameStart, m_pos - nameStart);
+		if(m_name.empty())
+			return false;
 
-/*** Start of inlined file: EnumBitflags.hpp ***/
-//
-// Created by robin on 08.11.2020.
-//
+		if(isEnd)
+		{
+			skipWhitespace();
+			if(m_pos >= m_size || m_data[m_pos] != '>' || m_depth == 0)
+				return false;
+			++m_pos;
+			--m_depth;
+			m_token = Token::EndElement;
+			return true;
+		}
 
-#ifndef TILESON_ENUMBITFLAGS_HPP
-#define TILESON_ENUMBITFLAGS_HPP
+		while(true)
+		{
+			skipWhitespace();
+			if(m_pos >= m_size)
+				return false;
 
-#include <type_traits>
-#include <iostream>
+			char const c = m_data[m_pos];
+			if(c == '>')
+			{
+				++m_pos;
+				break;
+			}
+			if(c == '/')
+			{
+				if(m_pos + 1 >= m_size || m_data[m_pos + 1] != '>')
+					return false;
+				m_pos += 2;
+				m_isEmptyElement = true;
+				m_pendingEnd = true;
+				break;
+			}
 
-#define TILESON_ENABLE_BITMASK_OPERATORS(x)  \
-namespace tson {                         \
-	ENABLE_BITMASK_OPERATORS(x) \
-}
+			size_t const attributeStart = m_pos;
+			while(m_pos < m_size && IsNameChar(m_data[m_pos]))
+				++m_pos;
+			std::string_view const attributeName(m_data + attributeStart, m_pos - attributeStart);
+			skipWhitespace();
+			if(attributeName.empty() || m_pos >= m_size || m_data[m_pos] != '=')
+				return false;
+			++m_pos;
+			skipWhitespace();
+			if(m_pos >= m_size || (m_data[m_pos] != '"' && m_data[m_pos] != '\''))
+				return false;
 
-namespace tson
-{
-	#define ENABLE_BITMASK_OPERATORS(x)  \
-	template<>                           \
-	struct EnableBitMaskOperators<x>     \
-	{                                    \
-		static const bool enable = true; \
-	};
+			char const quote = m_data[m_pos++];
+			const void *end = std::memchr(m_data + m_pos, quote, m_size - m_pos);
+			if(end == nullptr)
+				return false;
+			size_t const valueEnd = static_cast<size_t>(static_cast<const char *>(end) - m_data);
+			m_attributes.emplace_back(attributeName, std::string_view(m_data + m_pos, valueEnd - m_pos));
+			m_pos = valueEnd + 1;
+		}
 
-	template<typename Enum>
-	struct EnableBitMaskOperators
-	{
-		static const bool enable = false;
-	};
+		++m_depth;
+		m_token = Token::StartElement;
+		return true;
+	}
+}
 
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	operator |(Enum lhs, Enum rhs)
-	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
+#endif //TILESON_XMLREADER_HPP
 
-		using underlying = typename std::underlying_type<Enum>::type;
+/*** End of inlined file: XmlReader.hpp ***/
 
-		return static_cast<Enum> (
-				static_cast<underlying>(lhs) |
-				static_cast<underlying>(rhs)
-		);
-	}
 
-	//Permissions operator &(Permissions lhs, Permissions rhs)
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	operator &(Enum lhs, Enum rhs)
-	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
 
-		using underlying = typename std::underlying_type<Enum>::type;
+/*** Start of inlined file: Inflate.hpp ***/
+#ifndef TILESON_INFLATE_HPP
+#define TILESON_INFLATE_HPP
 
-		return static_cast<Enum> (
-				static_cast<underlying>(lhs) &
-				static_cast<underlying>(rhs)
-		);
-	}
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
 
-	//Permissions operator ^(Permissions lhs, Permissions rhs)
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	operator ^(Enum lhs, Enum rhs)
+namespace tson
+{
+	/*!
+	 * A small DEFLATE (RFC 1951) decompressor, used for tile layer data compressed with 'zlib' or 'gzip'.
+	 * Huffman codes of up to FastBits bits are decoded through a lookup table, longer codes bit by bit.
+	 *
+	 * The checksums of the zlib and gzip formats are not verified.
+	 */
+	class Inflate
 	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
+		public:
+			/*!
+			 * Gets the decompressed data in order, a piece at a time. Returns false to stop decompressing.
+			 */
+			using Sink = std::function<bool(const uint8_t *data, size_t size)>;
 
-		using underlying = typename std::underlying_type<Enum>::type;
+			inline static bool Raw(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+			inline static bool Zlib(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+			inline static bool Gzip(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+			inline static bool Raw(const uint8_t *data, size_t size, const Sink &sink);
+			inline static bool Zlib(const uint8_t *data, size_t size, const Sink &sink);
+			inline static bool Gzip(const uint8_t *data, size_t size, const Sink &sink);
 
-		return static_cast<Enum> (
-				static_cast<underlying>(lhs) ^
-				static_cast<underlying>(rhs)
-		);
-	}
+		private:
+			static constexpr int FastBits = 9;
+			static constexpr int MaxBits = 15;
+			static constexpr size_t WindowSize = 32768;             /*! The longest distance a DEFLATE match can refer back */
+			static constexpr size_t FlushSize = WindowSize * 4;     /*! Size of the output kept in memory before it is given to a Sink */
 
-	//Permissions operator ~(Permissions rhs)
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	operator ~(Enum rhs)
-	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
+			class Huffman
+			{
+				public:
+					inline bool build(const uint8_t *lengths, size_t count);
 
-		using underlying = typename std::underlying_type<Enum>::type;
+					uint16_t counts[MaxBits + 1] {};        /*! Number of codes of each length */
+					uint16_t symbols[288] {};               /*! Symbols ordered by code */
+					uint16_t fast[1 << FastBits] {};        /*! (length << 9) | symbol, by the first FastBits bits (reversed). 0 if the code is longer */
+			};
 
-		return static_cast<Enum> (
-				~static_cast<underlying>(rhs)
-		);
-	}
+			inline Inflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+			inline static size_t ZlibStart(const uint8_t *data, size_t size);
+			inline static size_t GzipStart(const uint8_t *data, size_t size);
+
+			inline bool run();
+			inline void flush(size_t keep);
+			inline bool stored();
+			inline bool codes(const Huffman &lengths, const Huffman &distances);
+			inline bool dynamic(Huffman &lengths, Huffman &distances);
+			inline static void fixed(Huffman &lengths, Huffman &distances);
+
+			inline void refill();
+			inline uint32_t bits(int count);
+			inline int decode(const Huffman &huffman);
+
+			const uint8_t *         m_data;
+			size_t                  m_size;
+			size_t                  m_pos {0};
+			uint64_t                m_bitBuffer {0};
+			int                     m_bitCount {0};
+			int                     m_paddingBits {0};  /*! Zero bits added to m_bitBuffer past the end of the data */
+			bool                    m_error {false};
+			std::vector<uint8_t> &  m_out;
+			const Sink *            m_sink {nullptr};   /*! If set, m_out is only the window of the latest output, and the rest is given to the sink */
+			bool                    m_stopped {false};  /*! The sink does not want more data */
+	};
 
-	//Permissions& operator |=(Permissions &lhs, Permissions rhs)
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	&operator |=(Enum &lhs, Enum rhs)
+	/*!
+	 * Decompresses the 'zlib' compression of Tiled tile layers
+	 */
+	class ZlibDecompressor : public IDecompressor<std::string_view, std::string>
 	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
-
-		using underlying = typename std::underlying_type<Enum>::type;
+		public:
+			[[nodiscard]] inline const std::string &name() const override
+			{
+				return NAME;
+			}
 
-		lhs = static_cast<Enum> (
-				static_cast<underlying>(lhs) |
-				static_cast<underlying>(rhs)
-		);
+			inline std::string decompress(const std::string_view &s) override
+			{
+				return decompress(s.data(), s.size());
+			}
 
-		return lhs;
-	}
+			inline std::string decompressFile(const fs::path &path) override
+			{
+				std::ifstream file(path, std::ios::binary);
+				std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+				return decompress(content);
+			}
 
-	//Permissions& operator &=(Permissions &lhs, Permissions rhs)
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	&operator &=(Enum &lhs, Enum rhs)
-	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
-
-		using underlying = typename std::underlying_type<Enum>::type;
-
-		lhs = static_cast<Enum> (
-				static_cast<underlying>(lhs) &
-				static_cast<underlying>(rhs)
-		);
+			inline std::string decompress(const void *data, size_t size) override
+			{
+				std::vector<uint8_t> out;
+				if(!Inflate::Zlib(static_cast<const uint8_t *>(data), size, out))
+					return std::string();
+				return std::string(out.begin(), out.end());
+			}
 
-		return lhs;
-	}
+		private:
+			inline static const std::string NAME = "zlib";
+	};
 
-	//Permissions& operator ^=(Permissions &lhs, Permissions rhs)
-	template<typename Enum>
-	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
-	&operator ^=(Enum &lhs, Enum rhs)
+	/*!
+	 * Decompresses the 'gzip' compression of Tiled tile layers
+	 */
+	class GzipDecompressor : public IDecompressor<std::string_view, std::string>
 	{
-		static_assert(std::is_enum<Enum>::value,
-					  "template parameter is not an enum type");
-
-		using underlying = typename std::underlying_type<Enum>::type;
-
-		lhs = static_cast<Enum> (
-				static_cast<underlying>(lhs) ^
-				static_cast<underlying>(rhs)
-		);
-
-		return lhs;
-	}
-}
+		public:
+			[[nodiscard]] inline const std::string &name() const override
+			{
+				return NAME;
+			}
 
-#endif //TILESON_ENUMBITFLAGS_HPP
+			inline std::string decompress(const std::string_view &s) override
+			{
+				return decompress(s.data(), s.size());
+			}
 
-/*** End of inlined file: EnumBitflags.hpp ***/
+			inline std::string decompressFile(const fs::path &path) override
+			{
+				std::ifstream file(path, std::ios::binary);
+				std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+				return decompress(content);
+			}
 
+			inline std::string decompress(const void *data, size_t size) override
+			{
+				std::vector<uint8_t> out;
+				if(!Inflate::Gzip(static_cast<const uint8_t *>(data), size, out))
+					return std::string();
+				return std::string(out.begin(), out.end());
+			}
 
-namespace tson
-{
-	/*!
-	 * Type used in Property.hpp
-	 */
-	enum class Type : uint8_t
-	{
-			Undefined = 0,
-			Color = 1, /*! color */
-			File = 2, /*! file */
-			Int = 3, /*! int */
-			Boolean = 4, /*! bool */
-			Float = 5, /*! float */
-			String = 6, /*! string */
-			Class = 7, /*! class */
-			Enum = 8,  /*! 'string' or 'int' with a value in 'propertyType' */
-			Object = 9 /*! object */
+		private:
+			inline static const std::string NAME = "gzip";
 	};
 
-	/*!
-	 * Layer.hpp - LayerType
-	 * //'type': tilelayer, objectgroup, imagelayer or group
-	 */
-	enum class LayerType : uint8_t
+	Inflate::Inflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out) : m_data {data}, m_size {size}, m_out {out}
 	{
-			Undefined = 0,
-			TileLayer = 1,
-			ObjectGroup = 2,
-			ImageLayer = 3,
-			Group = 4
-	};
+
+	}
 
 	/*!
-	 * Tileset.hpp - TilesetType
-	 * //'type': imagetileset, imagecollectiontileset
+	 * Decompresses raw DEFLATE data
+	 * @param out The decompressed data is appended to 'out'
+	 * @return false if the data is invalid or incomplete
 	 */
-	enum class TilesetType : uint8_t
+	bool Inflate::Raw(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
 	{
-		Undefined = 0,
-		ImageTileset = 1,
-		ImageCollectionTileset = 2
-	};
+		Inflate inflate {data, size, out};
+		return inflate.run();
+	}
 
 	/*!
-	 * Map.hpp - ParseStatus
+	 * Decompresses data in the zlib format (RFC 1950)
+	 * @param out The decompressed data is appended to 'out'
+	 * @return false if the data is invalid or incomplete
 	 */
-	enum class ParseStatus : uint8_t
+	bool Inflate::Zlib(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
 	{
-			OK = 0, //OK unless otherwise stated
-			FileNotFound = 1,
-			ParseError = 2,
-			MissingData = 3,
-			DecompressionError = 4
-	};
+		size_t const start = ZlibStart(data, size);
+		return start > 0 && Raw(data + start, size - start, out);
+	}
 
 	/*!
-	 * Object.hpp - ObjectType
+	 * Decompresses data in the gzip format (RFC 1952). Only the first member is read.
+	 * @param out The decompressed data is appended to 'out'
+	 * @return false if the data is invalid or incomplete
 	 */
-	enum class ObjectType : uint8_t
+	bool Inflate::Gzip(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
 	{
-			Undefined = 0,
-			Object = 1,
-			Ellipse = 2,
-			Rectangle = 3,
-			Point = 4,
-			Polygon = 5,
-			Polyline = 6,
-			Text = 7,
-			Template = 8
-	};
+		size_t const start = GzipStart(data, size);
+		return start > 0 && Raw(data + start, size - start, out);
+	}
 
-	static constexpr uint32_t FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
-	static constexpr uint32_t FLIPPED_VERTICALLY_FLAG   = 0x40000000;
-	static constexpr uint32_t FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
 	/*!
-	 * Object.hpp - ObjectFlipFlags
+	 * Decompresses raw DEFLATE data without keeping all of it in memory. Only the last FlushSize bytes are kept,
+	 * so the memory use does not depend on the size of the output.
+	 * @param sink Gets the decompressed data in order. Decompressing stops early if it returns false.
+	 * @return false if the data is invalid or incomplete. true if the sink stopped it.
 	 */
-	enum class TileFlipFlags : uint32_t
+	bool Inflate::Raw(const uint8_t *data, size_t size, const Sink &sink)
 	{
-			None = 0,
-			Diagonally = FLIPPED_DIAGONALLY_FLAG,
-			Vertically = FLIPPED_VERTICALLY_FLAG,
-			Horizontally = FLIPPED_HORIZONTALLY_FLAG
-	};
+		std::vector<uint8_t> window;
+		window.reserve(FlushSize + WindowSize);
+		Inflate inflate {data, size, window};
+		inflate.m_sink = &sink;
+		return inflate.run();
+	}
 
 	/*!
-	 * Tileset.hpp - ObjectAlignment
+	 * Decompresses data in the zlib format without keeping all of it in memory. See Raw().
 	 */
-	enum class ObjectAlignment : uint8_t
+	bool Inflate::Zlib(const uint8_t *data, size_t size, const Sink &sink)
 	{
-			Unspecified = 0,    //unspecified
-			TopLeft = 1,        //topleft
-			Top = 2,            //top
-			TopRight = 3,       //topright
-			Left = 4,           //left
-			Center = 5,         //center
-			Right = 6,          //right
-			BottomLeft = 7,     //bottomleft
-			Bottom = 8,         //bottom
-			BottomRight = 9     //bottomright
-	};
+		size_t const start = ZlibStart(data, size);
+		return start > 0 && Raw(data + start, size - start, sink);
+	}
 
 	/*!
-	 * Text.hpp - TextAlignment
+	 * Decompresses data in the gzip format without keeping all of it in memory. See Raw().
 	 */
-	enum class TextAlignment : uint8_t
+	bool Inflate::Gzip(const uint8_t *data, size_t size, const Sink &sink)
 	{
-		Unresolved = 0,
-		Left = 1,           //left
-		Center = 2,         //center
-		Right = 3,          //right
-		Justify = 4,        //justify
-		Top = 5,            //top
-		Bottom = 6          //bottom
-	};
+		size_t const start = GzipStart(data, size);
+		return start > 0 && Raw(data + start, size - start, sink);
+	}
 
 	/*!
-	 * Tileset.hpp - TileRenderSize - From Tiled v1.9
+	 * @return The offset of the DEFLATE data after the zlib header. 0 if the header is invalid.
 	 */
-	enum class TileRenderSize : uint8_t
+	size_t Inflate::ZlibStart(const uint8_t *data, size_t size)
 	{
-		Undefined = 0,
-		Tile = 1,  //tile (default)
-		Grid = 2   //grid
-	};
+		if(size < 2)
+			return 0;
+
+		uint8_t const method = data[0];
+		uint8_t const flags = data[1];
+		bool const validHeader = (method & 0x0f) == 8 && ((method << 8) | flags) % 31 == 0;
+		bool const hasDictionary = (flags & 0x20) != 0;
+		return (validHeader && !hasDictionary) ? 2 : 0;
+	}
 
 	/*!
-	 * Tileset.hpp - FillMode - From Tiled v1.9
+	 * @return The offset of the DEFLATE data after the gzip header. 0 if the header is invalid.
 	 */
-	enum class FillMode : uint8_t
+	size_t Inflate::GzipStart(const uint8_t *data, size_t size)
 	{
-		Undefined = 0,
-		Stretch = 1,            //stretch (default)
-		PreserveAspectFit = 2   //preserve-aspect-fit
-	};
+		if(size < 18 || data[0] != 0x1f || data[1] != 0x8b || data[2] != 8)
+			return 0;
 
-	enum class EnumStorageType : uint8_t
-	{
-		Unspecified = 0,
-		Int = 1,
-		String = 2
-	};
+		uint8_t const flags = data[3];
+		size_t pos = 10;
+		if(flags & 0x04) //FEXTRA
+		{
+			if(pos + 2 > size)
+				return 0;
+			pos += 2 + (data[pos] | (data[pos + 1] << 8));
+		}
+		for(uint8_t const flag : {uint8_t(0x08), uint8_t(0x10)}) //FNAME and FCOMMENT are zero-terminated
+		{
+			if(flags & flag)
+			{
+				while(pos < size && data[pos] != 0)
+					++pos;
+				++pos;
+			}
+		}
+		if(flags & 0x02) //FHCRC
+			pos += 2;
 
-	ENABLE_BITMASK_OPERATORS(TileFlipFlags)
-}
+		return (pos > size) ? 0 : pos;
+	}
 
-#endif //TILESON_ENUMS_HPP
+	bool Inflate::Huffman::build(const uint8_t *lengths, size_t count)
+	{
+		std::memset(counts, 0, sizeof(counts));
+		std::memset(fast, 0, sizeof(fast));
+		for(size_t i = 0; i < count; ++i)
+			++counts[lengths[i]];
+		counts[0] = 0;
+
+		//An over-subscribed set of lengths is invalid. Incomplete sets are allowed, as they are used for single distance codes.
+		int left = 1;
+		for(int length = 1; length <= MaxBits; ++length)
+		{
+			left = (left << 1) - counts[length];
+			if(left < 0)
+				return false;
+		}
 
-/*** End of inlined file: Enums.hpp ***/
+		uint16_t offsets[MaxBits + 1] {};
+		for(int length = 1; length < MaxBits; ++length)
+			offsets[length + 1] = static_cast<uint16_t>(offsets[length] + counts[length]);
+		for(size_t symbol = 0; symbol < count; ++symbol)
+		{
+			if(lengths[symbol] != 0)
+				symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+		}
 
+		//Canonical codes are read least significant bit first, so the table is indexed by the reversed code
+		uint32_t code = 0;
+		size_t index = 0;
+		for(int length = 1; length <= FastBits; ++length)
+		{
+			for(int i = 0; i < counts[length]; ++i, ++code, ++index)
+			{
+				uint32_t reversed = 0;
+				for(int bit = 0; bit < length; ++bit)
+					reversed |= ((code >> bit) & 1u) << (length - 1 - bit);
 
-//#include "../external/json.hpp"
+				for(uint32_t entry = reversed; entry < (1u << FastBits); entry += (1u << length))
+					fast[entry] = static_cast<uint16_t>((length << 9) | symbols[index]);
+			}
+			code <<= 1;
+		}
 
-namespace tson
-{
-	class Project;
+		return true;
+	}
 
-	class Property
+	void Inflate::refill()
 	{
-		public:
-			inline Property();
-			inline explicit Property(IJson &json, tson::Project *project = nullptr);
-			inline Property(std::string name, std::any value, Type type);
-
-			inline void setValue(const std::any &value);
-			inline void setStrValue(const std::string &value);
-			inline void setName(const std::string &name);
-
-			[[nodiscard]] inline const std::type_info& getValueType() const;
-			inline std::string getValueTypeInfo();
-			[[nodiscard]]inline const std::any &getValue() const;
-			template <typename T>
-			inline T getValue() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline Type getType() const;
-			[[nodiscard]] inline const std::string &getPropertyType() const;
-
-			//Became public in v1.4.0
-			inline void setValueByType(IJson &json); //Definition in tileson_forward.hpp
-
-		protected:
-			inline void setTypeByString(const std::string &str);
+		while(m_bitCount <= 56)
+		{
+			if(m_pos < m_size)
+				m_bitBuffer |= static_cast<uint64_t>(m_data[m_pos++]) << m_bitCount;
+			else
+				m_paddingBits += 8;
+			m_bitCount += 8;
+		}
+	}
 
-			tson::Project *m_project = nullptr; //Used for resolving 'enum' and 'class' objects
-			Type m_type = Type::Undefined;
-			std::string m_name {};
-			std::string m_propertyType {};
-			std::any m_value; //Using std::any to assign any type
-	};
+	uint32_t Inflate::bits(int count)
+	{
+		if(m_bitCount < count)
+			refill();
+
+		uint32_t const value = static_cast<uint32_t>(m_bitBuffer & ((uint64_t(1) << count) - 1));
+		m_bitBuffer >>= count;
+		m_bitCount -= count;
+		if(m_bitCount < m_paddingBits)
+			m_error = true;
+		return value;
+	}
 
-	template<typename T>
-	T Property::getValue() const
+	int Inflate::decode(const Huffman &huffman)
 	{
-		bool isCorrectType = (m_value.type() == typeid(T));
+		if(m_bitCount < MaxBits)
+			refill();
 
-		if(isCorrectType)
+		uint16_t const entry = huffman.fast[m_bitBuffer & ((1u << FastBits) - 1)];
+		if(entry != 0)
 		{
-			T value = std::any_cast<T>(m_value);
-			return value;
+			bits(entry >> 9);
+			return entry & 0x1ff;
 		}
-		else
+
+		//Slow path for long codes: The canonical code is read one bit at a time
+		int code = 0;
+		int first = 0;
+		int index = 0;
+		for(int length = 1; length <= MaxBits; ++length)
 		{
-			static T defaultValue;
-			return defaultValue;
+			code |= static_cast<int>(bits(1));
+			int const count = huffman.counts[length];
+			if(code - count < first)
+				return huffman.symbols[index + (code - first)];
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
 		}
+		m_error = true;
+		return -1;
 	}
-}
 
-tson::Property::Property() : m_name {"unnamed"}
-{
+	bool Inflate::run()
+	{
+		Huffman lengths;
+		Huffman distances;
+		bool last = false;
+		while(!last && !m_error && !m_stopped)
+		{
+			last = bits(1) == 1;
+			uint32_t const type = bits(2);
+			bool ok = false;
+			if(type == 0)
+				ok = stored();
+			else if(type == 1)
+			{
+				fixed(lengths, distances);
+				ok = codes(lengths, distances);
+			}
+			else if(type == 2)
+				ok = dynamic(lengths, distances) && codes(lengths, distances);
 
-}
+			if(!ok)
+				return false;
+		}
 
-tson::Property::Property(IJson &json, tson::Project *project) : m_project {project}
-{
-	m_name = json["name"].get<std::string>();
-	if(json.count("propertytype") > 0)
-		m_propertyType = json["propertytype"].get<std::string>();
-	else if(json.count("propertyType") > 0) //Somehow Tiled's class objects uses propertyType with 'T'.
-		m_propertyType = json["propertyType"].get<std::string>();
+		if(m_sink != nullptr && !m_stopped && !m_error)
+			flush(0);
+		return !m_error;
+	}
 
-	setTypeByString(json["type"].get<std::string>());
-	setValueByType(json["value"]);
-}
+	/*!
+	 * Gives all but the last 'keep' bytes of the output to the sink.
+	 */
+	void Inflate::flush(size_t keep)
+	{
+		if(m_out.size() <= keep)
+			return;
 
-tson::Property::Property(std::string name, std::any value, Type type) : m_type {type}, m_name { std::move(name) }, m_value { std::move(value) }
-{
+		size_t const count = m_out.size() - keep;
+		m_stopped = !(*m_sink)(m_out.data(), count);
+		m_out.erase(m_out.begin(), m_out.begin() + static_cast<std::ptrdiff_t>(count));
+	}
 
-}
+	bool Inflate::stored()
+	{
+		bits(m_bitCount % 8);
+		uint32_t const length = bits(16);
+		uint32_t const complement = bits(16);
+		if(m_error || (length ^ 0xffffu) != complement)
+			return false;
 
-void tson::Property::setValue(const std::any &value)
-{
-	m_value = value;
-}
+		//Bytes still in the bit buffer are read first, the rest is copied directly
+		uint32_t remaining = length;
+		while(remaining > 0 && m_bitCount > m_paddingBits)
+		{
+			m_out.push_back(static_cast<uint8_t>(bits(8)));
+			--remaining;
+		}
+		if(m_pos + remaining > m_size)
+			return false;
 
-/*!
- * Sets the value specifically as string.
- * When not specified as std::string, the default is that the value will be set as char * when adding a value like "test"
- * This function is to make sure the value is added as string.
- * @param value
- */
-void tson::Property::setStrValue(const std::string &value)
-{
-	m_value = value;
-}
+		m_out.insert(m_out.end(), m_data + m_pos, m_data + m_pos + remaining);
+		m_pos += remaining;
+		if(m_sink != nullptr && m_out.size() >= FlushSize)
+			flush(WindowSize);
+		return !m_error;
+	}
 
-const std::any &tson::Property::getValue() const
-{
-	return m_value;
-}
+	bool Inflate::codes(const Huffman &lengths, const Huffman &distances)
+	{
+		static constexpr uint16_t LengthBase[29] {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+		static constexpr uint8_t LengthExtra[29] {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+		static constexpr uint16_t DistanceBase[30] {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+													4097, 6145, 8193, 12289, 16385, 24577};
+		static constexpr uint8_t DistanceExtra[30] {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
 
-void tson::Property::setName(const std::string &name)
-{
-	m_name = name;
-}
+		while(!m_error && !m_stopped)
+		{
+			if(m_sink != nullptr && m_out.size() >= FlushSize)
+			{
+				flush(WindowSize);
+				continue;
+			}
 
-const std::string &tson::Property::getName() const
-{
-	return m_name;
-}
+			int symbol = decode(lengths);
+			if(symbol < 0)
+				return false;
+			if(symbol < 256)
+			{
+				m_out.push_back(static_cast<uint8_t>(symbol));
+				continue;
+			}
+			if(symbol == 256)
+				return true;
 
-/*!
- * Gets the value type as std::value_info.
- * This can easily be compared to types like this:
- * Check if int: getValueType() == typeid(int)
- * @return
- */
+			symbol -= 257;
+			if(symbol >= 29)
+				return false;
+			size_t const length = LengthBase[symbol] + bits(LengthExtra[symbol]);
 
-const std::type_info &tson::Property::getValueType() const
-{
-	return m_value.type();
-}
+			int const distanceSymbol = decode(distances);
+			if(distanceSymbol < 0 || distanceSymbol >= 30)
+				return false;
+			size_t const distance = DistanceBase[distanceSymbol] + bits(DistanceExtra[distanceSymbol]);
+			if(distance > m_out.size())
+				return false;
 
-/*!
- * Gets the value type as std::string
- * Examples of known types:
- * "i" = int
- * "f" = float
- * "b" = bool
- * @return
- */
-std::string tson::Property::getValueTypeInfo()
-{
-	return m_value.type().name();
-}
+			//The copy may overlap the bytes it creates, so it must go forward one byte at a time
+			size_t const start = m_out.size();
+			m_out.resize(start + length);
+			uint8_t *out = m_out.data() + start;
+			for(size_t i = 0; i < length; ++i)
+				out[i] = out[i - distance];
+		}
+		return m_stopped && !m_error;
+	}
 
-tson::Type tson::Property::getType() const
-{
-	return m_type;
-}
+	void Inflate::fixed(Huffman &lengths, Huffman &distances)
+	{
+		uint8_t codeLengths[288];
+		std::memset(codeLengths, 8, 144);
+		std::memset(codeLengths + 144, 9, 112);
+		std::memset(codeLengths + 256, 7, 24);
+		std::memset(codeLengths + 280, 8, 8);
+		lengths.build(codeLengths, 288);
+
+		std::memset(codeLengths, 5, 30);
+		distances.build(codeLengths, 30);
+	}
 
-void tson::Property::setTypeByString(const std::string &str)
-{
-	if(str == "color")
-		m_type = tson::Type::Color;
-	else if(str == "file")
-		m_type = tson::Type::File;
-	else if(str == "int")
-		m_type = tson::Type::Int;
-	else if(str == "bool")
-		m_type = tson::Type::Boolean;
-	else if(str == "float")
-		m_type = tson::Type::Float;
-	else if(str == "string")
-		m_type = tson::Type::String;
-	else if(str == "class")
-		m_type = tson::Type::Class;
-	else if(str == "object")
-		m_type = tson::Type::Object;
-	else
-		m_type = tson::Type::Undefined;
-}
+	bool Inflate::dynamic(Huffman &lengths, Huffman &distances)
+	{
+		static constexpr uint8_t Order[19] {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
 
-const std::string &tson::Property::getPropertyType() const
-{
-	return m_propertyType;
-}
+		uint32_t const lengthCount = bits(5) + 257;
+		uint32_t const distanceCount = bits(5) + 1;
+		uint32_t const codeCount = bits(4) + 4;
+		if(lengthCount > 286 || distanceCount > 30)
+			return false;
 
-#endif //TILESON_PROPERTY_HPP
+		uint8_t codeLengths[320] {};
+		for(uint32_t i = 0; i < codeCount; ++i)
+			codeLengths[Order[i]] = static_cast<uint8_t>(bits(3));
 
-/*** End of inlined file: Property.hpp ***/
+		Huffman codeLengthCodes;
+		if(!codeLengthCodes.build(codeLengths, 19))
+			return false;
 
-//#include "../external/json.hpp"
-#include <map>
+		std::memset(codeLengths, 0, sizeof(codeLengths));
+		uint32_t index = 0;
+		while(index < lengthCount + distanceCount)
+		{
+			int const symbol = decode(codeLengthCodes);
+			if(symbol < 0 || m_error)
+				return false;
+			if(symbol < 16)
+			{
+				codeLengths[index++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+
+			uint8_t length = 0;
+			uint32_t repeat = 0;
+			if(symbol == 16)
+			{
+				if(index == 0)
+					return false;
+				length = codeLengths[index - 1];
+				repeat = 3 + bits(2);
+			}
+			else if(symbol == 17)
+				repeat = 3 + bits(3);
+			else
+				repeat = 11 + bits(7);
+
+			if(index + repeat > lengthCount + distanceCount)
+				return false;
+			while(repeat-- > 0)
+				codeLengths[index++] = length;
+		}
+
+		//The end of block code must exist
+		if(codeLengths[256] == 0)
+			return false;
+
+		return lengths.build(codeLengths, lengthCount) && distances.build(codeLengths + lengthCount, distanceCount);
+	}
+}
+
+#endif //TILESON_INFLATE_HPP
+
+/*** End of inlined file: Inflate.hpp ***/
 
 namespace tson
 {
-	class PropertyCollection
+	/*!
+	 * Reads the XML formats of Tiled: Maps (.tmx), tilesets (.tsx) and templates (.tx).
+	 *
+	 * The XML is read with a tson::XmlReader, and turned directly into the values the Tiled json format would have,
+	 * so the rest of Tileson reads it like any other json. No XML document is kept in memory. Tile layer data, in csv, base64,
+	 * base64 with zlib or gzip, or as <tile> elements, is decoded straight into arrays of gids, and read by tson::Layer and
+	 * tson::Chunk through readArray().
+	 *
+	 * Example:
+	 * tson::Tileson t {std::make_unique<tson::TmxJson>()};
+	 * std::unique_ptr<tson::Map> map = t.parse("map.tmx");
+	 */
+	class TmxJson : public tson::IJson
 	{
 		public:
-			inline PropertyCollection() = default;
+			inline TmxJson() = default;
+
+			inline IJson &operator[](std::string_view key) override;
+			inline IJson &at(std::string_view key) override;
+			inline IJson &at(size_t pos) override;
+			inline std::vector<std::unique_ptr<IJson>> array() override;
+			inline std::vector<std::unique_ptr<IJson>> &array(std::string_view key) override;
+			[[nodiscard]] inline size_t size() const override;
+
+			inline bool parse(const fs::path &path) override;
+			inline bool parse(const void *data, size_t size) override;
+
+			[[nodiscard]] inline size_t count(std::string_view key) const override;
+			[[nodiscard]] inline bool any(std::string_view key) const override;
+			[[nodiscard]] inline bool isArray() const override;
+			[[nodiscard]] inline bool isObject() const override;
+			[[nodiscard]] inline bool isNull() const override;
+			inline bool readArray(std::string_view key, std::vector<uint32_t> &values) override;
+			inline bool readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength,
+										size_t x, size_t y, size_t width, size_t height) override;
+
+			[[nodiscard]] inline fs::path directory() const override;
+			inline void directory(const fs::path &directory) override;
+			inline std::unique_ptr<IJson> create() override;
 
-			inline explicit PropertyCollection(std::string id);
+		protected:
+			[[nodiscard]] inline int32_t getInt32(std::string_view key) override;
+			[[nodiscard]] inline uint32_t getUInt32(std::string_view key) override;
+			[[nodiscard]] inline int64_t getInt64(std::string_view key) override;
+			[[nodiscard]] inline uint64_t getUInt64(std::string_view key) override;
+			[[nodiscard]] inline double getDouble(std::string_view key) override;
+			[[nodiscard]] inline float getFloat(std::string_view key) override;
+			[[nodiscard]] inline std::string getString(std::string_view key) override;
+			[[nodiscard]] inline bool getBool(std::string_view key) override;
+
+			[[nodiscard]] inline int32_t getInt32() override;
+			[[nodiscard]] inline uint32_t getUInt32() override;
+			[[nodiscard]] inline int64_t getInt64() override;
+			[[nodiscard]] inline uint64_t getUInt64() override;
+			[[nodiscard]] inline double getDouble() override;
+			[[nodiscard]] inline float getFloat() override;
+			[[nodiscard]] inline std::string getString() override;
+			[[nodiscard]] inline bool getBool() override;
 
-			inline tson::Property * add(const tson::Property &property);
-			inline tson::Property * add(IJson &json, tson::Project *project = nullptr);
-			inline tson::Property * add(const std::string &name, const std::any &value, tson::Type type);
+		private:
+			/*!
+			 * A json value. Numbers and booleans are kept as the text of the XML, and converted when they are read.
+			 */
+			class Node
+			{
+				public:
+					enum class Kind : uint8_t
+					{
+						Null = 0,
+						Value = 1,
+						Array = 2,
+						Object = 3,
+						Tiles = 4           /*! An array of gids, kept in 'tiles' */
+					};
+
+					inline Node() = default;
+					inline explicit Node(Kind nodeKind);
+
+					inline Node &add(std::string_view key, Kind nodeKind);
+					inline Node &set(std::string_view key, std::string_view text);
+					inline Node &push(Kind nodeKind);
+					inline Node &getOrAdd(std::string_view key, Kind nodeKind);
+					[[nodiscard]] inline const Node *find(std::string_view key) const;
+
+					Kind                                    kind {Kind::Null};
+					std::string                             value;
+					std::vector<std::string>                keys;       /*! Keys of the children of an object */
+					std::vector<std::unique_ptr<Node>>      children;
+					std::vector<uint32_t>                   tiles;
+			};
 
-			inline void remove(const std::string &name);
+			inline TmxJson(const Node *node, const fs::path &path);
+			inline explicit TmxJson(std::unique_ptr<Node> node);
+
+			inline IJson &child(std::string_view key);
+			[[nodiscard]] inline const Node *value(std::string_view key) const;
+			inline void clearCache();
+			inline static const Node *GetNullNode();
+
+			inline static bool ReadDocument(XmlReader &reader, Node &root);
+			inline static bool ReadMap(XmlReader &reader, Node &map);
+			inline static bool ReadTileset(XmlReader &reader, Node &tileset);
+			inline static bool ReadTemplate(XmlReader &reader, Node &templ);
+			inline static bool ReadTile(XmlReader &reader, Node &tile);
+			inline static bool ReadWangSet(XmlReader &reader, Node &wangset);
+			inline static bool ReadLayer(XmlReader &reader, Node &layer);
+			inline static bool ReadData(XmlReader &reader, Node &layer);
+			inline static bool ReadObject(XmlReader &reader, Node &object);
+			inline static bool ReadText(XmlReader &reader, Node &text);
+			inline static bool ReadProperties(XmlReader &reader, Node &properties);
+			inline static bool ReadClassMembers(XmlReader &reader, Node &members);
+			inline static bool ReadImage(XmlReader &reader, Node &node);
+			inline static bool ReadChildren(XmlReader &reader, const std::function<bool(std::string_view)> &readChild);
+
+			inline static void ReadAttributes(const XmlReader &reader, Node &node);
+			inline static void SetDefault(Node &node, std::string_view key, std::string_view text);
+			inline static void ReadPoints(std::string_view points, Node &array);
+			inline static void ReadWangId(std::string_view wangid, Node &array);
+			inline static bool DecodeTiles(std::string_view text, std::string_view encoding, std::string_view compression, std::vector<uint32_t> &tiles);
+
+			std::unique_ptr<Node>   m_root;                 /*! Only used if this is the owner! */
+			const Node *            m_node {GetNullNode()};
+			fs::path                m_path;
 
-			inline void setValue(const std::string &name, const std::any &value);
-			inline void setProperty(const std::string &name, const tson::Property &value);
-			inline void setId(const std::string &id);
+			//Cache!
+			std::map<std::string, std::unique_ptr<IJson>, std::less<>> m_arrayCache;
+			std::map<size_t, std::unique_ptr<IJson>> m_arrayPosCache;
+			std::map<std::string, std::vector<std::unique_ptr<IJson>>, std::less<>> m_arrayListDataCache;
+	};
 
-			inline bool hasProperty(const std::string &name);
-			inline tson::Property * getProperty(const std::string &name);
-			inline std::map<std::string, Property> &getProperties();
-			inline std::vector<Property*> get();
-			template <typename T>
-			inline T getValue(const std::string &name);
-			[[nodiscard]] inline const std::string &getId() const;
-			[[nodiscard]] inline size_t getSize() const;
+	TmxJson::Node::Node(Kind nodeKind) : kind {nodeKind}
+	{
 
-		protected:
-			std::string m_id;
-			std::map<std::string, tson::Property> m_properties;
-	};
-}
+	}
 
-template<typename T>
-T tson::PropertyCollection::getValue(const std::string &name)
-{
-	static T defaultT;
-	return (m_properties.count(name) > 0) ? m_properties[name].getValue<T>() : defaultT;
-}
+	TmxJson::Node &TmxJson::Node::add(std::string_view key, Kind nodeKind)
+	{
+		keys.emplace_back(key);
+		return *children.emplace_back(std::make_unique<Node>(nodeKind));
+	}
 
-tson::PropertyCollection::PropertyCollection(std::string id) : m_id {std::move(id)}
-{
+	TmxJson::Node &TmxJson::Node::set(std::string_view key, std::string_view text)
+	{
+		Node &node = add(key, Kind::Value);
+		node.value = text;
+		return node;
+	}
 
-}
+	TmxJson::Node &TmxJson::Node::push(Kind nodeKind)
+	{
+		return *children.emplace_back(std::make_unique<Node>(nodeKind));
+	}
 
-tson::Property *tson::PropertyCollection::add(const tson::Property &property)
-{
-	m_properties[property.getName()] = property;
-	return &m_properties[property.getName()];
-}
+	/*!
+	 * Gets the child with a key, and adds it if it does not exist. Used for arrays built from repeated elements, like 'layers'.
+	 */
+	TmxJson::Node &TmxJson::Node::getOrAdd(std::string_view key, Kind nodeKind)
+	{
+		for(size_t i = 0; i < keys.size(); ++i)
+		{
+			if(keys[i] == key)
+				return *children[i];
+		}
+		return add(key, nodeKind);
+	}
 
-tson::Property *tson::PropertyCollection::add(IJson &json, tson::Project *project)
-{
-	tson::Property property = tson::Property(json, project);
-	const std::string name = property.getName();
-	m_properties[name] = std::move(property);
-	return &m_properties[name];
-}
+	const TmxJson::Node *TmxJson::Node::find(std::string_view key) const
+	{
+		for(size_t i = 0; i < keys.size(); ++i)
+		{
+			if(keys[i] == key)
+				return children[i].get();
+		}
+		return nullptr;
+	}
 
-tson::Property *tson::PropertyCollection::add(const std::string &name, const std::any &value, tson::Type type)
-{
-	m_properties[name] = {name, value, type};
-	return &m_properties[name];
-}
+	TmxJson::TmxJson(const Node *node, const fs::path &path) : m_node {node}, m_path {path}
+	{
 
-void tson::PropertyCollection::remove(const std::string &name)
-{
-	m_properties.erase(name);
-}
+	}
 
-/*!
- * Sets a value IF the property already exists. Does nothing otherwise.
- * See add() for adding new properties
- * @param name
- * @param value
- */
-void tson::PropertyCollection::setValue(const std::string &name, const std::any &value)
-{
-	if(m_properties.count(name) > 0)
-		m_properties[name].setValue(value);
-}
+	TmxJson::TmxJson(std::unique_ptr<Node> node) : m_root {std::move(node)}, m_node {m_root.get()}
+	{
 
-/*!
- * Overwrites the current property if it exists, or adds it if it doesn't.
- * @param name
- * @param value
- */
-void tson::PropertyCollection::setProperty(const std::string &name, const tson::Property &value)
-{
-	m_properties[name] = value;
-}
+	}
 
-void tson::PropertyCollection::setId(const std::string &id)
-{
-	m_id = id;
-}
+	IJson &TmxJson::operator[](std::string_view key)
+	{
+		return child(key);
+	}
 
-bool tson::PropertyCollection::hasProperty(const std::string &name)
-{
-	return m_properties.count(name) > 0;
-}
-
-tson::Property *tson::PropertyCollection::getProperty(const std::string &name)
-{
-	return (m_properties.count(name) > 0) ? &m_properties[name] : nullptr;
-}
-
-std::map<std::string, tson::Property> &tson::PropertyCollection::getProperties()
-{
-	return m_properties;
-}
-
-/*!
- * Gets vector of pointers to all the existing properties
- * @return
- */
-std::vector<tson::Property *> tson::PropertyCollection::get()
-{
-	std::vector<tson::Property *> props;
-	for(auto &i : m_properties)
-		props.emplace_back(&i.second);
+	IJson &TmxJson::at(std::string_view key)
+	{
+		return child(key);
+	}
 
-	return props;
-}
+	IJson &TmxJson::at(size_t pos)
+	{
+		auto it = m_arrayPosCache.find(pos);
+		if(it == m_arrayPosCache.end())
+		{
+			std::unique_ptr<IJson> item;
+			if(m_node->kind == Node::Kind::Tiles)
+			{
+				std::unique_ptr<Node> tile = std::make_unique<Node>(Node::Kind::Value);
+				tile->value = std::to_string(m_node->tiles.at(pos));
+				item = std::unique_ptr<IJson>(new TmxJson(std::move(tile)));
+			}
+			else
+				item = std::unique_ptr<IJson>(new TmxJson(m_node->children.at(pos).get(), m_path));
+			it = m_arrayPosCache.emplace(pos, std::move(item)).first;
+		}
+		return *it->second;
+	}
 
-const std::string &tson::PropertyCollection::getId() const
-{
-	return m_id;
-}
+	std::vector<std::unique_ptr<IJson>> TmxJson::array()
+	{
+		std::vector<std::unique_ptr<IJson>> vec;
+		if(m_node->kind == Node::Kind::Array)
+		{
+			for(const std::unique_ptr<Node> &item : m_node->children)
+				vec.emplace_back(new TmxJson(item.get(), m_path));
+		}
+		else if(m_node->kind == Node::Kind::Tiles)
+		{
+			for(uint32_t tile : m_node->tiles)
+			{
+				std::unique_ptr<Node> node = std::make_unique<Node>(Node::Kind::Value);
+				node->value = std::to_string(tile);
+				vec.emplace_back(new TmxJson(std::move(node)));
+			}
+		}
+		return vec;
+	}
 
-size_t tson::PropertyCollection::getSize() const
-{
-	return m_properties.size();
-}
+	std::vector<std::unique_ptr<IJson>> &TmxJson::array(std::string_view key)
+	{
+		auto it = m_arrayListDataCache.find(key);
+		if(it == m_arrayListDataCache.end())
+		{
+			it = m_arrayListDataCache.emplace(std::string(key), std::vector<std::unique_ptr<IJson>>()).first;
+			if(value(key) != nullptr)
+				it->second = child(key).array();
+		}
+		return it->second;
+	}
 
-#endif //TILESON_PROPERTYCOLLECTION_HPP
+	size_t TmxJson::size() const
+	{
+		if(m_node->kind == Node::Kind::Tiles)
+			return m_node->tiles.size();
+		if(m_node->kind == Node::Kind::Array || m_node->kind == Node::Kind::Object)
+			return m_node->children.size();
+		return 0;
+	}
 
-/*** End of inlined file: PropertyCollection.hpp ***/
+	bool TmxJson::parse(const fs::path &path)
+	{
+		clearCache();
+		m_root = nullptr;
+		m_node = GetNullNode();
+		if(!fs::exists(path) || !fs::is_regular_file(path))
+			return false;
 
+		std::ifstream file(path, std::ios::binary);
+		std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if(!parse(content.data(), content.size()))
+			return false;
 
-/*** Start of inlined file: Text.hpp ***/
-//
-// Created by robin on 05.08.2019.
-//
+		m_path = path.parent_path();
+		return true;
+	}
 
-#ifndef TILESON_TEXT_HPP
-#define TILESON_TEXT_HPP
+	/*!
+	 * Parses a .tmx, .tsx or .tx file in memory. All text is copied, so the data may be freed afterwards.
+	 */
+	bool TmxJson::parse(const void *data, size_t size)
+	{
+		clearCache();
+		m_root = std::make_unique<Node>(Node::Kind::Object);
+		m_node = m_root.get();
 
-#include <string>
+		XmlReader reader {static_cast<const char *>(data), size};
+		if(!ReadDocument(reader, *m_root))
+		{
+			std::cerr << "TmxJson parse error: Not a valid Tiled map, tileset or template\n";
+			m_root = nullptr;
+			m_node = GetNullNode();
+			return false;
+		}
+		return true;
+	}
 
-namespace tson
-{
-	class Text
+	size_t TmxJson::count(std::string_view key) const
 	{
-		public:
-			inline Text() = default;
-			/*!
-			 *
-			 * @param _text Text
-			 * @param _wrap If the text is marked as wrapped
-			 */
-			//inline Text(std::string _text, bool _wrap, tson::Colori _color) : text {std::move(_text)}, wrap {_wrap}, color {_color} {};
-			inline explicit Text(IJson &json)
-			{
-				bool hasColor = json.count("color") > 0;
-				tson::Color c = (hasColor) ? tson::Colori(json["color"].get<std::string>()) : tson::Colori();
-				color = c;
-				text = (json.count("text") > 0) ? json["text"].get<std::string>() : "";
-				wrap = (json.count("wrap") > 0) ? json["wrap"].get<bool>() : false;
+		return (value(key) != nullptr) ? 1 : 0;
+	}
 
-				//Previously missing properties
-				bold = (json.count("bold") > 0) ? json["bold"].get<bool>() : false;
-				fontFamily = (json.count("fontfamily") > 0) ? json["fontfamily"].get<std::string>() : "sans-serif";
-				horizontalAlignment = (json.count("halign") > 0) ? resolveTextAlignmentByString(json["halign"].get<std::string>()) : TextAlignment::Left;
-				italic = (json.count("italic") > 0) ? json["italic"].get<bool>() : false;
-				kerning = (json.count("kerning") > 0) ? json["kerning"].get<bool>() : true;
-				pixelSize = (json.count("pixelsize") > 0) ? json["pixelsize"].get<int32_t>() : 16;
-				strikeout = (json.count("strikeout") > 0) ? json["strikeout"].get<bool>() : false;
-				underline = (json.count("underline") > 0) ? json["underline"].get<bool>() : false;
-				verticalAlignment = (json.count("valign") > 0) ? resolveTextAlignmentByString(json["valign"].get<std::string>()) : TextAlignment::Top;
-			};
+	bool TmxJson::any(std::string_view key) const
+	{
+		return count(key) > 0;
+	}
 
-			//Just make it simple
-			std::string text {};
-			tson::Colori color {};
-			bool wrap{};
+	bool TmxJson::isArray() const
+	{
+		return m_node->kind == Node::Kind::Array || m_node->kind == Node::Kind::Tiles;
+	}
 
-			//Previously missing properties
-			bool bold {false};
-			std::string fontFamily {"sans-serif"};
-			TextAlignment horizontalAlignment {TextAlignment::Left};
-			bool italic {false};
-			bool kerning {true};
-			int pixelSize {16};
-			bool strikeout {false};
-			bool underline {false};
-			TextAlignment verticalAlignment {TextAlignment::Top};
+	bool TmxJson::isObject() const
+	{
+		return m_node->kind == Node::Kind::Object;
+	}
 
-		private:
-			[[nodiscard]] TextAlignment resolveTextAlignmentByString(const std::string &str) const
-			{
-				if(str == "left") return TextAlignment::Left;
-				if(str == "center") return TextAlignment::Center;
-				if(str == "right") return TextAlignment::Right;
-				if(str == "justify") return TextAlignment::Justify;
-				if(str == "top") return TextAlignment::Top;
-				if(str == "bottom") return TextAlignment::Bottom;
+	bool TmxJson::isNull() const
+	{
+		return m_node->kind == Node::Kind::Null;
+	}
 
-				return TextAlignment::Unresolved;
-			}
-	};
-}
+	/*!
+	 * Copies decoded tile layer data directly, without creating a json value per gid
+	 */
+	bool TmxJson::readArray(std::string_view key, std::vector<uint32_t> &values)
+	{
+		const Node *node = value(key);
+		if(node == nullptr || node->kind != Node::Kind::Tiles)
+			return IJson::readArray(key, values);
 
-#endif //TILESON_TEXT_HPP
+		values.insert(values.end(), node->tiles.begin(), node->tiles.end());
+		return true;
+	}
 
-/*** End of inlined file: Text.hpp ***/
+	/*!
+	 * Copies the rows of decoded tile layer data that overlap the rectangle
+	 */
+	bool TmxJson::readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength, size_t x, size_t y, size_t width, size_t height)
+	{
+		const Node *node = value(key);
+		if(node == nullptr || node->kind != Node::Kind::Tiles)
+			return IJson::readArrayRegion(key, values, rowLength, x, y, width, height);
 
-#include <optional>
+		const std::vector<uint32_t> &tiles = node->tiles;
+		values.reserve(values.size() + width * height);
+		for(size_t row = y; row < y + height; ++row)
+		{
+			size_t const start = std::min(row * rowLength + x, tiles.size());
+			size_t const end = std::min(start + width, tiles.size());
+			values.insert(values.end(), tiles.begin() + static_cast<std::ptrdiff_t>(start), tiles.begin() + static_cast<std::ptrdiff_t>(end));
+			values.resize(values.size() + width - (end - start), 0);
+		}
+		return true;
+	}
 
-namespace tson
-{
-	class TiledClass;
-	class Map;
-	class Object
+	fs::path TmxJson::directory() const
 	{
-		public:
-			//enum class Type : uint8_t
-			//{
-			//        Undefined = 0,
-			//        Object = 1,
-			//        Ellipse = 2,
-			//        Rectangle = 3,
-			//        Point = 4,
-			//        Polygon = 5,
-			//        Polyline = 6,
-			//        Text = 7,
-			//        Template = 8
-			//};
+		return m_path;
+	}
 
-			inline Object() = default;
-			inline explicit Object(IJson &json, tson::Map *map);
-			inline bool parse(IJson &json, tson::Map *map);
+	void TmxJson::directory(const fs::path &directory)
+	{
+		m_path = directory;
+	}
 
-			[[nodiscard]] inline ObjectType getObjectType() const;
-			[[nodiscard]] inline bool isEllipse() const;
-			[[nodiscard]] inline uint32_t getGid() const;
-			[[nodiscard]] inline const Vector2i &getSize() const;
-			[[nodiscard]] inline int getId() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline bool isPoint() const;
-			[[nodiscard]] inline float getRotation() const;
-			[[nodiscard]] inline const std::string &getTemplate() const;
-			[[nodiscard]] inline const std::string &getType() const;
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
-			[[nodiscard]] inline bool isVisible() const;
-			[[nodiscard]] inline const Vector2i &getPosition() const;
+	std::unique_ptr<IJson> TmxJson::create()
+	{
+		return std::make_unique<TmxJson>();
+	}
 
-			[[nodiscard]] inline const std::vector<tson::Vector2i> &getPolygons() const;
-			[[nodiscard]] inline const std::vector<tson::Vector2i> &getPolylines() const;
-			[[nodiscard]] inline PropertyCollection &getProperties();
-			[[nodiscard]] inline const Text &getText() const;
+	int32_t TmxJson::getInt32(std::string_view key)
+	{
+		return static_cast<int32_t>(getDouble(key));
+	}
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+	uint32_t TmxJson::getUInt32(std::string_view key)
+	{
+		return static_cast<uint32_t>(getDouble(key));
+	}
 
-			//v1.2.0-stuff
-			[[nodiscard]] inline TileFlipFlags getFlipFlags() const;
-			inline bool hasFlipFlags(TileFlipFlags flags);
+	int64_t TmxJson::getInt64(std::string_view key)
+	{
+		return static_cast<int64_t>(getDouble(key));
+	}
 
-		private:
-			inline void setObjectTypeByJson(IJson &json, IJson* templ);
+	uint64_t TmxJson::getUInt64(std::string_view key)
+	{
+		return static_cast<uint64_t>(getDouble(key));
+	}
 
-			ObjectType                        m_objectType = ObjectType::Undefined;    /*! Says with object type this is */
-			bool                              m_ellipse {};                            /*! 'ellipse': Used to mark an object as an ellipse */
-			uint32_t                          m_gid {};                                /*! 'gid': GID, only if object comes from a Tilemap */
-			tson::Vector2i                    m_size;                                  /*! x = 'width' (Width in pixels), y = 'height' (Height in pixels). Ignored if using a gid.)*/
-			int                               m_id{};                                  /*! 'id': Incremental id - unique across all objects */
-			std::string                       m_name;                                  /*! 'name':  String assigned to name field in editor*/
-			bool                              m_point {};                              /*! 'point': Used to mark an object as a point */
-			std::vector<tson::Vector2i>       m_polygon; 	                           /*! 'polygon': A list of x,y coordinates in pixels */
-			std::vector<tson::Vector2i>       m_polyline; 	                           /*! 'polyline': A list of x,y coordinates in pixels */
-			tson::PropertyCollection          m_properties; 	                       /*! 'properties': A list of properties (name, value, type). */
-			float                             m_rotation {};                           /*! 'rotation': Angle in degrees clockwise */
-			std::string                       m_template;                              /*! 'template': Reference to a template file, in case object is a template instance */
-			tson::Text                        m_text; 	                               /*! first: 'text' second: 'wrap' */
-			std::string                       m_type;                                  /*! 'type': String assigned to type field in editor */
-			bool                              m_visible {};                            /*! 'visible': Whether object is shown in editor. */
-			tson::Vector2i                    m_position;                              /*! 'x' and 'y': coordinate in pixels */
+	double TmxJson::getDouble(std::string_view key)
+	{
+		const Node *node = value(key);
+		return (node != nullptr) ? std::strtod(node->value.c_str(), nullptr) : 0.0;
+	}
 
-			//v1.2.0-stuff
-			tson::TileFlipFlags               m_flipFlags = TileFlipFlags::None;       /*! Resolved using bit 32, 31 and 30 from gid */
+	float TmxJson::getFloat(std::string_view key)
+	{
+		return static_cast<float>(getDouble(key));
+	}
 
-			tson::Map *m_map {nullptr};
-			std::shared_ptr<tson::TiledClass> m_class {};
-	};
+	std::string TmxJson::getString(std::string_view key)
+	{
+		const Node *node = value(key);
+		return (node != nullptr) ? node->value : std::string();
+	}
 
-	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
-	 */
-	template<typename T>
-	T tson::Object::get(const std::string &name)
+	bool TmxJson::getBool(std::string_view key)
 	{
-		return m_properties.getValue<T>(name);
+		const Node *node = value(key);
+		return node != nullptr && (node->value == "1" || node->value == "true");
 	}
 
-	/*!
-	* Returns the requested IJson object if it exists in the map file or in a related template file
-	* @param fieldName The name of the field to check
-	* @param main The main json file being parsed
-	* @param templ The template file json, if present, nullptr otherwise.
-	* @return the requested json object if found in the main json file, otherwise if it is found in the template and nullptr if not found anywhere
-	*/
-	inline IJson* readField(const std::string& fieldName,  IJson& main, IJson* templ = nullptr);
+	int32_t TmxJson::getInt32()
+	{
+		return static_cast<int32_t>(getDouble());
+	}
 
-	/*!
-	* Attempts to read a text field from main file or the template if not overriden
-	* @param fieldName The name of the field to check
-	* @param main The main json file being parsed
-	* @param templ The template file json, if present, nullptr otherwise.
-	* @return true if the field was found and parsed in any of the objects, false otherwise
-	*/
-   inline bool readField(Text& field, const std::string& fieldName,  IJson& main, IJson* templ = nullptr);
+	uint32_t TmxJson::getUInt32()
+	{
+		return static_cast<uint32_t>(getDouble());
+	}
 
-	/*!
-	* Attempts to read a series of coordinates from main file or the template if not overriden
-	* @param fieldName The name of the field to check
-	* @param main The main json file being parsed
-	* @param templ The template file json, if present, nullptr otherwise.
-	* @return true if the field was found and parsed in any of the objects, false otherwise
-	*/
-	inline bool readField(std::vector<Vector2i>& field, const std::string& fieldName, IJson& main, IJson* templ = nullptr);
+	int64_t TmxJson::getInt64()
+	{
+		return static_cast<int64_t>(getDouble());
+	}
 
-	/*!
-	* Attempts to read a field from main file or the template if not overriden
-	* @param fieldName The name of the field to check
-	* @param main The main json file being parsed
-	* @param templ The template file json, if present, nullptr otherwise.
-	* @return true if the field was found and parsed in any of the objects, false otherwise
-	*/
-	template <typename T> bool readField(T& field, const std::string& fieldName,  IJson& main, IJson* templ = nullptr)
+	uint64_t TmxJson::getUInt64()
 	{
-		IJson* fieldJson = readField(fieldName, main, templ);
-		if(fieldJson){
-			field = fieldJson->get<T>();
-			return true;
-		}
-		return false;
+		return static_cast<uint64_t>(getDouble());
 	}
 
-	/*!
-	* Attempts to read a vector from main file or the template if not overriden
-	* @param field Target variable to fill
-	* @param fieldNameX The name of the field to check for the x part of the vector
-	* @param fieldNameY The name of the field to check for the y part of the vector
-	* @param main The main json file being parsed
-	* @param templ The template file json, if present, nullptr otherwise.
-	* @return true if the field was found and parsed in any of the objects, false otherwise
-	*/
-	inline bool readVector(Vector2i& field, const std::string& fieldNameX, const std::string& fieldNameY, IJson& main, IJson* templ = nullptr);
+	double TmxJson::getDouble()
+	{
+		return std::strtod(m_node->value.c_str(), nullptr);
+	}
 
-	/*!
-	* Reads all custom properties from the given json node
-	* @param properties Target Properties collection to fill
-	* @param json json node representing the map object
-	* @param map Pointer to current map being parsed
-	*/
-	inline void readProperties(tson::PropertyCollection& properties, IJson& json, tson::Map* map);
+	float TmxJson::getFloat()
+	{
+		return static_cast<float>(getDouble());
+	}
 
-	/*!
-	* Reads a gid, parsing flip-flags
-	* @param properties Target Properties collection to fill
-	* @param json json node representing the map object
-	* @param map Pointer to current map being parsed
-	*/
-	inline void readGid(uint32_t& gid, TileFlipFlags& flags, IJson& main, IJson* templ = nullptr);
-}
+	std::string TmxJson::getString()
+	{
+		return m_node->value;
+	}
 
-/*!
- * Parses a json Tiled object
- * @param json
- */
-tson::Object::Object(IJson &json, tson::Map *map)
-{
-	parse(json, map);
-}
+	bool TmxJson::getBool()
+	{
+		return m_node->value == "1" || m_node->value == "true";
+	}
 
-/*!
- * Sets an object type based on json data.
- * @param json
- */
-void tson::Object::setObjectTypeByJson(IJson &json, IJson* templ)
-{
-	m_objectType = ObjectType::Undefined;
-	if(m_ellipse)
-		m_objectType = ObjectType::Ellipse;
-	else if(m_point)
-		m_objectType = ObjectType::Point;
-	else if(readField("polygon", json, templ))
-		m_objectType = ObjectType::Polygon;
-	else if(readField("polyline", json, templ))
-		m_objectType = ObjectType::Polyline;
-	else if(readField("text", json, templ))
-		m_objectType = ObjectType::Text;
-	else if(readField("gid", json, templ))
-		m_objectType = ObjectType::Object;
-	else if(json.count("template") > 0)
-		m_objectType = ObjectType::Template;
-	else
-		m_objectType = ObjectType::Rectangle;
-}
+	IJson &TmxJson::child(std::string_view key)
+	{
+		auto it = m_arrayCache.find(key);
+		if(it == m_arrayCache.end())
+		{
+			const Node *node = value(key);
+			std::unique_ptr<IJson> item {new TmxJson((node != nullptr) ? node : GetNullNode(), m_path)};
+			it = m_arrayCache.emplace(std::string(key), std::move(item)).first;
+		}
+		return *it->second;
+	}
 
-/*!
- * Gets what type of object this is.
- * @return
- */
+	const TmxJson::Node *TmxJson::value(std::string_view key) const
+	{
+		return (m_node != nullptr && m_node->kind == Node::Kind::Object) ? m_node->find(key) : nullptr;
+	}
 
-tson::ObjectType tson::Object::getObjectType() const
-{
-	return m_objectType;
-}
+	/*!
+	 * The value of keys that do not exist
+	 */
+	const TmxJson::Node *TmxJson::GetNullNode()
+	{
+		static const Node nullNode;
+		return &nullNode;
+	}
 
-/*!
- * 'ellipse': Used to mark an object as an ellipse
- * @return
- */
-bool tson::Object::isEllipse() const
-{
-	return m_ellipse;
-}
+	void TmxJson::clearCache()
+	{
+		m_arrayCache.clear();
+		m_arrayPosCache.clear();
+		m_arrayListDataCache.clear();
+	}
 
-/*!
- * 'gid': GID, only if object comes from a Tilemap
- * @return
- */
-uint32_t tson::Object::getGid() const
-{
-	return m_gid;
-}
+	/*!
+	 * Reads the root element: <map>, <tileset> or <template>
+	 */
+	bool TmxJson::ReadDocument(XmlReader &reader, Node &root)
+	{
+		if(reader.nextStartElement() != XmlReader::Token::StartElement)
+			return false;
 
-/*!
- * x = 'width' (Width in pixels), y = 'height' (Height in pixels). Ignored if using a gid.)
- * @return
- */
-const tson::Vector2i &tson::Object::getSize() const
-{
-	return m_size;
-}
+		std::string_view const name = reader.getName();
+		if(name == "map")
+			return ReadMap(reader, root);
+		if(name == "tileset")
+		{
+			root.set("type", "tileset");
+			return ReadTileset(reader, root);
+		}
+		if(name == "template")
+		{
+			root.set("type", "template");
+			return ReadTemplate(reader, root);
+		}
+		return false;
+	}
 
-/*!
- * 'id': Incremental id - unique across all objects
- * @return
- */
-int tson::Object::getId() const
-{
-	return m_id;
-}
+	bool TmxJson::ReadMap(XmlReader &reader, Node &map)
+	{
+		map.set("type", "map");
+		ReadAttributes(reader, map);
 
-/*!
- * 'name': String assigned to name field in editor
- * @return
- */
-const std::string &tson::Object::getName() const
-{
-	return m_name;
-}
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name == "tileset")
+				return ReadTileset(reader, map.getOrAdd("tilesets", Node::Kind::Array).push(Node::Kind::Object));
+			if(name == "layer" || name == "objectgroup" || name == "imagelayer" || name == "group")
+				return ReadLayer(reader, map.getOrAdd("layers", Node::Kind::Array).push(Node::Kind::Object));
+			if(name == "properties")
+				return ReadProperties(reader, map.getOrAdd("properties", Node::Kind::Array));
+			return reader.skipElement();
+		});
+	}
 
-/*!
- * 'point': Used to mark an object as a point
- * @return true if the object is of type point
- */
-bool tson::Object::isPoint() const
-{
-	return m_point;
-}
+	/*!
+	 * Reads a <tileset> of a .tsx file or a map. Tilesets in maps only have 'firstgid' and 'source' when they are external.
+	 */
+	bool TmxJson::ReadTileset(XmlReader &reader, Node &tileset)
+	{
+		ReadAttributes(reader, tileset);
+		bool const isExternal = tileset.find("source") != nullptr;
 
-/*!
- * 'rotation': Angle in degrees clockwise
- * @return
- */
-float tson::Object::getRotation() const
-{
-	return m_rotation;
-}
+		bool const ok = ReadChildren(reader, [&](std::string_view name)
+		{
+			if(isExternal)
+				return reader.skipElement();
+			if(name == "image")
+				return ReadImage(reader, tileset);
+			if(name == "tileoffset" || name == "grid" || name == "transformations")
+			{
+				ReadAttributes(reader, tileset.add(name, Node::Kind::Object));
+				return reader.skipElement();
+			}
+			if(name == "properties")
+				return ReadProperties(reader, tileset.getOrAdd("properties", Node::Kind::Array));
+			if(name == "tile")
+				return ReadTile(reader, tileset.getOrAdd("tiles", Node::Kind::Array).push(Node::Kind::Object));
+			if(name == "wangsets")
+			{
+				Node &wangsets = tileset.getOrAdd("wangsets", Node::Kind::Array);
+				return ReadChildren(reader, [&](std::string_view wangsetName)
+				{
+					return (wangsetName == "wangset") ? ReadWangSet(reader, wangsets.push(Node::Kind::Object)) : reader.skipElement();
+				});
+			}
+			if(name == "terraintypes")
+			{
+				Node &terrains = tileset.getOrAdd("terrains", Node::Kind::Array);
+				return ReadChildren(reader, [&](std::string_view terrainName)
+				{
+					if(terrainName != "terrain")
+						return reader.skipElement();
 
-/*!
- * 'template': Reference to a template file, in case object is a template instance
- * @return
- */
-const std::string &tson::Object::getTemplate() const
-{
-	return m_template;
-}
+					Node &terrain = terrains.push(Node::Kind::Object);
+					ReadAttributes(reader, terrain);
+					return ReadChildren(reader, [&](std::string_view childName)
+					{
+						return (childName == "properties") ? ReadProperties(reader, terrain.getOrAdd("properties", Node::Kind::Array)) : reader.skipElement();
+					});
+				});
+			}
+			return reader.skipElement();
+		});
 
-/*!
- * 'type': String assigned to type field in editor
- * This was renamed to 'class' in Tiled v1.9
- * @return
- */
-const std::string &tson::Object::getType() const
-{
-	return m_type;
-}
+		if(isExternal)
+			return ok;
 
-/*!
- * 'class': String assigned to class field in editor
- * This was renamed from 'type' to 'class' in Tiled v1.9
- * @return
- */
-const std::string &tson::Object::getClassType() const
-{
-	return m_type;
-}
+		SetDefault(tileset, "margin", "0");
+		SetDefault(tileset, "spacing", "0");
 
-/*!
- * 'visible': Whether object is shown in editor.
- * @return
- */
-bool tson::Object::isVisible() const
-{
-	return m_visible;
-}
+		//Maps older than Tiled 0.15 have no 'columns'
+		if(tileset.find("columns") == nullptr)
+		{
+			int columns = 0;
+			const Node *imageWidth = tileset.find("imagewidth");
+			const Node *tileWidth = tileset.find("tilewidth");
+			if(imageWidth != nullptr && tileWidth != nullptr)
+			{
+				int const margin = std::atoi(tileset.find("margin")->value.c_str());
+				int const spacing = std::atoi(tileset.find("spacing")->value.c_str());
+				int const step = std::atoi(tileWidth->value.c_str()) + spacing;
+				if(step > 0)
+					columns = (std::atoi(imageWidth->value.c_str()) - margin * 2 + spacing) / step;
+			}
+			tileset.set("columns", std::to_string(columns));
+		}
 
-/*!
- * 'x' and 'y': coordinate in pixels
- * @return
- */
-const tson::Vector2i &tson::Object::getPosition() const
-{
-	return m_position;
-}
+		return ok;
+	}
 
-/*!
- * 'polygon': A list of x,y coordinates in pixels.
- * If this is a Polygon type, this function will return the points used to create it
- * @return
- */
-const std::vector<tson::Vector2i> &tson::Object::getPolygons() const
-{
-	return m_polygon;
-}
-
-/*!
- * 'polyline': A list of x,y coordinates in pixels
- * If this is a Polyline type, this function will return the points used to create it
- * @return
- */
-const std::vector<tson::Vector2i> &tson::Object::getPolylines() const
-{
-	return m_polyline;
-}
-
-/*!
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::Object::getProperties()
-{
-	return m_properties;
-}
-
-/*!
- * 'type': String assigned to type field in editor
- * @return
- */
-const tson::Text &tson::Object::getText() const
-{
-	return m_text;
-}
-
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::Object::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
-	return nullptr;
-}
-
-/*!
- * Get all flip flags
- * @return
- */
-tson::TileFlipFlags tson::Object::getFlipFlags() const
-{
-	return m_flipFlags;
-}
-
-/*!
- *
- * @param flags Which flags to check for. Several flags can be checked at once using the bitwise or operator.
- * Example:
- * hasFlipFlags(TileFlipFlags::Vertically | TileFlipFlags::Horizontally)
- *
- * @return true if the flag(s) specified are set
- */
-bool tson::Object::hasFlipFlags(TileFlipFlags flags)
-{
-	return ((m_flipFlags & flags) == flags) ? true : false;
-}
-
-#endif //TILESON_OBJECT_HPP
-
-/*** End of inlined file: Object.hpp ***/
-
-
-/*** Start of inlined file: TileObject.hpp ***/
-//
-// Created by robin on 26.07.2020.
-//
-
-#ifndef TILESON_TILEOBJECT_HPP
-#define TILESON_TILEOBJECT_HPP
-
-
-/*** Start of inlined file: Rect.hpp ***/
-//
-// Created by robin on 24.07.2020.
-//
-
-#ifndef TILESON_RECT_HPP
-#define TILESON_RECT_HPP
-
-namespace tson
-{
-	class Rect
+	bool TmxJson::ReadTemplate(XmlReader &reader, Node &templ)
 	{
-		public:
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name == "tileset")
+			{
+				ReadAttributes(reader, templ.add("tileset", Node::Kind::Object));
+				return reader.skipElement();
+			}
+			if(name == "object")
+				return ReadObject(reader, templ.add("object", Node::Kind::Object));
+			return reader.skipElement();
+		});
+	}
 
-			inline Rect() = default;
-			inline Rect(int x_, int y_, int width_, int height_);
+	bool TmxJson::ReadTile(XmlReader &reader, Node &tile)
+	{
+		for(const auto &[name, text] : reader.getAttributes())
+		{
+			if(name != "terrain")
+			{
+				tile.set(name, XmlReader::Unescape(text));
+				continue;
+			}
 
-			inline bool operator==(const Rect &rhs) const;
-			inline bool operator!=(const Rect &rhs) const;
+			//Corners without a terrain are empty
+			Node &terrain = tile.add("terrain", Node::Kind::Array);
+			size_t start = 0;
+			while(start <= text.size())
+			{
+				size_t end = text.find(',', start);
+				if(end == std::string_view::npos)
+					end = text.size();
+				std::string_view const corner = text.substr(start, end - start);
+				terrain.push(Node::Kind::Value).value = (corner.empty()) ? "-1" : std::string(corner);
+				start = end + 1;
+			}
+		}
 
-			int x{};
-			int y{};
-			int width{};
-			int height{};
-	};
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name == "image")
+				return ReadImage(reader, tile);
+			if(name == "properties")
+				return ReadProperties(reader, tile.getOrAdd("properties", Node::Kind::Array));
+			if(name == "objectgroup")
+				return ReadLayer(reader, tile.add("objectgroup", Node::Kind::Object));
+			if(name == "animation")
+			{
+				Node &animation = tile.add("animation", Node::Kind::Array);
+				return ReadChildren(reader, [&](std::string_view frameName)
+				{
+					if(frameName == "frame")
+						ReadAttributes(reader, animation.push(Node::Kind::Object));
+					return reader.skipElement();
+				});
+			}
+			return reader.skipElement();
+		});
+	}
 
-	Rect::Rect(int x_, int y_, int width_, int height_)
+	/*!
+	 * Reads a <wangset>. Both the colors of Tiled 1.5 (<wangcolor>) and the older edge and corner colors are read.
+	 */
+	bool TmxJson::ReadWangSet(XmlReader &reader, Node &wangset)
 	{
-		x = x_;
-		y = y_;
-		width = width_;
-		height = height_;
+		ReadAttributes(reader, wangset);
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name == "properties")
+				return ReadProperties(reader, wangset.getOrAdd("properties", Node::Kind::Array));
+			if(name == "wangcolor" || name == "wangedgecolor" || name == "wangcornercolor")
+			{
+				std::string_view const key = (name == "wangcolor") ? "colors" : (name == "wangedgecolor") ? "edgecolors" : "cornercolors";
+				Node &color = wangset.getOrAdd(key, Node::Kind::Array).push(Node::Kind::Object);
+				ReadAttributes(reader, color);
+				SetDefault(color, "probability", "1");
+				return ReadChildren(reader, [&](std::string_view childName)
+				{
+					return (childName == "properties") ? ReadProperties(reader, color.getOrAdd("properties", Node::Kind::Array)) : reader.skipElement();
+				});
+			}
+			if(name == "wangtile")
+			{
+				Node &wangtile = wangset.getOrAdd("wangtiles", Node::Kind::Array).push(Node::Kind::Object);
+				for(const auto &[attributeName, text] : reader.getAttributes())
+				{
+					if(attributeName == "wangid")
+						ReadWangId(text, wangtile.add("wangid", Node::Kind::Array));
+					else
+						wangtile.set(attributeName, text);
+				}
+				return reader.skipElement();
+			}
+			return reader.skipElement();
+		});
 	}
 
-	bool Rect::operator==(const Rect &rhs) const
+	/*!
+	 * Reads a <layer>, <objectgroup>, <imagelayer> or <group>
+	 */
+	bool TmxJson::ReadLayer(XmlReader &reader, Node &layer)
 	{
-		return x == rhs.x &&
-			   y == rhs.y &&
-			   width == rhs.width &&
-			   height == rhs.height;
+		std::string_view const name = reader.getName();
+		if(name == "layer")
+			layer.set("type", "tilelayer");
+		else
+			layer.set("type", name);
+		ReadAttributes(reader, layer);
+
+		SetDefault(layer, "name", "");
+		SetDefault(layer, "opacity", "1");
+		SetDefault(layer, "visible", "1");
+		SetDefault(layer, "x", "0");
+		SetDefault(layer, "y", "0");
+		if(name == "objectgroup")
+			SetDefault(layer, "draworder", "topdown");
+
+		return ReadChildren(reader, [&](std::string_view childName)
+		{
+			if(childName == "properties")
+				return ReadProperties(reader, layer.getOrAdd("properties", Node::Kind::Array));
+			if(childName == "data")
+				return ReadData(reader, layer);
+			if(childName == "object")
+				return ReadObject(reader, layer.getOrAdd("objects", Node::Kind::Array).push(Node::Kind::Object));
+			if(childName == "image")
+				return ReadImage(reader, layer);
+			if(childName == "layer" || childName == "objectgroup" || childName == "imagelayer" || childName == "group")
+				return ReadLayer(reader, layer.getOrAdd("layers", Node::Kind::Array).push(Node::Kind::Object));
+			return reader.skipElement();
+		});
 	}
 
-	bool Rect::operator!=(const Rect &rhs) const
+	/*!
+	 * Reads the <data> of a tile layer into 'data', or into 'chunks' for infinite maps
+	 */
+	bool TmxJson::ReadData(XmlReader &reader, Node &layer)
 	{
-		return !(rhs == *this);
+		std::string const encoding {reader.getAttribute("encoding")};
+		std::string const compression {reader.getAttribute("compression")};
+		if(encoding == "base64")
+			layer.set("encoding", encoding);
+		if(!compression.empty())
+			layer.set("compression", compression);
+
+		Node &data = layer.add("data", Node::Kind::Tiles);
+		size_t const depth = reader.getDepth();
+		while(true)
+		{
+			XmlReader::Token const token = reader.next();
+			if(token == XmlReader::Token::EndElement && reader.getDepth() < depth)
+				return true;
+			if(token == XmlReader::Token::Error || token == XmlReader::Token::EndOfDocument)
+				return false;
+
+			if(token == XmlReader::Token::Text)
+			{
+				if(!DecodeTiles(reader.getText(), encoding, compression, data.tiles))
+					return false;
+			}
+			else if(token == XmlReader::Token::StartElement && reader.getName() == "tile")
+			{
+				//Tiled before 0.9 wrote one element per tile
+				data.tiles.push_back(static_cast<uint32_t>(std::strtoul(std::string(reader.getAttribute("gid")).c_str(), nullptr, 10)));
+				if(!reader.skipElement())
+					return false;
+			}
+			else if(token == XmlReader::Token::StartElement && reader.getName() == "chunk")
+			{
+				Node &chunk = layer.getOrAdd("chunks", Node::Kind::Array).push(Node::Kind::Object);
+				ReadAttributes(reader, chunk);
+				Node &chunkData = chunk.add("data", Node::Kind::Tiles);
+				if(!DecodeTiles(reader.readText(), encoding, compression, chunkData.tiles))
+					return false;
+			}
+			else if(token == XmlReader::Token::StartElement && !reader.skipElement())
+				return false;
+		}
 	}
-}
 
-#endif //TILESON_RECT_HPP
+	bool TmxJson::ReadObject(XmlReader &reader, Node &object)
+	{
+		ReadAttributes(reader, object);
 
-/*** End of inlined file: Rect.hpp ***/
+		//Instances of templates only have the fields that differ from the template
+		if(object.find("template") == nullptr)
+		{
+			SetDefault(object, "name", "");
+			SetDefault(object, "rotation", "0");
+			SetDefault(object, "visible", "1");
+			if(object.find("class") == nullptr)
+				SetDefault(object, "type", "");
+			if(object.find("x") != nullptr || object.find("y") != nullptr)
+			{
+				SetDefault(object, "x", "0");
+				SetDefault(object, "y", "0");
+				SetDefault(object, "width", "0");
+				SetDefault(object, "height", "0");
+			}
+		}
 
-namespace tson
-{
-	class Tile;
-	class TileObject
-	{
-		public:
-			inline TileObject() = default;
-			inline TileObject(const std::tuple<int, int> &posInTileUnits, tson::Tile *tile);
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name == "properties")
+				return ReadProperties(reader, object.getOrAdd("properties", Node::Kind::Array));
+			if(name == "ellipse" || name == "point")
+			{
+				object.set(name, "true");
+				return reader.skipElement();
+			}
+			if(name == "polygon" || name == "polyline")
+			{
+				ReadPoints(reader.getAttribute("points"), object.add(name, Node::Kind::Array));
+				return reader.skipElement();
+			}
+			if(name == "text")
+				return ReadText(reader, object.add("text", Node::Kind::Object));
+			return reader.skipElement();
+		});
+	}
 
-			inline void initialize(const std::tuple<int, int> &posInTileUnits, tson::Tile *tile); //Defined in tileson_forward.hpp
+	bool TmxJson::ReadText(XmlReader &reader, Node &text)
+	{
+		ReadAttributes(reader, text);
+		std::string_view const content = reader.readText();
+		if(reader.getToken() != XmlReader::Token::EndElement)
+			return false;
+		text.set("text", XmlReader::Unescape(content));
+		return true;
+	}
 
-			inline Tile *getTile();
-			inline const Vector2i &getPositionInTileUnits() const;
-			inline const Vector2f &getPosition() const;
-			inline const tson::Rect &getDrawingRect() const; //Defined in tileson_forward.hpp
+	/*!
+	 * Reads <properties> into an array of properties
+	 */
+	bool TmxJson::ReadProperties(XmlReader &reader, Node &properties)
+	{
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name != "property")
+				return reader.skipElement();
 
-		private:
-			tson::Tile *m_tile;
-			tson::Vector2i m_posInTileUnits;
-			tson::Vector2f m_position;
+			Node &property = properties.push(Node::Kind::Object);
+			ReadAttributes(reader, property);
+			SetDefault(property, "type", "string");
+			if(property.find("value") != nullptr)
+				return reader.skipElement();
 
-	};
+			if(property.find("type")->value == "class")
+			{
+				Node &members = property.add("value", Node::Kind::Object);
+				return ReadChildren(reader, [&](std::string_view childName)
+				{
+					return (childName == "properties") ? ReadClassMembers(reader, members) : reader.skipElement();
+				});
+			}
 
-	TileObject::TileObject(const std::tuple<int, int> &posInTileUnits, tson::Tile *tile)
-	{
-		initialize(posInTileUnits, tile);
+			//Strings with several lines are stored as the text of the property
+			std::string_view const text = reader.readText();
+			if(reader.getToken() != XmlReader::Token::EndElement)
+				return false;
+			property.set("value", XmlReader::Unescape(text));
+			return true;
+		});
 	}
 
 	/*!
-	 * Get a pointer to the related tile
-	 * @return
+	 * Reads the <properties> of a class property into an object with the values of its members
 	 */
-	Tile *TileObject::getTile()
+	bool TmxJson::ReadClassMembers(XmlReader &reader, Node &members)
 	{
-		return m_tile;
+		return ReadChildren(reader, [&](std::string_view name)
+		{
+			if(name != "property")
+				return reader.skipElement();
+
+			std::string const memberName = XmlReader::Unescape(reader.getAttribute("name"));
+			if(reader.getAttribute("type") == "class")
+			{
+				Node &member = members.add(memberName, Node::Kind::Object);
+				return ReadChildren(reader, [&](std::string_view childName)
+				{
+					return (childName == "properties") ? ReadClassMembers(reader, member) : reader.skipElement();
+				});
+			}
+
+			if(reader.hasAttribute("value"))
+			{
+				members.set(memberName, XmlReader::Unescape(reader.getAttribute("value")));
+				return reader.skipElement();
+			}
+			std::string_view const text = reader.readText();
+			members.set(memberName, XmlReader::Unescape(text));
+			return reader.getToken() == XmlReader::Token::EndElement;
+		});
 	}
 
 	/*!
-	 * Gets the position of the tile in tile units
-	 * @return
+	 * Reads an <image> into the fields its owner has in json
 	 */
-	const Vector2i &TileObject::getPositionInTileUnits() const
+	bool TmxJson::ReadImage(XmlReader &reader, Node &node)
 	{
-		return m_posInTileUnits;
+		for(const auto &[name, text] : reader.getAttributes())
+		{
+			if(name == "source")
+				node.set("image", XmlReader::Unescape(text));
+			else if(name == "width")
+				node.set("imagewidth", text);
+			else if(name == "height")
+				node.set("imageheight", text);
+			else if(name == "trans")
+				node.set("transparentcolor", (!text.empty() && text[0] == '#') ? std::string(text) : "#" + std::string(text));
+		}
+		return reader.skipElement();
 	}
 
 	/*!
-	 * Gets the position of the tile in pixels.
-	 * @return
+	 * Calls readChild for each child element of the current element, with the reader at the start of the child.
+	 * readChild must read the whole child, or skip it. Text is skipped.
+	 * @return false if readChild returns false, or the data is not well-formed
 	 */
-	const Vector2f &TileObject::getPosition() const
+	bool TmxJson::ReadChildren(XmlReader &reader, const std::function<bool(std::string_view)> &readChild)
 	{
-		return m_position;
+		while(true)
+		{
+			XmlReader::Token const token = reader.nextStartElement();
+			if(token == XmlReader::Token::EndElement)
+				return true;
+			if(token != XmlReader::Token::StartElement || !readChild(reader.getName()))
+				return false;
+		}
 	}
-}
 
-#endif //TILESON_TILEOBJECT_HPP
-
-/*** End of inlined file: TileObject.hpp ***/
+	void TmxJson::ReadAttributes(const XmlReader &reader, Node &node)
+	{
+		for(const auto &[name, text] : reader.getAttributes())
+		{
+			if(text.find('&') != std::string_view::npos)
+				node.set(name, XmlReader::Unescape(text));
+			else
+				node.set(name, text);
+		}
+	}
 
+	void TmxJson::SetDefault(Node &node, std::string_view key, std::string_view text)
+	{
+		if(node.find(key) == nullptr)
+			node.set(key, text);
+	}
 
-/*** Start of inlined file: FlaggedTile.hpp ***/
-//
-// Created by robin on 13.11.2020.
-//
+	/*!
+	 * Reads the points of a polygon or polyline ("x,y x,y ...") as an array of {x, y}
+	 */
+	void TmxJson::ReadPoints(std::string_view points, Node &array)
+	{
+		size_t start = 0;
+		while(start < points.size())
+		{
+			size_t end = points.find(' ', start);
+			if(end == std::string_view::npos)
+				end = points.size();
 
-#ifndef TILESON_FLAGGEDTILE_HPP
-#define TILESON_FLAGGEDTILE_HPP
+			std::string_view const point = points.substr(start, end - start);
+			size_t const comma = point.find(',');
+			if(comma != std::string_view::npos)
+			{
+				Node &item = array.push(Node::Kind::Object);
+				item.set("x", point.substr(0, comma));
+				item.set("y", point.substr(comma + 1));
+			}
+			start = end + 1;
+		}
+	}
 
-namespace tson
-{
-	class FlaggedTile
+	/*!
+	 * Reads the 'wangid' of a wang tile. Tiled 1.5 writes eight comma-separated colors, starting at the top edge and going clockwise.
+	 * Older versions write the same eight colors as the nibbles of a hexadecimal number, starting with the lowest.
+	 */
+	void TmxJson::ReadWangId(std::string_view wangid, Node &array)
 	{
+		if(wangid.size() > 2 && wangid[0] == '0' && (wangid[1] == 'x' || wangid[1] == 'X'))
+		{
+			uint32_t const value = static_cast<uint32_t>(std::strtoul(std::string(wangid.substr(2)).c_str(), nullptr, 16));
+			for(int i = 0; i < 8; ++i)
+				array.push(Node::Kind::Value).value = std::to_string((value >> (i * 4)) & 0xFu);
+			return;
+		}
 
-		public:
-			FlaggedTile(size_t x_, size_t y_, uint32_t id_, uint32_t tileId_) : x {x_}, y {y_}, id {id_}, tileId {tileId_}
+		size_t start = 0;
+		while(start <= wangid.size())
+		{
+			size_t end = wangid.find(',', start);
+			if(end == std::string_view::npos)
+				end = wangid.size();
+			array.push(Node::Kind::Value).value = std::string(wangid.substr(start, end - start));
+			start = end + 1;
+		}
+	}
+
+	/*!
+	 * Decodes the text of a <data> or <chunk> into gids
+	 * @return false if the encoding or compression is unsupported, or the data is invalid
+	 */
+	bool TmxJson::DecodeTiles(std::string_view text, std::string_view encoding, std::string_view compression, std::vector<uint32_t> &tiles)
+	{
+		if(encoding == "csv")
+		{
+			uint32_t value = 0;
+			bool hasDigits = false;
+			for(char const c : text)
 			{
+				if(c >= '0' && c <= '9')
+				{
+					value = value * 10 + static_cast<uint32_t>(c - '0');
+					hasDigits = true;
+				}
+				else if(c == ',')
+				{
+					tiles.push_back(value);
+					value = 0;
+					hasDigits = false;
+				}
+			}
+			if(hasDigits)
+				tiles.push_back(value);
+			return true;
+		}
 
+		if(encoding != "base64")
+			return text.find_first_not_of(" \t\r\n") == std::string_view::npos; //<tile> elements are separated by whitespace
+
+		static constexpr uint8_t Invalid = 0xFF;
+		static const auto Table = []()
+		{
+			std::array<uint8_t, 256> table {};
+			table.fill(Invalid);
+			const char *const chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			for(uint8_t i = 0; i < 64; ++i)
+				table[static_cast<uint8_t>(chars[i])] = i;
+			return table;
+		}();
+
+		std::vector<uint8_t> bytes;
+		bytes.reserve(text.size() / 4 * 3);
+		uint32_t buffer = 0;
+		int bits = 0;
+		for(char const c : text)
+		{
+			uint8_t const sextet = Table[static_cast<uint8_t>(c)];
+			if(sextet == Invalid)
+				continue; //Whitespace and padding
+			buffer = (buffer << 6) | sextet;
+			bits += 6;
+			if(bits >= 8)
+			{
+				bits -= 8;
+				bytes.push_back(static_cast<uint8_t>(buffer >> bits));
 			}
-			size_t x;
-			size_t y;
-			/*! Full ID, including flag */
-			uint32_t id;
-			/*! ID of the flagged tile */
-			uint32_t tileId;
-	};
+		}
+
+		if(!compression.empty())
+		{
+			std::vector<uint8_t> decompressed;
+			decompressed.reserve(bytes.size() * 4);
+			bool ok = false;
+			if(compression == "zlib")
+				ok = Inflate::Zlib(bytes.data(), bytes.size(), decompressed);
+			else if(compression == "gzip")
+				ok = Inflate::Gzip(bytes.data(), bytes.size(), decompressed);
+			if(!ok)
+				return false;
+			bytes = std::move(decompressed);
+		}
+
+		size_t const count = bytes.size() / 4;
+		tiles.reserve(tiles.size() + count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			const uint8_t *tile = bytes.data() + i * 4;
+			tiles.push_back(static_cast<uint32_t>(tile[0]) | (static_cast<uint32_t>(tile[1]) << 8) |
+							(static_cast<uint32_t>(tile[2]) << 16) | (static_cast<uint32_t>(tile[3]) << 24));
+		}
+		return true;
+	}
 }
-#endif //TILESON_FLAGGEDTILE_HPP
 
-/*** End of inlined file: FlaggedTile.hpp ***/
+#endif //TILESON_TMXJSON_HPP
+
+/*** End of inlined file: TmxJson.hpp ***/
+
+
+/*** Start of inlined file: BinaryJson.hpp ***/
+#ifndef TILESON_BINARYJSON_HPP
+#define TILESON_BINARYJSON_HPP
+
+#include <cmath>
+#include <cstring>
 
 namespace tson
 {
-	class Tile;
-	class Map;
-
-	class Layer
+	/*!
+	 * Reads the Tiled json format stored as CBOR (RFC 8949) or MessagePack instead of text.
+	 *
+	 * The whole document is kept in one buffer, and strings and keys point into it, so parsing does not allocate
+	 * per value. Arrays of unsigned 32-bit integers may be stored as a typed array, which is copied directly into the
+	 * tile data of tson::Layer and tson::Chunk through readArray():
+	 * - CBOR: A byte string tagged with 70 (little endian) or 66 (big endian), as in RFC 8746.
+	 * - MessagePack: An ext value of type tson::BinaryJson::MessagePackUInt32Array, little endian.
+	 *
+	 * Maps are converted from json with tson::BinaryJson::ConvertJson(), which stores the tile 'data' of layers and chunks as
+	 * typed arrays. External tilesets and templates are read with the same backend, so they must be converted as well.
+	 *
+	 * Use tson::CborJson or tson::MessagePackJson as the json parser of tson::Tileson.
+	 */
+	class BinaryJson : public tson::IJson
 	{
 		public:
-			inline Layer() = default;
-			inline Layer(IJson &json, tson::Map *map);
-			inline bool parse(IJson &json, tson::Map *map); //Defined in tileson_forward
-
-			[[nodiscard]] inline const std::string &getCompression() const;
-			[[nodiscard]] inline const std::vector<uint32_t> &getData() const;
-			[[nodiscard]] inline const std::string &getBase64Data() const;
-			[[nodiscard]] inline const std::string &getDrawOrder() const;
-			[[nodiscard]] inline const std::string &getEncoding() const;
-			[[nodiscard]] inline int getId() const;
-			[[nodiscard]] inline const std::string &getImage() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline const Vector2f &getOffset() const;
-			[[nodiscard]] inline float getOpacity() const;
-			[[nodiscard]] inline const Vector2i &getSize() const;
-			[[nodiscard]] inline const Colori &getTransparentColor() const;
-			[[nodiscard]] inline const Vector2f &getParallax() const;
-			[[nodiscard]] inline bool hasRepeatX() const;
-			[[nodiscard]] inline bool hasRepeatY() const;
+			enum class Format : uint8_t
+			{
+				Cbor = 0,
+				MessagePack = 1
+			};
 
-			[[nodiscard]] inline LayerType getType() const;
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			static constexpr uint64_t CborUInt32BigEndianTag {66};
+			static constexpr uint64_t CborUInt32LittleEndianTag {70};
+			static constexpr int8_t MessagePackUInt32Array {0x55};
 
-			[[nodiscard]] inline const std::string &getTypeStr() const;
-			[[nodiscard]] inline bool isVisible() const;
-			[[nodiscard]] inline int getX() const;
-			[[nodiscard]] inline int getY() const;
+			inline explicit BinaryJson(Format format);
 
-			[[nodiscard]] inline std::vector<tson::Chunk> &getChunks();
-			[[nodiscard]] inline std::vector<tson::Layer> &getLayers();
-			[[nodiscard]] inline std::vector<tson::Object> &getObjects();
-			[[nodiscard]] inline PropertyCollection &getProperties();
+			inline IJson &operator[](std::string_view key) override;
+			inline IJson &at(std::string_view key) override;
+			inline IJson &at(size_t pos) override;
+			inline std::vector<std::unique_ptr<IJson>> array() override;
+			inline std::vector<std::unique_ptr<IJson>> &array(std::string_view key) override;
+			[[nodiscard]] inline size_t size() const override;
 
-			inline tson::Object *getObj(int id);
-			inline tson::Object *firstObj(const std::string &name);
-			inline std::vector<tson::Object> getObjectsByName(const std::string &name);
-			inline std::vector<tson::Object> getObjectsByType(tson::ObjectType type);
+			inline bool parse(const fs::path &path) override;
+			inline bool parse(const void *data, size_t size) override;
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+			[[nodiscard]] inline size_t count(std::string_view key) const override;
+			[[nodiscard]] inline bool any(std::string_view key) const override;
+			[[nodiscard]] inline bool isArray() const override;
+			[[nodiscard]] inline bool isObject() const override;
+			[[nodiscard]] inline bool isNull() const override;
+			inline bool readArray(std::string_view key, std::vector<uint32_t> &values) override;
+			inline bool readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength,
+										size_t x, size_t y, size_t width, size_t height) override;
 
-			inline void assignTileMap(std::map<uint32_t, tson::Tile*> *tileMap);
-			inline void createTileData(const Vector2i &mapSize, bool isInfiniteMap);
+			[[nodiscard]] inline fs::path directory() const override;
+			inline void directory(const fs::path &directory) override;
+			inline std::unique_ptr<IJson> create() override;
 
-			[[nodiscard]] inline const std::map<std::tuple<int, int>, tson::Tile *> &getTileData() const;
-			inline tson::Tile * getTileData(int x, int y);
+			[[nodiscard]] inline Format getFormat() const;
 
-			//v1.2.0-stuff
-			[[nodiscard]] inline const Colori &getTintColor() const;
-			[[nodiscard]] inline tson::Map *getMap() const;
+			#ifdef JSON11_IS_DEFINED
+			inline static std::vector<uint8_t> FromJson(const json11::Json &json, Format format);
+			inline static bool ConvertJson(const fs::path &jsonPath, const fs::path &outputPath, Format format);
+			#endif
 
-			[[nodiscard]] inline std::map<std::tuple<int, int>, tson::TileObject> &getTileObjects();
-			inline tson::TileObject * getTileObject(int x, int y);
-			[[nodiscard]] inline const std::set<uint32_t> &getUniqueFlaggedTiles() const;
-			inline void resolveFlaggedTiles();
+		protected:
+			[[nodiscard]] inline int32_t getInt32(std::string_view key) override;
+			[[nodiscard]] inline uint32_t getUInt32(std::string_view key) override;
+			[[nodiscard]] inline int64_t getInt64(std::string_view key) override;
+			[[nodiscard]] inline uint64_t getUInt64(std::string_view key) override;
+			[[nodiscard]] inline double getDouble(std::string_view key) override;
+			[[nodiscard]] inline float getFloat(std::string_view key) override;
+			[[nodiscard]] inline std::string getString(std::string_view key) override;
+			[[nodiscard]] inline bool getBool(std::string_view key) override;
+
+			[[nodiscard]] inline int32_t getInt32() override;
+			[[nodiscard]] inline uint32_t getUInt32() override;
+			[[nodiscard]] inline int64_t getInt64() override;
+			[[nodiscard]] inline uint64_t getUInt64() override;
+			[[nodiscard]] inline double getDouble() override;
+			[[nodiscard]] inline float getFloat() override;
+			[[nodiscard]] inline std::string getString() override;
+			[[nodiscard]] inline bool getBool() override;
 
 		private:
-			inline void setTypeByString();
+			/*!
+			 * A decoded value. Strings, keys and typed arrays point into the buffer of the document.
+			 */
+			class Value
+			{
+				public:
+					enum class Kind : uint8_t
+					{
+						Null = 0,
+						Bool = 1,
+						Int = 2,
+						UInt = 3,           /*! Only used for values above INT64_MAX */
+						Double = 4,
+						String = 5,
+						Array = 6,
+						Object = 7,
+						UInt32Array = 8     /*! The bytes are in 'text' */
+					};
+
+					[[nodiscard]] inline double toDouble() const;
+					[[nodiscard]] inline int64_t toInt64() const;
+					[[nodiscard]] inline uint64_t toUInt64() const;
+					[[nodiscard]] inline uint32_t getUInt32(size_t index) const;
+					[[nodiscard]] inline const Value *find(std::string_view key) const;
+
+					Kind                            kind {Kind::Null};
+					bool                            bigEndian {false};
+					bool                            boolean {false};
+					int64_t                         integer {0};
+					uint64_t                        unsignedInteger {0};
+					double                          number {0.0};
+					std::string_view                text;
+					std::vector<std::string_view>   keys;       /*! Keys of the items of an object */
+					std::vector<Value>              items;
+			};
 
-			std::vector<tson::Chunk>                       m_chunks; 	                      /*! 'chunks': Array of chunks (optional). tilelayer only. */
-			std::string                                    m_compression;                     /*! 'compression': zlib, gzip or empty (default). tilelayer only. */
-			std::vector<uint32_t>                          m_data;                            /*! 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded
-																							   *   data. tilelayer only. */
-			std::string                                    m_base64Data;                      /*! 'data' (when string):     Array of unsigned int (GIDs) or base64-encoded
-																							   *   data. tilelayer only. */
-			std::string                                    m_drawOrder;                       /*! 'draworder': topdown (default) or index. objectgroup only. */
-			std::string                                    m_encoding;                        /*! 'encoding': csv (default) or base64. tilelayer only. */
-			int                                            m_id{};                            /*! 'id': Incremental id - unique across all layers */
-			std::string                                    m_image;                           /*! 'image': Image used by this layer. imagelayer only. */
-			std::vector<tson::Layer>                       m_layers; 	                      /*! 'layers': Array of layers. group on */
-			std::string                                    m_name;                            /*! 'name': Name assigned to this layer */
-			std::vector<tson::Object>                      m_objects;                         /*! 'objects': Array of objects. objectgroup only. */
-			tson::Vector2f                                 m_offset;                          /*! 'offsetx' and 'offsety': Horizontal and Vertical layer offset in pixels
-																							   *  (default: {0, 0}) */
-			float                                          m_opacity{};                       /*! 'opacity': Value between 0 and 1 */
-			tson::PropertyCollection                       m_properties; 	                  /*! 'properties': A list of properties (name, value, type). */
-			tson::Vector2i                                 m_size;                            /*! x = 'width': (Column count. Same as map width for fixed-size maps.)
-																								  y = 'height': Row count. Same as map height for fixed-size maps. */
-			tson::Colori                                   m_transparentColor;                /*! 'transparentcolor': Hex-formatted color (#RRGGBB) (optional, imagelayer only */
-			std::string                                    m_typeStr;                         /*! 'type': tilelayer, objectgroup, imagelayer or group */
-			LayerType                                      m_type {LayerType::Undefined};     /*! Layer type as enum*/
-			bool                                           m_visible{};                       /*! 'visible': Whether layer is shown or hidden in editor */
-			int                                            m_x{};                             /*! 'x': Horizontal layer offset in tiles. Always 0. */
-			int                                            m_y{};                             /*! 'y': Vertical layer offset in tiles. Always 0. */
-			tson::Vector2f                                 m_parallax{1.f, 1.f};    /*! Tiled v1.5: parallax factor for this layer. Defaults to 1.
-																								  x = 'parallaxx', y = 'parallaxy'*/
-			bool                                           m_repeatX {};                         /*! 'repeatx': Whether the image drawn by this layer is repeated along the X axis. (since Tiled 1.8)*/
-			bool                                           m_repeatY {};                         /*! 'repeaty': Whether the image drawn by this layer is repeated along the Y axis. (since Tiled 1.8)*/
+			class Reader
+			{
+				public:
+					inline Reader(const uint8_t *data, size_t size);
+
+					inline uint8_t byte();
+					inline uint64_t bigEndian(size_t bytes);
+					inline std::string_view bytes(uint64_t length);
+					[[nodiscard]] inline bool hasMore() const;
+					[[nodiscard]] inline bool isAtEnd() const;
+					[[nodiscard]] inline uint8_t peek() const;
+
+					bool ok {true};
+
+				private:
+					const uint8_t * m_data;
+					size_t m_size;
+					size_t m_pos {0};
+			};
 
-			std::map<uint32_t, tson::Tile*>                *m_tileMap;
-			std::map<std::tuple<int, int>, tson::Tile*>    m_tileData;                        /*! Key: Tuple of x and y pos in tile units. */
+			inline BinaryJson(const Value *value, Format format, const fs::path &path);
+			inline BinaryJson(std::unique_ptr<Value> value, Format format);
 
-			//v1.2.0-stuff
-			tson::Colori                                        m_tintColor;                  /*! 'tintcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) that is multiplied with
-																							   *        any graphics drawn by this layer or any child layers (optional). */
-			inline void decompressData();                                                     /*! Defined in tileson_forward.hpp */
-			inline void queueFlaggedTile(size_t x, size_t y, uint32_t id);                    /*! Queue a flagged tile */
+			inline bool decode();
+			inline IJson &child(std::string_view key);
+			[[nodiscard]] inline const Value *value(std::string_view key) const;
+			inline std::unique_ptr<IJson> makeUInt32(uint32_t number) const;
+			inline void clearCache();
+			inline static const Value *GetNullValue();
 
-			tson::Map *                                         m_map;                        /*! The map who owns this layer */
-			std::map<std::tuple<int, int>, tson::TileObject>    m_tileObjects;
-			std::set<uint32_t>                                  m_uniqueFlaggedTiles;
-			std::vector<tson::FlaggedTile>                      m_flaggedTiles;
+			inline static bool ReadCbor(Reader &reader, Value &value, int depth);
+			inline static bool ReadCborLength(Reader &reader, uint8_t info, uint64_t &length);
+			inline static bool ReadMessagePack(Reader &reader, Value &value, int depth);
+			inline static bool ReadMessagePackItems(Reader &reader, Value &value, uint64_t count, bool isObject, int depth);
+			inline static double HalfToDouble(uint16_t half);
 
-			std::string                                         m_classType{};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
-			std::shared_ptr<tson::TiledClass>                   m_class {};
+			#ifdef JSON11_IS_DEFINED
+			inline static void WriteCbor(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData);
+			inline static void WriteCborHead(uint8_t majorType, uint64_t length, std::vector<uint8_t> &out);
+			inline static void WriteMessagePack(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData);
+			inline static void WriteMessagePackHead(uint8_t small, uint8_t smallLimit, uint8_t head8, uint64_t length, std::vector<uint8_t> &out);
+			inline static void WriteBigEndian(uint64_t number, size_t bytes, std::vector<uint8_t> &out);
+			inline static bool IsTileData(const json11::Json &json);
+			#endif
+
+			static constexpr int MaxDepth {256};
+
+			std::vector<uint8_t>    m_buffer;               /*! Only used if this is the owner! */
+			std::unique_ptr<Value>  m_root;                 /*! Only used if this is the owner! */
+			const Value *           m_value {GetNullValue()};
+			Format                  m_format;
+			fs::path                m_path;
+
+			//Cache!
+			std::map<std::string, std::unique_ptr<IJson>, std::less<>> m_arrayCache;
+			std::map<size_t, std::unique_ptr<IJson>> m_arrayPosCache;
+			std::map<std::string, std::vector<std::unique_ptr<IJson>>, std::less<>> m_arrayListDataCache;
 	};
 
 	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 * Reads maps stored as CBOR.
+	 *
+	 * Example:
+	 * tson::Tileson t {std::make_unique<tson::CborJson>()};
+	 * std::unique_ptr<tson::Map> map = t.parse("map.cbor");
 	 */
-	template<typename T>
-	T Layer::get(const std::string &name)
+	class CborJson : public BinaryJson
 	{
-		return m_properties.getValue<T>(name);
-	}
-}
-
-/*!
- * Parses a Tiled layer from json
- * @param json
- */
-tson::Layer::Layer(IJson &json, tson::Map *map)
-{
-	parse(json, map);
-}
+		public:
+			inline CborJson() : BinaryJson(Format::Cbor) {}
+			inline std::unique_ptr<IJson> create() override { return std::make_unique<CborJson>(); }
+	};
 
-void tson::Layer::queueFlaggedTile(size_t x, size_t y, uint32_t id)
-{
-	uint32_t tileId = id;
-	tileId &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
-	m_uniqueFlaggedTiles.insert(id);
-	m_flaggedTiles.emplace_back(x, y, id, tileId);
-}
+	/*!
+	 * Reads maps stored as MessagePack.
+	 *
+	 * Example:
+	 * tson::Tileson t {std::make_unique<tson::MessagePackJson>()};
+	 * std::unique_ptr<tson::Map> map = t.parse("map.msgpack");
+	 */
+	class MessagePackJson : public BinaryJson
+	{
+		public:
+			inline MessagePackJson() : BinaryJson(Format::MessagePack) {}
+			inline std::unique_ptr<IJson> create() override { return std::make_unique<MessagePackJson>(); }
+	};
 
-/*!
- * Copies all objects with a name that equals the parameter
- * @param name Name of the objects to return
- * @return All objects with a matching name
- */
-std::vector<tson::Object> tson::Layer::getObjectsByName(const std::string &name)
-{
-	std::vector<tson::Object> found;
+	double BinaryJson::Value::toDouble() const
+	{
+		switch(kind)
+		{
+			case Kind::Int: return static_cast<double>(integer);
+			case Kind::UInt: return static_cast<double>(unsignedInteger);
+			case Kind::Double: return number;
+			default: return 0.0;
+		}
+	}
 
-	std::copy_if(m_objects.begin(), m_objects.end(), std::back_inserter(found), [&](const tson::Object &item)
+	int64_t BinaryJson::Value::toInt64() const
 	{
-		return item.getName() == name;
-	});
+		switch(kind)
+		{
+			case Kind::Int: return integer;
+			case Kind::UInt: return static_cast<int64_t>(unsignedInteger);
+			case Kind::Double: return static_cast<int64_t>(number);
+			default: return 0;
+		}
+	}
 
-	return found;
-}
+	uint64_t BinaryJson::Value::toUInt64() const
+	{
+		switch(kind)
+		{
+			case Kind::Int: return static_cast<uint64_t>(integer);
+			case Kind::UInt: return unsignedInteger;
+			case Kind::Double: return static_cast<uint64_t>(number);
+			default: return 0;
+		}
+	}
 
-/*!
- * Copies all objects with a type that equals the parameter
- * @param type LayerType of the objects to return
- * @return All objects with a matching type
- */
-std::vector<tson::Object> tson::Layer::getObjectsByType(tson::ObjectType type)
-{
-	std::vector<tson::Object> found;
+	/*!
+	 * Gets an item of a typed array
+	 */
+	uint32_t BinaryJson::Value::getUInt32(size_t index) const
+	{
+		const auto *bytes = reinterpret_cast<const uint8_t *>(text.data()) + index * 4;
+		if(bigEndian)
+			return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+		return bytes[0] | (static_cast<uint32_t>(bytes[1]) << 8) | (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+	}
 
-	std::copy_if(m_objects.begin(), m_objects.end(), std::back_inserter(found), [&](const tson::Object &item)
+	const BinaryJson::Value *BinaryJson::Value::find(std::string_view key) const
 	{
-		return item.getObjectType() == type;
-	});
-
-	return found;
-}
-
-/*!
- * Returns the first object with the given name
- * @param name Name of the object to find.
- * @return A pointer to the object if found. nullptr otherwise.
- */
-tson::Object *tson::Layer::firstObj(const std::string &name)
-{
-	auto result = std::find_if(m_objects.begin(), m_objects.end(), [&](const tson::Object &obj){return obj.getName() == name; });
-	if(result == m_objects.end())
+		for(size_t i = 0; i < keys.size(); ++i)
+		{
+			if(keys[i] == key)
+				return &items[i];
+		}
 		return nullptr;
+	}
 
-	return &result.operator*();
-}
+	BinaryJson::Reader::Reader(const uint8_t *data, size_t size) : m_data {data}, m_size {size}
+	{
 
-/*!
- * Get an object by ID
- * @param id Unique ID of the object
- * @return A pointer to the object if found. nullptr otherwise.
- */
-tson::Object *tson::Layer::getObj(int id)
-{
-	auto result = std::find_if(m_objects.begin(), m_objects.end(), [&](const tson::Object &obj){return obj.getId() == id; });
-	if(result == m_objects.end())
-		return nullptr;
+	}
 
-	return &result.operator*();
-}
+	uint8_t BinaryJson::Reader::byte()
+	{
+		if(m_pos >= m_size)
+		{
+			ok = false;
+			return 0;
+		}
+		return m_data[m_pos++];
+	}
 
-/*!
- * Set type by string
- * tilelayer, objectgroup, imagelayer or group
- */
-void tson::Layer::setTypeByString()
-{
-	if(m_typeStr == "tilelayer") m_type = LayerType::TileLayer;
-	else if(m_typeStr == "objectgroup") m_type = LayerType::ObjectGroup;
-	else if(m_typeStr == "imagelayer") m_type = LayerType::ImageLayer;
-	else if(m_typeStr == "group") m_type = LayerType::Group;
-	else m_type = LayerType::Undefined;
-}
+	uint64_t BinaryJson::Reader::bigEndian(size_t bytes)
+	{
+		if(m_size - m_pos < bytes)
+		{
+			ok = false;
+			m_pos = m_size;
+			return 0;
+		}
 
-/*!
- * 'compression': zlib, gzip or empty (default). tilelayer only.
- * @return
- */
-const std::string &tson::Layer::getCompression() const
-{
-	return m_compression;
-}
+		uint64_t number = 0;
+		for(size_t i = 0; i < bytes; ++i)
+			number = (number << 8) | m_data[m_pos++];
+		return number;
+	}
 
-/*!
- * 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only.
- * @return
- */
-const std::vector<uint32_t> &tson::Layer::getData() const
-{
-	return m_data;
-}
+	std::string_view BinaryJson::Reader::bytes(uint64_t length)
+	{
+		if(m_size - m_pos < length)
+		{
+			ok = false;
+			m_pos = m_size;
+			return {};
+		}
 
-/*!
- * 'data' (when string): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only.
- * @return
- */
-const std::string &tson::Layer::getBase64Data() const
-{
-	return m_base64Data;
-}
+		std::string_view view {reinterpret_cast<const char *>(m_data + m_pos), static_cast<size_t>(length)};
+		m_pos += static_cast<size_t>(length);
+		return view;
+	}
 
-/*!
- * 'draworder': topdown (default) or index. objectgroup only.
- * @return
- */
-const std::string &tson::Layer::getDrawOrder() const
-{
-	return m_drawOrder;
-}
+	bool BinaryJson::Reader::hasMore() const
+	{
+		return ok && m_pos < m_size;
+	}
 
-/*!
- * 'encoding': csv (default) or base64. tilelayer only.
- * @return
- */
-const std::string &tson::Layer::getEncoding() const
-{
-	return m_encoding;
-}
+	bool BinaryJson::Reader::isAtEnd() const
+	{
+		return m_pos == m_size;
+	}
 
-/*!
- * 'id': Incremental id - unique across all layers
- * @return
- */
-int tson::Layer::getId() const
-{
-	return m_id;
-}
+	uint8_t BinaryJson::Reader::peek() const
+	{
+		return (m_pos < m_size) ? m_data[m_pos] : 0;
+	}
 
-/*!
- * 'image': Image used by this layer. imagelayer only.
- * @return
- */
-const std::string &tson::Layer::getImage() const
-{
-	return m_image;
-}
+	BinaryJson::BinaryJson(Format format) : m_format {format}
+	{
 
-/*!
- * 'name': Name assigned to this layer
- * @return
- */
-const std::string &tson::Layer::getName() const
-{
-	return m_name;
-}
+	}
 
-/*!
- * 'offsetx' and 'offsety': Horizontal and Vertical layer offset in pixels (default: {0, 0})
- * @return
- */
-const tson::Vector2f &tson::Layer::getOffset() const
-{
-	return m_offset;
-}
+	BinaryJson::BinaryJson(const Value *value, Format format, const fs::path &path) : m_value {value}, m_format {format}, m_path {path}
+	{
 
-/*!
- * 'opacity': Value between 0 and 1
- * @return
- */
-float tson::Layer::getOpacity() const
-{
-	return m_opacity;
-}
+	}
 
-/*!
- * x = 'width': (Column count. Same as map width for fixed-size maps.)
- * y = 'height': Row count. Same as map height for fixed-size maps.
- * @return width and height as a single size
- */
-const tson::Vector2i &tson::Layer::getSize() const
-{
-	return m_size;
-}
+	BinaryJson::BinaryJson(std::unique_ptr<Value> value, Format format) : m_root {std::move(value)}, m_value {m_root.get()}, m_format {format}
+	{
 
-/*!
- * 'transparentcolor': Color created from a hex color (#RRGGBB) (optional, imagelayer only)
- * @return color as color object with rgba channel.
- */
-const tson::Colori &tson::Layer::getTransparentColor() const
-{
-	return m_transparentColor;
-}
+	}
 
-/*!
- * 'type': tilelayer, objectgroup, imagelayer or group
- * @return string with the object type
- */
-const std::string &tson::Layer::getTypeStr() const
-{
-	return m_typeStr;
-}
+	IJson &BinaryJson::operator[](std::string_view key)
+	{
+		return child(key);
+	}
 
-/*!
- * 'visible': Whether layer is shown or hidden in editor
- * @return
- */
-bool tson::Layer::isVisible() const
-{
-	return m_visible;
-}
+	IJson &BinaryJson::at(std::string_view key)
+	{
+		return child(key);
+	}
 
-/*!
- * 'x': Horizontal layer offset in tiles. Always 0.
- * @return x value (always 0 for layer)
- */
-int tson::Layer::getX() const
-{
-	return m_x;
-}
+	IJson &BinaryJson::at(size_t pos)
+	{
+		auto it = m_arrayPosCache.find(pos);
+		if(it == m_arrayPosCache.end())
+		{
+			std::unique_ptr<IJson> item;
+			if(m_value->kind == Value::Kind::UInt32Array)
+				item = makeUInt32(m_value->getUInt32(pos));
+			else
+				item = std::unique_ptr<IJson>(new BinaryJson(&m_value->items.at(pos), m_format, m_path));
+			it = m_arrayPosCache.emplace(pos, std::move(item)).first;
+		}
+		return *it->second;
+	}
 
-/*!
- * 'y': Horizontal layer offset in tiles. Always 0.
- * @return y value (always 0 for layer)
- */
-int tson::Layer::getY() const
-{
-	return m_y;
-}
+	std::vector<std::unique_ptr<IJson>> BinaryJson::array()
+	{
+		std::vector<std::unique_ptr<IJson>> vec;
+		if(m_value->kind == Value::Kind::Array)
+		{
+			for(const Value &item : m_value->items)
+				vec.emplace_back(new BinaryJson(&item, m_format, m_path));
+		}
+		else if(m_value->kind == Value::Kind::UInt32Array)
+		{
+			for(size_t i = 0; i < size(); ++i)
+				vec.emplace_back(makeUInt32(m_value->getUInt32(i)));
+		}
+		return vec;
+	}
 
-/*!
- * 'chunks': Array of chunks (optional). tilelayer only.
- * @return
- */
-std::vector<tson::Chunk> &tson::Layer::getChunks()
-{
-	return m_chunks;
-}
+	std::vector<std::unique_ptr<IJson>> &BinaryJson::array(std::string_view key)
+	{
+		auto it = m_arrayListDataCache.find(key);
+		if(it == m_arrayListDataCache.end())
+		{
+			it = m_arrayListDataCache.emplace(std::string(key), std::vector<std::unique_ptr<IJson>>()).first;
+			if(value(key) != nullptr)
+				it->second = child(key).array();
+		}
+		return it->second;
+	}
 
-/*!
- * 'layers': Array of layers. group on
- * @return
- */
-std::vector<tson::Layer> &tson::Layer::getLayers()
-{
-	return m_layers;
-}
+	size_t BinaryJson::size() const
+	{
+		if(m_value->kind == Value::Kind::UInt32Array)
+			return m_value->text.size() / 4;
+		if(m_value->kind == Value::Kind::Array || m_value->kind == Value::Kind::Object)
+			return m_value->items.size();
+		return 0;
+	}
 
-/*!
- * 'objects': Array of objects. objectgroup only.
- * @return
- */
-std::vector<tson::Object> &tson::Layer::getObjects()
-{
-	return m_objects;
-}
+	bool BinaryJson::parse(const fs::path &path)
+	{
+		clearCache();
+		m_root = nullptr;
+		m_value = GetNullValue();
+		if(!fs::exists(path) || !fs::is_regular_file(path))
+			return false;
 
-/*!
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::Layer::getProperties()
-{
-	return m_properties;
-}
+		std::ifstream file(path, std::ios::binary);
+		m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		if(!decode())
+			return false;
+
+		m_path = path.parent_path();
+		return true;
+	}
+
+	/*!
+	 * Parses a document in memory. The data is copied, so it may be freed afterwards.
+	 */
+	bool BinaryJson::parse(const void *data, size_t size)
+	{
+		clearCache();
+		const auto *bytes = static_cast<const uint8_t *>(data);
+		m_buffer.assign(bytes, bytes + size);
+		return decode();
+	}
+
+	size_t BinaryJson::count(std::string_view key) const
+	{
+		return (value(key) != nullptr) ? 1 : 0;
+	}
+
+	bool BinaryJson::any(std::string_view key) const
+	{
+		return count(key) > 0;
+	}
+
+	bool BinaryJson::isArray() const
+	{
+		return m_value->kind == Value::Kind::Array || m_value->kind == Value::Kind::UInt32Array;
+	}
+
+	bool BinaryJson::isObject() const
+	{
+		return m_value->kind == Value::Kind::Object;
+	}
+
+	bool BinaryJson::isNull() const
+	{
+		return m_value->kind == Value::Kind::Null;
+	}
+
+	/*!
+	 * Copies typed arrays directly, without creating a json value per item
+	 */
+	bool BinaryJson::readArray(std::string_view key, std::vector<uint32_t> &values)
+	{
+		const Value *node = value(key);
+		if(node == nullptr || node->kind != Value::Kind::UInt32Array)
+			return IJson::readArray(key, values);
+
+		size_t const count = node->text.size() / 4;
+		size_t const offset = values.size();
+		values.resize(offset + count);
+		for(size_t i = 0; i < count; ++i)
+			values[offset + i] = node->getUInt32(i);
+		return true;
+	}
+
+	/*!
+	 * Reads only the items of a typed array that are inside the rectangle, by seeking to each row
+	 */
+	bool BinaryJson::readArrayRegion(std::string_view key, std::vector<uint32_t> &values, size_t rowLength, size_t x, size_t y, size_t width, size_t height)
+	{
+		const Value *node = value(key);
+		if(node == nullptr || node->kind != Value::Kind::UInt32Array)
+			return IJson::readArrayRegion(key, values, rowLength, x, y, width, height);
+
+		size_t const count = node->text.size() / 4;
+		values.reserve(values.size() + width * height);
+		for(size_t row = y; row < y + height; ++row)
+		{
+			for(size_t i = row * rowLength + x; i < row * rowLength + x + width; ++i)
+				values.push_back((i < count) ? node->getUInt32(i) : 0);
+		}
+		return true;
+	}
+
+	fs::path BinaryJson::directory() const
+	{
+		return m_path;
+	}
+
+	void BinaryJson::directory(const fs::path &directory)
+	{
+		m_path = directory;
+	}
+
+	std::unique_ptr<IJson> BinaryJson::create()
+	{
+		return std::make_unique<BinaryJson>(m_format);
+	}
+
+	BinaryJson::Format BinaryJson::getFormat() const
+	{
+		return m_format;
+	}
+
+	int32_t BinaryJson::getInt32(std::string_view key)
+	{
+		const Value *node = value(key);
+		return (node != nullptr) ? static_cast<int32_t>(node->toInt64()) : 0;
+	}
+
+	uint32_t BinaryJson::getUInt32(std::string_view key)
+	{
+		const Value *node = value(key);
+		return (node != nullptr) ? static_cast<uint32_t>(node->toUInt64()) : 0;
+	}
+
+	int64_t BinaryJson::getInt64(std::string_view key)
+	{
+		const Value *node = value(key);
+		return (node != nullptr) ? node->toInt64() : 0;
+	}
+
+	uint64_t BinaryJson::getUInt64(std::string_view key)
+	{
+		const Value *node = value(key);
+		return (node != nullptr) ? node->toUInt64() : 0;
+	}
+
+	double BinaryJson::getDouble(std::string_view key)
+	{
+		const Value *node = value(key);
+		return (node != nullptr) ? node->toDouble() : 0.0;
+	}
+
+	float BinaryJson::getFloat(std::string_view key)
+	{
+		return static_cast<float>(getDouble(key));
+	}
+
+	std::string BinaryJson::getString(std::string_view key)
+	{
+		const Value *node = value(key);
+		return (node != nullptr && node->kind == Value::Kind::String) ? std::string(node->text) : std::string();
+	}
+
+	bool BinaryJson::getBool(std::string_view key)
+	{
+		const Value *node = value(key);
+		return node != nullptr && node->kind == Value::Kind::Bool && node->boolean;
+	}
+
+	int32_t BinaryJson::getInt32()
+	{
+		return static_cast<int32_t>(m_value->toInt64());
+	}
+
+	uint32_t BinaryJson::getUInt32()
+	{
+		return static_cast<uint32_t>(m_value->toUInt64());
+	}
+
+	int64_t BinaryJson::getInt64()
+	{
+		return m_value->toInt64();
+	}
+
+	uint64_t BinaryJson::getUInt64()
+	{
+		return m_value->toUInt64();
+	}
+
+	double BinaryJson::getDouble()
+	{
+		return m_value->toDouble();
+	}
+
+	float BinaryJson::getFloat()
+	{
+		return static_cast<float>(getDouble());
+	}
+
+	std::string BinaryJson::getString()
+	{
+		return (m_value->kind == Value::Kind::String) ? std::string(m_value->text) : std::string();
+	}
+
+	bool BinaryJson::getBool()
+	{
+		return m_value->kind == Value::Kind::Bool && m_value->boolean;
+	}
+
+	/*!
+	 * Decodes m_buffer into m_root. The document must be exactly one value.
+	 */
+	bool BinaryJson::decode()
+	{
+		m_root = std::make_unique<Value>();
+		Reader reader {m_buffer.data(), m_buffer.size()};
+		bool const ok = (m_format == Format::Cbor) ? ReadCbor(reader, *m_root, 0) : ReadMessagePack(reader, *m_root, 0);
+		if(!ok || !reader.ok || !reader.isAtEnd() || m_root->kind != Value::Kind::Object)
+		{
+			std::cerr << ((m_format == Format::Cbor) ? "CborJson" : "MessagePackJson") << " parse error: Invalid or truncated document\n";
+			m_root = nullptr;
+			m_value = GetNullValue();
+			return false;
+		}
+
+		m_value = m_root.get();
+		return true;
+	}
+
+	IJson &BinaryJson::child(std::string_view key)
+	{
+		auto it = m_arrayCache.find(key);
+		if(it == m_arrayCache.end())
+		{
+			const Value *node = value(key);
+			std::unique_ptr<IJson> item {new BinaryJson((node != nullptr) ? node : GetNullValue(), m_format, m_path)};
+			it = m_arrayCache.emplace(std::string(key), std::move(item)).first;
+		}
+		return *it->second;
+	}
+
+	const BinaryJson::Value *BinaryJson::value(std::string_view key) const
+	{
+		return (m_value->kind == Value::Kind::Object) ? m_value->find(key) : nullptr;
+	}
+
+	/*!
+	 * An item of a typed array, which has no Value of its own
+	 */
+	std::unique_ptr<IJson> BinaryJson::makeUInt32(uint32_t number) const
+	{
+		std::unique_ptr<Value> item = std::make_unique<Value>();
+		item->kind = Value::Kind::Int;
+		item->integer = number;
+		return std::unique_ptr<IJson>(new BinaryJson(std::move(item), m_format));
+	}
+
+	void BinaryJson::clearCache()
+	{
+		m_arrayCache.clear();
+		m_arrayPosCache.clear();
+		m_arrayListDataCache.clear();
+	}
+
+	/*!
+	 * The value of keys that do not exist
+	 */
+	const BinaryJson::Value *BinaryJson::GetNullValue()
+	{
+		static const Value nullValue;
+		return &nullValue;
+	}
+
+	/*!
+	 * Reads the length or value following the initial byte of a CBOR item. 'info' is the low 5 bits of the initial byte.
+	 * Indefinite lengths (31) are not handled here.
+	 */
+	bool BinaryJson::ReadCborLength(Reader &reader, uint8_t info, uint64_t &length)
+	{
+		if(info < 24)
+			length = info;
+		else if(info <= 27)
+			length = reader.bigEndian(size_t(1) << (info - 24));
+		else
+			return false;
+		return reader.ok;
+	}
+
+	bool BinaryJson::ReadCbor(Reader &reader, Value &value, int depth)
+	{
+		if(depth > MaxDepth)
+			return false;
+
+		uint8_t const initial = reader.byte();
+		uint8_t const major = initial >> 5;
+		uint8_t const info = initial & 0x1f;
+		if(!reader.ok)
+			return false;
+
+		//Floats and simple values
+		if(major == 7)
+		{
+			switch(info)
+			{
+				case 20: value.kind = Value::Kind::Bool; value.boolean = false; return true;
+				case 21: value.kind = Value::Kind::Bool; value.boolean = true; return true;
+				case 22:
+				case 23: value.kind = Value::Kind::Null; return true;
+				case 25:
+					value.kind = Value::Kind::Double;
+					value.number = HalfToDouble(static_cast<uint16_t>(reader.bigEndian(2)));
+					return reader.ok;
+				case 26:
+				{
+					auto const bits = static_cast<uint32_t>(reader.bigEndian(4));
+					float number;
+					std::memcpy(&number, &bits, sizeof(number));
+					value.kind = Value::Kind::Double;
+					value.number = number;
+					return reader.ok;
+				}
+				case 27:
+				{
+					uint64_t const bits = reader.bigEndian(8);
+					value.kind = Value::Kind::Double;
+					std::memcpy(&value.number, &bits, sizeof(value.number));
+					return reader.ok;
+				}
+				default: return false;
+			}
+		}
+
+		bool const indefinite = info == 31 && (major == 4 || major == 5);
+		uint64_t length = 0;
+		if(!indefinite && !ReadCborLength(reader, info, length))
+			return false;
+
+		switch(major)
+		{
+			case 0:
+				if(length > static_cast<uint64_t>(INT64_MAX))
+				{
+					value.kind = Value::Kind::UInt;
+					value.unsignedInteger = length;
+				}
+				else
+				{
+					value.kind = Value::Kind::Int;
+					value.integer = static_cast<int64_t>(length);
+				}
+				return true;
+
+			case 1:
+				if(length > static_cast<uint64_t>(INT64_MAX))
+					return false;
+				value.kind = Value::Kind::Int;
+				value.integer = -1 - static_cast<int64_t>(length);
+				return true;
+
+			case 2:
+			case 3:
+				value.kind = Value::Kind::String;
+				value.text = reader.bytes(length);
+				return reader.ok;
+
+			case 4:
+			case 5:
+			{
+				bool const isObject = major == 5;
+				value.kind = (isObject) ? Value::Kind::Object : Value::Kind::Array;
+				if(!indefinite)
+				{
+					//Every item is at least one byte, which keeps a broken length from reserving too much
+					value.items.reserve(static_cast<size_t>(std::min<uint64_t>(length, 1024)));
+					if(isObject)
+						value.keys.reserve(value.items.capacity());
+				}
+
+				for(uint64_t i = 0; (indefinite) ? reader.peek() != 0xff : i < length; ++i)
+				{
+					if(!reader.hasMore())
+						return false;
+					if(isObject)
+					{
+						Value key;
+						if(!ReadCbor(reader, key, depth + 1) || key.kind != Value::Kind::String)
+							return false;
+						value.keys.push_back(key.text);
+					}
+					if(!ReadCbor(reader, value.items.emplace_back(), depth + 1))
+						return false;
+				}
+				if(indefinite)
+					reader.byte();
+				return reader.ok;
+			}
+
+			case 6:
+			{
+				if(!ReadCbor(reader, value, depth + 1))
+					return false;
+				if((length == CborUInt32LittleEndianTag || length == CborUInt32BigEndianTag) && value.kind == Value::Kind::String)
+				{
+					if(value.text.size() % 4 != 0)
+						return false;
+					value.kind = Value::Kind::UInt32Array;
+					value.bigEndian = length == CborUInt32BigEndianTag;
+				}
+				return true;
+			}
+
+			default:
+				return false;
+		}
+	}
+
+	bool BinaryJson::ReadMessagePackItems(Reader &reader, Value &value, uint64_t count, bool isObject, int depth)
+	{
+		value.kind = (isObject) ? Value::Kind::Object : Value::Kind::Array;
+		value.items.reserve(static_cast<size_t>(std::min<uint64_t>(count, 1024)));
+		if(isObject)
+			value.keys.reserve(value.items.capacity());
+
+		for(uint64_t i = 0; i < count; ++i)
+		{
+			if(!reader.hasMore())
+				return false;
+			if(isObject)
+			{
+				Value key;
+				if(!ReadMessagePack(reader, key, depth + 1) || key.kind != Value::Kind::String)
+					return false;
+				value.keys.push_back(key.text);
+			}
+			if(!ReadMessagePack(reader, value.items.emplace_back(), depth + 1))
+				return false;
+		}
+		return true;
+	}
+
+	bool BinaryJson::ReadMessagePack(Reader &reader, Value &value, int depth)
+	{
+		if(depth > MaxDepth)
+			return false;
+
+		uint8_t const type = reader.byte();
+		if(!reader.ok)
+			return false;
+
+		if(type <= 0x7f || type >= 0xe0)
+		{
+			value.kind = Value::Kind::Int;
+			value.integer = static_cast<int8_t>(type);
+			return true;
+		}
+		if(type <= 0x8f)
+			return ReadMessagePackItems(reader, value, type & 0x0f, true, depth);
+		if(type <= 0x9f)
+			return ReadMessagePackItems(reader, value, type & 0x0f, false, depth);
+		if(type <= 0xbf)
+		{
+			value.kind = Value::Kind::String;
+			value.text = reader.bytes(type & 0x1f);
+			return reader.ok;
+		}
+
+		switch(type)
+		{
+			case 0xc0: value.kind = Value::Kind::Null; return true;
+			case 0xc2: value.kind = Value::Kind::Bool; value.boolean = false; return true;
+			case 0xc3: value.kind = Value::Kind::Bool; value.boolean = true; return true;
+
+			//bin and str
+			case 0xc4:
+			case 0xc5:
+			case 0xc6:
+			case 0xd9:
+			case 0xda:
+			case 0xdb:
+			{
+				size_t const lengthBytes = size_t(1) << ((type >= 0xd9) ? type - 0xd9 : type - 0xc4);
+				value.kind = Value::Kind::String;
+				value.text = reader.bytes(reader.bigEndian(lengthBytes));
+				return reader.ok;
+			}
+
+			//ext and fixext
+			case 0xc7:
+			case 0xc8:
+			case 0xc9:
+			case 0xd4:
+			case 0xd5:
+			case 0xd6:
+			case 0xd7:
+			case 0xd8:
+			{
+				uint64_t const length = (type >= 0xd4) ? (uint64_t(1) << (type - 0xd4)) : reader.bigEndian(size_t(1) << (type - 0xc7));
+				auto const extType = static_cast<int8_t>(reader.byte());
+				std::string_view const data = reader.bytes(length);
+				if(!reader.ok)
+					return false;
+				if(extType == MessagePackUInt32Array)
+				{
+					if(data.size() % 4 != 0)
+						return false;
+					value.kind = Value::Kind::UInt32Array;
+					value.text = data;
+				}
+				else
+					value.kind = Value::Kind::Null;
+				return true;
+			}
+
+			case 0xca:
+			{
+				auto const bits = static_cast<uint32_t>(reader.bigEndian(4));
+				float number;
+				std::memcpy(&number, &bits, sizeof(number));
+				value.kind = Value::Kind::Double;
+				value.number = number;
+				return reader.ok;
+			}
+			case 0xcb:
+			{
+				uint64_t const bits = reader.bigEndian(8);
+				value.kind = Value::Kind::Double;
+				std::memcpy(&value.number, &bits, sizeof(value.number));
+				return reader.ok;
+			}
+
+			//uint 8 - 64
+			case 0xcc:
+			case 0xcd:
+			case 0xce:
+			case 0xcf:
+			{
+				uint64_t const number = reader.bigEndian(size_t(1) << (type - 0xcc));
+				if(number > static_cast<uint64_t>(INT64_MAX))
+				{
+					value.kind = Value::Kind::UInt;
+					value.unsignedInteger = number;
+				}
+				else
+				{
+					value.kind = Value::Kind::Int;
+					value.integer = static_cast<int64_t>(number);
+				}
+				return reader.ok;
+			}
+
+			//int 8 - 64
+			case 0xd0: value.kind = Value::Kind::Int; value.integer = static_cast<int8_t>(reader.bigEndian(1)); return reader.ok;
+			case 0xd1: value.kind = Value::Kind::Int; value.integer = static_cast<int16_t>(reader.bigEndian(2)); return reader.ok;
+			case 0xd2: value.kind = Value::Kind::Int; value.integer = static_cast<int32_t>(reader.bigEndian(4)); return reader.ok;
+			case 0xd3: value.kind = Value::Kind::Int; value.integer = static_cast<int64_t>(reader.bigEndian(8)); return reader.ok;
+
+			case 0xdc: return ReadMessagePackItems(reader, value, reader.bigEndian(2), false, depth);
+			case 0xdd: return ReadMessagePackItems(reader, value, reader.bigEndian(4), false, depth);
+			case 0xde: return ReadMessagePackItems(reader, value, reader.bigEndian(2), true, depth);
+			case 0xdf: return ReadMessagePackItems(reader, value, reader.bigEndian(4), true, depth);
+
+			default: return false;
+		}
+	}
+
+	double BinaryJson::HalfToDouble(uint16_t half)
+	{
+		int const exponent = (half >> 10) & 0x1f;
+		int const mantissa = half & 0x3ff;
+		double number;
+		if(exponent == 0)
+			number = std::ldexp(mantissa, -24);
+		else if(exponent != 31)
+			number = std::ldexp(mantissa + 1024, exponent - 25);
+		else
+			number = (mantissa == 0) ? INFINITY : NAN;
+		return (half & 0x8000) ? -number : number;
+	}
+
+	#ifdef JSON11_IS_DEFINED
+	/*!
+	 * Encodes json as CBOR or MessagePack. Numbers without decimals are stored as integers, and other numbers as
+	 * 32-bit floats when that is lossless. The tile 'data' arrays of layers and chunks are stored as typed arrays.
+	 */
+	std::vector<uint8_t> BinaryJson::FromJson(const json11::Json &json, Format format)
+	{
+		std::vector<uint8_t> out;
+		if(format == Format::Cbor)
+			WriteCbor(json, out, false);
+		else
+			WriteMessagePack(json, out, false);
+		return out;
+	}
+
+	/*!
+	 * Converts a Tiled json file (map, tileset, template...) to CBOR or MessagePack.
+	 * @return false if the json could not be read, or the output could not be written
+	 */
+	bool BinaryJson::ConvertJson(const fs::path &jsonPath, const fs::path &outputPath, Format format)
+	{
+		std::ifstream file(jsonPath, std::ios::binary);
+		if(!file.good())
+			return false;
+
+		std::string const content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		std::string error;
+		json11::Json const json = json11::Json::parse(content, error);
+		if(!error.empty())
+			return false;
+
+		std::vector<uint8_t> const data = FromJson(json, format);
+		std::ofstream output(outputPath, std::ios::binary);
+		output.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+		return output.good();
+	}
+
+	/*!
+	 * An array where every item is an integer that fits in 32 unsigned bits
+	 */
+	bool BinaryJson::IsTileData(const json11::Json &json)
+	{
+		if(!json.is_array())
+			return false;
+		for(const json11::Json &item : json.array_items())
+		{
+			double const number = item.number_value();
+			if(!item.is_number() || number < 0.0 || number > 4294967295.0 || std::floor(number) != number)
+				return false;
+		}
+		return true;
+	}
+
+	void BinaryJson::WriteBigEndian(uint64_t number, size_t bytes, std::vector<uint8_t> &out)
+	{
+		for(size_t i = bytes; i > 0; --i)
+			out.push_back(static_cast<uint8_t>(number >> ((i - 1) * 8)));
+	}
+
+	void BinaryJson::WriteCborHead(uint8_t majorType, uint64_t length, std::vector<uint8_t> &out)
+	{
+		auto const major = static_cast<uint8_t>(majorType << 5);
+		if(length < 24)
+			out.push_back(static_cast<uint8_t>(major | length));
+		else if(length <= 0xff)
+		{
+			out.push_back(major | 24);
+			WriteBigEndian(length, 1, out);
+		}
+		else if(length <= 0xffff)
+		{
+			out.push_back(major | 25);
+			WriteBigEndian(length, 2, out);
+		}
+		else if(length <= 0xffffffff)
+		{
+			out.push_back(major | 26);
+			WriteBigEndian(length, 4, out);
+		}
+		else
+		{
+			out.push_back(major | 27);
+			WriteBigEndian(length, 8, out);
+		}
+	}
+
+	void BinaryJson::WriteCbor(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData)
+	{
+		switch(json.type())
+		{
+			case json11::Json::NUL: out.push_back(0xf6); break;
+			case json11::Json::BOOL: out.push_back((json.bool_value()) ? 0xf5 : 0xf4); break;
+			case json11::Json::NUMBER:
+			{
+				double const number = json.number_value();
+				if(std::floor(number) == number && std::abs(number) < 9.2e18)
+				{
+					auto const integer = static_cast<int64_t>(number);
+					WriteCborHead((integer < 0) ? 1 : 0, static_cast<uint64_t>((integer < 0) ? -1 - integer : integer), out);
+				}
+				else if(static_cast<double>(static_cast<float>(number)) == number)
+				{
+					auto const single = static_cast<float>(number);
+					uint32_t bits;
+					std::memcpy(&bits, &single, sizeof(bits));
+					out.push_back(0xfa);
+					WriteBigEndian(bits, 4, out);
+				}
+				else
+				{
+					uint64_t bits;
+					std::memcpy(&bits, &number, sizeof(bits));
+					out.push_back(0xfb);
+					WriteBigEndian(bits, 8, out);
+				}
+				break;
+			}
+			case json11::Json::STRING:
+				WriteCborHead(3, json.string_value().size(), out);
+				out.insert(out.end(), json.string_value().begin(), json.string_value().end());
+				break;
+			case json11::Json::ARRAY:
+				if(isTileData && IsTileData(json))
+				{
+					WriteCborHead(6, CborUInt32LittleEndianTag, out);
+					WriteCborHead(2, json.array_items().size() * 4, out);
+					for(const json11::Json &item : json.array_items())
+					{
+						auto const gid = static_cast<uint32_t>(item.number_value());
+						for(int shift = 0; shift < 32; shift += 8)
+							out.push_back(static_cast<uint8_t>(gid >> shift));
+					}
+					break;
+				}
+				WriteCborHead(4, json.array_items().size(), out);
+				for(const json11::Json &item : json.array_items())
+					WriteCbor(item, out, false);
+				break;
+			case json11::Json::OBJECT:
+				WriteCborHead(5, json.object_items().size(), out);
+				for(const auto &[key, item] : json.object_items())
+				{
+					WriteCborHead(3, key.size(), out);
+					out.insert(out.end(), key.begin(), key.end());
+					WriteCbor(item, out, key == "data");
+				}
+				break;
+		}
+	}
+
+	/*!
+	 * Writes the type and length of a str, array or map. 'small' is the fix-type, used for lengths below 'smallLimit',
+	 * and 'head8' is the type using an 8-bit length, or 0 if there is none. The 16 and 32-bit types follow in the spec.
+	 */
+	void BinaryJson::WriteMessagePackHead(uint8_t small, uint8_t smallLimit, uint8_t head8, uint64_t length, std::vector<uint8_t> &out)
+	{
+		uint8_t const head16 = (head8 != 0) ? head8 + 1 : ((small == 0x90) ? 0xdc : 0xde);
+		if(length < smallLimit)
+			out.push_back(static_cast<uint8_t>(small | length));
+		else if(head8 != 0 && length <= 0xff)
+		{
+			out.push_back(head8);
+			WriteBigEndian(length, 1, out);
+		}
+		else if(length <= 0xffff)
+		{
+			out.push_back(head16);
+			WriteBigEndian(length, 2, out);
+		}
+		else
+		{
+			out.push_back(head16 + 1);
+			WriteBigEndian(length, 4, out);
+		}
+	}
+
+	void BinaryJson::WriteMessagePack(const json11::Json &json, std::vector<uint8_t> &out, bool isTileData)
+	{
+		switch(json.type())
+		{
+			case json11::Json::NUL: out.push_back(0xc0); break;
+			case json11::Json::BOOL: out.push_back((json.bool_value()) ? 0xc3 : 0xc2); break;
+			case json11::Json::NUMBER:
+			{
+				double const number = json.number_value();
+				if(std::floor(number) == number && std::abs(number) < 9.2e18)
+				{
+					auto const integer = static_cast<int64_t>(number);
+					if(integer >= -32 && integer <= 127)
+						out.push_back(static_cast<uint8_t>(integer));
+					else if(integer >= 0)
+					{
+						size_t const bytes = (integer <= 0xff) ? 1 : (integer <= 0xffff) ? 2 : (integer <= 0xffffffff) ? 4 : 8;
+						out.push_back(static_cast<uint8_t>((bytes == 1) ? 0xcc : (bytes == 2) ? 0xcd : (bytes == 4) ? 0xce : 0xcf));
+						WriteBigEndian(static_cast<uint64_t>(integer), bytes, out);
+					}
+					else
+					{
+						size_t const bytes = (integer >= INT8_MIN) ? 1 : (integer >= INT16_MIN) ? 2 : (integer >= INT32_MIN) ? 4 : 8;
+						out.push_back(static_cast<uint8_t>((bytes == 1) ? 0xd0 : (bytes == 2) ? 0xd1 : (bytes == 4) ? 0xd2 : 0xd3));
+						WriteBigEndian(static_cast<uint64_t>(integer), bytes, out);
+					}
+				}
+				else if(static_cast<double>(static_cast<float>(number)) == number)
+				{
+					auto const single = static_cast<float>(number);
+					uint32_t bits;
+					std::memcpy(&bits, &single, sizeof(bits));
+					out.push_back(0xca);
+					WriteBigEndian(bits, 4, out);
+				}
+				else
+				{
+					uint64_t bits;
+					std::memcpy(&bits, &number, sizeof(bits));
+					out.push_back(0xcb);
+					WriteBigEndian(bits, 8, out);
+				}
+				break;
+			}
+			case json11::Json::STRING:
+				WriteMessagePackHead(0xa0, 32, 0xd9, json.string_value().size(), out);
+				out.insert(out.end(), json.string_value().begin(), json.string_value().end());
+				break;
+			case json11::Json::ARRAY:
+				if(isTileData && IsTileData(json))
+				{
+					size_t const bytes = json.array_items().size() * 4;
+					if(bytes <= 0xff)
+					{
+						out.push_back(0xc7);
+						WriteBigEndian(bytes, 1, out);
+					}
+					else if(bytes <= 0xffff)
+					{
+						out.push_back(0xc8);
+						WriteBigEndian(bytes, 2, out);
+					}
+					else
+					{
+						out.push_back(0xc9);
+						WriteBigEndian(bytes, 4, out);
+					}
+					out.push_back(static_cast<uint8_t>(MessagePackUInt32Array));
+					for(const json11::Json &item : json.array_items())
+					{
+						auto const gid = static_cast<uint32_t>(item.number_value());
+						for(int shift = 0; shift < 32; shift += 8)
+							out.push_back(static_cast<uint8_t>(gid >> shift));
+					}
+					break;
+				}
+				WriteMessagePackHead(0x90, 16, 0, json.array_items().size(), out);
+				for(const json11::Json &item : json.array_items())
+					WriteMessagePack(item, out, false);
+				break;
+			case json11::Json::OBJECT:
+				WriteMessagePackHead(0x80, 16, 0, json.object_items().size(), out);
+				for(const auto &[key, item] : json.object_items())
+				{
+					WriteMessagePackHead(0xa0, 32, 0xd9, key.size(), out);
+					out.insert(out.end(), key.begin(), key.end());
+					WriteMessagePack(item, out, key == "data");
+				}
+				break;
+		}
+	}
+	#endif
+}
+
+#endif //TILESON_BINARYJSON_HPP
+
+/*** End of inlined file: BinaryJson.hpp ***/
+
+
+/*** Start of inlined file: Layer.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_LAYER_HPP
+#define TILESON_LAYER_HPP
+
+#include <set>
+#include <unordered_map>
+#include <functional>
+//#include "../external/json.hpp"
+
+
+/*** Start of inlined file: Chunk.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_CHUNK_HPP
+#define TILESON_CHUNK_HPP
+
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class Chunk
+	{
+		friend class MapSnapshot;
+		public:
+			inline Chunk() = default;
+			inline explicit Chunk(IJson &json);
+			inline bool parse(IJson &json);
+
+			[[nodiscard]] inline const std::vector<int> &getData() const;
+			[[nodiscard]] inline const std::string &getBase64Data() const;
+			[[nodiscard]] inline const Vector2i &getSize() const;
+			[[nodiscard]] inline const Vector2i &getPosition() const;
+
+		private:
+			std::vector<int> m_data;        /*! 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only. */
+			std::string      m_base64Data;  /*! 'data' (when string): Array of unsigned int (GIDs) or base64-encoded data. */
+			tson::Vector2i   m_size;        /*!  x='width' (in tiles) and y='height' (in tiles): */
+			tson::Vector2i   m_position;    /*! 'x' and 'y' position in tiles */
+	};
+}
+
+#endif //TILESON_CHUNK_HPP
+
+/*!
+ * Parses 'chunk' data from Tiled json and stores the values in this class
+ * @param json json-data
+ */
+tson::Chunk::Chunk(IJson &json)
+{
+	parse(json);
+}
+
+/*!
+ * Parses 'chunk' data from Tiled json and stores the values in this class
+ * @param json json-data
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Chunk::parse(IJson &json)
+{
+	bool allFound = true;
+
+	if(json.count("width") > 0 && json.count("height") > 0)
+		m_size = {json["width"].get<int>(), json["height"].get<int>()}; else allFound = false;
+	if(json.count("x") > 0 && json.count("y") > 0)
+		m_position = {json["x"].get<int>(), json["y"].get<int>()}; else allFound = false;
+
+	//Handle DATA (Optional)
+	if(json.count("data") > 0)
+	{
+		if(json["data"].isArray())
+		{
+			std::vector<uint32_t> data;
+			json.readArray("data", data);
+			m_data.assign(data.begin(), data.end());
+		}
+		else
+			m_base64Data = json["data"].get<std::string>();
+	}
+
+	return allFound;
+}
+
+/*!
+ * 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only.
+ * @return list of tile ids
+ */
+const std::vector<int> &tson::Chunk::getData() const
+{
+	return m_data;
+}
+
+/*!
+ * 'data' (when string): Array of unsigned int (GIDs) or base64-encoded data.
+ * @return base64 string
+ */
+const std::string &tson::Chunk::getBase64Data() const
+{
+	return m_base64Data;
+}
+
+/*!
+ * x='width' (in tiles) and y='height' (in tiles).
+ * @return Size (x and y), containing the values from the fields 'width' and 'height' in Tiled
+ */
+const tson::Vector2i &tson::Chunk::getSize() const
+{
+	return m_size;
+}
+
+/*!
+ * 'x' and 'y' position in tiles
+ * @return Position in int
+ */
+const tson::Vector2i &tson::Chunk::getPosition() const
+{
+	return m_position;
+}
+/*** End of inlined file: Chunk.hpp ***/
+
+
+/*** Start of inlined file: Object.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_OBJECT_HPP
+#define TILESON_OBJECT_HPP
+
+//#include "../external/json.hpp"
+
+
+/*** Start of inlined file: PropertyCollection.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_PROPERTYCOLLECTION_HPP
+#define TILESON_PROPERTYCOLLECTION_HPP
+
+
+/*** Start of inlined file: Property.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_PROPERTY_HPP
+#define TILESON_PROPERTY_HPP
+
+//#include "../../TilesonConfig.h"
+
+//#if USE_CPP17_FILESYSTEM
+
+#include <any>
+#include <string>
+
+/*** Start of inlined file: Enums.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_ENUMS_HPP
+#define TILESON_ENUMS_HPP
+#include <cstdint>
+
+/*** Start of inlined file: EnumBitflags.hpp ***/
+//
+// Created by robin on 08.11.2020.
+//
+
+#ifndef TILESON_ENUMBITFLAGS_HPP
+#define TILESON_ENUMBITFLAGS_HPP
+
+#include <type_traits>
+#include <iostream>
+
+#define TILESON_ENABLE_BITMASK_OPERATORS(x)  \
+namespace tson {                         \
+	ENABLE_BITMASK_OPERATORS(x) \
+}
+
+namespace tson
+{
+	#define ENABLE_BITMASK_OPERATORS(x)  \
+	template<>                           \
+	struct EnableBitMaskOperators<x>     \
+	{                                    \
+		static const bool enable = true; \
+	};
+
+	template<typename Enum>
+	struct EnableBitMaskOperators
+	{
+		static const bool enable = false;
+	};
+
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	operator |(Enum lhs, Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		return static_cast<Enum> (
+				static_cast<underlying>(lhs) |
+				static_cast<underlying>(rhs)
+		);
+	}
+
+	//Permissions operator &(Permissions lhs, Permissions rhs)
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	operator &(Enum lhs, Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		return static_cast<Enum> (
+				static_cast<underlying>(lhs) &
+				static_cast<underlying>(rhs)
+		);
+	}
+
+	//Permissions operator ^(Permissions lhs, Permissions rhs)
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	operator ^(Enum lhs, Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		return static_cast<Enum> (
+				static_cast<underlying>(lhs) ^
+				static_cast<underlying>(rhs)
+		);
+	}
+
+	//Permissions operator ~(Permissions rhs)
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	operator ~(Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		return static_cast<Enum> (
+				~static_cast<underlying>(rhs)
+		);
+	}
+
+	//Permissions& operator |=(Permissions &lhs, Permissions rhs)
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	&operator |=(Enum &lhs, Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		lhs = static_cast<Enum> (
+				static_cast<underlying>(lhs) |
+				static_cast<underlying>(rhs)
+		);
+
+		return lhs;
+	}
+
+	//Permissions& operator &=(Permissions &lhs, Permissions rhs)
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	&operator &=(Enum &lhs, Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		lhs = static_cast<Enum> (
+				static_cast<underlying>(lhs) &
+				static_cast<underlying>(rhs)
+		);
+
+		return lhs;
+	}
+
+	//Permissions& operator ^=(Permissions &lhs, Permissions rhs)
+	template<typename Enum>
+	typename std::enable_if<EnableBitMaskOperators<Enum>::enable, Enum>::type
+	&operator ^=(Enum &lhs, Enum rhs)
+	{
+		static_assert(std::is_enum<Enum>::value,
+					  "template parameter is not an enum type");
+
+		using underlying = typename std::underlying_type<Enum>::type;
+
+		lhs = static_cast<Enum> (
+				static_cast<underlying>(lhs) ^
+				static_cast<underlying>(rhs)
+		);
+
+		return lhs;
+	}
+}
+
+#endif //TILESON_ENUMBITFLAGS_HPP
+
+/*** End of inlined file: EnumBitflags.hpp ***/
+
+
+namespace tson
+{
+	/*!
+	 * Type used in Property.hpp
+	 */
+	enum class Type : uint8_t
+	{
+			Undefined = 0,
+			Color = 1, /*! color */
+			File = 2, /*! file */
+			Int = 3, /*! int */
+			Boolean = 4, /*! bool */
+			Float = 5, /*! float */
+			String = 6, /*! string */
+			Class = 7, /*! class */
+			Enum = 8,  /*! 'string' or 'int' with a value in 'propertyType' */
+			Object = 9 /*! object */
+	};
+
+	/*!
+	 * Layer.hpp - LayerType
+	 * //'type': tilelayer, objectgroup, imagelayer or group
+	 */
+	enum class LayerType : uint8_t
+	{
+			Undefined = 0,
+			TileLayer = 1,
+			ObjectGroup = 2,
+			ImageLayer = 3,
+			Group = 4
+	};
+
+	/*!
+	 * Tileset.hpp - TilesetType
+	 * //'type': imagetileset, imagecollectiontileset
+	 */
+	enum class TilesetType : uint8_t
+	{
+		Undefined = 0,
+		ImageTileset = 1,
+		ImageCollectionTileset = 2
+	};
+
+	/*!
+	 * Map.hpp - ParseStatus
+	 */
+	enum class ParseStatus : uint8_t
+	{
+			OK = 0, //OK unless otherwise stated
+			FileNotFound = 1,
+			ParseError = 2,
+			MissingData = 3,
+			DecompressionError = 4
+	};
+
+	/*!
+	 * Object.hpp - ObjectType
+	 */
+	enum class ObjectType : uint8_t
+	{
+			Undefined = 0,
+			Object = 1,
+			Ellipse = 2,
+			Rectangle = 3,
+			Point = 4,
+			Polygon = 5,
+			Polyline = 6,
+			Text = 7,
+			Template = 8
+	};
+
+	static constexpr uint32_t FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
+	static constexpr uint32_t FLIPPED_VERTICALLY_FLAG   = 0x40000000;
+	static constexpr uint32_t FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
+	/*!
+	 * Object.hpp - ObjectFlipFlags
+	 */
+	enum class TileFlipFlags : uint32_t
+	{
+			None = 0,
+			Diagonally = FLIPPED_DIAGONALLY_FLAG,
+			Vertically = FLIPPED_VERTICALLY_FLAG,
+			Horizontally = FLIPPED_HORIZONTALLY_FLAG
+	};
+
+	/*!
+	 * Tileset.hpp - ObjectAlignment
+	 */
+	enum class ObjectAlignment : uint8_t
+	{
+			Unspecified = 0,    //unspecified
+			TopLeft = 1,        //topleft
+			Top = 2,            //top
+			TopRight = 3,       //topright
+			Left = 4,           //left
+			Center = 5,         //center
+			Right = 6,          //right
+			BottomLeft = 7,     //bottomleft
+			Bottom = 8,         //bottom
+			BottomRight = 9     //bottomright
+	};
+
+	/*!
+	 * Text.hpp - TextAlignment
+	 */
+	enum class TextAlignment : uint8_t
+	{
+		Unresolved = 0,
+		Left = 1,           //left
+		Center = 2,         //center
+		Right = 3,          //right
+		Justify = 4,        //justify
+		Top = 5,            //top
+		Bottom = 6          //bottom
+	};
+
+	/*!
+	 * Tileset.hpp - TileRenderSize - From Tiled v1.9
+	 */
+	enum class TileRenderSize : uint8_t
+	{
+		Undefined = 0,
+		Tile = 1,  //tile (default)
+		Grid = 2   //grid
+	};
+
+	/*!
+	 * Tileset.hpp - FillMode - From Tiled v1.9
+	 */
+	enum class FillMode : uint8_t
+	{
+		Undefined = 0,
+		Stretch = 1,            //stretch (default)
+		PreserveAspectFit = 2   //preserve-aspect-fit
+	};
+
+	enum class EnumStorageType : uint8_t
+	{
+		Unspecified = 0,
+		Int = 1,
+		String = 2
+	};
+
+	/*!
+	 * NavigationGrid.hpp - NavigationTopology
+	 */
+	enum class NavigationTopology : uint8_t
+	{
+		Orthogonal = 0,     //orthogonal and isometric maps
+		Staggered = 1,      //staggered (isometric) maps
+		Hexagonal = 2       //hexagonal maps
+	};
+
+	/*!
+	 * MapSnapshot.hpp - SnapshotMode - How tson::Tileson uses .tsonb snapshots next to the maps it parses
+	 */
+	enum class SnapshotMode : uint8_t
+	{
+		Disabled = 0,       //Always parse the json (default)
+		Read = 1,           //Load a snapshot instead of the json when it is up to date
+		ReadWrite = 2       //Like Read, and write a new snapshot when the json had to be parsed
+	};
+
+	ENABLE_BITMASK_OPERATORS(TileFlipFlags)
+}
+
+#endif //TILESON_ENUMS_HPP
+
+/*** End of inlined file: Enums.hpp ***/
+
+
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class Project;
+
+	class Property
+	{
+		friend class MapSnapshot;
+		public:
+			inline Property();
+			inline explicit Property(IJson &json, tson::Project *project = nullptr);
+			inline Property(std::string name, std::any value, Type type);
+
+			inline void setValue(const std::any &value);
+			inline void setStrValue(const std::string &value);
+			inline void setName(const std::string &name);
+
+			[[nodiscard]] inline const std::type_info& getValueType() const;
+			inline std::string getValueTypeInfo();
+			[[nodiscard]]inline const std::any &getValue() const;
+			template <typename T>
+			inline T getValue() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline Type getType() const;
+			[[nodiscard]] inline const std::string &getPropertyType() const;
+
+			//Became public in v1.4.0
+			inline void setValueByType(IJson &json); //Definition in tileson_forward.hpp
+
+		protected:
+			inline void setTypeByString(const std::string &str);
+
+			tson::Project *m_project = nullptr; //Used for resolving 'enum' and 'class' objects
+			Type m_type = Type::Undefined;
+			std::string m_name {};
+			std::string m_propertyType {};
+			std::any m_value; //Using std::any to assign any type
+	};
+
+	template<typename T>
+	T Property::getValue() const
+	{
+		bool isCorrectType = (m_value.type() == typeid(T));
+
+		if(isCorrectType)
+		{
+			T value = std::any_cast<T>(m_value);
+			return value;
+		}
+		else
+		{
+			static T defaultValue;
+			return defaultValue;
+		}
+	}
+}
+
+tson::Property::Property() : m_name {"unnamed"}
+{
+
+}
+
+tson::Property::Property(IJson &json, tson::Project *project) : m_project {project}
+{
+	m_name = json["name"].get<std::string>();
+	if(json.count("propertytype") > 0)
+		m_propertyType = json["propertytype"].get<std::string>();
+	else if(json.count("propertyType") > 0) //Somehow Tiled's class objects uses propertyType with 'T'.
+		m_propertyType = json["propertyType"].get<std::string>();
+
+	setTypeByString(json["type"].get<std::string>());
+	setValueByType(json["value"]);
+}
+
+tson::Property::Property(std::string name, std::any value, Type type) : m_type {type}, m_name { std::move(name) }, m_value { std::move(value) }
+{
+
+}
+
+void tson::Property::setValue(const std::any &value)
+{
+	m_value = value;
+}
+
+/*!
+ * Sets the value specifically as string.
+ * When not specified as std::string, the default is that the value will be set as char * when adding a value like "test"
+ * This function is to make sure the value is added as string.
+ * @param value
+ */
+void tson::Property::setStrValue(const std::string &value)
+{
+	m_value = value;
+}
+
+const std::any &tson::Property::getValue() const
+{
+	return m_value;
+}
+
+void tson::Property::setName(const std::string &name)
+{
+	m_name = name;
+}
+
+const std::string &tson::Property::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * Gets the value type as std::value_info.
+ * This can easily be compared to types like this:
+ * Check if int: getValueType() == typeid(int)
+ * @return
+ */
+
+const std::type_info &tson::Property::getValueType() const
+{
+	return m_value.type();
+}
+
+/*!
+ * Gets the value type as std::string
+ * Examples of known types:
+ * "i" = int
+ * "f" = float
+ * "b" = bool
+ * @return
+ */
+std::string tson::Property::getValueTypeInfo()
+{
+	return m_value.type().name();
+}
+
+tson::Type tson::Property::getType() const
+{
+	return m_type;
+}
+
+void tson::Property::setTypeByString(const std::string &str)
+{
+	if(str == "color")
+		m_type = tson::Type::Color;
+	else if(str == "file")
+		m_type = tson::Type::File;
+	else if(str == "int")
+		m_type = tson::Type::Int;
+	else if(str == "bool")
+		m_type = tson::Type::Boolean;
+	else if(str == "float")
+		m_type = tson::Type::Float;
+	else if(str == "string")
+		m_type = tson::Type::String;
+	else if(str == "class")
+		m_type = tson::Type::Class;
+	else if(str == "object")
+		m_type = tson::Type::Object;
+	else
+		m_type = tson::Type::Undefined;
+}
+
+const std::string &tson::Property::getPropertyType() const
+{
+	return m_propertyType;
+}
+
+#endif //TILESON_PROPERTY_HPP
+
+/*** End of inlined file: Property.hpp ***/
+
+//#include "../external/json.hpp"
+#include <map>
+
+namespace tson
+{
+	class PropertyCollection
+	{
+		friend class MapSnapshot;
+		public:
+			inline PropertyCollection() = default;
+
+			inline explicit PropertyCollection(std::string id);
+
+			inline tson::Property * add(const tson::Property &property);
+			inline tson::Property * add(IJson &json, tson::Project *project = nullptr);
+			inline tson::Property * add(const std::string &name, const std::any &value, tson::Type type);
+
+			inline void remove(const std::string &name);
+
+			inline void setValue(const std::string &name, const std::any &value);
+			inline void setProperty(const std::string &name, const tson::Property &value);
+			inline void setId(const std::string &id);
+
+			inline bool hasProperty(const std::string &name);
+			inline tson::Property * getProperty(const std::string &name);
+			inline std::map<std::string, Property> &getProperties();
+			inline std::vector<Property*> get();
+			template <typename T>
+			inline T getValue(const std::string &name);
+			[[nodiscard]] inline const std::string &getId() const;
+			[[nodiscard]] inline size_t getSize() const;
+
+		protected:
+			std::string m_id;
+			std::map<std::string, tson::Property> m_properties;
+	};
+}
+
+template<typename T>
+T tson::PropertyCollection::getValue(const std::string &name)
+{
+	static T defaultT;
+	return (m_properties.count(name) > 0) ? m_properties[name].getValue<T>() : defaultT;
+}
+
+tson::PropertyCollection::PropertyCollection(std::string id) : m_id {std::move(id)}
+{
+
+}
+
+tson::Property *tson::PropertyCollection::add(const tson::Property &property)
+{
+	m_properties[property.getName()] = property;
+	return &m_properties[property.getName()];
+}
+
+tson::Property *tson::PropertyCollection::add(IJson &json, tson::Project *project)
+{
+	tson::Property property = tson::Property(json, project);
+	const std::string name = property.getName();
+	m_properties[name] = std::move(property);
+	return &m_properties[name];
+}
+
+tson::Property *tson::PropertyCollection::add(const std::string &name, const std::any &value, tson::Type type)
+{
+	m_properties[name] = {name, value, type};
+	return &m_properties[name];
+}
+
+void tson::PropertyCollection::remove(const std::string &name)
+{
+	m_properties.erase(name);
+}
+
+/*!
+ * Sets a value IF the property already exists. Does nothing otherwise.
+ * See add() for adding new properties
+ * @param name
+ * @param value
+ */
+void tson::PropertyCollection::setValue(const std::string &name, const std::any &value)
+{
+	if(m_properties.count(name) > 0)
+		m_properties[name].setValue(value);
+}
+
+/*!
+ * Overwrites the current property if it exists, or adds it if it doesn't.
+ * @param name
+ * @param value
+ */
+void tson::PropertyCollection::setProperty(const std::string &name, const tson::Property &value)
+{
+	m_properties[name] = value;
+}
+
+void tson::PropertyCollection::setId(const std::string &id)
+{
+	m_id = id;
+}
+
+bool tson::PropertyCollection::hasProperty(const std::string &name)
+{
+	return m_properties.count(name) > 0;
+}
+
+tson::Property *tson::PropertyCollection::getProperty(const std::string &name)
+{
+	return (m_properties.count(name) > 0) ? &m_properties[name] : nullptr;
+}
+
+std::map<std::string, tson::Property> &tson::PropertyCollection::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * Gets vector of pointers to all the existing properties
+ * @return
+ */
+std::vector<tson::Property *> tson::PropertyCollection::get()
+{
+	std::vector<tson::Property *> props;
+	for(auto &i : m_properties)
+		props.emplace_back(&i.second);
+
+	return props;
+}
+
+const std::string &tson::PropertyCollection::getId() const
+{
+	return m_id;
+}
+
+size_t tson::PropertyCollection::getSize() const
+{
+	return m_properties.size();
+}
+
+#endif //TILESON_PROPERTYCOLLECTION_HPP
+
+/*** End of inlined file: PropertyCollection.hpp ***/
+
+
+/*** Start of inlined file: Text.hpp ***/
+//
+// Created by robin on 05.08.2019.
+//
+
+#ifndef TILESON_TEXT_HPP
+#define TILESON_TEXT_HPP
+
+#include <string>
+
+namespace tson
+{
+	class Text
+	{
+		public:
+			inline Text() = default;
+			/*!
+			 *
+			 * @param _text Text
+			 * @param _wrap If the text is marked as wrapped
+			 */
+			//inline Text(std::string _text, bool _wrap, tson::Colori _color) : text {std::move(_text)}, wrap {_wrap}, color {_color} {};
+			inline explicit Text(IJson &json)
+			{
+				bool hasColor = json.count("color") > 0;
+				tson::Color c = (hasColor) ? tson::Colori(json["color"].get<std::string>()) : tson::Colori();
+				color = c;
+				text = (json.count("text") > 0) ? json["text"].get<std::string>() : "";
+				wrap = (json.count("wrap") > 0) ? json["wrap"].get<bool>() : false;
+
+				//Previously missing properties
+				bold = (json.count("bold") > 0) ? json["bold"].get<bool>() : false;
+				fontFamily = (json.count("fontfamily") > 0) ? json["fontfamily"].get<std::string>() : "sans-serif";
+				horizontalAlignment = (json.count("halign") > 0) ? resolveTextAlignmentByString(json["halign"].get<std::string>()) : TextAlignment::Left;
+				italic = (json.count("italic") > 0) ? json["italic"].get<bool>() : false;
+				kerning = (json.count("kerning") > 0) ? json["kerning"].get<bool>() : true;
+				pixelSize = (json.count("pixelsize") > 0) ? json["pixelsize"].get<int32_t>() : 16;
+				strikeout = (json.count("strikeout") > 0) ? json["strikeout"].get<bool>() : false;
+				underline = (json.count("underline") > 0) ? json["underline"].get<bool>() : false;
+				verticalAlignment = (json.count("valign") > 0) ? resolveTextAlignmentByString(json["valign"].get<std::string>()) : TextAlignment::Top;
+			};
+
+			//Just make it simple
+			std::string text {};
+			tson::Colori color {};
+			bool wrap{};
+
+			//Previously missing properties
+			bool bold {false};
+			std::string fontFamily {"sans-serif"};
+			TextAlignment horizontalAlignment {TextAlignment::Left};
+			bool italic {false};
+			bool kerning {true};
+			int pixelSize {16};
+			bool strikeout {false};
+			bool underline {false};
+			TextAlignment verticalAlignment {TextAlignment::Top};
+
+		private:
+			[[nodiscard]] TextAlignment resolveTextAlignmentByString(const std::string &str) const
+			{
+				if(str == "left") return TextAlignment::Left;
+				if(str == "center") return TextAlignment::Center;
+				if(str == "right") return TextAlignment::Right;
+				if(str == "justify") return TextAlignment::Justify;
+				if(str == "top") return TextAlignment::Top;
+				if(str == "bottom") return TextAlignment::Bottom;
+
+				return TextAlignment::Unresolved;
+			}
+	};
+}
+
+#endif //TILESON_TEXT_HPP
+
+/*** End of inlined file: Text.hpp ***/
+
+#include <optional>
+#include <functional>
+
+namespace tson
+{
+	class TiledClass;
+	class Map;
+	class ObjectTemplate;
+	class Object
+	{
+		friend class Tileset;
+		friend class ObjectTemplate;
+		friend class MapSnapshot;
+		public:
+			//enum class Type : uint8_t
+			//{
+			//        Undefined = 0,
+			//        Object = 1,
+			//        Ellipse = 2,
+			//        Rectangle = 3,
+			//        Point = 4,
+			//        Polygon = 5,
+			//        Polyline = 6,
+			//        Text = 7,
+			//        Template = 8
+			//};
+
+			inline Object() = default;
+			inline explicit Object(IJson &json, tson::Map *map);
+			inline bool parse(IJson &json, tson::Map *map);
+
+			[[nodiscard]] inline ObjectType getObjectType() const;
+			[[nodiscard]] inline bool isEllipse() const;
+			[[nodiscard]] inline uint32_t getGid() const;
+			[[nodiscard]] inline const Vector2i &getSize() const;
+			[[nodiscard]] inline int getId() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline bool isPoint() const;
+			[[nodiscard]] inline float getRotation() const;
+			[[nodiscard]] inline const std::string &getTemplate() const;
+			[[nodiscard]] inline const std::string &getType() const;
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			[[nodiscard]] inline bool isVisible() const;
+			[[nodiscard]] inline const Vector2i &getPosition() const;
+
+			[[nodiscard]] inline const std::vector<tson::Vector2i> &getPolygons() const;
+			[[nodiscard]] inline const std::vector<tson::Vector2i> &getPolylines() const;
+			[[nodiscard]] inline PropertyCollection &getProperties();
+			[[nodiscard]] inline const Text &getText() const;
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			//v1.2.0-stuff
+			[[nodiscard]] inline TileFlipFlags getFlipFlags() const;
+			inline bool hasFlipFlags(TileFlipFlags flags);
+
+		private:
+			inline void setObjectTypeByJson(IJson &json, IJson* templ);
+			inline void setObjectType(const std::function<bool(const std::string &)> &hasField, bool isTemplateInstance);
+			inline bool parseInstance(IJson &json, const tson::ObjectTemplate &objectTemplate); /*! Declared in tileson_forward.hpp */
+
+			ObjectType                        m_objectType = ObjectType::Undefined;    /*! Says with object type this is */
+			bool                              m_ellipse {};                            /*! 'ellipse': Used to mark an object as an ellipse */
+			uint32_t                          m_gid {};                                /*! 'gid': GID, only if object comes from a Tilemap */
+			tson::Vector2i                    m_size;                                  /*! x = 'width' (Width in pixels), y = 'height' (Height in pixels). Ignored if using a gid.)*/
+			int                               m_id{};                                  /*! 'id': Incremental id - unique across all objects */
+			std::string                       m_name;                                  /*! 'name':  String assigned to name field in editor*/
+			bool                              m_point {};                              /*! 'point': Used to mark an object as a point */
+			std::vector<tson::Vector2i>       m_polygon; 	                           /*! 'polygon': A list of x,y coordinates in pixels */
+			std::vector<tson::Vector2i>       m_polyline; 	                           /*! 'polyline': A list of x,y coordinates in pixels */
+			tson::PropertyCollection          m_properties; 	                       /*! 'properties': A list of properties (name, value, type). */
+			float                             m_rotation {};                           /*! 'rotation': Angle in degrees clockwise */
+			std::string                       m_template;                              /*! 'template': Reference to a template file, in case object is a template instance */
+			tson::Text                        m_text; 	                               /*! first: 'text' second: 'wrap' */
+			std::string                       m_type;                                  /*! 'type': String assigned to type field in editor */
+			bool                              m_visible {};                            /*! 'visible': Whether object is shown in editor. */
+			tson::Vector2i                    m_position;                              /*! 'x' and 'y': coordinate in pixels */
+
+			//v1.2.0-stuff
+			tson::TileFlipFlags               m_flipFlags = TileFlipFlags::None;       /*! Resolved using bit 32, 31 and 30 from gid */
+
+			tson::Map *m_map {nullptr};
+			std::shared_ptr<tson::TiledClass> m_class {};
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T tson::Object::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+
+	/*!
+	* Returns the requested IJson object if it exists in the map file or in a related template file
+	* @param fieldName The name of the field to check
+	* @param main The main json file being parsed
+	* @param templ The template file json, if present, nullptr otherwise.
+	* @return the requested json object if found in the main json file, otherwise if it is found in the template and nullptr if not found anywhere
+	*/
+	inline IJson* readField(const std::string& fieldName,  IJson& main, IJson* templ = nullptr);
+
+	/*!
+	* Attempts to read a text field from main file or the template if not overriden
+	* @param fieldName The name of the field to check
+	* @param main The main json file being parsed
+	* @param templ The template file json, if present, nullptr otherwise.
+	* @return true if the field was found and parsed in any of the objects, false otherwise
+	*/
+   inline bool readField(Text& field, const std::string& fieldName,  IJson& main, IJson* templ = nullptr);
+
+	/*!
+	* Attempts to read a series of coordinates from main file or the template if not overriden
+	* @param fieldName The name of the field to check
+	* @param main The main json file being parsed
+	* @param templ The template file json, if present, nullptr otherwise.
+	* @return true if the field was found and parsed in any of the objects, false otherwise
+	*/
+	inline bool readField(std::vector<Vector2i>& field, const std::string& fieldName, IJson& main, IJson* templ = nullptr);
+
+	/*!
+	* Attempts to read a field from main file or the template if not overriden
+	* @param fieldName The name of the field to check
+	* @param main The main json file being parsed
+	* @param templ The template file json, if present, nullptr otherwise.
+	* @return true if the field was found and parsed in any of the objects, false otherwise
+	*/
+	template <typename T> bool readField(T& field, const std::string& fieldName,  IJson& main, IJson* templ = nullptr)
+	{
+		IJson* fieldJson = readField(fieldName, main, templ);
+		if(fieldJson){
+			field = fieldJson->get<T>();
+			return true;
+		}
+		return false;
+	}
+
+	/*!
+	* Attempts to read a vector from main file or the template if not overriden
+	* @param field Target variable to fill
+	* @param fieldNameX The name of the field to check for the x part of the vector
+	* @param fieldNameY The name of the field to check for the y part of the vector
+	* @param main The main json file being parsed
+	* @param templ The template file json, if present, nullptr otherwise.
+	* @return true if the field was found and parsed in any of the objects, false otherwise
+	*/
+	inline bool readVector(Vector2i& field, const std::string& fieldNameX, const std::string& fieldNameY, IJson& main, IJson* templ = nullptr);
+
+	/*!
+	* Reads all custom properties from the given json node
+	* @param properties Target Properties collection to fill
+	* @param json json node representing the map object
+	* @param map Pointer to current map being parsed
+	*/
+	inline void readProperties(tson::PropertyCollection& properties, IJson& json, tson::Map* map);
+
+	/*!
+	* Reads a gid, parsing flip-flags
+	* @param properties Target Properties collection to fill
+	* @param json json node representing the map object
+	* @param map Pointer to current map being parsed
+	*/
+	inline void readGid(uint32_t& gid, TileFlipFlags& flags, IJson& main, IJson* templ = nullptr);
+}
+
+/*!
+ * Parses a json Tiled object
+ * @param json
+ */
+tson::Object::Object(IJson &json, tson::Map *map)
+{
+	parse(json, map);
+}
+
+/*!
+ * Sets an object type based on json data.
+ * @param json
+ */
+void tson::Object::setObjectTypeByJson(IJson &json, IJson* templ)
+{
+	setObjectType([&](const std::string &name) { return readField(name, json, templ) != nullptr; }, json.count("template") > 0);
+}
+
+/*!
+ * Sets the object type from the fields the object has
+ * @param hasField true if the object, or its template, has a field
+ * @param isTemplateInstance true if the object has a 'template'
+ */
+void tson::Object::setObjectType(const std::function<bool(const std::string &)> &hasField, bool isTemplateInstance)
+{
+	m_objectType = ObjectType::Undefined;
+	if(m_ellipse)
+		m_objectType = ObjectType::Ellipse;
+	else if(m_point)
+		m_objectType = ObjectType::Point;
+	else if(hasField("polygon"))
+		m_objectType = ObjectType::Polygon;
+	else if(hasField("polyline"))
+		m_objectType = ObjectType::Polyline;
+	else if(hasField("text"))
+		m_objectType = ObjectType::Text;
+	else if(hasField("gid"))
+		m_objectType = ObjectType::Object;
+	else if(isTemplateInstance)
+		m_objectType = ObjectType::Template;
+	else
+		m_objectType = ObjectType::Rectangle;
+}
+
+/*!
+ * Gets what type of object this is.
+ * @return
+ */
+
+tson::ObjectType tson::Object::getObjectType() const
+{
+	return m_objectType;
+}
+
+/*!
+ * 'ellipse': Used to mark an object as an ellipse
+ * @return
+ */
+bool tson::Object::isEllipse() const
+{
+	return m_ellipse;
+}
+
+/*!
+ * 'gid': GID, only if object comes from a Tilemap
+ * @return
+ */
+uint32_t tson::Object::getGid() const
+{
+	return m_gid;
+}
+
+/*!
+ * x = 'width' (Width in pixels), y = 'height' (Height in pixels). Ignored if using a gid.)
+ * @return
+ */
+const tson::Vector2i &tson::Object::getSize() const
+{
+	return m_size;
+}
+
+/*!
+ * 'id': Incremental id - unique across all objects
+ * @return
+ */
+int tson::Object::getId() const
+{
+	return m_id;
+}
+
+/*!
+ * 'name': String assigned to name field in editor
+ * @return
+ */
+const std::string &tson::Object::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * 'point': Used to mark an object as a point
+ * @return true if the object is of type point
+ */
+bool tson::Object::isPoint() const
+{
+	return m_point;
+}
+
+/*!
+ * 'rotation': Angle in degrees clockwise
+ * @return
+ */
+float tson::Object::getRotation() const
+{
+	return m_rotation;
+}
+
+/*!
+ * 'template': Reference to a template file, in case object is a template instance
+ * @return
+ */
+const std::string &tson::Object::getTemplate() const
+{
+	return m_template;
+}
+
+/*!
+ * 'type': String assigned to type field in editor
+ * This was renamed to 'class' in Tiled v1.9
+ * @return
+ */
+const std::string &tson::Object::getType() const
+{
+	return m_type;
+}
+
+/*!
+ * 'class': String assigned to class field in editor
+ * This was renamed from 'type' to 'class' in Tiled v1.9
+ * @return
+ */
+const std::string &tson::Object::getClassType() const
+{
+	return m_type;
+}
+
+/*!
+ * 'visible': Whether object is shown in editor.
+ * @return
+ */
+bool tson::Object::isVisible() const
+{
+	return m_visible;
+}
+
+/*!
+ * 'x' and 'y': coordinate in pixels
+ * @return
+ */
+const tson::Vector2i &tson::Object::getPosition() const
+{
+	return m_position;
+}
+
+/*!
+ * 'polygon': A list of x,y coordinates in pixels.
+ * If this is a Polygon type, this function will return the points used to create it
+ * @return
+ */
+const std::vector<tson::Vector2i> &tson::Object::getPolygons() const
+{
+	return m_polygon;
+}
+
+/*!
+ * 'polyline': A list of x,y coordinates in pixels
+ * If this is a Polyline type, this function will return the points used to create it
+ * @return
+ */
+const std::vector<tson::Vector2i> &tson::Object::getPolylines() const
+{
+	return m_polyline;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::Object::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * 'type': String assigned to type field in editor
+ * @return
+ */
+const tson::Text &tson::Object::getText() const
+{
+	return m_text;
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::Object::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+	return nullptr;
+}
+
+/*!
+ * Get all flip flags
+ * @return
+ */
+tson::TileFlipFlags tson::Object::getFlipFlags() const
+{
+	return m_flipFlags;
+}
+
+/*!
+ *
+ * @param flags Which flags to check for. Several flags can be checked at once using the bitwise or operator.
+ * Example:
+ * hasFlipFlags(TileFlipFlags::Vertically | TileFlipFlags::Horizontally)
+ *
+ * @return true if the flag(s) specified are set
+ */
+bool tson::Object::hasFlipFlags(TileFlipFlags flags)
+{
+	return ((m_flipFlags & flags) == flags) ? true : false;
+}
+
+#endif //TILESON_OBJECT_HPP
+
+/*** End of inlined file: Object.hpp ***/
+
+
+/*** Start of inlined file: SpatialIndex.hpp ***/
+#ifndef TILESON_SPATIALINDEX_HPP
+#define TILESON_SPATIALINDEX_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace tson
+{
+	/*!
+	 * A uniform grid over the bounding boxes of the objects in an object layer.
+	 * Each object is stored in every cell its bounding box touches, and the queries return the indices of
+	 * the objects (in the order of Layer::getObjects()) whose bounding box intersects the query shape.
+	 *
+	 * The bounds take position, size, rotation and polygon/polyline points into account.
+	 * Tile objects (objects with a gid) are anchored at their bottom-left corner, like in Tiled.
+	 *
+	 * All queries are const and do not allocate when the output vector has enough capacity,
+	 * so one index may be queried from several threads at once.
+	 */
+	class SpatialIndex
+	{
+		public:
+			inline SpatialIndex() = default;
+			inline explicit SpatialIndex(const std::vector<tson::Object> &objects, float cellSize = 0.f);
+			inline void build(const std::vector<tson::Object> &objects, float cellSize = 0.f);
+			inline void clear();
+
+			inline size_t queryRect(float x, float y, float width, float height, std::vector<size_t> &out) const;
+			inline size_t queryPoint(float x, float y, std::vector<size_t> &out) const;
+			inline size_t queryRadius(float x, float y, float radius, std::vector<size_t> &out) const;
+
+			[[nodiscard]] inline bool empty() const;
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline float getCellSize() const;
+			[[nodiscard]] inline const Vector2i &getGridSize() const;
+
+			inline static void CalculateBounds(const tson::Object &obj, float &minX, float &minY, float &maxX, float &maxY);
+
+		private:
+			template <typename Func>
+			inline size_t forEachCandidate(float minX, float minY, float maxX, float maxY, Func &&func) const;
+			[[nodiscard]] inline int cellX(float x) const;
+			[[nodiscard]] inline int cellY(float y) const;
+
+			float                 m_cellSize {};
+			tson::Vector2f        m_origin;            /*! Top-left corner of the grid in pixels */
+			tson::Vector2i        m_gridSize;          /*! Number of columns and rows */
+
+			//Bounds of every object, stored as separate arrays to keep the tests in the queries tight
+			std::vector<float>    m_minX;
+			std::vector<float>    m_minY;
+			std::vector<float>    m_maxX;
+			std::vector<float>    m_maxY;
+
+			std::vector<uint32_t> m_cellStart;         /*! Offset into m_cellItems for each cell. Has one extra element at the end */
+			std::vector<uint32_t> m_cellItems;         /*! Object indices, grouped by cell */
+	};
+
+	SpatialIndex::SpatialIndex(const std::vector<tson::Object> &objects, float cellSize)
+	{
+		build(objects, cellSize);
+	}
+
+	/*!
+	 * Calculates the axis aligned bounding box of an object in pixels.
+	 * Rotation is done clockwise around the position of the object, as in Tiled.
+	 */
+	void SpatialIndex::CalculateBounds(const tson::Object &obj, float &minX, float &minY, float &maxX, float &maxY)
+	{
+		const tson::Vector2i &pos = obj.getPosition();
+		const tson::Vector2i &size = obj.getSize();
+
+		float const radians = obj.getRotation() * 3.14159265358979323846f / 180.f;
+		float const cosR = std::cos(radians);
+		float const sinR = std::sin(radians);
+		bool const rotated = obj.getRotation() != 0.f;
+
+		minX = minY = std::numeric_limits<float>::max();
+		maxX = maxY = std::numeric_limits<float>::lowest();
+
+		auto addPoint = [&](float x, float y)
+		{
+			float px = (rotated) ? (x * cosR) - (y * sinR) : x;
+			float py = (rotated) ? (x * sinR) + (y * cosR) : y;
+			px += static_cast<float>(pos.x);
+			py += static_cast<float>(pos.y);
+			minX = std::min(minX, px);
+			minY = std::min(minY, py);
+			maxX = std::max(maxX, px);
+			maxY = std::max(maxY, py);
+		};
+
+		const std::vector<tson::Vector2i> *points = nullptr;
+		if(obj.getObjectType() == ObjectType::Polygon)
+			points = &obj.getPolygons();
+		else if(obj.getObjectType() == ObjectType::Polyline)
+			points = &obj.getPolylines();
+
+		if(points != nullptr && !points->empty())
+		{
+			for(const auto &p : *points)
+				addPoint(static_cast<float>(p.x), static_cast<float>(p.y));
+		}
+		else
+		{
+			float const w = static_cast<float>(size.x);
+			float const h = static_cast<float>(size.y);
+			float const top = (obj.getGid() > 0) ? -h : 0.f; //Tile objects are placed by their bottom-left corner
+			addPoint(0.f, top);
+			addPoint(w, top);
+			addPoint(0.f, top + h);
+			addPoint(w, top + h);
+		}
+	}
+
+	/*!
+	 * Builds the grid.
+	 * @param objects The objects to index. The index stores positions in this vector, so it must be rebuilt if the vector changes.
+	 * @param cellSize Size of a grid cell in pixels. If 0 or less, a cell size based on the average object size is used.
+	 */
+	void SpatialIndex::build(const std::vector<tson::Object> &objects, float cellSize)
+	{
+		clear();
+		if(objects.empty())
+			return;
+
+		size_t const count = objects.size();
+		m_minX.resize(count);
+		m_minY.resize(count);
+		m_maxX.resize(count);
+		m_maxY.resize(count);
+
+		float worldMinX = std::numeric_limits<float>::max();
+		float worldMinY = std::numeric_limits<float>::max();
+		float worldMaxX = std::numeric_limits<float>::lowest();
+		float worldMaxY = std::numeric_limits<float>::lowest();
+		double extentSum = 0.0;
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			CalculateBounds(objects[i], m_minX[i], m_minY[i], m_maxX[i], m_maxY[i]);
+			worldMinX = std::min(worldMinX, m_minX[i]);
+			worldMinY = std::min(worldMinY, m_minY[i]);
+			worldMaxX = std::max(worldMaxX, m_maxX[i]);
+			worldMaxY = std::max(worldMaxY, m_maxY[i]);
+			extentSum += std::max(m_maxX[i] - m_minX[i], m_maxY[i] - m_minY[i]);
+		}
+
+		float const worldWidth = worldMaxX - worldMinX;
+		float const worldHeight = worldMaxY - worldMinY;
+
+		if(cellSize <= 0.f)
+			cellSize = std::max(static_cast<float>(extentSum / static_cast<double>(count)) * 2.f, 1.f);
+
+		//Keep the amount of cells in the same order of magnitude as the amount of objects
+		double const maxCells = std::max<double>(static_cast<double>(count) * 4.0, 64.0);
+		while((std::floor(worldWidth / cellSize) + 1.0) * (std::floor(worldHeight / cellSize) + 1.0) > maxCells)
+			cellSize *= 2.f;
+
+		m_cellSize = cellSize;
+		m_origin = {worldMinX, worldMinY};
+		m_gridSize = {static_cast<int>(worldWidth / cellSize) + 1, static_cast<int>(worldHeight / cellSize) + 1};
+
+		//Counting sort of the object indices into the cells
+		size_t const cellCount = static_cast<size_t>(m_gridSize.x) * static_cast<size_t>(m_gridSize.y);
+		m_cellStart.assign(cellCount + 1, 0);
+		for(size_t i = 0; i < count; ++i)
+		{
+			for(int y = cellY(m_minY[i]); y <= cellY(m_maxY[i]); ++y)
+				for(int x = cellX(m_minX[i]); x <= cellX(m_maxX[i]); ++x)
+					++m_cellStart[static_cast<size_t>(y) * m_gridSize.x + x + 1];
+		}
+		for(size_t c = 0; c < cellCount; ++c)
+			m_cellStart[c + 1] += m_cellStart[c];
+
+		m_cellItems.resize(m_cellStart[cellCount]);
+		std::vector<uint32_t> fill {m_cellStart.begin(), m_cellStart.end() - 1};
+		for(size_t i = 0; i < count; ++i)
+		{
+			for(int y = cellY(m_minY[i]); y <= cellY(m_maxY[i]); ++y)
+				for(int x = cellX(m_minX[i]); x <= cellX(m_maxX[i]); ++x)
+					m_cellItems[fill[static_cast<size_t>(y) * m_gridSize.x + x]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	void SpatialIndex::clear()
+	{
+		m_cellSize = 0.f;
+		m_origin = {0.f, 0.f};
+		m_gridSize = {0, 0};
+		m_minX.clear();
+		m_minY.clear();
+		m_maxX.clear();
+		m_maxY.clear();
+		m_cellStart.clear();
+		m_cellItems.clear();
+	}
+
+	int SpatialIndex::cellX(float x) const
+	{
+		return std::clamp(static_cast<int>(std::floor((x - m_origin.x) / m_cellSize)), 0, m_gridSize.x - 1);
+	}
+
+	int SpatialIndex::cellY(float y) const
+	{
+		return std::clamp(static_cast<int>(std::floor((y - m_origin.y) / m_cellSize)), 0, m_gridSize.y - 1);
+	}
+
+	/*!
+	 * Calls func(index) once for every object whose bounding box overlaps the given box.
+	 * Objects spanning several cells are only reported from the first cell shared with the query,
+	 * which removes duplicates without having to keep any state between the queries.
+	 */
+	template<typename Func>
+	size_t SpatialIndex::forEachCandidate(float minX, float minY, float maxX, float maxY, Func &&func) const
+	{
+		if(m_cellStart.empty() || maxX < m_origin.x || maxY < m_origin.y ||
+		   minX > m_origin.x + m_cellSize * m_gridSize.x || minY > m_origin.y + m_cellSize * m_gridSize.y)
+			return 0;
+
+		int const startX = cellX(minX);
+		int const startY = cellY(minY);
+		int const endX = cellX(maxX);
+		int const endY = cellY(maxY);
+
+		size_t found = 0;
+		for(int y = startY; y <= endY; ++y)
+		{
+			for(int x = startX; x <= endX; ++x)
+			{
+				size_t const cell = static_cast<size_t>(y) * m_gridSize.x + x;
+				for(uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+				{
+					uint32_t const item = m_cellItems[i];
+					if(m_minX[item] > maxX || m_maxX[item] < minX || m_minY[item] > maxY || m_maxY[item] < minY)
+						continue;
+					if(std::max(cellX(m_minX[item]), startX) != x || std::max(cellY(m_minY[item]), startY) != y)
+						continue;
+					if(func(item))
+						++found;
+				}
+			}
+		}
+		return found;
+	}
+
+	/*!
+	 * Finds all objects with a bounding box that intersects the rectangle.
+	 * @param out Indices of the objects found are appended to this vector
+	 * @return The number of objects found
+	 */
+	size_t SpatialIndex::queryRect(float x, float y, float width, float height, std::vector<size_t> &out) const
+	{
+		return forEachCandidate(x, y, x + width, y + height, [&](uint32_t item)
+		{
+			out.push_back(item);
+			return true;
+		});
+	}
+
+	/*!
+	 * Finds all objects with a bounding box that contains the point.
+	 * @param out Indices of the objects found are appended to this vector
+	 * @return The number of objects found
+	 */
+	size_t SpatialIndex::queryPoint(float x, float y, std::vector<size_t> &out) const
+	{
+		return forEachCandidate(x, y, x, y, [&](uint32_t item)
+		{
+			out.push_back(item);
+			return true;
+		});
+	}
+
+	/*!
+	 * Finds all objects with a bounding box that intersects the circle.
+	 * @param out Indices of the objects found are appended to this vector
+	 * @return The number of objects found
+	 */
+	size_t SpatialIndex::queryRadius(float x, float y, float radius, std::vector<size_t> &out) const
+	{
+		float const radiusSq = radius * radius;
+		return forEachCandidate(x - radius, y - radius, x + radius, y + radius, [&](uint32_t item)
+		{
+			float const dx = x - std::clamp(x, m_minX[item], m_maxX[item]);
+			float const dy = y - std::clamp(y, m_minY[item], m_maxY[item]);
+			if((dx * dx) + (dy * dy) > radiusSq)
+				return false;
+
+			out.push_back(item);
+			return true;
+		});
+	}
+
+	bool SpatialIndex::empty() const
+	{
+		return m_minX.empty();
+	}
+
+	/*!
+	 * @return The number of indexed objects
+	 */
+	size_t SpatialIndex::size() const
+	{
+		return m_minX.size();
+	}
+
+	float SpatialIndex::getCellSize() const
+	{
+		return m_cellSize;
+	}
+
+	/*!
+	 * @return The number of columns (x) and rows (y) in the grid
+	 */
+	const Vector2i &SpatialIndex::getGridSize() const
+	{
+		return m_gridSize;
+	}
+}
+
+#endif //TILESON_SPATIALINDEX_HPP
+
+/*** End of inlined file: SpatialIndex.hpp ***/
+
+
+/*** Start of inlined file: IndexedRange.hpp ***/
+#ifndef TILESON_INDEXEDRANGE_HPP
+#define TILESON_INDEXEDRANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace tson
+{
+	/*!
+	 * A non-owning view of the elements of a container selected by a list of indices.
+	 * Used to return query results without copying the elements themselves.
+	 *
+	 * The view is only valid as long as both the container and the list of indices stay unchanged.
+	 *
+	 * Example:
+	 * for(tson::Object &obj : layer.getObjsByType(tson::ObjectType::Polygon)) { ... }
+	 */
+	template <typename T>
+	class IndexedRange
+	{
+		public:
+			class Iterator
+			{
+				public:
+					using iterator_category = std::forward_iterator_tag;
+					using value_type = T;
+					using difference_type = std::ptrdiff_t;
+					using pointer = T*;
+					using reference = T&;
+
+					inline Iterator(T *data, const size_t *index) : m_data {data}, m_index {index} {}
+					inline T &operator*() const { return m_data[*m_index]; }
+					inline T *operator->() const { return &m_data[*m_index]; }
+					inline Iterator &operator++() { ++m_index; return *this; }
+					inline Iterator operator++(int) { Iterator it = *this; ++m_index; return it; }
+					inline bool operator==(const Iterator &rhs) const { return m_index == rhs.m_index; }
+					inline bool operator!=(const Iterator &rhs) const { return m_index != rhs.m_index; }
+
+				private:
+					T *m_data;
+					const size_t *m_index;
+			};
+
+			inline IndexedRange() = default;
+			inline IndexedRange(T *data, const size_t *first, const size_t *last) : m_data {data}, m_first {first}, m_last {last} {}
+
+			[[nodiscard]] inline Iterator begin() const { return {m_data, m_first}; }
+			[[nodiscard]] inline Iterator end() const { return {m_data, m_last}; }
+			[[nodiscard]] inline size_t size() const { return static_cast<size_t>(m_last - m_first); }
+			[[nodiscard]] inline bool empty() const { return m_first == m_last; }
+			[[nodiscard]] inline T &operator[](size_t pos) const { return m_data[m_first[pos]]; }
+			[[nodiscard]] inline size_t indexAt(size_t pos) const { return m_first[pos]; }
+
+		private:
+			T *m_data {nullptr};
+			const size_t *m_first {nullptr};
+			const size_t *m_last {nullptr};
+	};
+}
+
+#endif //TILESON_INDEXEDRANGE_HPP
+
+/*** End of inlined file: IndexedRange.hpp ***/
+
+
+/*** Start of inlined file: TileObject.hpp ***/
+//
+// Created by robin on 26.07.2020.
+//
+
+#ifndef TILESON_TILEOBJECT_HPP
+#define TILESON_TILEOBJECT_HPP
+
+namespace tson
+{
+	class Tile;
+	class TileObject
+	{
+		public:
+			inline TileObject() = default;
+			inline TileObject(const std::tuple<int, int> &posInTileUnits, tson::Tile *tile);
+
+			inline void initialize(const std::tuple<int, int> &posInTileUnits, tson::Tile *tile); //Defined in tileson_forward.hpp
+
+			inline Tile *getTile();
+			inline const Vector2i &getPositionInTileUnits() const;
+			inline const Vector2f &getPosition() const;
+			inline const tson::Rect &getDrawingRect() const; //Defined in tileson_forward.hpp
+
+		private:
+			tson::Tile *m_tile;
+			tson::Vector2i m_posInTileUnits;
+			tson::Vector2f m_position;
+
+	};
+
+	TileObject::TileObject(const std::tuple<int, int> &posInTileUnits, tson::Tile *tile)
+	{
+		initialize(posInTileUnits, tile);
+	}
+
+	/*!
+	 * Get a pointer to the related tile
+	 * @return
+	 */
+	Tile *TileObject::getTile()
+	{
+		return m_tile;
+	}
+
+	/*!
+	 * Gets the position of the tile in tile units
+	 * @return
+	 */
+	const Vector2i &TileObject::getPositionInTileUnits() const
+	{
+		return m_posInTileUnits;
+	}
+
+	/*!
+	 * Gets the position of the tile in pixels.
+	 * @return
+	 */
+	const Vector2f &TileObject::getPosition() const
+	{
+		return m_position;
+	}
+}
+
+#endif //TILESON_TILEOBJECT_HPP
+
+/*** End of inlined file: TileObject.hpp ***/
+
+
+/*** Start of inlined file: TileCell.hpp ***/
+#ifndef TILESON_TILECELL_HPP
+#define TILESON_TILECELL_HPP
+
+#include <cstdint>
+
+namespace tson
+{
+	class Tile;
+
+	/*!
+	 * A single non-empty cell of a tile layer, as given by the region functions of tson::Layer.
+	 * Unlike tson::TileObject, this is a plain value, and works for infinite maps as well.
+	 */
+	class TileCell
+	{
+		public:
+			/*! The tile in this cell. Flip flagged tiles point to the flipped version of the tile when it exists.
+			 *  nullptr if no tile exists for the gid. */
+			tson::Tile *tile {nullptr};
+			/*! The gid of the cell, including flip flags */
+			uint32_t gid {};
+			/*! Position of the cell in tile units */
+			tson::Vector2i posInTileUnits;
+			/*! Top-left corner of the cell in pixels, including layer offset (and parallax, when a camera is involved) */
+			tson::Vector2f position;
+	};
+}
+
+#endif //TILESON_TILECELL_HPP
+
+/*** End of inlined file: TileCell.hpp ***/
+
+
+/*** Start of inlined file: FlaggedTile.hpp ***/
+//
+// Created by robin on 13.11.2020.
+//
+
+#ifndef TILESON_FLAGGEDTILE_HPP
+#define TILESON_FLAGGEDTILE_HPP
+
+namespace tson
+{
+	class FlaggedTile
+	{
+
+		public:
+			FlaggedTile(size_t x_, size_t y_, uint32_t id_, uint32_t tileId_) : x {x_}, y {y_}, id {id_}, tileId {tileId_}
+			{
+
+			}
+			size_t x;
+			size_t y;
+			/*! Full ID, including flag */
+			uint32_t id;
+			/*! ID of the flagged tile */
+			uint32_t tileId;
+	};
+}
+#endif //TILESON_FLAGGEDTILE_HPP
+
+/*** End of inlined file: FlaggedTile.hpp ***/
+
+namespace tson
+{
+	class Tile;
+	class Map;
+	class Layer;
+
+	/*!
+	 * Decides which layers of a map are parsed. Gets a layer where only the fields of the layer itself are read,
+	 * like the name, type and class. Must return true to keep the layer.
+	 */
+	using LayerFilter = std::function<bool(const tson::Layer &layer)>;
+
+	/*!
+	 * The json of a lazy layer until it is loaded. The json is owned by the map, which releases it when every layer is loaded.
+	 * Copying a lazy layer loads the source first, so a copy never points into the json of the map. Moving hands the json over.
+	 */
+	class LazyLayerJson
+	{
+		public:
+			inline LazyLayerJson() = default;
+			inline LazyLayerJson(const LazyLayerJson &other);
+			inline LazyLayerJson(LazyLayerJson &&other) noexcept;
+			inline LazyLayerJson &operator=(const LazyLayerJson &other);
+			inline LazyLayerJson &operator=(LazyLayerJson &&other) noexcept;
+			inline ~LazyLayerJson() = default;
+
+			IJson *                                             m_lazyJson {nullptr};       /*! The json of the data, chunks and objects until they are loaded. Owned by the map */
+	};
+
+	class Layer : private LazyLayerJson
+	{
+		friend class LazyLayerJson;
+		friend class Map;
+		friend class Tileset;
+		friend class MapSnapshot;
+		public:
+			inline Layer() = default;
+			inline Layer(IJson &json, tson::Map *map);
+			inline bool parse(IJson &json, tson::Map *map); //Defined in tileson_forward
+
+			[[nodiscard]] inline bool isLoaded() const;
+			inline void load(); //Defined in tileson_forward
+
+			[[nodiscard]] inline const std::string &getCompression() const;
+			[[nodiscard]] inline const std::vector<uint32_t> &getData() const;
+			[[nodiscard]] inline const std::string &getBase64Data() const;
+			[[nodiscard]] inline const std::string &getDrawOrder() const;
+			[[nodiscard]] inline const std::string &getEncoding() const;
+			[[nodiscard]] inline int getId() const;
+			[[nodiscard]] inline const std::string &getImage() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline const Vector2f &getOffset() const;
+			[[nodiscard]] inline float getOpacity() const;
+			[[nodiscard]] inline const Vector2i &getSize() const;
+			[[nodiscard]] inline const Colori &getTransparentColor() const;
+			[[nodiscard]] inline const Vector2f &getParallax() const;
+			[[nodiscard]] inline bool hasRepeatX() const;
+			[[nodiscard]] inline bool hasRepeatY() const;
+
+			[[nodiscard]] inline LayerType getType() const;
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+
+			[[nodiscard]] inline const std::string &getTypeStr() const;
+			[[nodiscard]] inline bool isVisible() const;
+			[[nodiscard]] inline int getX() const;
+			[[nodiscard]] inline int getY() const;
+
+			[[nodiscard]] inline std::vector<tson::Chunk> &getChunks();
+			[[nodiscard]] inline std::vector<tson::Layer> &getLayers();
+			[[nodiscard]] inline std::vector<tson::Object> &getObjects();
+			[[nodiscard]] inline PropertyCollection &getProperties();
+
+			inline tson::Object *getObj(int id);
+			inline tson::Object *firstObj(const std::string &name);
+			inline std::vector<tson::Object> getObjectsByName(const std::string &name);
+			inline std::vector<tson::Object> getObjectsByType(tson::ObjectType type);
+			inline tson::IndexedRange<tson::Object> getObjsByName(const std::string &name);
+			inline tson::IndexedRange<tson::Object> getObjsByType(tson::ObjectType type);
+			inline tson::IndexedRange<tson::Object> getObjsByClass(const std::string &classType);
+			inline void buildObjectBuckets();
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			inline void assignTileMap(std::map<uint32_t, tson::Tile*> *tileMap);
+			inline void createTileData(const Vector2i &mapSize, bool isInfiniteMap);
+
+			[[nodiscard]] inline const std::map<std::tuple<int, int>, tson::Tile *> &getTileData() const;
+			inline tson::Tile * getTileData(int x, int y);
+
+			//v1.2.0-stuff
+			[[nodiscard]] inline const Colori &getTintColor() const;
+			[[nodiscard]] inline bool hasTintColor() const;
+			[[nodiscard]] inline tson::Map *getMap() const;
+
+			[[nodiscard]] inline std::map<std::tuple<int, int>, tson::TileObject> &getTileObjects();
+			inline tson::TileObject * getTileObject(int x, int y);
+			[[nodiscard]] inline const std::set<uint32_t> &getUniqueFlaggedTiles() const;
+			inline void resolveFlaggedTiles();
+
+			inline const tson::SpatialIndex &buildSpatialIndex(float cellSize = 0.f);
+			[[nodiscard]] inline const tson::SpatialIndex &getSpatialIndex() const;
+			inline std::vector<tson::Object *> queryRect(const tson::Rect &rect);
+			inline std::vector<tson::Object *> queryPoint(const tson::Vector2f &point);
+			inline std::vector<tson::Object *> queryRadius(const tson::Vector2f &center, float radius);
+
+			template <typename Func>
+			inline void forEachVisibleTile(const tson::Rect &camera, Func &&func);
+			template <typename Func>
+			inline void forEachTileInRegion(const tson::Rect &tileRect, Func &&func);
+			inline std::vector<tson::TileCell> getVisibleTiles(const tson::Rect &camera);
+			[[nodiscard]] inline tson::Rect getTileBounds() const;
+			[[nodiscard]] inline const Vector2i &getRegionOrigin() const;
+			[[nodiscard]] inline bool hasRegion() const;
+			[[nodiscard]] inline tson::Vector2f getParallaxOffset(const tson::Rect &camera) const; /*! Defined in tileson_forward.hpp */
+
+		private:
+			/*!
+			 * Everything needed to iterate a rectangle of tiles. Created by createTileRegion().
+			 */
+			struct TileRegion
+			{
+				int x0 {}, y0 {}, x1 {-1}, y1 {-1};           /*! Inclusive range in tile units */
+				tson::Vector2f origin;                        /*! Added to the position of every tile */
+				bool cull {false};                            /*! Whether each tile must be checked against the pixel rect below */
+				float minX {}, minY {}, maxX {}, maxY {};     /*! Pixel rect, in the coordinates of the tiles without origin */
+				int orientation {};                           /*! 0 = orthogonal, 1 = isometric, 2 = staggered/hexagonal */
+				float tileWidth {}, tileHeight {};
+				float isoOriginX {};
+				bool staggerX {}, staggerEven {};
+				float sideLengthX {}, sideLengthY {}, columnWidth {}, rowHeight {};
+			};
+
+			template <typename Func>
+			inline void iterateTileRegion(const TileRegion &region, Func &&func);
+			inline TileRegion createTileRegion(const tson::Rect &rect, bool inPixels);   /*! Defined in tileson_forward.hpp */
+			inline tson::Vector2f tileToPixel(int x, int y, const TileRegion &region) const;
+			inline tson::Tile *resolveTile(uint32_t gid);                                  /*! Defined in tileson_forward.hpp */
+
+			inline void setTypeByString();
+
+			inline static void ParseLayers(IJson &json, tson::Map *map, std::vector<tson::Layer> &layers, const tson::LayerFilter &filter, bool lazy); /*! Defined in tileson_forward.hpp */
+			inline bool parseHeader(IJson &json, tson::Map *map);     /*! Defined in tileson_forward.hpp */
+			inline void parseProperties(IJson &json);                 /*! Defined in tileson_forward.hpp */
+			inline void parseData(IJson &json);                       /*! Defined in tileson_forward.hpp */
+			inline bool getDataRegion(tson::Rect &region) const;      /*! Defined in tileson_forward.hpp */
+			inline void decodeRegion(const tson::Rect &region);       /*! Defined in tileson_forward.hpp */
+			inline void ensureLoaded() const;
+
+			std::vector<tson::Chunk>                       m_chunks; 	                      /*! 'chunks': Array of chunks (optional). tilelayer only. */
+			std::string                                    m_compression;                     /*! 'compression': zlib, gzip or empty (default). tilelayer only. */
+			std::vector<uint32_t>                          m_data;                            /*! 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded
+																							   *   data. tilelayer only. */
+			std::string                                    m_base64Data;                      /*! 'data' (when string):     Array of unsigned int (GIDs) or base64-encoded
+																							   *   data. tilelayer only. */
+			std::string                                    m_drawOrder;                       /*! 'draworder': topdown (default) or index. objectgroup only. */
+			std::string                                    m_encoding;                        /*! 'encoding': csv (default) or base64. tilelayer only. */
+			int                                            m_id{};                            /*! 'id': Incremental id - unique across all layers */
+			std::string                                    m_image;                           /*! 'image': Image used by this layer. imagelayer only. */
+			std::vector<tson::Layer>                       m_layers; 	                      /*! 'layers': Array of layers. group on */
+			std::string                                    m_name;                            /*! 'name': Name assigned to this layer */
+			std::vector<tson::Object>                      m_objects;                         /*! 'objects': Array of objects. objectgroup only. */
+			tson::Vector2f                                 m_offset;                          /*! 'offsetx' and 'offsety': Horizontal and Vertical layer offset in pixels
+																							   *  (default: {0, 0}) */
+			float                                          m_opacity{};                       /*! 'opacity': Value between 0 and 1 */
+			tson::PropertyCollection                       m_properties; 	                  /*! 'properties': A list of properties (name, value, type). */
+			tson::Vector2i                                 m_size;                            /*! x = 'width': (Column count. Same as map width for fixed-size maps.)
+																								  y = 'height': Row count. Same as map height for fixed-size maps. */
+			tson::Colori                                   m_transparentColor;                /*! 'transparentcolor': Hex-formatted color (#RRGGBB) (optional, imagelayer only */
+			std::string                                    m_typeStr;                         /*! 'type': tilelayer, objectgroup, imagelayer or group */
+			LayerType                                      m_type {LayerType::Undefined};     /*! Layer type as enum*/
+			bool                                           m_visible{};                       /*! 'visible': Whether layer is shown or hidden in editor */
+			int                                            m_x{};                             /*! 'x': Horizontal layer offset in tiles. Always 0. */
+			int                                            m_y{};                             /*! 'y': Vertical layer offset in tiles. Always 0. */
+			tson::Vector2f                                 m_parallax{1.f, 1.f};    /*! Tiled v1.5: parallax factor for this layer. Defaults to 1.
+																								  x = 'parallaxx', y = 'parallaxy'*/
+			bool                                           m_repeatX {};                         /*! 'repeatx': Whether the image drawn by this layer is repeated along the X axis. (since Tiled 1.8)*/
+			bool                                           m_repeatY {};                         /*! 'repeaty': Whether the image drawn by this layer is repeated along the Y axis. (since Tiled 1.8)*/
+
+			std::map<uint32_t, tson::Tile*>                *m_tileMap {nullptr};
+			std::map<std::tuple<int, int>, tson::Tile*>    m_tileData;                        /*! Key: Tuple of x and y pos in tile units. */
+
+			//v1.2.0-stuff
+			tson::Colori                                        m_tintColor;                  /*! 'tintcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) that is multiplied with
+																							   *        any graphics drawn by this layer or any child layers (optional). */
+			bool                                                m_hasTintColor {false};       /*! true if 'tintcolor' is set */
+			inline void decompressData(const tson::Rect *region = nullptr);                   /*! Defined in tileson_forward.hpp */
+			inline void queueFlaggedTile(size_t x, size_t y, uint32_t id);                    /*! Queue a flagged tile */
+
+			tson::Map *                                         m_map;                        /*! The map who owns this layer */
+			std::map<std::tuple<int, int>, tson::TileObject>    m_tileObjects;
+			std::set<uint32_t>                                  m_uniqueFlaggedTiles;
+			std::vector<tson::FlaggedTile>                      m_flaggedTiles;
+
+			std::string                                         m_classType{};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
+			std::shared_ptr<tson::TiledClass>                   m_class {};
+
+			tson::SpatialIndex                                  m_spatialIndex;             /*! Optional grid over the bounds of m_objects. Built by buildSpatialIndex() */
+			inline std::vector<tson::Object *> indicesToObjects(const std::vector<size_t> &indices);
+
+			inline tson::IndexedRange<tson::Object> bucketToRange(const std::vector<size_t> *bucket);
+			std::vector<std::vector<size_t>>                         m_objectsByType;       /*! Indices of m_objects, grouped by tson::ObjectType */
+			std::unordered_map<std::string, std::vector<size_t>>     m_objectsByClass;      /*! Indices of m_objects, grouped by 'type'/'class' */
+			std::unordered_map<std::string, std::vector<size_t>>     m_objectsByName;       /*! Indices of m_objects, grouped by 'name' */
+
+			tson::Vector2i                                      m_regionOrigin;             /*! Position of the first tile of m_data in the map, when only a region is decoded */
+			bool                                                m_hasRegion {false};        /*! true if m_data is only a region of the layer. See tson::Map::setTileRegion() */
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T Layer::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+}
+
+/*!
+ * Calls func(const tson::TileCell &) for every non-empty tile of this tile layer that is visible inside the camera rectangle,
+ * in row-major order. The layer offset, the parallax factor of the layer and the parallax origin of the map are taken into account,
+ * as well as the orientation of the map (orthogonal, isometric, staggered and hexagonal).
+ * The TileCell::position of each tile is the top-left corner of its cell in the same coordinates as the camera.
+ *
+ * For finite maps, the cost is proportional to the number of visible tiles. Infinite maps are handled by iterating
+ * the chunks that overlap the camera. Only chunks with csv data are supported.
+ *
+ * NOTE: The parallax factor of parent group layers is not included.
+ *
+ * @param camera The visible area in pixels.
+ * @param func Function called for each visible tile.
+ */
+template<typename Func>
+void tson::Layer::forEachVisibleTile(const tson::Rect &camera, Func &&func)
+{
+	iterateTileRegion(createTileRegion(camera, true), std::forward<Func>(func));
+}
+
+/*!
+ * Calls func(const tson::TileCell &) for every non-empty tile of this tile layer inside the rectangle, in row-major order.
+ * The TileCell::position of each tile includes the offset of the layer, but not parallax.
+ *
+ * @param tileRect The rectangle in tile units.
+ * @param func Function called for each tile.
+ */
+template<typename Func>
+void tson::Layer::forEachTileInRegion(const tson::Rect &tileRect, Func &&func)
+{
+	iterateTileRegion(createTileRegion(tileRect, false), std::forward<Func>(func));
+}
+
+template<typename Func>
+void tson::Layer::iterateTileRegion(const TileRegion &region, Func &&func)
+{
+	ensureLoaded();
+
+	if(region.x1 < region.x0 || region.y1 < region.y0)
+		return;
+
+	tson::TileCell cell;
+	auto emit = [&](int x, int y, uint32_t gid)
+	{
+		tson::Vector2f pos = tileToPixel(x, y, region);
+		if(region.cull && (pos.x + region.tileWidth <= region.minX || pos.x >= region.maxX ||
+						   pos.y + region.tileHeight <= region.minY || pos.y >= region.maxY))
+			return;
+
+		cell.gid = gid;
+		cell.tile = resolveTile(gid);
+		cell.posInTileUnits = {x, y};
+		cell.position = {pos.x + region.origin.x, pos.y + region.origin.y};
+		func(static_cast<const tson::TileCell &>(cell));
+	};
+
+	if(m_chunks.empty())
+	{
+		//m_data starts at m_regionOrigin when only a region of the layer is decoded
+		int const x0 = std::max(region.x0, m_regionOrigin.x);
+		int const y0 = std::max(region.y0, m_regionOrigin.y);
+		int const x1 = std::min(region.x1, m_regionOrigin.x + m_size.x - 1);
+		int const y1 = std::min(region.y1, m_regionOrigin.y + m_size.y - 1);
+		if(m_data.size() < static_cast<size_t>(m_size.x) * static_cast<size_t>(m_size.y))
+			return;
+
+		for(int y = y0; y <= y1; ++y)
+		{
+			const uint32_t *row = m_data.data() + static_cast<size_t>(y - m_regionOrigin.y) * m_size.x;
+			for(int x = x0; x <= x1; ++x)
+			{
+				uint32_t const gid = row[x - m_regionOrigin.x];
+				if(gid != 0)
+					emit(x, y, gid);
+			}
+		}
+	}
+	else
+	{
+		//Only the chunks overlapping the region, sorted by x, so every row can be visited from left to right
+		std::vector<const tson::Chunk *> chunks;
+		for(const auto &chunk : m_chunks)
+		{
+			const tson::Vector2i &pos = chunk.getPosition();
+			const tson::Vector2i &size = chunk.getSize();
+			if(pos.x > region.x1 || pos.x + size.x <= region.x0 || pos.y > region.y1 || pos.y + size.y <= region.y0)
+				continue;
+			if(chunk.getData().size() < static_cast<size_t>(size.x) * static_cast<size_t>(size.y))
+				continue;
+			chunks.push_back(&chunk);
+		}
+		std::sort(chunks.begin(), chunks.end(), [](const tson::Chunk *a, const tson::Chunk *b) { return a->getPosition().x < b->getPosition().x; });
+
+		for(int y = region.y0; y <= region.y1; ++y)
+		{
+			for(const tson::Chunk *chunk : chunks)
+			{
+				const tson::Vector2i &pos = chunk->getPosition();
+				const tson::Vector2i &size = chunk->getSize();
+				if(y < pos.y || y >= pos.y + size.y)
+					continue;
+
+				const int *row = chunk->getData().data() + static_cast<size_t>(y - pos.y) * size.x;
+				int const x1 = std::min(region.x1, pos.x + size.x - 1);
+				for(int x = std::max(region.x0, pos.x); x <= x1; ++x)
+				{
+					uint32_t const gid = static_cast<uint32_t>(row[x - pos.x]);
+					if(gid != 0)
+						emit(x, y, gid);
+				}
+			}
+		}
+	}
+}
+
+/*!
+ * Parses a Tiled layer from json
+ * @param json
+ */
+tson::Layer::Layer(IJson &json, tson::Map *map)
+{
+	parse(json, map);
+}
+
+/*!
+ * Whether the tile data, chunks and objects of this layer have been read. Only layers of maps parsed with
+ * tson::Tileson::setLazyLayers() can be unloaded, until one of the functions that need the data are used, or load() is called.
+ * @return false if the layer is still waiting to be loaded
+ */
+bool tson::Layer::isLoaded() const
+{
+	return m_lazyJson == nullptr;
+}
+
+void tson::Layer::ensureLoaded() const
+{
+	//Loading is part of reading the layer, like with the lazily built spatial index
+	if(m_lazyJson != nullptr)
+		const_cast<tson::Layer *>(this)->load();
+}
+
+/*!
+ * Loads the source layer, which is the tson::Layer this is a part of, before its members are copied
+ */
+tson::LazyLayerJson::LazyLayerJson(const LazyLayerJson &other)
+{
+	static_cast<const tson::Layer &>(other).ensureLoaded();
+}
+
+tson::LazyLayerJson::LazyLayerJson(LazyLayerJson &&other) noexcept : m_lazyJson {other.m_lazyJson}
+{
+	other.m_lazyJson = nullptr;
+}
+
+tson::LazyLayerJson &tson::LazyLayerJson::operator=(const LazyLayerJson &other)
+{
+	if(this != &other)
+	{
+		static_cast<const tson::Layer &>(other).ensureLoaded();
+		static_cast<tson::Layer &>(*this).ensureLoaded();
+	}
+	return *this;
+}
+
+tson::LazyLayerJson &tson::LazyLayerJson::operator=(LazyLayerJson &&other) noexcept
+{
+	std::swap(m_lazyJson, other.m_lazyJson);
+	return *this;
+}
+
+void tson::Layer::queueFlaggedTile(size_t x, size_t y, uint32_t id)
+{
+	uint32_t tileId = id;
+	tileId &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+	m_uniqueFlaggedTiles.insert(id);
+	m_flaggedTiles.emplace_back(x, y, id, tileId);
+}
+
+/*!
+ * Copies all objects with a name that equals the parameter
+ * @param name Name of the objects to return
+ * @return All objects with a matching name
+ */
+std::vector<tson::Object> tson::Layer::getObjectsByName(const std::string &name)
+{
+	ensureLoaded();
+	std::vector<tson::Object> found;
+
+	std::copy_if(m_objects.begin(), m_objects.end(), std::back_inserter(found), [&](const tson::Object &item)
+	{
+		return item.getName() == name;
+	});
+
+	return found;
+}
+
+/*!
+ * Copies all objects with a type that equals the parameter
+ * @param type LayerType of the objects to return
+ * @return All objects with a matching type
+ */
+std::vector<tson::Object> tson::Layer::getObjectsByType(tson::ObjectType type)
+{
+	ensureLoaded();
+	std::vector<tson::Object> found;
+
+	std::copy_if(m_objects.begin(), m_objects.end(), std::back_inserter(found), [&](const tson::Object &item)
+	{
+		return item.getObjectType() == type;
+	});
+
+	return found;
+}
+
+/*!
+ * Groups the indices of all objects by object type, class and name, so getObjsByType(), getObjsByClass() and getObjsByName()
+ * can return the matching objects without searching or copying.
+ * Called automatically when the layer is parsed, but must be called again if objects are added or removed afterwards.
+ */
+void tson::Layer::buildObjectBuckets()
+{
+	m_objectsByType.clear();
+	m_objectsByClass.clear();
+	m_objectsByName.clear();
+
+	for(size_t i = 0; i < m_objects.size(); ++i)
+	{
+		const tson::Object &obj = m_objects[i];
+		auto type = static_cast<size_t>(obj.getObjectType());
+		if(type >= m_objectsByType.size())
+			m_objectsByType.resize(type + 1);
+
+		m_objectsByType[type].push_back(i);
+		m_objectsByClass[obj.getClassType()].push_back(i);
+		m_objectsByName[obj.getName()].push_back(i);
+	}
+}
+
+tson::IndexedRange<tson::Object> tson::Layer::bucketToRange(const std::vector<size_t> *bucket)
+{
+	if(bucket == nullptr || bucket->empty())
+		return {};
+
+	return {m_objects.data(), bucket->data(), bucket->data() + bucket->size()};
+}
+
+/*!
+ * Gets all objects with a name that equals the parameter, without copying them.
+ * The result is only valid as long as the objects of this layer are unchanged.
+ * @param name Name of the objects to return
+ * @return A view of all objects with a matching name, in the same order as getObjects().
+ */
+tson::IndexedRange<tson::Object> tson::Layer::getObjsByName(const std::string &name)
+{
+	ensureLoaded();
+	auto iter = m_objectsByName.find(name);
+	return bucketToRange((iter != m_objectsByName.end()) ? &iter->second : nullptr);
+}
+
+/*!
+ * Gets all objects of the given object type, without copying them.
+ * The result is only valid as long as the objects of this layer are unchanged.
+ * @param type ObjectType of the objects to return
+ * @return A view of all objects with a matching type, in the same order as getObjects().
+ */
+tson::IndexedRange<tson::Object> tson::Layer::getObjsByType(tson::ObjectType type)
+{
+	ensureLoaded();
+	auto pos = static_cast<size_t>(type);
+	return bucketToRange((pos < m_objectsByType.size()) ? &m_objectsByType[pos] : nullptr);
+}
+
+/*!
+ * Gets all objects with a 'class' (previously 'type') that equals the parameter, without copying them.
+ * The result is only valid as long as the objects of this layer are unchanged.
+ * @param classType Class of the objects to return
+ * @return A view of all objects with a matching class, in the same order as getObjects().
+ */
+tson::IndexedRange<tson::Object> tson::Layer::getObjsByClass(const std::string &classType)
+{
+	ensureLoaded();
+	auto iter = m_objectsByClass.find(classType);
+	return bucketToRange((iter != m_objectsByClass.end()) ? &iter->second : nullptr);
+}
+
+/*!
+ * Returns the first object with the given name
+ * @param name Name of the object to find.
+ * @return A pointer to the object if found. nullptr otherwise.
+ */
+tson::Object *tson::Layer::firstObj(const std::string &name)
+{
+	ensureLoaded();
+	auto result = std::find_if(m_objects.begin(), m_objects.end(), [&](const tson::Object &obj){return obj.getName() == name; });
+	if(result == m_objects.end())
+		return nullptr;
+
+	return &result.operator*();
+}
+
+/*!
+ * Get an object by ID
+ * @param id Unique ID of the object
+ * @return A pointer to the object if found. nullptr otherwise.
+ */
+tson::Object *tson::Layer::getObj(int id)
+{
+	ensureLoaded();
+	auto result = std::find_if(m_objects.begin(), m_objects.end(), [&](const tson::Object &obj){return obj.getId() == id; });
+	if(result == m_objects.end())
+		return nullptr;
+
+	return &result.operator*();
+}
+
+/*!
+ * Set type by string
+ * tilelayer, objectgroup, imagelayer or group
+ */
+void tson::Layer::setTypeByString()
+{
+	if(m_typeStr == "tilelayer") m_type = LayerType::TileLayer;
+	else if(m_typeStr == "objectgroup") m_type = LayerType::ObjectGroup;
+	else if(m_typeStr == "imagelayer") m_type = LayerType::ImageLayer;
+	else if(m_typeStr == "group") m_type = LayerType::Group;
+	else m_type = LayerType::Undefined;
+}
+
+/*!
+ * 'compression': zlib, gzip or empty (default). tilelayer only.
+ * @return
+ */
+const std::string &tson::Layer::getCompression() const
+{
+	return m_compression;
+}
+
+/*!
+ * 'data' (when uint array): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only.
+ * @return
+ */
+const std::vector<uint32_t> &tson::Layer::getData() const
+{
+	ensureLoaded();
+	return m_data;
+}
+
+/*!
+ * 'data' (when string): Array of unsigned int (GIDs) or base64-encoded data. tilelayer only.
+ * @return
+ */
+const std::string &tson::Layer::getBase64Data() const
+{
+	ensureLoaded();
+	return m_base64Data;
+}
+
+/*!
+ * 'draworder': topdown (default) or index. objectgroup only.
+ * @return
+ */
+const std::string &tson::Layer::getDrawOrder() const
+{
+	return m_drawOrder;
+}
+
+/*!
+ * 'encoding': csv (default) or base64. tilelayer only.
+ * @return
+ */
+const std::string &tson::Layer::getEncoding() const
+{
+	return m_encoding;
+}
+
+/*!
+ * 'id': Incremental id - unique across all layers
+ * @return
+ */
+int tson::Layer::getId() const
+{
+	return m_id;
+}
+
+/*!
+ * 'image': Image used by this layer. imagelayer only.
+ * @return
+ */
+const std::string &tson::Layer::getImage() const
+{
+	return m_image;
+}
+
+/*!
+ * 'name': Name assigned to this layer
+ * @return
+ */
+const std::string &tson::Layer::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * 'offsetx' and 'offsety': Horizontal and Vertical layer offset in pixels (default: {0, 0})
+ * @return
+ */
+const tson::Vector2f &tson::Layer::getOffset() const
+{
+	return m_offset;
+}
+
+/*!
+ * 'opacity': Value between 0 and 1
+ * @return
+ */
+float tson::Layer::getOpacity() const
+{
+	return m_opacity;
+}
+
+/*!
+ * x = 'width': (Column count. Same as map width for fixed-size maps.)
+ * y = 'height': Row count. Same as map height for fixed-size maps.
+ * @return width and height as a single size
+ */
+const tson::Vector2i &tson::Layer::getSize() const
+{
+	return m_size;
+}
+
+/*!
+ * 'transparentcolor': Color created from a hex color (#RRGGBB) (optional, imagelayer only)
+ * @return color as color object with rgba channel.
+ */
+const tson::Colori &tson::Layer::getTransparentColor() const
+{
+	return m_transparentColor;
+}
+
+/*!
+ * 'type': tilelayer, objectgroup, imagelayer or group
+ * @return string with the object type
+ */
+const std::string &tson::Layer::getTypeStr() const
+{
+	return m_typeStr;
+}
+
+/*!
+ * 'visible': Whether layer is shown or hidden in editor
+ * @return
+ */
+bool tson::Layer::isVisible() const
+{
+	return m_visible;
+}
+
+/*!
+ * 'x': Horizontal layer offset in tiles. Always 0.
+ * @return x value (always 0 for layer)
+ */
+int tson::Layer::getX() const
+{
+	return m_x;
+}
+
+/*!
+ * 'y': Horizontal layer offset in tiles. Always 0.
+ * @return y value (always 0 for layer)
+ */
+int tson::Layer::getY() const
+{
+	return m_y;
+}
+
+/*!
+ * 'chunks': Array of chunks (optional). tilelayer only.
+ * @return
+ */
+std::vector<tson::Chunk> &tson::Layer::getChunks()
+{
+	ensureLoaded();
+	return m_chunks;
+}
+
+/*!
+ * 'layers': Array of layers. group on
+ * @return
+ */
+std::vector<tson::Layer> &tson::Layer::getLayers()
+{
+	return m_layers;
+}
+
+/*!
+ * 'objects': Array of objects. objectgroup only.
+ * @return
+ */
+std::vector<tson::Object> &tson::Layer::getObjects()
+{
+	ensureLoaded();
+	return m_objects;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::Layer::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::Layer::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+	return nullptr;
+}
+
+/*!
+ * Get layer type
+ * @return Layer type as enum
+ */
+tson::LayerType tson::Layer::getType() const
+{
+	return m_type;
+}
+
+/*!
+ * Assigns a tilemap of pointers to existing tiles.
+ * @param tileMap The tilemap. key: tile id, value: pointer to Tile.
+ */
+void tson::Layer::assignTileMap(std::map<uint32_t, tson::Tile *> *tileMap)
+{
+	m_tileMap = tileMap;
+}
+
+/*!
+ * Get tile data as some kind of map with x and y position with pointers to existing tiles.
+ * Map only contains tiles that are not empty. x and y position is in tile units.
+ *
+ * Example of getting tile from the returned map:
+ *
+ * Tile *tile = tileData[{0, 4}];
+ *
+ * @return A map that represents the data returned from getData() in a 2D map with Tile pointers.
+ */
+const std::map<std::tuple<int, int>, tson::Tile *> &tson::Layer::getTileData() const
+{
+	ensureLoaded();
+	return m_tileData;
+}
+
+/*!
+ * A safe way to get tile data
+ * Get tile data as some kind of map with x and y position with pointers to existing tiles.
+ * Map only contains tiles that are not empty. x and y position is in tile units.
+ *
+ * Example of getting tile:
+ * Tile *tile = layer->getTileData(0, 4)
+ *
+ * @param x X position in tile units
+ * @param y Y position in tile units
+ * @return pointer to tile, if it exists. nullptr otherwise.
+ */
+tson::Tile *tson::Layer::getTileData(int x, int y)
+{
+	ensureLoaded();
+	return (m_tileData.count({x, y}) > 0) ? m_tileData[{x,y}] : nullptr;
+}
+
+/*!
+ * Used for getting the tson::Map who is the parent of this Layer.
+ * @return a pointer to the tson::Map where this layer is contained.
+ */
+tson::Map *tson::Layer::getMap() const
+{
+	return m_map;
+}
+
+/*!
+ *
+ * This is only supported for non-infinite maps!
+ *
+ * @param mapSize The size of the map
+ * @param isInfiniteMap Whether or not the current map is infinte.
+ */
+void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
+{
+	//A decoded region has its own width, and its tiles keep their position in the map
+	int const width = (m_hasRegion) ? m_size.x : mapSize.x;
+	size_t x = m_regionOrigin.x;
+	size_t y = m_regionOrigin.y;
+	if(!isInfiniteMap)
+	{
+		std::for_each(m_data.begin(), m_data.end(), [&](uint32_t tileId)
+		{
+			if (static_cast<int>(x) == m_regionOrigin.x + width)
+			{
+				++y;
+				x = m_regionOrigin.x;
+			}
+
+			if (tileId > 0 && m_tileMap->count(tileId) > 0)
+			{
+				m_tileData[{static_cast<int>(x), static_cast<int>(y)}] = m_tileMap->at(tileId);
+				m_tileObjects[{static_cast<int>(x), static_cast<int>(y)}] = {{static_cast<int>(x), static_cast<int>(y)}, m_tileData[{static_cast<int>(x), static_cast<int>(y)}]};
+			}
+			else if(tileId > 0 && m_tileMap->count(tileId) == 0) //Tile with flip flags!
+			{
+				queueFlaggedTile(x, y, tileId);
+			}
+			x++;
+		});
+
+	}
+}
+
+std::map<std::tuple<int, int>, tson::TileObject> &tson::Layer::getTileObjects()
+{
+	ensureLoaded();
+	return m_tileObjects;
+}
+
+tson::TileObject *tson::Layer::getTileObject(int x, int y)
+{
+	ensureLoaded();
+	return (m_tileObjects.count({x, y}) > 0) ? &m_tileObjects[{x,y}] : nullptr;
+}
+
+const std::set<uint32_t> &tson::Layer::getUniqueFlaggedTiles() const
+{
+	ensureLoaded();
+	return m_uniqueFlaggedTiles;
+}
+
+void tson::Layer::resolveFlaggedTiles()
+{
+	std::for_each(m_flaggedTiles.begin(), m_flaggedTiles.end(), [&](const tson::FlaggedTile &tile)
+	{
+		if (tile.id > 0 && m_tileMap->count(tile.id) > 0)
+		{
+			m_tileData[{static_cast<int>(tile.x), static_cast<int>(tile.y)}] = m_tileMap->at(tile.id);
+			m_tileObjects[{static_cast<int>(tile.x), static_cast<int>(tile.y)}] = {{static_cast<int>(tile.x), static_cast<int>(tile.y)}, m_tileData[{static_cast<int>(tile.x), static_cast<int>(tile.y)}]};
+		}
+	});
+}
+
+/*!
+ * 'tintcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) that is multiplied with any graphics drawn by this layer or any child layers (optional).
+ *
+ * @return tintcolor
+ */
+const tson::Colori &tson::Layer::getTintColor() const
+{
+	return m_tintColor;
+}
+
+/*!
+ * Whether the layer has a 'tintcolor'. If false, getTintColor() is just the default color and should not be applied.
+ * @return true if 'tintcolor' is set
+ */
+bool tson::Layer::hasTintColor() const
+{
+	return m_hasTintColor;
+}
+
+/*!
+ * New in Tiled v1.5
+ * Gets the parallax factor for current layer. Defaults to 1.
+ * @return A vector with the x and y values of the parallax factor.
+ */
+const tson::Vector2f &tson::Layer::getParallax() const
+{
+	return m_parallax;
+}
+
+/*!
+ * New in Tiled v1.8
+ * 'repeatx': Whether the image drawn by this layer is repeated along the X axis.
+ * @return true if image layer is repeated along the X axis, false otherwise.
+ */
+bool tson::Layer::hasRepeatX() const
+{
+	return m_repeatX;
+}
+
+/*!
+ * New in Tiled v1.8
+ * 'repeatx': Whether the image drawn by this layer is repeated along the Y axis.
+ * @return true if image layer is repeated along the Y axis, false otherwise.
+ */
+bool tson::Layer::hasRepeatY() const
+{
+	return m_repeatY;
+}
+
+const std::string &tson::Layer::getClassType() const
+{
+	return m_classType;
+}
+
+/*!
+ * Builds a spatial index (uniform grid) over the bounding boxes of the objects in this layer.
+ * This is optional, but makes queryRect(), queryPoint() and queryRadius() run in roughly constant time instead
+ * of checking every object. The queries will build the index automatically the first time they are used, but if the layer
+ * is going to be queried from several threads, this function should be called first.
+ *
+ * The index must be rebuilt if the objects of the layer are changed.
+ *
+ * @param cellSize Size of a grid cell in pixels. If 0 or less, a cell size based on the average object size is used.
+ * @return The built index, which also offers queries that return indices without allocating.
+ */
+const tson::SpatialIndex &tson::Layer::buildSpatialIndex(float cellSize)
+{
+	ensureLoaded();
+	m_spatialIndex.build(m_objects, cellSize);
+	return m_spatialIndex;
+}
+
+/*!
+ * Gets the spatial index of the objects in this layer. Empty until buildSpatialIndex() or one of the queries has been called.
+ * @return The spatial index
+ */
+const tson::SpatialIndex &tson::Layer::getSpatialIndex() const
+{
+	ensureLoaded();
+	return m_spatialIndex;
+}
+
+/*!
+ * Gets all objects with a bounding box intersecting the rectangle. Position, size, rotation and polygon points of the objects are
+ * taken into account.
+ * @param rect The rectangle in pixels
+ * @return Pointers to the objects found, in no particular order.
+ */
+std::vector<tson::Object *> tson::Layer::queryRect(const tson::Rect &rect)
+{
+	ensureLoaded();
+	if(m_spatialIndex.size() != m_objects.size())
+		buildSpatialIndex();
+
+	std::vector<size_t> indices;
+	m_spatialIndex.queryRect((float)rect.x, (float)rect.y, (float)rect.width, (float)rect.height, indices);
+	return indicesToObjects(indices);
+}
+
+/*!
+ * Gets all objects with a bounding box containing the point.
+ * @param point The point in pixels
+ * @return Pointers to the objects found, in no particular order.
+ */
+std::vector<tson::Object *> tson::Layer::queryPoint(const tson::Vector2f &point)
+{
+	ensureLoaded();
+	if(m_spatialIndex.size() != m_objects.size())
+		buildSpatialIndex();
+
+	std::vector<size_t> indices;
+	m_spatialIndex.queryPoint(point.x, point.y, indices);
+	return indicesToObjects(indices);
+}
+
+/*!
+ * Gets all objects with a bounding box intersecting the circle.
+ * @param center Center of the circle in pixels
+ * @param radius Radius of the circle in pixels
+ * @return Pointers to the objects found, in no particular order.
+ */
+std::vector<tson::Object *> tson::Layer::queryRadius(const tson::Vector2f &center, float radius)
+{
+	ensureLoaded();
+	if(m_spatialIndex.size() != m_objects.size())
+		buildSpatialIndex();
+
+	std::vector<size_t> indices;
+	m_spatialIndex.queryRadius(center.x, center.y, radius, indices);
+	return indicesToObjects(indices);
+}
+
+/*!
+ * Gets every non-empty tile visible inside the camera rectangle, in row-major order.
+ * See forEachVisibleTile() for details. Use forEachVisibleTile() directly to avoid the allocation.
+ * @param camera The visible area in pixels.
+ * @return The visible tiles.
+ */
+std::vector<tson::TileCell> tson::Layer::getVisibleTiles(const tson::Rect &camera)
+{
+	std::vector<tson::TileCell> tiles;
+	forEachVisibleTile(camera, [&](const tson::TileCell &cell) { tiles.push_back(cell); });
+	return tiles;
+}
+
+/*!
+ * The rectangle in tile units that contains all the tile data of this layer.
+ * For finite layers this is the size of the layer, or the decoded region (see hasRegion()). For infinite layers it is the union of all chunks, which may start at negative positions.
+ * @return Bounds in tile units
+ */
+tson::Rect tson::Layer::getTileBounds() const
+{
+	ensureLoaded();
+	if(m_chunks.empty())
+		return {m_regionOrigin.x, m_regionOrigin.y, m_size.x, m_size.y};
+
+	int minX = std::numeric_limits<int>::max(), minY = std::numeric_limits<int>::max();
+	int maxX = std::numeric_limits<int>::min(), maxY = std::numeric_limits<int>::min();
+	for(const auto &chunk : m_chunks)
+	{
+		minX = std::min(minX, chunk.getPosition().x);
+		minY = std::min(minY, chunk.getPosition().y);
+		maxX = std::max(maxX, chunk.getPosition().x + chunk.getSize().x);
+		maxY = std::max(maxY, chunk.getPosition().y + chunk.getSize().y);
+	}
+	return {minX, minY, maxX - minX, maxY - minY};
+}
+
+/*!
+ * Position in the map, in tile units, of the first tile of getData(). Only differs from {0, 0} when hasRegion() is true.
+ * @return Origin of the data in tile units
+ */
+const tson::Vector2i &tson::Layer::getRegionOrigin() const
+{
+	return m_regionOrigin;
+}
+
+/*!
+ * Whether only a region of this tile layer was decoded (see tson::Tileson::setTileRegion()). getData() then only holds
+ * the tiles of the region, row by row, getSize() is the size of the region and getRegionOrigin() is where it starts in the map.
+ * getTileData(), forEachVisibleTile() etc. still use positions in the map.
+ * @return true if the data is only a region of the layer
+ */
+bool tson::Layer::hasRegion() const
+{
+	return m_hasRegion;
+}
+
+/*!
+ * Position of the top-left corner of the bounding box of a cell, relative to the layer.
+ * Follows the renderers of Tiled for each orientation.
+ */
+tson::Vector2f tson::Layer::tileToPixel(int x, int y, const TileRegion &region) const
+{
+	if(region.orientation == 1) //isometric
+	{
+		return {static_cast<float>(x - y) * region.tileWidth / 2.f + region.isoOriginX, static_cast<float>(x + y) * region.tileHeight / 2.f};
+	}
+	else if(region.orientation == 2) //staggered and hexagonal
+	{
+		if(region.staggerX)
+		{
+			float pixelY = static_cast<float>(y) * (region.tileHeight + region.sideLengthY);
+			if(((x & 1) != 0) != region.staggerEven)
+				pixelY += region.rowHeight;
+			return {static_cast<float>(x) * region.columnWidth, pixelY};
+		}
+
+		float pixelX = static_cast<float>(x) * (region.tileWidth + region.sideLengthX);
+		if(((y & 1) != 0) != region.staggerEven)
+			pixelX += region.columnWidth;
+		return {pixelX, static_cast<float>(y) * region.rowHeight};
+	}
+
+	return {static_cast<float>(x) * region.tileWidth, static_cast<float>(y) * region.tileHeight};
+}
+
+std::vector<tson::Object *> tson::Layer::indicesToObjects(const std::vector<size_t> &indices)
+{
+	std::vector<tson::Object *> objects;
+	objects.reserve(indices.size());
+	for(size_t i : indices)
+		objects.push_back(&m_objects[i]);
+	return objects;
+}
+
+#endif //TILESON_LAYER_HPP
+
+/*** End of inlined file: Layer.hpp ***/
+
+
+/*** Start of inlined file: Tileset.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_TILESET_HPP
+#define TILESON_TILESET_HPP
+
+//#include "../external/json.hpp"
+
+
+/*** Start of inlined file: Transformations.hpp ***/
+//
+// Created by robin on 04.04.2021.
+//
+
+#ifndef TILESON_TRANSFORMATIONS_HPP
+#define TILESON_TRANSFORMATIONS_HPP
+
+namespace tson
+{
+	class Transformations
+	{
+		friend class MapSnapshot;
+		public:
+			inline Transformations() = default;
+			inline explicit Transformations(IJson &json);
+			inline bool parse(IJson &json);
+
+			inline bool allowHflip() const;
+			inline bool allowPreferuntransformed() const;
+			inline bool allowRotation() const;
+			inline bool allowVflip() const;
+
+		private:
+			bool m_hflip {};                /*! hflip: Whether the tiles in this set can be flipped horizontally (default false) */
+			bool m_preferuntransformed {};  /*! preferuntransformed: Whether untransformed tiles remain preferred, otherwise transformed tiles are used to produce more variations (default false) */
+			bool m_rotate {};               /*! rotate: Whether the tiles in this set can be rotated in 90 degree increments (default false) */
+			bool m_vflip {};                /*! vflip: Whether the tiles in this set can be flipped vertically (default false) */
+	};
+
+	Transformations::Transformations(IJson &json)
+	{
+		parse(json);
+	}
+
+	bool Transformations::parse(IJson &json)
+	{
+		if(json.count("hflip") > 0) m_hflip = json["hflip"].get<bool>(); //Optional
+		if(json.count("preferuntransformed") > 0) m_preferuntransformed = json["preferuntransformed"].get<bool>(); //Optional
+		if(json.count("rotate") > 0) m_rotate = json["rotate"].get<bool>(); //Optional
+		if(json.count("vflip") > 0) m_vflip = json["vflip"].get<bool>(); //Optional
+
+		return true;
+	}
+
+	/*!
+	 *
+	 * @return hflip: Whether the tiles in this set can be flipped horizontally (default false)
+	 */
+	bool Transformations::allowHflip() const
+	{
+		return m_hflip;
+	}
+
+	/*!
+	 *
+	 * @return preferuntransformed: Whether untransformed tiles remain preferred, otherwise transformed tiles are used to produce more variations (default false)
+	 */
+	bool Transformations::allowPreferuntransformed() const
+	{
+		return m_preferuntransformed;
+	}
+
+	/*!
+	 *
+	 * @return rotate: Whether the tiles in this set can be rotated in 90 degree increments (default false)
+	 */
+	bool Transformations::allowRotation() const
+	{
+		return m_rotate;
+	}
+
+	/*!
+	 *
+	 * @return vflip: Whether the tiles in this set can be flipped vertically (default false)
+	 */
+	bool Transformations::allowVflip() const
+	{
+		return m_vflip;
+	}
+}
+
+#endif //TILESON_TRANSFORMATIONS_HPP
+
+/*** End of inlined file: Transformations.hpp ***/
+
+
+/*** Start of inlined file: WangSet.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_WANGSET_HPP
+#define TILESON_WANGSET_HPP
+
+//#include "../external/json.hpp"
+
+/*** Start of inlined file: WangColor.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_WANGCOLOR_HPP
+#define TILESON_WANGCOLOR_HPP
+
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class WangColor
+	{
+		friend class Tileset;
+		friend class MapSnapshot;
+		public:
+			inline WangColor() = default;
+			inline explicit WangColor(IJson &json, tson::Map *map);
+			inline bool parse(IJson &json, tson::Map *map);
+
+			[[nodiscard]] inline const Colori &getColor() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline float getProbability() const;
+			[[nodiscard]] inline int getTile() const;
+
+			inline PropertyCollection &getProperties();
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+
+		private:
+			tson::Colori      m_color;              /*! 'color': Hex-formatted color (#RRGGBB or #AARRGGBB) */
+			std::string       m_name;               /*! 'name': Name of the Wang color */
+			float             m_probability{};      /*! 'probability': Probability used when randomizing */
+			int               m_tile{};             /*! 'tile': Local ID of tile representing the Wang color */
+
+			//New in Tiled v1.5
+			tson::PropertyCollection     m_properties; 	  /*! 'properties': A list of properties (name, value, type). */
+			tson::Map *                  m_map;
+			std::string                  m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
+			std::shared_ptr<tson::TiledClass> m_class {};
+
+	};
+}
+
+tson::WangColor::WangColor(IJson &json, tson::Map *map)
+{
+	parse(json, map);
+}
+
+bool tson::WangColor::parse(IJson &json, tson::Map *map)
+{
+	m_map = map;
+	bool allFound = true;
+
+	if(json.count("color") > 0) m_color = tson::Colori(json["color"].get<std::string>()); else allFound = false;
+	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
+	if(json.count("probability") > 0) m_probability = json["probability"].get<float>(); else allFound = false;
+	if(json.count("tile") > 0) m_tile = json["tile"].get<int>(); else allFound = false;
+	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+
+	if(json.count("properties") > 0 && json["properties"].isArray())
+	{
+		auto &properties = json.array("properties");
+		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item); });
+	}
+
+	return allFound;
+}
+
+/*!
+ * 'color': Color object created from hex-formatted string (#RRGGBB or #AARRGGBB)
+ * @return
+ */
+const tson::Colori &tson::WangColor::getColor() const
+{
+	return m_color;
+}
+
+/*!
+ * 'name': Name of the Wang color
+ * @return
+ */
+const std::string &tson::WangColor::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * 'probability': Probability used when randomizing
+ * @return
+ */
+float tson::WangColor::getProbability() const
+{
+	return m_probability;
+}
+
+/*!
+ * 'tile': Local ID of tile representing the Wang color
+ * @return
+ */
+int tson::WangColor::getTile() const
+{
+	return m_tile;
+}
+
+/*!
+ * New property in Tiled v1.5 when data is contained in 'colors' of a wangset
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::WangColor::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+ * @tparam T The template value
+ * @param name Name of the property
+ * @return The actual value, if it exists. Otherwise: The default value of the type.
+ */
+template<typename T>
+T tson::WangColor::get(const std::string &name)
+{
+	return m_properties.getValue<T>(name);
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::WangColor::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+
+	return nullptr;
+}
+
+const std::string &tson::WangColor::getClassType() const
+{
+	return m_classType;
+}
+
+#endif //TILESON_WANGCOLOR_HPP
+
+/*** End of inlined file: WangColor.hpp ***/
+
+
+
+/*** Start of inlined file: WangTile.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_WANGTILE_HPP
+#define TILESON_WANGTILE_HPP
+
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class WangTile
+	{
+		friend class MapSnapshot;
+		public:
+			inline WangTile() = default;
+			inline explicit WangTile(IJson &json);
+			inline bool parse(IJson &json);
+
+			[[nodiscard]] inline bool hasDFlip() const;
+			[[nodiscard]] inline bool hasHFlip() const;
+			[[nodiscard]] inline uint32_t getTileid() const;
+			[[nodiscard]] inline bool hasVFlip() const;
+
+			[[nodiscard]] inline const std::vector<uint32_t> &getWangIds() const;
+
+		private:
+			bool                    m_dflip{};     /*! 'dflip': Tile is flipped diagonally */
+			bool                    m_hflip{};     /*! 'hflip': Tile is flipped horizontally */
+			uint32_t                m_tileid{};    /*! 'tileid': Local ID of tile */
+			bool                    m_vflip{};     /*! 'vflip': Tile is flipped vertically */
+			std::vector<uint32_t>   m_wangId;      /*! 'wangid': Array of Wang color indexes (uchar[8])*/
+	};
+}
+
+tson::WangTile::WangTile(IJson &json)
+{
+	parse(json);
+}
+
+/*!
+ * Parses a wang tile from Tiled json.
+ * @param json A Tiled json file
+ * @return true if all mandatory fields were found. False otherwise.
+ */
+bool tson::WangTile::parse(IJson &json)
+{
+	bool allFound = true;
+
+	if(json.count("dflip") > 0) m_dflip = json["dflip"].get<bool>(); //Removed in Tiled v1.5 and is now optional
+	if(json.count("hflip") > 0) m_hflip = json["hflip"].get<bool>(); //Removed in Tiled v1.5 and is now optional
+	if(json.count("vflip") > 0) m_vflip = json["vflip"].get<bool>(); //Removed in Tiled v1.5 and is now optional
+
+	if(json.count("tileid") > 0) m_tileid = json["tileid"].get<uint32_t>(); else allFound = false;
+	if(json.count("wangid") > 0 && json["wangid"].isArray())
+	{
+		auto &wangid = json.array("wangid");
+		std::for_each(wangid.begin(), wangid.end(), [&](std::unique_ptr<IJson> &item) { m_wangId.emplace_back(item->get<uint32_t>()); });
+	}
+
+	return allFound;
+}
+
+/*!
+ * 'dflip': Tile is flipped diagonally
+ *
+ * NB! This property got removed in Tiled v1.5
+ * @return
+ */
+bool tson::WangTile::hasDFlip() const
+{
+	return m_dflip;
+}
+
+/*!
+ * 'hflip': Tile is flipped horizontally
+ *
+ * NB! This property got removed in Tiled v1.5
+ * @return
+ */
+bool tson::WangTile::hasHFlip() const
+{
+	return m_hflip;
+}
+
+/*!
+ * 'tileid': Local ID of tile
+ * @return
+ */
+uint32_t tson::WangTile::getTileid() const
+{
+	return m_tileid;
+}
+
+/*!
+ * 'vflip': Tile is flipped vertically
+ *
+ * NB! This property got removed in Tiled v1.5
+ * @return
+ */
+bool tson::WangTile::hasVFlip() const
+{
+	return m_vflip;
+}
+
+/*!
+ * 'wangid': Array of Wang color indexes (uchar[8])
+ * @return
+ */
+const std::vector<uint32_t> &tson::WangTile::getWangIds() const
+{
+	return m_wangId;
+}
+
+#endif //TILESON_WANGTILE_HPP
+
+/*** End of inlined file: WangTile.hpp ***/
+
+
+/*** Start of inlined file: WangLookup.hpp ***/
+#ifndef TILESON_WANGLOOKUP_HPP
+#define TILESON_WANGLOOKUP_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+namespace tson
+{
+	/*!
+	 * The tiles matching a packed wang id. Gids include the flip flags of the transformation.
+	 */
+	class WangCandidates
+	{
+		public:
+			/*! First gid. nullptr when nothing matches */
+			const uint32_t *gids {nullptr};
+			/*! Number of gids */
+			uint32_t count {0};
+
+			[[nodiscard]] inline bool empty() const { return count == 0; }
+	};
+
+	/*!
+	 * A hash from wang ids to tiles, created by tson::Tileset for each of its tson::WangSet.
+	 *
+	 * A wang id is packed into 64 bits: one byte per color, in the order of Tiled (top, top-right, right, bottom-right, bottom,
+	 * bottom-left, left, top-left), with the top in the lowest byte. When the tileset allows transformations, the flipped and rotated
+	 * variants of every wang tile are added as well, with the flip flags in their gid.
+	 */
+	class WangLookup
+	{
+		public:
+			inline WangLookup() = default;
+
+			inline void build(const std::vector<tson::WangTile> &wangTiles, const tson::Transformations &transformations, uint32_t firstgid);
+
+			[[nodiscard]] inline tson::WangCandidates find(uint64_t wangId) const;
+			[[nodiscard]] inline uint64_t getWangId(uint32_t gid) const;
+			[[nodiscard]] inline const std::vector<uint64_t> &getWangIds() const;
+			[[nodiscard]] inline bool usesCorners() const;
+			[[nodiscard]] inline bool usesEdges() const;
+			[[nodiscard]] inline size_t size() const;
+
+			inline static uint64_t Pack(const std::vector<uint32_t> &wangId);
+			inline static uint8_t GetColor(uint64_t wangId, int index);
+			inline static uint64_t Transform(uint64_t wangId, uint32_t flipFlags);
+
+			static constexpr uint64_t CornerMask = 0xFF00FF00FF00FF00;  /*! The bytes of the corners */
+			static constexpr uint64_t EdgeMask = 0x00FF00FF00FF00FF;    /*! The bytes of the edges */
+
+		private:
+			static constexpr uint32_t FLIP_FLAGS = FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG;
+
+			class Entry
+			{
+				public:
+					uint32_t first {};          /*! Index of the first gid in m_gids */
+					uint32_t count {};
+					uint32_t untransformed {};  /*! Number of gids without flip flags, which come first */
+			};
+
+			inline static uint64_t Permute(uint64_t wangId, const int (&sourceIndices)[8]);
+
+			bool                                    m_preferUntransformed {false};
+			std::unordered_map<uint64_t, Entry>     m_entries;
+			std::vector<uint64_t>                   m_wangIds;      /*! Every wang id in m_entries */
+			std::vector<uint32_t>                   m_gids;
+			std::unordered_map<uint32_t, uint64_t>  m_tileWangIds;  /*! Gid without flip flags -> wang id */
+	};
+
+	/*!
+	 * Creates the lookup. Wang ids with one or more colors set only match tiles having exactly the same colors.
+	 * @param wangTiles The wang tiles of a wang set
+	 * @param transformations The transformations allowed by the tileset
+	 * @param firstgid The first gid of the tileset
+	 */
+	void WangLookup::build(const std::vector<tson::WangTile> &wangTiles, const tson::Transformations &transformations, uint32_t firstgid)
+	{
+		m_entries.clear();
+		m_wangIds.clear();
+		m_gids.clear();
+		m_tileWangIds.clear();
+		m_preferUntransformed = transformations.allowPreferuntransformed();
+
+		//Flip flags of every allowed transformation. Rotations by 90 degrees are diagonal flips combined with a horizontal or vertical flip.
+		std::vector<uint32_t> flags {0};
+		bool const hflip = transformations.allowHflip();
+		bool const vflip = transformations.allowVflip();
+		if(transformations.allowRotation())
+		{
+			flags.insert(flags.end(), {FLIPPED_DIAGONALLY_FLAG | FLIPPED_HORIZONTALLY_FLAG, FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG,
+									   FLIPPED_DIAGONALLY_FLAG | FLIPPED_VERTICALLY_FLAG});
+			if(hflip || vflip)
+				flags.insert(flags.end(), {FLIPPED_HORIZONTALLY_FLAG, FLIPPED_VERTICALLY_FLAG, FLIPPED_DIAGONALLY_FLAG,
+										   FLIPPED_DIAGONALLY_FLAG | FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG});
+		}
+		else
+		{
+			if(hflip)
+				flags.push_back(FLIPPED_HORIZONTALLY_FLAG);
+			if(vflip)
+				flags.push_back(FLIPPED_VERTICALLY_FLAG);
+			if(hflip && vflip)
+				flags.push_back(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG);
+		}
+
+		//(wang id, gid) of every variant, grouped by wang id with the untransformed tiles first
+		std::vector<std::pair<uint64_t, uint32_t>> variants;
+		variants.reserve(wangTiles.size() * flags.size());
+		for(const auto &wangTile : wangTiles)
+		{
+			uint64_t const wangId = Pack(wangTile.getWangIds());
+			if(wangId == 0)
+				continue;
+
+			uint32_t const gid = firstgid + wangTile.getTileid();
+			m_tileWangIds[gid] = wangId;
+			for(uint32_t flag : flags)
+				variants.emplace_back(Transform(wangId, flag), gid | flag);
+		}
+		std::stable_sort(variants.begin(), variants.end(), [](const auto &a, const auto &b)
+		{
+			if(a.first != b.first)
+				return a.first < b.first;
+			return (a.second & FLIP_FLAGS) == 0 && (b.second & FLIP_FLAGS) != 0;
+		});
+
+		m_gids.reserve(variants.size());
+		for(const auto &[wangId, gid] : variants)
+		{
+			auto [entry, inserted] = m_entries.try_emplace(wangId);
+			if(inserted)
+			{
+				entry->second.first = static_cast<uint32_t>(m_gids.size());
+				m_wangIds.push_back(wangId);
+			}
+
+			//Symmetric tiles look the same with different flags. Only the first one is kept.
+			uint32_t const tileGid = gid & ~FLIP_FLAGS;
+			const uint32_t *begin = m_gids.data() + entry->second.first;
+			if(std::any_of(begin, begin + entry->second.count, [&](uint32_t other) { return (other & ~FLIP_FLAGS) == tileGid; }))
+				continue;
+
+			m_gids.push_back(gid);
+			++entry->second.count;
+			if(gid == tileGid)
+				++entry->second.untransformed;
+		}
+	}
+
+	/*!
+	 * Gets the tiles that match a wang id exactly.
+	 * When the tileset prefers untransformed tiles, transformed variants are only given when no untransformed tile matches.
+	 * @param wangId A packed wang id
+	 */
+	tson::WangCandidates WangLookup::find(uint64_t wangId) const
+	{
+		auto it = m_entries.find(wangId);
+		if(it == m_entries.end())
+			return {};
+
+		const Entry &entry = it->second;
+		uint32_t const count = (m_preferUntransformed && entry.untransformed > 0) ? entry.untransformed : entry.count;
+		return {m_gids.data() + entry.first, count};
+	}
+
+	/*!
+	 * Gets the wang id of a gid, as it looks with its flip flags.
+	 * @param gid Gid with or without flip flags
+	 * @return The packed wang id. 0 if the gid is not part of the wang set.
+	 */
+	uint64_t WangLookup::getWangId(uint32_t gid) const
+	{
+		uint32_t const flags = gid & FLIP_FLAGS;
+		auto it = m_tileWangIds.find(gid & ~flags);
+		return (it == m_tileWangIds.end()) ? 0 : Transform(it->second, flags);
+	}
+
+	/*!
+	 * Every distinct wang id, including those of transformed tiles
+	 */
+	const std::vector<uint64_t> &WangLookup::getWangIds() const
+	{
+		return m_wangIds;
+	}
+
+	/*!
+	 * true if any tile has a corner color
+	 */
+	bool WangLookup::usesCorners() const
+	{
+		return std::any_of(m_wangIds.begin(), m_wangIds.end(), [](uint64_t wangId) { return (wangId & CornerMask) != 0; });
+	}
+
+	/*!
+	 * true if any tile has an edge color
+	 */
+	bool WangLookup::usesEdges() const
+	{
+		return std::any_of(m_wangIds.begin(), m_wangIds.end(), [](uint64_t wangId) { return (wangId & EdgeMask) != 0; });
+	}
+
+	/*!
+	 * Number of distinct wang ids
+	 */
+	size_t WangLookup::size() const
+	{
+		return m_wangIds.size();
+	}
+
+	/*!
+	 * Packs the 'wangid' of a tson::WangTile into 64 bits. Colors above 255 are not supported by Tiled, and are cut off.
+	 */
+	uint64_t WangLookup::Pack(const std::vector<uint32_t> &wangId)
+	{
+		uint64_t packed = 0;
+		for(size_t i = 0; i < wangId.size() && i < 8; ++i)
+			packed |= static_cast<uint64_t>(wangId[i] & 0xFF) << (8 * i);
+		return packed;
+	}
+
+	/*!
+	 * Gets one color of a packed wang id.
+	 * @param index 0 = top, 1 = top-right ... 7 = top-left
+	 */
+	uint8_t WangLookup::GetColor(uint64_t wangId, int index)
+	{
+		return static_cast<uint8_t>(wangId >> (8 * index));
+	}
+
+	/*!
+	 * Gets the wang id of a tile as it looks when drawn with flip flags. Tiled applies the diagonal flip first,
+	 * then the horizontal flip, and then the vertical flip.
+	 */
+	uint64_t WangLookup::Transform(uint64_t wangId, uint32_t flipFlags)
+	{
+		static constexpr int Diagonal[8] {6, 5, 4, 3, 2, 1, 0, 7};
+		static constexpr int Horizontal[8] {0, 7, 6, 5, 4, 3, 2, 1};
+		static constexpr int Vertical[8] {4, 3, 2, 1, 0, 7, 6, 5};
+		if((flipFlags & FLIPPED_DIAGONALLY_FLAG) != 0)
+			wangId = Permute(wangId, Diagonal);
+		if((flipFlags & FLIPPED_HORIZONTALLY_FLAG) != 0)
+			wangId = Permute(wangId, Horizontal);
+		if((flipFlags & FLIPPED_VERTICALLY_FLAG) != 0)
+			wangId = Permute(wangId, Vertical);
+		return wangId;
+	}
+
+	/*!
+	 * Byte i of the result is byte sourceIndices[i] of the input
+	 */
+	uint64_t WangLookup::Permute(uint64_t wangId, const int (&sourceIndices)[8])
+	{
+		uint64_t result = 0;
+		for(int i = 0; i < 8; ++i)
+			result |= static_cast<uint64_t>(GetColor(wangId, sourceIndices[i])) << (8 * i);
+		return result;
+	}
+}
+
+#endif //TILESON_WANGLOOKUP_HPP
+
+/*** End of inlined file: WangLookup.hpp ***/
+
+namespace tson
+{
+	class WangSet
+	{
+		friend class Tileset;
+		friend class MapSnapshot;
+		public:
+			inline WangSet() = default;
+			inline explicit WangSet(IJson &json, tson::Map *map);
+			inline bool parse(IJson &json, tson::Map *map);
+
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline int getTile() const;
+
+			[[nodiscard]] inline const std::vector<tson::WangTile> &getWangTiles() const;
+			[[nodiscard]] inline const std::vector<tson::WangColor> &getCornerColors() const;
+			[[nodiscard]] inline const std::vector<tson::WangColor> &getEdgeColors() const;
+
+			inline tson::WangColor * getColor(const std::string &name);
+			inline const std::vector<tson::WangColor> &getColors() const;
+			inline PropertyCollection &getProperties();
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+
+			[[nodiscard]] inline const tson::WangLookup &getLookup() const;
+			inline void buildLookup(const tson::Transformations &transformations, uint32_t firstgid);
+
+		private:
+
+			inline bool parseTiled15Props(IJson &json);
+
+			std::string                  m_name;          /*! 'name': Name of the Wang set */
+			int                          m_tile{};        /*! 'tile': Local ID of tile representing the Wang set */
+			std::vector<tson::WangTile>  m_wangTiles;     /*! 'wangtiles': Array of Wang tiles */
+			std::vector<tson::WangColor> m_cornerColors;  /*! 'cornercolors': Array of Wang colors */
+			std::vector<tson::WangColor> m_edgeColors;    /*! 'edgecolors': Array of Wang colors */
+			tson::PropertyCollection     m_properties; 	  /*! 'properties': A list of properties (name, value, type). */
+
+			//Tiled v1.5
+			std::vector<tson::WangColor> m_colors;        /*! 'colors': */
+
+			tson::Map *                  m_map;
+			std::string                  m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
+			tson::WangLookup             m_lookup;                    /*! Wang id -> tiles. Built by the tileset */
+			std::shared_ptr<tson::TiledClass> m_class {};
+
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T tson::WangSet::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+}
+
+tson::WangSet::WangSet(IJson &json, tson::Map *map)
+{
+	parse(json, map);
+}
+
+bool tson::WangSet::parse(IJson &json, tson::Map *map)
+{
+	m_map = map;
+	bool allFound = true;
+
+	if(json.count("tile") > 0) m_tile = json["tile"].get<int>(); else allFound = false;
+	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
+
+	//More advanced data
+	if(json.count("wangtiles") > 0 && json["wangtiles"].isArray())
+	{
+		auto &wangtiles = json.array("wangtiles");
+		std::for_each(wangtiles.begin(), wangtiles.end(), [&](std::unique_ptr<IJson> &item) { m_wangTiles.emplace_back(*item); });
+	}
+	if(json.count("cornercolors") > 0 && json["cornercolors"].isArray())
+	{
+		auto &cornercolors = json.array("cornercolors");
+		std::for_each(cornercolors.begin(), cornercolors.end(), [&](std::unique_ptr<IJson> &item) { m_cornerColors.emplace_back(*item, m_map); });
+	}
+	if(json.count("edgecolors") > 0 && json["edgecolors"].isArray())
+	{
+		auto &edgecolors = json.array("edgecolors");
+		std::for_each(edgecolors.begin(), edgecolors.end(), [&](std::unique_ptr<IJson> &item) { m_edgeColors.emplace_back(*item, m_map); });
+	}
+	if(json.count("properties") > 0 && json["properties"].isArray())
+	{
+		auto &properties = json.array("properties");
+		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item); });
+	}
+
+	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+
+	if(!parseTiled15Props(json))
+		allFound = false;
+
+	return allFound;
+}
+
+/*!
+ * Parsing data related to Tiled v1.5 changes
+ * @param json The json containing data
+ * @return Returns true if success
+ */
+
+bool tson::WangSet::parseTiled15Props(tson::IJson &json)
+{
+	if(json.count("colors") > 0 && json["colors"].isArray())
+	{
+		auto &colors = json.array("colors");
+		std::for_each(colors.begin(), colors.end(), [&](std::unique_ptr<IJson> &item) { m_colors.emplace_back(*item, m_map); });
+	}
+	return true;
+}
+
+/*!
+ * 'name': Name of the Wang set
+ * @return
+ */
+const std::string &tson::WangSet::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * 'tile': Local ID of tile representing the Wang set
+ * @return
+ */
+int tson::WangSet::getTile() const
+{
+	return m_tile;
+}
+
+/*!
+ * 'wangtiles': Array of Wang tiles
+ * @return
+ */
+const std::vector<tson::WangTile> &tson::WangSet::getWangTiles() const
+{
+	return m_wangTiles;
+}
+
+/*!
+ * 'cornercolors': Array of Wang colors
+ * @return
+ */
+const std::vector<tson::WangColor> &tson::WangSet::getCornerColors() const
+{
+	return m_cornerColors;
+}
+
+/*!
+ * 'edgecolors': Array of Wang colors
+ * @return
+ */
+const std::vector<tson::WangColor> &tson::WangSet::getEdgeColors() const
+{
+	return m_edgeColors;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::WangSet::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::WangSet::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+
+	return nullptr;
+}
+
+/*!
+ * Get Wangset colors (new in Tiled v1.5)
+ * @return
+ */
+const std::vector<tson::WangColor> &tson::WangSet::getColors() const
+{
+	return m_colors;
+}
+
+/*!
+ * NB! Will only work with maps created/modified by Tiled v1.5 or later!
+ * Gets a color from a wangset by its name.
+ *
+ * @param name 'name' of WangColor
+ * @return The WangColor with the given name or nullptr if it doesn't exist.
+ */
+tson::WangColor *tson::WangSet::getColor(const std::string &name)
+{
+	auto color = std::find_if(m_colors.begin(), m_colors.end(), [&](const auto &c) { return c.getName() == name; });
+
+	if(color != m_colors.end())
+		return &color.operator*();
+
+	return nullptr;
+}
+
+const std::string &tson::WangSet::getClassType() const
+{
+	return m_classType;
+}
+
+/*!
+ * A hash from packed wang ids to the tiles (and their allowed transformations) having them.
+ * Built by tson::Tileset when the tileset is loaded.
+ */
+const tson::WangLookup &tson::WangSet::getLookup() const
+{
+	return m_lookup;
+}
+
+/*!
+ * Creates the lookup of getLookup(). Called by tson::Tileset after parsing.
+ * @param transformations The transformations allowed by the tileset
+ * @param firstgid The first gid of the tileset
+ */
+void tson::WangSet::buildLookup(const tson::Transformations &transformations, uint32_t firstgid)
+{
+	m_lookup.build(m_wangTiles, transformations, firstgid);
+}
+
+#endif //TILESON_WANGSET_HPP
+
+/*** End of inlined file: WangSet.hpp ***/
+
+
+/*** Start of inlined file: Tile.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_TILE_HPP
+#define TILESON_TILE_HPP
+
+//#include "../external/json.hpp"
+
+
+/*** Start of inlined file: Frame.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_FRAME_HPP
+#define TILESON_FRAME_HPP
+
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class Frame
+	{
+		public:
+			inline Frame() = default;
+			inline Frame(int duration, uint32_t tileId);
+			inline explicit Frame(IJson &json);
+
+			inline bool parse(IJson &json);
+
+			[[nodiscard]] inline int getDuration() const;
+			[[nodiscard]] inline uint32_t getTileId() const;
+
+		private:
+			int m_duration {};  /*! 'duration': Frame duration in milliseconds */
+			uint32_t m_tileId {};    /*! 'tileid': Local tile ID representing this frame */
+	};
+}
+
+/*!
+ *
+ * @param duration duration in milliseconds
+ * @param tileId TileId
+ */
+tson::Frame::Frame(int duration, uint32_t tileId) : m_duration {duration}, m_tileId {tileId}
+{
+
+}
+
+/*!
+ * Parses frame data from json
+ * @param json
+ */
+tson::Frame::Frame(IJson &json)
+{
+	parse(json);
+}
+
+/*!
+ * Parses frame data from json
+ * @param json
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Frame::parse(IJson &json)
+{
+	bool allFound = true;
+
+	if(json.count("duration") > 0) m_duration = json["duration"].get<int>(); else allFound = false;
+	if(json.count("tileid") > 0) m_tileId = json["tileid"].get<uint32_t>() + 1; else allFound = false;
+
+	return allFound;
+}
+
+/*!
+ * 'duration': Frame duration in milliseconds
+ * @return Duration in milliseconds
+ */
+int tson::Frame::getDuration() const
+{
+	return m_duration;
+}
+
+/*!
+ * 'tileid': Local tile ID representing this frame
+ * @return tile id
+ */
+uint32_t tson::Frame::getTileId() const
+{
+	return m_tileId;
+}
+
+#endif //TILESON_FRAME_HPP
+
+/*** End of inlined file: Frame.hpp ***/
+
+
+/*** Start of inlined file: Animation.hpp ***/
+//
+// Created by robin on 21.05.2021.
+//
+
+#ifndef TILESON_ANIMATION_HPP
+#define TILESON_ANIMATION_HPP
+
+#include <cmath>
+#include <algorithm>
+
+namespace tson
+{
+	class Animation
+	{
+		public:
+			inline Animation() = default;
+			inline Animation(const std::vector<tson::Frame> &frames) : m_frames {frames} { calculateFrameEnds(); };
+
+			inline void update(float timeDeltaMs);
+			inline void reset();
+			[[nodiscard]] inline uint32_t frameAt(double timeMs) const;
+
+			inline void setFrames(const std::vector<tson::Frame> &frames);
+			inline void setCurrentFrame(uint32_t currentFrame);
+			inline void setTimeDelta(float timeDelta);
+
+			inline const std::vector<tson::Frame> &getFrames() const;
+			inline const tson::Frame *getCurrentFrame() const;
+			inline uint32_t getCurrentFrameNumber() const;
+			inline uint32_t getCurrentTileId() const;
+			inline float getTimeDelta() const;
+			[[nodiscard]] inline uint32_t getTotalDuration() const;
+
+			inline bool any() const;
+			inline size_t size() const;
+
+		private:
+			inline void calculateFrameEnds();
+			inline uint32_t findFrame(double loopTimeMs) const;
+
+			std::vector<tson::Frame> m_frames;
+			std::vector<uint32_t> m_frameEnds;      /*! Prefix sum of the frame durations: the time each frame ends, from the start of the animation */
+			uint32_t m_currentFrame {0};
+			float m_timeDelta {0};
+	};
+
+	const std::vector<tson::Frame> &Animation::getFrames() const
+	{
+		return m_frames;
+	}
+
+	/*!
+	 * Resets the current frame and time delta to 0.
+	 */
+	void Animation::reset()
+	{
+		m_currentFrame = 0;
+		m_timeDelta = 0.f;
+	}
+
+	/*!
+	 * Gets the current frame or nullptr if no frame is found.
+	 * @return
+	 */
+	const tson::Frame *Animation::getCurrentFrame() const
+	{
+		return (m_frames.size() == 0 || m_currentFrame >= m_frames.size()) ? nullptr : &m_frames.at(m_currentFrame);
+	}
+
+	size_t Animation::size() const
+	{
+		return m_frames.size();
+	}
+
+	/*!
+	 * Update animation based on the time since the last update.
+	 * Any number of frames may be skipped, so animations stay in sync even with very large time deltas.
+	 * O(log n) of the number of frames.
+	 * @param timedeltaMs Time in milliseconds
+	 */
+	void Animation::update(float timeDeltaMs)
+	{
+		const tson::Frame *frame = getCurrentFrame();
+		uint32_t const total = getTotalDuration();
+		if(frame == nullptr || total == 0 || timeDeltaMs <= 0.f)
+			return;
+
+		//Time since the start of the animation, limited to a single loop
+		uint32_t const frameStart = m_frameEnds[m_currentFrame] - static_cast<uint32_t>(std::max(frame->getDuration(), 0));
+		double const loopTime = std::fmod(static_cast<double>(frameStart) + static_cast<double>(m_timeDelta) + static_cast<double>(timeDeltaMs),
+										  static_cast<double>(total));
+
+		m_currentFrame = findFrame(loopTime);
+		uint32_t const newFrameStart = m_frameEnds[m_currentFrame] - static_cast<uint32_t>(std::max(m_frames[m_currentFrame].getDuration(), 0));
+		m_timeDelta = static_cast<float>(loopTime - static_cast<double>(newFrameStart));
+	}
+
+	/*!
+	 * Gets the frame number at any point in time, where 0 is the start of the animation.
+	 * Does not change the state of the animation. O(log n) of the number of frames.
+	 * @param timeMs Time in milliseconds since the start of the animation
+	 * @return The frame number at the given time. 0 if there are no frames.
+	 */
+	uint32_t Animation::frameAt(double timeMs) const
+	{
+		uint32_t const total = getTotalDuration();
+		if(total == 0 || timeMs <= 0.0)
+			return 0;
+
+		return findFrame(std::fmod(timeMs, static_cast<double>(total)));
+	}
+
+	/*!
+	 * Sum of the duration of all frames in milliseconds
+	 */
+	uint32_t Animation::getTotalDuration() const
+	{
+		return (m_frameEnds.empty()) ? 0 : m_frameEnds.back();
+	}
+
+	void Animation::calculateFrameEnds()
+	{
+		m_frameEnds.resize(m_frames.size());
+		uint32_t end = 0;
+		for(size_t i = 0; i < m_frames.size(); ++i)
+		{
+			end += static_cast<uint32_t>(std::max(m_frames[i].getDuration(), 0));
+			m_frameEnds[i] = end;
+		}
+	}
+
+	/*!
+	 * The first frame ending after the given time. Frames with no duration are never selected.
+	 */
+	uint32_t Animation::findFrame(double loopTimeMs) const
+	{
+		auto iter = std::upper_bound(m_frameEnds.begin(), m_frameEnds.end(), loopTimeMs,
+									 [](double time, uint32_t end) { return time < static_cast<double>(end); });
+		if(iter == m_frameEnds.end())
+			return 0;
+
+		return static_cast<uint32_t>(iter - m_frameEnds.begin());
+	}
+
+	float Animation::getTimeDelta() const
+	{
+		return m_timeDelta;
+	}
+
+	uint32_t Animation::getCurrentFrameNumber() const
+	{
+		return m_currentFrame;
+	}
+
+	uint32_t Animation::getCurrentTileId() const
+	{
+		return (getCurrentFrame() != nullptr) ? getCurrentFrame()->getTileId() : 0;
+	}
+
+	void Animation::setFrames(const std::vector<tson::Frame> &frames)
+	{
+		m_frames = frames;
+		calculateFrameEnds();
+	}
+
+	void Animation::setCurrentFrame(uint32_t currentFrame)
+	{
+		m_currentFrame = currentFrame;
+	}
+
+	void Animation::setTimeDelta(float timeDelta)
+	{
+		m_timeDelta = timeDelta;
+	}
+
+	/*!
+	 * True if any frames exists, false otherwise
+	 * @return
+	 */
+	bool Animation::any() const
+	{
+		return m_frames.size() > 0;
+	}
+}
+
+#endif //TILESON_ANIMATION_HPP
+
+/*** End of inlined file: Animation.hpp ***/
+
+namespace tson
+{
+	class Tileset;
+	class TiledClass;
+
+	class Tile
+	{
+		friend class MapSnapshot;
+		public:
+			inline Tile() = default;
+			inline Tile(IJson &json, tson::Tileset *tileset, tson::Map *map);
+			inline static Tile CreateFlippedTile(uint32_t gid, tson::Map *map); // v1.2.0
+			inline static Tile CreateMissingTile(uint32_t id, tson::Tileset* tileset, tson::Map* map);
+			inline bool parse(IJson &json, tson::Tileset *tileset, tson::Map *map);
+			inline bool parseId(IJson &json);
+
+			[[nodiscard]] inline uint32_t getId() const;
+			[[nodiscard]] inline const fs::path &getImage() const;
+			[[nodiscard]] inline const Vector2i &getImageSize() const;
+			[[nodiscard]] inline const std::string &getType() const;
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+
+			//[[nodiscard]] inline const std::vector<tson::Frame> &getAnimation() const;
+			[[nodiscard]] inline tson::Animation &getAnimation();
+			[[nodiscard]] inline Layer &getObjectgroup();
+			[[nodiscard]] inline PropertyCollection &getProperties();
+			[[nodiscard]] inline const std::vector<int> &getTerrain() const;
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			//v1.2.0-stuff
+			inline void setProperties(const tson::PropertyCollection &properties);
+
+			[[nodiscard]] inline tson::Tileset * getTileset() const;
+			[[nodiscard]] inline tson::Map * getMap() const;
+			[[nodiscard]] inline const tson::Rect &getDrawingRect() const;
+			[[nodiscard]] inline const Rect &getSubRectangle() const;
+
+			inline const tson::Vector2f getPosition(const std::tuple<int, int> &tileDataPos);
+			inline const tson::Vector2i getPositionInTileUnits(const std::tuple<int, int> &tileDataPos);
+			[[nodiscard]] inline const tson::Vector2i getTileSize() const;                       /*! Declared in tileson_forward.hpp */
+
+			[[nodiscard]] inline TileFlipFlags getFlipFlags() const;
+			inline bool hasFlipFlags(TileFlipFlags flags);
+			[[nodiscard]] inline uint32_t getGid() const;
+
+			inline void addTilesetAndPerformCalculations(tson::Tileset *tileset); //v1.2.0
+
+		private:
+			tson::Animation                  m_animation{};      /*! 'animation': Array of Frames */
+			uint32_t                         m_id {};            /*! 'id': Local ID of the tile */
+
+			fs::path                         m_image;            /*! 'image': Image representing this tile (optional)*/
+
+			tson::Vector2i                   m_imageSize;        /*! x = 'imagewidth' and y = 'imageheight': in pixels */
+			tson::Layer                      m_objectgroup; 	 	/*! 'objectgroup': Layer with type objectgroup (optional) */
+			tson::PropertyCollection         m_properties; 	    /*! 'properties': A list of properties (name, value, type). */
+			std::vector<int>                 m_terrain;          /*! 'terrain': Index of terrain for each corner of tile */
+			std::string                      m_type;             /*! 'type': The type of the tile (optional) */
+
+			//v1.2.0-stuff
+			uint32_t                    m_gid {};                                    /*! id without flip flags */
+			tson::Tileset *             m_tileset;                                   /*! A pointer to the tileset where this Tile comes from */
+			tson::Map *                 m_map;                                       /*! A pointer to the map where this tile is contained */
+			tson::Rect                  m_drawingRect;                               /*! A rect that shows which part of the tileset that is used for this tile */
+			tson::Rect                  m_subRect;                                   /*! Tiled 1.9: Contains the newly added sub-rectangle variables: 'x', 'y', 'width' and 'height'*/
+			tson::TileFlipFlags         m_flipFlags = TileFlipFlags::None;           /*! Resolved using bit 32, 31 and 30 from gid */
+			inline void performDataCalculations();                                   /*! Declared in tileson_forward.hpp - Calculate all the values used in the tile class. */
+			inline void manageFlipFlagsByIdThenRemoveFlags(uint32_t &id);
+			friend class Layer;
+			friend class Tileset;
+			std::shared_ptr<tson::TiledClass> m_class {};
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T tson::Tile::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+}
+
+tson::Tile::Tile(IJson &json, tson::Tileset *tileset, tson::Map *map)
+{
+	parse(json, tileset, map);
+}
+
+/*!
+ * For flip flagged tiles, tilesets must be resolved later.
+ * @param tileset
+ */
+void tson::Tile::addTilesetAndPerformCalculations(tson::Tileset *tileset)
+{
+	m_tileset = tileset;
+	performDataCalculations();
+}
+
+/*!
+ * 'id': Local ID of the tile
+ * @return
+ */
+uint32_t tson::Tile::getId() const
+{
+	return m_id;
+}
+
+/*!
+ * 'image': Image representing this tile (optional)
+ * @return
+ */
+
+const fs::path &tson::Tile::getImage() const { return m_image; }
+
+/*!
+ * x = 'imagewidth' and y = 'imageheight': in pixels
+ * @return
+ */
+const tson::Vector2i &tson::Tile::getImageSize() const
+{
+	return m_imageSize;
+}
+
+/*!
+ * 'type': The type of the tile (optional)
+ * This was renamed to 'class' in Tiled v1.9
+ * @return
+ */
+const std::string &tson::Tile::getType() const
+{
+	return m_type;
+}
+
+/*!
+  * 'class': String assigned to class field in editor (optional)
+ * This was renamed from 'type' to 'class' in Tiled v1.9
+ * @return
+ */
+const std::string &tson::Tile::getClassType() const
+{
+	return m_type;
+}
+
+/*!
+ * 'animation': Array of Frames
+ * @return
+ */
+tson::Animation &tson::Tile::getAnimation()
+{
+	return m_animation;
+}
+
+/*!
+ * 'objectgroup': Layer with type objectgroup (optional)
+ * @return
+ */
+tson::Layer &tson::Tile::getObjectgroup()
+{
+	return m_objectgroup;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::Tile::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * 'terrain': Index of terrain for each corner of tile
+ * @return
+ */
+const std::vector<int> &tson::Tile::getTerrain() const
+{
+	return m_terrain;
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::Tile::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+
+	return nullptr;
+}
+
+/*!
+ * Used for getting the tson::Tileset who is the parent of this Tile.
+ * @return a pointer to the tson::Tileset where this tile is contained.
+ */
+tson::Tileset *tson::Tile::getTileset() const
+{
+	return m_tileset;
+}
+
+/*!
+ * Used for getting the tson::Map who is the parent of this Tile.
+ * @return a pointer to the tson::Map where this tile is contained.
+ */
+tson::Map *tson::Tile::getMap() const
+{
+	return m_map;
+}
+
+/*!
+ * Get the information needed to draw the Tile based on its current tileset
+ * @return a tson::Rect containing the information needed to draw the tile.
+ */
+const tson::Rect &tson::Tile::getDrawingRect() const
+{
+	return m_drawingRect;
+}
+
+/*!
+ * Helper function.
+ *
+ * Get the position of the tile in tile units.
+ * The size of each unit is determined by the tile size property of the map.
+ * Example: If the tile size is 16x16 in the map, a tile unit of [2, 4] would be [32, 64] in pixels.
+ * If you want the position in pixels: use getPosition() instead.
+ *
+ * @return Position of tile in tile units.
+ */
+const tson::Vector2i tson::Tile::getPositionInTileUnits(const std::tuple<int, int> &tileDataPos)
+{
+	return {std::get<0>(tileDataPos), std::get<1>(tileDataPos)};
+}
+
+void tson::Tile::manageFlipFlagsByIdThenRemoveFlags(uint32_t &id)
+{
+	if (id & FLIPPED_HORIZONTALLY_FLAG) m_flipFlags |= TileFlipFlags::Horizontally;
+	if (id & FLIPPED_VERTICALLY_FLAG) m_flipFlags |= TileFlipFlags::Vertically;
+	if (id & FLIPPED_DIAGONALLY_FLAG) m_flipFlags |= TileFlipFlags::Diagonally;
+
+	id &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+}
+
+tson::TileFlipFlags tson::Tile::getFlipFlags() const
+{
+	return m_flipFlags;
+}
+
+/*!
+ *
+ * @param flags Which flags to check for. Several flags can be checked at once using the bitwise or operator.
+ * Example:
+ * hasFlipFlags(TileFlipFlags::Vertically | TileFlipFlags::Horizontally)
+ *
+ * @return true if the flag(s) specified are set
+ */
+bool tson::Tile::hasFlipFlags(tson::TileFlipFlags flags)
+{
+	return ((m_flipFlags & flags) == flags) ? true : false;
+}
+
+uint32_t tson::Tile::getGid() const
+{
+	return m_gid;
+}
+
+void tson::Tile::setProperties(const tson::PropertyCollection &properties)
+{
+	m_properties = properties;
+}
+
+/*!
+ * Tiled 1.9: Contains the newly added sub-rectangle variables: 'x', 'y', 'width' and 'height'
+ * @return A tson::Rect with the 'x', 'y', 'width' and 'height' values
+ */
+const tson::Rect &tson::Tile::getSubRectangle() const
+{
+	return m_subRect;
+}
+
+#endif //TILESON_TILE_HPP
+
+/*** End of inlined file: Tile.hpp ***/
+
+
+/*** Start of inlined file: Terrain.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_TERRAIN_HPP
+#define TILESON_TERRAIN_HPP
+
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class Terrain
+	{
+		public:
+			inline Terrain() = default;
+			inline Terrain(std::string name, int tile);
+			inline explicit Terrain(IJson &json);
+
+			inline bool parse(IJson &json);
+
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline int getTile() const;
+			[[nodiscard]] inline PropertyCollection &getProperties();
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+		private:
+			std::string                 m_name;        /*! 'name': Name of terrain */
+			int                         m_tile {};     /*! 'tile': Local ID of tile representing terrain */
+			tson::PropertyCollection    m_properties;  /*! 'properties': A list of properties (name, value, type). */
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T tson::Terrain::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+}
+
+tson::Terrain::Terrain(std::string name, int tile) : m_name {std::move(name)}, m_tile {tile}
+{
+
+}
+
+tson::Terrain::Terrain(IJson &json)
+{
+	parse(json);
+}
+
+bool tson::Terrain::parse(IJson &json)
+{
+	bool allFound = true;
+
+	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
+	if(json.count("tile") > 0) m_tile = json["tile"].get<int>(); else allFound = false;
+
+	if(json.count("properties") > 0 && json["properties"].isArray())
+	{
+		auto &properties = json.array("properties");
+		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item); });
+	}
+
+	return allFound;
+}
+
+/*!
+ * 'name': Name of terrain
+ * @return
+ */
+const std::string &tson::Terrain::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * 'tile': Local ID of tile representing terrain
+ * @return
+ */
+int tson::Terrain::getTile() const
+{
+	return m_tile;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type). *Missing from the official Tiled documentation...*
+ * @return
+ */
+tson::PropertyCollection &tson::Terrain::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::Terrain::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+	return nullptr;
+}
+
+#endif //TILESON_TERRAIN_HPP
+
+/*** End of inlined file: Terrain.hpp ***/
+
+
+/*** Start of inlined file: Grid.hpp ***/
+//
+// Created by robin on 22.03.2020.
+//
+
+#ifndef TILESON_GRID_HPP
+#define TILESON_GRID_HPP
+
+#include <string>
+//#include "../external/json.hpp"
+
+namespace tson
+{
+	class Grid
+	{
+		friend class MapSnapshot;
+		public:
+			inline Grid() = default;
+			inline explicit Grid(IJson &json);
+
+			inline bool parse(IJson &json);
+
+			[[nodiscard]] inline const std::string &getOrientation() const;
+			[[nodiscard]] inline const Vector2i &getSize() const;
+
+		private:
+			std::string m_orientation; /*! 'orientation': Orientation of the grid for the tiles in this tileset (orthogonal or isometric) */
+			tson::Vector2i m_size; /*! 'width' and 'height': Size. */
+	};
+}
+
+/*!
+ * Parses Tiled grid data from json
+ * @param json
+ */
+tson::Grid::Grid(IJson &json)
+{
+	parse(json);
+}
+
+/*!
+ * Parses Tiled grid data from json
+ * @param json
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Grid::parse(IJson &json)
+{
+	bool allFound = true;
+
+	if(json.count("orientation") > 0) m_orientation = json["orientation"].get<std::string>(); //Optional
+
+	if(json.count("width") > 0 && json.count("height") > 0)
+		m_size = {json["width"].get<int>(), json["height"].get<int>()}; else allFound = false;
+
+	return allFound;
+}
+
+/*!
+ * 'orientation': Orientation of the grid for the tiles in this tileset (orthogonal or isometric)
+ * @return orientation as string
+ */
+const std::string &tson::Grid::getOrientation() const
+{
+	return m_orientation;
+}
+
+/*!
+ * 'width' and 'height': Size.
+ * @return size as int
+ */
+const tson::Vector2i &tson::Grid::getSize() const
+{
+	return m_size;
+}
+
+#endif //TILESON_GRID_HPP
+
+/*** End of inlined file: Grid.hpp ***/
+
+#include <functional>
+
+namespace tson
+{
+	class Map;
+	class Project;
+	class TilesetCache;
+	class Tileset
+	{
+		friend class TilesetCache;
+		friend class MapSnapshot;
+		public:
+			inline Tileset() = default;
+			inline explicit Tileset(IJson &json, tson::Map *map, tson::TilesetCache *cache = nullptr);
+			inline bool parse(IJson &json, tson::Map *map, tson::TilesetCache *cache = nullptr);
+
+			[[nodiscard]] inline int getColumns() const;
+			[[nodiscard]] inline int getFirstgid() const;
+
+			[[nodiscard]] inline const fs::path &getImagePath() const;
+			[[nodiscard]] inline const fs::path &getFullImagePath() const;
+			[[nodiscard]] inline const fs::path &getImage() const;
+			[[nodiscard]] inline const Vector2i &getImageSize() const;
+			[[nodiscard]] inline int getMargin() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline int getSpacing() const;
+			[[nodiscard]] inline int getTileCount() const;
+			[[nodiscard]] inline const Vector2i &getTileSize() const;
+			[[nodiscard]] inline const Colori &getTransparentColor() const;
+			[[nodiscard]] inline const std::string& getTypeStr() const;
+			[[nodiscard]] inline TilesetType getType() const;
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			[[nodiscard]] inline std::vector<tson::Tile> &getTiles();
+			[[nodiscard]] inline const std::vector<tson::WangSet> &getWangsets() const;
+			[[nodiscard]] inline PropertyCollection &getProperties();
+			[[nodiscard]] inline const std::vector<tson::Terrain> &getTerrains() const;
+			[[nodiscard]] inline const Vector2i &getTileOffset() const;
+			[[nodiscard]] inline const Grid &getGrid() const;
+			[[nodiscard]] inline TileRenderSize getTileRenderSize() const;
+			[[nodiscard]] inline FillMode getFillMode() const;
+
+			inline tson::Tile * getTile(uint32_t id);
+			inline tson::Terrain * getTerrain(const std::string &name);
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			//v1.2.0-stuff
+			[[nodiscard]] inline tson::Map *getMap() const;
+			[[nodiscard]] inline ObjectAlignment getObjectAlignment() const;
+
+			inline static tson::ObjectAlignment StringToAlignment(std::string_view str);
+
+			//v1.3.0
+			inline tson::Vector2i getMarginSpacingOffset(const tson::Vector2i &posInTileUnits);
+			inline tson::WangSet * getWangset(const std::string &name);
+			inline const Transformations &getTransformations() const;
+
+			#ifndef TSON_TEST_ENABLED
+		private:
+			#endif
+
+			[[nodiscard]] inline tson::Project *getProject() const;
+
+			inline void generateMissingTiles();
+			inline bool parseData(IJson &json);
+			inline bool parseSource(IJson &json, const fs::path &path, tson::Map *map);
+			inline bool parseFromCache(IJson &json, tson::TilesetCache &cache); /*! Declared in tileson_forward.hpp */
+			inline IJson *parseLinkedFile(); /*! Declared in tileson_forward.hpp */
+			inline void bind(tson::Map *map, int firstgid);
+			inline static void BindLayer(tson::Layer &layer, tson::Map *map);
+
+			int                           m_columns {};       /*! 'columns': The number of tile columns in the tileset */
+			int                           m_firstgid {};      /*! 'firstgid': GID corresponding to the first tile in the set */
+
+			fs::path                      m_image;            /*! 'image': Image used for tiles in this set */
+			fs::path                      m_imagePath;        /*!  Image path relative to the tileset json of this tileset */
+
+			tson::Vector2i                m_imageSize;        /*! x = 'imagewidth' and y = 'imageheight': in pixels */
+			int                           m_margin {};        /*! 'margin': Buffer between image edge and first tile (pixels)*/
+			std::string                   m_name;             /*! 'name': Name given to this tileset */
+			int                           m_spacing {};       /*! 'spacing': Spacing between adjacent tiles in image (pixels)*/
+			int                           m_tileCount {};     /*! 'tilecount': The number of tiles in this tileset */
+			tson::Vector2i                m_tileSize;         /*! x = 'tilewidth' and y = 'tileheight': Maximum size of tiles in this set */
+			tson::Colori                  m_transparentColor; /*! 'transparentcolor': Hex-formatted color (#RRGGBB) (optional) */
+			std::string                   m_typeStr;          /*! 'type': tileset (for tileset files, since 1.0) */
+			TilesetType                   m_type{ TilesetType::Undefined }; /*! Tileset type as enum */
+
+			std::vector<tson::Tile>       m_tiles;            /*! 'tiles': Array of Tiles (optional) */
+			std::vector<tson::WangSet>    m_wangsets;         /*! 'wangsets':Array of Wang sets (since 1.1.5) */
+			tson::PropertyCollection      m_properties; 	  /*! 'properties': A list of properties (name, value, type). */
+
+			std::vector<tson::Terrain>    m_terrains;         /*! 'terrains': Array of Terrains (optional) */
+			tson::Vector2i                m_tileOffset;       /*! 'x' and 'y': See <tileoffset> (optional) */
+			tson::Grid                    m_grid;             /*! 'grid': This element is only used in case of isometric orientation, and determines
+																   how tile overlays for terrain and collision information are rendered. */
+
+			//v1.2.0-stuff
+			tson::ObjectAlignment         m_objectAlignment{tson::ObjectAlignment::Unspecified};  /*! 'objectalignment': Alignment to use for tile objects. Tiled 1.4.*/
+			tson::Map *                   m_map;              /*! The map who owns this tileset */
+
+			//v1.3.0-stuff
+			fs::path                      m_source {};           /*! 'source': exists only when tileset is contained in an external file*/
+			fs::path                      m_path {};             /*! Has the full path to the tileset if 'source' has an existing value */
+			Transformations               m_transformations {};  /*! New in Tiled v1.5 - This element is used to describe which transformations can be applied to
+																	 the tiles (e.g. to extend a Wang set by transforming existing tiles).*/
+
+			//v1.4.0-stuff
+			TileRenderSize                m_tileRenderSize {};   /*! 'tilerendersize': The size to use when rendering tiles from this tileset on a tile layer. Valid values are 'tile' (the default) and 'grid'.
+ *                                                                    When set to 'grid', the tile is drawn at the tile grid size of the map. (since 1.9)*/
+			FillMode                      m_fillMode {};         /*! 'fillmode': The fill mode to use when rendering tiles from this tileset. Valid values are 'stretch' (the default) and 'preserve-aspect-fit'.
+ *                                                                    Only relevant when the tiles are not rendered at their native size, so this applies to resized tile objects or in combination with 'tilerendersize' set to 'grid'. (since 1.9)*/
+
+			std::string                   m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
+			std::shared_ptr<tson::TiledClass> m_class {};
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T tson::Tileset::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+}
+
+tson::Tileset::Tileset(IJson &json, tson::Map *map, tson::TilesetCache *cache)
+{
+	parse(json, map, cache);
+}
+
+/*!
+ * Parses a tileset of a map.
+ * @param json A json object with the format of Tileset
+ * @param map The map who owns the tileset
+ * @param cache When not nullptr, external tilesets ('source') are copied from the cache instead of being parsed
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Tileset::parse(IJson &json, tson::Map *map, tson::TilesetCache *cache)
+{
+	m_map = map;
+	bool allFound = true;
+
+	if(json.count("firstgid") > 0) m_firstgid = json["firstgid"].get<int>(); else allFound = false;
+
+	//Tileset is stored in external file if 'source' exists
+	if(json.count("source") > 0)
+	{
+		if(!allFound)
+			return allFound;
+
+		std::string sourceStr = json["source"].get<std::string>();
+		m_source = fs::path(sourceStr);
+		m_path = json.directory() / m_source;
+
+		//Maps with a custom tson::LinkedFileParser, like maps in a tson::Archive, read external tilesets through it
+		IJson *linkedFile = parseLinkedFile();
+		if(linkedFile != nullptr)
+			return parseData(*linkedFile);
+
+		if(cache != nullptr)
+			return parseFromCache(json, *cache);
+
+		if(!json.parse(m_path))
+			return false;
+	}
+
+	bool const dataFound = parseData(json);
+	return allFound && dataFound;
+}
+
+/*!
+ * Parses an external tileset file on its own, to be kept in a tson::TilesetCache.
+ * It is parsed with 'firstgid' 1, and is not bound to a map afterwards.
+ * @param json The tileset file
+ * @param path Path to the tileset file
+ * @param map The map asking for the tileset. Only used while parsing.
+ */
+bool tson::Tileset::parseSource(IJson &json, const fs::path &path, tson::Map *map)
+{
+	m_map = map;
+	m_firstgid = 1;
+	m_source = path;
+	m_path = path;
+	bool const allFound = parseData(json);
+	bind(nullptr, m_firstgid);
+	return allFound;
+}
+
+/*!
+ * Parses everything but 'firstgid' and 'source'
+ */
+bool tson::Tileset::parseData(IJson &json)
+{
+	bool allFound = true;
+
+	if (json.count("columns") > 0)
+	{
+		m_columns = json["columns"].get<int>();
+		if (m_columns == 0)
+		{
+			m_type = TilesetType::ImageCollectionTileset;
+		}
+		else if (m_columns > 0)
+		{
+			m_type = TilesetType::ImageTileset;
+		}
+	}
+	else
+	{
+		allFound = false;
+	}
+
+	// Image tileset specific properties
+	if (m_type == TilesetType::ImageTileset)
+	{
+		if (json.count("image") > 0)
+		{
+			m_image = fs::path(json["image"].get<std::string>());
+			m_imagePath = m_path.parent_path() / m_image;
+		}
+		else
+		{
+			allFound = false;
+		}
+
+		if (json.count("imagewidth") > 0 && json.count("imageheight") > 0)
+		{
+			m_imageSize = { json["imagewidth"].get<int>(), json["imageheight"].get<int>() };
+		}
+		else
+		{
+			allFound = false;
+		}
+	}
+
+	if(json.count("margin") > 0) m_margin = json["margin"].get<int>(); else allFound = false;
+	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
+	if(json.count("spacing") > 0) m_spacing = json["spacing"].get<int>(); else allFound = false;
+	if(json.count("tilecount") > 0) m_tileCount = json["tilecount"].get<int>(); else allFound = false;
+	if(json.count("transparentcolor") > 0) m_transparentColor = tson::Colori(json["transparentcolor"].get<std::string>()); //Optional
+	if (json.count("type") > 0) m_typeStr = json["type"].get<std::string>();
+	if(json.count("grid") > 0) m_grid = tson::Grid(json["grid"]);
+	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+
+	if(json.count("tilewidth") > 0 && json.count("tileheight") > 0)
+		m_tileSize = {json["tilewidth"].get<int>(), json["tileheight"].get<int>()}; else allFound = false;
+	if(json.count("tileoffset") > 0)
+		m_tileOffset = {json["tileoffset"]["x"].get<int>(), json["tileoffset"]["y"].get<int>()};
+
+	if(json.count("tilerendersize") > 0)
+	{
+		std::string tileRenderStr = json["tilerendersize"].get<std::string>();
+		if(tileRenderStr == "tile") m_tileRenderSize = TileRenderSize::Tile;
+		else if(tileRenderStr == "grid") m_tileRenderSize = TileRenderSize::Grid;
+	}
+
+	if(json.count("fillmode") > 0)
+	{
+		std::string fillmode = json["fillmode"].get<std::string>();
+		if(fillmode == "stretch") m_fillMode = FillMode::Stretch;
+		else if(fillmode == "preserve-aspect-fit") m_fillMode = FillMode::PreserveAspectFit;
+	}
+
+	//More advanced data
+	if(json.count("wangsets") > 0 && json["wangsets"].isArray())
+	{
+		auto &wangsets = json.array("wangsets");
+		std::for_each(wangsets.begin(), wangsets.end(), [&](std::unique_ptr<IJson> &item) { m_wangsets.emplace_back(*item, m_map); });
+	}
+	if(json.count("tiles") > 0 && json["tiles"].isArray())
+	{
+		auto &tiles = json.array("tiles");
+		std::for_each(tiles.begin(), tiles.end(), [&](std::unique_ptr<IJson> &item) { m_tiles.emplace_back(*item, this, m_map); });
+	}
+	if(json.count("terrains") > 0 && json["terrains"].isArray())
+	{
+		auto &terrains = json.array("terrains");
+		std::for_each(terrains.begin(), terrains.end(), [&](std::unique_ptr<IJson> &item) { m_terrains.emplace_back(*item); });
+	}
+
+	if(json.count("properties") > 0 && json["properties"].isArray())
+	{
+		auto &properties = json.array("properties");
+		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item, getProject()); });
+	}
+
+	if(json.count("objectalignment") > 0)
+	{
+		std::string alignment = json["objectalignment"].get<std::string>();
+		m_objectAlignment = StringToAlignment(alignment);
+	}
+
+	if(json.count("transformations") > 0)
+	{
+		m_transformations.parse(json["transformations"]);
+	}
+
+	for(auto &wangset : m_wangsets)
+		wangset.buildLookup(m_transformations, static_cast<uint32_t>(m_firstgid));
+
+	generateMissingTiles();
+
+	return allFound;
+}
+
+/*!
+ * 'columns': The number of tile columns in the tileset
+ * @return
+ */
+int tson::Tileset::getColumns() const
+{
+	return m_columns;
+}
+
+/*!
+ * 'firstgid': GID corresponding to the first tile in the set
+ * @return
+ */
+int tson::Tileset::getFirstgid() const
+{
+	return m_firstgid;
+}
+
+/*!
+ * 'image': Image used for tiles in this set
+ * @return
+ */
+const fs::path &tson::Tileset::getImagePath() const { return m_image; }
+
+/*!
+ * Gets a path to the image used in this tileset relative to the JSON
+ * file defining this tileset.
+ * @return A path that can be used to open the image file of this tileset.
+ */
+const fs::path &tson::Tileset::getFullImagePath() const { return m_imagePath; }
+
+/*!
+ * x = 'imagewidth' and y = 'imageheight': in pixels
+ * @return
+ */
+const tson::Vector2i &tson::Tileset::getImageSize() const
+{
+	return m_imageSize;
+}
+
+/*!
+ * 'margin': Buffer between image edge and first tile (pixels)
+ * @return
+ */
+int tson::Tileset::getMargin() const
+{
+	return m_margin;
+}
+
+/*!
+ * 'name': Name given to this tileset
+ * @return
+ */
+const std::string &tson::Tileset::getName() const
+{
+	return m_name;
+}
+
+/*!
+ * 'spacing': Spacing between adjacent tiles in image (pixels)
+ * @return
+ */
+int tson::Tileset::getSpacing() const
+{
+	return m_spacing;
+}
+
+/*!
+ * 'tilecount': The number of tiles in this tileset
+ * @return
+ */
+int tson::Tileset::getTileCount() const
+{
+	return m_tileCount;
+}
+
+/*!
+ * x = 'tilewidth' and y = 'tileheight': Maximum size of tiles in this set
+ * @return
+ */
+const tson::Vector2i &tson::Tileset::getTileSize() const
+{
+	return m_tileSize;
+}
+
+/*!
+ * 'transparentcolor': Color object created by hex-formatted color (#RRGGBB) (optional)
+ * @return
+ */
+const tson::Colori &tson::Tileset::getTransparentColor() const
+{
+	return m_transparentColor;
+}
+
+/*!
+ * 'type': tileset (for tileset files, since 1.0)
+ * @return
+ */
+const std::string& tson::Tileset::getTypeStr() const
+{
+	return m_typeStr;
+}
+
+/*!
+ * 'type': Tileset type as enum
+ * @return
+*/
+tson::TilesetType tson::Tileset::getType() const
+{
+	return m_type;
+}
+
+/*!
+ * 'image': Image used for tiles in this set
+ * @return
+ */
+
+const fs::path &tson::Tileset::getImage() const { return m_image; }
+
+/*!
+ * 'tiles': Array of Tiles (optional)
+ * @return
+ */
+std::vector<tson::Tile> &tson::Tileset::getTiles()
+{
+	return m_tiles;
+}
+
+/*!
+ * 'wangsets':Array of Wang sets (since Tiled 1.1.5)
+ * @return
+ */
+const std::vector<tson::WangSet> &tson::Tileset::getWangsets() const
+{
+	return m_wangsets;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::Tileset::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * 'terrains': Array of Terrains (optional)
+ * @return
+ */
+const std::vector<tson::Terrain> &tson::Tileset::getTerrains() const
+{
+	return m_terrains;
+}
+
+/*!
+ * 'x' and 'y': See <tileoffset> (optional)
+ * @return
+ */
+const tson::Vector2i &tson::Tileset::getTileOffset() const
+{
+	return m_tileOffset;
+}
+
+/*!
+ * 'grid': This element is only used in case of isometric orientation, and determines
+ * how tile overlays for terrain and collision information are rendered.
+ * @return
+ */
+const tson::Grid &tson::Tileset::getGrid() const
+{
+	return m_grid;
+}
+
+/*!
+ * Gets a tile by ID (Tiled ID + 1)
+ * @param id The ID of the tile stored in Tiled map + 1. Example: If ID was stored in Tiled map as 0, the corresponding value in Tileson is 1.
+ * This is to make sure the IDs of tiles matches their references in containers.
+ * @return A pointer to the Tile if found. nullptr otherwise.
+ */
+tson::Tile *tson::Tileset::getTile(uint32_t id)
+{
+	auto result = std::find_if(m_tiles.begin(), m_tiles.end(), [&](const tson::Tile & item) { return item.getId() == id;});
+	if(result == m_tiles.end())
+		return nullptr;
+
+	return &result.operator*();
+}
+
+/*!
+ * Get an existing Terrain object by name
+ * @param name
+ * @return A pointer to the Terrain if found. nullptr otherwise.
+ */
+tson::Terrain *tson::Tileset::getTerrain(const std::string &name)
+{
+	auto result = std::find_if(m_terrains.begin(), m_terrains.end(), [&](const tson::Terrain & item) { return item.getName() == name;});
+	if(result == m_terrains.end())
+		return nullptr;
+
+	return &result.operator*();
+}
+
+/*!
+ * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
+ * @param name Name of the property
+ * @return
+ */
+tson::Property *tson::Tileset::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+
+	return nullptr;
+}
+
+/*!
+ * Points a copied tileset, and everything in it, to a map and a 'firstgid'.
+ * Values that depend on them, like gids and drawing rects, are calculated again.
+ */
+void tson::Tileset::bind(tson::Map *map, int firstgid)
+{
+	bool const firstgidChanged = firstgid != m_firstgid;
+	m_map = map;
+	m_firstgid = firstgid;
+	m_class = nullptr;
+
+	for(auto &wangset : m_wangsets)
+	{
+		wangset.m_map = map;
+		wangset.m_class = nullptr;
+		for(auto *colors : {&wangset.m_cornerColors, &wangset.m_edgeColors, &wangset.m_colors})
+		{
+			for(auto &color : *colors)
+			{
+				color.m_map = map;
+				color.m_class = nullptr;
+			}
+		}
+		if(firstgidChanged)
+			wangset.buildLookup(m_transformations, static_cast<uint32_t>(firstgid));
+	}
+
+	for(auto &tile : m_tiles)
+	{
+		tile.m_tileset = this;
+		tile.m_map = map;
+		tile.m_gid = static_cast<uint32_t>(firstgid) + tile.m_id - 1;
+		tile.m_class = nullptr;
+		BindLayer(tile.m_objectgroup, map);
+		tile.performDataCalculations();
+	}
+}
+
+/*!
+ * Points a layer, its objects and its sub layers to a map
+ */
+void tson::Tileset::BindLayer(tson::Layer &layer, tson::Map *map)
+{
+	layer.m_map = map;
+	layer.m_class = nullptr;
+	for(auto &object : layer.m_objects)
+	{
+		object.m_map = map;
+		object.m_class = nullptr;
+	}
+	for(auto &child : layer.m_layers)
+		BindLayer(child, map);
+}
+
+/*!
+ * Tiled only has tiles with a property stored in the map. This function makes sure even the ones with no properties will exist.
+ */
+void tson::Tileset::generateMissingTiles()
+{
+	std::vector<uint32_t> tileIds;
+	for(auto &tile : m_tiles)
+		tileIds.push_back(tile.getId());
+
+	for (uint32_t i = 1; i < (uint32_t)m_tileCount + 1; ++i)
+	{
+		if (std::count(tileIds.begin(), tileIds.end(), i) == 0)
+		{
+			m_tiles.emplace_back(Tile::CreateMissingTile(i, this, m_map));
+		}
+	}
+}
+
+/*!
+ * Used for getting the tson::Map who is the parent of this Tileset.
+ * @return a pointer to the tson::Map where this tileset is contained.
+ */
+tson::Map *tson::Tileset::getMap() const
+{
+	return m_map;
+}
+
+/*!
+ *
+ * @param str The string you want to convert
+ * @return Alignment enum based on the string from the input.
+ */
+tson::ObjectAlignment tson::Tileset::StringToAlignment(std::string_view str)
+{
+	if(str == "unspecified") return tson::ObjectAlignment::Unspecified;
+	else if(str == "topleft") return tson::ObjectAlignment::TopLeft;
+	else if(str == "top") return tson::ObjectAlignment::Top;
+	else if(str == "topright") return tson::ObjectAlignment::TopRight;
+	else if(str == "left") return tson::ObjectAlignment::Left;
+	else if(str == "center") return tson::ObjectAlignment::Center;
+	else if(str == "right") return tson::ObjectAlignment::Right;
+	else if(str == "bottomleft") return tson::ObjectAlignment::BottomLeft;
+	else if(str == "bottom") return tson::ObjectAlignment::Bottom;
+	else if(str == "bottomright") return tson::ObjectAlignment::BottomRight;
+	else
+		return tson::ObjectAlignment::Unspecified;
+}
+
+tson::ObjectAlignment tson::Tileset::getObjectAlignment() const
+{
+	return m_objectAlignment;
+}
+
+/*!
+ * Helper function to calculate the correct additional offset when margin and/or spacing is used in a tileset
+ * Created to solve issue #31.
+ *
+ * @param posInTileUnits Position of the current tile in tile units.
+ * @return Calculated additional offset in pixels.
+ */
+tson::Vector2i tson::Tileset::getMarginSpacingOffset(const tson::Vector2i &posInTileUnits)
+{
+	if(m_margin == 0 && m_spacing == 0)
+		return {0,0};
+
+	tson::Vector2i offset {(posInTileUnits.x * m_spacing) + m_margin, (posInTileUnits.y * m_spacing) + m_margin};
+	return offset;
+}
+
+/*!
+ * Get a wangset by name
+ * @param name
+ * @return
+ */
+tson::WangSet *tson::Tileset::getWangset(const std::string &name)
+{
+	auto wangset = std::find_if(m_wangsets.begin(), m_wangsets.end(), [&](const auto &w) { return w.getName() == name; });
+
+	if(wangset != m_wangsets.end())
+		return &wangset.operator*();
+
+	return nullptr;
+}
+
+/*!
+ * New in Tiled v1.5 - This element is used to describe which transformations can be applied to
+ * the tiles (e.g. to extend a Wang set by transforming existing tiles).
+ *
+ * @return
+ */
+const tson::Transformations &tson::Tileset::getTransformations() const
+{
+	return m_transformations;
+}
+
+tson::TileRenderSize tson::Tileset::getTileRenderSize() const
+{
+	return m_tileRenderSize;
+}
+
+tson::FillMode tson::Tileset::getFillMode() const
+{
+	return m_fillMode;
+}
+
+const std::string &tson::Tileset::getClassType() const
+{
+	return m_classType;
+}
+
+#endif //TILESON_TILESET_HPP
+/*** End of inlined file: Tileset.hpp ***/
+
+
+/*** Start of inlined file: AnimationClock.hpp ***/
+#ifndef TILESON_ANIMATIONCLOCK_HPP
+#define TILESON_ANIMATIONCLOCK_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace tson
+{
+	/*!
+	 * Keeps track of all the tile animations of a map, without touching the tson::Animation of each tson::Tile.
+	 *
+	 * Every animated tile of every tileset is collected once, and the state of all animations is kept in flat arrays,
+	 * so update() advances everything in one pass. The result is a table with the gid to draw for each gid,
+	 * which renderers can index directly:
+	 *
+	 * tson::AnimationClock &clock = map->getAnimationClock();
+	 * clock.update(deltaMs);
+	 * uint32_t gidToDraw = clock.getCurrentGid(cell.gid);
+	 *
+	 * All animations share the same clock, which starts at 0 when the map is loaded. getGidAt() gives the gid for any point in time
+	 * without changing the state of the clock, so it can be used from multiple threads at once.
+	 */
+	class AnimationClock
+	{
+		public:
+			inline AnimationClock() = default;
+
+			inline void build(std::vector<tson::Tileset> &tilesets);
+			inline void update(float timeDeltaMs);
+			inline void reset();
+
+			[[nodiscard]] inline double getTime() const;
+			[[nodiscard]] inline const std::vector<uint32_t> &getCurrentGids() const;
+			[[nodiscard]] inline uint32_t getCurrentGid(uint32_t gid) const;
+			[[nodiscard]] inline uint32_t getGidAt(uint32_t gid, double timeMs) const;
+			[[nodiscard]] inline bool isAnimated(uint32_t gid) const;
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline bool empty() const;
+
+		private:
+			static constexpr uint32_t FLIP_FLAGS = FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG;
+			inline uint32_t frameAt(size_t animation, double timeMs) const;
+			inline static uint32_t findFrame(const uint32_t *frameEnds, uint32_t frameCount, double loopTimeMs);
+
+			double                  m_time {};              /*! Time since build() or reset() in milliseconds */
+			std::vector<uint32_t>   m_currentGids;          /*! index: gid without flip flags. Value: gid of the current frame */
+			std::vector<int32_t>    m_animationIndices;     /*! index: gid without flip flags. Value: index of the animation, or -1 */
+
+			//One element per animation
+			std::vector<uint32_t>   m_animatedGids;         /*! The gid of the animated tile */
+			std::vector<uint32_t>   m_firstFrames;          /*! Index of the first frame in m_frameGids and m_frameEnds */
+			std::vector<uint32_t>   m_frameCounts;
+			std::vector<uint32_t>   m_totalDurations;       /*! Sum of all frame durations in milliseconds */
+			std::vector<uint32_t>   m_currentFrames;        /*! Current frame, relative to the first frame */
+			std::vector<float>      m_loopTimes;            /*! Time since the start of the current loop in milliseconds */
+
+			//One element per frame of every animation
+			std::vector<uint32_t>   m_frameGids;
+			std::vector<uint32_t>   m_frameEnds;            /*! Prefix sum of the frame durations of each animation */
+	};
+
+	/*!
+	 * Collects the animations of all tiles in the tilesets, and sets the clock to 0.
+	 * @param tilesets The tilesets of a map
+	 */
+	void AnimationClock::build(std::vector<tson::Tileset> &tilesets)
+	{
+		m_animatedGids.clear();
+		m_firstFrames.clear();
+		m_frameCounts.clear();
+		m_totalDurations.clear();
+		m_frameGids.clear();
+		m_frameEnds.clear();
+
+		uint32_t maxGid = 0;
+		for(auto &tileset : tilesets)
+		{
+			if(tileset.getTileCount() > 0)
+				maxGid = std::max(maxGid, static_cast<uint32_t>(tileset.getFirstgid() + tileset.getTileCount() - 1));
+
+			for(auto &tile : tileset.getTiles())
+			{
+				maxGid = std::max(maxGid, tile.getGid());
+				if(!tile.getAnimation().any())
+					continue;
+
+				uint32_t total = 0;
+				m_firstFrames.push_back(static_cast<uint32_t>(m_frameGids.size()));
+				for(const auto &frame : tile.getAnimation().getFrames())
+				{
+					//The tile id of a frame is the local id + 1
+					m_frameGids.push_back(static_cast<uint32_t>(tileset.getFirstgid()) + frame.getTileId() - 1);
+					total += static_cast<uint32_t>(std::max(frame.getDuration(), 0));
+					m_frameEnds.push_back(total);
+				}
+				m_animatedGids.push_back(tile.getGid());
+				m_frameCounts.push_back(static_cast<uint32_t>(tile.getAnimation().size()));
+				m_totalDurations.push_back(total);
+			}
+		}
+
+		m_animationIndices.assign(m_animatedGids.empty() ? 0 : static_cast<size_t>(maxGid) + 1, -1);
+		for(size_t i = 0; i < m_animatedGids.size(); ++i)
+			m_animationIndices[m_animatedGids[i]] = static_cast<int32_t>(i);
+
+		reset();
+	}
+
+	/*!
+	 * Advances all animations. Large time deltas skip as many frames as needed.
+	 * @param timeDeltaMs Time in milliseconds since the last update
+	 */
+	void AnimationClock::update(float timeDeltaMs)
+	{
+		if(timeDeltaMs <= 0.f)
+			return;
+
+		m_time += timeDeltaMs;
+		size_t const count = m_animatedGids.size();
+		for(size_t i = 0; i < count; ++i)
+		{
+			uint32_t const total = m_totalDurations[i];
+			if(total == 0)
+				continue;
+
+			//Whole loops of the animation end up at the same frame, so only the remainder matters
+			float time = m_loopTimes[i] + timeDeltaMs;
+			if(time >= static_cast<float>(total))
+				time = std::fmod(time, static_cast<float>(total));
+			m_loopTimes[i] = time;
+
+			//Most updates stay within the current frame. Otherwise: binary search in the prefix sum
+			const uint32_t *ends = m_frameEnds.data() + m_firstFrames[i];
+			uint32_t frame = m_currentFrames[i];
+			if(time >= static_cast<float>(ends[frame]) || (frame > 0 && time < static_cast<float>(ends[frame - 1])))
+				frame = findFrame(ends, m_frameCounts[i], time);
+
+			m_currentFrames[i] = frame;
+			m_currentGids[m_animatedGids[i]] = m_frameGids[m_firstFrames[i] + frame];
+		}
+	}
+
+	/*!
+	 * Sets the clock back to 0, which is the first frame of every animation.
+	 */
+	void AnimationClock::reset()
+	{
+		m_time = 0.0;
+		m_currentGids.resize(m_animationIndices.size());
+		for(size_t gid = 0; gid < m_currentGids.size(); ++gid)
+			m_currentGids[gid] = static_cast<uint32_t>(gid);
+
+		m_currentFrames.assign(m_animatedGids.size(), 0);
+		m_loopTimes.assign(m_animatedGids.size(), 0.f);
+		for(size_t i = 0; i < m_animatedGids.size(); ++i)
+		{
+			if(m_frameCounts[i] > 0)
+				m_currentGids[m_animatedGids[i]] = m_frameGids[m_firstFrames[i]];
+		}
+	}
+
+	/*!
+	 * Time since the animations started, in milliseconds
+	 */
+	double AnimationClock::getTime() const
+	{
+		return m_time;
+	}
+
+	/*!
+	 * A table with the gid to draw for every gid, where the index is a gid without flip flags.
+	 * Gids that are not animated point to themselves. Gids outside the table are not animated.
+	 * @return The table of current gids
+	 */
+	const std::vector<uint32_t> &AnimationClock::getCurrentGids() const
+	{
+		return m_currentGids;
+	}
+
+	/*!
+	 * Gets the gid to draw right now for a gid.
+	 * @param gid Gid with or without flip flags
+	 * @return The gid of the current frame, with the flip flags of the input. The input itself if the gid is not animated.
+	 */
+	uint32_t AnimationClock::getCurrentGid(uint32_t gid) const
+	{
+		uint32_t const id = gid & ~FLIP_FLAGS;
+		return (id < m_currentGids.size()) ? (m_currentGids[id] | (gid & FLIP_FLAGS)) : gid;
+	}
+
+	/*!
+	 * Gets the gid to draw at any point in time, where 0 is the first frame of all animations.
+	 * Does not change the clock, and is safe to call from multiple threads.
+	 * @param gid Gid with or without flip flags
+	 * @param timeMs Time in milliseconds
+	 * @return The gid of the frame at the given time, with the flip flags of the input. The input itself if the gid is not animated.
+	 */
+	uint32_t AnimationClock::getGidAt(uint32_t gid, double timeMs) const
+	{
+		uint32_t const id = gid & ~FLIP_FLAGS;
+		if(id >= m_animationIndices.size() || m_animationIndices[id] < 0)
+			return gid;
+
+		auto const animation = static_cast<size_t>(m_animationIndices[id]);
+		if(m_frameCounts[animation] == 0)
+			return gid;
+
+		return m_frameGids[m_firstFrames[animation] + frameAt(animation, timeMs)] | (gid & FLIP_FLAGS);
+	}
+
+	/*!
+	 * true if the gid has an animation
+	 */
+	bool AnimationClock::isAnimated(uint32_t gid) const
+	{
+		uint32_t const id = gid & ~FLIP_FLAGS;
+		return id < m_animationIndices.size() && m_animationIndices[id] >= 0;
+	}
+
+	/*!
+	 * Number of animations
+	 */
+	size_t AnimationClock::size() const
+	{
+		return m_animatedGids.size();
+	}
+
+	bool AnimationClock::empty() const
+	{
+		return m_animatedGids.empty();
+	}
+
+	uint32_t AnimationClock::frameAt(size_t animation, double timeMs) const
+	{
+		uint32_t const total = m_totalDurations[animation];
+		if(total == 0 || timeMs <= 0.0)
+			return 0;
+
+		return findFrame(m_frameEnds.data() + m_firstFrames[animation], m_frameCounts[animation], std::fmod(timeMs, static_cast<double>(total)));
+	}
+
+	/*!
+	 * The first frame ending after the given time, found by binary search in the prefix sum of the frame durations.
+	 */
+	uint32_t AnimationClock::findFrame(const uint32_t *frameEnds, uint32_t frameCount, double loopTimeMs)
+	{
+		const uint32_t *end = frameEnds + frameCount;
+		const uint32_t *frame = std::upper_bound(frameEnds, end, loopTimeMs, [](double time, uint32_t frameEnd) { return time < static_cast<double>(frameEnd); });
+		return (frame == end) ? 0 : static_cast<uint32_t>(frame - frameEnds);
+	}
+}
+
+#endif //TILESON_ANIMATIONCLOCK_HPP
+
+/*** End of inlined file: AnimationClock.hpp ***/
+
+namespace tson
+{
+	using LinkedFileParser = std::function<std::unique_ptr<IJson>(std::string relativePath)>;
+	class Object;
+	class TemplateCache;
+	class Map
+	{
+		friend class Object;
+		friend class Layer;
+		friend class Tileset;
+		friend class MapSnapshot;
+		friend class Tileson;
+		public:
+			inline Map() = default;
+			inline Map(ParseStatus status, std::string description);
+			inline explicit Map(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser = nullptr);
+			inline bool parse(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser = nullptr);
+
+			[[nodiscard]] inline const Colori &getBackgroundColor() const;
+			[[nodiscard]] inline const Vector2i &getSize() const;
+			[[nodiscard]] inline int getHexsideLength() const;
+			[[nodiscard]] inline bool isInfinite() const;
+			[[nodiscard]] inline int getNextLayerId() const;
+			[[nodiscard]] inline int getNextObjectId() const;
+			[[nodiscard]] inline const std::string &getOrientation() const;
+			[[nodiscard]] inline const std::string &getRenderOrder() const;
+			[[nodiscard]] inline const std::string &getStaggerAxis() const;
+			[[nodiscard]] inline const std::string &getStaggerIndex() const;
+			[[nodiscard]] inline const std::string &getTiledVersion() const;
+			[[nodiscard]] inline const Vector2i &getTileSize() const;
+			[[nodiscard]] inline const std::string &getType() const;
+			[[nodiscard]] inline const std::string &getClassType() const;
+			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			[[nodiscard]] inline const Vector2f &getParallaxOrigin() const;
+			//[[nodiscard]] inline int getVersion() const; //Removed - Tileson v1.3.0
+
+			[[nodiscard]] inline std::vector<tson::Layer> &getLayers();
+			[[nodiscard]] inline PropertyCollection &getProperties();
+			[[nodiscard]] inline std::vector<tson::Tileset> &getTilesets();
+
+			[[nodiscard]] inline ParseStatus getStatus() const;
+			[[nodiscard]] inline const std::string &getStatusMessage() const;
+			[[nodiscard]] inline const std::map<uint32_t, tson::Tile *> &getTileMap() const;
+			[[nodiscard]] inline const std::vector<tson::TileDrawInfo> &getTileDrawTable() const;
+			[[nodiscard]] inline const tson::TileDrawInfo *getTileDrawInfo(uint32_t gid) const;
+			[[nodiscard]] inline tson::AnimationClock &getAnimationClock();
+
+			inline Layer * getLayer(const std::string &name);
+			inline Tileset * getTileset(const std::string &name);
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property * getProp(const std::string &name);
+
+			//v1.2.0
+			[[nodiscard]] inline int getCompressionLevel() const;
+			inline DecompressorContainer *getDecompressors();
+			inline Project * getProject();
+			inline Tileset * getTilesetByGid(uint32_t gid);
+			inline void setTilesetCache(tson::TilesetCache *tilesetCache);
+			inline void setTemplateCache(tson::TemplateCache *templateCache);
+			inline void setLayerFilter(tson::LayerFilter layerFilter);
+			inline void setTileRegion(const tson::Rect &tileRegion);
+			[[nodiscard]] inline const tson::Rect &getTileRegion() const;
+			inline void loadLayers();
+			[[nodiscard]] inline bool hasUnloadedLayers() const;
+
+			inline tson::Object * getObj(int id);
+			inline tson::Layer * getObjLayer(int id);
+			inline tson::Object * firstObj(const std::string &name);
+			inline std::vector<tson::Object *> getObjsByName(const std::string &name);
+			inline tson::Object * resolveObjectRef(const tson::Property *property);
+			inline void buildObjectLookup();
+
+		private:
+			inline IJson* parseLinkedFile(const std::string& path);
+			inline std::shared_ptr<const tson::ObjectTemplate> getTemplate(const std::string &relativePath); /*! Declared in tileson_forward.hpp */
+			inline bool createTilesetData(IJson &json);
+			inline void processData();
+			inline void processLayer(tson::Layer &layer);
+			inline void loadLayer(tson::Layer &layer);
+			inline void loadLayers(std::vector<tson::Layer> &layers);
+			inline void buildTileDrawTable();
+			inline void addObjectsToLookup(std::vector<tson::Layer> &layers);
+
+			Colori                                 m_backgroundColor;   /*! 'backgroundcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) (optional)*/;
+			Vector2i                               m_size;              /*! 'width' and 'height' of a Tiled map */
+			int                                    m_hexsideLength {};  /*! 'hexsidelength': Length of the side of a hex tile in pixels */
+			bool                                   m_isInfinite {};     /*! 'infinite': Whether the map has infinite dimensions*/
+			std::vector<tson::Layer>               m_layers; 	        /*! 'layers': Array of layers. group on */
+			int                                    m_nextLayerId {};    /*! 'nextlayerid': Auto-increments for each layer */
+			int                                    m_nextObjectId {};   /*! 'nextobjectid': Auto-increments for each placed object */
+			std::string                            m_orientation;       /*! 'orientation': orthogonal, isometric, staggered or hexagonal */
+			tson::PropertyCollection               m_properties; 	    /*! 'properties': A list of properties (name, value, type). */
+			std::string                            m_renderOrder;       /*! 'renderorder': Rendering direction (orthogonal maps only) */
+			std::string                            m_staggerAxis;       /*! 'staggeraxis': x or y (staggered / hexagonal maps only) */
+			std::string                            m_staggerIndex;      /*! 'staggerindex': odd or even (staggered / hexagonal maps only) */
+			std::string                            m_tiledVersion;      /*! 'tiledversion': The Tiled version used to save the file */
+			Vector2i                               m_tileSize;          /*! 'tilewidth': and 'tileheight' of a map */
+			std::vector<tson::Tileset>             m_tilesets;          /*! 'tilesets': Array of Tilesets */
+			std::string                            m_type;              /*! 'type': map (since 1.0) */
+			tson::Vector2f                         m_parallaxOrigin;    /*! Tiled v1.8: parallax origin in pixels. Defaults to 0. */
+			//int                                    m_version{};       /*! 'version': The JSON format version - Removed in Tileson v1.3.0*/
+
+			ParseStatus                            m_status {ParseStatus::OK};
+			std::string                            m_statusMessage {"OK"};
+
+			std::map<uint32_t, tson::Tile*>        m_tileMap{};           /*! key: Tile ID. Value: Pointer to Tile*/
+			std::vector<tson::TileDrawInfo>        m_tileDrawTable;       /*! index: gid without flip flags */
+			tson::AnimationClock                   m_animationClock;      /*! All tile animations of the map */
+
+			//v1.2.0
+			int                                    m_compressionLevel {-1};  /*! 'compressionlevel': The compression level to use for tile layer
+																			  *     data (defaults to -1, which means to use the algorithm default)
+																			  *     Introduced in Tiled 1.3*/
+			tson::DecompressorContainer *          m_decompressors {nullptr};
+			tson::Project *                        m_project {nullptr};
+			tson::TilesetCache *                   m_tilesetCache {nullptr};  /*! External tilesets are copied from here when set */
+			tson::TemplateCache *                  m_templateCache {nullptr}; /*! Object templates are copied from here when set */
+			IJson *                                m_parsingJson {nullptr};   /*! The json of the map. Only set while parsing */
+			bool                                   m_hasCustomLinkedFileParser {false};
+			std::map<uint32_t, tson::Tile>         m_flaggedTileMap{};    /*! key: Tile ID. Value: Tile*/
+
+			std::string                            m_classType{};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
+			std::shared_ptr<tson::TiledClass>      m_class {};
+
+			tson::LinkedFileParser                 m_linkedFileParser;     /*! callback function to parse linked files */
+			std::map<std::string, std::unique_ptr<IJson>> m_linkedFiles;  /*! key: relative path to linked file. Value: Pointer to loaded JSON */
+
+			std::unordered_map<int, std::pair<tson::Layer *, size_t>> m_objectIds;      /*! key: Object ID. Value: Layer containing the object and its index in that layer */
+			std::unordered_multimap<std::string, int>                  m_objectNames;    /*! key: Object name. Value: Object ID */
+
+			tson::LayerFilter                      m_layerFilter;          /*! Layers rejected by the filter are skipped while parsing */
+			tson::Rect                             m_tileRegion;           /*! If not empty, only the tiles inside it are decoded. In tile units */
+			std::unique_ptr<IJson>                 m_json;                 /*! Owns the json of the map while it has lazy layers that are not loaded */
+			std::unique_ptr<tson::DecompressorContainer> m_lazyDecompressors;  /*! Copy of the decompressors of the parser, used by lazy layers */
+			std::shared_ptr<tson::TemplateCache>   m_lazyTemplateCache;    /*! Keeps the template cache of the parser alive for lazy layers */
+			size_t                                 m_unloadedLayers {0};   /*! Number of lazy layers that are not loaded yet */
+	};
+
+	/*!
+	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
+	 * @tparam T The template value
+	 * @param name Name of the property
+	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 */
+	template<typename T>
+	T tson::Map::get(const std::string &name)
+	{
+		return m_properties.getValue<T>(name);
+	}
+}
+
+/*!
+ * When errors have happened before the map starts parsing, just keep the statuses
+ * @param status The status
+ * @param description Description of the status
+ */
+tson::Map::Map(tson::ParseStatus status, std::string description) : m_status {status}, m_statusMessage { std::move(description) }
+{
+
+}
+
+/*!
+ * Parses a json of a Tiled map.
+ * @param json A json object with the format of Map
+ * @param linkedFileParser A callback function that must return a IJson object when a linked file is found in the map
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+tson::Map::Map(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser)
+{
+	parse(json, decompressors, project, linkedFileParser);
+}
+
+/*!
+ * Parses a json of a Tiled map.
+ * @param json A json object with the format of Map
+ * @param linkedFileParser A callback function that must return a IJson object when a linked file is found in the map
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Map::parse(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser)
+{
+	m_decompressors = decompressors;
+	m_project = project;
+	m_linkedFileParser = linkedFileParser;
+	m_hasCustomLinkedFileParser = static_cast<bool>(linkedFileParser);
+	m_parsingJson = &json;
+
+	if(!m_linkedFileParser)
+	{  // build a default linked file parser out of processing relative paths to
+	   // the main json's location.
+		m_linkedFileParser = [&json](std::string relativePath) -> std::unique_ptr<IJson>
+		{
+			if(json.directory().empty())
+				return nullptr;
+
+			std::unique_ptr<IJson> linkedFileJson = json.create();
+			bool parseOk = linkedFileJson->parse(json.directory() / relativePath);
+			if(parseOk)
+				return linkedFileJson;
+			else
+				return nullptr;
+		};
+	}
+
+	bool allFound = true;
+	if(json.count("compressionlevel") > 0)
+		m_compressionLevel = json["compressionlevel"].get<int>(); //Tiled 1.3 - Optional
+
+	if(json.count("backgroundcolor") > 0) m_backgroundColor = Colori(json["backgroundcolor"].get<std::string>()); //Optional
+	if(json.count("width") > 0 && json.count("height") > 0 )
+		m_size = {json["width"].get<int>(), json["height"].get<int>()}; else allFound = false;
+	if(json.count("hexsidelength") > 0) m_hexsideLength = json["hexsidelength"].get<int>();         //Optional
+	if(json.count("infinite") > 0) m_isInfinite = json["infinite"].get<bool>();                     //Optional
+	if(json.count("nextlayerid") > 0) m_nextLayerId = json["nextlayerid"].get<int>();               //Optional
+	if(json.count("nextobjectid") > 0) m_nextObjectId = json["nextobjectid"].get<int>(); else allFound = false;
+	if(json.count("orientation") > 0) m_orientation = json["orientation"].get<std::string>(); else allFound = false;
+	if(json.count("renderorder") > 0) m_renderOrder = json["renderorder"].get<std::string>();       //Optional
+	if(json.count("staggeraxis") > 0) m_staggerAxis = json["staggeraxis"].get<std::string>();       //Optional
+	if(json.count("staggerindex") > 0) m_staggerIndex = json["staggerindex"].get<std::string>();    //Optional
+	if(json.count("tiledversion") > 0) m_tiledVersion = json["tiledversion"].get<std::string>(); else allFound = false;
+	if(json.count("tilewidth") > 0 && json.count("tileheight") > 0 )
+		m_tileSize = {json["tilewidth"].get<int>(), json["tileheight"].get<int>()}; else allFound = false;
+	if(json.count("type") > 0) m_type = json["type"].get<std::string>();                            //Optional
+	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+
+	//Removed - Changed from a float to string in Tiled v1.6, and old spec said int.
+	//Reason for removal is that it seems to have no real use, as TiledVersion is stored in another variable.
+	//if(json.count("version") > 0) m_version = json["version"].get<int>(); else allFound = false;
+
+	//More advanced data. Layers are only lazy when the map owns the json, which tson::Tileson does with setLazyLayers()
+	if(json.count("layers") > 0 && json["layers"].isArray())
+		tson::Layer::ParseLayers(json, this, m_layers, m_layerFilter, m_json != nullptr && m_json.get() == &json);
+
+	if(json.count("properties") > 0 && json["properties"].isArray())
+	{
+		auto &array = json.array("properties");
+		std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
+		{
+			m_properties.add(*item, m_project);
+		});
+	}
+
+	tson::Vector2f parallaxOrigin {0.f, 0.f};
+	if(json.count("parallaxoriginx") > 0)
+		parallaxOrigin.x = json["parallaxoriginx"].get<float>();
+	if(json.count("parallaxoriginy") > 0)
+		parallaxOrigin.y = json["parallaxoriginy"].get<float>();
+
+	m_parallaxOrigin = parallaxOrigin;
+
+	if(!createTilesetData(json))
+		allFound = false;
+
+	processData();
+	buildObjectLookup();
+
+	m_parsingJson = nullptr;
+	if(m_unloadedLayers == 0)
+	{
+		m_linkedFiles.clear(); // close all open linked json files
+		m_json.reset();
+	}
+
+	return allFound;
+}
+
+/*!
+ * Attempts to parse a linked file found in the map.
+ * @param relativePath Path to the linked file, relative to the map file.
+ * @return a IJson pointer to the parsed file.
+ */
+tson::IJson* tson::Map::parseLinkedFile(const std::string& relativePath)
+{
+	auto it = m_linkedFiles.find(relativePath);
+	if(it == m_linkedFiles.end())
+	{
+		if (!m_linkedFileParser) return nullptr;
+		std::unique_ptr<IJson> linkedFileJson = m_linkedFileParser(relativePath);
+		if(!linkedFileJson)
+			return nullptr;
+
+		auto result = m_linkedFiles.emplace(relativePath, std::move(linkedFileJson));
+		return result.first->second.get();
+	}
+	else return it->second.get();
+}
+
+/*!
+ * Tileset data must be created in two steps to prevent malformed tson::Tileset pointers inside tson::Tile
+ */
+bool tson::Map::createTilesetData(IJson &json)
+{
+	bool ok = true;
+	if(json.count("tilesets") > 0 && json["tilesets"].isArray())
+	{
+		//First created tileset objects
+		auto &tilesets = json.array("tilesets");
+		std::for_each(tilesets.begin(), tilesets.end(), [&](std::unique_ptr<IJson> &)
+		{
+			m_tilesets.emplace_back();
+		});
+
+		int i = 0;
+		//Then do the parsing
+		std::for_each(tilesets.begin(), tilesets.end(), [&](std::unique_ptr<IJson> &item)
+		{
+			item->directory(json.directory());
+			if(!m_tilesets[i].parse(*item, this, m_tilesetCache))
+				ok = false;
+
+			++i;
+		});
+	}
+	return ok;
+}
+
+/*!
+ * Processes the parsed data and uses the data to create helpful objects, like tile maps.
+ */
+void tson::Map::processData()
+{
+	m_tileMap.clear();
+	for(auto &tileset : m_tilesets)
+	{
+		  std::set<std::uint32_t> usedIds;
+		  for(auto& tile : tileset.getTiles())
+		  {
+			  if (usedIds.count(tile.getGid()) != 0)
+			  {
+				  continue;
+			  }
+			  usedIds.insert(tile.getGid());
+			  m_tileMap[tile.getGid()] = &tile;
+		  }
+	}
+	std::for_each(m_layers.begin(), m_layers.end(), [&](tson::Layer &layer)
+	{
+		layer.assignTileMap(&m_tileMap);
+		if(layer.isLoaded())
+			processLayer(layer);
+	});
+
+	buildTileDrawTable();
+	m_animationClock.build(m_tilesets);
+}
+
+/*!
+ * Creates the tile data of a layer, and adds the flipped tiles it uses to the tile map.
+ */
+void tson::Map::processLayer(tson::Layer &layer)
+{
+	layer.createTileData(m_size, m_isInfinite);
+	const std::set<uint32_t> &flaggedTiles = layer.getUniqueFlaggedTiles();
+	for(uint32_t ftile : flaggedTiles)
+	{
+		tson::Tile tile = tson::Tile::CreateFlippedTile(ftile, layer.getMap());
+		if(m_tileMap.count(tile.getGid()))
+		{
+			tson::Tile *originalTile = m_tileMap[tile.getGid()];
+			tile.addTilesetAndPerformCalculations(originalTile->getTileset());
+			tile.setProperties(originalTile->getProperties());
+			m_flaggedTileMap[ftile] = tile;
+			m_tileMap[ftile] = &m_flaggedTileMap[ftile];
+		}
+	}
+	layer.resolveFlaggedTiles();
+}
+
+/*!
+ * Reads the deferred part of a lazy layer, and does what parse() does for the layers that are not lazy.
+ * The json of the map is released when the last layer is loaded.
+ */
+void tson::Map::loadLayer(tson::Layer &layer)
+{
+	IJson *json = layer.m_lazyJson;
+	layer.m_lazyJson = nullptr;
+
+	m_parsingJson = m_json.get();
+	layer.parseData(*json);
+	m_parsingJson = nullptr;
+
+	//Only the top level layers have tile data, like in processData()
+	if(layer.m_tileMap != nullptr)
+		processLayer(layer);
+	if(!layer.m_objects.empty())
+		buildObjectLookup();
+
+	if(--m_unloadedLayers == 0)
+	{
+		m_linkedFiles.clear();
+		m_json.reset();
+	}
+}
+
+void tson::Map::loadLayers(std::vector<tson::Layer> &layers)
+{
+	for(auto &layer : layers)
+	{
+		layer.load();
+		loadLayers(layer.m_layers);
+	}
+}
+
+/*!
+ * Precalculates the drawing rect, UVs and tile offset of every gid of every tileset, so they can be found with a single array lookup.
+ * Unlike tson::Tile::getDrawingRect(), the tile size of the tileset is used for the position of a tile in the image,
+ * which matches Tiled when the tilesets have a different tile size than the map.
+ */
+void tson::Map::buildTileDrawTable()
+{
+	m_tileDrawTable.clear();
+
+	uint32_t maxGid = 0;
+	for(auto &tileset : m_tilesets)
+	{
+		if(tileset.getTileCount() > 0)
+			maxGid = std::max(maxGid, static_cast<uint32_t>(tileset.getFirstgid() + tileset.getTileCount() - 1));
+		for(auto &tile : tileset.getTiles())
+			maxGid = std::max(maxGid, tile.getGid());
+	}
+	if(maxGid == 0)
+		return;
+
+	m_tileDrawTable.resize(static_cast<size_t>(maxGid) + 1);
+	for(auto &tileset : m_tilesets)
+	{
+		tson::Vector2i const tileOffset = tileset.getTileOffset();
+		if(tileset.getType() == tson::TilesetType::ImageCollectionTileset)
+		{
+			for(auto &tile : tileset.getTiles())
+			{
+				tson::TileDrawInfo &info = m_tileDrawTable[tile.getGid()];
+				const tson::Vector2i &imageSize = tile.getImageSize();
+				info.tile = &tile;
+				info.tileset = &tileset;
+				info.tileOffset = tileOffset;
+				info.drawingRect = tile.getSubRectangle();
+				if(imageSize.x > 0 && imageSize.y > 0)
+				{
+					info.uvTopLeft = {static_cast<float>(info.drawingRect.x) / static_cast<float>(imageSize.x),
+									  static_cast<float>(info.drawingRect.y) / static_cast<float>(imageSize.y)};
+					info.uvBottomRight = {static_cast<float>(info.drawingRect.x + info.drawingRect.width) / static_cast<float>(imageSize.x),
+										  static_cast<float>(info.drawingRect.y + info.drawingRect.height) / static_cast<float>(imageSize.y)};
+				}
+			}
+			continue;
+		}
+
+		int const columns = tileset.getColumns();
+		const tson::Vector2i &tileSize = tileset.getTileSize();
+		const tson::Vector2i &imageSize = tileset.getImageSize();
+		if(columns <= 0)
+			continue;
+
+		auto const firstGid = static_cast<uint32_t>(tileset.getFirstgid());
+		for(int id = 0; id < tileset.getTileCount(); ++id)
+		{
+			tson::TileDrawInfo &info = m_tileDrawTable[firstGid + static_cast<uint32_t>(id)];
+			info.tileset = &tileset;
+			info.tileOffset = tileOffset;
+			info.drawingRect = {tileset.getMargin() + (id % columns) * (tileSize.x + tileset.getSpacing()),
+								tileset.getMargin() + (id / columns) * (tileSize.y + tileset.getSpacing()),
+								tileSize.x, tileSize.y};
+			if(imageSize.x > 0 && imageSize.y > 0)
+			{
+				info.uvTopLeft = {static_cast<float>(info.drawingRect.x) / static_cast<float>(imageSize.x),
+								  static_cast<float>(info.drawingRect.y) / static_cast<float>(imageSize.y)};
+				info.uvBottomRight = {static_cast<float>(info.drawingRect.x + tileSize.x) / static_cast<float>(imageSize.x),
+									  static_cast<float>(info.drawingRect.y + tileSize.y) / static_cast<float>(imageSize.y)};
+			}
+		}
+
+		for(auto &tile : tileset.getTiles())
+		{
+			if(tile.getGid() < m_tileDrawTable.size() && m_tileDrawTable[tile.getGid()].tileset == &tileset)
+				m_tileDrawTable[tile.getGid()].tile = &tile;
+		}
+	}
+}
+
+/*!
+ * 'backgroundcolor': Color created from a hex-formatted color string (#RRGGBB or #AARRGGBB) (optional)
+ * @return string as color
+ */
+const tson::Colori &tson::Map::getBackgroundColor() const
+{
+	return m_backgroundColor;
+}
+
+/*!
+ * 'width' and 'height' of a Tiled map
+ * @return
+ */
+const tson::Vector2<int> &tson::Map::getSize() const
+{
+	return m_size;
+}
+
+/*!
+ * 'hexsidelength': Length of the side of a hex tile in pixels
+ * @return
+ */
+int tson::Map::getHexsideLength() const
+{
+	return m_hexsideLength;
+}
+
+/*!
+ * 'infinite': Whether the map has infinite dimensions
+ * @return
+ */
+bool tson::Map::isInfinite() const
+{
+	return m_isInfinite;
+}
+
+/*!
+ * 'nextlayerid': Auto-increments for each layer
+ * @return
+ */
+int tson::Map::getNextLayerId() const
+{
+	return m_nextLayerId;
+}
+
+/*!
+ * 'nextobjectid': Auto-increments for each placed object
+ * @return
+ */
+int tson::Map::getNextObjectId() const
+{
+	return m_nextObjectId;
+}
+
+/*!
+ * 'orientation': orthogonal, isometric, staggered or hexagonal
+ * @return
+ */
+const std::string &tson::Map::getOrientation() const
+{
+	return m_orientation;
+}
+
+/*!
+ * 'renderorder': Rendering direction (orthogonal maps only)
+ * @return
+ */
+const std::string &tson::Map::getRenderOrder() const
+{
+	return m_renderOrder;
+}
+
+/*!
+ * 'staggeraxis': x or y (staggered / hexagonal maps only)
+ * @return
+ */
+const std::string &tson::Map::getStaggerAxis() const
+{
+	return m_staggerAxis;
+}
+
+/*!
+ * 'staggerindex': odd or even (staggered / hexagonal maps only)
+ * @return
+ */
+const std::string &tson::Map::getStaggerIndex() const
+{
+	return m_staggerIndex;
+}
+
+/*!
+ * 'tiledversion': The Tiled version used to save the file
+ * @return
+ */
+const std::string &tson::Map::getTiledVersion() const
+{
+	return m_tiledVersion;
+}
+
+/*!
+ * 'tilewidth': and 'tileheight' of a map
+ * @return
+ */
+const tson::Vector2<int> &tson::Map::getTileSize() const
+{
+	return m_tileSize;
+}
+
+/*!
+ * 'type': map (since 1.0)
+ * @return
+ */
+const std::string &tson::Map::getType() const
+{
+	return m_type;
+}
+
+/*!
+ * 'version': The JSON format version
+ * @return
+ */
+//int tson::Map::getVersion() const
+//{
+//    return m_version;
+//}
+
+/*!
+ * 'layers': Array of layers. group on
+ * @return
+ */
+std::vector<tson::Layer> &tson::Map::getLayers()
+{
+	return m_layers;
+}
+
+/*!
+ * 'properties': A list of properties (name, value, type).
+ * @return
+ */
+tson::PropertyCollection &tson::Map::getProperties()
+{
+	return m_properties;
+}
+
+/*!
+ * 'tilesets': Array of Tilesets
+ * @return
+ */
+std::vector<tson::Tileset> &tson::Map::getTilesets()
+{
+	return m_tilesets;
+}
+
+tson::Layer *tson::Map::getLayer(const std::string &name)
+{
+	auto result = std::find_if(m_layers.begin(), m_layers.end(), [&](const tson::Layer &item) { return item.getName() == name; });
+	if(result == m_layers.end())
+		return nullptr;
+
+	return &result.operator*();
+}
+
+/*!
+ * Makes external tilesets be copied from a cache instead of being parsed. Must be set before parsing.
+ * tson::Tileson sets this when it has a tileset cache.
+ * @param tilesetCache The cache. nullptr parses every external tileset.
+ */
+void tson::Map::setTilesetCache(tson::TilesetCache *tilesetCache)
+{
+	m_tilesetCache = tilesetCache;
+}
+
+/*!
+ * Makes template instances be copied from a cache of parsed templates, instead of merging the template file into every instance.
+ * Must be set before parsing. tson::Tileson sets this when it has a template cache.
+ * @param templateCache The cache. nullptr reads the template file for every instance.
+ */
+void tson::Map::setTemplateCache(tson::TemplateCache *templateCache)
+{
+	m_templateCache = templateCache;
+}
+
+/*!
+ * Skips the layers rejected by the filter. Must be set before parsing. tson::Tileson sets this when it has a layer filter.
+ * A rejected group layer is kept if any of its child layers are accepted. All child layers of an accepted group are kept.
+ * @param layerFilter The filter. An empty filter keeps every layer.
+ */
+void tson::Map::setLayerFilter(tson::LayerFilter layerFilter)
+{
+	m_layerFilter = std::move(layerFilter);
+}
+
+/*!
+ * Makes the tile layers of a finite map only decode the tiles inside a rectangle. Must be set before parsing.
+ * tson::Tileson sets this when it has a tile region. See tson::Layer::hasRegion() for how such layers are stored.
+ * Infinite maps only read the chunks that overlap the rectangle.
+ * @param tileRegion The rectangle in tile units. An empty rectangle decodes every tile.
+ */
+void tson::Map::setTileRegion(const tson::Rect &tileRegion)
+{
+	m_tileRegion = tileRegion;
+}
+
+/*!
+ * The rectangle the tile layers were decoded with. Empty if every tile was decoded.
+ */
+const tson::Rect &tson::Map::getTileRegion() const
+{
+	return m_tileRegion;
+}
+
+/*!
+ * Loads every lazy layer of the map that is not loaded yet (see tson::Tileson::setLazyLayers()).
+ * Does nothing for maps without lazy layers.
+ */
+void tson::Map::loadLayers()
+{
+	if(m_unloadedLayers > 0)
+		loadLayers(m_layers);
+}
+
+/*!
+ * Whether any lazy layer of the map has not been loaded yet. See tson::Tileson::setLazyLayers().
+ */
+bool tson::Map::hasUnloadedLayers() const
+{
+	return m_unloadedLayers > 0;
+}
+
+/*!
+ * Gets a tileset by name
+ *
+ * @param name Name of the tileset
+ * @return tileset with the matching name
+ */
+tson::Tileset *tson::Map::getTileset(const std::string &name)
+{
+	auto result = std::find_if(m_tilesets.begin(), m_tilesets.end(), [&](const tson::Tileset &item) {return item.getName() == name; });
+	if(result == m_tilesets.end())
+		return nullptr;
+
+	return &result.operator*();
+}
+
+/*!
+ * Gets a tileset by gid (graphical ID of a tile). These are always unique, no matter how many tilesets you have
+ *
+ * @param gid Graphical ID of a tile
+ * @return tileset related to the actual gid
+ */
+tson::Tileset *tson::Map::getTilesetByGid(uint32_t gid)
+{
+	auto result = std::find_if(m_tilesets.begin(), m_tilesets.end(), [&](const tson::Tileset &tileset)
+	{
+		auto const firstId = static_cast<uint32_t>(tileset.getFirstgid()); //First tile id of the tileset
+		auto const lastId =  static_cast<uint32_t>((firstId + tileset.getTileCount()) - 1);
+
+		return (gid >= firstId && gid <= lastId);
+	});
+	if(result == m_tilesets.end())
+		return nullptr;
+
+	return &result.operator*();
+}
 
 /*!
  * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
  * @param name Name of the property
  * @return
  */
-tson::Property *tson::Layer::getProp(const std::string &name)
+tson::Property *tson::Map::getProp(const std::string &name)
+{
+	if(m_properties.hasProperty(name))
+		return m_properties.getProperty(name);
+	return nullptr;
+}
+
+tson::ParseStatus tson::Map::getStatus() const
+{
+	return m_status;
+}
+
+const std::string &tson::Map::getStatusMessage() const
+{
+	return m_statusMessage;
+}
+
+/*!
+ * Get a tile map with pointers to every existing tile.
+ * @return
+ */
+const std::map<uint32_t, tson::Tile *> &tson::Map::getTileMap() const
+{
+	return m_tileMap;
+}
+
+/*!
+ * A table with drawing information for each gid, where the index is the gid without flip flags.
+ * Index 0 and gids not used by any tileset have a nullptr tile and tileset.
+ * @return The table of drawing information
+ */
+const std::vector<tson::TileDrawInfo> &tson::Map::getTileDrawTable() const
+{
+	return m_tileDrawTable;
+}
+
+/*!
+ * The animations of all animated tiles in the map, sharing one clock.
+ * Call update() on it once per frame, and use getCurrentGid() to find the gid to draw for an animated tile.
+ * @return The animation clock of the map
+ */
+tson::AnimationClock &tson::Map::getAnimationClock()
+{
+	return m_animationClock;
+}
+
+/*!
+ * Gets the drawing information of a gid. Flip flags are ignored.
+ * @param gid The gid, with or without flip flags
+ * @return The drawing information, or nullptr if no tileset contains the gid.
+ */
+const tson::TileDrawInfo *tson::Map::getTileDrawInfo(uint32_t gid) const
+{
+	gid &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+	if(gid >= m_tileDrawTable.size() || m_tileDrawTable[gid].tileset == nullptr)
+		return nullptr;
+
+	return &m_tileDrawTable[gid];
+}
+
+tson::DecompressorContainer *tson::Map::getDecompressors()
+{
+	return m_decompressors;
+}
+
+/*!
+ * 'compressionlevel': The compression level to use for tile layer data (defaults to -1, which means to use the algorithm default)
+ *
+ * @return The compression level
+ */
+int tson::Map::getCompressionLevel() const
+{
+	return m_compressionLevel;
+}
+
+/*!
+ * New in Tiled v1.8
+ * Gets the parallax origin in pixels. Defaults to 0.
+ * @return A vector with the x and y values of the parallax origin.
+ */
+const tson::Vector2f &tson::Map::getParallaxOrigin() const
+{
+	return m_parallaxOrigin;
+}
+
+tson::Project *tson::Map::getProject()
+{
+	return m_project;
+}
+
+const std::string &tson::Map::getClassType() const
+{
+	return m_classType;
+}
+
+/*!
+ * Builds the map-wide lookup tables used by getObj(), getObjLayer(), firstObj(), getObjsByName() and resolveObjectRef().
+ * Objects in every layer are included, also the ones inside group layers. Lazy layers are loaded by those functions, not by this one.
+ * This is done automatically at the end of parse(), but must be called again if objects or layers are added or removed afterwards.
+ */
+void tson::Map::buildObjectLookup()
+{
+	m_objectIds.clear();
+	m_objectNames.clear();
+	addObjectsToLookup(m_layers);
+}
+
+void tson::Map::addObjectsToLookup(std::vector<tson::Layer> &layers)
+{
+	for(auto &layer : layers)
+	{
+		//Not through getObjects(), which would load lazy layers
+		std::vector<tson::Object> &objects = layer.m_objects;
+		for(size_t i = 0; i < objects.size(); ++i)
+		{
+			//If an id exists more than once, the first one wins, like with Layer::getObj()
+			if(m_objectIds.emplace(objects[i].getId(), std::make_pair(&layer, i)).second)
+				m_objectNames.emplace(objects[i].getName(), objects[i].getId());
+		}
+		addObjectsToLookup(layer.m_layers);
+	}
+}
+
+/*!
+ * Get an object by ID, no matter which layer it belongs to. Runs in constant time.
+ * @param id Unique ID of the object
+ * @return A pointer to the object if found. nullptr otherwise.
+ */
+tson::Object *tson::Map::getObj(int id)
+{
+	loadLayers();
+	auto iter = m_objectIds.find(id);
+	if(iter == m_objectIds.end())
+		return nullptr;
+
+	return &iter->second.first->getObjects()[iter->second.second];
+}
+
+/*!
+ * Get the layer containing the object with the given ID. Runs in constant time.
+ * @param id Unique ID of the object
+ * @return A pointer to the layer if an object with the ID was found. nullptr otherwise.
+ */
+tson::Layer *tson::Map::getObjLayer(int id)
+{
+	loadLayers();
+	auto iter = m_objectIds.find(id);
+	return (iter == m_objectIds.end()) ? nullptr : iter->second.first;
+}
+
+/*!
+ * Returns the object with the given name and the lowest ID, searching all layers.
+ * @param name Name of the object to find.
+ * @return A pointer to the object if found. nullptr otherwise.
+ */
+tson::Object *tson::Map::firstObj(const std::string &name)
+{
+	loadLayers();
+	auto range = m_objectNames.equal_range(name);
+	if(range.first == range.second)
+		return nullptr;
+
+	int id = range.first->second;
+	for(auto iter = range.first; iter != range.second; ++iter)
+		id = std::min(id, iter->second);
+
+	return getObj(id);
+}
+
+/*!
+ * Gets all objects with a name that equals the parameter, searching all layers.
+ * @param name Name of the objects to return
+ * @return Pointers to all objects with a matching name, sorted by ID.
+ */
+std::vector<tson::Object *> tson::Map::getObjsByName(const std::string &name)
+{
+	loadLayers();
+	auto range = m_objectNames.equal_range(name);
+	std::vector<int> ids;
+	for(auto iter = range.first; iter != range.second; ++iter)
+		ids.push_back(iter->second);
+	std::sort(ids.begin(), ids.end());
+
+	std::vector<tson::Object *> found;
+	found.reserve(ids.size());
+	for(int id : ids)
+		found.push_back(getObj(id));
+
+	return found;
+}
+
+/*!
+ * Resolves a property of the 'object' type into the object it refers to.
+ * @param property A property of type tson::Type::Object
+ * @return A pointer to the referenced object. nullptr if the property is not an object reference or the object does not exist.
+ */
+tson::Object *tson::Map::resolveObjectRef(const tson::Property *property)
+{
+	if(property == nullptr || property->getType() != tson::Type::Object || !property->getValue().has_value())
+		return nullptr;
+
+	if(property->getValueType() == typeid(uint32_t))
+		return getObj(static_cast<int>(property->getValue<uint32_t>()));
+	else if(property->getValueType() == typeid(int))
+		return getObj(property->getValue<int>());
+
+	return nullptr;
+}
+
+#endif //TILESON_MAP_HPP
+
+/*** End of inlined file: Map.hpp ***/
+
+
+/*** Start of inlined file: TilesetCache.hpp ***/
+#ifndef TILESON_TILESETCACHE_HPP
+#define TILESON_TILESETCACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <system_error>
+
+namespace tson
+{
+	/*!
+	 * Keeps parsed external tilesets ('source' in a map), so maps sharing a tileset file only read and parse it once.
+	 *
+	 * Tilesets are keyed by their canonical path and the time they were last written to, so a tileset changed on disk is parsed again.
+	 * The cached tileset is never handed out directly: Each map gets a copy bound to the map and to its own 'firstgid'.
+	 * All functions are thread safe, so one cache can be shared by several tson::Tileson instances using the same tson::Project.
+	 * The class and enum properties of a cached tileset are resolved against the project of the map that parsed it first.
+	 *
+	 * Example:
+	 * tson::Tileson t;
+	 * t.setTilesetCache(std::make_shared<tson::TilesetCache>());
+	 * for(const auto &data : world.getMapData())
+	 *     maps.push_back(t.parse(data.path));
+	 */
+	class TilesetCache
+	{
+		public:
+			/*!
+			 * A parsed tileset file
+			 */
+			class Entry
+			{
+				public:
+					std::shared_ptr<const tson::Tileset> tileset;
+					fs::file_time_type                   modified {};
+					bool                                 allFound {false}; /*! true if all mandatory fields were found */
+			};
+
+			inline TilesetCache() = default;
+
+			inline std::shared_ptr<const Entry> get(const fs::path &path, IJson &json, tson::Map *map);
+			inline void clear();
+
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline size_t getHits() const;
+			[[nodiscard]] inline size_t getMisses() const;
+
+		private:
+			mutable std::mutex                                              m_mutex;
+			std::unordered_map<std::string, std::shared_ptr<const Entry>>   m_entries;  /*! Canonical path -> tileset */
+			size_t                                                          m_hits {};
+			size_t                                                          m_misses {};
+	};
+
+	/*!
+	 * Gets a tileset file, parsing it if it is not cached or has been changed since it was parsed.
+	 * The tileset is parsed outside the lock, so different tilesets can be parsed at the same time.
+	 * @param path Path to the tileset file
+	 * @param json Used to create the json parser of the tileset file
+	 * @param map The map asking for the tileset. Only used while parsing, for its tson::Project.
+	 * @return The parsed tileset. nullptr if the file could not be read.
+	 */
+	std::shared_ptr<const TilesetCache::Entry> TilesetCache::get(const fs::path &path, IJson &json, tson::Map *map)
+	{
+		std::error_code error;
+		fs::path canonical = fs::canonical(path, error);
+		if(error)
+			return nullptr;
+		fs::file_time_type modified = fs::last_write_time(canonical, error);
+		if(error)
+			return nullptr;
+
+		std::string key = canonical.generic_string();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_entries.find(key);
+			if(it != m_entries.end() && it->second->modified == modified)
+			{
+				++m_hits;
+				return it->second;
+			}
+			++m_misses;
+		}
+
+		std::unique_ptr<IJson> file = json.create();
+		if(!file->parse(path))
+			return nullptr;
+
+		std::shared_ptr<tson::Tileset> tileset = std::make_shared<tson::Tileset>();
+		auto entry = std::make_shared<Entry>();
+		entry->modified = modified;
+		entry->allFound = tileset->parseSource(*file, path, map);
+		entry->tileset = std::move(tileset);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::shared_ptr<const Entry> &cached = m_entries[key];
+		if(cached == nullptr || cached->modified != modified)
+			cached = std::move(entry);
+		return cached;
+	}
+
+	/*!
+	 * Removes every cached tileset. Maps that are already parsed keep their own copies.
+	 */
+	void TilesetCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+	}
+
+	/*!
+	 * Number of cached tileset files
+	 */
+	size_t TilesetCache::size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+
+	/*!
+	 * Number of times a tileset was found in the cache
+	 */
+	size_t TilesetCache::getHits() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	/*!
+	 * Number of times a tileset had to be parsed
+	 */
+	size_t TilesetCache::getMisses() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_misses;
+	}
+}
+
+#endif //TILESON_TILESETCACHE_HPP
+
+/*** End of inlined file: TilesetCache.hpp ***/
+
+
+/*** Start of inlined file: TemplateCache.hpp ***/
+#ifndef TILESON_TEMPLATECACHE_HPP
+#define TILESON_TEMPLATECACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <system_error>
+
+namespace tson
+{
+	/*!
+	 * The object of a template file (.tj or .json), parsed once. Template instances copy it and only read their overrides.
+	 */
+	class ObjectTemplate
+	{
+		public:
+			inline ObjectTemplate() = default;
+			inline bool parse(IJson &json, tson::Map *map);
+
+			[[nodiscard]] inline const tson::Object &getObject() const;
+			[[nodiscard]] inline bool hasField(const std::string &name) const;
+
+		private:
+			tson::Object            m_object;   /*! Not bound to a map */
+			std::set<std::string>   m_fields;   /*! The fields of the object that exist in the template file */
+	};
+
+	/*!
+	 * Keeps parsed object templates, so maps using the same template files only read and parse them once.
+	 *
+	 * Templates are keyed by their canonical path and the time they were last written to, so a template changed on disk is parsed again.
+	 * All functions are thread safe, so one cache can be shared by several tson::Tileson instances using the same tson::Project.
+	 * Only templates read from files are cached: Maps parsed with a custom tson::LinkedFileParser parse their templates as before.
+	 *
+	 * Example:
+	 * tson::Tileson t;
+	 * t.setTemplateCache(std::make_shared<tson::TemplateCache>());
+	 */
+	class TemplateCache
+	{
+		public:
+			inline TemplateCache() = default;
+
+			inline std::shared_ptr<const tson::ObjectTemplate> get(const fs::path &path, IJson &json, tson::Map *map);
+			inline void clear();
+
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline size_t getHits() const;
+			[[nodiscard]] inline size_t getMisses() const;
+
+		private:
+			class Entry
+			{
+				public:
+					fs::file_time_type                          modified {};
+					std::shared_ptr<const tson::ObjectTemplate> objectTemplate;
+			};
+
+			mutable std::mutex                      m_mutex;
+			std::unordered_map<std::string, Entry>  m_entries;  /*! Canonical path -> template */
+			size_t                                  m_hits {};
+			size_t                                  m_misses {};
+	};
+
+	/*!
+	 * Parses the 'object' of a template file
+	 * @param json The template file
+	 * @param map The map asking for the template. Only used while parsing, for its tson::Project.
+	 * @return false if the file has no 'object'
+	 */
+	bool ObjectTemplate::parse(IJson &json, tson::Map *map)
+	{
+		IJson *object = readField("object", json);
+		if(object == nullptr)
+			return false;
+
+		static const char *const Fields[] {"ellipse", "point", "text", "gid", "id", "name", "rotation", "type", "class", "visible",
+										   "width", "height", "x", "y", "polygon", "polyline"};
+		for(const char *field : Fields)
+		{
+			if(object->count(field) > 0)
+				m_fields.emplace(field);
+		}
+
+		m_object.parse(*object, map);
+		m_object.m_map = nullptr;
+		return true;
+	}
+
+	/*!
+	 * The template object, with every field of the template file applied
+	 */
+	const tson::Object &ObjectTemplate::getObject() const
+	{
+		return m_object;
+	}
+
+	/*!
+	 * true if the template file has a field, so instances without it use the one of the template
+	 */
+	bool ObjectTemplate::hasField(const std::string &name) const
+	{
+		return m_fields.count(name) > 0;
+	}
+
+	/*!
+	 * Gets a template file, parsing it if it is not cached or has been changed since it was parsed.
+	 * The template is parsed outside the lock, so different templates can be parsed at the same time.
+	 * @param path Path to the template file
+	 * @param json Used to create the json parser of the template file
+	 * @param map The map asking for the template. Only used while parsing.
+	 * @return The parsed template. nullptr if the file could not be read, or has no object.
+	 */
+	std::shared_ptr<const tson::ObjectTemplate> TemplateCache::get(const fs::path &path, IJson &json, tson::Map *map)
+	{
+		std::error_code error;
+		fs::path canonical = fs::canonical(path, error);
+		if(error)
+			return nullptr;
+		fs::file_time_type modified = fs::last_write_time(canonical, error);
+		if(error)
+			return nullptr;
+
+		std::string key = canonical.generic_string();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_entries.find(key);
+			if(it != m_entries.end() && it->second.modified == modified)
+			{
+				++m_hits;
+				return it->second.objectTemplate;
+			}
+			++m_misses;
+		}
+
+		std::unique_ptr<IJson> file = json.create();
+		std::shared_ptr<tson::ObjectTemplate> objectTemplate = std::make_shared<tson::ObjectTemplate>();
+		if(!file->parse(path) || !objectTemplate->parse(*file, map))
+			return nullptr;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Entry &entry = m_entries[key];
+		if(entry.objectTemplate == nullptr || entry.modified != modified)
+			entry = {modified, std::move(objectTemplate)};
+		return entry.objectTemplate;
+	}
+
+	/*!
+	 * Removes every cached template
+	 */
+	void TemplateCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+	}
+
+	/*!
+	 * Number of cached template files
+	 */
+	size_t TemplateCache::size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+
+	/*!
+	 * Number of times a template was found in the cache
+	 */
+	size_t TemplateCache::getHits() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	/*!
+	 * Number of times a template had to be parsed
+	 */
+	size_t TemplateCache::getMisses() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_misses;
+	}
+}
+
+#endif //TILESON_TEMPLATECACHE_HPP
+
+/*** End of inlined file: TemplateCache.hpp ***/
+
+
+/*** Start of inlined file: TiledEnum.hpp ***/
+//
+// Created by robin on 06.06.22.
+//
+
+#ifndef TILESON_TILEDENUM_HPP
+#define TILESON_TILEDENUM_HPP
+
+namespace tson
+{
+	class EnumDefinition
+	{
+		public:
+			inline explicit EnumDefinition(IJson &json);
+			inline uint32_t getValue(const std::string &str);
+			inline std::string getValue(uint32_t num);
+			inline std::vector<std::string> getValues(uint32_t num);
+			inline bool exists(const std::string &str);
+			inline bool exists(uint32_t num);
+
+			[[nodiscard]] inline uint32_t getId() const;
+			[[nodiscard]] inline uint32_t getMaxValue() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline EnumStorageType getStorageType() const;
+			[[nodiscard]] inline bool hasValuesAsFlags() const;
+
+		private:
+			inline bool hasFlag(uint32_t value, uint32_t flag) const;
+			uint32_t m_id {};
+			uint32_t m_maxValue {};
+			std::string m_name {};
+			std::map<uint32_t, std::string> m_values {};
+			bool m_valuesAsFlags {false};
+			EnumStorageType m_storageType { EnumStorageType::Unspecified };
+	};
+
+	EnumDefinition::EnumDefinition(IJson &json)
+	{
+		m_id = json.get<uint32_t>("id");
+		m_name = json.get<std::string>("name");
+		std::string type = json.get<std::string>("storageType");
+		m_storageType = (type == "int") ? EnumStorageType::Int : (type == "string") ? EnumStorageType::String : EnumStorageType::Unspecified;
+		m_valuesAsFlags = json.get<bool>("valuesAsFlags");
+
+		if(json.count("values") > 0 && json["values"].isArray())
+		{
+			m_values[0] = "None";
+			uint32_t valueCounter = (m_valuesAsFlags) ? 1 : 0;
+			uint8_t flagBit = 1;
+			auto &array = json.array("values");
+			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
+			{
+				std::string v = item->get<std::string>();
+				m_values[valueCounter] = v;
+				if(m_valuesAsFlags)
+				{
+					valueCounter = 1 << flagBit;
+					++flagBit;
+				}
+				else
+				{
+					++valueCounter;
+				}
+			});
+
+			m_maxValue = valueCounter;
+		}
+	}
+
+	uint32_t EnumDefinition::getValue(const std::string &str)
+	{
+		auto result = std::find_if(m_values.begin(), m_values.end(), [&](const std::pair<uint32_t, std::string> &pair)
+		{
+			return pair.second == str;
+		});
+
+		if(result != m_values.end())
+			return result->first;
+
+		return 0;
+	}
+
+	std::string EnumDefinition::getValue(uint32_t num)
+	{
+		return (m_values.count(num) > 0) ? m_values[num] : "";
+	}
+
+	bool EnumDefinition::hasValuesAsFlags() const
+	{
+		return m_valuesAsFlags;
+	}
+
+	bool EnumDefinition::exists(const std::string &str)
+	{
+		auto result = std::find_if(m_values.begin(), m_values.end(), [&](const std::pair<uint32_t, std::string> &pair)
+		{
+			return pair.second == str;
+		});
+
+		if(result != m_values.end())
+			return true;
+
+		return false;
+	}
+
+	bool EnumDefinition::exists(uint32_t num) { return (m_values.count(num) > 0); }
+
+	uint32_t EnumDefinition::getId() const
+	{
+		return m_id;
+	}
+
+	const std::string &EnumDefinition::getName() const
+	{
+		return m_name;
+	}
+
+	EnumStorageType EnumDefinition::getStorageType() const
+	{
+		return m_storageType;
+	}
+
+	uint32_t EnumDefinition::getMaxValue() const
+	{
+		return m_maxValue;
+	}
+
+	std::vector<std::string> EnumDefinition::getValues(uint32_t num)
+	{
+		std::vector<std::string> values;
+		if(m_valuesAsFlags)
+		{
+			uint32_t flag = 0;
+			uint32_t i = 0;
+			while(flag < m_maxValue)
+			{
+				flag = 1 << i;
+				++i;
+				if(m_values.count(flag) > 0 && hasFlag(num, flag))
+				{
+					values.emplace_back(m_values[flag]);
+				}
+			}
+		}
+		else
+		{
+			std::string v = getValue(num);
+			if(!v.empty())
+				values.emplace_back();
+		}
+
+		return values;
+	}
+
+	bool EnumDefinition::hasFlag(uint32_t value, uint32_t flag) const
+	{
+		return ((value & flag) == flag);
+	}
+
+	class EnumValue
+	{
+		public:
+			inline EnumValue() = default;
+			inline EnumValue(uint32_t value, EnumDefinition *definition);
+			inline EnumValue(const std::string &value, EnumDefinition *definition);
+
+			[[nodiscard]] inline uint32_t getValue() const;
+			inline std::string getValueName() const;
+			[[nodiscard]] inline std::vector<std::string> getValueNames() const;
+			[[nodiscard]] inline EnumDefinition *getDefinition() const;
+
+			inline bool hasFlagValue(uint32_t flag) const;
+			template <typename T>
+			inline bool hasFlag(T flags) const;
+			inline bool hasAnyFlagValue(uint32_t flags) const;
+			template <typename T>
+			inline bool hasAnyFlag(T flags) const;
+			[[nodiscard]] inline bool containsValueName(const std::string &value) const;
+
+		private:
+			uint32_t m_value {0};
+			EnumDefinition *m_definition = nullptr;
+	};
+
+	EnumValue::EnumValue(uint32_t value, EnumDefinition *definition) : m_value {value}, m_definition {definition}
+	{
+
+	}
+
+	EnumValue::EnumValue(const std::string &value, EnumDefinition *definition) : m_definition {definition}
+	{
+		if(!value.empty() && definition != nullptr)
+		{
+			std::vector<std::string> values = Tools::SplitString(value, ',');
+			for(auto &item : values)
+			{
+				uint32_t v = definition->getValue(item);
+				m_value |= v;
+			}
+		}
+	}
+
+	/*!
+	 * Checks if uint32 value contains a single flag. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
+	 * instead.
+	 * @param flags The uint32 value of the flag you want to check
+	 * @return 'true' if EnumValue has the requested bit activated. 'false' otherwise.
+	 */
+	bool EnumValue::hasFlagValue(uint32_t flags) const
+	{
+		if(m_definition->hasValuesAsFlags())
+			return ((m_value & flags) == flags) ? true : false;
+
+		return m_value == flags;
+	}
+
+	/*!
+	 * Checks if uint32 value contains one of several possible flags. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
+	 * instead.
+	 * @param flags The uint32 values of the flags you want to check
+	 * @return 'true' if EnumValue has the requested bits activated. 'false' otherwise.
+	 */
+	bool EnumValue::hasAnyFlagValue(uint32_t flags) const
+	{
+		if(m_definition->hasValuesAsFlags())
+			return ((m_value & flags) != 0);
+
+		return m_value == flags;
+	}
+
+	uint32_t EnumValue::getValue() const
+	{
+		return m_value;
+	}
+
+	/*!
+	 * Gets the single name of a value.
+	 * This function is intended for enums that can only have one value (non-flag).
+	 * If you want to get several value names (flags), use getValueNames() instead.
+	 * @return A single name for a value
+	 */
+	std::string EnumValue::getValueName() const
+	{
+		return (m_definition == nullptr) ? "" : m_definition->getValue(m_value);
+	}
+
+	/*!
+	 * Checks if T value contains a single flag. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
+	 * instead.
+	 * @tparam T A uint32_t compatible type
+	 * @param flags One or more flags you want to verify is included.
+	 * @return true is all flags presented are set. false otherwise.
+	 */
+	template<typename T>
+	bool EnumValue::hasFlag(T flags) const
+	{
+		return hasFlagValue(static_cast<uint32_t>(flags));
+	}
+
+	/*!
+	 * Checks if T value contains one of several possible flags. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
+	 * instead.
+	 * @tparam T A uint32_t compatible type
+	 * @param flags One or more flags you want to verify is included.
+	 * @return true is all flags presented are set. false otherwise.
+	 */
+	template<typename T>
+	bool EnumValue::hasAnyFlag(T flags) const
+	{
+		return hasAnyFlagValue(static_cast<uint32_t>(flags));
+	}
+
+	EnumDefinition *EnumValue::getDefinition() const
+	{
+		return m_definition;
+	}
+
+	std::vector<std::string> EnumValue::getValueNames() const
+	{
+		return (m_definition == nullptr) ? std::vector<std::string>() : m_definition->getValues(m_value);
+	}
+
+	/*!
+	 *
+	 * @param value
+	 * @return
+	 */
+	bool EnumValue::containsValueName(const std::string &value) const
+	{
+		if(m_definition != nullptr)
+		{
+			if(m_definition->hasValuesAsFlags())
+			{
+				std::vector<std::string> values = m_definition->getValues(m_value);
+				auto it = std::find(values.begin(), values.end(), value);
+				return it != values.end();
+			}
+			return m_definition->getValue(value) == m_value;
+		}
+		return false;
+	}
+}
+
+#endif //TILESON_TILEDENUM_HPP
+
+/*** End of inlined file: TiledEnum.hpp ***/
+
+
+/*** Start of inlined file: TiledClass.hpp ***/
+//
+// Created by robin on 06.06.22.
+//
+
+#ifndef TILESON_TILEDCLASS_HPP
+#define TILESON_TILEDCLASS_HPP
+
+namespace tson
+{
+	class TiledClass
+	{
+		friend class MapSnapshot;
+		public:
+			inline explicit TiledClass() = default;
+			inline explicit TiledClass(IJson &json, tson::Project *project = nullptr);
+
+			[[nodiscard]] inline uint32_t getId() const;
+			[[nodiscard]] inline const std::string &getName() const;
+			[[nodiscard]] inline const std::string &getType() const;
+			[[nodiscard]] inline PropertyCollection &getMembers();
+			inline void update(IJson &json);
+			inline void update(PropertyCollection &properties);
+
+			template <typename T>
+			inline T get(const std::string &name);
+			inline tson::Property *getMember(const std::string &name);
+
+		private:
+			uint32_t m_id {};
+			std::string m_name {};
+			std::string m_type {};
+			PropertyCollection m_members {};
+
+	};
+
+	TiledClass::TiledClass(IJson &json, tson::Project *project)
+	{
+		if(json.count("id") > 0)
+			m_id = json["id"].get<uint32_t>();
+
+		if(json.count("name") > 0)
+			m_name = json["name"].get<std::string>();
+		if(json.count("type") > 0)
+			m_type = json["type"].get<std::string>();
+
+		if(json.count("members") > 0 && json["members"].isArray())
+		{
+			auto &array = json.array("members");
+			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
+			{
+				m_members.add(*item, project);
+			});
+		}
+	}
+
+	uint32_t TiledClass::getId() const
+	{
+		return m_id;
+	}
+
+	const std::string &TiledClass::getName() const
+	{
+		return m_name;
+	}
+
+	const std::string &TiledClass::getType() const
+	{
+		return m_type;
+	}
+
+	PropertyCollection &TiledClass::getMembers()
+	{
+		return m_members;
+	}
+
+	template<typename T>
+	T TiledClass::get(const std::string &name)
+	{
+		return m_members.getValue<T>(name);
+	}
+
+	tson::Property *TiledClass::getMember(const std::string &name)
+	{
+		if(m_members.hasProperty(name))
+			return m_members.getProperty(name);
+		return nullptr;
+	}
+
+	/*!
+	 * Takes a json object from a particular map top update values if they differ from the original values of the class
+	 * @param json
+	 */
+	void TiledClass::update(IJson &json)
+	{
+		for(Property *property : m_members.get())
+		{
+			if(json.any(property->getName()))
+			{
+				property->setValueByType(json[property->getName()]);
+			}
+		}
+	}
+
+	void TiledClass::update(PropertyCollection &properties)
+	{
+		std::vector<Property *> toUpdate;
+		for(Property *member : m_members.get())
+		{
+			if(properties.hasProperty(member->getName()))
+			{
+				Property *property = properties.getProperty(member->getName());
+				if(member->getType() == property->getType())
+				{
+					toUpdate.push_back(property);
+				}
+			}
+		}
+
+		std::for_each(toUpdate.begin(), toUpdate.end(), [&](Property *p)
+		{
+		   m_members.setProperty(p->getName(), *p);
+		});
+	}
+}
+
+#endif //TILESON_TILEDCLASS_HPP
+
+/*** End of inlined file: TiledClass.hpp ***/
+
+
+/*** Start of inlined file: Project.hpp ***/
+//
+// Created by robin on 01.08.2020.
+//
+
+#ifndef TILESON_PROJECT_HPP
+#define TILESON_PROJECT_HPP
+
+#include <fstream>
+#include <sstream>
+#include <memory>
+
+/*** Start of inlined file: World.hpp ***/
+//
+// Created by robin on 01.08.2020.
+//
+
+#ifndef TILESON_WORLD_HPP
+#define TILESON_WORLD_HPP
+
+
+/*** Start of inlined file: WorldMapData.hpp ***/
+//
+// Created by robin on 01.08.2020.
+//
+
+#ifndef TILESON_WORLDMAPDATA_HPP
+#define TILESON_WORLDMAPDATA_HPP
+
+namespace tson
 {
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
-	return nullptr;
+	class WorldMapData
+	{
+		public:
+			inline WorldMapData(const fs::path &folder_, IJson &json);
+			inline WorldMapData(const fs::path &folder_, std::string fileName_, const tson::Vector2i &position_, const tson::Vector2i &size_);
+			inline void parse(const fs::path &folder_, IJson &json);
+
+			fs::path folder;
+			fs::path path;
+			std::string fileName;
+			tson::Vector2i size;
+			tson::Vector2i position;
+	};
+
+	WorldMapData::WorldMapData(const fs::path &folder_, IJson &json)
+	{
+		parse(folder_, json);
+	}
+
+	/*!
+	 * Map data of a map that is not listed in the world file, like those matching a pattern.
+	 */
+	WorldMapData::WorldMapData(const fs::path &folder_, std::string fileName_, const tson::Vector2i &position_, const tson::Vector2i &size_)
+		: folder {folder_}, path {folder_ / fileName_}, fileName {std::move(fileName_)}, size {size_}, position {position_}
+	{
+
+	}
+
+	void WorldMapData::parse(const fs::path &folder_, IJson &json)
+	{
+		folder = folder_;
+		if(json.count("fileName") > 0) fileName = json["fileName"].get<std::string>();
+		if(json.count("height") > 0) size = {json["width"].get<int>(), json["height"].get<int>()};
+		if(json.count("x") > 0) position = {json["x"].get<int>(), json["y"].get<int>()};
+
+		path = (!fileName.empty()) ? folder / fileName : folder;
+	}
 }
 
-/*!
- * Get layer type
- * @return Layer type as enum
- */
-tson::LayerType tson::Layer::getType() const
+#endif //TILESON_WORLDMAPDATA_HPP
+/*** End of inlined file: WorldMapData.hpp ***/
+
+#include <memory>
+#include <set>
+#include <regex>
+#include <limits>
+#include <unordered_map>
+namespace tson
 {
-	return m_type;
+	class Tileson;
+	class Archive;
+	class TilesetCache;
+	class TemplateCache;
+	class World
+	{
+		public:
+			#ifdef JSON11_IS_DEFINED
+			inline explicit World(std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>()) : m_json {std::move(jsonParser)}
+			{
+			}
+
+			inline explicit World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>());
+			#else
+			inline explicit World(std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
+			{
+			}
+
+			inline explicit World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser);
+			#endif
+			inline bool parse(const fs::path &path);
+			inline bool parse(const tson::Archive &archive, const fs::path &path); //tileson_forward.hpp
+			inline std::size_t loadMaps(tson::Tileson *parser); //tileson_forward.hpp
+			inline bool contains(std::string_view filename);
+			inline const WorldMapData *get(std::string_view filename) const;
+			inline size_t mapsIntersecting(const tson::Rect &rect, std::vector<size_t> &out) const;
+			inline const WorldMapData *mapAt(const tson::Vector2i &point) const;
+
+			[[nodiscard]] inline const fs::path &getPath() const;
+			[[nodiscard]] inline const fs::path &getFolder() const;
+			[[nodiscard]] inline const std::vector<WorldMapData> &getMapData() const;
+			[[nodiscard]] inline bool onlyShowAdjacentMaps() const;
+			[[nodiscard]] inline const std::string &getType() const;
+			[[nodiscard]] inline const std::vector<std::unique_ptr<tson::Map>> &getMaps() const;
+			[[nodiscard]] inline const std::vector<size_t> &getFailedMaps() const;
+
+			static constexpr size_t MaxIndexCells = 1 << 20;   /*! The cells of the map index grow until there are no more than this */
+
+		private:
+			inline void parseJson(IJson &json);
+			inline void parsePatterns(IJson &json);
+			inline void buildIndex();
+			[[nodiscard]] inline std::vector<std::string> getFileNamesInArchive() const; //tileson_forward.hpp
+			[[nodiscard]] inline int cellX(int x) const;
+			[[nodiscard]] inline int cellY(int y) const;
+
+			std::unique_ptr<IJson> m_json = nullptr;
+			fs::path m_path;
+			fs::path m_folder;
+			std::vector<WorldMapData> m_mapData;
+			std::shared_ptr<tson::TilesetCache> m_tilesetCache;     /*! Shared by the maps of loadMaps(), when the parser has no cache of its own */
+			std::shared_ptr<tson::TemplateCache> m_templateCache;
+			std::vector<std::unique_ptr<tson::Map>> m_maps;
+			std::vector<size_t> m_failedMaps;                       /*! Indices in m_maps of the maps that failed to load */
+			bool m_onlyShowAdjacentMaps {false};
+			std::string m_type;
+			const tson::Archive *m_archive {nullptr};               /*! The archive the world and its maps are in. nullptr when they are files */
+
+			//Index over the map rectangles: A uniform grid where every map is stored in each cell it touches
+			std::unordered_map<std::string, size_t> m_fileIndices;  /*! fileName -> index in m_mapData */
+			tson::Vector2i m_cellSize {1, 1};
+			tson::Vector2i m_gridOrigin;
+			tson::Vector2i m_gridSize;
+			std::vector<uint32_t> m_cellStart;                      /*! Offset into m_cellItems for each cell. Has one extra element at the end */
+			std::vector<uint32_t> m_cellItems;                      /*! Map indices, grouped by cell */
+	};
+
+	World::World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
+	{
+		parse(path);
+	}
+
+	bool World::parse(const fs::path &path)
+	{
+		m_path = path;
+		m_folder = m_path.parent_path();
+		m_archive = nullptr;
+
+		if(!m_json->parse(path))
+			return false;
+
+		parseJson(*m_json);
+		return true;
+	}
+
+	const fs::path &World::getPath() const
+	{
+		return m_path;
+	}
+
+	const std::vector<WorldMapData> &World::getMapData() const
+	{
+		return m_mapData;
+	}
+
+	bool World::onlyShowAdjacentMaps() const
+	{
+		return m_onlyShowAdjacentMaps;
+	}
+
+	const std::string &World::getType() const
+	{
+		return m_type;
+	}
+
+	void World::parseJson(IJson &json)
+	{
+		if(json.count("onlyShowAdjacentMaps") > 0) m_onlyShowAdjacentMaps = json["onlyShowAdjacentMaps"].get<bool>();
+		if(json.count("type") > 0) m_type = json["type"].get<std::string>();
+
+		if(json["maps"].isArray())
+		{
+			auto &maps = json.array("maps");
+			std::for_each(maps.begin(), maps.end(), [&](std::unique_ptr<IJson> &item) { m_mapData.emplace_back(m_folder, *item); });
+		}
+		if(json.count("patterns") > 0 && json["patterns"].isArray())
+			parsePatterns(json);
+
+		buildIndex();
+	}
+
+	/*!
+	 * Adds the maps in the folder of the world whose filename matches one of the 'patterns'.
+	 * As in Tiled, the first two captures of the 'regexp' are the x and y of the map, which are multiplied by
+	 * 'multiplierX'/'multiplierY' and moved by 'offsetX'/'offsetY'. The folder is only listed once, and maps that
+	 * are listed in 'maps' are not added again.
+	 */
+	void World::parsePatterns(IJson &json)
+	{
+		std::vector<std::string> fileNames;
+		if(m_archive != nullptr)
+			fileNames = getFileNamesInArchive();
+		else
+		{
+			std::error_code error;
+			for(const auto &entry : fs::directory_iterator(m_folder, error))
+			{
+				if(fs::is_regular_file(entry.status()))
+					fileNames.push_back(entry.path().filename().generic_string());
+			}
+		}
+		std::sort(fileNames.begin(), fileNames.end());
+
+		std::set<std::string> known;
+		for(const auto &data : m_mapData)
+			known.insert(data.fileName);
+
+		auto &patterns = json.array("patterns");
+		for(auto &pattern : patterns)
+		{
+			if(pattern->count("regexp") == 0)
+				continue;
+
+			std::regex regexp;
+			try
+			{
+				regexp = std::regex((*pattern)["regexp"].get<std::string>());
+			}
+			catch(const std::regex_error &)
+			{
+				continue;
+			}
+
+			int const multiplierX = (pattern->count("multiplierX") > 0) ? (*pattern)["multiplierX"].get<int>() : 1;
+			int const multiplierY = (pattern->count("multiplierY") > 0) ? (*pattern)["multiplierY"].get<int>() : 1;
+			tson::Vector2i const offset {(pattern->count("offsetX") > 0) ? (*pattern)["offsetX"].get<int>() : 0,
+										 (pattern->count("offsetY") > 0) ? (*pattern)["offsetY"].get<int>() : 0};
+			tson::Vector2i const mapSize {(pattern->count("mapWidth") > 0) ? (*pattern)["mapWidth"].get<int>() : multiplierX,
+										  (pattern->count("mapHeight") > 0) ? (*pattern)["mapHeight"].get<int>() : multiplierY};
+
+			std::smatch match;
+			for(const auto &fileName : fileNames)
+			{
+				if(known.count(fileName) > 0 || !std::regex_search(fileName, match, regexp) || match.size() < 3)
+					continue;
+
+				tson::Vector2i const position {std::atoi(match[1].str().c_str()) * multiplierX + offset.x,
+											   std::atoi(match[2].str().c_str()) * multiplierY + offset.y};
+				m_mapData.emplace_back(m_folder, fileName, position, mapSize);
+				known.insert(fileName);
+			}
+		}
+	}
+
+	const fs::path &World::getFolder() const
+	{
+		return m_folder;
+	}
+
+	/*!
+	 * Check if there is WorldMapData in the world that contains the current filename.
+	 * Filename = <file>.<extension>
+	 * @param filename
+	 * @return
+	 */
+	bool World::contains(std::string_view filename)
+	{
+		return m_fileIndices.count(std::string(filename)) > 0;
+	}
+
+	/*!
+	 * Get a map by its filename
+	 * @param filename Filename (including extension) - (example: file.json)
+	 * @return pointer to WorldMapData or nullptr if not exists
+	 */
+	const WorldMapData * World::get(std::string_view filename) const
+	{
+		auto iter = m_fileIndices.find(std::string(filename));
+		return (iter == m_fileIndices.end()) ? nullptr : &m_mapData[iter->second];
+	}
+
+	/*!
+	 * Gets all maps whose rectangle overlaps a rectangle. Maps that only touch the rectangle are not included,
+	 * so the neighbours of a map are found by growing its rectangle by one pixel.
+	 * Does not allocate when out has enough capacity.
+	 * @param rect Rectangle in pixels, in the coordinates of the world
+	 * @param out Receives the indices of the maps in getMapData(), in ascending order
+	 * @return Number of maps found
+	 */
+	size_t World::mapsIntersecting(const tson::Rect &rect, std::vector<size_t> &out) const
+	{
+		out.clear();
+		if(m_cellItems.empty() || rect.width <= 0 || rect.height <= 0)
+			return 0;
+
+		int const firstX = std::max(cellX(rect.x), 0);
+		int const firstY = std::max(cellY(rect.y), 0);
+		int const lastX = std::min(cellX(rect.x + rect.width - 1), m_gridSize.x - 1);
+		int const lastY = std::min(cellY(rect.y + rect.height - 1), m_gridSize.y - 1);
+		for(int y = firstY; y <= lastY; ++y)
+		{
+			for(int x = firstX; x <= lastX; ++x)
+			{
+				size_t const cell = static_cast<size_t>(y) * static_cast<size_t>(m_gridSize.x) + static_cast<size_t>(x);
+				for(uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+				{
+					const WorldMapData &data = m_mapData[m_cellItems[i]];
+					if(data.position.x >= rect.x + rect.width || rect.x >= data.position.x + data.size.x ||
+					   data.position.y >= rect.y + rect.height || rect.y >= data.position.y + data.size.y)
+						continue;
+
+					//Maps spanning several cells are only reported in the first cell they share with the rectangle
+					if(x == std::max(firstX, cellX(data.position.x)) && y == std::max(firstY, cellY(data.position.y)))
+						out.push_back(m_cellItems[i]);
+				}
+			}
+		}
+		std::sort(out.begin(), out.end());
+		return out.size();
+	}
+
+	/*!
+	 * Gets the map containing a point.
+	 * @param point Position in pixels, in the coordinates of the world
+	 * @return The first map (in the order of getMapData()) containing the point, or nullptr
+	 */
+	const WorldMapData *World::mapAt(const tson::Vector2i &point) const
+	{
+		int const x = cellX(point.x);
+		int const y = cellY(point.y);
+		if(m_cellItems.empty() || x < 0 || y < 0 || x >= m_gridSize.x || y >= m_gridSize.y)
+			return nullptr;
+
+		const WorldMapData *result = nullptr;
+		size_t const cell = static_cast<size_t>(y) * static_cast<size_t>(m_gridSize.x) + static_cast<size_t>(x);
+		for(uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+		{
+			const WorldMapData &data = m_mapData[m_cellItems[i]];
+			if(point.x >= data.position.x && point.y >= data.position.y &&
+			   point.x < data.position.x + data.size.x && point.y < data.position.y + data.size.y && (result == nullptr || &data < result))
+				result = &data;
+		}
+		return result;
+	}
+
+	/*!
+	 * Creates the lookup by filename and the grid over the map rectangles.
+	 * The cells are as large as the average map, so most maps touch no more than four cells.
+	 */
+	void World::buildIndex()
+	{
+		m_fileIndices.clear();
+		m_cellStart.clear();
+		m_cellItems.clear();
+		m_gridSize = {0, 0};
+		for(size_t i = 0; i < m_mapData.size(); ++i)
+			m_fileIndices.emplace(m_mapData[i].fileName, i);
+
+		std::vector<uint32_t> maps;
+		int64_t totalWidth = 0;
+		int64_t totalHeight = 0;
+		tson::Vector2i min {std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+		tson::Vector2i max {std::numeric_limits<int>::min(), std::numeric_limits<int>::min()};
+		for(size_t i = 0; i < m_mapData.size(); ++i)
+		{
+			const WorldMapData &data = m_mapData[i];
+			if(data.size.x <= 0 || data.size.y <= 0)
+				continue;
+
+			maps.push_back(static_cast<uint32_t>(i));
+			totalWidth += data.size.x;
+			totalHeight += data.size.y;
+			min = {std::min(min.x, data.position.x), std::min(min.y, data.position.y)};
+			max = {std::max(max.x, data.position.x + data.size.x), std::max(max.y, data.position.y + data.size.y)};
+		}
+		if(maps.empty())
+			return;
+
+		m_gridOrigin = min;
+		m_cellSize = {std::max(1, static_cast<int>(totalWidth / static_cast<int64_t>(maps.size()))),
+					  std::max(1, static_cast<int>(totalHeight / static_cast<int64_t>(maps.size())))};
+		auto gridSize = [&]() -> tson::Vector2i
+		{
+			return {(max.x - min.x + m_cellSize.x - 1) / m_cellSize.x, (max.y - min.y + m_cellSize.y - 1) / m_cellSize.y};
+		};
+		for(m_gridSize = gridSize(); static_cast<size_t>(m_gridSize.x) * static_cast<size_t>(m_gridSize.y) > MaxIndexCells; m_gridSize = gridSize())
+			m_cellSize = {m_cellSize.x * 2, m_cellSize.y * 2};
+
+		//Counting sort of the maps by cell
+		auto forEachCell = [&](const WorldMapData &data, auto &&func)
+		{
+			for(int y = cellY(data.position.y); y <= cellY(data.position.y + data.size.y - 1); ++y)
+				for(int x = cellX(data.position.x); x <= cellX(data.position.x + data.size.x - 1); ++x)
+					func(static_cast<size_t>(y) * static_cast<size_t>(m_gridSize.x) + static_cast<size_t>(x));
+		};
+		m_cellStart.assign(static_cast<size_t>(m_gridSize.x) * static_cast<size_t>(m_gridSize.y) + 1, 0);
+		for(uint32_t i : maps)
+			forEachCell(m_mapData[i], [&](size_t cell) { ++m_cellStart[cell + 1]; });
+		for(size_t cell = 1; cell < m_cellStart.size(); ++cell)
+			m_cellStart[cell] += m_cellStart[cell - 1];
+
+		std::vector<uint32_t> next(m_cellStart.begin(), m_cellStart.end() - 1);
+		m_cellItems.resize(m_cellStart.back());
+		for(uint32_t i : maps)
+			forEachCell(m_mapData[i], [&](size_t cell) { m_cellItems[next[cell]++] = i; });
+	}
+
+	int World::cellX(int x) const
+	{
+		int const offset = x - m_gridOrigin.x;
+		return (offset >= 0) ? offset / m_cellSize.x : -1;
+	}
+
+	int World::cellY(int y) const
+	{
+		int const offset = y - m_gridOrigin.y;
+		return (offset >= 0) ? offset / m_cellSize.y : -1;
+	}
+
+	/*!
+	 * Get all maps that have been loaded by loadMaps().
+	 * @return All maps loaded by loadMaps(), in the order of getMapData(). Maps that failed to load have the status of the failure.
+	 */
+	const std::vector<std::unique_ptr<tson::Map>> &World::getMaps() const
+	{
+		return m_maps;
+	}
+
+	/*!
+	 * The maps of the last loadMaps() that did not load, like maps whose file does not exist.
+	 * @return Indices in getMaps() and getMapData(), in ascending order
+	 */
+	const std::vector<size_t> &World::getFailedMaps() const
+	{
+		return m_failedMaps;
+	}
+
 }
 
-/*!
- * Assigns a tilemap of pointers to existing tiles.
- * @param tileMap The tilemap. key: tile id, value: pointer to Tile.
- */
-void tson::Layer::assignTileMap(std::map<uint32_t, tson::Tile *> *tileMap)
-{
-	m_tileMap = tileMap;
-}
+#endif //TILESON_WORLD_HPP
+
+/*** End of inlined file: World.hpp ***/
+
+
+
+/*** Start of inlined file: ProjectPropertyTypes.hpp ***/
+//
+// Created by robin on 01.08.22.
+//
+
+#ifndef TILESON_PROJECTPROPERTYTYPES_HPP
+#define TILESON_PROJECTPROPERTYTYPES_HPP
 
-/*!
- * Get tile data as some kind of map with x and y position with pointers to existing tiles.
- * Map only contains tiles that are not empty. x and y position is in tile units.
- *
- * Example of getting tile from the returned map:
- *
- * Tile *tile = tileData[{0, 4}];
- *
- * @return A map that represents the data returned from getData() in a 2D map with Tile pointers.
- */
-const std::map<std::tuple<int, int>, tson::Tile *> &tson::Layer::getTileData() const
+namespace tson
 {
-	return m_tileData;
-}
+	class ProjectPropertyTypes
+	{
+		public:
+			inline ProjectPropertyTypes() = default;
+			inline bool parse(IJson &json, tson::Project *project);
 
-/*!
- * A safe way to get tile data
- * Get tile data as some kind of map with x and y position with pointers to existing tiles.
- * Map only contains tiles that are not empty. x and y position is in tile units.
- *
- * Example of getting tile:
- * Tile *tile = layer->getTileData(0, 4)
- *
- * @param x X position in tile units
- * @param y Y position in tile units
- * @return pointer to tile, if it exists. nullptr otherwise.
- */
-tson::Tile *tson::Layer::getTileData(int x, int y)
-{
-	return (m_tileData.count({x, y}) > 0) ? m_tileData[{x,y}] : nullptr;
-}
+			inline const std::vector<tson::EnumDefinition> &getEnums() const;
+			inline const std::vector<tson::TiledClass> &getClasses() const;
+			[[nodiscard]] inline tson::EnumDefinition* getEnumDefinition(std::string_view name);
+			[[nodiscard]] inline tson::TiledClass* getClass(std::string_view name);
+			inline bool isUnhandledContentFound() const;
 
-/*!
- * Used for getting the tson::Map who is the parent of this Layer.
- * @return a pointer to the tson::Map where this layer is contained.
- */
-tson::Map *tson::Layer::getMap() const
-{
-	return m_map;
-}
+		private:
+			std::vector<tson::EnumDefinition> m_enums;
+			std::vector<tson::TiledClass> m_classes;
+			bool m_unhandledContentFound {false};
 
-/*!
- *
- * This is only supported for non-infinite maps!
- *
- * @param mapSize The size of the map
- * @param isInfiniteMap Whether or not the current map is infinte.
- */
-void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
-{
-	size_t x = 0;
-	size_t y = 0;
-	if(!isInfiniteMap)
+	};
+
+	bool ProjectPropertyTypes::parse(IJson &json, tson::Project *project)
 	{
-		std::for_each(m_data.begin(), m_data.end(), [&](uint32_t tileId)
+		m_enums.clear();
+		m_classes.clear();
+		m_unhandledContentFound = false;
+
+		if(json.count("propertyTypes") > 0 && json["propertyTypes"].isArray())
 		{
-			if (static_cast<int>(x) == mapSize.x)
+			auto &array = json.array("propertyTypes");
+			std::vector<tson::IJson*> classes; //Classes must be handled after enums
+			std::vector<tson::IJson*> other; //Unhandled stuff - just to keep track if something is missing...
+			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
 			{
-				++y;
-				x = 0;
-			}
+				IJson &j = *item;
+				if(j.count("type") > 0)
+				{
+					std::string t = j["type"].get<std::string>();
+					if(t == "enum")
+					{
+						m_enums.emplace_back(j); //Can be resolved directly
+					}
+					else if(t == "class")
+					{
+						classes.push_back(item.get()); //Must be resolved later
+					}
+					else
+						other.push_back(item.get()); //Only used to set flag for whether unhandled content was found.
+				}
+			});
 
-			if (tileId > 0 && m_tileMap->count(tileId) > 0)
-			{
-				m_tileData[{static_cast<int>(x), static_cast<int>(y)}] = m_tileMap->at(tileId);
-				m_tileObjects[{static_cast<int>(x), static_cast<int>(y)}] = {{static_cast<int>(x), static_cast<int>(y)}, m_tileData[{static_cast<int>(x), static_cast<int>(y)}]};
-			}
-			else if(tileId > 0 && m_tileMap->count(tileId) == 0) //Tile with flip flags!
+			std::for_each(classes.begin(), classes.end(), [&](IJson *item)
 			{
-				queueFlaggedTile(x, y, tileId);
-			}
-			x++;
-		});
+				m_classes.emplace_back(*item, project);
+			});
 
+			if(!other.empty())
+				m_unhandledContentFound = true;
+
+		}
+		return false;
 	}
-}
 
-std::map<std::tuple<int, int>, tson::TileObject> &tson::Layer::getTileObjects()
-{
-	return m_tileObjects;
-}
+	const std::vector<tson::EnumDefinition> &ProjectPropertyTypes::getEnums() const
+	{
+		return m_enums;
+	}
 
-tson::TileObject *tson::Layer::getTileObject(int x, int y)
-{
-	return (m_tileObjects.count({x, y}) > 0) ? &m_tileObjects[{x,y}] : nullptr;
-}
+	const std::vector<tson::TiledClass> &ProjectPropertyTypes::getClasses() const
+	{
+		return m_classes;
+	}
 
-const std::set<uint32_t> &tson::Layer::getUniqueFlaggedTiles() const
-{
-	return m_uniqueFlaggedTiles;
-}
+	bool ProjectPropertyTypes::isUnhandledContentFound() const
+	{
+		return m_unhandledContentFound;
+	}
 
-void tson::Layer::resolveFlaggedTiles()
-{
-	std::for_each(m_flaggedTiles.begin(), m_flaggedTiles.end(), [&](const tson::FlaggedTile &tile)
+	tson::EnumDefinition *ProjectPropertyTypes::getEnumDefinition(std::string_view name)
 	{
-		if (tile.id > 0 && m_tileMap->count(tile.id) > 0)
+		auto it = std::find_if(m_enums.begin(), m_enums.end(), [&](const EnumDefinition &def)
 		{
-			m_tileData[{static_cast<int>(tile.x), static_cast<int>(tile.y)}] = m_tileMap->at(tile.id);
-			m_tileObjects[{static_cast<int>(tile.x), static_cast<int>(tile.y)}] = {{static_cast<int>(tile.x), static_cast<int>(tile.y)}, m_tileData[{static_cast<int>(tile.x), static_cast<int>(tile.y)}]};
-		}
-	});
-}
+			return def.getName() == name;
+		});
 
-/*!
- * 'tintcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) that is multiplied with any graphics drawn by this layer or any child layers (optional).
- *
- * @return tintcolor
- */
-const tson::Colori &tson::Layer::getTintColor() const
-{
-	return m_tintColor;
-}
+		if(it != m_enums.end())
+			return &it.operator*();
 
-/*!
- * New in Tiled v1.5
- * Gets the parallax factor for current layer. Defaults to 1.
- * @return A vector with the x and y values of the parallax factor.
- */
-const tson::Vector2f &tson::Layer::getParallax() const
-{
-	return m_parallax;
-}
+		return nullptr;
+	}
 
-/*!
- * New in Tiled v1.8
- * 'repeatx': Whether the image drawn by this layer is repeated along the X axis.
- * @return true if image layer is repeated along the X axis, false otherwise.
- */
-bool tson::Layer::hasRepeatX() const
-{
-	return m_repeatX;
-}
+	tson::TiledClass *ProjectPropertyTypes::getClass(std::string_view name)
+	{
+		auto it = std::find_if(m_classes.begin(), m_classes.end(), [&](const TiledClass &def)
+		{
+			return def.getName() == name;
+		});
 
-/*!
- * New in Tiled v1.8
- * 'repeatx': Whether the image drawn by this layer is repeated along the Y axis.
- * @return true if image layer is repeated along the Y axis, false otherwise.
- */
-bool tson::Layer::hasRepeatY() const
-{
-	return m_repeatY;
-}
+		if(it != m_classes.end())
+			return &it.operator*();
 
-const std::string &tson::Layer::getClassType() const
-{
-	return m_classType;
+		return nullptr;
+	}
 }
 
-#endif //TILESON_LAYER_HPP
-
-/*** End of inlined file: Layer.hpp ***/
-
-
-/*** Start of inlined file: Tileset.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
-
-#ifndef TILESON_TILESET_HPP
-#define TILESON_TILESET_HPP
+#endif //TILESON_PROJECTPROPERTYTYPES_HPP
 
-//#include "../external/json.hpp"
+/*** End of inlined file: ProjectPropertyTypes.hpp ***/
 
 
-/*** Start of inlined file: Transformations.hpp ***/
+/*** Start of inlined file: ProjectFolder.hpp ***/
 //
-// Created by robin on 04.04.2021.
+// Created by robin on 01.08.2020.
 //
 
-#ifndef TILESON_TRANSFORMATIONS_HPP
-#define TILESON_TRANSFORMATIONS_HPP
+#ifndef TILESON_PROJECTFOLDER_HPP
+#define TILESON_PROJECTFOLDER_HPP
 
 namespace tson
 {
-	class Transformations
+	class ProjectFolder
 	{
 		public:
-			inline Transformations() = default;
-			inline explicit Transformations(IJson &json);
-			inline bool parse(IJson &json);
+			inline ProjectFolder(const fs::path &path);
 
-			inline bool allowHflip() const;
-			inline bool allowPreferuntransformed() const;
-			inline bool allowRotation() const;
-			inline bool allowVflip() const;
+			inline const fs::path &getPath() const;
+			inline bool hasWorldFile() const;
+			inline const std::vector<ProjectFolder> &getSubFolders() const;
+			inline const std::vector<fs::path> &getFiles() const;
+			inline const World &getWorld() const;
+
+		private:
+			inline void loadData();
+			fs::path                    m_path;
+			bool                        m_hasWorldFile;
+			tson::World                 m_world;
+			std::vector<ProjectFolder>  m_subFolders;
+			std::vector<fs::path>       m_files;
 
-		private:
-			bool m_hflip {};                /*! hflip: Whether the tiles in this set can be flipped horizontally (default false) */
-			bool m_preferuntransformed {};  /*! preferuntransformed: Whether untransformed tiles remain preferred, otherwise transformed tiles are used to produce more variations (default false) */
-			bool m_rotate {};               /*! rotate: Whether the tiles in this set can be rotated in 90 degree increments (default false) */
-			bool m_vflip {};                /*! vflip: Whether the tiles in this set can be flipped vertically (default false) */
 	};
 
-	Transformations::Transformations(IJson &json)
+	ProjectFolder::ProjectFolder(const fs::path &path) : m_path {path}
 	{
-		parse(json);
+		loadData();
 	}
 
-	bool Transformations::parse(IJson &json)
+	void ProjectFolder::loadData()
 	{
-		if(json.count("hflip") > 0) m_hflip = json["hflip"].get<bool>(); //Optional
-		if(json.count("preferuntransformed") > 0) m_preferuntransformed = json["preferuntransformed"].get<bool>(); //Optional
-		if(json.count("rotate") > 0) m_rotate = json["rotate"].get<bool>(); //Optional
-		if(json.count("vflip") > 0) m_vflip = json["vflip"].get<bool>(); //Optional
+		m_hasWorldFile = false;
+		m_subFolders.clear();
+		m_files.clear();
+		//Search and see if there is a World file .world file
+		fs::path worldPath;
+		for (const auto & entry : fs::directory_iterator(m_path))
+		{
+			if(fs::is_regular_file(entry.path()))
+			{
+				if(entry.path().extension() == ".world")
+				{
+					m_hasWorldFile = true;
+					worldPath = entry.path();
+				}
+			}
+		}
+
+		if(m_hasWorldFile)
+			m_world.parse(worldPath);
+
+		for (const auto & entry : fs::directory_iterator(m_path))
+		{
+			if (fs::is_directory(entry.path()))
+				m_subFolders.emplace_back(entry.path());//.loadData(); - loadData() is called in the constructor, so don't call again.
+			else if (fs::is_regular_file(entry.path()))
+			{
+				if(m_hasWorldFile && m_world.contains(entry.path().filename().generic_string()))
+					m_files.emplace_back(entry.path());
+				else if(!m_hasWorldFile)
+					m_files.emplace_back(entry.path());
+			}
+		}
 
-		return true;
 	}
 
-	/*!
-	 *
-	 * @return hflip: Whether the tiles in this set can be flipped horizontally (default false)
-	 */
-	bool Transformations::allowHflip() const
+	const fs::path &ProjectFolder::getPath() const
 	{
-		return m_hflip;
+		return m_path;
 	}
 
-	/*!
-	 *
-	 * @return preferuntransformed: Whether untransformed tiles remain preferred, otherwise transformed tiles are used to produce more variations (default false)
-	 */
-	bool Transformations::allowPreferuntransformed() const
+	bool ProjectFolder::hasWorldFile() const
 	{
-		return m_preferuntransformed;
+		return m_hasWorldFile;
 	}
 
-	/*!
-	 *
-	 * @return rotate: Whether the tiles in this set can be rotated in 90 degree increments (default false)
-	 */
-	bool Transformations::allowRotation() const
+	const std::vector<ProjectFolder> &ProjectFolder::getSubFolders() const
 	{
-		return m_rotate;
+		return m_subFolders;
+	}
+
+	const std::vector<fs::path> &ProjectFolder::getFiles() const
+	{
+		return m_files;
 	}
 
 	/*!
-	 *
-	 * @return vflip: Whether the tiles in this set can be flipped vertically (default false)
+	 * Only gives useful data if hasWorldFile() is true!
+	 * @return
 	 */
-	bool Transformations::allowVflip() const
+	const World &ProjectFolder::getWorld() const
 	{
-		return m_vflip;
+		return m_world;
 	}
 }
 
-#endif //TILESON_TRANSFORMATIONS_HPP
-
-/*** End of inlined file: Transformations.hpp ***/
+#endif //TILESON_PROJECTFOLDER_HPP
+/*** End of inlined file: ProjectFolder.hpp ***/
 
 
-/*** Start of inlined file: WangSet.hpp ***/
+/*** Start of inlined file: ProjectData.hpp ***/
 //
-// Created by robin on 22.03.2020.
+// Created by robin on 01.08.2020.
 //
 
-#ifndef TILESON_WANGSET_HPP
-#define TILESON_WANGSET_HPP
-
-//#include "../external/json.hpp"
+#ifndef TILESON_PROJECTDATA_HPP
+#define TILESON_PROJECTDATA_HPP
 
-/*** Start of inlined file: WangColor.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+namespace tson
+{
+	class ProjectData
+	{
+		public:
+			ProjectData() = default;
+			std::string automappingRulesFile;
+			std::vector<std::string> commands;
+			std::string extensionsPath;
+			std::vector<std::string> folders;
+			std::string objectTypesFile;
+			ProjectPropertyTypes projectPropertyTypes;
 
-#ifndef TILESON_WANGCOLOR_HPP
-#define TILESON_WANGCOLOR_HPP
+			//Tileson specific
+			fs::path basePath;
+			std::vector<tson::ProjectFolder> folderPaths;
+	};
+}
 
-//#include "../external/json.hpp"
+#endif //TILESON_PROJECTDATA_HPP
+/*** End of inlined file: ProjectData.hpp ***/
 
 namespace tson
 {
-	class WangColor
+	class Archive;
+	class Project
 	{
 		public:
-			inline WangColor() = default;
-			inline explicit WangColor(IJson &json, tson::Map *map);
-			inline bool parse(IJson &json, tson::Map *map);
+			#ifdef JSON11_IS_DEFINED
+			inline explicit Project(std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>()) : m_json {std::move(jsonParser)}
+			{
 
-			[[nodiscard]] inline const Colori &getColor() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline float getProbability() const;
-			[[nodiscard]] inline int getTile() const;
+			}
+			inline explicit Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>());
+			#else
+			inline explicit Project(std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
+			{
 
-			inline PropertyCollection &getProperties();
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+			}
+			inline explicit Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser);
+			#endif
+			inline bool parse(const fs::path &path);
+			inline bool parse(const tson::Archive &archive, const fs::path &path); //tileson_forward.hpp
+			inline void parse();
 
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			[[nodiscard]] inline const ProjectData &getData() const;
+			[[nodiscard]] inline const fs::path &getPath() const;
+			[[nodiscard]] inline const std::vector<ProjectFolder> &getFolders() const;
+			[[nodiscard]] inline tson::EnumDefinition* getEnumDefinition(std::string_view name);
+			[[nodiscard]] inline tson::TiledClass* getClass(std::string_view name);
 
 		private:
-			tson::Colori      m_color;              /*! 'color': Hex-formatted color (#RRGGBB or #AARRGGBB) */
-			std::string       m_name;               /*! 'name': Name of the Wang color */
-			float             m_probability{};      /*! 'probability': Probability used when randomizing */
-			int               m_tile{};             /*! 'tile': Local ID of tile representing the Wang color */
+			inline void parseJson(IJson &json, bool loadFolders = true);
+			fs::path m_path;
+			std::vector<ProjectFolder> m_folders;
+			ProjectData m_data;
+			std::unique_ptr<IJson> m_json = nullptr;
+	};
 
-			//New in Tiled v1.5
-			tson::PropertyCollection     m_properties; 	  /*! 'properties': A list of properties (name, value, type). */
-			tson::Map *                  m_map;
-			std::string                  m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
-			std::shared_ptr<tson::TiledClass> m_class {};
+	Project::Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
+	{
+		parse(path);
+	}
 
-	};
-}
+	bool Project::parse(const fs::path &path)
+	{
+		m_path = path;
+		std::ifstream i(m_path.generic_string());
 
-tson::WangColor::WangColor(IJson &json, tson::Map *map)
-{
-	parse(json, map);
-}
+		try
+		{
+			if(!m_json->parse(path))
+				return false;
+		}
+		catch(const std::exception &error)
+		{
+			std::string message = "Parse error: ";
+			message += std::string(error.what());
+			message += std::string("\n");
+			return false;
+		}
+		parseJson(*m_json);
+		return true;
+	}
+
+	const ProjectData &Project::getData() const
+	{
+		return m_data;
+	}
+
+	/*!
+	 * @param loadFolders Loads the tson::ProjectFolders of 'folders' from disk
+	 */
+	void Project::parseJson(IJson &json, bool loadFolders)
+	{
+		m_data.basePath = (m_path.empty()) ? fs::path() : m_path.parent_path(); //The directory of the project file
+
+		//Make sure these property types are read before any map is, so they can be resolved.
+		if(json.count("propertyTypes") > 0)
+		{
+			m_data.projectPropertyTypes.parse(json, this);
+		}
+
+		if(json.count("automappingRulesFile") > 0) m_data.automappingRulesFile = json["automappingRulesFile"].get<std::string>();
+		if(json.count("commands") > 0)
+		{
+			m_data.commands.clear();
+			auto &commands = json.array("commands");
+			std::for_each(commands.begin(), commands.end(), [&](std::unique_ptr<IJson> &item)
+			{
+				m_data.commands.emplace_back(item->get<std::string>());
+			});
+		}
+		if(json.count("extensionsPath") > 0) m_data.extensionsPath = json["extensionsPath"].get<std::string>();
+		if(json.count("folders") > 0)
+		{
+			m_data.folders.clear();
+			m_data.folderPaths.clear();
+			auto &folders = json.array("folders");
+			std::for_each(folders.begin(), folders.end(), [&](std::unique_ptr<IJson> &item)
+			{
+				std::string folder = item->get<std::string>();
+				m_data.folders.emplace_back(folder);
+				if(loadFolders)
+				{
+					m_data.folderPaths.emplace_back(m_data.basePath / folder);
+					m_folders.emplace_back(m_data.basePath / folder);
+				}
+			});
+		}
+		if(json.count("objectTypesFile") > 0) m_data.objectTypesFile = json["objectTypesFile"].get<std::string>();
+	}
+
+	const fs::path &Project::getPath() const
+	{
+		return m_path;
+	}
+
+	const std::vector<ProjectFolder> &Project::getFolders() const
+	{
+		return m_folders;
+	}
 
-bool tson::WangColor::parse(IJson &json, tson::Map *map)
-{
-	m_map = map;
-	bool allFound = true;
+	tson::EnumDefinition *Project::getEnumDefinition(std::string_view name)
+	{
+		return m_data.projectPropertyTypes.getEnumDefinition(name);
+	}
 
-	if(json.count("color") > 0) m_color = tson::Colori(json["color"].get<std::string>()); else allFound = false;
-	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
-	if(json.count("probability") > 0) m_probability = json["probability"].get<float>(); else allFound = false;
-	if(json.count("tile") > 0) m_tile = json["tile"].get<int>(); else allFound = false;
-	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+	tson::TiledClass *Project::getClass(std::string_view name)
+	{
+		return m_data.projectPropertyTypes.getClass(name);
+	}
 
-	if(json.count("properties") > 0 && json["properties"].isArray())
+	/*!
+	 * Parses preloaded json data. Only used during tests involving project jsons not actually read from files
+	 * @return
+	 */
+	void Project::parse()
 	{
-		auto &properties = json.array("properties");
-		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item); });
+		parseJson(*m_json);
 	}
 
-	return allFound;
 }
 
-/*!
- * 'color': Color object created from hex-formatted string (#RRGGBB or #AARRGGBB)
- * @return
- */
-const tson::Colori &tson::WangColor::getColor() const
-{
-	return m_color;
-}
+#endif //TILESON_PROJECT_HPP
 
-/*!
- * 'name': Name of the Wang color
- * @return
- */
-const std::string &tson::WangColor::getName() const
-{
-	return m_name;
-}
+/*** End of inlined file: Project.hpp ***/
 
-/*!
- * 'probability': Probability used when randomizing
- * @return
- */
-float tson::WangColor::getProbability() const
-{
-	return m_probability;
-}
 
-/*!
- * 'tile': Local ID of tile representing the Wang color
- * @return
- */
-int tson::WangColor::getTile() const
-{
-	return m_tile;
-}
+/*** Start of inlined file: TileBatch.hpp ***/
+#ifndef TILESON_TILEBATCH_HPP
+#define TILESON_TILEBATCH_HPP
 
-/*!
- * New property in Tiled v1.5 when data is contained in 'colors' of a wangset
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::WangColor::getProperties()
-{
-	return m_properties;
-}
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 
-/*!
- * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
- * @tparam T The template value
- * @param name Name of the property
- * @return The actual value, if it exists. Otherwise: The default value of the type.
- */
-template<typename T>
-T tson::WangColor::get(const std::string &name)
+namespace tson
 {
-	return m_properties.getValue<T>(name);
-}
+	/*!
+	 * A single vertex of a tile quad.
+	 * 'color' is the tint of the layer as RGBA8: red in the lowest byte and alpha in the highest byte.
+	 */
+	class TileVertex
+	{
+		public:
+			float x {};
+			float y {};
+			float u {};
+			float v {};
+			uint32_t color {0xffffffff};
+	};
 
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::WangColor::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
+	/*!
+	 * All the tiles of a layer that are drawn with the same texture.
+	 * Every tile is a quad of 4 vertices in the order top-left, top-right, bottom-right, bottom-left,
+	 * and the UVs are normalized to the size of the texture. Use TileBatchBuilder::CreateQuadIndices() to
+	 * get an index buffer for the quads.
+	 */
+	class TileBatch
+	{
+		public:
+			[[nodiscard]] inline const fs::path &getImage() const;
+			[[nodiscard]] inline const tson::Vector2i &getImageSize() const;
+			[[nodiscard]] inline size_t getTileCount() const;
+
+			/*! The tileset of all the tiles in the batch */
+			tson::Tileset *tileset {nullptr};
+			/*! The tile holding the image of this batch. Only set for image collection tilesets, where every tile has its own image. */
+			tson::Tile *imageTile {nullptr};
+			/*! 4 vertices per tile */
+			std::vector<tson::TileVertex> vertices;
+	};
 
-	return nullptr;
-}
+	/*!
+	 * Turns the tiles of a tile layer into vertices, with one tson::TileBatch per texture.
+	 * The result can be uploaded as one vertex buffer per tileset, instead of drawing every tile as a sprite.
+	 *
+	 * Tiles are looked up in the drawing table of the map (tson::Map::getTileDrawTable()).
+	 * Vertex positions are in pixels, with the offset of the layer (and parallax, when a camera is used),
+	 * the tile offset of the tileset and oversized tiles (drawn from the bottom-left corner of the cell) taken into account.
+	 * Flipped tiles get their UVs swapped, and the quad of a diagonally flipped tile has its width and height swapped.
+	 *
+	 * The builder keeps its buffers between calls to build(), so a builder should be reused every frame to avoid allocations.
+	 *
+	 * Example:
+	 * tson::TileBatchBuilder builder;
+	 * for(const tson::TileBatch &batch : builder.build(*layer, camera))
+	 *     renderer.draw(batch.getImage(), batch.vertices);
+	 */
+	class TileBatchBuilder
+	{
+		public:
+			inline const std::vector<tson::TileBatch> &build(tson::Layer &layer);
+			inline const std::vector<tson::TileBatch> &build(tson::Layer &layer, const tson::Rect &camera);
 
-const std::string &tson::WangColor::getClassType() const
-{
-	return m_classType;
-}
+			[[nodiscard]] inline const std::vector<tson::TileBatch> &getBatches() const;
+			[[nodiscard]] inline size_t getTileCount() const;
+			inline void clear();
 
-#endif //TILESON_WANGCOLOR_HPP
+			inline static void CreateQuadIndices(size_t tileCount, std::vector<uint32_t> &indices);
 
-/*** End of inlined file: WangColor.hpp ***/
+		private:
+			/*! Per tile data of a batch, waiting to be turned into vertices */
+			struct Staging
+			{
+				std::vector<float> left, top, right, bottom;
+				std::vector<float> u0, v0, u1, v1;
+				std::vector<uint8_t> flip;
+			};
 
+			inline void begin(tson::Layer &layer);
+			inline void add(const tson::TileCell &cell);
+			inline void end();
+			inline size_t getBatchIndex(tson::Tileset *tileset, tson::Tile *imageTile);
+
+			std::vector<tson::TileBatch>            m_batches;
+			std::vector<Staging>                    m_staging;
+			std::unordered_map<const void *, size_t> m_batchIndices;    /*! Key: tileset (image tilesets) or tile (image collection tilesets) */
+			tson::Map                               *m_map {nullptr};
+			uint32_t                                m_color {0xffffffff};
+			float                                   m_cellHeight {};
+	};
 
+	const fs::path &TileBatch::getImage() const
+	{
+		return (imageTile != nullptr) ? imageTile->getImage() : tileset->getImage();
+	}
 
-/*** Start of inlined file: WangTile.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	const tson::Vector2i &TileBatch::getImageSize() const
+	{
+		return (imageTile != nullptr) ? imageTile->getImageSize() : tileset->getImageSize();
+	}
 
-#ifndef TILESON_WANGTILE_HPP
-#define TILESON_WANGTILE_HPP
+	size_t TileBatch::getTileCount() const
+	{
+		return vertices.size() / 4;
+	}
 
-//#include "../external/json.hpp"
+	/*!
+	 * Creates vertices for every tile in the layer.
+	 * @param layer A tile layer. Any other kind of layer gives no batches.
+	 * @return One batch per texture used by the layer. Batches keep their order between builds.
+	 */
+	const std::vector<tson::TileBatch> &TileBatchBuilder::build(tson::Layer &layer)
+	{
+		begin(layer);
+		if(layer.getType() == tson::LayerType::TileLayer)
+			layer.forEachTileInRegion(layer.getTileBounds(), [&](const tson::TileCell &cell) { add(cell); });
+		end();
+		return m_batches;
+	}
 
-namespace tson
-{
-	class WangTile
+	/*!
+	 * Creates vertices for the tiles of the layer that are visible inside the camera. See tson::Layer::forEachVisibleTile().
+	 * @param layer A tile layer. Any other kind of layer gives no batches.
+	 * @param camera The visible area in pixels.
+	 * @return One batch per texture used by the visible tiles. Batches keep their order between builds.
+	 */
+	const std::vector<tson::TileBatch> &TileBatchBuilder::build(tson::Layer &layer, const tson::Rect &camera)
 	{
-		public:
-			inline WangTile() = default;
-			inline explicit WangTile(IJson &json);
-			inline bool parse(IJson &json);
+		begin(layer);
+		if(layer.getType() == tson::LayerType::TileLayer)
+			layer.forEachVisibleTile(camera, [&](const tson::TileCell &cell) { add(cell); });
+		end();
+		return m_batches;
+	}
 
-			[[nodiscard]] inline bool hasDFlip() const;
-			[[nodiscard]] inline bool hasHFlip() const;
-			[[nodiscard]] inline uint32_t getTileid() const;
-			[[nodiscard]] inline bool hasVFlip() const;
+	/*!
+	 * The batches of the last call to build()
+	 */
+	const std::vector<tson::TileBatch> &TileBatchBuilder::getBatches() const
+	{
+		return m_batches;
+	}
 
-			[[nodiscard]] inline const std::vector<uint32_t> &getWangIds() const;
+	/*!
+	 * Number of tiles in all the batches of the last call to build()
+	 */
+	size_t TileBatchBuilder::getTileCount() const
+	{
+		size_t count = 0;
+		for(const auto &batch : m_batches)
+			count += batch.getTileCount();
+		return count;
+	}
 
-		private:
-			bool                    m_dflip{};     /*! 'dflip': Tile is flipped diagonally */
-			bool                    m_hflip{};     /*! 'hflip': Tile is flipped horizontally */
-			uint32_t                m_tileid{};    /*! 'tileid': Local ID of tile */
-			bool                    m_vflip{};     /*! 'vflip': Tile is flipped vertically */
-			std::vector<uint32_t>   m_wangId;      /*! 'wangid': Array of Wang color indexes (uchar[8])*/
-	};
-}
+	/*!
+	 * Removes all batches, and frees the memory used by them.
+	 */
+	void TileBatchBuilder::clear()
+	{
+		m_batches.clear();
+		m_staging.clear();
+		m_batchIndices.clear();
+	}
 
-tson::WangTile::WangTile(IJson &json)
-{
-	parse(json);
-}
+	/*!
+	 * Creates the indices of two triangles per quad, for tiles created by this builder.
+	 * The same indices can be used for every batch with the same number of tiles or fewer.
+	 * @param tileCount Number of tiles (quads)
+	 * @param indices Output. Gets 6 indices per tile.
+	 */
+	void TileBatchBuilder::CreateQuadIndices(size_t tileCount, std::vector<uint32_t> &indices)
+	{
+		indices.resize(tileCount * 6);
+		for(size_t i = 0; i < tileCount; ++i)
+		{
+			uint32_t const first = static_cast<uint32_t>(i * 4);
+			uint32_t *index = indices.data() + i * 6;
+			index[0] = first;
+			index[1] = first + 1;
+			index[2] = first + 2;
+			index[3] = first;
+			index[4] = first + 2;
+			index[5] = first + 3;
+		}
+	}
 
-/*!
- * Parses a wang tile from Tiled json.
- * @param json A Tiled json file
- * @return true if all mandatory fields were found. False otherwise.
- */
-bool tson::WangTile::parse(IJson &json)
-{
-	bool allFound = true;
+	void TileBatchBuilder::begin(tson::Layer &layer)
+	{
+		//Only empty the buffers, so their memory can be reused by the next build
+		for(size_t i = 0; i < m_batches.size(); ++i)
+		{
+			m_batches[i].vertices.clear();
+			Staging &staging = m_staging[i];
+			for(auto *values : {&staging.left, &staging.top, &staging.right, &staging.bottom, &staging.u0, &staging.v0, &staging.u1, &staging.v1})
+				values->clear();
+			staging.flip.clear();
+		}
 
-	if(json.count("dflip") > 0) m_dflip = json["dflip"].get<bool>(); //Removed in Tiled v1.5 and is now optional
-	if(json.count("hflip") > 0) m_hflip = json["hflip"].get<bool>(); //Removed in Tiled v1.5 and is now optional
-	if(json.count("vflip") > 0) m_vflip = json["vflip"].get<bool>(); //Removed in Tiled v1.5 and is now optional
+		tson::Colori tint = (layer.hasTintColor()) ? layer.getTintColor() : tson::Colori(255, 255, 255, 255);
+		float const alpha = static_cast<float>(tint.a) * std::clamp(layer.getOpacity(), 0.f, 1.f);
+		m_color = static_cast<uint32_t>(tint.r) | (static_cast<uint32_t>(tint.g) << 8) | (static_cast<uint32_t>(tint.b) << 16) |
+				  (static_cast<uint32_t>(alpha + 0.5f) << 24);
 
-	if(json.count("tileid") > 0) m_tileid = json["tileid"].get<uint32_t>(); else allFound = false;
-	if(json.count("wangid") > 0 && json["wangid"].isArray())
-	{
-		auto &wangid = json.array("wangid");
-		std::for_each(wangid.begin(), wangid.end(), [&](std::unique_ptr<IJson> &item) { m_wangId.emplace_back(item->get<uint32_t>()); });
+		m_map = layer.getMap();
+		m_cellHeight = (m_map != nullptr) ? static_cast<float>(m_map->getTileSize().y) : 0.f;
 	}
 
-	return allFound;
-}
+	void TileBatchBuilder::add(const tson::TileCell &cell)
+	{
+		const tson::TileDrawInfo *info = (m_map != nullptr) ? m_map->getTileDrawInfo(cell.gid) : nullptr;
+		if(info == nullptr)
+			return;
+
+		//Every tile of an image collection tileset has its own image. Flipped tiles use the image of the original tile.
+		tson::Tileset *tileset = info->tileset;
+		tson::Tile *imageTile = (tileset->getType() == tson::TilesetType::ImageCollectionTileset) ? info->tile : nullptr;
+		const tson::Vector2i &imageSize = (imageTile != nullptr) ? imageTile->getImageSize() : tileset->getImageSize();
+		if(imageSize.x <= 0 || imageSize.y <= 0)
+			return;
+
+		//Flip flags are bits 32, 31 and 30 of the gid: horizontal = 4, vertical = 2 and diagonal = 1
+		uint8_t const flip = static_cast<uint8_t>((cell.gid >> 29) & 7);
+		float width = static_cast<float>(info->drawingRect.width);
+		float height = static_cast<float>(info->drawingRect.height);
+		if((flip & 1) != 0)
+			std::swap(width, height);
+
+		Staging &staging = m_staging[getBatchIndex(tileset, imageTile)];
+		float const left = cell.position.x + static_cast<float>(info->tileOffset.x);
+		float const bottom = cell.position.y + m_cellHeight + static_cast<float>(info->tileOffset.y);
+		staging.left.push_back(left);
+		staging.top.push_back(bottom - height);
+		staging.right.push_back(left + width);
+		staging.bottom.push_back(bottom);
+		staging.u0.push_back(info->uvTopLeft.x);
+		staging.v0.push_back(info->uvTopLeft.y);
+		staging.u1.push_back(info->uvBottomRight.x);
+		staging.v1.push_back(info->uvBottomRight.y);
+		staging.flip.push_back(flip);
+	}
 
-/*!
- * 'dflip': Tile is flipped diagonally
- *
- * NB! This property got removed in Tiled v1.5
- * @return
- */
-bool tson::WangTile::hasDFlip() const
-{
-	return m_dflip;
-}
+	void TileBatchBuilder::end()
+	{
+		//For each flip combination: which corner of the texture rect (0 = top-left, 1 = top-right, 2 = bottom-right, 3 = bottom-left)
+		//goes to each corner of the quad. Tiled flips diagonally first, then horizontally and vertically.
+		static constexpr uint8_t FlipCorners[8][4] = {{0, 1, 2, 3}, {0, 3, 2, 1}, {3, 2, 1, 0}, {1, 2, 3, 0},
+													  {1, 0, 3, 2}, {3, 0, 1, 2}, {2, 3, 0, 1}, {2, 1, 0, 3}};
 
-/*!
- * 'hflip': Tile is flipped horizontally
- *
- * NB! This property got removed in Tiled v1.5
- * @return
- */
-bool tson::WangTile::hasHFlip() const
-{
-	return m_hflip;
-}
+		for(size_t i = 0; i < m_batches.size(); ++i)
+		{
+			const Staging &staging = m_staging[i];
+			std::vector<tson::TileVertex> &vertices = m_batches[i].vertices;
+			size_t const count = staging.flip.size();
+			vertices.resize(count * 4);
+
+			tson::TileVertex *vertex = vertices.data();
+			uint32_t const color = m_color;
+			for(size_t t = 0; t < count; ++t, vertex += 4)
+			{
+				float const us[4] = {staging.u0[t], staging.u1[t], staging.u1[t], staging.u0[t]};
+				float const vs[4] = {staging.v0[t], staging.v0[t], staging.v1[t], staging.v1[t]};
+				const uint8_t *corners = FlipCorners[staging.flip[t]];
+
+				vertex[0] = {staging.left[t], staging.top[t], us[corners[0]], vs[corners[0]], color};
+				vertex[1] = {staging.right[t], staging.top[t], us[corners[1]], vs[corners[1]], color};
+				vertex[2] = {staging.right[t], staging.bottom[t], us[corners[2]], vs[corners[2]], color};
+				vertex[3] = {staging.left[t], staging.bottom[t], us[corners[3]], vs[corners[3]], color};
+			}
+		}
 
-/*!
- * 'tileid': Local ID of tile
- * @return
- */
-uint32_t tson::WangTile::getTileid() const
-{
-	return m_tileid;
-}
+		//Batches without tiles are removed, but the others keep their order and memory
+		size_t used = 0;
+		for(size_t i = 0; i < m_batches.size(); ++i)
+		{
+			if(m_batches[i].vertices.empty())
+				continue;
+			if(used != i)
+			{
+				std::swap(m_batches[used], m_batches[i]);
+				std::swap(m_staging[used], m_staging[i]);
+			}
+			++used;
+		}
+		m_batches.resize(used);
+		m_staging.resize(used);
 
-/*!
- * 'vflip': Tile is flipped vertically
- *
- * NB! This property got removed in Tiled v1.5
- * @return
- */
-bool tson::WangTile::hasVFlip() const
-{
-	return m_vflip;
-}
+		m_batchIndices.clear();
+		for(size_t i = 0; i < m_batches.size(); ++i)
+			m_batchIndices[(m_batches[i].imageTile != nullptr) ? static_cast<const void *>(m_batches[i].imageTile) : m_batches[i].tileset] = i;
+	}
 
-/*!
- * 'wangid': Array of Wang color indexes (uchar[8])
- * @return
- */
-const std::vector<uint32_t> &tson::WangTile::getWangIds() const
-{
-	return m_wangId;
+	size_t TileBatchBuilder::getBatchIndex(tson::Tileset *tileset, tson::Tile *imageTile)
+	{
+		const void *key = (imageTile != nullptr) ? static_cast<const void *>(imageTile) : tileset;
+		auto iter = m_batchIndices.find(key);
+		if(iter != m_batchIndices.end())
+			return iter->second;
+
+		m_batches.emplace_back();
+		m_batches.back().tileset = tileset;
+		m_batches.back().imageTile = imageTile;
+		m_staging.emplace_back();
+		m_batchIndices[key] = m_batches.size() - 1;
+		return m_batches.size() - 1;
+	}
 }
 
-#endif //TILESON_WANGTILE_HPP
+#endif //TILESON_TILEBATCH_HPP
 
-/*** End of inlined file: WangTile.hpp ***/
+/*** End of inlined file: TileBatch.hpp ***/
+
+
+/*** Start of inlined file: CollisionBuilder.hpp ***/
+#ifndef TILESON_COLLISIONBUILDER_HPP
+#define TILESON_COLLISIONBUILDER_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <set>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 namespace tson
 {
-	class WangSet
+	/*!
+	 * A collision shape from the objectgroup of a tile, in pixels, with the flip flags of the tile applied.
+	 */
+	class CollisionShape
 	{
 		public:
-			inline WangSet() = default;
-			inline explicit WangSet(IJson &json, tson::Map *map);
-			inline bool parse(IJson &json, tson::Map *map);
+			/*! Rectangle, Ellipse, Polygon, Polyline or Point */
+			tson::ObjectType type {tson::ObjectType::Undefined};
+			/*! The corners of rectangles and ellipse bounds (clockwise from the top-left corner before any transformation),
+			 *  the points of polygons and polylines, or a single point. */
+			std::vector<tson::Vector2f> points;
+			/*! The object in the objectgroup of the tile */
+			tson::Object *object {nullptr};
+			/*! The tile the shape belongs to */
+			tson::Tile *tile {nullptr};
+			/*! Position of the tile in tile units */
+			tson::Vector2i tilePosition;
+	};
 
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline int getTile() const;
+	/*!
+	 * Creates collision geometry from a tile layer.
+	 *
+	 * Solid tiles are merged into as few axis aligned rectangles as possible (greedy meshing), which keeps the number of
+	 * bodies in a physics engine low. Tiles are solid when they match the predicate given in the constructor (a property or a set of gids),
+	 * or when their objectgroup is a single rectangle covering the whole tile (see setMergeFullTileShapes()).
+	 * Other tiles with an objectgroup give their shapes through buildShapes().
+	 *
+	 * The layer is split in horizontal bands of rows that are processed in parallel. Rectangles are merged across bands afterwards,
+	 * so the result does not depend on the number of threads.
+	 *
+	 * Example:
+	 * tson::CollisionBuilder builder {"solid"};
+	 * for(const tson::Rect &rect : builder.buildRects(*layer))
+	 *     world.addBox(rect.x * tileWidth, rect.y * tileHeight, rect.width * tileWidth, rect.height * tileHeight);
+	 */
+	class CollisionBuilder
+	{
+		public:
+			inline CollisionBuilder() = default;
+			inline explicit CollisionBuilder(std::string propertyName);
+			inline explicit CollisionBuilder(std::set<uint32_t> gids);
 
-			[[nodiscard]] inline const std::vector<tson::WangTile> &getWangTiles() const;
-			[[nodiscard]] inline const std::vector<tson::WangColor> &getCornerColors() const;
-			[[nodiscard]] inline const std::vector<tson::WangColor> &getEdgeColors() const;
+			inline void setThreadCount(size_t threadCount);
+			inline void setMergeFullTileShapes(bool mergeFullTileShapes);
 
-			inline tson::WangColor * getColor(const std::string &name);
-			inline const std::vector<tson::WangColor> &getColors() const;
-			inline PropertyCollection &getProperties();
+			inline const std::vector<tson::Rect> &buildRects(tson::Layer &layer);
+			inline const std::vector<tson::CollisionShape> &buildShapes(tson::Layer &layer);
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+			[[nodiscard]] inline const std::vector<tson::Rect> &getRects() const;
+			[[nodiscard]] inline const std::vector<tson::CollisionShape> &getShapes() const;
 
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			inline static tson::Vector2f TransformTilePoint(const tson::Vector2f &point, const tson::Vector2f &tileSize, uint32_t gid);
+
+			static constexpr int BandRows = 64;     /*! Number of rows in each band that is meshed on its own */
 
 		private:
+			inline void prepare(tson::Layer &layer);
+			inline bool isFullTileShape(tson::Tile &tile, const tson::Map &map) const;
+			inline static void MergeBand(uint8_t *mask, int width, int height, const tson::Vector2i &origin, std::vector<tson::Rect> &rects);
+			inline static void StitchBands(std::vector<std::vector<tson::Rect>> &bands, std::vector<tson::Rect> &rects);
+
+			std::string                     m_propertyName;
+			std::set<uint32_t>              m_gids;
+			size_t                          m_threadCount {0};
+			bool                            m_mergeFullTileShapes {true};
+
+			std::vector<uint8_t>            m_solidGids;        /*! index: gid without flip flags. 1 if the tile is solid */
+			std::vector<tson::Rect>         m_rects;
+			std::vector<tson::CollisionShape> m_shapes;
+	};
 
-			inline bool parseTiled15Props(IJson &json);
+	/*!
+	 * Tiles having a property with this name are solid. Boolean properties must also be true.
+	 * @param propertyName Name of the property
+	 */
+	CollisionBuilder::CollisionBuilder(std::string propertyName) : m_propertyName {std::move(propertyName)}
+	{
 
-			std::string                  m_name;          /*! 'name': Name of the Wang set */
-			int                          m_tile{};        /*! 'tile': Local ID of tile representing the Wang set */
-			std::vector<tson::WangTile>  m_wangTiles;     /*! 'wangtiles': Array of Wang tiles */
-			std::vector<tson::WangColor> m_cornerColors;  /*! 'cornercolors': Array of Wang colors */
-			std::vector<tson::WangColor> m_edgeColors;    /*! 'edgecolors': Array of Wang colors */
-			tson::PropertyCollection     m_properties; 	  /*! 'properties': A list of properties (name, value, type). */
+	}
 
-			//Tiled v1.5
-			std::vector<tson::WangColor> m_colors;        /*! 'colors': */
+	/*!
+	 * Tiles with one of these gids are solid.
+	 * @param gids Gids without flip flags
+	 */
+	CollisionBuilder::CollisionBuilder(std::set<uint32_t> gids) : m_gids {std::move(gids)}
+	{
 
-			tson::Map *                  m_map;
-			std::string                  m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
-			std::shared_ptr<tson::TiledClass> m_class {};
+	}
 
-	};
+	/*!
+	 * Number of threads used by buildRects(). 0 (default) uses the number of hardware threads.
+	 */
+	void CollisionBuilder::setThreadCount(size_t threadCount)
+	{
+		m_threadCount = threadCount;
+	}
 
 	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 * Whether tiles having a single rectangle in their objectgroup that covers the whole tile are solid. Default: true
 	 */
-	template<typename T>
-	T tson::WangSet::get(const std::string &name)
+	void CollisionBuilder::setMergeFullTileShapes(bool mergeFullTileShapes)
 	{
-		return m_properties.getValue<T>(name);
+		m_mergeFullTileShapes = mergeFullTileShapes;
 	}
-}
 
-tson::WangSet::WangSet(IJson &json, tson::Map *map)
-{
-	parse(json, map);
-}
+	/*!
+	 * Merges all solid tiles of the layer into axis aligned rectangles, with greedy meshing.
+	 * Every solid tile is covered by exactly one rectangle.
+	 * @param layer A tile layer
+	 * @return Rectangles in tile units, sorted by y and then x. For orthogonal maps, multiply by the tile size of the map to get pixels.
+	 */
+	const std::vector<tson::Rect> &CollisionBuilder::buildRects(tson::Layer &layer)
+	{
+		m_rects.clear();
+		prepare(layer);
+		if(layer.getType() != tson::LayerType::TileLayer || m_solidGids.empty())
+			return m_rects;
 
-bool tson::WangSet::parse(IJson &json, tson::Map *map)
-{
-	m_map = map;
-	bool allFound = true;
+		tson::Rect const bounds = layer.getTileBounds();
+		if(bounds.width <= 0 || bounds.height <= 0)
+			return m_rects;
 
-	if(json.count("tile") > 0) m_tile = json["tile"].get<int>(); else allFound = false;
-	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
+		size_t const bandCount = static_cast<size_t>((bounds.height + BandRows - 1) / BandRows);
+		std::vector<std::vector<tson::Rect>> bands(bandCount);
+		std::atomic<size_t> nextBand {0};
 
-	//More advanced data
-	if(json.count("wangtiles") > 0 && json["wangtiles"].isArray())
-	{
-		auto &wangtiles = json.array("wangtiles");
-		std::for_each(wangtiles.begin(), wangtiles.end(), [&](std::unique_ptr<IJson> &item) { m_wangTiles.emplace_back(*item); });
+		auto worker = [&]()
+		{
+			std::vector<uint8_t> mask;
+			for(size_t band = nextBand++; band < bandCount; band = nextBand++)
+			{
+				int const y = bounds.y + static_cast<int>(band) * BandRows;
+				int const rows = std::min(BandRows, bounds.y + bounds.height - y);
+				mask.assign(static_cast<size_t>(bounds.width) * static_cast<size_t>(rows), 0);
+				layer.forEachTileInRegion({bounds.x, y, bounds.width, rows}, [&](const tson::TileCell &cell)
+				{
+					uint32_t const gid = cell.gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+					if(gid < m_solidGids.size() && m_solidGids[gid] != 0)
+						mask[static_cast<size_t>(cell.posInTileUnits.y - y) * bounds.width + (cell.posInTileUnits.x - bounds.x)] = 1;
+				});
+				MergeBand(mask.data(), bounds.width, rows, {bounds.x, y}, bands[band]);
+			}
+		};
+
+		size_t threadCount = (m_threadCount == 0) ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : m_threadCount;
+		threadCount = std::min(threadCount, bandCount);
+		std::vector<std::thread> threads;
+		for(size_t i = 1; i < threadCount; ++i)
+			threads.emplace_back(worker);
+		worker();
+		for(auto &thread : threads)
+			thread.join();
+
+		StitchBands(bands, m_rects);
+		return m_rects;
 	}
-	if(json.count("cornercolors") > 0 && json["cornercolors"].isArray())
+
+	/*!
+	 * Gets the objectgroup shapes of all tiles in the layer that are not solid, in pixels.
+	 * The shapes are rotated by the rotation of the objects, flipped by the flip flags of the tiles,
+	 * and placed where the tile is drawn: At the bottom-left corner of its cell, moved by the offsets of the layer and tileset.
+	 * @param layer A tile layer
+	 * @return The shapes, in the order of the tiles (row-major), and then in the order of the objects in each objectgroup.
+	 */
+	const std::vector<tson::CollisionShape> &CollisionBuilder::buildShapes(tson::Layer &layer)
 	{
-		auto &cornercolors = json.array("cornercolors");
-		std::for_each(cornercolors.begin(), cornercolors.end(), [&](std::unique_ptr<IJson> &item) { m_cornerColors.emplace_back(*item, m_map); });
+		m_shapes.clear();
+		prepare(layer);
+		tson::Map *map = layer.getMap();
+		if(layer.getType() != tson::LayerType::TileLayer || map == nullptr)
+			return m_shapes;
+
+		float const cellHeight = static_cast<float>(map->getTileSize().y);
+		layer.forEachTileInRegion(layer.getTileBounds(), [&](const tson::TileCell &cell)
+		{
+			const tson::TileDrawInfo *info = map->getTileDrawInfo(cell.gid);
+			uint32_t const gid = cell.gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+			if(info == nullptr || info->tile == nullptr || (gid < m_solidGids.size() && m_solidGids[gid] != 0))
+				return;
+
+			std::vector<tson::Object> &objects = info->tile->getObjectgroup().getObjects();
+			if(objects.empty())
+				return;
+
+			tson::Vector2f const tileSize {static_cast<float>(info->drawingRect.width), static_cast<float>(info->drawingRect.height)};
+			bool const diagonal = (cell.gid & FLIPPED_DIAGONALLY_FLAG) != 0;
+			float const drawnHeight = (diagonal) ? tileSize.x : tileSize.y;
+			tson::Vector2f const origin {cell.position.x + static_cast<float>(info->tileOffset.x),
+										 cell.position.y + cellHeight - drawnHeight + static_cast<float>(info->tileOffset.y)};
+
+			for(auto &obj : objects)
+			{
+				tson::CollisionShape shape;
+				shape.type = obj.getObjectType();
+				shape.object = &obj;
+				shape.tile = info->tile;
+				shape.tilePosition = cell.posInTileUnits;
+
+				std::vector<tson::Vector2f> local;
+				auto const width = static_cast<float>(obj.getSize().x);
+				auto const height = static_cast<float>(obj.getSize().y);
+				if(shape.type == tson::ObjectType::Rectangle || shape.type == tson::ObjectType::Ellipse)
+					local = {{0.f, 0.f}, {width, 0.f}, {width, height}, {0.f, height}};
+				else if(shape.type == tson::ObjectType::Polygon || shape.type == tson::ObjectType::Polyline)
+				{
+					const auto &points = (shape.type == tson::ObjectType::Polygon) ? obj.getPolygons() : obj.getPolylines();
+					for(const auto &point : points)
+						local.emplace_back(static_cast<float>(point.x), static_cast<float>(point.y));
+				}
+				else if(shape.type == tson::ObjectType::Point)
+					local = {{0.f, 0.f}};
+				else
+					continue;
+
+				//Rotation is clockwise around the position of the object, as in Tiled
+				float const radians = obj.getRotation() * 3.14159265358979323846f / 180.f;
+				float const cosR = std::cos(radians);
+				float const sinR = std::sin(radians);
+				shape.points.reserve(local.size());
+				for(const auto &point : local)
+				{
+					tson::Vector2f const inTile {point.x * cosR - point.y * sinR + static_cast<float>(obj.getPosition().x),
+												 point.x * sinR + point.y * cosR + static_cast<float>(obj.getPosition().y)};
+					tson::Vector2f const transformed = TransformTilePoint(inTile, tileSize, cell.gid);
+					shape.points.emplace_back(transformed.x + origin.x, transformed.y + origin.y);
+				}
+				m_shapes.push_back(std::move(shape));
+			}
+		});
+
+		return m_shapes;
 	}
-	if(json.count("edgecolors") > 0 && json["edgecolors"].isArray())
+
+	/*!
+	 * The rectangles of the last call to buildRects()
+	 */
+	const std::vector<tson::Rect> &CollisionBuilder::getRects() const
 	{
-		auto &edgecolors = json.array("edgecolors");
-		std::for_each(edgecolors.begin(), edgecolors.end(), [&](std::unique_ptr<IJson> &item) { m_edgeColors.emplace_back(*item, m_map); });
+		return m_rects;
 	}
-	if(json.count("properties") > 0 && json["properties"].isArray())
+
+	/*!
+	 * The shapes of the last call to buildShapes()
+	 */
+	const std::vector<tson::CollisionShape> &CollisionBuilder::getShapes() const
 	{
-		auto &properties = json.array("properties");
-		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item); });
+		return m_shapes;
 	}
 
-	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+	/*!
+	 * Applies the flip flags of a gid to a point inside a tile, the same way Tiled flips the image of the tile:
+	 * Diagonally (swapping x and y) first, then horizontally and vertically.
+	 * @param point Point relative to the top-left corner of the tile
+	 * @param tileSize Size of the tile image before flipping
+	 * @param gid Gid with flip flags
+	 * @return The point relative to the top-left corner of the flipped tile
+	 */
+	tson::Vector2f CollisionBuilder::TransformTilePoint(const tson::Vector2f &point, const tson::Vector2f &tileSize, uint32_t gid)
+	{
+		tson::Vector2f result = point;
+		tson::Vector2f size = tileSize;
+		if((gid & FLIPPED_DIAGONALLY_FLAG) != 0)
+		{
+			std::swap(result.x, result.y);
+			std::swap(size.x, size.y);
+		}
+		if((gid & FLIPPED_HORIZONTALLY_FLAG) != 0)
+			result.x = size.x - result.x;
+		if((gid & FLIPPED_VERTICALLY_FLAG) != 0)
+			result.y = size.y - result.y;
 
-	if(!parseTiled15Props(json))
-		allFound = false;
+		return result;
+	}
 
-	return allFound;
-}
+	/*!
+	 * Evaluates the predicate once for every gid of the map
+	 */
+	void CollisionBuilder::prepare(tson::Layer &layer)
+	{
+		m_solidGids.clear();
+		tson::Map *map = layer.getMap();
+		if(map == nullptr)
+			return;
+
+		const std::vector<tson::TileDrawInfo> &table = map->getTileDrawTable();
+		m_solidGids.assign(table.size(), 0);
+		for(size_t gid = 0; gid < table.size(); ++gid)
+		{
+			tson::Tile *tile = table[gid].tile;
+			bool solid = m_gids.count(static_cast<uint32_t>(gid)) > 0;
+			if(!solid && tile != nullptr && !m_propertyName.empty())
+			{
+				tson::Property *property = tile->getProp(m_propertyName);
+				solid = property != nullptr && (property->getType() != tson::Type::Boolean || property->getValue<bool>());
+			}
+			if(!solid && tile != nullptr && m_mergeFullTileShapes)
+				solid = isFullTileShape(*tile, *map);
 
-/*!
- * Parsing data related to Tiled v1.5 changes
- * @param json The json containing data
- * @return Returns true if success
- */
+			m_solidGids[gid] = (solid) ? 1 : 0;
+		}
+	}
 
-bool tson::WangSet::parseTiled15Props(tson::IJson &json)
-{
-	if(json.count("colors") > 0 && json["colors"].isArray())
+	/*!
+	 * true if the objectgroup of the tile is a single unrotated rectangle covering the whole cell
+	 */
+	bool CollisionBuilder::isFullTileShape(tson::Tile &tile, const tson::Map &map) const
 	{
-		auto &colors = json.array("colors");
-		std::for_each(colors.begin(), colors.end(), [&](std::unique_ptr<IJson> &item) { m_colors.emplace_back(*item, m_map); });
-	}
-	return true;
-}
+		const std::vector<tson::Object> &objects = tile.getObjectgroup().getObjects();
+		if(objects.size() != 1 || tile.getTileset() == nullptr)
+			return false;
 
-/*!
- * 'name': Name of the Wang set
- * @return
- */
-const std::string &tson::WangSet::getName() const
-{
-	return m_name;
-}
+		const tson::Object &obj = objects[0];
+		const tson::Vector2i &tileSize = tile.getTileset()->getTileSize();
+		return obj.getObjectType() == tson::ObjectType::Rectangle && obj.getRotation() == 0.f &&
+			   obj.getPosition() == tson::Vector2i(0, 0) && obj.getSize() == tileSize && tileSize == map.getTileSize() &&
+			   tile.getTileset()->getTileOffset() == tson::Vector2i(0, 0);
+	}
 
-/*!
- * 'tile': Local ID of tile representing the Wang set
- * @return
- */
-int tson::WangSet::getTile() const
-{
-	return m_tile;
-}
+	/*!
+	 * Greedy meshing of one band: Each unused solid tile starts a rectangle that grows to the right as far as possible,
+	 * and then downwards as long as the whole row below is solid and unused.
+	 * @param mask One byte per tile: 1 = solid. Changed to 2 for tiles that are used.
+	 */
+	void CollisionBuilder::MergeBand(uint8_t *mask, int width, int height, const tson::Vector2i &origin, std::vector<tson::Rect> &rects)
+	{
+		for(int y = 0; y < height; ++y)
+		{
+			uint8_t *row = mask + static_cast<size_t>(y) * width;
+			for(int x = 0; x < width; ++x)
+			{
+				if(row[x] != 1)
+					continue;
 
-/*!
- * 'wangtiles': Array of Wang tiles
- * @return
- */
-const std::vector<tson::WangTile> &tson::WangSet::getWangTiles() const
-{
-	return m_wangTiles;
-}
+				int w = 1;
+				while(x + w < width && row[x + w] == 1)
+					++w;
 
-/*!
- * 'cornercolors': Array of Wang colors
- * @return
- */
-const std::vector<tson::WangColor> &tson::WangSet::getCornerColors() const
-{
-	return m_cornerColors;
-}
+				int h = 1;
+				for(; y + h < height; ++h)
+				{
+					const uint8_t *below = mask + static_cast<size_t>(y + h) * width + x;
+					if(!std::all_of(below, below + w, [](uint8_t value) { return value == 1; }))
+						break;
+				}
 
-/*!
- * 'edgecolors': Array of Wang colors
- * @return
- */
-const std::vector<tson::WangColor> &tson::WangSet::getEdgeColors() const
-{
-	return m_edgeColors;
-}
+				for(int fillY = y; fillY < y + h; ++fillY)
+					std::fill_n(mask + static_cast<size_t>(fillY) * width + x, w, static_cast<uint8_t>(2));
 
-/*!
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::WangSet::getProperties()
-{
-	return m_properties;
-}
+				rects.emplace_back(origin.x + x, origin.y + y, w, h);
+				x += w - 1;
+			}
+		}
+	}
 
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::WangSet::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
+	/*!
+	 * Joins rectangles ending at the bottom of a band with rectangles starting at the top of the next band,
+	 * when they have the same x and width.
+	 */
+	void CollisionBuilder::StitchBands(std::vector<std::vector<tson::Rect>> &bands, std::vector<tson::Rect> &rects)
+	{
+		//key: x, width and bottom. Value: index in rects
+		std::map<std::tuple<int, int, int>, size_t> previous;
+		std::map<std::tuple<int, int, int>, size_t> current;
+		for(const auto &band : bands)
+		{
+			current.clear();
+			for(const auto &rect : band)
+			{
+				size_t index = rects.size();
+				auto iter = previous.find({rect.x, rect.width, rect.y});
+				if(iter != previous.end())
+				{
+					index = iter->second;
+					rects[index].height += rect.height;
+					previous.erase(iter);
+				}
+				else
+					rects.push_back(rect);
 
-	return nullptr;
-}
+				current[{rects[index].x, rects[index].width, rects[index].y + rects[index].height}] = index;
+			}
+			std::swap(previous, current);
+		}
 
-/*!
- * Get Wangset colors (new in Tiled v1.5)
- * @return
- */
-const std::vector<tson::WangColor> &tson::WangSet::getColors() const
-{
-	return m_colors;
+		std::sort(rects.begin(), rects.end(), [](const tson::Rect &a, const tson::Rect &b) { return (a.y != b.y) ? a.y < b.y : a.x < b.x; });
+	}
 }
 
-/*!
- * NB! Will only work with maps created/modified by Tiled v1.5 or later!
- * Gets a color from a wangset by its name.
- *
- * @param name 'name' of WangColor
- * @return The WangColor with the given name or nullptr if it doesn't exist.
- */
-tson::WangColor *tson::WangSet::getColor(const std::string &name)
-{
-	auto color = std::find_if(m_colors.begin(), m_colors.end(), [&](const auto &c) { return c.getName() == name; });
+#endif //TILESON_COLLISIONBUILDER_HPP
 
-	if(color != m_colors.end())
-		return &color.operator*();
+/*** End of inlined file: CollisionBuilder.hpp ***/
 
-	return nullptr;
-}
 
-const std::string &tson::WangSet::getClassType() const
+/*** Start of inlined file: NavigationGrid.hpp ***/
+#ifndef TILESON_NAVIGATIONGRID_HPP
+#define TILESON_NAVIGATIONGRID_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace tson
 {
-	return m_classType;
-}
+	class NavigationGrid;
 
-#endif //TILESON_WANGSET_HPP
+	/*!
+	 * The memory used by a path search of tson::NavigationGrid.
+	 *
+	 * The buffers are sized on the first search, and reused afterwards without being cleared (a generation counter tells which
+	 * entries belong to the current search), so searches on the same grid do not allocate.
+	 * A context may only be used by one search at a time: Give every worker thread its own context.
+	 */
+	class NavigationContext
+	{
+		public:
+			inline NavigationContext() = default;
 
-/*** End of inlined file: WangSet.hpp ***/
+			[[nodiscard]] inline size_t getExpandedNodes() const;
 
+		private:
+			friend class NavigationGrid;
+
+			inline void prepare(size_t cellCount);
+			inline void push(uint32_t estimatedCost, uint32_t node);
+			inline uint32_t pop();
+			inline void relax(uint32_t node, uint32_t parent, uint32_t cost, uint32_t estimatedCost);
+			[[nodiscard]] inline bool isClosed(uint32_t node) const;
+
+			std::vector<uint32_t>   m_costs;        /*! Cost from the start to each node */
+			std::vector<uint32_t>   m_parents;
+			std::vector<uint32_t>   m_seen;         /*! Generation in which the node got a cost */
+			std::vector<uint32_t>   m_closed;       /*! Generation in which the node was expanded */
+			std::vector<std::pair<uint32_t, uint32_t>> m_open; /*! Binary min-heap of (estimated total cost, node) */
+			uint32_t                m_generation {0};
+			size_t                  m_expandedNodes {0};
+	};
 
-/*** Start of inlined file: Tile.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	/*!
+	 * Number of nodes expanded by the last search
+	 */
+	size_t NavigationContext::getExpandedNodes() const
+	{
+		return m_expandedNodes;
+	}
 
-#ifndef TILESON_TILE_HPP
-#define TILESON_TILE_HPP
+	void NavigationContext::prepare(size_t cellCount)
+	{
+		if(m_costs.size() != cellCount)
+		{
+			m_costs.assign(cellCount, 0);
+			m_parents.assign(cellCount, 0);
+			m_seen.assign(cellCount, 0);
+			m_closed.assign(cellCount, 0);
+			m_generation = 0;
+		}
 
-//#include "../external/json.hpp"
+		if(++m_generation == 0)
+		{
+			std::fill(m_seen.begin(), m_seen.end(), 0);
+			std::fill(m_closed.begin(), m_closed.end(), 0);
+			m_generation = 1;
+		}
+		m_open.clear();
+		m_expandedNodes = 0;
+	}
 
+	void NavigationContext::push(uint32_t estimatedCost, uint32_t node)
+	{
+		m_open.emplace_back(estimatedCost, node);
+		std::push_heap(m_open.begin(), m_open.end(), std::greater<>());
+	}
 
-/*** Start of inlined file: Frame.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	uint32_t NavigationContext::pop()
+	{
+		std::pop_heap(m_open.begin(), m_open.end(), std::greater<>());
+		uint32_t const node = m_open.back().second;
+		m_open.pop_back();
+		return node;
+	}
 
-#ifndef TILESON_FRAME_HPP
-#define TILESON_FRAME_HPP
+	/*!
+	 * Gives the node a new cost when it is cheaper than what it had. Nodes are pushed again rather than updated in the heap,
+	 * and the outdated entries are skipped when they come out.
+	 */
+	void NavigationContext::relax(uint32_t node, uint32_t parent, uint32_t cost, uint32_t estimatedCost)
+	{
+		if(m_closed[node] == m_generation || (m_seen[node] == m_generation && m_costs[node] <= cost))
+			return;
 
-//#include "../external/json.hpp"
+		m_seen[node] = m_generation;
+		m_costs[node] = cost;
+		m_parents[node] = parent;
+		push(cost + estimatedCost, node);
+	}
 
-namespace tson
-{
-	class Frame
+	bool NavigationContext::isClosed(uint32_t node) const
+	{
+		return m_closed[node] == m_generation;
+	}
+
+	/*!
+	 * A walkability grid in tile units, compiled from the tile layers of a map, with A* and Jump Point Search.
+	 *
+	 * A cell is blocked when a tile in one of the selected layers matches the predicate given in the constructor
+	 * (a property, "solid" by default, or a set of gids). Empty cells are walkable. The grid is stored as a bitset.
+	 *
+	 * Isometric maps are searched in tile coordinates, just like orthogonal maps. Staggered and hexagonal maps use the
+	 * neighbours of their stagger axis and index. Searches only read the grid, so any number of threads can search at once,
+	 * as long as every thread has its own tson::NavigationContext.
+	 *
+	 * Example:
+	 * tson::NavigationGrid grid;
+	 * grid.build(*map, {"Walls"});
+	 * tson::NavigationContext context;
+	 * std::vector<tson::Vector2i> path;
+	 * if(grid.findPath(context, {1, 1}, {20, 14}, path))
+	 *     ...
+	 */
+	class NavigationGrid
 	{
 		public:
-			inline Frame() = default;
-			inline Frame(int duration, uint32_t tileId);
-			inline explicit Frame(IJson &json);
+			inline NavigationGrid() = default;
+			inline explicit NavigationGrid(std::string propertyName);
+			inline explicit NavigationGrid(std::set<uint32_t> gids);
 
-			inline bool parse(IJson &json);
+			inline void build(tson::Map &map, const std::vector<std::string> &layerNames = {});
+			inline void create(const tson::Rect &bounds, tson::NavigationTopology topology = tson::NavigationTopology::Orthogonal,
+							   bool staggerX = false, bool staggerEven = false);
 
-			[[nodiscard]] inline int getDuration() const;
-			[[nodiscard]] inline uint32_t getTileId() const;
+			inline void setWalkable(int x, int y, bool walkable);
+			inline void setDiagonalMovement(bool diagonalMovement);
+
+			[[nodiscard]] inline bool isWalkable(int x, int y) const;
+			[[nodiscard]] inline bool isDiagonalMovement() const;
+			[[nodiscard]] inline const tson::Rect &getBounds() const;
+			[[nodiscard]] inline tson::NavigationTopology getTopology() const;
+
+			inline bool findPath(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+								 std::vector<tson::Vector2i> &path) const;
+			inline bool findPathJps(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+									std::vector<tson::Vector2i> &path) const;
+
+			static constexpr uint32_t StraightCost = 10;    /*! Cost of a move to a neighbour sharing an edge */
+			static constexpr uint32_t DiagonalCost = 14;    /*! Cost of a move to a neighbour sharing a corner */
 
 		private:
-			int m_duration {};  /*! 'duration': Frame duration in milliseconds */
-			uint32_t m_tileId {};    /*! 'tileid': Local tile ID representing this frame */
+			inline void collectLayers(std::vector<tson::Layer> &layers, const std::vector<std::string> &layerNames, std::vector<tson::Layer *> &result);
+			inline void createBlockingTable(tson::Map &map, std::vector<uint8_t> &blockingGids) const;
+
+			[[nodiscard]] inline uint32_t toIndex(int x, int y) const;
+			[[nodiscard]] inline tson::Vector2i toPosition(uint32_t index) const;
+			[[nodiscard]] inline bool isShifted(int row) const;
+			[[nodiscard]] inline uint32_t getEstimatedCost(const tson::Vector2i &from, const tson::Vector2i &to) const;
+			[[nodiscard]] inline uint32_t getOctileCost(int dx, int dy) const;
+
+			template <typename Func>
+			inline void forEachNeighbour(int x, int y, Func &&func) const;
+
+			inline bool jump(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const;
+			inline bool jumpStraight(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const;
+			inline void createPath(const tson::NavigationContext &context, uint32_t start, uint32_t goal, bool fillGaps,
+								   std::vector<tson::Vector2i> &path) const;
+
+			std::string                 m_propertyName {"solid"};
+			std::set<uint32_t>          m_gids;
+
+			tson::Rect                  m_bounds {};
+			tson::NavigationTopology    m_topology {tson::NavigationTopology::Orthogonal};
+			bool                        m_staggerX {false};
+			bool                        m_staggerEven {false};
+			bool                        m_diagonalMovement {true};
+			std::vector<uint64_t>       m_walkable;     /*! One bit per cell, row-major. 1 = walkable */
 	};
-}
 
-/*!
- *
- * @param duration duration in milliseconds
- * @param tileId TileId
- */
-tson::Frame::Frame(int duration, uint32_t tileId) : m_duration {duration}, m_tileId {tileId}
-{
+	/*!
+	 * Tiles having a property with this name block the cell. Boolean properties must also be true.
+	 * @param propertyName Name of the property
+	 */
+	NavigationGrid::NavigationGrid(std::string propertyName) : m_propertyName {std::move(propertyName)}
+	{
 
-}
+	}
 
-/*!
- * Parses frame data from json
- * @param json
- */
-tson::Frame::Frame(IJson &json)
-{
-	parse(json);
-}
+	/*!
+	 * Tiles with one of these gids block the cell.
+	 * @param gids Gids without flip flags
+	 */
+	NavigationGrid::NavigationGrid(std::set<uint32_t> gids) : m_gids {std::move(gids)}
+	{
 
-/*!
- * Parses frame data from json
- * @param json
- * @return true if all mandatory fields was found. false otherwise.
- */
-bool tson::Frame::parse(IJson &json)
-{
-	bool allFound = true;
+	}
 
-	if(json.count("duration") > 0) m_duration = json["duration"].get<int>(); else allFound = false;
-	if(json.count("tileid") > 0) m_tileId = json["tileid"].get<uint32_t>() + 1; else allFound = false;
+	/*!
+	 * Compiles the grid from the tile layers of a map. The topology is taken from the orientation and stagger settings of the map,
+	 * and the bounds are the size of the map (or all chunks of the selected layers, for infinite maps).
+	 * @param map The map
+	 * @param layerNames Names of the tile layers to use, including layers inside groups. Empty (default) uses all tile layers.
+	 */
+	void NavigationGrid::build(tson::Map &map, const std::vector<std::string> &layerNames)
+	{
+		tson::NavigationTopology topology = tson::NavigationTopology::Orthogonal;
+		if(map.getOrientation() == "staggered")
+			topology = tson::NavigationTopology::Staggered;
+		else if(map.getOrientation() == "hexagonal")
+			topology = tson::NavigationTopology::Hexagonal;
 
-	return allFound;
-}
+		std::vector<tson::Layer *> layers;
+		collectLayers(map.getLayers(), layerNames, layers);
 
-/*!
- * 'duration': Frame duration in milliseconds
- * @return Duration in milliseconds
- */
-int tson::Frame::getDuration() const
-{
-	return m_duration;
-}
+		tson::Rect bounds {0, 0, map.getSize().x, map.getSize().y};
+		if(map.isInfinite())
+		{
+			bool first = true;
+			for(tson::Layer *layer : layers)
+			{
+				tson::Rect const layerBounds = layer->getTileBounds();
+				if(layerBounds.width <= 0 || layerBounds.height <= 0)
+					continue;
 
-/*!
- * 'tileid': Local tile ID representing this frame
- * @return tile id
- */
-uint32_t tson::Frame::getTileId() const
-{
-	return m_tileId;
-}
+				if(first)
+					bounds = layerBounds;
+				else
+				{
+					int const right = std::max(bounds.x + bounds.width, layerBounds.x + layerBounds.width);
+					int const bottom = std::max(bounds.y + bounds.height, layerBounds.y + layerBounds.height);
+					bounds.x = std::min(bounds.x, layerBounds.x);
+					bounds.y = std::min(bounds.y, layerBounds.y);
+					bounds.width = right - bounds.x;
+					bounds.height = bottom - bounds.y;
+				}
+				first = false;
+			}
+			if(first)
+				bounds = {};
+		}
 
-#endif //TILESON_FRAME_HPP
+		create(bounds, topology, map.getStaggerAxis() == "x", map.getStaggerIndex() == "even");
 
-/*** End of inlined file: Frame.hpp ***/
+		std::vector<uint8_t> blockingGids;
+		createBlockingTable(map, blockingGids);
+		if(blockingGids.empty())
+			return;
 
+		for(tson::Layer *layer : layers)
+		{
+			layer->forEachTileInRegion(m_bounds, [&](const tson::TileCell &cell)
+			{
+				uint32_t const gid = cell.gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+				if(gid < blockingGids.size() && blockingGids[gid] != 0)
+					setWalkable(cell.posInTileUnits.x, cell.posInTileUnits.y, false);
+			});
+		}
+	}
 
-/*** Start of inlined file: Animation.hpp ***/
-//
-// Created by robin on 21.05.2021.
-//
+	/*!
+	 * Creates a grid where every cell is walkable. Use setWalkable() to block cells.
+	 * @param bounds The cells of the grid, in tile units
+	 * @param topology How the cells are connected
+	 * @param staggerX true if the stagger axis is x (staggered and hexagonal only)
+	 * @param staggerEven true if the even rows/columns are shifted (staggered and hexagonal only)
+	 */
+	void NavigationGrid::create(const tson::Rect &bounds, tson::NavigationTopology topology, bool staggerX, bool staggerEven)
+	{
+		m_bounds = bounds;
+		if(m_bounds.width < 0 || m_bounds.height < 0)
+			m_bounds = {};
 
-#ifndef TILESON_ANIMATION_HPP
-#define TILESON_ANIMATION_HPP
+		m_topology = topology;
+		m_staggerX = staggerX;
+		m_staggerEven = staggerEven;
 
-namespace tson
-{
-	class Animation
+		size_t const cellCount = static_cast<size_t>(m_bounds.width) * static_cast<size_t>(m_bounds.height);
+		m_walkable.assign((cellCount + 63) / 64, ~uint64_t(0));
+	}
+
+	/*!
+	 * Changes a cell. Positions outside the grid are ignored.
+	 */
+	void NavigationGrid::setWalkable(int x, int y, bool walkable)
 	{
-		public:
-			inline Animation() = default;
-			inline Animation(const std::vector<tson::Frame> &frames) : m_frames {frames} {};
+		if(x < m_bounds.x || y < m_bounds.y || x >= m_bounds.x + m_bounds.width || y >= m_bounds.y + m_bounds.height)
+			return;
 
-			inline void update(float timeDeltaMs);
-			inline void reset();
+		uint32_t const index = toIndex(x, y);
+		if(walkable)
+			m_walkable[index >> 6] |= uint64_t(1) << (index & 63);
+		else
+			m_walkable[index >> 6] &= ~(uint64_t(1) << (index & 63));
+	}
 
-			inline void setFrames(const std::vector<tson::Frame> &frames);
-			inline void setCurrentFrame(uint32_t currentFrame);
-			inline void setTimeDelta(float timeDelta);
+	/*!
+	 * Whether moves to neighbours sharing only a corner are allowed (orthogonal and staggered maps). Default: true
+	 * Diagonal moves never cut corners: Both cells next to the move must be walkable.
+	 */
+	void NavigationGrid::setDiagonalMovement(bool diagonalMovement)
+	{
+		m_diagonalMovement = diagonalMovement;
+	}
 
-			inline const std::vector<tson::Frame> &getFrames() const;
-			inline const tson::Frame *getCurrentFrame() const;
-			inline uint32_t getCurrentFrameNumber() const;
-			inline uint32_t getCurrentTileId() const;
-			inline float getTimeDelta() const;
+	/*!
+	 * @return true if the cell is inside the grid and walkable
+	 */
+	bool NavigationGrid::isWalkable(int x, int y) const
+	{
+		if(x < m_bounds.x || y < m_bounds.y || x >= m_bounds.x + m_bounds.width || y >= m_bounds.y + m_bounds.height)
+			return false;
+
+		uint32_t const index = toIndex(x, y);
+		return ((m_walkable[index >> 6] >> (index & 63)) & 1) != 0;
+	}
+
+	bool NavigationGrid::isDiagonalMovement() const
+	{
+		return m_diagonalMovement;
+	}
+
+	/*!
+	 * The cells of the grid, in tile units
+	 */
+	const tson::Rect &NavigationGrid::getBounds() const
+	{
+		return m_bounds;
+	}
+
+	tson::NavigationTopology NavigationGrid::getTopology() const
+	{
+		return m_topology;
+	}
+
+	/*!
+	 * Finds the cheapest path with A*.
+	 * @param context Memory for the search. Must not be used by another search at the same time.
+	 * @param start Start cell in tile units
+	 * @param goal Goal cell in tile units
+	 * @param path Receives all cells of the path, from start to goal. Cleared when no path exists.
+	 * @return true if a path was found
+	 */
+	bool NavigationGrid::findPath(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+								  std::vector<tson::Vector2i> &path) const
+	{
+		path.clear();
+		if(!isWalkable(start.x, start.y) || !isWalkable(goal.x, goal.y))
+			return false;
+
+		context.prepare(static_cast<size_t>(m_bounds.width) * static_cast<size_t>(m_bounds.height));
+		uint32_t const startIndex = toIndex(start.x, start.y);
+		uint32_t const goalIndex = toIndex(goal.x, goal.y);
+		context.relax(startIndex, startIndex, 0, getEstimatedCost(start, goal));
+
+		while(!context.m_open.empty())
+		{
+			uint32_t const node = context.pop();
+			if(context.isClosed(node))
+				continue;
+
+			context.m_closed[node] = context.m_generation;
+			++context.m_expandedNodes;
+			if(node == goalIndex)
+			{
+				createPath(context, startIndex, goalIndex, false, path);
+				return true;
+			}
+
+			tson::Vector2i const position = toPosition(node);
+			uint32_t const cost = context.m_costs[node];
+			forEachNeighbour(position.x, position.y, [&](int x, int y, uint32_t moveCost)
+			{
+				context.relax(toIndex(x, y), node, cost + moveCost, getEstimatedCost({x, y}, goal));
+			});
+		}
+		return false;
+	}
+
+	/*!
+	 * Finds the cheapest path with Jump Point Search, which expands far fewer nodes than A* on open areas.
+	 * The result has the same cost as findPath(), and contains every cell of the path as well.
+	 *
+	 * Jump Point Search needs the symmetry of an orthogonal grid with diagonal movement: On staggered and hexagonal grids,
+	 * or without diagonal movement, this is the same as findPath().
+	 * @param context Memory for the search. Must not be used by another search at the same time.
+	 * @param start Start cell in tile units
+	 * @param goal Goal cell in tile units
+	 * @param path Receives all cells of the path, from start to goal. Cleared when no path exists.
+	 * @return true if a path was found
+	 */
+	bool NavigationGrid::findPathJps(tson::NavigationContext &context, const tson::Vector2i &start, const tson::Vector2i &goal,
+									 std::vector<tson::Vector2i> &path) const
+	{
+		if(m_topology != tson::NavigationTopology::Orthogonal || !m_diagonalMovement)
+			return findPath(context, start, goal, path);
+
+		path.clear();
+		if(!isWalkable(start.x, start.y) || !isWalkable(goal.x, goal.y))
+			return false;
+
+		context.prepare(static_cast<size_t>(m_bounds.width) * static_cast<size_t>(m_bounds.height));
+		uint32_t const startIndex = toIndex(start.x, start.y);
+		uint32_t const goalIndex = toIndex(goal.x, goal.y);
+		context.relax(startIndex, startIndex, 0, getEstimatedCost(start, goal));
+
+		int directions[8][2];
+		while(!context.m_open.empty())
+		{
+			uint32_t const node = context.pop();
+			if(context.isClosed(node))
+				continue;
+
+			context.m_closed[node] = context.m_generation;
+			++context.m_expandedNodes;
+			if(node == goalIndex)
+			{
+				createPath(context, startIndex, goalIndex, true, path);
+				return true;
+			}
+
+			int const x = toPosition(node).x;
+			int const y = toPosition(node).y;
+			size_t count = 0;
+			auto add = [&](int dx, int dy) { directions[count][0] = dx; directions[count][1] = dy; ++count; };
+
+			if(node == startIndex)
+			{
+				//No parent: Every direction
+				for(int dy = -1; dy <= 1; ++dy)
+					for(int dx = -1; dx <= 1; ++dx)
+						if((dx != 0 || dy != 0) && (dx == 0 || dy == 0 || (isWalkable(x + dx, y) && isWalkable(x, y + dy))))
+							add(dx, dy);
+			}
+			else
+			{
+				//Only the natural and forced neighbours in the direction of travel
+				tson::Vector2i const parent = toPosition(context.m_parents[node]);
+				int const dx = (x > parent.x) - (x < parent.x);
+				int const dy = (y > parent.y) - (y < parent.y);
+				if(dx != 0 && dy != 0)
+				{
+					bool const vertical = isWalkable(x, y + dy);
+					bool const horizontal = isWalkable(x + dx, y);
+					if(vertical)
+						add(0, dy);
+					if(horizontal)
+						add(dx, 0);
+					if(vertical && horizontal)
+						add(dx, dy);
+				}
+				else if(dx != 0)
+				{
+					bool const up = isWalkable(x, y - 1);
+					bool const down = isWalkable(x, y + 1);
+					if(isWalkable(x + dx, y))
+					{
+						add(dx, 0);
+						if(up)
+							add(dx, -1);
+						if(down)
+							add(dx, 1);
+					}
+					if(up)
+						add(0, -1);
+					if(down)
+						add(0, 1);
+				}
+				else
+				{
+					bool const left = isWalkable(x - 1, y);
+					bool const right = isWalkable(x + 1, y);
+					if(isWalkable(x, y + dy))
+					{
+						add(0, dy);
+						if(left)
+							add(-1, dy);
+						if(right)
+							add(1, dy);
+					}
+					if(left)
+						add(-1, 0);
+					if(right)
+						add(1, 0);
+				}
+			}
 
-			inline bool any() const;
-			inline size_t size() const;
+			uint32_t const cost = context.m_costs[node];
+			for(size_t i = 0; i < count; ++i)
+			{
+				tson::Vector2i jumpPoint;
+				if(!jump(x + directions[i][0], y + directions[i][1], directions[i][0], directions[i][1], goal, jumpPoint))
+					continue;
 
-		private:
-			inline int nextFrame();
-			std::vector<tson::Frame> m_frames;
-			uint32_t m_currentFrame {0};
-			float m_timeDelta {0};
-	};
+				context.relax(toIndex(jumpPoint.x, jumpPoint.y), node, cost + getOctileCost(jumpPoint.x - x, jumpPoint.y - y),
+							  getEstimatedCost(jumpPoint, goal));
+			}
+		}
+		return false;
+	}
 
-	const std::vector<tson::Frame> &Animation::getFrames() const
+	void NavigationGrid::collectLayers(std::vector<tson::Layer> &layers, const std::vector<std::string> &layerNames, std::vector<tson::Layer *> &result)
 	{
-		return m_frames;
+		for(auto &layer : layers)
+		{
+			if(layer.getType() == tson::LayerType::Group)
+				collectLayers(layer.getLayers(), layerNames, result);
+			else if(layer.getType() == tson::LayerType::TileLayer &&
+					(layerNames.empty() || std::find(layerNames.begin(), layerNames.end(), layer.getName()) != layerNames.end()))
+				result.push_back(&layer);
+		}
 	}
 
 	/*!
-	 * Resets the current frame and time delta to 0.
+	 * One byte per gid (without flip flags): 1 if tiles with the gid block the cell.
 	 */
-	void Animation::reset()
+	void NavigationGrid::createBlockingTable(tson::Map &map, std::vector<uint8_t> &blockingGids) const
 	{
-		m_currentFrame = 0;
-		m_timeDelta = 0.f;
+		const std::vector<tson::TileDrawInfo> &table = map.getTileDrawTable();
+		blockingGids.assign(table.size(), 0);
+		for(size_t gid = 0; gid < table.size(); ++gid)
+		{
+			tson::Tile *tile = table[gid].tile;
+			bool blocking = m_gids.count(static_cast<uint32_t>(gid)) > 0;
+			if(!blocking && tile != nullptr && !m_propertyName.empty())
+			{
+				tson::Property *property = tile->getProp(m_propertyName);
+				blocking = property != nullptr && (property->getType() != tson::Type::Boolean || property->getValue<bool>());
+			}
+			blockingGids[gid] = (blocking) ? 1 : 0;
+		}
 	}
 
-	/*!
-	 * Gets the current frame or nullptr if no frame is found.
-	 * @return
-	 */
-	const tson::Frame *Animation::getCurrentFrame() const
+	uint32_t NavigationGrid::toIndex(int x, int y) const
 	{
-		return (m_frames.size() == 0 || m_currentFrame >= m_frames.size()) ? nullptr : &m_frames.at(m_currentFrame);
+		return static_cast<uint32_t>((y - m_bounds.y) * m_bounds.width + (x - m_bounds.x));
 	}
 
-	size_t Animation::size() const
+	tson::Vector2i NavigationGrid::toPosition(uint32_t index) const
 	{
-		return m_frames.size();
+		int const i = static_cast<int>(index);
+		return {m_bounds.x + i % m_bounds.width, m_bounds.y + i / m_bounds.width};
 	}
 
 	/*!
-	 * Update animation based on the fra
-	 * @param timedeltaMs Time in milliseconds
+	 * true if the row (or column, when the stagger axis is x) is shifted by half a tile
 	 */
-	void Animation::update(float timeDeltaMs)
+	bool NavigationGrid::isShifted(int row) const
 	{
-		const tson::Frame *frame = getCurrentFrame();
-		if(frame != nullptr)
-		{
-			m_timeDelta += timeDeltaMs;
-			if(m_timeDelta >= frame->getDuration())
-			{
-				m_timeDelta = static_cast<float>((int32_t)m_timeDelta % frame->getDuration());
-				m_currentFrame = nextFrame();
-			}
-		}
+		return ((row & 1) != 0) != m_staggerEven;
 	}
 
-	int Animation::nextFrame()
+	uint32_t NavigationGrid::getOctileCost(int dx, int dy) const
 	{
-		return (m_currentFrame+1 >= m_frames.size()) ? 0 : m_currentFrame + 1;
-	}
+		uint32_t const ax = static_cast<uint32_t>(std::abs(dx));
+		uint32_t const ay = static_cast<uint32_t>(std::abs(dy));
+		if(!m_diagonalMovement)
+			return (ax + ay) * StraightCost;
 
-	float Animation::getTimeDelta() const
-	{
-		return m_timeDelta;
+		uint32_t const diagonal = std::min(ax, ay);
+		return diagonal * DiagonalCost + (std::max(ax, ay) - diagonal) * StraightCost;
 	}
 
-	uint32_t Animation::getCurrentFrameNumber() const
+	/*!
+	 * The cost of the cheapest path without any blocked cells. Never more than the real cost, so A* finds the cheapest path.
+	 */
+	uint32_t NavigationGrid::getEstimatedCost(const tson::Vector2i &from, const tson::Vector2i &to) const
 	{
-		return m_currentFrame;
-	}
+		if(m_topology == tson::NavigationTopology::Orthogonal)
+			return getOctileCost(to.x - from.x, to.y - from.y);
+
+		//Positions in half tiles: The shifted rows are half a tile further along the row
+		int const fromRow = (m_staggerX) ? from.x : from.y;
+		int const toRow = (m_staggerX) ? to.x : to.y;
+		int const fromColumn = 2 * ((m_staggerX) ? from.y : from.x) + (isShifted(fromRow) ? 1 : 0);
+		int const toColumn = 2 * ((m_staggerX) ? to.y : to.x) + (isShifted(toRow) ? 1 : 0);
+		int const dColumn = toColumn - fromColumn;
+		int const dRow = toRow - fromRow;
+
+		if(m_topology == tson::NavigationTopology::Hexagonal)
+		{
+			uint32_t const rows = static_cast<uint32_t>(std::abs(dRow));
+			uint32_t const columns = static_cast<uint32_t>(std::abs(dColumn));
+			return (rows + ((columns > rows) ? (columns - rows) / 2 : 0)) * StraightCost;
+		}
 
-	uint32_t Animation::getCurrentTileId() const
-	{
-		return (getCurrentFrame() != nullptr) ? getCurrentFrame()->getTileId() : 0;
+		//Staggered tiles form an orthogonal grid rotated by 45 degrees
+		return getOctileCost((dColumn + dRow) / 2, (dRow - dColumn) / 2);
 	}
 
-	void Animation::setFrames(const std::vector<tson::Frame> &frames)
+	/*!
+	 * Calls func(x, y, cost) for each walkable neighbour of a cell.
+	 */
+	template<typename Func>
+	void NavigationGrid::forEachNeighbour(int x, int y, Func &&func) const
 	{
-		m_frames = frames;
+		if(m_topology == tson::NavigationTopology::Orthogonal)
+		{
+			static constexpr int Straight[4][2] {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+			for(const auto &d : Straight)
+			{
+				if(isWalkable(x + d[0], y + d[1]))
+					func(x + d[0], y + d[1], StraightCost);
+			}
+
+			if(!m_diagonalMovement)
+				return;
+
+			static constexpr int Diagonal[4][2] {{1, -1}, {1, 1}, {-1, 1}, {-1, -1}};
+			for(const auto &d : Diagonal)
+			{
+				if(isWalkable(x + d[0], y + d[1]) && isWalkable(x + d[0], y) && isWalkable(x, y + d[1]))
+					func(x + d[0], y + d[1], DiagonalCost);
+			}
+			return;
+		}
+
+		//Staggered and hexagonal maps: Work in rows and columns along the stagger axis, and swap back for the result
+		int const row = (m_staggerX) ? x : y;
+		int const column = (m_staggerX) ? y : x;
+		auto cell = [&](int c, int r) { return (m_staggerX) ? tson::Vector2i {r, c} : tson::Vector2i {c, r}; };
+		auto visit = [&](const tson::Vector2i &p, uint32_t cost) { if(isWalkable(p.x, p.y)) func(p.x, p.y, cost); };
+
+		//The neighbours in the rows before and after share an edge
+		int const left = (isShifted(row)) ? column : column - 1;
+		tson::Vector2i const previousLeft = cell(left, row - 1);
+		tson::Vector2i const previousRight = cell(left + 1, row - 1);
+		tson::Vector2i const nextLeft = cell(left, row + 1);
+		tson::Vector2i const nextRight = cell(left + 1, row + 1);
+		visit(previousLeft, StraightCost);
+		visit(previousRight, StraightCost);
+		visit(nextLeft, StraightCost);
+		visit(nextRight, StraightCost);
+
+		if(m_topology == tson::NavigationTopology::Hexagonal)
+		{
+			visit(cell(column - 1, row), StraightCost);
+			visit(cell(column + 1, row), StraightCost);
+			return;
+		}
+
+		if(!m_diagonalMovement)
+			return;
+
+		//Staggered tiles also touch four tiles with a corner, which are reached through the two tiles in between
+		auto walkable = [&](const tson::Vector2i &p) { return isWalkable(p.x, p.y); };
+		if(walkable(previousLeft) && walkable(nextLeft))
+			visit(cell(column - 1, row), DiagonalCost);
+		if(walkable(previousRight) && walkable(nextRight))
+			visit(cell(column + 1, row), DiagonalCost);
+		if(walkable(previousLeft) && walkable(previousRight))
+			visit(cell(column, row - 2), DiagonalCost);
+		if(walkable(nextLeft) && walkable(nextRight))
+			visit(cell(column, row + 2), DiagonalCost);
 	}
 
-	void Animation::setCurrentFrame(uint32_t currentFrame)
+	/*!
+	 * Moves from a cell in one direction until a jump point is found: The goal, or a cell with a forced neighbour.
+	 * Diagonal moves stop where a straight move from the cell finds a jump point.
+	 * @return true if a jump point was found before running into a blocked cell
+	 */
+	bool NavigationGrid::jump(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const
 	{
-		m_currentFrame = currentFrame;
+		if(dx == 0 || dy == 0)
+			return jumpStraight(x, y, dx, dy, goal, result);
+
+		tson::Vector2i found;
+		while(isWalkable(x, y))
+		{
+			if((x == goal.x && y == goal.y) || jumpStraight(x + dx, y, dx, 0, goal, found) || jumpStraight(x, y + dy, 0, dy, goal, found))
+			{
+				result = {x, y};
+				return true;
+			}
+
+			//No corner cutting
+			if(!isWalkable(x + dx, y) || !isWalkable(x, y + dy))
+				return false;
+
+			x += dx;
+			y += dy;
+		}
+		return false;
 	}
 
-	void Animation::setTimeDelta(float timeDelta)
+	bool NavigationGrid::jumpStraight(int x, int y, int dx, int dy, const tson::Vector2i &goal, tson::Vector2i &result) const
 	{
-		m_timeDelta = timeDelta;
+		while(isWalkable(x, y))
+		{
+			//A neighbour next to the move is forced when the cell behind it is blocked, since it cannot be reached diagonally from behind
+			bool forced = (x == goal.x && y == goal.y);
+			if(!forced && dx != 0)
+				forced = (isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1)) || (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1));
+			else if(!forced)
+				forced = (isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy)) || (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy));
+
+			if(forced)
+			{
+				result = {x, y};
+				return true;
+			}
+
+			x += dx;
+			y += dy;
+		}
+		return false;
 	}
 
 	/*!
-	 * True if any frames exists, false otherwise
-	 * @return
+	 * Follows the parents from the goal back to the start.
+	 * @param fillGaps true to add the cells between jump points, which are on a straight or diagonal line
 	 */
-	bool Animation::any() const
+	void NavigationGrid::createPath(const tson::NavigationContext &context, uint32_t start, uint32_t goal, bool fillGaps,
+									std::vector<tson::Vector2i> &path) const
 	{
-		return m_frames.size() > 0;
+		path.clear();
+		for(uint32_t node = goal; ; node = context.m_parents[node])
+		{
+			tson::Vector2i const position = toPosition(node);
+			if(fillGaps && !path.empty())
+			{
+				tson::Vector2i current = path.back();
+				int const dx = (position.x > current.x) - (position.x < current.x);
+				int const dy = (position.y > current.y) - (position.y < current.y);
+				for(current = {current.x + dx, current.y + dy}; current != position; current = {current.x + dx, current.y + dy})
+					path.push_back(current);
+			}
+			path.push_back(position);
+
+			if(node == start)
+				break;
+		}
+		std::reverse(path.begin(), path.end());
 	}
 }
 
-#endif //TILESON_ANIMATION_HPP
+#endif //TILESON_NAVIGATIONGRID_HPP
 
-/*** End of inlined file: Animation.hpp ***/
+/*** End of inlined file: NavigationGrid.hpp ***/
+
+
+/*** Start of inlined file: WangAutotiler.hpp ***/
+#ifndef TILESON_WANGAUTOTILER_HPP
+#define TILESON_WANGAUTOTILER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
 
 namespace tson
 {
-	class Tileset;
-	class TiledClass;
-
-	class Tile
+	/*!
+	 * Picks tiles from a tson::WangSet for a grid of terrain colors, for terrain that changes at runtime.
+	 *
+	 * Colors are stored where Tiled stores them: on the corners between cells and on the edges between cells.
+	 * Changing a color only resolves the cells touching it, each with a single hash lookup in the tson::WangLookup of the wang set,
+	 * so an edit costs the same no matter how large the grid is. Cells whose tile changed are collected in getChangedCells().
+	 *
+	 * When several tiles match, one is picked by the position of the cell, so the same terrain always gives the same tiles.
+	 * When no tile matches exactly, the tile matching the most colors is used. Those searches are remembered.
+	 *
+	 * Example:
+	 * tson::WangAutotiler autotiler {*tileset->getWangset("Terrain")};
+	 * autotiler.create(*map->getLayer("Ground"));
+	 * autotiler.paint(10, 4, 2);
+	 * for(const tson::Vector2i &cell : autotiler.getChangedCells())
+	 *     renderer.setTile(cell, autotiler.getGid(cell.x, cell.y));
+	 * autotiler.clearChangedCells();
+	 */
+	class WangAutotiler
 	{
 		public:
-			inline Tile() = default;
-			inline Tile(IJson &json, tson::Tileset *tileset, tson::Map *map);
-			inline static Tile CreateFlippedTile(uint32_t gid, tson::Map *map); // v1.2.0
-			inline static Tile CreateMissingTile(uint32_t id, tson::Tileset* tileset, tson::Map* map);
-			inline bool parse(IJson &json, tson::Tileset *tileset, tson::Map *map);
-			inline bool parseId(IJson &json);
+			inline WangAutotiler() = default;
+			inline explicit WangAutotiler(const tson::WangSet &wangset);
 
-			[[nodiscard]] inline uint32_t getId() const;
-			[[nodiscard]] inline const fs::path &getImage() const;
-			[[nodiscard]] inline const Vector2i &getImageSize() const;
-			[[nodiscard]] inline const std::string &getType() const;
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
+			inline void create(int width, int height);
+			inline void create(tson::Layer &layer);
 
-			//[[nodiscard]] inline const std::vector<tson::Frame> &getAnimation() const;
-			[[nodiscard]] inline tson::Animation &getAnimation();
-			[[nodiscard]] inline Layer &getObjectgroup();
-			[[nodiscard]] inline PropertyCollection &getProperties();
-			[[nodiscard]] inline const std::vector<int> &getTerrain() const;
+			inline void paint(int x, int y, uint8_t color);
+			inline void setCornerColor(int x, int y, uint8_t color);
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+			[[nodiscard]] inline uint32_t getGid(int x, int y) const;
+			[[nodiscard]] inline uint64_t getWangId(int x, int y) const;
+			[[nodiscard]] inline const std::vector<uint32_t> &getGids() const;
+			[[nodiscard]] inline const tson::Vector2i &getSize() const;
+			[[nodiscard]] inline const std::vector<tson::Vector2i> &getChangedCells() const;
+			inline void clearChangedCells();
 
-			//v1.2.0-stuff
-			inline void setProperties(const tson::PropertyCollection &properties);
+		private:
+			[[nodiscard]] inline bool contains(int x, int y) const;
+			inline void resolve(int x, int y);
+			inline uint32_t findBestMatch(uint64_t wangId);
+
+			const tson::WangLookup                  *m_lookup {nullptr};
+			bool                                    m_usesCorners {false};
+			bool                                    m_usesEdges {false};
+
+			tson::Vector2i                          m_size;
+			std::vector<uint8_t>                    m_corners;          /*! (width + 1) * (height + 1): The corners of the cells */
+			std::vector<uint8_t>                    m_horizontalEdges;  /*! width * (height + 1): The top and bottom edges of the cells */
+			std::vector<uint8_t>                    m_verticalEdges;    /*! (width + 1) * height: The left and right edges of the cells */
+			std::vector<uint32_t>                   m_gids;             /*! width * height: The resolved gids, with flip flags */
+			std::vector<uint8_t>                    m_changed;          /*! width * height: 1 if the cell is in m_changedCells */
+			std::vector<tson::Vector2i>             m_changedCells;
+			std::unordered_map<uint64_t, uint32_t>  m_bestMatches;      /*! Wang id without an exact match -> gid */
+	};
 
-			[[nodiscard]] inline tson::Tileset * getTileset() const;
-			[[nodiscard]] inline tson::Map * getMap() const;
-			[[nodiscard]] inline const tson::Rect &getDrawingRect() const;
-			[[nodiscard]] inline const Rect &getSubRectangle() const;
+	/*!
+	 * @param wangset The wang set to pick tiles from. Must outlive the autotiler.
+	 */
+	WangAutotiler::WangAutotiler(const tson::WangSet &wangset) : m_lookup {&wangset.getLookup()}
+	{
+		m_usesCorners = m_lookup->usesCorners();
+		m_usesEdges = m_lookup->usesEdges();
+	}
 
-			inline const tson::Vector2f getPosition(const std::tuple<int, int> &tileDataPos);
-			inline const tson::Vector2i getPositionInTileUnits(const std::tuple<int, int> &tileDataPos);
-			[[nodiscard]] inline const tson::Vector2i getTileSize() const;                       /*! Declared in tileson_forward.hpp */
+	/*!
+	 * Creates an empty grid, where no cell has a tile.
+	 * @param width Width in tiles
+	 * @param height Height in tiles
+	 */
+	void WangAutotiler::create(int width, int height)
+	{
+		m_size = {std::max(width, 0), std::max(height, 0)};
+		size_t const w = static_cast<size_t>(m_size.x);
+		size_t const h = static_cast<size_t>(m_size.y);
+		m_corners.assign((w + 1) * (h + 1), 0);
+		m_horizontalEdges.assign(w * (h + 1), 0);
+		m_verticalEdges.assign((w + 1) * h, 0);
+		m_gids.assign(w * h, 0);
+		m_changed.assign(w * h, 0);
+		m_changedCells.clear();
+	}
 
-			[[nodiscard]] inline TileFlipFlags getFlipFlags() const;
-			inline bool hasFlipFlags(TileFlipFlags flags);
-			[[nodiscard]] inline uint32_t getGid() const;
+	/*!
+	 * Creates the grid from the tiles of a (finite) tile layer. The colors are taken from the tiles of the wang set,
+	 * including their flip flags, and the tiles of the layer are kept as they are until the terrain around them changes.
+	 * @param layer A tile layer
+	 */
+	void WangAutotiler::create(tson::Layer &layer)
+	{
+		create(layer.getSize().x, layer.getSize().y);
+		const std::vector<uint32_t> &data = layer.getData();
+		if(m_lookup == nullptr || data.size() != m_gids.size())
+			return;
 
-			inline void addTilesetAndPerformCalculations(tson::Tileset *tileset); //v1.2.0
+		int const w = m_size.x;
+		for(int y = 0; y < m_size.y; ++y)
+		{
+			for(int x = 0; x < w; ++x)
+			{
+				size_t const index = static_cast<size_t>(y * w + x);
+				m_gids[index] = data[index];
+				uint64_t const wangId = m_lookup->getWangId(data[index]);
+				if(wangId == 0)
+					continue;
+
+				m_horizontalEdges[static_cast<size_t>(y * w + x)] = tson::WangLookup::GetColor(wangId, 0);
+				m_verticalEdges[static_cast<size_t>(y * (w + 1) + x + 1)] = tson::WangLookup::GetColor(wangId, 2);
+				m_horizontalEdges[static_cast<size_t>((y + 1) * w + x)] = tson::WangLookup::GetColor(wangId, 4);
+				m_verticalEdges[static_cast<size_t>(y * (w + 1) + x)] = tson::WangLookup::GetColor(wangId, 6);
+				m_corners[static_cast<size_t>(y * (w + 1) + x + 1)] = tson::WangLookup::GetColor(wangId, 1);
+				m_corners[static_cast<size_t>((y + 1) * (w + 1) + x + 1)] = tson::WangLookup::GetColor(wangId, 3);
+				m_corners[static_cast<size_t>((y + 1) * (w + 1) + x)] = tson::WangLookup::GetColor(wangId, 5);
+				m_corners[static_cast<size_t>(y * (w + 1) + x)] = tson::WangLookup::GetColor(wangId, 7);
+			}
+		}
+	}
 
-		private:
-			tson::Animation                  m_animation{};      /*! 'animation': Array of Frames */
-			uint32_t                         m_id {};            /*! 'id': Local ID of the tile */
+	/*!
+	 * Gives a whole cell a color: Its four corners and/or its four edges, depending on what the wang set uses.
+	 * The cell and its eight neighbours are resolved again.
+	 * @param x X position of the cell in tiles
+	 * @param y Y position of the cell in tiles
+	 * @param color The wang color (1-based, as in Tiled). 0 removes the terrain.
+	 */
+	void WangAutotiler::paint(int x, int y, uint8_t color)
+	{
+		if(!contains(x, y))
+			return;
 
-			fs::path                         m_image;            /*! 'image': Image representing this tile (optional)*/
+		int const w = m_size.x;
+		if(m_usesCorners)
+		{
+			m_corners[static_cast<size_t>(y * (w + 1) + x)] = color;
+			m_corners[static_cast<size_t>(y * (w + 1) + x + 1)] = color;
+			m_corners[static_cast<size_t>((y + 1) * (w + 1) + x)] = color;
+			m_corners[static_cast<size_t>((y + 1) * (w + 1) + x + 1)] = color;
+		}
+		if(m_usesEdges)
+		{
+			m_horizontalEdges[static_cast<size_t>(y * w + x)] = color;
+			m_horizontalEdges[static_cast<size_t>((y + 1) * w + x)] = color;
+			m_verticalEdges[static_cast<size_t>(y * (w + 1) + x)] = color;
+			m_verticalEdges[static_cast<size_t>(y * (w + 1) + x + 1)] = color;
+		}
 
-			tson::Vector2i                   m_imageSize;        /*! x = 'imagewidth' and y = 'imageheight': in pixels */
-			tson::Layer                      m_objectgroup; 	 	/*! 'objectgroup': Layer with type objectgroup (optional) */
-			tson::PropertyCollection         m_properties; 	    /*! 'properties': A list of properties (name, value, type). */
-			std::vector<int>                 m_terrain;          /*! 'terrain': Index of terrain for each corner of tile */
-			std::string                      m_type;             /*! 'type': The type of the tile (optional) */
+		for(int ny = y - 1; ny <= y + 1; ++ny)
+			for(int nx = x - 1; nx <= x + 1; ++nx)
+				resolve(nx, ny);
+	}
 
-			//v1.2.0-stuff
-			uint32_t                    m_gid {};                                    /*! id without flip flags */
-			tson::Tileset *             m_tileset;                                   /*! A pointer to the tileset where this Tile comes from */
-			tson::Map *                 m_map;                                       /*! A pointer to the map where this tile is contained */
-			tson::Rect                  m_drawingRect;                               /*! A rect that shows which part of the tileset that is used for this tile */
-			tson::Rect                  m_subRect;                                   /*! Tiled 1.9: Contains the newly added sub-rectangle variables: 'x', 'y', 'width' and 'height'*/
-			tson::TileFlipFlags         m_flipFlags = TileFlipFlags::None;           /*! Resolved using bit 32, 31 and 30 from gid */
-			inline void performDataCalculations();                                   /*! Declared in tileson_forward.hpp - Calculate all the values used in the tile class. */
-			inline void manageFlipFlagsByIdThenRemoveFlags(uint32_t &id);
-			friend class Layer;
-			std::shared_ptr<tson::TiledClass> m_class {};
-	};
+	/*!
+	 * Sets the color of a single corner, like the terrain brush of Tiled. The four cells sharing the corner are resolved again.
+	 * @param x X position of the corner: 0 is the left side of the grid, and width the right side
+	 * @param y Y position of the corner: 0 is the top of the grid, and height the bottom
+	 * @param color The wang color (1-based, as in Tiled). 0 removes the terrain.
+	 */
+	void WangAutotiler::setCornerColor(int x, int y, uint8_t color)
+	{
+		if(x < 0 || y < 0 || x > m_size.x || y > m_size.y)
+			return;
+
+		m_corners[static_cast<size_t>(y * (m_size.x + 1) + x)] = color;
+		resolve(x - 1, y - 1);
+		resolve(x, y - 1);
+		resolve(x - 1, y);
+		resolve(x, y);
+	}
 
 	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 * Gets the tile of a cell.
+	 * @return The gid with flip flags. 0 if the cell has no tile, or is outside the grid.
 	 */
-	template<typename T>
-	T tson::Tile::get(const std::string &name)
+	uint32_t WangAutotiler::getGid(int x, int y) const
 	{
-		return m_properties.getValue<T>(name);
+		return (contains(x, y)) ? m_gids[static_cast<size_t>(y * m_size.x + x)] : 0;
 	}
-}
 
-tson::Tile::Tile(IJson &json, tson::Tileset *tileset, tson::Map *map)
-{
-	parse(json, tileset, map);
-}
+	/*!
+	 * Gets the colors around a cell as a packed wang id (see tson::WangLookup).
+	 */
+	uint64_t WangAutotiler::getWangId(int x, int y) const
+	{
+		if(!contains(x, y))
+			return 0;
 
-/*!
- * For flip flagged tiles, tilesets must be resolved later.
- * @param tileset
- */
-void tson::Tile::addTilesetAndPerformCalculations(tson::Tileset *tileset)
-{
-	m_tileset = tileset;
-	performDataCalculations();
-}
+		int const w = m_size.x;
+		uint64_t wangId = 0;
+		if(m_usesEdges)
+		{
+			wangId |= static_cast<uint64_t>(m_horizontalEdges[static_cast<size_t>(y * w + x)]);
+			wangId |= static_cast<uint64_t>(m_verticalEdges[static_cast<size_t>(y * (w + 1) + x + 1)]) << 16;
+			wangId |= static_cast<uint64_t>(m_horizontalEdges[static_cast<size_t>((y + 1) * w + x)]) << 32;
+			wangId |= static_cast<uint64_t>(m_verticalEdges[static_cast<size_t>(y * (w + 1) + x)]) << 48;
+		}
+		if(m_usesCorners)
+		{
+			wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>(y * (w + 1) + x + 1)]) << 8;
+			wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>((y + 1) * (w + 1) + x + 1)]) << 24;
+			wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>((y + 1) * (w + 1) + x)]) << 40;
+			wangId |= static_cast<uint64_t>(m_corners[static_cast<size_t>(y * (w + 1) + x)]) << 56;
+		}
+		return wangId;
+	}
 
-/*!
- * 'id': Local ID of the tile
- * @return
- */
-uint32_t tson::Tile::getId() const
-{
-	return m_id;
-}
+	/*!
+	 * The gids of all cells (row-major), with flip flags
+	 */
+	const std::vector<uint32_t> &WangAutotiler::getGids() const
+	{
+		return m_gids;
+	}
+
+	/*!
+	 * Size of the grid in tiles
+	 */
+	const tson::Vector2i &WangAutotiler::getSize() const
+	{
+		return m_size;
+	}
+
+	/*!
+	 * The cells whose gid changed since the last call to clearChangedCells(), each listed once.
+	 */
+	const std::vector<tson::Vector2i> &WangAutotiler::getChangedCells() const
+	{
+		return m_changedCells;
+	}
+
+	void WangAutotiler::clearChangedCells()
+	{
+		for(const auto &cell : m_changedCells)
+			m_changed[static_cast<size_t>(cell.y * m_size.x + cell.x)] = 0;
+		m_changedCells.clear();
+	}
 
-/*!
- * 'image': Image representing this tile (optional)
- * @return
- */
+	bool WangAutotiler::contains(int x, int y) const
+	{
+		return x >= 0 && y >= 0 && x < m_size.x && y < m_size.y;
+	}
 
-const fs::path &tson::Tile::getImage() const { return m_image; }
+	/*!
+	 * Picks the tile for the colors around a cell
+	 */
+	void WangAutotiler::resolve(int x, int y)
+	{
+		if(!contains(x, y) || m_lookup == nullptr)
+			return;
 
-/*!
- * x = 'imagewidth' and y = 'imageheight': in pixels
- * @return
- */
-const tson::Vector2i &tson::Tile::getImageSize() const
-{
-	return m_imageSize;
-}
+		uint64_t const wangId = getWangId(x, y);
+		uint32_t gid = 0;
+		if(wangId != 0)
+		{
+			tson::WangCandidates const candidates = m_lookup->find(wangId);
+			if(!candidates.empty())
+			{
+				//A hash of the position gives variation between cells, while staying the same for each cell
+				uint32_t const hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+				gid = candidates.gids[hash % candidates.count];
+			}
+			else
+				gid = findBestMatch(wangId);
+		}
 
-/*!
- * 'type': The type of the tile (optional)
- * This was renamed to 'class' in Tiled v1.9
- * @return
- */
-const std::string &tson::Tile::getType() const
-{
-	return m_type;
-}
+		size_t const index = static_cast<size_t>(y * m_size.x + x);
+		if(m_gids[index] == gid)
+			return;
 
-/*!
-  * 'class': String assigned to class field in editor (optional)
- * This was renamed from 'type' to 'class' in Tiled v1.9
- * @return
- */
-const std::string &tson::Tile::getClassType() const
-{
-	return m_type;
-}
+		m_gids[index] = gid;
+		if(m_changed[index] == 0)
+		{
+			m_changed[index] = 1;
+			m_changedCells.emplace_back(x, y);
+		}
+	}
 
-/*!
- * 'animation': Array of Frames
- * @return
- */
-tson::Animation &tson::Tile::getAnimation()
-{
-	return m_animation;
-}
+	/*!
+	 * The first tile with the most colors in common with the wang id. Searches all wang ids once, and remembers the result.
+	 */
+	uint32_t WangAutotiler::findBestMatch(uint64_t wangId)
+	{
+		auto it = m_bestMatches.find(wangId);
+		if(it != m_bestMatches.end())
+			return it->second;
 
-/*!
- * 'objectgroup': Layer with type objectgroup (optional)
- * @return
- */
-tson::Layer &tson::Tile::getObjectgroup()
-{
-	return m_objectgroup;
-}
+		uint32_t gid = 0;
+		int bestScore = 0;
+		for(uint64_t other : m_lookup->getWangIds())
+		{
+			int score = 0;
+			for(int i = 0; i < 8; ++i)
+			{
+				uint8_t const color = tson::WangLookup::GetColor(wangId, i);
+				if(color != 0 && color == tson::WangLookup::GetColor(other, i))
+					++score;
+			}
 
-/*!
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::Tile::getProperties()
-{
-	return m_properties;
-}
+			tson::WangCandidates const candidates = m_lookup->find(other);
+			if(score > bestScore && !candidates.empty())
+			{
+				bestScore = score;
+				gid = candidates.gids[0];
+			}
+		}
 
-/*!
- * 'terrain': Index of terrain for each corner of tile
- * @return
- */
-const std::vector<int> &tson::Tile::getTerrain() const
-{
-	return m_terrain;
+		m_bestMatches[wangId] = gid;
+		return gid;
+	}
 }
 
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::Tile::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
+#endif //TILESON_WANGAUTOTILER_HPP
 
-	return nullptr;
-}
+/*** End of inlined file: WangAutotiler.hpp ***/
 
-/*!
- * Used for getting the tson::Tileset who is the parent of this Tile.
- * @return a pointer to the tson::Tileset where this tile is contained.
- */
-tson::Tileset *tson::Tile::getTileset() const
-{
-	return m_tileset;
-}
 
-/*!
- * Used for getting the tson::Map who is the parent of this Tile.
- * @return a pointer to the tson::Map where this tile is contained.
- */
-tson::Map *tson::Tile::getMap() const
-{
-	return m_map;
-}
+/*** Start of inlined file: WorldStreamer.hpp ***/
+#ifndef TILESON_WORLDSTREAMER_HPP
+#define TILESON_WORLDSTREAMER_HPP
 
-/*!
- * Get the information needed to draw the Tile based on its current tileset
- * @return a tson::Rect containing the information needed to draw the tile.
- */
-const tson::Rect &tson::Tile::getDrawingRect() const
-{
-	return m_drawingRect;
-}
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <condition_variable>
 
-/*!
- * Helper function.
- *
- * Get the position of the tile in tile units.
- * The size of each unit is determined by the tile size property of the map.
- * Example: If the tile size is 16x16 in the map, a tile unit of [2, 4] would be [32, 64] in pixels.
- * If you want the position in pixels: use getPosition() instead.
- *
- * @return Position of tile in tile units.
- */
-const tson::Vector2i tson::Tile::getPositionInTileUnits(const std::tuple<int, int> &tileDataPos)
+namespace tson
 {
-	return {std::get<0>(tileDataPos), std::get<1>(tileDataPos)};
-}
+	/*!
+	 * Keeps the maps of a tson::World near a focus point loaded, for worlds with far more maps than fit in memory.
+	 *
+	 * Maps whose rectangle (position and size from tson::WorldMapData) is within the focus radius are parsed on background threads,
+	 * nearest first. The memory of the loaded maps is kept within a byte budget: Maps outside the focus stay loaded as a cache,
+	 * and the least recently used of them are evicted first when room is needed. Maps inside the focus are only loaded when they fit.
+	 *
+	 * Everything except the background parsing happens in update(), which is meant to be called once per frame from the game thread.
+	 * Finished maps are published there as a whole, so the game thread never sees a map that is still being parsed.
+	 * Pointers from getMap() stay valid until the next call to update().
+	 *
+	 * Example:
+	 * tson::World world {"worlds/overworld.world"};
+	 * tson::WorldStreamer streamer {world, 2};
+	 * streamer.setByteBudget(256 * 1024 * 1024);
+	 * //Every frame:
+	 * streamer.setFocus(player.position, 2000.f);
+	 * streamer.update();
+	 * for(size_t i : streamer.getLoadedMaps())
+	 *     draw(*streamer.getMap(i), streamer.getMapData()[i].position);
+	 */
+	class WorldStreamer
+	{
+		public:
+			/*! Creates the parser of a background thread. Each thread gets its own. */
+			using ParserFactory = std::function<std::unique_ptr<tson::Tileson>()>;
 
-void tson::Tile::manageFlipFlagsByIdThenRemoveFlags(uint32_t &id)
-{
-	if (id & FLIPPED_HORIZONTALLY_FLAG) m_flipFlags |= TileFlipFlags::Horizontally;
-	if (id & FLIPPED_VERTICALLY_FLAG) m_flipFlags |= TileFlipFlags::Vertically;
-	if (id & FLIPPED_DIAGONALLY_FLAG) m_flipFlags |= TileFlipFlags::Diagonally;
+			#ifdef JSON11_IS_DEFINED
+			inline explicit WorldStreamer(const tson::World &world, size_t threadCount = 1); //tileson_forward.hpp
+			#endif
+			inline WorldStreamer(const tson::World &world, ParserFactory parserFactory, size_t threadCount = 1);
+			inline ~WorldStreamer();
 
-	id &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
-}
+			WorldStreamer(const WorldStreamer &) = delete;
+			WorldStreamer &operator=(const WorldStreamer &) = delete;
 
-tson::TileFlipFlags tson::Tile::getFlipFlags() const
-{
-	return m_flipFlags;
-}
+			inline void setByteBudget(size_t bytes);
+			inline void setFocus(const tson::Vector2f &center, float radius);
+			inline size_t update();
+			inline void flush();
 
-/*!
- *
- * @param flags Which flags to check for. Several flags can be checked at once using the bitwise or operator.
- * Example:
- * hasFlipFlags(TileFlipFlags::Vertically | TileFlipFlags::Horizontally)
- *
- * @return true if the flag(s) specified are set
- */
-bool tson::Tile::hasFlipFlags(tson::TileFlipFlags flags)
-{
-	return ((m_flipFlags & flags) == flags) ? true : false;
-}
+			[[nodiscard]] inline tson::Map *getMap(size_t index);
+			[[nodiscard]] inline bool isLoaded(size_t index) const;
+			[[nodiscard]] inline bool isPending(size_t index) const;
+			[[nodiscard]] inline const std::vector<size_t> &getLoadedMaps() const;
+			[[nodiscard]] inline const std::vector<tson::WorldMapData> &getMapData() const;
+			[[nodiscard]] inline size_t getByteBudget() const;
+			[[nodiscard]] inline size_t getUsedBytes() const;
 
-uint32_t tson::Tile::getGid() const
-{
-	return m_gid;
-}
+			inline static size_t EstimateBytes(tson::Map &map);
 
-void tson::Tile::setProperties(const tson::PropertyCollection &properties)
-{
-	m_properties = properties;
-}
+		private:
+			enum class SlotState : uint8_t
+			{
+				Unloaded = 0,
+				Pending = 1,    //Queued or being parsed
+				Loaded = 2,
+				Failed = 3      //The file does not exist, could not be parsed, or parsing threw
+			};
 
-/*!
- * Tiled 1.9: Contains the newly added sub-rectangle variables: 'x', 'y', 'width' and 'height'
- * @return A tson::Rect with the 'x', 'y', 'width' and 'height' values
- */
-const tson::Rect &tson::Tile::getSubRectangle() const
-{
-	return m_subRect;
-}
+			class Slot
+			{
+				public:
+					SlotState                   state {SlotState::Unloaded};
+					std::unique_ptr<tson::Map>  map;
+					size_t                      bytes {};           /*! Memory of the loaded map */
+					size_t                      estimate {};        /*! Expected memory before loading. 0 = unknown */
+					uint64_t                    lastUsed {};        /*! Last update in which the map was inside the focus */
+			};
 
-#endif //TILESON_TILE_HPP
+			/*! Counts a job as finished when it goes out of scope, even when parsing throws */
+			class ActiveJob
+			{
+				public:
+					inline explicit ActiveJob(WorldStreamer &streamer) : m_streamer {streamer} {}
+					inline ~ActiveJob();
 
-/*** End of inlined file: Tile.hpp ***/
+					ActiveJob(const ActiveJob &) = delete;
+					ActiveJob &operator=(const ActiveJob &) = delete;
 
+				private:
+					WorldStreamer &m_streamer;
+			};
 
-/*** Start of inlined file: Terrain.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+			inline void start(size_t threadCount);
+			inline void workerLoop(); //tileson_forward.hpp
+			inline size_t publishFinished();
+			inline void scheduleLoads(const std::vector<size_t> &wanted);
+			inline bool evictLeastRecentlyUsed();
+			inline void evict(size_t index);
+			[[nodiscard]] inline float getDistance(size_t index) const;
+			inline static void EstimateLayerBytes(std::vector<tson::Layer> &layers, size_t &bytes);
+
+			std::vector<tson::WorldMapData>     m_mapData;
+			std::vector<Slot>                   m_slots;
+			std::vector<size_t>                 m_loadedMaps;
+			ParserFactory                       m_parserFactory;
+
+			size_t                              m_byteBudget {std::numeric_limits<size_t>::max()};
+			size_t                              m_usedBytes {};         /*! Memory of the loaded maps */
+			size_t                              m_reservedBytes {};     /*! Expected memory of the pending maps */
+			tson::Vector2f                      m_focusCenter;
+			float                               m_focusRadius {};
+			uint64_t                            m_tick {};
+
+			//Shared with the background threads. Guarded by m_mutex.
+			std::mutex                          m_mutex;
+			std::condition_variable             m_workAvailable;
+			std::condition_variable             m_workDone;
+			std::vector<size_t>                 m_queue;                /*! Maps to parse, nearest last */
+			std::vector<std::pair<size_t, std::unique_ptr<tson::Map>>> m_finished;
+			size_t                              m_activeJobs {};
+			bool                                m_stop {false};
+			std::vector<std::thread>            m_threads;
+	};
 
-#ifndef TILESON_TERRAIN_HPP
-#define TILESON_TERRAIN_HPP
+	/*!
+	 * @param world The world. Its map data is copied, so the world does not have to outlive the streamer.
+	 * @param parserFactory Creates a tson::Tileson for each background thread
+	 * @param threadCount Number of background threads. 0 uses the number of hardware threads.
+	 */
+	WorldStreamer::WorldStreamer(const tson::World &world, ParserFactory parserFactory, size_t threadCount)
+		: m_mapData {world.getMapData()}, m_slots(world.getMapData().size()), m_parserFactory {std::move(parserFactory)}
+	{
+		start(threadCount);
+	}
 
-//#include "../external/json.hpp"
+	/*!
+	 * Stops the background threads. Maps that are being parsed are finished first.
+	 */
+	WorldStreamer::~WorldStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_workAvailable.notify_all();
+		for(auto &thread : m_threads)
+			thread.join();
+	}
 
-namespace tson
-{
-	class Terrain
+	/*!
+	 * Maximum memory of all loaded maps, as estimated by EstimateBytes(). Default: No limit
+	 */
+	void WorldStreamer::setByteBudget(size_t bytes)
 	{
-		public:
-			inline Terrain() = default;
-			inline Terrain(std::string name, int tile);
-			inline explicit Terrain(IJson &json);
+		m_byteBudget = bytes;
+	}
 
-			inline bool parse(IJson &json);
+	/*!
+	 * Maps within the radius of the center are loaded by the next update().
+	 * @param center Center in pixels, in the coordinates of the world
+	 * @param radius Radius in pixels
+	 */
+	void WorldStreamer::setFocus(const tson::Vector2f &center, float radius)
+	{
+		m_focusCenter = center;
+		m_focusRadius = radius;
+	}
 
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline int getTile() const;
-			[[nodiscard]] inline PropertyCollection &getProperties();
+	/*!
+	 * Publishes the maps that finished loading, and decides which maps to load and evict for the current focus.
+	 * @return Number of maps that were published
+	 */
+	size_t WorldStreamer::update()
+	{
+		++m_tick;
+		size_t const published = publishFinished();
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+		std::vector<size_t> wanted;
+		for(size_t i = 0; i < m_slots.size(); ++i)
+		{
+			if(getDistance(i) <= m_focusRadius)
+			{
+				wanted.push_back(i);
+				m_slots[i].lastUsed = m_tick;
+			}
+		}
+		std::sort(wanted.begin(), wanted.end(), [&](size_t a, size_t b) { return getDistance(a) < getDistance(b); });
 
-		private:
-			std::string                 m_name;        /*! 'name': Name of terrain */
-			int                         m_tile {};     /*! 'tile': Local ID of tile representing terrain */
-			tson::PropertyCollection    m_properties;  /*! 'properties': A list of properties (name, value, type). */
-	};
+		scheduleLoads(wanted);
+		while(m_usedBytes + m_reservedBytes > m_byteBudget && evictLeastRecentlyUsed()) {}
+
+		return published;
+	}
+
+	/*!
+	 * Blocks until every map inside the focus that fits in the budget is loaded and published. Useful for loading screens.
+	 */
+	void WorldStreamer::flush()
+	{
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workDone.wait(lock, [&]() { return m_queue.empty() && m_activeJobs == 0; });
+			}
+			update();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(m_queue.empty() && m_activeJobs == 0 && m_finished.empty())
+				return;
+		}
+	}
 
 	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 * Gets a loaded map.
+	 * @param index Index of the map in getMapData()
+	 * @return The map, or nullptr if it is not loaded. Valid until the next update().
 	 */
-	template<typename T>
-	T tson::Terrain::get(const std::string &name)
+	tson::Map *WorldStreamer::getMap(size_t index)
 	{
-		return m_properties.getValue<T>(name);
+		return (index < m_slots.size() && m_slots[index].state == SlotState::Loaded) ? m_slots[index].map.get() : nullptr;
 	}
-}
 
-tson::Terrain::Terrain(std::string name, int tile) : m_name {std::move(name)}, m_tile {tile}
-{
-
-}
+	bool WorldStreamer::isLoaded(size_t index) const
+	{
+		return index < m_slots.size() && m_slots[index].state == SlotState::Loaded;
+	}
 
-tson::Terrain::Terrain(IJson &json)
-{
-	parse(json);
-}
+	/*!
+	 * true if the map is waiting to be parsed, or is being parsed
+	 */
+	bool WorldStreamer::isPending(size_t index) const
+	{
+		return index < m_slots.size() && m_slots[index].state == SlotState::Pending;
+	}
 
-bool tson::Terrain::parse(IJson &json)
-{
-	bool allFound = true;
+	/*!
+	 * Indices (in getMapData()) of all loaded maps
+	 */
+	const std::vector<size_t> &WorldStreamer::getLoadedMaps() const
+	{
+		return m_loadedMaps;
+	}
 
-	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
-	if(json.count("tile") > 0) m_tile = json["tile"].get<int>(); else allFound = false;
+	/*!
+	 * The map data of the world, in the same order as in tson::World
+	 */
+	const std::vector<tson::WorldMapData> &WorldStreamer::getMapData() const
+	{
+		return m_mapData;
+	}
 
-	if(json.count("properties") > 0 && json["properties"].isArray())
+	size_t WorldStreamer::getByteBudget() const
 	{
-		auto &properties = json.array("properties");
-		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item); });
+		return m_byteBudget;
 	}
 
-	return allFound;
-}
+	/*!
+	 * Estimated memory of all loaded maps
+	 */
+	size_t WorldStreamer::getUsedBytes() const
+	{
+		return m_usedBytes;
+	}
 
-/*!
- * 'name': Name of terrain
- * @return
- */
-const std::string &tson::Terrain::getName() const
-{
-	return m_name;
-}
+	/*!
+	 * Estimates the memory used by a parsed map: The map, its tilesets and tiles, and the tiles and objects of all layers.
+	 * Strings and properties are not included.
+	 */
+	size_t WorldStreamer::EstimateBytes(tson::Map &map)
+	{
+		size_t bytes = sizeof(tson::Map) + map.getTileDrawTable().size() * sizeof(tson::TileDrawInfo) +
+					   map.getTileMap().size() * (sizeof(std::pair<uint32_t, tson::Tile *>) + 2 * sizeof(void *));
+		for(auto &tileset : map.getTilesets())
+			bytes += sizeof(tson::Tileset) + tileset.getTiles().size() * sizeof(tson::Tile);
 
-/*!
- * 'tile': Local ID of tile representing terrain
- * @return
- */
-int tson::Terrain::getTile() const
-{
-	return m_tile;
-}
+		EstimateLayerBytes(map.getLayers(), bytes);
+		return bytes;
+	}
 
-/*!
- * 'properties': A list of properties (name, value, type). *Missing from the official Tiled documentation...*
- * @return
- */
-tson::PropertyCollection &tson::Terrain::getProperties()
-{
-	return m_properties;
-}
+	void WorldStreamer::EstimateLayerBytes(std::vector<tson::Layer> &layers, size_t &bytes)
+	{
+		//Nodes of std::map have three pointers and a color besides the value
+		size_t const nodeBytes = 4 * sizeof(void *);
+		for(auto &layer : layers)
+		{
+			bytes += sizeof(tson::Layer) + layer.getData().size() * sizeof(uint32_t) + layer.getObjects().size() * sizeof(tson::Object);
+			bytes += layer.getTileData().size() * (sizeof(std::pair<std::tuple<int, int>, tson::Tile *>) + nodeBytes);
+			bytes += layer.getTileObjects().size() * (sizeof(std::pair<std::tuple<int, int>, tson::TileObject>) + nodeBytes);
+			for(auto &chunk : layer.getChunks())
+				bytes += sizeof(tson::Chunk) + chunk.getData().size() * sizeof(int);
 
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::Terrain::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
-	return nullptr;
-}
+			EstimateLayerBytes(layer.getLayers(), bytes);
+		}
+	}
 
-#endif //TILESON_TERRAIN_HPP
+	void WorldStreamer::start(size_t threadCount)
+	{
+		if(threadCount == 0)
+			threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
 
-/*** End of inlined file: Terrain.hpp ***/
+		for(size_t i = 0; i < threadCount; ++i)
+			m_threads.emplace_back([this]() { workerLoop(); });
+	}
 
+	WorldStreamer::ActiveJob::~ActiveJob()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_streamer.m_mutex);
+			--m_streamer.m_activeJobs;
+		}
+		m_streamer.m_workDone.notify_all();
+	}
 
-/*** Start of inlined file: Grid.hpp ***/
-//
-// Created by robin on 22.03.2020.
-//
+	/*!
+	 * Moves the maps parsed by the background threads into their slots
+	 * @return Number of maps that were loaded
+	 */
+	size_t WorldStreamer::publishFinished()
+	{
+		std::vector<std::pair<size_t, std::unique_ptr<tson::Map>>> finished;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			finished.swap(m_finished);
+		}
 
-#ifndef TILESON_GRID_HPP
-#define TILESON_GRID_HPP
+		size_t published = 0;
+		for(auto &[index, map] : finished)
+		{
+			Slot &slot = m_slots[index];
+			m_reservedBytes -= std::min(m_reservedBytes, slot.estimate);
+			if(map == nullptr || map->getStatus() != tson::ParseStatus::OK)
+			{
+				slot.state = SlotState::Failed;
+				continue;
+			}
 
-#include <string>
-//#include "../external/json.hpp"
+			slot.bytes = EstimateBytes(*map);
+			slot.estimate = slot.bytes;
+			slot.map = std::move(map);
+			slot.state = SlotState::Loaded;
+			m_usedBytes += slot.bytes;
+			m_loadedMaps.push_back(index);
+			++published;
+		}
+		return published;
+	}
 
-namespace tson
-{
-	class Grid
+	/*!
+	 * Replaces the queue with the wanted maps that are not loaded yet, as long as they fit in the budget.
+	 * @param wanted Maps inside the focus, nearest first
+	 */
+	void WorldStreamer::scheduleLoads(const std::vector<size_t> &wanted)
 	{
-		public:
-			inline Grid() = default;
-			inline explicit Grid(IJson &json);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			//Queued maps that have not been picked up yet are cancelled. The others are being parsed, and stay pending.
+			for(size_t index : m_queue)
+			{
+				m_slots[index].state = SlotState::Unloaded;
+				m_reservedBytes -= std::min(m_reservedBytes, m_slots[index].estimate);
+			}
+			m_queue.clear();
 
-			inline bool parse(IJson &json);
+			for(size_t index : wanted)
+			{
+				Slot &slot = m_slots[index];
+				if(slot.state != SlotState::Unloaded)
+					continue;
 
-			[[nodiscard]] inline const std::string &getOrientation() const;
-			[[nodiscard]] inline const Vector2i &getSize() const;
+				//Before the first load, the size of the file is the best guess
+				if(slot.estimate == 0)
+				{
+					std::error_code error;
+					auto const fileSize = fs::file_size(m_mapData[index].path, error);
+					slot.estimate = (error) ? 0 : static_cast<size_t>(fileSize);
+				}
 
-		private:
-			std::string m_orientation; /*! 'orientation': Orientation of the grid for the tiles in this tileset (orthogonal or isometric) */
-			tson::Vector2i m_size; /*! 'width' and 'height': Size. */
-	};
-}
+				while(m_usedBytes + m_reservedBytes + slot.estimate > m_byteBudget && evictLeastRecentlyUsed()) {}
+				if(m_usedBytes + m_reservedBytes + slot.estimate > m_byteBudget)
+					break;
 
-/*!
- * Parses Tiled grid data from json
- * @param json
- */
-tson::Grid::Grid(IJson &json)
-{
-	parse(json);
-}
+				slot.state = SlotState::Pending;
+				m_reservedBytes += slot.estimate;
+				m_queue.push_back(index);
+			}
+			//Workers take from the back
+			std::reverse(m_queue.begin(), m_queue.end());
+		}
+		m_workAvailable.notify_all();
+	}
 
-/*!
- * Parses Tiled grid data from json
- * @param json
- * @return true if all mandatory fields was found. false otherwise.
- */
-bool tson::Grid::parse(IJson &json)
-{
-	bool allFound = true;
+	/*!
+	 * Evicts the loaded map outside the focus that was inside it the longest time ago.
+	 * @return false if every loaded map is inside the focus
+	 */
+	bool WorldStreamer::evictLeastRecentlyUsed()
+	{
+		size_t best = m_slots.size();
+		for(size_t index : m_loadedMaps)
+		{
+			if(m_slots[index].lastUsed < m_tick && (best == m_slots.size() || m_slots[index].lastUsed < m_slots[best].lastUsed))
+				best = index;
+		}
 
-	if(json.count("orientation") > 0) m_orientation = json["orientation"].get<std::string>(); //Optional
+		if(best == m_slots.size())
+			return false;
 
-	if(json.count("width") > 0 && json.count("height") > 0)
-		m_size = {json["width"].get<int>(), json["height"].get<int>()}; else allFound = false;
+		evict(best);
+		return true;
+	}
 
-	return allFound;
-}
+	void WorldStreamer::evict(size_t index)
+	{
+		Slot &slot = m_slots[index];
+		slot.map.reset();
+		slot.state = SlotState::Unloaded;
+		m_usedBytes -= std::min(m_usedBytes, slot.bytes);
+		slot.bytes = 0;
+		m_loadedMaps.erase(std::find(m_loadedMaps.begin(), m_loadedMaps.end(), index));
+	}
 
-/*!
- * 'orientation': Orientation of the grid for the tiles in this tileset (orthogonal or isometric)
- * @return orientation as string
- */
-const std::string &tson::Grid::getOrientation() const
-{
-	return m_orientation;
+	/*!
+	 * Distance from the focus center to the rectangle of a map. 0 when the center is inside the map.
+	 */
+	float WorldStreamer::getDistance(size_t index) const
+	{
+		const tson::WorldMapData &data = m_mapData[index];
+		float const left = static_cast<float>(data.position.x);
+		float const top = static_cast<float>(data.position.y);
+		float const dx = std::max({left - m_focusCenter.x, 0.f, m_focusCenter.x - (left + static_cast<float>(data.size.x))});
+		float const dy = std::max({top - m_focusCenter.y, 0.f, m_focusCenter.y - (top + static_cast<float>(data.size.y))});
+		return std::sqrt(dx * dx + dy * dy);
+	}
 }
 
-/*!
- * 'width' and 'height': Size.
- * @return size as int
- */
-const tson::Vector2i &tson::Grid::getSize() const
-{
-	return m_size;
-}
+#endif //TILESON_WORLDSTREAMER_HPP
 
-#endif //TILESON_GRID_HPP
+/*** End of inlined file: WorldStreamer.hpp ***/
 
-/*** End of inlined file: Grid.hpp ***/
 
-#include <functional>
+/*** Start of inlined file: MapSnapshot.hpp ***/
+#ifndef TILESON_MAPSNAPSHOT_HPP
+#define TILESON_MAPSNAPSHOT_HPP
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <system_error>
 
 namespace tson
 {
-	class Map;
-	class Project;
-	class Tileset
+	/*!
+	 * Saves a parsed tson::Map to a versioned binary snapshot (.tsonb), and loads it again without any json backend.
+	 *
+	 * A snapshot has everything a parsed map has: Layers with their gids already decoded, tilesets (external tilesets included),
+	 * tiles, objects (template instances included), and properties. Enum values and classes are stored with the name of their type,
+	 * and are resolved against the tson::Project given when loading, like when parsing. Everything derived from the parsed data,
+	 * like the tile map and the tile draw table, is created again when loading.
+	 *
+	 * The header stores a hash of the source json, and the tileset and template files the map depends on, so a snapshot can be checked
+	 * against its sources before it is used. tson::Tileson does that when a snapshot mode is set.
+	 *
+	 * All numbers are stored as little endian.
+	 */
+	class MapSnapshot
 	{
 		public:
-			inline Tileset() = default;
-			inline explicit Tileset(IJson &json, tson::Map *map);
-			inline bool parse(IJson &json, tson::Map *map);
+			static constexpr uint32_t Version = 2;
+			static constexpr char Magic[6] {'T', 'S', 'O', 'N', 'B', '\0'};
 
-			[[nodiscard]] inline int getColumns() const;
-			[[nodiscard]] inline int getFirstgid() const;
+			/*!
+			 * The beginning of a snapshot
+			 */
+			class Header
+			{
+				public:
+					uint32_t                    version {};
+					uint64_t                    sourceHash {};      /*! Hash() of the source json */
+					std::vector<fs::path>       dependencies;       /*! External tilesets and templates */
+			};
 
-			[[nodiscard]] inline const fs::path &getImagePath() const;
-			[[nodiscard]] inline const fs::path &getFullImagePath() const;
-			[[nodiscard]] inline const fs::path &getImage() const;
-			[[nodiscard]] inline const Vector2i &getImageSize() const;
-			[[nodiscard]] inline int getMargin() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline int getSpacing() const;
-			[[nodiscard]] inline int getTileCount() const;
-			[[nodiscard]] inline const Vector2i &getTileSize() const;
-			[[nodiscard]] inline const Colori &getTransparentColor() const;
-			[[nodiscard]] inline const std::string& getTypeStr() const;
-			[[nodiscard]] inline TilesetType getType() const;
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
-			[[nodiscard]] inline std::vector<tson::Tile> &getTiles();
-			[[nodiscard]] inline const std::vector<tson::WangSet> &getWangsets() const;
-			[[nodiscard]] inline PropertyCollection &getProperties();
-			[[nodiscard]] inline const std::vector<tson::Terrain> &getTerrains() const;
-			[[nodiscard]] inline const Vector2i &getTileOffset() const;
-			[[nodiscard]] inline const Grid &getGrid() const;
-			[[nodiscard]] inline TileRenderSize getTileRenderSize() const;
-			[[nodiscard]] inline FillMode getFillMode() const;
+			inline static std::vector<uint8_t> Serialize(tson::Map &map, uint64_t sourceHash = 0, const fs::path &directory = {});
+			inline static std::unique_ptr<tson::Map> Deserialize(const void *data, size_t size, tson::Project *project = nullptr,
+																 tson::DecompressorContainer *decompressors = nullptr);
+			inline static bool ReadHeader(const void *data, size_t size, Header &header);
+
+			inline static bool Save(tson::Map &map, const fs::path &path, uint64_t sourceHash = 0, const fs::path &directory = {});
+			inline static std::unique_ptr<tson::Map> Load(const fs::path &path, tson::Project *project = nullptr,
+														  tson::DecompressorContainer *decompressors = nullptr);
+			inline static std::unique_ptr<tson::Map> LoadIfCurrent(const fs::path &path, uint64_t sourceHash, const fs::file_time_type &sourceModified,
+																   tson::Project *project = nullptr, tson::DecompressorContainer *decompressors = nullptr);
+
+			inline static fs::path GetPath(const fs::path &sourcePath);
+			inline static uint64_t Hash(const void *data, size_t size);
+			inline static bool ReadFile(const fs::path &path, std::vector<uint8_t> &data);
+
+		private:
+			class Writer
+			{
+				public:
+					inline void u8(uint8_t value) { data.push_back(value); }
+					inline void boolean(bool value) { u8(value ? 1 : 0); }
+					inline void u32(uint32_t value) { for(int i = 0; i < 4; ++i) u8(static_cast<uint8_t>(value >> (8 * i))); }
+					inline void i32(int32_t value) { u32(static_cast<uint32_t>(value)); }
+					inline void u64(uint64_t value) { for(int i = 0; i < 8; ++i) u8(static_cast<uint8_t>(value >> (8 * i))); }
+					inline void f32(float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); u32(bits); }
+					inline void size(size_t value) { u32(static_cast<uint32_t>(value)); }
+					inline void string(const std::string &value) { size(value.size()); data.insert(data.end(), value.begin(), value.end()); }
+					inline void path(const fs::path &value) { string(value.generic_string()); }
+					inline void vector2i(const tson::Vector2i &value) { i32(value.x); i32(value.y); }
+					inline void vector2f(const tson::Vector2f &value) { f32(value.x); f32(value.y); }
+					inline void color(const tson::Colori &value) { u8(value.r); u8(value.g); u8(value.b); u8(value.a); }
+					inline void rect(const tson::Rect &value) { i32(value.x); i32(value.y); i32(value.width); i32(value.height); }
+
+					std::vector<uint8_t> data;
+			};
+
+			class Reader
+			{
+				public:
+					inline Reader(const uint8_t *data, size_t size) : m_data {data}, m_size {size} {}
+
+					inline uint8_t u8() { return (has(1)) ? m_data[m_pos++] : 0; }
+					inline bool boolean() { return u8() != 0; }
+					inline uint32_t u32();
+					inline int32_t i32() { return static_cast<int32_t>(u32()); }
+					inline uint64_t u64();
+					inline float f32() { uint32_t bits = u32(); float value; std::memcpy(&value, &bits, sizeof(value)); return value; }
+					inline size_t size(size_t minElementSize);
+					inline std::string string();
+					inline fs::path path() { return fs::path(string()); }
+					inline tson::Vector2i vector2i() { int32_t x = i32(); return {x, i32()}; }
+					inline tson::Vector2f vector2f() { float x = f32(); return {x, f32()}; }
+					inline tson::Colori color() { uint8_t r = u8(); uint8_t g = u8(); uint8_t b = u8(); return {r, g, b, u8()}; }
+					inline tson::Rect rect() { int32_t x = i32(); int32_t y = i32(); int32_t w = i32(); return {x, y, w, i32()}; }
+
+					[[nodiscard]] inline bool ok() const { return m_ok; }
+
+				private:
+					inline bool has(size_t bytes);
+
+					const uint8_t *m_data;
+					size_t m_size;
+					size_t m_pos {0};
+					bool m_ok {true};
+			};
+
+			/*! The C++ type of a property value */
+			enum class ValueKind : uint8_t
+			{
+				None = 0,
+				Int = 1,
+				UInt = 2,
+				Bool = 3,
+				Float = 4,
+				String = 5,
+				Path = 6,
+				Color = 7,
+				Enum = 8,
+				Class = 9
+			};
+
+			inline static void WriteHeader(Writer &out, tson::Map &map, uint64_t sourceHash, const fs::path &directory);
+			inline static bool ReadHeader(Reader &in, Header &header);
+			inline static void CollectDependencies(tson::Map &map, const fs::path &directory, std::vector<fs::path> &dependencies);
+			inline static void CollectTemplates(std::vector<tson::Layer> &layers, std::vector<std::string> &templates);
+
+			inline static void WriteMap(Writer &out, tson::Map &map);
+			inline static void WriteLayer(Writer &out, tson::Layer &layer);
+			inline static void WriteObject(Writer &out, tson::Object &object);
+			inline static void WriteTileset(Writer &out, tson::Tileset &tileset);
+			inline static void WriteTile(Writer &out, tson::Tile &tile);
+			inline static void WriteWangSet(Writer &out, const tson::WangSet &wangset);
+			inline static void WriteWangColor(Writer &out, const tson::WangColor &color);
+			inline static void WriteProperties(Writer &out, const tson::PropertyCollection &properties);
+			inline static void WriteValue(Writer &out, const std::any &value);
+
+			inline static void ReadMap(Reader &in, tson::Map &map);
+			inline static void ReadLayer(Reader &in, tson::Layer &layer, tson::Map *map);
+			inline static void ReadObject(Reader &in, tson::Object &object, tson::Map *map);
+			inline static void ReadTileset(Reader &in, tson::Tileset &tileset, tson::Map *map);
+			inline static void ReadTile(Reader &in, tson::Tile &tile, tson::Tileset *tileset, tson::Map *map);
+			inline static void ReadWangSet(Reader &in, tson::WangSet &wangset, tson::Map *map);
+			inline static void ReadWangColor(Reader &in, tson::WangColor &color, tson::Map *map);
+			inline static void ReadProperties(Reader &in, tson::PropertyCollection &properties, tson::Project *project);
+			inline static std::any ReadValue(Reader &in, tson::Project *project);
+	};
 
-			inline tson::Tile * getTile(uint32_t id);
-			inline tson::Terrain * getTerrain(const std::string &name);
+	uint32_t MapSnapshot::Reader::u32()
+	{
+		uint32_t value = 0;
+		for(int i = 0; i < 4; ++i)
+			value |= static_cast<uint32_t>(u8()) << (8 * i);
+		return value;
+	}
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+	uint64_t MapSnapshot::Reader::u64()
+	{
+		uint64_t value = 0;
+		for(int i = 0; i < 8; ++i)
+			value |= static_cast<uint64_t>(u8()) << (8 * i);
+		return value;
+	}
 
-			//v1.2.0-stuff
-			[[nodiscard]] inline tson::Map *getMap() const;
-			[[nodiscard]] inline ObjectAlignment getObjectAlignment() const;
+	/*!
+	 * Reads the number of elements of a list. Fails when the rest of the data is too small for that many elements.
+	 */
+	size_t MapSnapshot::Reader::size(size_t minElementSize)
+	{
+		size_t const count = u32();
+		if(!has(count * minElementSize))
+			return 0;
+		return count;
+	}
 
-			inline static tson::ObjectAlignment StringToAlignment(std::string_view str);
+	std::string MapSnapshot::Reader::string()
+	{
+		size_t const length = size(1);
+		std::string value(reinterpret_cast<const char *>(m_data + m_pos), length);
+		m_pos += length;
+		return value;
+	}
 
-			//v1.3.0
-			inline tson::Vector2i getMarginSpacingOffset(const tson::Vector2i &posInTileUnits);
-			inline tson::WangSet * getWangset(const std::string &name);
-			inline const Transformations &getTransformations() const;
+	bool MapSnapshot::Reader::has(size_t bytes)
+	{
+		if(!m_ok || bytes > m_size - m_pos)
+		{
+			m_ok = false;
+			return false;
+		}
+		return true;
+	}
 
-			#ifndef TSON_TEST_ENABLED
-		private:
-			#endif
+	/*!
+	 * Writes a parsed map to a snapshot.
+	 * @param map A map with tson::ParseStatus::OK
+	 * @param sourceHash Hash() of the json the map was parsed from
+	 * @param directory The directory of the map file. Templates are found relative to it.
+	 */
+	std::vector<uint8_t> MapSnapshot::Serialize(tson::Map &map, uint64_t sourceHash, const fs::path &directory)
+	{
+		//The snapshot holds every layer, so lazy layers must be read first
+		map.loadLayers();
 
-			[[nodiscard]] inline tson::Project *getProject() const;
+		Writer out;
+		WriteHeader(out, map, sourceHash, directory);
+		WriteMap(out, map);
+		return std::move(out.data);
+	}
 
-			inline void generateMissingTiles();
+	/*!
+	 * Creates a map from a snapshot
+	 * @param project The project to resolve classes and enums with. Should be the one the map was parsed with.
+	 * @param decompressors Given to the map, like when it is parsed
+	 * @return The map. Has tson::ParseStatus::ParseError if the snapshot is invalid or has another version.
+	 */
+	std::unique_ptr<tson::Map> MapSnapshot::Deserialize(const void *data, size_t size, tson::Project *project, tson::DecompressorContainer *decompressors)
+	{
+		Reader in {static_cast<const uint8_t *>(data), size};
+		Header header;
+		if(!ReadHeader(in, header))
+			return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Not a tileson snapshot, or a snapshot of another version");
+
+		std::unique_ptr<tson::Map> map = std::make_unique<tson::Map>();
+		map->m_decompressors = decompressors;
+		map->m_project = project;
+		ReadMap(in, *map);
+		if(!in.ok())
+			return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Snapshot is corrupt");
 
-			int                           m_columns {};       /*! 'columns': The number of tile columns in the tileset */
-			int                           m_firstgid {};      /*! 'firstgid': GID corresponding to the first tile in the set */
+		return map;
+	}
 
-			fs::path                      m_image;            /*! 'image': Image used for tiles in this set */
-			fs::path                      m_imagePath;        /*!  Image path relative to the tileset json of this tileset */
+	/*!
+	 * Reads only the header of a snapshot
+	 * @return false if the data is not a snapshot of this version
+	 */
+	bool MapSnapshot::ReadHeader(const void *data, size_t size, Header &header)
+	{
+		Reader in {static_cast<const uint8_t *>(data), size};
+		return ReadHeader(in, header);
+	}
 
-			tson::Vector2i                m_imageSize;        /*! x = 'imagewidth' and y = 'imageheight': in pixels */
-			int                           m_margin {};        /*! 'margin': Buffer between image edge and first tile (pixels)*/
-			std::string                   m_name;             /*! 'name': Name given to this tileset */
-			int                           m_spacing {};       /*! 'spacing': Spacing between adjacent tiles in image (pixels)*/
-			int                           m_tileCount {};     /*! 'tilecount': The number of tiles in this tileset */
-			tson::Vector2i                m_tileSize;         /*! x = 'tilewidth' and y = 'tileheight': Maximum size of tiles in this set */
-			tson::Colori                  m_transparentColor; /*! 'transparentcolor': Hex-formatted color (#RRGGBB) (optional) */
-			std::string                   m_typeStr;          /*! 'type': tileset (for tileset files, since 1.0) */
-			TilesetType                   m_type{ TilesetType::Undefined }; /*! Tileset type as enum */
+	/*!
+	 * Writes a snapshot of a map to a file
+	 * @return true if the file was written
+	 */
+	bool MapSnapshot::Save(tson::Map &map, const fs::path &path, uint64_t sourceHash, const fs::path &directory)
+	{
+		std::vector<uint8_t> data = Serialize(map, sourceHash, directory);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+		return file.good();
+	}
 
-			std::vector<tson::Tile>       m_tiles;            /*! 'tiles': Array of Tiles (optional) */
-			std::vector<tson::WangSet>    m_wangsets;         /*! 'wangsets':Array of Wang sets (since 1.1.5) */
-			tson::PropertyCollection      m_properties; 	  /*! 'properties': A list of properties (name, value, type). */
+	/*!
+	 * Loads a snapshot file without checking it against its sources
+	 */
+	std::unique_ptr<tson::Map> MapSnapshot::Load(const fs::path &path, tson::Project *project, tson::DecompressorContainer *decompressors)
+	{
+		std::vector<uint8_t> data;
+		if(!ReadFile(path, data))
+			return std::make_unique<tson::Map>(tson::ParseStatus::FileNotFound, "File not found: " + path.generic_string());
 
-			std::vector<tson::Terrain>    m_terrains;         /*! 'terrains': Array of Terrains (optional) */
-			tson::Vector2i                m_tileOffset;       /*! 'x' and 'y': See <tileoffset> (optional) */
-			tson::Grid                    m_grid;             /*! 'grid': This element is only used in case of isometric orientation, and determines
-																   how tile overlays for terrain and collision information are rendered. */
+		return Deserialize(data.data(), data.size(), project, decompressors);
+	}
 
-			//v1.2.0-stuff
-			tson::ObjectAlignment         m_objectAlignment{tson::ObjectAlignment::Unspecified};  /*! 'objectalignment': Alignment to use for tile objects. Tiled 1.4.*/
-			tson::Map *                   m_map;              /*! The map who owns this tileset */
+	/*!
+	 * Loads a snapshot file if it is still valid: It must be newer than its source and every file the map depends on,
+	 * and it must have been made from a json with the same hash.
+	 * @param path The snapshot
+	 * @param sourceHash Hash() of the current source json
+	 * @param sourceModified When the source json was last written to
+	 * @return The map. nullptr if the snapshot does not exist, or is out of date.
+	 */
+	std::unique_ptr<tson::Map> MapSnapshot::LoadIfCurrent(const fs::path &path, uint64_t sourceHash, const fs::file_time_type &sourceModified,
+														  tson::Project *project, tson::DecompressorContainer *decompressors)
+	{
+		std::error_code error;
+		fs::file_time_type const modified = fs::last_write_time(path, error);
+		if(error || modified < sourceModified)
+			return nullptr;
 
-			//v1.3.0-stuff
-			fs::path                      m_source {};           /*! 'source': exists only when tileset is contained in an external file*/
-			fs::path                      m_path {};             /*! Has the full path to the tileset if 'source' has an existing value */
-			Transformations               m_transformations {};  /*! New in Tiled v1.5 - This element is used to describe which transformations can be applied to
-																	 the tiles (e.g. to extend a Wang set by transforming existing tiles).*/
+		std::vector<uint8_t> data;
+		Header header;
+		if(!ReadFile(path, data) || !ReadHeader(data.data(), data.size(), header) || header.sourceHash != sourceHash)
+			return nullptr;
 
-			//v1.4.0-stuff
-			TileRenderSize                m_tileRenderSize {};   /*! 'tilerendersize': The size to use when rendering tiles from this tileset on a tile layer. Valid values are 'tile' (the default) and 'grid'.
- *                                                                    When set to 'grid', the tile is drawn at the tile grid size of the map. (since 1.9)*/
-			FillMode                      m_fillMode {};         /*! 'fillmode': The fill mode to use when rendering tiles from this tileset. Valid values are 'stretch' (the default) and 'preserve-aspect-fit'.
- *                                                                    Only relevant when the tiles are not rendered at their native size, so this applies to resized tile objects or in combination with 'tilerendersize' set to 'grid'. (since 1.9)*/
+		for(const fs::path &dependency : header.dependencies)
+		{
+			fs::file_time_type const dependencyModified = fs::last_write_time(dependency, error);
+			if(error || dependencyModified > modified)
+				return nullptr;
+		}
 
-			std::string                   m_classType {};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
-			std::shared_ptr<tson::TiledClass> m_class {};
-	};
+		std::unique_ptr<tson::Map> map = Deserialize(data.data(), data.size(), project, decompressors);
+		if(map->getStatus() != tson::ParseStatus::OK)
+			return nullptr;
+		return map;
+	}
 
 	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 * The snapshot path used by tson::Tileson for a map: The path of the map with the extension '.tsonb'
 	 */
-	template<typename T>
-	T tson::Tileset::get(const std::string &name)
+	fs::path MapSnapshot::GetPath(const fs::path &sourcePath)
 	{
-		return m_properties.getValue<T>(name);
+		fs::path path = sourcePath;
+		path.replace_extension(".tsonb");
+		return path;
 	}
-}
 
-tson::Tileset::Tileset(IJson &json, tson::Map *map)
-{
-	parse(json, map);
-}
+	/*!
+	 * 64-bit FNV-1a hash of the source json
+	 */
+	uint64_t MapSnapshot::Hash(const void *data, size_t size)
+	{
+		const auto *bytes = static_cast<const uint8_t *>(data);
+		uint64_t hash = 14695981039346656037ull;
+		for(size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
 
-bool tson::Tileset::parse(IJson &json, tson::Map *map)
-{
-	m_map = map;
-	bool allFound = true;
+	/*!
+	 * Reads a whole file
+	 * @return false if the file could not be read
+	 */
+	bool MapSnapshot::ReadFile(const fs::path &path, std::vector<uint8_t> &data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if(!file)
+			return false;
 
-	if(json.count("firstgid") > 0) m_firstgid = json["firstgid"].get<int>(); else allFound = false;
+		std::streamoff const size = file.tellg();
+		if(size < 0)
+			return false;
+		data.resize(static_cast<size_t>(size));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char *>(data.data()), size));
+	}
 
-	//Tileset is stored in external file if 'source' exists
-	if(json.count("source") > 0)
+	void MapSnapshot::WriteHeader(Writer &out, tson::Map &map, uint64_t sourceHash, const fs::path &directory)
 	{
-		if(!allFound)
-			return allFound;
-
-		std::string sourceStr = json["source"].get<std::string>();
-		m_source = fs::path(sourceStr);
-		m_path = json.directory() / m_source;
+		for(char c : Magic)
+			out.u8(static_cast<uint8_t>(c));
+		out.u32(Version);
+		out.u64(sourceHash);
+
+		std::vector<fs::path> dependencies;
+		CollectDependencies(map, directory, dependencies);
+		out.size(dependencies.size());
+		for(const fs::path &dependency : dependencies)
+			out.path(dependency);
+	}
 
-		if(!json.parse(m_path))
+	bool MapSnapshot::ReadHeader(Reader &in, Header &header)
+	{
+		for(char c : Magic)
+		{
+			if(in.u8() != static_cast<uint8_t>(c))
+				return false;
+		}
+		header.version = in.u32();
+		if(header.version != Version)
 			return false;
+		header.sourceHash = in.u64();
+		size_t const count = in.size(4);
+		header.dependencies.clear();
+		for(size_t i = 0; i < count; ++i)
+			header.dependencies.emplace_back(in.path());
+		return in.ok();
 	}
 
-	if (json.count("columns") > 0)
+	/*!
+	 * The files of the external tilesets and templates of a map
+	 */
+	void MapSnapshot::CollectDependencies(tson::Map &map, const fs::path &directory, std::vector<fs::path> &dependencies)
 	{
-		m_columns = json["columns"].get<int>();
-		if (m_columns == 0)
+		for(auto &tileset : map.m_tilesets)
 		{
-			m_type = TilesetType::ImageCollectionTileset;
+			if(!tileset.m_source.empty())
+				dependencies.push_back(tileset.m_path);
 		}
-		else if (m_columns > 0)
+
+		std::vector<std::string> templates;
+		CollectTemplates(map.m_layers, templates);
+		std::sort(templates.begin(), templates.end());
+		templates.erase(std::unique(templates.begin(), templates.end()), templates.end());
+		for(const std::string &templatePath : templates)
+			dependencies.push_back(directory / templatePath);
+	}
+
+	void MapSnapshot::CollectTemplates(std::vector<tson::Layer> &layers, std::vector<std::string> &templates)
+	{
+		for(auto &layer : layers)
 		{
-			m_type = TilesetType::ImageTileset;
+			for(auto &object : layer.m_objects)
+			{
+				if(!object.m_template.empty())
+					templates.push_back(object.m_template);
+			}
+			CollectTemplates(layer.m_layers, templates);
 		}
 	}
-	else
+
+	void MapSnapshot::WriteMap(Writer &out, tson::Map &map)
 	{
-		allFound = false;
+		out.color(map.m_backgroundColor);
+		out.vector2i(map.m_size);
+		out.i32(map.m_hexsideLength);
+		out.boolean(map.m_isInfinite);
+		out.i32(map.m_nextLayerId);
+		out.i32(map.m_nextObjectId);
+		out.string(map.m_orientation);
+		out.string(map.m_renderOrder);
+		out.string(map.m_staggerAxis);
+		out.string(map.m_staggerIndex);
+		out.string(map.m_tiledVersion);
+		out.vector2i(map.m_tileSize);
+		out.string(map.m_type);
+		out.string(map.m_classType);
+		out.vector2f(map.m_parallaxOrigin);
+		out.i32(map.m_compressionLevel);
+		WriteProperties(out, map.m_properties);
+
+		out.size(map.m_tilesets.size());
+		for(auto &tileset : map.m_tilesets)
+			WriteTileset(out, tileset);
+
+		out.size(map.m_layers.size());
+		for(auto &layer : map.m_layers)
+			WriteLayer(out, layer);
 	}
 
-	// Image tileset specific properties
-	if (m_type == TilesetType::ImageTileset)
+	/*!
+	 * Reads the map, then creates the data a parsed map creates from its json
+	 */
+	void MapSnapshot::ReadMap(Reader &in, tson::Map &map)
 	{
-		if (json.count("image") > 0)
+		map.m_backgroundColor = in.color();
+		map.m_size = in.vector2i();
+		map.m_hexsideLength = in.i32();
+		map.m_isInfinite = in.boolean();
+		map.m_nextLayerId = in.i32();
+		map.m_nextObjectId = in.i32();
+		map.m_orientation = in.string();
+		map.m_renderOrder = in.string();
+		map.m_staggerAxis = in.string();
+		map.m_staggerIndex = in.string();
+		map.m_tiledVersion = in.string();
+		map.m_tileSize = in.vector2i();
+		map.m_type = in.string();
+		map.m_classType = in.string();
+		map.m_parallaxOrigin = in.vector2f();
+		map.m_compressionLevel = in.i32();
+		ReadProperties(in, map.m_properties, map.m_project);
+
+		//The tiles point to their tileset, so every tileset must be in place before they are read
+		map.m_tilesets.resize(in.size(1));
+		for(auto &tileset : map.m_tilesets)
+			ReadTileset(in, tileset, &map);
+
+		map.m_layers.resize(in.size(1));
+		for(auto &layer : map.m_layers)
+			ReadLayer(in, layer, &map);
+
+		if(!in.ok())
+			return;
+
+		map.processData();
+		map.buildObjectLookup();
+	}
+
+	void MapSnapshot::WriteLayer(Writer &out, tson::Layer &layer)
+	{
+		out.string(layer.m_typeStr);
+		out.string(layer.m_classType);
+		out.i32(layer.m_id);
+		out.string(layer.m_name);
+		out.string(layer.m_compression);
+		out.string(layer.m_encoding);
+		out.string(layer.m_drawOrder);
+		out.string(layer.m_image);
+		out.vector2f(layer.m_offset);
+		out.f32(layer.m_opacity);
+		out.vector2i(layer.m_size);
+		out.color(layer.m_transparentColor);
+		out.boolean(layer.m_hasTintColor);
+		out.color(layer.m_tintColor);
+		out.boolean(layer.m_visible);
+		out.i32(layer.m_x);
+		out.i32(layer.m_y);
+		out.vector2f(layer.m_parallax);
+		out.boolean(layer.m_repeatX);
+		out.boolean(layer.m_repeatY);
+		out.boolean(layer.m_hasRegion);
+		out.vector2i(layer.m_regionOrigin);
+
+		//Already decoded and decompressed gids
+		out.size(layer.m_data.size());
+		for(uint32_t gid : layer.m_data)
+			out.u32(gid);
+		out.string(layer.m_base64Data);
+
+		out.size(layer.m_chunks.size());
+		for(auto &chunk : layer.m_chunks)
 		{
-			m_image = fs::path(json["image"].get<std::string>());
-			m_imagePath = m_path.parent_path() / m_image;
+			out.vector2i(chunk.m_size);
+			out.vector2i(chunk.m_position);
+			out.size(chunk.m_data.size());
+			for(int gid : chunk.m_data)
+				out.i32(gid);
+			out.string(chunk.m_base64Data);
 		}
-		else
+
+		WriteProperties(out, layer.m_properties);
+
+		out.size(layer.m_objects.size());
+		for(auto &object : layer.m_objects)
+			WriteObject(out, object);
+
+		out.size(layer.m_layers.size());
+		for(auto &child : layer.m_layers)
+			WriteLayer(out, child);
+	}
+
+	void MapSnapshot::ReadLayer(Reader &in, tson::Layer &layer, tson::Map *map)
+	{
+		layer.m_map = map;
+		layer.m_typeStr = in.string();
+		layer.m_classType = in.string();
+		layer.m_id = in.i32();
+		layer.m_name = in.string();
+		layer.m_compression = in.string();
+		layer.m_encoding = in.string();
+		layer.m_drawOrder = in.string();
+		layer.m_image = in.string();
+		layer.m_offset = in.vector2f();
+		layer.m_opacity = in.f32();
+		layer.m_size = in.vector2i();
+		layer.m_transparentColor = in.color();
+		layer.m_hasTintColor = in.boolean();
+		layer.m_tintColor = in.color();
+		layer.m_visible = in.boolean();
+		layer.m_x = in.i32();
+		layer.m_y = in.i32();
+		layer.m_parallax = in.vector2f();
+		layer.m_repeatX = in.boolean();
+		layer.m_repeatY = in.boolean();
+		layer.m_hasRegion = in.boolean();
+		layer.m_regionOrigin = in.vector2i();
+
+		layer.m_data.resize(in.size(4));
+		for(uint32_t &gid : layer.m_data)
+			gid = in.u32();
+		layer.m_base64Data = in.string();
+
+		layer.m_chunks.resize(in.size(20));
+		for(auto &chunk : layer.m_chunks)
 		{
-			allFound = false;
+			chunk.m_size = in.vector2i();
+			chunk.m_position = in.vector2i();
+			chunk.m_data.resize(in.size(4));
+			for(int &gid : chunk.m_data)
+				gid = in.i32();
+			chunk.m_base64Data = in.string();
 		}
 
-		if (json.count("imagewidth") > 0 && json.count("imageheight") > 0)
+		ReadProperties(in, layer.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+
+		layer.m_objects.resize(in.size(1));
+		for(auto &object : layer.m_objects)
+			ReadObject(in, object, map);
+
+		layer.m_layers.resize(in.size(1));
+		for(auto &child : layer.m_layers)
+			ReadLayer(in, child, map);
+
+		layer.setTypeByString();
+		layer.buildObjectBuckets();
+	}
+
+	void MapSnapshot::WriteObject(Writer &out, tson::Object &object)
+	{
+		out.u8(static_cast<uint8_t>(object.m_objectType));
+		out.boolean(object.m_ellipse);
+		out.u32(object.m_gid);
+		out.u32(static_cast<uint32_t>(object.m_flipFlags));
+		out.vector2i(object.m_size);
+		out.i32(object.m_id);
+		out.string(object.m_name);
+		out.boolean(object.m_point);
+		for(const auto *points : {&object.m_polygon, &object.m_polyline})
 		{
-			m_imageSize = { json["imagewidth"].get<int>(), json["imageheight"].get<int>() };
+			out.size(points->size());
+			for(const auto &point : *points)
+				out.vector2i(point);
 		}
-		else
+		out.f32(object.m_rotation);
+		out.string(object.m_template);
+		out.string(object.m_type);
+		out.boolean(object.m_visible);
+		out.vector2i(object.m_position);
+
+		const tson::Text &text = object.m_text;
+		out.string(text.text);
+		out.color(text.color);
+		out.boolean(text.wrap);
+		out.boolean(text.bold);
+		out.string(text.fontFamily);
+		out.u8(static_cast<uint8_t>(text.horizontalAlignment));
+		out.boolean(text.italic);
+		out.boolean(text.kerning);
+		out.i32(text.pixelSize);
+		out.boolean(text.strikeout);
+		out.boolean(text.underline);
+		out.u8(static_cast<uint8_t>(text.verticalAlignment));
+
+		WriteProperties(out, object.m_properties);
+	}
+
+	void MapSnapshot::ReadObject(Reader &in, tson::Object &object, tson::Map *map)
+	{
+		object.m_map = map;
+		object.m_objectType = static_cast<tson::ObjectType>(in.u8());
+		object.m_ellipse = in.boolean();
+		object.m_gid = in.u32();
+		object.m_flipFlags = static_cast<tson::TileFlipFlags>(in.u32());
+		object.m_size = in.vector2i();
+		object.m_id = in.i32();
+		object.m_name = in.string();
+		object.m_point = in.boolean();
+		for(auto *points : {&object.m_polygon, &object.m_polyline})
 		{
-			allFound = false;
+			points->resize(in.size(8));
+			for(auto &point : *points)
+				point = in.vector2i();
 		}
+		object.m_rotation = in.f32();
+		object.m_template = in.string();
+		object.m_type = in.string();
+		object.m_visible = in.boolean();
+		object.m_position = in.vector2i();
+
+		tson::Text &text = object.m_text;
+		text.text = in.string();
+		text.color = in.color();
+		text.wrap = in.boolean();
+		text.bold = in.boolean();
+		text.fontFamily = in.string();
+		text.horizontalAlignment = static_cast<tson::TextAlignment>(in.u8());
+		text.italic = in.boolean();
+		text.kerning = in.boolean();
+		text.pixelSize = in.i32();
+		text.strikeout = in.boolean();
+		text.underline = in.boolean();
+		text.verticalAlignment = static_cast<tson::TextAlignment>(in.u8());
+
+		ReadProperties(in, object.m_properties, (map != nullptr) ? map->getProject() : nullptr);
 	}
 
-	if(json.count("margin") > 0) m_margin = json["margin"].get<int>(); else allFound = false;
-	if(json.count("name") > 0) m_name = json["name"].get<std::string>(); else allFound = false;
-	if(json.count("spacing") > 0) m_spacing = json["spacing"].get<int>(); else allFound = false;
-	if(json.count("tilecount") > 0) m_tileCount = json["tilecount"].get<int>(); else allFound = false;
-	if(json.count("transparentcolor") > 0) m_transparentColor = tson::Colori(json["transparentcolor"].get<std::string>()); //Optional
-	if (json.count("type") > 0) m_typeStr = json["type"].get<std::string>();
-	if(json.count("grid") > 0) m_grid = tson::Grid(json["grid"]);
-	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
+	/*!
+	 * Writes a tileset, with every tile. External tilesets are stored like embedded ones, but keep their 'source'.
+	 */
+	void MapSnapshot::WriteTileset(Writer &out, tson::Tileset &tileset)
+	{
+		out.i32(tileset.m_firstgid);
+		out.path(tileset.m_source);
+		out.path(tileset.m_path);
+		out.i32(tileset.m_columns);
+		out.u8(static_cast<uint8_t>(tileset.m_type));
+		out.string(tileset.m_typeStr);
+		out.path(tileset.m_image);
+		out.path(tileset.m_imagePath);
+		out.vector2i(tileset.m_imageSize);
+		out.i32(tileset.m_margin);
+		out.string(tileset.m_name);
+		out.i32(tileset.m_spacing);
+		out.i32(tileset.m_tileCount);
+		out.vector2i(tileset.m_tileSize);
+		out.color(tileset.m_transparentColor);
+		out.string(tileset.m_grid.m_orientation);
+		out.vector2i(tileset.m_grid.m_size);
+		out.string(tileset.m_classType);
+		out.vector2i(tileset.m_tileOffset);
+		out.u8(static_cast<uint8_t>(tileset.m_tileRenderSize));
+		out.u8(static_cast<uint8_t>(tileset.m_fillMode));
+		out.u8(static_cast<uint8_t>(tileset.m_objectAlignment));
+		out.boolean(tileset.m_transformations.m_hflip);
+		out.boolean(tileset.m_transformations.m_preferuntransformed);
+		out.boolean(tileset.m_transformations.m_rotate);
+		out.boolean(tileset.m_transformations.m_vflip);
+		WriteProperties(out, tileset.m_properties);
+
+		out.size(tileset.m_terrains.size());
+		for(auto &terrain : tileset.m_terrains)
+		{
+			out.string(terrain.getName());
+			out.i32(terrain.getTile());
+			WriteProperties(out, terrain.getProperties());
+		}
 
-	if(json.count("tilewidth") > 0 && json.count("tileheight") > 0)
-		m_tileSize = {json["tilewidth"].get<int>(), json["tileheight"].get<int>()}; else allFound = false;
-	if(json.count("tileoffset") > 0)
-		m_tileOffset = {json["tileoffset"]["x"].get<int>(), json["tileoffset"]["y"].get<int>()};
+		out.size(tileset.m_wangsets.size());
+		for(const auto &wangset : tileset.m_wangsets)
+			WriteWangSet(out, wangset);
 
-	if(json.count("tilerendersize") > 0)
+		out.size(tileset.m_tiles.size());
+		for(auto &tile : tileset.m_tiles)
+			WriteTile(out, tile);
+	}
+
+	void MapSnapshot::ReadTileset(Reader &in, tson::Tileset &tileset, tson::Map *map)
 	{
-		std::string tileRenderStr = json["tilerendersize"].get<std::string>();
-		if(tileRenderStr == "tile") m_tileRenderSize = TileRenderSize::Tile;
-		else if(tileRenderStr == "grid") m_tileRenderSize = TileRenderSize::Grid;
+		tileset.m_map = map;
+		tileset.m_firstgid = in.i32();
+		tileset.m_source = in.path();
+		tileset.m_path = in.path();
+		tileset.m_columns = in.i32();
+		tileset.m_type = static_cast<tson::TilesetType>(in.u8());
+		tileset.m_typeStr = in.string();
+		tileset.m_image = in.path();
+		tileset.m_imagePath = in.path();
+		tileset.m_imageSize = in.vector2i();
+		tileset.m_margin = in.i32();
+		tileset.m_name = in.string();
+		tileset.m_spacing = in.i32();
+		tileset.m_tileCount = in.i32();
+		tileset.m_tileSize = in.vector2i();
+		tileset.m_transparentColor = in.color();
+		tileset.m_grid.m_orientation = in.string();
+		tileset.m_grid.m_size = in.vector2i();
+		tileset.m_classType = in.string();
+		tileset.m_tileOffset = in.vector2i();
+		tileset.m_tileRenderSize = static_cast<tson::TileRenderSize>(in.u8());
+		tileset.m_fillMode = static_cast<tson::FillMode>(in.u8());
+		tileset.m_objectAlignment = static_cast<tson::ObjectAlignment>(in.u8());
+		tileset.m_transformations.m_hflip = in.boolean();
+		tileset.m_transformations.m_preferuntransformed = in.boolean();
+		tileset.m_transformations.m_rotate = in.boolean();
+		tileset.m_transformations.m_vflip = in.boolean();
+		ReadProperties(in, tileset.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+
+		size_t const terrainCount = in.size(8);
+		tileset.m_terrains.clear();
+		for(size_t i = 0; i < terrainCount; ++i)
+		{
+			std::string name = in.string();
+			int const tile = in.i32();
+			tson::Terrain &terrain = tileset.m_terrains.emplace_back(std::move(name), tile);
+			ReadProperties(in, terrain.getProperties(), (map != nullptr) ? map->getProject() : nullptr);
+		}
+
+		tileset.m_wangsets.resize(in.size(1));
+		for(auto &wangset : tileset.m_wangsets)
+			ReadWangSet(in, wangset, map);
+
+		tileset.m_tiles.resize(in.size(1));
+		for(auto &tile : tileset.m_tiles)
+			ReadTile(in, tile, &tileset, map);
+
+		if(!in.ok())
+			return;
+
+		tileset.bind(map, tileset.m_firstgid);
+		for(auto &wangset : tileset.m_wangsets)
+			wangset.buildLookup(tileset.m_transformations, static_cast<uint32_t>(tileset.m_firstgid));
 	}
 
-	if(json.count("fillmode") > 0)
+	void MapSnapshot::WriteTile(Writer &out, tson::Tile &tile)
 	{
-		std::string fillmode = json["fillmode"].get<std::string>();
-		if(fillmode == "stretch") m_fillMode = FillMode::Stretch;
-		else if(fillmode == "preserve-aspect-fit") m_fillMode = FillMode::PreserveAspectFit;
+		out.u32(tile.m_id);
+		out.path(tile.m_image);
+		out.vector2i(tile.m_imageSize);
+		out.rect(tile.m_subRect);
+		out.string(tile.m_type);
+		out.size(tile.m_terrain.size());
+		for(int terrain : tile.m_terrain)
+			out.i32(terrain);
+
+		const std::vector<tson::Frame> &frames = tile.m_animation.getFrames();
+		out.size(frames.size());
+		for(const auto &frame : frames)
+		{
+			out.i32(frame.getDuration());
+			out.u32(frame.getTileId());
+		}
+
+		WriteProperties(out, tile.m_properties);
+		WriteLayer(out, tile.m_objectgroup);
 	}
 
-	//More advanced data
-	if(json.count("wangsets") > 0 && json["wangsets"].isArray())
+	/*!
+	 * Reads a tile. Its gid and drawing rect are calculated when its tileset is bound to the map.
+	 */
+	void MapSnapshot::ReadTile(Reader &in, tson::Tile &tile, tson::Tileset *tileset, tson::Map *map)
 	{
-		auto &wangsets = json.array("wangsets");
-		std::for_each(wangsets.begin(), wangsets.end(), [&](std::unique_ptr<IJson> &item) { m_wangsets.emplace_back(*item, m_map); });
+		tile.m_tileset = tileset;
+		tile.m_map = map;
+		tile.m_id = in.u32();
+		tile.m_image = in.path();
+		tile.m_imageSize = in.vector2i();
+		tile.m_subRect = in.rect();
+		tile.m_type = in.string();
+		tile.m_terrain.resize(in.size(4));
+		for(int &terrain : tile.m_terrain)
+			terrain = in.i32();
+
+		size_t const frameCount = in.size(8);
+		std::vector<tson::Frame> frames;
+		frames.reserve(frameCount);
+		for(size_t i = 0; i < frameCount; ++i)
+		{
+			int const duration = in.i32();
+			frames.emplace_back(duration, in.u32());
+		}
+		if(!frames.empty())
+			tile.m_animation.setFrames(frames);
+
+		ReadProperties(in, tile.m_properties, (map != nullptr) ? map->getProject() : nullptr);
+		ReadLayer(in, tile.m_objectgroup, map);
 	}
-	if(json.count("tiles") > 0 && json["tiles"].isArray())
+
+	void MapSnapshot::WriteWangSet(Writer &out, const tson::WangSet &wangset)
 	{
-		auto &tiles = json.array("tiles");
-		std::for_each(tiles.begin(), tiles.end(), [&](std::unique_ptr<IJson> &item) { m_tiles.emplace_back(*item, this, m_map); });
+		out.string(wangset.m_name);
+		out.i32(wangset.m_tile);
+		out.string(wangset.m_classType);
+		out.size(wangset.m_wangTiles.size());
+		for(const auto &wangTile : wangset.m_wangTiles)
+		{
+			out.boolean(wangTile.m_dflip);
+			out.boolean(wangTile.m_hflip);
+			out.u32(wangTile.m_tileid);
+			out.boolean(wangTile.m_vflip);
+			out.size(wangTile.m_wangId.size());
+			for(uint32_t id : wangTile.m_wangId)
+				out.u32(id);
+		}
+
+		for(const auto *colors : {&wangset.m_cornerColors, &wangset.m_edgeColors, &wangset.m_colors})
+		{
+			out.size(colors->size());
+			for(const auto &color : *colors)
+				WriteWangColor(out, color);
+		}
+		WriteProperties(out, wangset.m_properties);
 	}
-	if(json.count("terrains") > 0 && json["terrains"].isArray())
+
+	/*!
+	 * Reads a wang set. Its lookup is built when its tileset is read.
+	 */
+	void MapSnapshot::ReadWangSet(Reader &in, tson::WangSet &wangset, tson::Map *map)
 	{
-		auto &terrains = json.array("terrains");
-		std::for_each(terrains.begin(), terrains.end(), [&](std::unique_ptr<IJson> &item) { m_terrains.emplace_back(*item); });
+		wangset.m_map = map;
+		wangset.m_name = in.string();
+		wangset.m_tile = in.i32();
+		wangset.m_classType = in.string();
+		wangset.m_wangTiles.resize(in.size(11));
+		for(auto &wangTile : wangset.m_wangTiles)
+		{
+			wangTile.m_dflip = in.boolean();
+			wangTile.m_hflip = in.boolean();
+			wangTile.m_tileid = in.u32();
+			wangTile.m_vflip = in.boolean();
+			wangTile.m_wangId.resize(in.size(4));
+			for(uint32_t &id : wangTile.m_wangId)
+				id = in.u32();
+		}
+
+		for(auto *colors : {&wangset.m_cornerColors, &wangset.m_edgeColors, &wangset.m_colors})
+		{
+			colors->resize(in.size(1));
+			for(auto &color : *colors)
+				ReadWangColor(in, color, map);
+		}
+		ReadProperties(in, wangset.m_properties, (map != nullptr) ? map->getProject() : nullptr);
 	}
 
-	if(json.count("properties") > 0 && json["properties"].isArray())
+	void MapSnapshot::WriteWangColor(Writer &out, const tson::WangColor &color)
 	{
-		auto &properties = json.array("properties");
-		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item, getProject()); });
+		out.color(color.m_color);
+		out.string(color.m_name);
+		out.f32(color.m_probability);
+		out.i32(color.m_tile);
+		out.string(color.m_classType);
+		WriteProperties(out, color.m_properties);
 	}
 
-	if(json.count("objectalignment") > 0)
+	void MapSnapshot::ReadWangColor(Reader &in, tson::WangColor &color, tson::Map *map)
 	{
-		std::string alignment = json["objectalignment"].get<std::string>();
-		m_objectAlignment = StringToAlignment(alignment);
+		color.m_map = map;
+		color.m_color = in.color();
+		color.m_name = in.string();
+		color.m_probability = in.f32();
+		color.m_tile = in.i32();
+		color.m_classType = in.string();
+		ReadProperties(in, color.m_properties, (map != nullptr) ? map->getProject() : nullptr);
 	}
 
-	if(json.count("transformations") > 0)
+	void MapSnapshot::WriteProperties(Writer &out, const tson::PropertyCollection &properties)
 	{
-		m_transformations.parse(json["transformations"]);
+		out.string(properties.m_id);
+		out.size(properties.m_properties.size());
+		for(const auto &[name, property] : properties.m_properties)
+		{
+			out.string(name);
+			out.u8(static_cast<uint8_t>(property.m_type));
+			out.string(property.m_propertyType);
+			WriteValue(out, property.m_value);
+		}
 	}
 
-	generateMissingTiles();
-
-	return allFound;
-}
-
-/*!
- * 'columns': The number of tile columns in the tileset
- * @return
- */
-int tson::Tileset::getColumns() const
-{
-	return m_columns;
-}
-
-/*!
- * 'firstgid': GID corresponding to the first tile in the set
- * @return
- */
-int tson::Tileset::getFirstgid() const
-{
-	return m_firstgid;
-}
+	void MapSnapshot::ReadProperties(Reader &in, tson::PropertyCollection &properties, tson::Project *project)
+	{
+		properties.m_id = in.string();
+		properties.m_properties.clear();
+		size_t const count = in.size(7);
+		for(size_t i = 0; i < count && in.ok(); ++i)
+		{
+			std::string name = in.string();
+			auto const type = static_cast<tson::Type>(in.u8());
+			std::string propertyType = in.string();
+			tson::Property property {name, ReadValue(in, project), type};
+			property.m_propertyType = std::move(propertyType);
+			property.m_project = project;
+			properties.m_properties[name] = std::move(property);
+		}
+	}
 
-/*!
- * 'image': Image used for tiles in this set
- * @return
- */
-const fs::path &tson::Tileset::getImagePath() const { return m_image; }
+	/*!
+	 * Writes the value of a property, by its C++ type.
+	 * Enum values store the name of their definition, and classes their members, so both can be resolved with the project when loading.
+	 */
+	void MapSnapshot::WriteValue(Writer &out, const std::any &value)
+	{
+		const std::type_info &type = value.type();
+		if(type == typeid(int))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::Int));
+			out.i32(std::any_cast<int>(value));
+		}
+		else if(type == typeid(uint32_t))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::UInt));
+			out.u32(std::any_cast<uint32_t>(value));
+		}
+		else if(type == typeid(bool))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::Bool));
+			out.boolean(std::any_cast<bool>(value));
+		}
+		else if(type == typeid(float))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::Float));
+			out.f32(std::any_cast<float>(value));
+		}
+		else if(type == typeid(std::string))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::String));
+			out.string(std::any_cast<const std::string &>(value));
+		}
+		else if(type == typeid(fs::path))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::Path));
+			out.path(std::any_cast<const fs::path &>(value));
+		}
+		else if(type == typeid(tson::Colori))
+		{
+			out.u8(static_cast<uint8_t>(ValueKind::Color));
+			out.color(std::any_cast<const tson::Colori &>(value));
+		}
+		else if(type == typeid(tson::EnumValue))
+		{
+			const auto &enumValue = std::any_cast<const tson::EnumValue &>(value);
+			out.u8(static_cast<uint8_t>(ValueKind::Enum));
+			out.u32(enumValue.getValue());
+			out.string((enumValue.getDefinition() != nullptr) ? enumValue.getDefinition()->getName() : std::string());
+		}
+		else if(type == typeid(tson::TiledClass))
+		{
+			const auto &tiledClass = std::any_cast<const tson::TiledClass &>(value);
+			out.u8(static_cast<uint8_t>(ValueKind::Class));
+			out.u32(tiledClass.m_id);
+			out.string(tiledClass.m_name);
+			out.string(tiledClass.m_type);
+			WriteProperties(out, tiledClass.m_members);
+		}
+		else
+			out.u8(static_cast<uint8_t>(ValueKind::None));
+	}
 
-/*!
- * Gets a path to the image used in this tileset relative to the JSON
- * file defining this tileset.
- * @return A path that can be used to open the image file of this tileset.
- */
-const fs::path &tson::Tileset::getFullImagePath() const { return m_imagePath; }
+	std::any MapSnapshot::ReadValue(Reader &in, tson::Project *project)
+	{
+		switch(static_cast<ValueKind>(in.u8()))
+		{
+			case ValueKind::Int:
+				return in.i32();
 
-/*!
- * x = 'imagewidth' and y = 'imageheight': in pixels
- * @return
- */
-const tson::Vector2i &tson::Tileset::getImageSize() const
-{
-	return m_imageSize;
-}
+			case ValueKind::UInt:
+				return in.u32();
 
-/*!
- * 'margin': Buffer between image edge and first tile (pixels)
- * @return
- */
-int tson::Tileset::getMargin() const
-{
-	return m_margin;
-}
+			case ValueKind::Bool:
+				return in.boolean();
 
-/*!
- * 'name': Name given to this tileset
- * @return
- */
-const std::string &tson::Tileset::getName() const
-{
-	return m_name;
-}
+			case ValueKind::Float:
+				return in.f32();
 
-/*!
- * 'spacing': Spacing between adjacent tiles in image (pixels)
- * @return
- */
-int tson::Tileset::getSpacing() const
-{
-	return m_spacing;
-}
+			case ValueKind::String:
+				return in.string();
 
-/*!
- * 'tilecount': The number of tiles in this tileset
- * @return
- */
-int tson::Tileset::getTileCount() const
-{
-	return m_tileCount;
-}
+			case ValueKind::Path:
+				return in.path();
 
-/*!
- * x = 'tilewidth' and y = 'tileheight': Maximum size of tiles in this set
- * @return
- */
-const tson::Vector2i &tson::Tileset::getTileSize() const
-{
-	return m_tileSize;
-}
+			case ValueKind::Color:
+				return in.color();
 
-/*!
- * 'transparentcolor': Color object created by hex-formatted color (#RRGGBB) (optional)
- * @return
- */
-const tson::Colori &tson::Tileset::getTransparentColor() const
-{
-	return m_transparentColor;
-}
+			case ValueKind::Enum:
+			{
+				uint32_t const value = in.u32();
+				std::string definitionName = in.string();
+				tson::EnumDefinition *definition = (project != nullptr) ? project->getEnumDefinition(definitionName) : nullptr;
+				return (definition != nullptr) ? tson::EnumValue(value, definition) : tson::EnumValue();
+			}
 
-/*!
- * 'type': tileset (for tileset files, since 1.0)
- * @return
- */
-const std::string& tson::Tileset::getTypeStr() const
-{
-	return m_typeStr;
-}
+			case ValueKind::Class:
+			{
+				tson::TiledClass tiledClass;
+				tiledClass.m_id = in.u32();
+				tiledClass.m_name = in.string();
+				tiledClass.m_type = in.string();
+				ReadProperties(in, tiledClass.m_members, project);
+				return tiledClass;
+			}
 
-/*!
- * 'type': Tileset type as enum
- * @return
-*/
-tson::TilesetType tson::Tileset::getType() const
-{
-	return m_type;
+			default:
+				return {};
+		}
+	}
 }
 
-/*!
- * 'image': Image used for tiles in this set
- * @return
- */
+#endif //TILESON_MAPSNAPSHOT_HPP
 
-const fs::path &tson::Tileset::getImage() const { return m_image; }
+/*** End of inlined file: MapSnapshot.hpp ***/
 
-/*!
- * 'tiles': Array of Tiles (optional)
- * @return
- */
-std::vector<tson::Tile> &tson::Tileset::getTiles()
-{
-	return m_tiles;
-}
 
-/*!
- * 'wangsets':Array of Wang sets (since Tiled 1.1.5)
- * @return
- */
-const std::vector<tson::WangSet> &tson::Tileset::getWangsets() const
-{
-	return m_wangsets;
-}
+/*** Start of inlined file: MappedFile.hpp ***/
+#ifndef TILESON_MAPPEDFILE_HPP
+#define TILESON_MAPPEDFILE_HPP
 
-/*!
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::Tileset::getProperties()
-{
-	return m_properties;
-}
+#include <cstdint>
+#include <fstream>
+#include <vector>
 
-/*!
- * 'terrains': Array of Terrains (optional)
- * @return
- */
-const std::vector<tson::Terrain> &tson::Tileset::getTerrains() const
-{
-	return m_terrains;
-}
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define TILESON_HAS_MMAP 1
+#endif
 
-/*!
- * 'x' and 'y': See <tileoffset> (optional)
- * @return
- */
-const tson::Vector2i &tson::Tileset::getTileOffset() const
+namespace tson
 {
-	return m_tileOffset;
-}
+	/*!
+	 * A read-only file mapped into memory. Processes mapping the same file share its pages through the page cache,
+	 * so the file is only in memory once, however many processes use it.
+	 *
+	 * On platforms without mmap() the file is read into memory instead.
+	 *
+	 * Example:
+	 * tson::MappedFile file {"map.tsonf"};
+	 * tson::MapView map {file.data(), file.size()};
+	 */
+	class MappedFile
+	{
+		public:
+			inline MappedFile() = default;
+			inline explicit MappedFile(const fs::path &path);
+			inline ~MappedFile();
 
-/*!
- * 'grid': This element is only used in case of isometric orientation, and determines
- * how tile overlays for terrain and collision information are rendered.
- * @return
- */
-const tson::Grid &tson::Tileset::getGrid() const
-{
-	return m_grid;
-}
+			MappedFile(const MappedFile &) = delete;
+			MappedFile &operator=(const MappedFile &) = delete;
+			inline MappedFile(MappedFile &&other) noexcept;
+			inline MappedFile &operator=(MappedFile &&other) noexcept;
 
-/*!
- * Gets a tile by ID (Tiled ID + 1)
- * @param id The ID of the tile stored in Tiled map + 1. Example: If ID was stored in Tiled map as 0, the corresponding value in Tileson is 1.
- * This is to make sure the IDs of tiles matches their references in containers.
- * @return A pointer to the Tile if found. nullptr otherwise.
- */
-tson::Tile *tson::Tileset::getTile(uint32_t id)
-{
-	auto result = std::find_if(m_tiles.begin(), m_tiles.end(), [&](const tson::Tile & item) { return item.getId() == id;});
-	if(result == m_tiles.end())
-		return nullptr;
+			inline bool open(const fs::path &path);
+			inline void close();
 
-	return &result.operator*();
-}
+			[[nodiscard]] inline const uint8_t *data() const;
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline bool isOpen() const;
+			[[nodiscard]] inline bool isMapped() const;
 
-/*!
- * Get an existing Terrain object by name
- * @param name
- * @return A pointer to the Terrain if found. nullptr otherwise.
- */
-tson::Terrain *tson::Tileset::getTerrain(const std::string &name)
-{
-	auto result = std::find_if(m_terrains.begin(), m_terrains.end(), [&](const tson::Terrain & item) { return item.getName() == name;});
-	if(result == m_terrains.end())
-		return nullptr;
+		private:
+			inline bool read(const fs::path &path);
 
-	return &result.operator*();
-}
+			const uint8_t *         m_data {nullptr};
+			size_t                  m_size {0};
+			bool                    m_isMapped {false};   /*! true if m_data is mapped, false if it points to m_buffer */
+			std::vector<uint8_t>    m_buffer;             /*! The file, when it could not be mapped */
+	};
 
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::Tileset::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
+	MappedFile::MappedFile(const fs::path &path)
+	{
+		open(path);
+	}
 
-	return nullptr;
-}
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
 
-/*!
- * Tiled only has tiles with a property stored in the map. This function makes sure even the ones with no properties will exist.
- */
-void tson::Tileset::generateMissingTiles()
-{
-	std::vector<uint32_t> tileIds;
-	for(auto &tile : m_tiles)
-		tileIds.push_back(tile.getId());
+	MappedFile::MappedFile(MappedFile &&other) noexcept
+	{
+		*this = std::move(other);
+	}
 
-	for (uint32_t i = 1; i < (uint32_t)m_tileCount + 1; ++i)
+	MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
 	{
-		if (std::count(tileIds.begin(), tileIds.end(), i) == 0)
+		if(this != &other)
 		{
-			m_tiles.emplace_back(Tile::CreateMissingTile(i, this, m_map));
+			close();
+			m_buffer = std::move(other.m_buffer);
+			m_data = (other.m_isMapped) ? other.m_data : m_buffer.data();
+			m_size = other.m_size;
+			m_isMapped = other.m_isMapped;
+			other.m_data = nullptr;
+			other.m_size = 0;
+			other.m_isMapped = false;
 		}
+		return *this;
 	}
-}
 
-/*!
- * Used for getting the tson::Map who is the parent of this Tileset.
- * @return a pointer to the tson::Map where this tileset is contained.
- */
-tson::Map *tson::Tileset::getMap() const
-{
-	return m_map;
-}
+	/*!
+	 * Maps a file, closing the file that was open
+	 * @return false if the file could not be opened
+	 */
+	bool MappedFile::open(const fs::path &path)
+	{
+		close();
+		#ifdef TILESON_HAS_MMAP
+		int const file = ::open(path.c_str(), O_RDONLY);
+		if(file < 0)
+			return false;
 
-/*!
- *
- * @param str The string you want to convert
- * @return Alignment enum based on the string from the input.
- */
-tson::ObjectAlignment tson::Tileset::StringToAlignment(std::string_view str)
-{
-	if(str == "unspecified") return tson::ObjectAlignment::Unspecified;
-	else if(str == "topleft") return tson::ObjectAlignment::TopLeft;
-	else if(str == "top") return tson::ObjectAlignment::Top;
-	else if(str == "topright") return tson::ObjectAlignment::TopRight;
-	else if(str == "left") return tson::ObjectAlignment::Left;
-	else if(str == "center") return tson::ObjectAlignment::Center;
-	else if(str == "right") return tson::ObjectAlignment::Right;
-	else if(str == "bottomleft") return tson::ObjectAlignment::BottomLeft;
-	else if(str == "bottom") return tson::ObjectAlignment::Bottom;
-	else if(str == "bottomright") return tson::ObjectAlignment::BottomRight;
-	else
-		return tson::ObjectAlignment::Unspecified;
-}
+		struct stat status {};
+		if(::fstat(file, &status) != 0)
+		{
+			::close(file);
+			return false;
+		}
 
-tson::ObjectAlignment tson::Tileset::getObjectAlignment() const
-{
-	return m_objectAlignment;
-}
+		//An empty file cannot be mapped
+		if(status.st_size > 0)
+		{
+			void *mapped = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+			if(mapped != MAP_FAILED)
+			{
+				m_data = static_cast<const uint8_t *>(mapped);
+				m_size = static_cast<size_t>(status.st_size);
+				m_isMapped = true;
+			}
+		}
+		::close(file);
+		if(m_isMapped)
+			return true;
+		#endif
 
-/*!
- * Helper function to calculate the correct additional offset when margin and/or spacing is used in a tileset
- * Created to solve issue #31.
- *
- * @param posInTileUnits Position of the current tile in tile units.
- * @return Calculated additional offset in pixels.
- */
-tson::Vector2i tson::Tileset::getMarginSpacingOffset(const tson::Vector2i &posInTileUnits)
-{
-	if(m_margin == 0 && m_spacing == 0)
-		return {0,0};
+		return read(path);
+	}
 
-	tson::Vector2i offset {(posInTileUnits.x * m_spacing) + m_margin, (posInTileUnits.y * m_spacing) + m_margin};
-	return offset;
-}
+	/*!
+	 * Unmaps the file
+	 */
+	void MappedFile::close()
+	{
+		#ifdef TILESON_HAS_MMAP
+		if(m_isMapped)
+			::munmap(const_cast<uint8_t *>(m_data), m_size);
+		#endif
+		m_data = nullptr;
+		m_size = 0;
+		m_isMapped = false;
+		m_buffer.clear();
+		m_buffer.shrink_to_fit();
+	}
 
-/*!
- * Get a wangset by name
- * @param name
- * @return
- */
-tson::WangSet *tson::Tileset::getWangset(const std::string &name)
-{
-	auto wangset = std::find_if(m_wangsets.begin(), m_wangsets.end(), [&](const auto &w) { return w.getName() == name; });
+	bool MappedFile::read(const fs::path &path)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if(!file)
+			return false;
 
-	if(wangset != m_wangsets.end())
-		return &wangset.operator*();
+		std::streamoff const size = file.tellg();
+		if(size < 0)
+			return false;
+		m_buffer.resize(static_cast<size_t>(size));
+		file.seekg(0, std::ios::beg);
+		if(!file.read(reinterpret_cast<char *>(m_buffer.data()), size))
+		{
+			m_buffer.clear();
+			return false;
+		}
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		return true;
+	}
 
-	return nullptr;
-}
+	/*!
+	 * The contents of the file. nullptr if no file is open.
+	 */
+	const uint8_t *MappedFile::data() const
+	{
+		return m_data;
+	}
 
-/*!
- * New in Tiled v1.5 - This element is used to describe which transformations can be applied to
- * the tiles (e.g. to extend a Wang set by transforming existing tiles).
- *
- * @return
- */
-const tson::Transformations &tson::Tileset::getTransformations() const
-{
-	return m_transformations;
-}
+	size_t MappedFile::size() const
+	{
+		return m_size;
+	}
 
-tson::TileRenderSize tson::Tileset::getTileRenderSize() const
-{
-	return m_tileRenderSize;
-}
+	bool MappedFile::isOpen() const
+	{
+		return m_data != nullptr;
+	}
 
-tson::FillMode tson::Tileset::getFillMode() const
-{
-	return m_fillMode;
+	/*!
+	 * true if the file is mapped, and not read into memory
+	 */
+	bool MappedFile::isMapped() const
+	{
+		return m_isMapped;
+	}
 }
 
-const std::string &tson::Tileset::getClassType() const
-{
-	return m_classType;
-}
+#endif //TILESON_MAPPEDFILE_HPP
 
-#endif //TILESON_TILESET_HPP
-/*** End of inlined file: Tileset.hpp ***/
+/*** End of inlined file: MappedFile.hpp ***/
+
+
+/*** Start of inlined file: FlatMap.hpp ***/
+#ifndef TILESON_FLATMAP_HPP
+#define TILESON_FLATMAP_HPP
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace tson
 {
-	using LinkedFileParser = std::function<std::unique_ptr<IJson>(std::string relativePath)>;
-	class Object;
-	class Map
+	/*!
+	 * A read-only map format (.tsonf) that is used where it is, without being parsed: Mapped with tson::MappedFile, and read through
+	 * tson::MapView. Nothing is allocated when a map is opened, and processes mapping the same file share it in the page cache.
+	 *
+	 * The file is a set of tables of fixed size records. Records point to their children with the offset and count of a table,
+	 * and to strings with an offset and length in the string section, where every distinct string is stored once.
+	 * Gids are stored as a plain uint32_t array per layer. Everything is 4-byte aligned, and stored in the byte order of the host
+	 * that wrote it, which the header tells: Files written on a host with another byte order are rejected.
+	 *
+	 * Unlike tson::MapSnapshot, this is not a full tson::Map: Wang sets, terrains and tile collision layers other than their objects are left out.
+	 *
+	 * Example:
+	 * tson::FlatMap::Save(*map, "map.tsonf");
+	 */
+	class FlatMap
 	{
-		friend class Object;
 		public:
-			inline Map() = default;
-			inline Map(ParseStatus status, std::string description);
-			inline explicit Map(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser = nullptr);
-			inline bool parse(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser = nullptr);
+			static constexpr char Magic[8] {'T', 'S', 'O', 'N', 'F', 'L', 'A', 'T'};
+			static constexpr uint32_t Version = 2;
+			static constexpr uint32_t ByteOrderMark = 0x01020304;
 
-			[[nodiscard]] inline const Colori &getBackgroundColor() const;
-			[[nodiscard]] inline const Vector2i &getSize() const;
-			[[nodiscard]] inline int getHexsideLength() const;
-			[[nodiscard]] inline bool isInfinite() const;
-			[[nodiscard]] inline int getNextLayerId() const;
-			[[nodiscard]] inline int getNextObjectId() const;
-			[[nodiscard]] inline const std::string &getOrientation() const;
-			[[nodiscard]] inline const std::string &getRenderOrder() const;
-			[[nodiscard]] inline const std::string &getStaggerAxis() const;
-			[[nodiscard]] inline const std::string &getStaggerIndex() const;
-			[[nodiscard]] inline const std::string &getTiledVersion() const;
-			[[nodiscard]] inline const Vector2i &getTileSize() const;
-			[[nodiscard]] inline const std::string &getType() const;
-			[[nodiscard]] inline const std::string &getClassType() const;
-			[[nodiscard]] inline tson::TiledClass *getClass(); /*! Declared in tileson_forward.hpp */
-			[[nodiscard]] inline const Vector2f &getParallaxOrigin() const;
-			//[[nodiscard]] inline int getVersion() const; //Removed - Tileson v1.3.0
+			/*! The string at 'offset' in the string section */
+			class String
+			{
+				public:
+					uint32_t offset;
+					uint32_t length;
+			};
 
-			[[nodiscard]] inline std::vector<tson::Layer> &getLayers();
-			[[nodiscard]] inline PropertyCollection &getProperties();
-			[[nodiscard]] inline std::vector<tson::Tileset> &getTilesets();
+			/*! 'count' records starting at 'offset' in the file */
+			class Table
+			{
+				public:
+					uint32_t offset;
+					uint32_t count;
+			};
 
-			[[nodiscard]] inline ParseStatus getStatus() const;
-			[[nodiscard]] inline const std::string &getStatusMessage() const;
-			[[nodiscard]] inline const std::map<uint32_t, tson::Tile *> &getTileMap() const;
+			class Header
+			{
+				public:
+					char     magic[8];
+					uint32_t version;
+					uint32_t byteOrder;     /*! ByteOrderMark, as written by the host */
+					uint32_t size;          /*! Size of the file */
+					uint32_t map;           /*! Offset of the MapRecord */
+					uint32_t strings;       /*! Offset of the string section */
+					uint32_t stringsSize;
+			};
 
-			inline Layer * getLayer(const std::string &name);
-			inline Tileset * getTileset(const std::string &name);
+			class MapRecord
+			{
+				public:
+					int32_t  width, height, tileWidth, tileHeight;
+					String   orientation, renderOrder, staggerAxis, staggerIndex, tiledVersion, type, classType;
+					uint32_t infinite;
+					uint32_t backgroundColor;
+					int32_t  hexsideLength, nextLayerId, nextObjectId;
+					float    parallaxOriginX, parallaxOriginY;
+					Table    layers, tilesets, properties;
+			};
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property * getProp(const std::string &name);
+			class LayerRecord
+			{
+				public:
+					int32_t  id;
+					uint32_t type;          /*! tson::LayerType */
+					String   name, typeStr, classType, image, drawOrder;
+					int32_t  x, y, width, height;
+					int32_t  regionX, regionY;  /*! Position of the first tile of 'data' in the map, when the layer has LayerHasRegion */
+					float    offsetX, offsetY, opacity, parallaxX, parallaxY;
+					uint32_t flags;         /*! LayerVisible, LayerHasTintColor... */
+					uint32_t tintColor, transparentColor;
+					Table    data, chunks, objects, layers, properties;
+			};
 
-			//v1.2.0
-			[[nodiscard]] inline int getCompressionLevel() const;
-			inline DecompressorContainer *getDecompressors();
-			inline Project * getProject();
-			inline Tileset * getTilesetByGid(uint32_t gid);
+			class ChunkRecord
+			{
+				public:
+					int32_t  x, y, width, height;
+					Table    data;
+			};
 
-		private:
-			inline IJson* parseLinkedFile(const std::string& path);
-			inline bool createTilesetData(IJson &json);
-			inline void processData();
+			class ObjectRecord
+			{
+				public:
+					int32_t  id;
+					uint32_t objectType;    /*! tson::ObjectType */
+					String   name, type, templ, text;
+					int32_t  x, y, width, height;
+					float    rotation;
+					uint32_t gid, flipFlags;
+					uint32_t flags;         /*! ObjectVisible, ObjectEllipse, ObjectPoint */
+					Table    polygon, polyline, properties;
+			};
 
-			Colori                                 m_backgroundColor;   /*! 'backgroundcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) (optional)*/;
-			Vector2i                               m_size;              /*! 'width' and 'height' of a Tiled map */
-			int                                    m_hexsideLength {};  /*! 'hexsidelength': Length of the side of a hex tile in pixels */
-			bool                                   m_isInfinite {};     /*! 'infinite': Whether the map has infinite dimensions*/
-			std::vector<tson::Layer>               m_layers; 	        /*! 'layers': Array of layers. group on */
-			int                                    m_nextLayerId {};    /*! 'nextlayerid': Auto-increments for each layer */
-			int                                    m_nextObjectId {};   /*! 'nextobjectid': Auto-increments for each placed object */
-			std::string                            m_orientation;       /*! 'orientation': orthogonal, isometric, staggered or hexagonal */
-			tson::PropertyCollection               m_properties; 	    /*! 'properties': A list of properties (name, value, type). */
-			std::string                            m_renderOrder;       /*! 'renderorder': Rendering direction (orthogonal maps only) */
-			std::string                            m_staggerAxis;       /*! 'staggeraxis': x or y (staggered / hexagonal maps only) */
-			std::string                            m_staggerIndex;      /*! 'staggerindex': odd or even (staggered / hexagonal maps only) */
-			std::string                            m_tiledVersion;      /*! 'tiledversion': The Tiled version used to save the file */
-			Vector2i                               m_tileSize;          /*! 'tilewidth': and 'tileheight' of a map */
-			std::vector<tson::Tileset>             m_tilesets;          /*! 'tilesets': Array of Tilesets */
-			std::string                            m_type;              /*! 'type': map (since 1.0) */
-			tson::Vector2f                         m_parallaxOrigin;    /*! Tiled v1.8: parallax origin in pixels. Defaults to 0. */
-			//int                                    m_version{};       /*! 'version': The JSON format version - Removed in Tileson v1.3.0*/
+			class TilesetRecord
+			{
+				public:
+					int32_t  firstgid;
+					uint32_t type;          /*! tson::TilesetType */
+					String   name, image, fullImagePath, classType;
+					int32_t  imageWidth, imageHeight, tileWidth, tileHeight, tileCount, columns, margin, spacing, tileOffsetX, tileOffsetY;
+					uint32_t transparentColor;
+					Table    tiles, properties;
+			};
 
-			ParseStatus                            m_status {ParseStatus::OK};
-			std::string                            m_statusMessage {"OK"};
+			/*! Only tiles with an image, a class, an animation, objects or properties are stored */
+			class TileRecord
+			{
+				public:
+					uint32_t id, gid;
+					String   image, type;
+					int32_t  imageWidth, imageHeight;
+					int32_t  subX, subY, subWidth, subHeight;
+					Table    animation, objects, properties;
+			};
 
-			std::map<uint32_t, tson::Tile*>        m_tileMap{};           /*! key: Tile ID. Value: Pointer to Tile*/
+			class FrameRecord
+			{
+				public:
+					uint32_t tileId;
+					int32_t  duration;
+			};
 
-			//v1.2.0
-			int                                    m_compressionLevel {-1};  /*! 'compressionlevel': The compression level to use for tile layer
-																			  *     data (defaults to -1, which means to use the algorithm default)
-																			  *     Introduced in Tiled 1.3*/
-			tson::DecompressorContainer *          m_decompressors {nullptr};
-			tson::Project *                        m_project {nullptr};
-			std::map<uint32_t, tson::Tile>         m_flaggedTileMap{};    /*! key: Tile ID. Value: Tile*/
+			class PointRecord
+			{
+				public:
+					int32_t  x, y;
+			};
+
+			class PropertyRecord
+			{
+				public:
+					String   name;
+					uint32_t type;          /*! tson::Type */
+					String   propertyType;
+					uint32_t kind;          /*! ValueKind */
+					uint32_t value;         /*! int, uint, bool, float bits, color or enum value */
+					String   string;        /*! string and file values, the value name of enums and the name of classes */
+					Table    members;       /*! PropertyRecords of class values */
+			};
+
+			enum class ValueKind : uint32_t
+			{
+				None = 0,
+				Int = 1,
+				UInt = 2,
+				Bool = 3,
+				Float = 4,
+				String = 5,
+				Path = 6,
+				Color = 7,
+				Enum = 8,
+				Class = 9
+			};
+
+			/*! Flags of LayerRecord::flags */
+			static constexpr uint32_t LayerVisible = 1 << 0;
+			static constexpr uint32_t LayerHasTintColor = 1 << 1;
+			static constexpr uint32_t LayerRepeatX = 1 << 2;
+			static constexpr uint32_t LayerRepeatY = 1 << 3;
+			static constexpr uint32_t LayerHasRegion = 1 << 4;   /*! Only a region of the layer was decoded. See tson::Layer::hasRegion() */
+
+			/*! Flags of ObjectRecord::flags */
+			static constexpr uint32_t ObjectVisible = 1 << 0;
+			static constexpr uint32_t ObjectEllipse = 1 << 1;
+			static constexpr uint32_t ObjectPoint = 1 << 2;
+
+			/*!
+			 * Bounds checked access to the records of a flat map in memory
+			 */
+			class Data
+			{
+				public:
+					inline Data() = default;
+					inline Data(const uint8_t *data, size_t size, uint32_t strings, uint32_t stringsSize);
+
+					template <typename T>
+					inline T record(uint32_t offset) const;
+					template <typename T>
+					inline T record(const Table &table, size_t index) const;
+					template <typename T>
+					[[nodiscard]] inline size_t count(const Table &table) const;
+					[[nodiscard]] inline std::string_view string(const String &string) const;
+					[[nodiscard]] inline const uint8_t *data() const { return m_data; }
+
+				private:
+					const uint8_t *m_data {nullptr};
+					size_t m_size {0};
+					uint32_t m_strings {0};
+					uint32_t m_stringsSize {0};
+			};
 
-			std::string                            m_classType{};              /*! 'class': The class of this map (since 1.9, defaults to “”). */
-			std::shared_ptr<tson::TiledClass>      m_class {};
+			inline static std::vector<uint8_t> Serialize(tson::Map &map);
+			inline static bool Save(tson::Map &map, const fs::path &path);
+			inline static bool ReadHeader(const void *data, size_t size, Header &header);
 
-			tson::LinkedFileParser                 m_linkedFileParser;     /*! callback function to parse linked files */
-			std::map<std::string, std::unique_ptr<IJson>> m_linkedFiles;  /*! key: relative path to linked file. Value: Pointer to loaded JSON */
+			inline static uint32_t PackColor(const tson::Colori &color);
+			inline static tson::Colori UnpackColor(uint32_t color);
+
+		private:
+			class Writer
+			{
+				public:
+					template <typename T>
+					inline uint32_t allocate(size_t count);
+					template <typename T>
+					inline void store(uint32_t offset, size_t index, const T &record);
+					inline String string(const std::string &value);
+
+					std::vector<uint8_t> data;
+					std::vector<uint8_t> strings;
+					std::unordered_map<std::string, String> stringOffsets; /*! Every distinct string is only stored once */
+			};
+
+			inline static void WriteMap(Writer &out, tson::Map &map, uint32_t offset);
+			inline static Table WriteLayers(Writer &out, std::vector<tson::Layer> &layers);
+			inline static Table WriteObjects(Writer &out, std::vector<tson::Object> &objects);
+			inline static Table WriteTilesets(Writer &out, std::vector<tson::Tileset> &tilesets);
+			inline static Table WriteTiles(Writer &out, std::vector<tson::Tile> &tiles);
+			inline static Table WriteProperties(Writer &out, tson::PropertyCollection &properties);
+			inline static Table WritePoints(Writer &out, const std::vector<tson::Vector2i> &points);
+			template <typename T>
+			inline static Table WriteArray(Writer &out, const std::vector<T> &values);
+			inline static void WriteValue(Writer &out, const std::any &value, PropertyRecord &record);
 	};
 
+	static_assert(sizeof(FlatMap::Header) == 32, "FlatMap records must not be padded");
+	static_assert(sizeof(FlatMap::MapRecord) % 4 == 0 && sizeof(FlatMap::LayerRecord) % 4 == 0 && sizeof(FlatMap::ObjectRecord) % 4 == 0,
+				  "FlatMap records must keep the file 4-byte aligned");
+
+	FlatMap::Data::Data(const uint8_t *data, size_t size, uint32_t strings, uint32_t stringsSize) : m_data {data}, m_size {size},
+																									 m_strings {strings}, m_stringsSize {stringsSize}
+	{
+
+	}
+
 	/*!
-	 * A shortcut for getting a property. Alternative to getProperties().getValue<T>("<name>")
-	 * @tparam T The template value
-	 * @param name Name of the property
-	 * @return The actual value, if it exists. Otherwise: The default value of the type.
+	 * Reads the record at an offset. A default record if it is outside the data.
 	 */
 	template<typename T>
-	T tson::Map::get(const std::string &name)
+	T FlatMap::Data::record(uint32_t offset) const
 	{
-		return m_properties.getValue<T>(name);
+		T value {};
+		if(m_data != nullptr && offset <= m_size && sizeof(T) <= m_size - offset)
+			std::memcpy(&value, m_data + offset, sizeof(T));
+		return value;
 	}
-}
-
-/*!
- * When errors have happened before the map starts parsing, just keep the statuses
- * @param status The status
- * @param description Description of the status
- */
-tson::Map::Map(tson::ParseStatus status, std::string description) : m_status {status}, m_statusMessage { std::move(description) }
-{
-
-}
 
-/*!
- * Parses a json of a Tiled map.
- * @param json A json object with the format of Map
- * @param linkedFileParser A callback function that must return a IJson object when a linked file is found in the map
- * @return true if all mandatory fields was found. false otherwise.
- */
-tson::Map::Map(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser)
-{
-	parse(json, decompressors, project, linkedFileParser);
-}
-
-/*!
- * Parses a json of a Tiled map.
- * @param json A json object with the format of Map
- * @param linkedFileParser A callback function that must return a IJson object when a linked file is found in the map
- * @return true if all mandatory fields was found. false otherwise.
- */
-bool tson::Map::parse(IJson &json, tson::DecompressorContainer *decompressors, tson::Project *project, tson::LinkedFileParser linkedFileParser)
-{
-	m_decompressors = decompressors;
-	m_project = project;
-	m_linkedFileParser = linkedFileParser;
-
-	if(!m_linkedFileParser)
-	{  // build a default linked file parser out of processing relative paths to
-	   // the main json's location.
-		m_linkedFileParser = [&json](std::string relativePath) -> std::unique_ptr<IJson>
-		{
-			if(json.directory().empty())
-				return nullptr;
-
-			std::unique_ptr<IJson> linkedFileJson = json.create();
-			bool parseOk = linkedFileJson->parse(json.directory() / relativePath);
-			if(parseOk)
-				return linkedFileJson;
-			else
-				return nullptr;
-		};
+	template<typename T>
+	T FlatMap::Data::record(const Table &table, size_t index) const
+	{
+		if(index >= count<T>(table))
+			return T {};
+		return record<T>(static_cast<uint32_t>(table.offset + index * sizeof(T)));
 	}
 
-	bool allFound = true;
-	if(json.count("compressionlevel") > 0)
-		m_compressionLevel = json["compressionlevel"].get<int>(); //Tiled 1.3 - Optional
-
-	if(json.count("backgroundcolor") > 0) m_backgroundColor = Colori(json["backgroundcolor"].get<std::string>()); //Optional
-	if(json.count("width") > 0 && json.count("height") > 0 )
-		m_size = {json["width"].get<int>(), json["height"].get<int>()}; else allFound = false;
-	if(json.count("hexsidelength") > 0) m_hexsideLength = json["hexsidelength"].get<int>();         //Optional
-	if(json.count("infinite") > 0) m_isInfinite = json["infinite"].get<bool>();                     //Optional
-	if(json.count("nextlayerid") > 0) m_nextLayerId = json["nextlayerid"].get<int>();               //Optional
-	if(json.count("nextobjectid") > 0) m_nextObjectId = json["nextobjectid"].get<int>(); else allFound = false;
-	if(json.count("orientation") > 0) m_orientation = json["orientation"].get<std::string>(); else allFound = false;
-	if(json.count("renderorder") > 0) m_renderOrder = json["renderorder"].get<std::string>();       //Optional
-	if(json.count("staggeraxis") > 0) m_staggerAxis = json["staggeraxis"].get<std::string>();       //Optional
-	if(json.count("staggerindex") > 0) m_staggerIndex = json["staggerindex"].get<std::string>();    //Optional
-	if(json.count("tiledversion") > 0) m_tiledVersion = json["tiledversion"].get<std::string>(); else allFound = false;
-	if(json.count("tilewidth") > 0 && json.count("tileheight") > 0 )
-		m_tileSize = {json["tilewidth"].get<int>(), json["tileheight"].get<int>()}; else allFound = false;
-	if(json.count("type") > 0) m_type = json["type"].get<std::string>();                            //Optional
-	if(json.count("class") > 0) m_classType = json["class"].get<std::string>();                     //Optional
-
-	//Removed - Changed from a float to string in Tiled v1.6, and old spec said int.
-	//Reason for removal is that it seems to have no real use, as TiledVersion is stored in another variable.
-	//if(json.count("version") > 0) m_version = json["version"].get<int>(); else allFound = false;
-
-	//More advanced data
-	if(json.count("layers") > 0 && json["layers"].isArray())
+	/*!
+	 * The number of records in a table. 0 if the table does not fit in the data.
+	 */
+	template<typename T>
+	size_t FlatMap::Data::count(const Table &table) const
 	{
-		auto &array = json.array("layers");
-		std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
-		{
-			m_layers.emplace_back(*item, this);
-		});
+		if(table.offset > m_size || table.count > (m_size - table.offset) / sizeof(T))
+			return 0;
+		return table.count;
 	}
 
-	if(json.count("properties") > 0 && json["properties"].isArray())
+	std::string_view FlatMap::Data::string(const String &string) const
 	{
-		auto &array = json.array("properties");
-		std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
-		{
-			m_properties.add(*item, m_project);
-		});
+		if(m_data == nullptr || string.offset > m_stringsSize || string.length > m_stringsSize - string.offset)
+			return {};
+		return {reinterpret_cast<const char *>(m_data + m_strings + string.offset), string.length};
 	}
 
-	tson::Vector2f parallaxOrigin {0.f, 0.f};
-	if(json.count("parallaxoriginx") > 0)
-		parallaxOrigin.x = json["parallaxoriginx"].get<float>();
-	if(json.count("parallaxoriginy") > 0)
-		parallaxOrigin.y = json["parallaxoriginy"].get<float>();
+	/*!
+	 * Writes a parsed map to the flat format
+	 */
+	std::vector<uint8_t> FlatMap::Serialize(tson::Map &map)
+	{
+		Writer out;
+		uint32_t const header = out.allocate<Header>(1);
+		uint32_t const mapOffset = out.allocate<MapRecord>(1);
+		WriteMap(out, map, mapOffset);
+
+		Header record {};
+		std::memcpy(record.magic, Magic, sizeof(record.magic));
+		record.version = Version;
+		record.byteOrder = ByteOrderMark;
+		record.map = mapOffset;
+		record.strings = static_cast<uint32_t>(out.data.size());
+		record.stringsSize = static_cast<uint32_t>(out.strings.size());
+		out.data.insert(out.data.end(), out.strings.begin(), out.strings.end());
+		out.data.resize((out.data.size() + 3) & ~size_t(3));
+		record.size = static_cast<uint32_t>(out.data.size());
+		out.store(header, 0, record);
+		return std::move(out.data);
+	}
 
-	m_parallaxOrigin = parallaxOrigin;
+	/*!
+	 * Writes a parsed map to a flat map file
+	 * @return true if the file was written
+	 */
+	bool FlatMap::Save(tson::Map &map, const fs::path &path)
+	{
+		std::vector<uint8_t> data = Serialize(map);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+		return file.good();
+	}
 
-	if(!createTilesetData(json))
-		allFound = false;
+	/*!
+	 * Reads and checks the header of a flat map
+	 * @return false if the data is not a flat map of this version and byte order, or is smaller than the header says
+	 */
+	bool FlatMap::ReadHeader(const void *data, size_t size, Header &header)
+	{
+		if(data == nullptr || size < sizeof(Header))
+			return false;
 
-	processData();
+		std::memcpy(&header, data, sizeof(Header));
+		return std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version && header.byteOrder == ByteOrderMark &&
+			   header.size <= size && header.strings <= header.size && header.stringsSize <= header.size - header.strings;
+	}
 
-	m_linkedFiles.clear(); // close all open linked json files
+	uint32_t FlatMap::PackColor(const tson::Colori &color)
+	{
+		return static_cast<uint32_t>(color.r) | static_cast<uint32_t>(color.g) << 8 | static_cast<uint32_t>(color.b) << 16 |
+			   static_cast<uint32_t>(color.a) << 24;
+	}
 
-	return allFound;
-}
+	tson::Colori FlatMap::UnpackColor(uint32_t color)
+	{
+		return {static_cast<uint8_t>(color), static_cast<uint8_t>(color >> 8), static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 24)};
+	}
 
-/*!
- * Attempts to parse a linked file found in the map.
- * @param relativePath Path to the linked file, relative to the map file.
- * @return a IJson pointer to the parsed file.
- */
-tson::IJson* tson::Map::parseLinkedFile(const std::string& relativePath)
-{
-	auto it = m_linkedFiles.find(relativePath);
-	if(it == m_linkedFiles.end())
+	/*!
+	 * Adds room for 'count' records at the end of the data
+	 * @return The offset of the first record
+	 */
+	template<typename T>
+	uint32_t FlatMap::Writer::allocate(size_t count)
 	{
-		if (!m_linkedFileParser) return nullptr;
-		std::unique_ptr<IJson> linkedFileJson = m_linkedFileParser(relativePath);
-		if(!linkedFileJson)
-			return nullptr;
+		auto const offset = static_cast<uint32_t>(data.size());
+		data.resize(data.size() + count * sizeof(T));
+		return offset;
+	}
 
-		auto result = m_linkedFiles.emplace(relativePath, std::move(linkedFileJson));
-		return result.first->second.get();
+	template<typename T>
+	void FlatMap::Writer::store(uint32_t offset, size_t index, const T &record)
+	{
+		std::memcpy(data.data() + offset + index * sizeof(T), &record, sizeof(T));
 	}
-	else return it->second.get();
-}
 
-/*!
- * Tileset data must be created in two steps to prevent malformed tson::Tileset pointers inside tson::Tile
- */
-bool tson::Map::createTilesetData(IJson &json)
-{
-	bool ok = true;
-	if(json.count("tilesets") > 0 && json["tilesets"].isArray())
+	FlatMap::String FlatMap::Writer::string(const std::string &value)
 	{
-		//First created tileset objects
-		auto &tilesets = json.array("tilesets");
-		std::for_each(tilesets.begin(), tilesets.end(), [&](std::unique_ptr<IJson> &)
-		{
-			m_tilesets.emplace_back();
-		});
+		if(value.empty())
+			return {0, 0};
 
-		int i = 0;
-		//Then do the parsing
-		std::for_each(tilesets.begin(), tilesets.end(), [&](std::unique_ptr<IJson> &item)
-		{
-			item->directory(json.directory());
-			if(!m_tilesets[i].parse(*item, this))
-				ok = false;
+		auto it = stringOffsets.find(value);
+		if(it != stringOffsets.end())
+			return it->second;
 
-			++i;
-		});
+		String result {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+		strings.insert(strings.end(), value.begin(), value.end());
+		stringOffsets.emplace(value, result);
+		return result;
 	}
-	return ok;
-}
 
-/*!
- * Processes the parsed data and uses the data to create helpful objects, like tile maps.
- */
-void tson::Map::processData()
-{
-	m_tileMap.clear();
-	for(auto &tileset : m_tilesets)
+	void FlatMap::WriteMap(Writer &out, tson::Map &map, uint32_t offset)
 	{
-		  std::set<std::uint32_t> usedIds;
-		  for(auto& tile : tileset.getTiles())
-		  {
-			  if (usedIds.count(tile.getGid()) != 0)
-			  {
-				  continue;
-			  }
-			  usedIds.insert(tile.getGid());
-			  m_tileMap[tile.getGid()] = &tile;
-		  }
+		MapRecord record {};
+		record.width = map.getSize().x;
+		record.height = map.getSize().y;
+		record.tileWidth = map.getTileSize().x;
+		record.tileHeight = map.getTileSize().y;
+		record.orientation = out.string(map.getOrientation());
+		record.renderOrder = out.string(map.getRenderOrder());
+		record.staggerAxis = out.string(map.getStaggerAxis());
+		record.staggerIndex = out.string(map.getStaggerIndex());
+		record.tiledVersion = out.string(map.getTiledVersion());
+		record.type = out.string(map.getType());
+		record.classType = out.string(map.getClassType());
+		record.infinite = map.isInfinite() ? 1 : 0;
+		record.backgroundColor = PackColor(map.getBackgroundColor());
+		record.hexsideLength = map.getHexsideLength();
+		record.nextLayerId = map.getNextLayerId();
+		record.nextObjectId = map.getNextObjectId();
+		record.parallaxOriginX = map.getParallaxOrigin().x;
+		record.parallaxOriginY = map.getParallaxOrigin().y;
+		record.layers = WriteLayers(out, map.getLayers());
+		record.tilesets = WriteTilesets(out, map.getTilesets());
+		record.properties = WriteProperties(out, map.getProperties());
+		out.store(offset, 0, record);
 	}
-	std::for_each(m_layers.begin(), m_layers.end(), [&](tson::Layer &layer)
+
+	FlatMap::Table FlatMap::WriteLayers(Writer &out, std::vector<tson::Layer> &layers)
 	{
-		layer.assignTileMap(&m_tileMap);
-		layer.createTileData(m_size, m_isInfinite);
-		const std::set<uint32_t> &flaggedTiles = layer.getUniqueFlaggedTiles();
-		for(uint32_t ftile : flaggedTiles)
+		Table const table {out.allocate<LayerRecord>(layers.size()), static_cast<uint32_t>(layers.size())};
+		for(size_t i = 0; i < layers.size(); ++i)
 		{
-			tson::Tile tile = tson::Tile::CreateFlippedTile(ftile, layer.getMap());
-			if(m_tileMap.count(tile.getGid()))
+			tson::Layer &layer = layers[i];
+			LayerRecord record {};
+			record.id = layer.getId();
+			record.type = static_cast<uint32_t>(layer.getType());
+			record.name = out.string(layer.getName());
+			record.typeStr = out.string(layer.getTypeStr());
+			record.classType = out.string(layer.getClassType());
+			record.image = out.string(layer.getImage());
+			record.drawOrder = out.string(layer.getDrawOrder());
+			record.x = layer.getX();
+			record.y = layer.getY();
+			record.width = layer.getSize().x;
+			record.height = layer.getSize().y;
+			record.regionX = layer.getRegionOrigin().x;
+			record.regionY = layer.getRegionOrigin().y;
+			record.offsetX = layer.getOffset().x;
+			record.offsetY = layer.getOffset().y;
+			record.opacity = layer.getOpacity();
+			record.parallaxX = layer.getParallax().x;
+			record.parallaxY = layer.getParallax().y;
+			record.flags = (layer.isVisible() ? LayerVisible : 0u) | (layer.hasTintColor() ? LayerHasTintColor : 0u) |
+						   (layer.hasRepeatX() ? LayerRepeatX : 0u) | (layer.hasRepeatY() ? LayerRepeatY : 0u) |
+						   (layer.hasRegion() ? LayerHasRegion : 0u);
+			record.tintColor = PackColor(layer.getTintColor());
+			record.transparentColor = PackColor(layer.getTransparentColor());
+			record.data = WriteArray(out, layer.getData());
+
+			std::vector<tson::Chunk> &chunks = layer.getChunks();
+			record.chunks = {out.allocate<ChunkRecord>(chunks.size()), static_cast<uint32_t>(chunks.size())};
+			for(size_t c = 0; c < chunks.size(); ++c)
 			{
-				tson::Tile *originalTile = m_tileMap[tile.getGid()];
-				tile.addTilesetAndPerformCalculations(originalTile->getTileset());
-				tile.setProperties(originalTile->getProperties());
-				m_flaggedTileMap[ftile] = tile;
-				m_tileMap[ftile] = &m_flaggedTileMap[ftile];
+				ChunkRecord chunk {chunks[c].getPosition().x, chunks[c].getPosition().y, chunks[c].getSize().x, chunks[c].getSize().y, {}};
+				std::vector<uint32_t> gids(chunks[c].getData().begin(), chunks[c].getData().end());
+				chunk.data = WriteArray(out, gids);
+				out.store(record.chunks.offset, c, chunk);
 			}
-		}
-		layer.resolveFlaggedTiles();
-	});
-}
-
-/*!
- * 'backgroundcolor': Color created from a hex-formatted color string (#RRGGBB or #AARRGGBB) (optional)
- * @return string as color
- */
-const tson::Colori &tson::Map::getBackgroundColor() const
-{
-	return m_backgroundColor;
-}
-
-/*!
- * 'width' and 'height' of a Tiled map
- * @return
- */
-const tson::Vector2<int> &tson::Map::getSize() const
-{
-	return m_size;
-}
 
-/*!
- * 'hexsidelength': Length of the side of a hex tile in pixels
- * @return
- */
-int tson::Map::getHexsideLength() const
-{
-	return m_hexsideLength;
-}
+			record.objects = WriteObjects(out, layer.getObjects());
+			record.layers = WriteLayers(out, layer.getLayers());
+			record.properties = WriteProperties(out, layer.getProperties());
+			out.store(table.offset, i, record);
+		}
+		return table;
+	}
 
-/*!
- * 'infinite': Whether the map has infinite dimensions
- * @return
- */
-bool tson::Map::isInfinite() const
-{
-	return m_isInfinite;
-}
+	FlatMap::Table FlatMap::WriteObjects(Writer &out, std::vector<tson::Object> &objects)
+	{
+		Table const table {out.allocate<ObjectRecord>(objects.size()), static_cast<uint32_t>(objects.size())};
+		for(size_t i = 0; i < objects.size(); ++i)
+		{
+			tson::Object &object = objects[i];
+			ObjectRecord record {};
+			record.id = object.getId();
+			record.objectType = static_cast<uint32_t>(object.getObjectType());
+			record.name = out.string(object.getName());
+			record.type = out.string(object.getType());
+			record.templ = out.string(object.getTemplate());
+			record.text = out.string(object.getText().text);
+			record.x = object.getPosition().x;
+			record.y = object.getPosition().y;
+			record.width = object.getSize().x;
+			record.height = object.getSize().y;
+			record.rotation = object.getRotation();
+			record.gid = object.getGid();
+			record.flipFlags = static_cast<uint32_t>(object.getFlipFlags());
+			record.flags = (object.isVisible() ? ObjectVisible : 0u) | (object.isEllipse() ? ObjectEllipse : 0u) | (object.isPoint() ? ObjectPoint : 0u);
+			record.polygon = WritePoints(out, object.getPolygons());
+			record.polyline = WritePoints(out, object.getPolylines());
+			record.properties = WriteProperties(out, object.getProperties());
+			out.store(table.offset, i, record);
+		}
+		return table;
+	}
 
-/*!
- * 'nextlayerid': Auto-increments for each layer
- * @return
- */
-int tson::Map::getNextLayerId() const
-{
-	return m_nextLayerId;
-}
+	FlatMap::Table FlatMap::WriteTilesets(Writer &out, std::vector<tson::Tileset> &tilesets)
+	{
+		Table const table {out.allocate<TilesetRecord>(tilesets.size()), static_cast<uint32_t>(tilesets.size())};
+		for(size_t i = 0; i < tilesets.size(); ++i)
+		{
+			tson::Tileset &tileset = tilesets[i];
+			TilesetRecord record {};
+			record.firstgid = tileset.getFirstgid();
+			record.type = static_cast<uint32_t>(tileset.getType());
+			record.name = out.string(tileset.getName());
+			record.image = out.string(tileset.getImage().generic_string());
+			record.fullImagePath = out.string(tileset.getFullImagePath().generic_string());
+			record.classType = out.string(tileset.getClassType());
+			record.imageWidth = tileset.getImageSize().x;
+			record.imageHeight = tileset.getImageSize().y;
+			record.tileWidth = tileset.getTileSize().x;
+			record.tileHeight = tileset.getTileSize().y;
+			record.tileCount = tileset.getTileCount();
+			record.columns = tileset.getColumns();
+			record.margin = tileset.getMargin();
+			record.spacing = tileset.getSpacing();
+			record.tileOffsetX = tileset.getTileOffset().x;
+			record.tileOffsetY = tileset.getTileOffset().y;
+			record.transparentColor = PackColor(tileset.getTransparentColor());
+			record.tiles = WriteTiles(out, tileset.getTiles());
+			record.properties = WriteProperties(out, tileset.getProperties());
+			out.store(table.offset, i, record);
+		}
+		return table;
+	}
 
-/*!
- * 'nextobjectid': Auto-increments for each placed object
- * @return
- */
-int tson::Map::getNextObjectId() const
-{
-	return m_nextObjectId;
-}
+	/*!
+	 * Writes the tiles that have more than their id, sorted by id so they can be binary searched
+	 */
+	FlatMap::Table FlatMap::WriteTiles(Writer &out, std::vector<tson::Tile> &tiles)
+	{
+		std::vector<tson::Tile *> stored;
+		for(auto &tile : tiles)
+		{
+			if(!tile.getImage().empty() || !tile.getClassType().empty() || tile.getAnimation().any() || tile.getProperties().getSize() > 0 ||
+			   !tile.getObjectgroup().getObjects().empty())
+				stored.push_back(&tile);
+		}
+		std::sort(stored.begin(), stored.end(), [](const tson::Tile *a, const tson::Tile *b) { return a->getId() < b->getId(); });
 
-/*!
- * 'orientation': orthogonal, isometric, staggered or hexagonal
- * @return
- */
-const std::string &tson::Map::getOrientation() const
-{
-	return m_orientation;
-}
+		Table const table {out.allocate<TileRecord>(stored.size()), static_cast<uint32_t>(stored.size())};
+		for(size_t i = 0; i < stored.size(); ++i)
+		{
+			tson::Tile &tile = *stored[i];
+			TileRecord record {};
+			record.id = tile.getId();
+			record.gid = tile.getGid();
+			record.image = out.string(tile.getImage().generic_string());
+			record.type = out.string(tile.getClassType());
+			record.imageWidth = tile.getImageSize().x;
+			record.imageHeight = tile.getImageSize().y;
+			record.subX = tile.getSubRectangle().x;
+			record.subY = tile.getSubRectangle().y;
+			record.subWidth = tile.getSubRectangle().width;
+			record.subHeight = tile.getSubRectangle().height;
+
+			std::vector<FrameRecord> frames;
+			for(const auto &frame : tile.getAnimation().getFrames())
+				frames.push_back({frame.getTileId(), frame.getDuration()});
+			record.animation = WriteArray(out, frames);
+			record.objects = WriteObjects(out, tile.getObjectgroup().getObjects());
+			record.properties = WriteProperties(out, tile.getProperties());
+			out.store(table.offset, i, record);
+		}
+		return table;
+	}
 
-/*!
- * 'renderorder': Rendering direction (orthogonal maps only)
- * @return
- */
-const std::string &tson::Map::getRenderOrder() const
-{
-	return m_renderOrder;
-}
+	/*!
+	 * Writes properties sorted by name, so they can be binary searched
+	 */
+	FlatMap::Table FlatMap::WriteProperties(Writer &out, tson::PropertyCollection &properties)
+	{
+		std::map<std::string, tson::Property> &values = properties.getProperties();
+		Table const table {out.allocate<PropertyRecord>(values.size()), static_cast<uint32_t>(values.size())};
+		size_t i = 0;
+		for(auto &[name, property] : values)
+		{
+			PropertyRecord record {};
+			record.name = out.string(name);
+			record.type = static_cast<uint32_t>(property.getType());
+			record.propertyType = out.string(property.getPropertyType());
+			WriteValue(out, property.getValue(), record);
+			out.store(table.offset, i++, record);
+		}
+		return table;
+	}
 
-/*!
- * 'staggeraxis': x or y (staggered / hexagonal maps only)
- * @return
- */
-const std::string &tson::Map::getStaggerAxis() const
-{
-	return m_staggerAxis;
-}
+	FlatMap::Table FlatMap::WritePoints(Writer &out, const std::vector<tson::Vector2i> &points)
+	{
+		std::vector<PointRecord> records;
+		records.reserve(points.size());
+		for(const auto &point : points)
+			records.push_back({point.x, point.y});
+		return WriteArray(out, records);
+	}
 
-/*!
- * 'staggerindex': odd or even (staggered / hexagonal maps only)
- * @return
- */
-const std::string &tson::Map::getStaggerIndex() const
-{
-	return m_staggerIndex;
-}
+	template<typename T>
+	FlatMap::Table FlatMap::WriteArray(Writer &out, const std::vector<T> &values)
+	{
+		Table const table {out.allocate<T>(values.size()), static_cast<uint32_t>(values.size())};
+		if(!values.empty())
+			std::memcpy(out.data.data() + table.offset, values.data(), values.size() * sizeof(T));
+		return table;
+	}
 
-/*!
- * 'tiledversion': The Tiled version used to save the file
- * @return
- */
-const std::string &tson::Map::getTiledVersion() const
-{
-	return m_tiledVersion;
+	void FlatMap::WriteValue(Writer &out, const std::any &value, PropertyRecord &record)
+	{
+		const std::type_info &type = value.type();
+		ValueKind kind = ValueKind::None;
+		if(type == typeid(int))
+		{
+			kind = ValueKind::Int;
+			record.value = static_cast<uint32_t>(std::any_cast<int>(value));
+		}
+		else if(type == typeid(uint32_t))
+		{
+			kind = ValueKind::UInt;
+			record.value = std::any_cast<uint32_t>(value);
+		}
+		else if(type == typeid(bool))
+		{
+			kind = ValueKind::Bool;
+			record.value = std::any_cast<bool>(value) ? 1 : 0;
+		}
+		else if(type == typeid(float))
+		{
+			kind = ValueKind::Float;
+			float const f = std::any_cast<float>(value);
+			std::memcpy(&record.value, &f, sizeof(f));
+		}
+		else if(type == typeid(std::string))
+		{
+			kind = ValueKind::String;
+			record.string = out.string(std::any_cast<const std::string &>(value));
+		}
+		else if(type == typeid(fs::path))
+		{
+			kind = ValueKind::Path;
+			record.string = out.string(std::any_cast<const fs::path &>(value).generic_string());
+		}
+		else if(type == typeid(tson::Colori))
+		{
+			kind = ValueKind::Color;
+			record.value = PackColor(std::any_cast<const tson::Colori &>(value));
+		}
+		else if(type == typeid(tson::EnumValue))
+		{
+			const auto &enumValue = std::any_cast<const tson::EnumValue &>(value);
+			kind = ValueKind::Enum;
+			record.value = enumValue.getValue();
+			record.string = out.string(enumValue.getValueName());
+		}
+		else if(type == typeid(tson::TiledClass))
+		{
+			kind = ValueKind::Class;
+			tson::TiledClass tiledClass = std::any_cast<tson::TiledClass>(value);
+			record.string = out.string(tiledClass.getName());
+			record.members = WriteProperties(out, tiledClass.getMembers());
+		}
+		record.kind = static_cast<uint32_t>(kind);
+	}
 }
 
-/*!
- * 'tilewidth': and 'tileheight' of a map
- * @return
- */
-const tson::Vector2<int> &tson::Map::getTileSize() const
-{
-	return m_tileSize;
-}
+#endif //TILESON_FLATMAP_HPP
 
-/*!
- * 'type': map (since 1.0)
- * @return
- */
-const std::string &tson::Map::getType() const
-{
-	return m_type;
-}
+/*** End of inlined file: FlatMap.hpp ***/
 
-/*!
- * 'version': The JSON format version
- * @return
- */
-//int tson::Map::getVersion() const
-//{
-//    return m_version;
-//}
 
-/*!
- * 'layers': Array of layers. group on
- * @return
- */
-std::vector<tson::Layer> &tson::Map::getLayers()
-{
-	return m_layers;
-}
+/*** Start of inlined file: MapView.hpp ***/
+#ifndef TILESON_MAPVIEW_HPP
+#define TILESON_MAPVIEW_HPP
 
-/*!
- * 'properties': A list of properties (name, value, type).
- * @return
- */
-tson::PropertyCollection &tson::Map::getProperties()
-{
-	return m_properties;
-}
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
 
-/*!
- * 'tilesets': Array of Tilesets
- * @return
- */
-std::vector<tson::Tileset> &tson::Map::getTilesets()
+namespace tson
 {
-	return m_tilesets;
-}
+	/*!
+	 * The records of a table in a flat map, as views. Views are created when they are accessed.
+	 * @tparam View A view with a 'Record' type, constructed from the data and a record
+	 */
+	template <typename View>
+	class TableView
+	{
+		public:
+			using Record = typename View::Record;
 
-tson::Layer *tson::Map::getLayer(const std::string &name)
-{
-	auto result = std::find_if(m_layers.begin(), m_layers.end(), [&](const tson::Layer &item) { return item.getName() == name; });
-	if(result == m_layers.end())
-		return nullptr;
+			class Iterator
+			{
+				public:
+					using iterator_category = std::forward_iterator_tag;
+					using value_type = View;
+					using difference_type = std::ptrdiff_t;
+					using pointer = void;
+					using reference = View;
+
+					inline Iterator(const TableView *table, size_t index) : m_table {table}, m_index {index} {}
+					inline View operator*() const { return (*m_table)[m_index]; }
+					inline Iterator &operator++() { ++m_index; return *this; }
+					inline Iterator operator++(int) { Iterator it = *this; ++m_index; return it; }
+					inline bool operator==(const Iterator &other) const { return m_index == other.m_index && m_table == other.m_table; }
+					inline bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+				private:
+					const TableView *m_table;
+					size_t m_index;
+			};
 
-	return &result.operator*();
-}
+			inline TableView() = default;
+			inline TableView(const FlatMap::Data &data, const FlatMap::Table &table) : m_data {data}, m_table {table}, m_size {data.count<Record>(table)} {}
 
-/*!
- * Gets a tileset by name
- *
- * @param name Name of the tileset
- * @return tileset with the matching name
- */
-tson::Tileset *tson::Map::getTileset(const std::string &name)
-{
-	auto result = std::find_if(m_tilesets.begin(), m_tilesets.end(), [&](const tson::Tileset &item) {return item.getName() == name; });
-	if(result == m_tilesets.end())
-		return nullptr;
+			[[nodiscard]] inline size_t size() const { return m_size; }
+			[[nodiscard]] inline bool empty() const { return m_size == 0; }
+			inline View operator[](size_t index) const { return View(m_data, m_data.record<Record>(m_table, index)); }
+			[[nodiscard]] inline Iterator begin() const { return Iterator(this, 0); }
+			[[nodiscard]] inline Iterator end() const { return Iterator(this, m_size); }
 
-	return &result.operator*();
-}
+		private:
+			FlatMap::Data m_data;
+			FlatMap::Table m_table {};
+			size_t m_size {0};
+	};
 
-/*!
- * Gets a tileset by gid (graphical ID of a tile). These are always unique, no matter how many tilesets you have
- *
- * @param gid Graphical ID of a tile
- * @return tileset related to the actual gid
- */
-tson::Tileset *tson::Map::getTilesetByGid(uint32_t gid)
-{
-	auto result = std::find_if(m_tilesets.begin(), m_tilesets.end(), [&](const tson::Tileset &tileset)
+	/*!
+	 * A property in a flat map. Like tson::Property, but the value is read with the getter of its type.
+	 */
+	class PropertyView
 	{
-		auto const firstId = static_cast<uint32_t>(tileset.getFirstgid()); //First tile id of the tileset
-		auto const lastId =  static_cast<uint32_t>((firstId + tileset.getTileCount()) - 1);
+		public:
+			using Record = FlatMap::PropertyRecord;
 
-		return (gid >= firstId && gid <= lastId);
-	});
-	if(result == m_tilesets.end())
-		return nullptr;
+			inline PropertyView() = default;
+			inline PropertyView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
 
-	return &result.operator*();
-}
+			inline static PropertyView Find(const TableView<PropertyView> &properties, std::string_view name);
 
-/*!
- * Shortcut for getting a property object. Alternative to getProperties().getProperty("<name>");
- * @param name Name of the property
- * @return
- */
-tson::Property *tson::Map::getProp(const std::string &name)
-{
-	if(m_properties.hasProperty(name))
-		return m_properties.getProperty(name);
-	return nullptr;
-}
+			[[nodiscard]] inline bool isValid() const { return m_valid; }
+			[[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+			[[nodiscard]] inline tson::Type getType() const { return static_cast<tson::Type>(m_record.type); }
+			[[nodiscard]] inline std::string_view getPropertyType() const { return m_data.string(m_record.propertyType); }
+			[[nodiscard]] inline FlatMap::ValueKind getValueKind() const { return static_cast<FlatMap::ValueKind>(m_record.kind); }
 
-tson::ParseStatus tson::Map::getStatus() const
-{
-	return m_status;
-}
+			[[nodiscard]] inline int getInt() const { return static_cast<int>(m_record.value); }
+			[[nodiscard]] inline uint32_t getUInt() const { return m_record.value; }
+			[[nodiscard]] inline bool getBool() const { return m_record.value != 0; }
+			[[nodiscard]] inline float getFloat() const;
+			[[nodiscard]] inline tson::Colori getColor() const { return FlatMap::UnpackColor(m_record.value); }
+			[[nodiscard]] inline std::string_view getString() const { return m_data.string(m_record.string); }
+			[[nodiscard]] inline uint32_t getEnumValue() const { return m_record.value; }
 
-const std::string &tson::Map::getStatusMessage() const
-{
-	return m_statusMessage;
-}
+			[[nodiscard]] inline TableView<PropertyView> getMembers() const { return {m_data, m_record.members}; }
+			[[nodiscard]] inline PropertyView getMember(std::string_view name) const { return Find(getMembers(), name); }
 
-/*!
- * Get a tile map with pointers to every existing tile.
- * @return
- */
-const std::map<uint32_t, tson::Tile *> &tson::Map::getTileMap() const
-{
-	return m_tileMap;
-}
+		private:
+			FlatMap::Data m_data;
+			Record m_record {};
+			bool m_valid {false};
+	};
 
-tson::DecompressorContainer *tson::Map::getDecompressors()
-{
-	return m_decompressors;
-}
+	/*!
+	 * An object in a flat map
+	 */
+	class ObjectView
+	{
+		public:
+			using Record = FlatMap::ObjectRecord;
+
+			inline ObjectView() = default;
+			inline ObjectView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+			[[nodiscard]] inline bool isValid() const { return m_valid; }
+			[[nodiscard]] inline int getId() const { return m_record.id; }
+			[[nodiscard]] inline tson::ObjectType getObjectType() const { return static_cast<tson::ObjectType>(m_record.objectType); }
+			[[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+			[[nodiscard]] inline std::string_view getType() const { return m_data.string(m_record.type); }
+			[[nodiscard]] inline std::string_view getClassType() const { return getType(); }
+			[[nodiscard]] inline std::string_view getTemplate() const { return m_data.string(m_record.templ); }
+			[[nodiscard]] inline std::string_view getText() const { return m_data.string(m_record.text); }
+			[[nodiscard]] inline tson::Vector2i getPosition() const { return {m_record.x, m_record.y}; }
+			[[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+			[[nodiscard]] inline float getRotation() const { return m_record.rotation; }
+			[[nodiscard]] inline uint32_t getGid() const { return m_record.gid; }
+			[[nodiscard]] inline tson::TileFlipFlags getFlipFlags() const { return static_cast<tson::TileFlipFlags>(m_record.flipFlags); }
+			[[nodiscard]] inline bool isVisible() const { return (m_record.flags & FlatMap::ObjectVisible) != 0; }
+			[[nodiscard]] inline bool isEllipse() const { return (m_record.flags & FlatMap::ObjectEllipse) != 0; }
+			[[nodiscard]] inline bool isPoint() const { return (m_record.flags & FlatMap::ObjectPoint) != 0; }
+			[[nodiscard]] inline std::vector<tson::Vector2i> getPolygons() const { return getPoints(m_record.polygon); }
+			[[nodiscard]] inline std::vector<tson::Vector2i> getPolylines() const { return getPoints(m_record.polyline); }
+
+			[[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+			[[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
 
-/*!
- * 'compressionlevel': The compression level to use for tile layer data (defaults to -1, which means to use the algorithm default)
- *
- * @return The compression level
- */
-int tson::Map::getCompressionLevel() const
-{
-	return m_compressionLevel;
-}
+		private:
+			inline std::vector<tson::Vector2i> getPoints(const FlatMap::Table &table) const;
 
-/*!
- * New in Tiled v1.8
- * Gets the parallax origin in pixels. Defaults to 0.
- * @return A vector with the x and y values of the parallax origin.
- */
-const tson::Vector2f &tson::Map::getParallaxOrigin() const
-{
-	return m_parallaxOrigin;
-}
+			FlatMap::Data m_data;
+			Record m_record {};
+			bool m_valid {false};
+	};
+
+	/*!
+	 * A chunk of a tile layer of an infinite map
+	 */
+	class ChunkView
+	{
+		public:
+			using Record = FlatMap::ChunkRecord;
+
+			inline ChunkView() = default;
+			inline ChunkView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record} {}
+
+			[[nodiscard]] inline tson::Vector2i getPosition() const { return {m_record.x, m_record.y}; }
+			[[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+			[[nodiscard]] inline size_t getDataSize() const { return m_data.count<uint32_t>(m_record.data); }
+			[[nodiscard]] inline uint32_t getGid(size_t index) const { return m_data.record<uint32_t>(m_record.data, index); }
+
+		private:
+			FlatMap::Data m_data;
+			Record m_record {};
+	};
 
-tson::Project *tson::Map::getProject()
-{
-	return m_project;
-}
+	/*!
+	 * A layer in a flat map. The gids are read directly from the mapped data.
+	 */
+	class LayerView
+	{
+		public:
+			using Record = FlatMap::LayerRecord;
+
+			inline LayerView() = default;
+			inline LayerView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+			[[nodiscard]] inline bool isValid() const { return m_valid; }
+			[[nodiscard]] inline int getId() const { return m_record.id; }
+			[[nodiscard]] inline tson::LayerType getType() const { return static_cast<tson::LayerType>(m_record.type); }
+			[[nodiscard]] inline std::string_view getTypeStr() const { return m_data.string(m_record.typeStr); }
+			[[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+			[[nodiscard]] inline std::string_view getClassType() const { return m_data.string(m_record.classType); }
+			[[nodiscard]] inline std::string_view getImage() const { return m_data.string(m_record.image); }
+			[[nodiscard]] inline std::string_view getDrawOrder() const { return m_data.string(m_record.drawOrder); }
+			[[nodiscard]] inline int getX() const { return m_record.x; }
+			[[nodiscard]] inline int getY() const { return m_record.y; }
+			[[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+			[[nodiscard]] inline tson::Vector2f getOffset() const { return {m_record.offsetX, m_record.offsetY}; }
+			[[nodiscard]] inline float getOpacity() const { return m_record.opacity; }
+			[[nodiscard]] inline tson::Vector2f getParallax() const { return {m_record.parallaxX, m_record.parallaxY}; }
+			[[nodiscard]] inline bool isVisible() const { return (m_record.flags & FlatMap::LayerVisible) != 0; }
+			[[nodiscard]] inline bool hasTintColor() const { return (m_record.flags & FlatMap::LayerHasTintColor) != 0; }
+			[[nodiscard]] inline bool hasRepeatX() const { return (m_record.flags & FlatMap::LayerRepeatX) != 0; }
+			[[nodiscard]] inline bool hasRepeatY() const { return (m_record.flags & FlatMap::LayerRepeatY) != 0; }
+			[[nodiscard]] inline bool hasRegion() const { return (m_record.flags & FlatMap::LayerHasRegion) != 0; }
+			[[nodiscard]] inline tson::Vector2i getRegionOrigin() const { return {m_record.regionX, m_record.regionY}; }
+			[[nodiscard]] inline tson::Colori getTintColor() const { return FlatMap::UnpackColor(m_record.tintColor); }
+			[[nodiscard]] inline tson::Colori getTransparentColor() const { return FlatMap::UnpackColor(m_record.transparentColor); }
+
+			[[nodiscard]] inline size_t getDataSize() const { return m_data.count<uint32_t>(m_record.data); }
+			[[nodiscard]] inline uint32_t getGid(size_t index) const { return m_data.record<uint32_t>(m_record.data, index); }
+			[[nodiscard]] inline uint32_t getGid(int x, int y) const;
+
+			[[nodiscard]] inline TableView<ChunkView> getChunks() const { return {m_data, m_record.chunks}; }
+			[[nodiscard]] inline TableView<ObjectView> getObjects() const { return {m_data, m_record.objects}; }
+			[[nodiscard]] inline TableView<LayerView> getLayers() const { return {m_data, m_record.layers}; }
+			[[nodiscard]] inline ObjectView firstObj(std::string_view name) const;
+			[[nodiscard]] inline LayerView getLayer(std::string_view name) const;
+
+			[[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+			[[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
 
-const std::string &tson::Map::getClassType() const
-{
-	return m_classType;
-}
+		private:
+			FlatMap::Data m_data;
+			Record m_record {};
+			bool m_valid {false};
+	};
 
-#endif //TILESON_MAP_HPP
+	/*!
+	 * A tile of a tileset in a flat map. Only exists for tiles with more data than their id.
+	 */
+	class TileView
+	{
+		public:
+			using Record = FlatMap::TileRecord;
 
-/*** End of inlined file: Map.hpp ***/
+			inline TileView() = default;
+			inline TileView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
 
+			[[nodiscard]] inline bool isValid() const { return m_valid; }
+			[[nodiscard]] inline uint32_t getId() const { return m_record.id; }
+			[[nodiscard]] inline uint32_t getGid() const { return m_record.gid; }
+			[[nodiscard]] inline std::string_view getImage() const { return m_data.string(m_record.image); }
+			[[nodiscard]] inline std::string_view getType() const { return m_data.string(m_record.type); }
+			[[nodiscard]] inline std::string_view getClassType() const { return getType(); }
+			[[nodiscard]] inline tson::Vector2i getImageSize() const { return {m_record.imageWidth, m_record.imageHeight}; }
+			[[nodiscard]] inline tson::Rect getSubRectangle() const { return {m_record.subX, m_record.subY, m_record.subWidth, m_record.subHeight}; }
+			[[nodiscard]] inline std::vector<tson::Frame> getFrames() const;
+			[[nodiscard]] inline TableView<ObjectView> getObjects() const { return {m_data, m_record.objects}; }
 
-/*** Start of inlined file: TiledEnum.hpp ***/
-//
-// Created by robin on 06.06.22.
-//
+			[[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+			[[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
 
-#ifndef TILESON_TILEDENUM_HPP
-#define TILESON_TILEDENUM_HPP
+		private:
+			FlatMap::Data m_data;
+			Record m_record {};
+			bool m_valid {false};
+	};
 
-namespace tson
-{
-	class EnumDefinition
+	/*!
+	 * A tileset in a flat map
+	 */
+	class TilesetView
 	{
 		public:
-			inline explicit EnumDefinition(IJson &json);
-			inline uint32_t getValue(const std::string &str);
-			inline std::string getValue(uint32_t num);
-			inline std::vector<std::string> getValues(uint32_t num);
-			inline bool exists(const std::string &str);
-			inline bool exists(uint32_t num);
-
-			[[nodiscard]] inline uint32_t getId() const;
-			[[nodiscard]] inline uint32_t getMaxValue() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline EnumStorageType getStorageType() const;
-			[[nodiscard]] inline bool hasValuesAsFlags() const;
+			using Record = FlatMap::TilesetRecord;
+
+			inline TilesetView() = default;
+			inline TilesetView(const FlatMap::Data &data, const Record &record) : m_data {data}, m_record {record}, m_valid {true} {}
+
+			[[nodiscard]] inline bool isValid() const { return m_valid; }
+			[[nodiscard]] inline int getFirstgid() const { return m_record.firstgid; }
+			[[nodiscard]] inline tson::TilesetType getType() const { return static_cast<tson::TilesetType>(m_record.type); }
+			[[nodiscard]] inline std::string_view getName() const { return m_data.string(m_record.name); }
+			[[nodiscard]] inline std::string_view getImage() const { return m_data.string(m_record.image); }
+			[[nodiscard]] inline std::string_view getFullImagePath() const { return m_data.string(m_record.fullImagePath); }
+			[[nodiscard]] inline std::string_view getClassType() const { return m_data.string(m_record.classType); }
+			[[nodiscard]] inline tson::Vector2i getImageSize() const { return {m_record.imageWidth, m_record.imageHeight}; }
+			[[nodiscard]] inline tson::Vector2i getTileSize() const { return {m_record.tileWidth, m_record.tileHeight}; }
+			[[nodiscard]] inline int getTileCount() const { return m_record.tileCount; }
+			[[nodiscard]] inline int getColumns() const { return m_record.columns; }
+			[[nodiscard]] inline int getMargin() const { return m_record.margin; }
+			[[nodiscard]] inline int getSpacing() const { return m_record.spacing; }
+			[[nodiscard]] inline tson::Vector2i getTileOffset() const { return {m_record.tileOffsetX, m_record.tileOffsetY}; }
+			[[nodiscard]] inline tson::Colori getTransparentColor() const { return FlatMap::UnpackColor(m_record.transparentColor); }
+
+			[[nodiscard]] inline TableView<TileView> getTiles() const { return {m_data, m_record.tiles}; }
+			[[nodiscard]] inline TileView getTile(uint32_t id) const;
+
+			[[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+			[[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
 
 		private:
-			inline bool hasFlag(uint32_t value, uint32_t flag) const;
-			uint32_t m_id {};
-			uint32_t m_maxValue {};
-			std::string m_name {};
-			std::map<uint32_t, std::string> m_values {};
-			bool m_valuesAsFlags {false};
-			EnumStorageType m_storageType { EnumStorageType::Unspecified };
+			FlatMap::Data m_data;
+			Record m_record {};
+			bool m_valid {false};
 	};
 
-	EnumDefinition::EnumDefinition(IJson &json)
+	/*!
+	 * A flat map (tson::FlatMap), used where it is in memory. Nothing is copied or allocated when it is opened:
+	 * Every view reads its record when it is accessed.
+	 *
+	 * The view does not own the memory, which must outlive the view and every view created from it.
+	 *
+	 * Example:
+	 * tson::MappedFile file {"map.tsonf"};
+	 * tson::MapView map {file.data(), file.size()};
+	 * if(map.isValid())
+	 * {
+	 *     for(tson::LayerView layer : map.getLayers())
+	 *         ...
+	 * }
+	 */
+	class MapView
 	{
-		m_id = json.get<uint32_t>("id");
-		m_name = json.get<std::string>("name");
-		std::string type = json.get<std::string>("storageType");
-		m_storageType = (type == "int") ? EnumStorageType::Int : (type == "string") ? EnumStorageType::String : EnumStorageType::Unspecified;
-		m_valuesAsFlags = json.get<bool>("valuesAsFlags");
+		public:
+			inline MapView() = default;
+			inline MapView(const void *data, size_t size);
+
+			[[nodiscard]] inline bool isValid() const { return m_valid; }
+			[[nodiscard]] inline tson::Vector2i getSize() const { return {m_record.width, m_record.height}; }
+			[[nodiscard]] inline tson::Vector2i getTileSize() const { return {m_record.tileWidth, m_record.tileHeight}; }
+			[[nodiscard]] inline std::string_view getOrientation() const { return m_data.string(m_record.orientation); }
+			[[nodiscard]] inline std::string_view getRenderOrder() const { return m_data.string(m_record.renderOrder); }
+			[[nodiscard]] inline std::string_view getStaggerAxis() const { return m_data.string(m_record.staggerAxis); }
+			[[nodiscard]] inline std::string_view getStaggerIndex() const { return m_data.string(m_record.staggerIndex); }
+			[[nodiscard]] inline std::string_view getTiledVersion() const { return m_data.string(m_record.tiledVersion); }
+			[[nodiscard]] inline std::string_view getType() const { return m_data.string(m_record.type); }
+			[[nodiscard]] inline std::string_view getClassType() const { return m_data.string(m_record.classType); }
+			[[nodiscard]] inline bool isInfinite() const { return m_record.infinite != 0; }
+			[[nodiscard]] inline tson::Colori getBackgroundColor() const { return FlatMap::UnpackColor(m_record.backgroundColor); }
+			[[nodiscard]] inline int getHexsideLength() const { return m_record.hexsideLength; }
+			[[nodiscard]] inline int getNextLayerId() const { return m_record.nextLayerId; }
+			[[nodiscard]] inline int getNextObjectId() const { return m_record.nextObjectId; }
+			[[nodiscard]] inline tson::Vector2f getParallaxOrigin() const { return {m_record.parallaxOriginX, m_record.parallaxOriginY}; }
+
+			[[nodiscard]] inline TableView<LayerView> getLayers() const { return {m_data, m_record.layers}; }
+			[[nodiscard]] inline LayerView getLayer(std::string_view name) const;
+			[[nodiscard]] inline TableView<TilesetView> getTilesets() const { return {m_data, m_record.tilesets}; }
+			[[nodiscard]] inline TilesetView getTileset(std::string_view name) const;
+			[[nodiscard]] inline TilesetView getTilesetByGid(uint32_t gid) const;
+
+			[[nodiscard]] inline TableView<PropertyView> getProperties() const { return {m_data, m_record.properties}; }
+			[[nodiscard]] inline PropertyView getProp(std::string_view name) const { return PropertyView::Find(getProperties(), name); }
 
-		if(json.count("values") > 0 && json["values"].isArray())
-		{
-			m_values[0] = "None";
-			uint32_t valueCounter = (m_valuesAsFlags) ? 1 : 0;
-			uint8_t flagBit = 1;
-			auto &array = json.array("values");
-			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
-			{
-				std::string v = item->get<std::string>();
-				m_values[valueCounter] = v;
-				if(m_valuesAsFlags)
-				{
-					valueCounter = 1 << flagBit;
-					++flagBit;
-				}
-				else
-				{
-					++valueCounter;
-				}
-			});
+		private:
+			FlatMap::Data m_data;
+			FlatMap::MapRecord m_record {};
+			bool m_valid {false};
+	};
 
-			m_maxValue = valueCounter;
+	/*!
+	 * Finds a property by name. Properties are sorted by name, so this is a binary search.
+	 * @return The property. Not valid if it does not exist.
+	 */
+	PropertyView PropertyView::Find(const TableView<PropertyView> &properties, std::string_view name)
+	{
+		size_t first = 0;
+		size_t last = properties.size();
+		while(first < last)
+		{
+			size_t const middle = first + (last - first) / 2;
+			PropertyView property = properties[middle];
+			std::string_view const current = property.getName();
+			if(current == name)
+				return property;
+			if(current < name)
+				first = middle + 1;
+			else
+				last = middle;
 		}
+		return {};
 	}
 
-	uint32_t EnumDefinition::getValue(const std::string &str)
+	float PropertyView::getFloat() const
 	{
-		auto result = std::find_if(m_values.begin(), m_values.end(), [&](const std::pair<uint32_t, std::string> &pair)
-		{
-			return pair.second == str;
-		});
-
-		if(result != m_values.end())
-			return result->first;
-
-		return 0;
+		float value;
+		std::memcpy(&value, &m_record.value, sizeof(value));
+		return value;
 	}
 
-	std::string EnumDefinition::getValue(uint32_t num)
+	std::vector<tson::Vector2i> ObjectView::getPoints(const FlatMap::Table &table) const
 	{
-		return (m_values.count(num) > 0) ? m_values[num] : "";
+		size_t const count = m_data.count<FlatMap::PointRecord>(table);
+		std::vector<tson::Vector2i> points;
+		points.reserve(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			auto const point = m_data.record<FlatMap::PointRecord>(table, i);
+			points.emplace_back(point.x, point.y);
+		}
+		return points;
 	}
 
-	bool EnumDefinition::hasValuesAsFlags() const
+	/*!
+	 * The gid at a tile position in the map, flip flags included. 0 if the position is outside the layer,
+	 * or outside the decoded region when hasRegion() is true.
+	 */
+	uint32_t LayerView::getGid(int x, int y) const
 	{
-		return m_valuesAsFlags;
+		x -= m_record.regionX;
+		y -= m_record.regionY;
+		if(x < 0 || y < 0 || x >= m_record.width || y >= m_record.height)
+			return 0;
+		return getGid(static_cast<size_t>(y) * static_cast<size_t>(m_record.width) + static_cast<size_t>(x));
 	}
 
-	bool EnumDefinition::exists(const std::string &str)
+	/*!
+	 * The first object with a name. Not valid if there is none.
+	 */
+	ObjectView LayerView::firstObj(std::string_view name) const
 	{
-		auto result = std::find_if(m_values.begin(), m_values.end(), [&](const std::pair<uint32_t, std::string> &pair)
+		for(ObjectView object : getObjects())
 		{
-			return pair.second == str;
-		});
-
-		if(result != m_values.end())
-			return true;
-
-		return false;
+			if(object.getName() == name)
+				return object;
+		}
+		return {};
 	}
 
-	bool EnumDefinition::exists(uint32_t num) { return (m_values.count(num) > 0); }
-
-	uint32_t EnumDefinition::getId() const
+	/*!
+	 * A child layer of a group layer, by name. Not valid if there is none.
+	 */
+	LayerView LayerView::getLayer(std::string_view name) const
 	{
-		return m_id;
+		for(LayerView layer : getLayers())
+		{
+			if(layer.getName() == name)
+				return layer;
+		}
+		return {};
 	}
 
-	const std::string &EnumDefinition::getName() const
+	/*!
+	 * The animation of the tile, copied to tson::Frames
+	 */
+	std::vector<tson::Frame> TileView::getFrames() const
 	{
-		return m_name;
+		size_t const count = m_data.count<FlatMap::FrameRecord>(m_record.animation);
+		std::vector<tson::Frame> frames;
+		frames.reserve(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			auto const frame = m_data.record<FlatMap::FrameRecord>(m_record.animation, i);
+			frames.emplace_back(frame.duration, frame.tileId);
+		}
+		return frames;
 	}
 
-	EnumStorageType EnumDefinition::getStorageType() const
+	/*!
+	 * A tile by id (the local id + 1, like tson::Tileset::getTile()). Tiles are sorted by id, so this is a binary search.
+	 * @return The tile. Not valid if the tile has no data other than its id.
+	 */
+	TileView TilesetView::getTile(uint32_t id) const
 	{
-		return m_storageType;
+		TableView<TileView> tiles = getTiles();
+		size_t first = 0;
+		size_t last = tiles.size();
+		while(first < last)
+		{
+			size_t const middle = first + (last - first) / 2;
+			TileView tile = tiles[middle];
+			if(tile.getId() == id)
+				return tile;
+			if(tile.getId() < id)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		return {};
 	}
 
-	uint32_t EnumDefinition::getMaxValue() const
+	/*!
+	 * Opens a flat map in memory
+	 * @param data The flat map. Must outlive the view.
+	 * @param size Size of the data
+	 */
+	MapView::MapView(const void *data, size_t size)
 	{
-		return m_maxValue;
+		FlatMap::Header header {};
+		if(!FlatMap::ReadHeader(data, size, header))
+			return;
+
+		m_data = FlatMap::Data(static_cast<const uint8_t *>(data), header.size, header.strings, header.stringsSize);
+		m_record = m_data.record<FlatMap::MapRecord>(header.map);
+		m_valid = true;
 	}
 
-	std::vector<std::string> EnumDefinition::getValues(uint32_t num)
+	/*!
+	 * A layer by name. Not valid if there is none.
+	 */
+	LayerView MapView::getLayer(std::string_view name) const
 	{
-		std::vector<std::string> values;
-		if(m_valuesAsFlags)
-		{
-			uint32_t flag = 0;
-			uint32_t i = 0;
-			while(flag < m_maxValue)
-			{
-				flag = 1 << i;
-				++i;
-				if(m_values.count(flag) > 0 && hasFlag(num, flag))
-				{
-					values.emplace_back(m_values[flag]);
-				}
-			}
-		}
-		else
+		for(LayerView layer : getLayers())
 		{
-			std::string v = getValue(num);
-			if(!v.empty())
-				values.emplace_back();
+			if(layer.getName() == name)
+				return layer;
 		}
-
-		return values;
+		return {};
 	}
 
-	bool EnumDefinition::hasFlag(uint32_t value, uint32_t flag) const
+	/*!
+	 * A tileset by name. Not valid if there is none.
+	 */
+	TilesetView MapView::getTileset(std::string_view name) const
 	{
-		return ((value & flag) == flag);
+		for(TilesetView tileset : getTilesets())
+		{
+			if(tileset.getName() == name)
+				return tileset;
+		}
+		return {};
 	}
 
-	class EnumValue
+	/*!
+	 * The tileset a gid (without flip flags) belongs to. Not valid if there is none.
+	 */
+	TilesetView MapView::getTilesetByGid(uint32_t gid) const
 	{
-		public:
-			inline EnumValue() = default;
-			inline EnumValue(uint32_t value, EnumDefinition *definition);
-			inline EnumValue(const std::string &value, EnumDefinition *definition);
+		for(TilesetView tileset : getTilesets())
+		{
+			auto const firstId = static_cast<uint32_t>(tileset.getFirstgid());
+			auto const lastId = static_cast<uint32_t>(firstId + tileset.getTileCount()) - 1;
+			if(gid >= firstId && gid <= lastId)
+				return tileset;
+		}
+		return {};
+	}
+}
 
-			[[nodiscard]] inline uint32_t getValue() const;
-			inline std::string getValueName() const;
-			[[nodiscard]] inline std::vector<std::string> getValueNames() const;
-			[[nodiscard]] inline EnumDefinition *getDefinition() const;
+#endif //TILESON_MAPVIEW_HPP
 
-			inline bool hasFlagValue(uint32_t flag) const;
-			template <typename T>
-			inline bool hasFlag(T flags) const;
-			inline bool hasAnyFlagValue(uint32_t flags) const;
-			template <typename T>
-			inline bool hasAnyFlag(T flags) const;
-			[[nodiscard]] inline bool containsValueName(const std::string &value) const;
+/*** End of inlined file: MapView.hpp ***/
 
-		private:
-			uint32_t m_value {0};
-			EnumDefinition *m_definition = nullptr;
-	};
 
-	EnumValue::EnumValue(uint32_t value, EnumDefinition *definition) : m_value {value}, m_definition {definition}
-	{
+/*** Start of inlined file: Archive.hpp ***/
+#ifndef TILESON_ARCHIVE_HPP
+#define TILESON_ARCHIVE_HPP
 
-	}
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
-	EnumValue::EnumValue(const std::string &value, EnumDefinition *definition) : m_definition {definition}
-	{
-		if(!value.empty() && definition != nullptr)
-		{
-			std::vector<std::string> values = Tools::SplitString(value, ',');
-			for(auto &item : values)
-			{
-				uint32_t v = definition->getValue(item);
-				m_value |= v;
-			}
-		}
-	}
+namespace tson
+{
+	/*!
+	 * Compresses the content of one archive entry. Returns an empty vector if it could not be compressed.
+	 */
+	using ArchiveCompressor = std::function<std::vector<uint8_t>(const std::vector<uint8_t> &input)>;
 
 	/*!
-	 * Checks if uint32 value contains a single flag. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
-	 * instead.
-	 * @param flags The uint32 value of the flag you want to check
-	 * @return 'true' if EnumValue has the requested bit activated. 'false' otherwise.
+	 * A packed archive (.tsonpak) of Tiled files: maps, tilesets, templates, worlds and projects, read without opening each file.
+	 *
+	 * The archive has a central index of paths, sorted so a path is found with a binary search, pointing to blobs of content.
+	 * Files with the same content, like a tileset or a template copied to several folders, share one blob. Each blob is compressed
+	 * on its own, so any file is read without decompressing the others.
+	 *
+	 * tson::Tileson, tson::World and tson::Project load files from the archive. Linked files (external tilesets and templates)
+	 * are read from the archive through the tson::LinkedFileParser of the map, relative to the map.
+	 *
+	 * Every const function is thread safe, so one archive can be read by many threads at once. Decompressors must be added before
+	 * the archive is shared, and must be safe to call from several threads (tson::Lzma is).
+	 *
+	 * Example:
+	 * tson::Archive archive {"maps.tsonpak"};
+	 * tson::Tileson t;
+	 * std::unique_ptr<tson::Map> map = t.parse(archive, "maps/level1.json");
 	 */
-	bool EnumValue::hasFlagValue(uint32_t flags) const
+	class Archive
 	{
-		if(m_definition->hasValuesAsFlags())
-			return ((m_value & flags) == flags) ? true : false;
+		public:
+			static constexpr char Magic[8] {'T', 'S', 'O', 'N', 'P', 'A', 'K', '\0'};
+			static constexpr uint32_t Version = 1;
+
+			class Header
+			{
+				public:
+					char            magic[8];
+					uint32_t        version;
+					uint32_t        byteOrder;      /*! FlatMap::ByteOrderMark, as written by the host */
+					uint32_t        size;           /*! Size of the archive */
+					FlatMap::Table  entries;        /*! EntryRecords, sorted by path */
+					FlatMap::Table  blobs;          /*! BlobRecords */
+					uint32_t        strings;        /*! Offset of the string section */
+					uint32_t        stringsSize;
+			};
+
+			class EntryRecord
+			{
+				public:
+					FlatMap::String path;           /*! Normalized path, see NormalizePath() */
+					uint32_t        blob;           /*! Index of the BlobRecord with the content */
+			};
+
+			class BlobRecord
+			{
+				public:
+					uint32_t        offset;
+					uint32_t        size;           /*! Stored size */
+					uint32_t        originalSize;   /*! Size of the content, when decompressed */
+					FlatMap::String compression;    /*! Name of the decompressor. Empty when the content is stored as is. */
+					uint32_t        hashLow;        /*! FNV-1a hash of the content */
+					uint32_t        hashHigh;
+			};
+
+			inline Archive() = default;
+			inline explicit Archive(const fs::path &path);
+
+			inline bool open(const fs::path &path);
+			inline bool open(const void *data, size_t size);
+			inline void addDecompressor(std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor);
+
+			[[nodiscard]] inline bool isOpen() const;
+			[[nodiscard]] inline bool contains(const fs::path &path) const;
+			inline bool read(const fs::path &path, std::vector<uint8_t> &out) const;
+			[[nodiscard]] inline std::vector<std::string> getPaths() const;
+			[[nodiscard]] inline std::vector<std::string> getFileNames(const fs::path &folder) const;
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline size_t getBlobCount() const;
+			[[nodiscard]] inline tson::LinkedFileParser createLinkedFileParser(IJson &json, const fs::path &path) const;
+
+			inline static std::string NormalizePath(const fs::path &path);
+
+		private:
+			[[nodiscard]] inline bool find(const std::string &path, EntryRecord &entry) const;
 
-		return m_value == flags;
-	}
+			tson::MappedFile                m_file;
+			FlatMap::Data                   m_data;
+			Header                          m_header {};
+			bool                            m_isOpen {false};
+			std::vector<std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>>> m_decompressors;
+	};
 
 	/*!
-	 * Checks if uint32 value contains one of several possible flags. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
-	 * instead.
-	 * @param flags The uint32 values of the flags you want to check
-	 * @return 'true' if EnumValue has the requested bits activated. 'false' otherwise.
+	 * Builds a tson::Archive. Files are added with their path in the archive, and written when the archive is saved.
+	 *
+	 * Example:
+	 * tson::ArchiveWriter writer;
+	 * writer.addDirectory("content");
+	 * writer.save("content.tsonpak");
 	 */
-	bool EnumValue::hasAnyFlagValue(uint32_t flags) const
+	class ArchiveWriter
 	{
-		if(m_definition->hasValuesAsFlags())
-			return ((m_value & flags) != 0);
+		public:
+			inline ArchiveWriter() = default;
 
-		return m_value == flags;
-	}
+			inline void add(const fs::path &archivePath, std::vector<uint8_t> content);
+			inline bool addFile(const fs::path &file, const fs::path &archivePath);
+			inline size_t addDirectory(const fs::path &folder, const std::vector<std::string> &extensions = {".json", ".tmj", ".tsj", ".tj", ".world", ".tiled-project"});
+			inline void setCompressor(std::string name, tson::ArchiveCompressor compressor);
 
-	uint32_t EnumValue::getValue() const
+			[[nodiscard]] inline std::vector<uint8_t> serialize() const;
+			[[nodiscard]] inline bool save(const fs::path &path) const;
+			[[nodiscard]] inline size_t size() const;
+			[[nodiscard]] inline size_t getBlobCount() const;
+
+		private:
+			class Blob
+			{
+				public:
+					std::vector<uint8_t>    content;
+					uint64_t                hash;
+			};
+
+			std::map<std::string, size_t>               m_entries;      /*! Normalized path -> index in m_blobs. Sorted like the index of the archive */
+			std::vector<Blob>                           m_blobs;
+			std::unordered_multimap<uint64_t, size_t>   m_blobsByHash;  /*! Content hash -> index in m_blobs */
+			std::string                                 m_compressorName;
+			tson::ArchiveCompressor                     m_compressor;
+	};
+
+	static_assert(sizeof(Archive::Header) == 44 && sizeof(Archive::BlobRecord) % 4 == 0, "Archive records must not be padded");
+
+	Archive::Archive(const fs::path &path)
 	{
-		return m_value;
+		open(path);
 	}
 
 	/*!
-	 * Gets the single name of a value.
-	 * This function is intended for enums that can only have one value (non-flag).
-	 * If you want to get several value names (flags), use getValueNames() instead.
-	 * @return A single name for a value
+	 * Maps an archive file
+	 * @return false if the file could not be opened, or is not an archive
 	 */
-	std::string EnumValue::getValueName() const
+	bool Archive::open(const fs::path &path)
 	{
-		return (m_definition == nullptr) ? "" : m_definition->getValue(m_value);
+		m_isOpen = false;
+		if(!m_file.open(path))
+			return false;
+		return open(m_file.data(), m_file.size());
 	}
 
 	/*!
-	 * Checks if T value contains a single flag. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
-	 * instead.
-	 * @tparam T A uint32_t compatible type
-	 * @param flags One or more flags you want to verify is included.
-	 * @return true is all flags presented are set. false otherwise.
+	 * Opens an archive in memory. The memory is not copied, and must outlive the archive.
+	 * @return false if the data is not an archive of this version and byte order
 	 */
-	template<typename T>
-	bool EnumValue::hasFlag(T flags) const
+	bool Archive::open(const void *data, size_t size)
 	{
-		return hasFlagValue(static_cast<uint32_t>(flags));
+		m_isOpen = false;
+		if(data == nullptr || size < sizeof(Header))
+			return false;
+
+		std::memcpy(&m_header, data, sizeof(Header));
+		if(std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0 || m_header.version != Version || m_header.byteOrder != FlatMap::ByteOrderMark ||
+		   m_header.size > size || m_header.strings > m_header.size || m_header.stringsSize > m_header.size - m_header.strings)
+			return false;
+
+		m_data = FlatMap::Data(static_cast<const uint8_t *>(data), m_header.size, m_header.strings, m_header.stringsSize);
+		m_isOpen = m_data.count<EntryRecord>(m_header.entries) == m_header.entries.count &&
+				   m_data.count<BlobRecord>(m_header.blobs) == m_header.blobs.count;
+		return m_isOpen;
 	}
 
 	/*!
-	 * Checks if T value contains one of several possible flags. If 'valuesAsFlags' is not a part of the EnumDefinition, a simple equality comparison will be done
-	 * instead.
-	 * @tparam T A uint32_t compatible type
-	 * @param flags One or more flags you want to verify is included.
-	 * @return true is all flags presented are set. false otherwise.
+	 * Adds a decompressor for compressed entries. Entries are decompressed with the decompressor of the same name().
+	 * Not thread safe: Add every decompressor before reading from several threads.
 	 */
-	template<typename T>
-	bool EnumValue::hasAnyFlag(T flags) const
+	void Archive::addDecompressor(std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor)
 	{
-		return hasAnyFlagValue(static_cast<uint32_t>(flags));
+		m_decompressors.push_back(std::move(decompressor));
 	}
 
-	EnumDefinition *EnumValue::getDefinition() const
+	bool Archive::isOpen() const
 	{
-		return m_definition;
+		return m_isOpen;
 	}
 
-	std::vector<std::string> EnumValue::getValueNames() const
+	bool Archive::contains(const fs::path &path) const
 	{
-		return (m_definition == nullptr) ? std::vector<std::string>() : m_definition->getValues(m_value);
+		EntryRecord entry {};
+		return find(NormalizePath(path), entry);
 	}
 
 	/*!
-	 *
-	 * @param value
-	 * @return
+	 * Reads the content of a file in the archive
+	 * @param path Path of the file in the archive. "a/../b.json" and "./b.json" are the same as "b.json".
+	 * @param out The content
+	 * @return false if the file is not in the archive, or could not be decompressed
 	 */
-	bool EnumValue::containsValueName(const std::string &value) const
+	bool Archive::read(const fs::path &path, std::vector<uint8_t> &out) const
 	{
-		if(m_definition != nullptr)
+		out.clear();
+		EntryRecord entry {};
+		if(!find(NormalizePath(path), entry) || entry.blob >= m_header.blobs.count)
+			return false;
+
+		auto const blob = m_data.record<BlobRecord>(m_header.blobs, entry.blob);
+		if(blob.offset > m_header.size || blob.size > m_header.size - blob.offset)
+			return false;
+
+		const uint8_t *content = m_data.data() + blob.offset;
+		std::string_view const compression = m_data.string(blob.compression);
+		if(compression.empty())
 		{
-			if(m_definition->hasValuesAsFlags())
+			out.assign(content, content + blob.size);
+			return true;
+		}
+
+		for(const auto &decompressor : m_decompressors)
+		{
+			if(decompressor->name() == compression)
 			{
-				std::vector<std::string> values = m_definition->getValues(m_value);
-				auto it = std::find(values.begin(), values.end(), value);
-				return it != values.end();
+				out = decompressor->decompress(content, blob.size);
+				return out.size() == blob.originalSize;
 			}
-			return m_definition->getValue(value) == m_value;
 		}
 		return false;
 	}
-}
-
-#endif //TILESON_TILEDENUM_HPP
-
-/*** End of inlined file: TiledEnum.hpp ***/
 
+	/*!
+	 * The paths of every file in the archive, sorted
+	 */
+	std::vector<std::string> Archive::getPaths() const
+	{
+		std::vector<std::string> paths;
+		paths.reserve(m_header.entries.count);
+		for(size_t i = 0; i < size(); ++i)
+			paths.emplace_back(m_data.string(m_data.record<EntryRecord>(m_header.entries, i).path));
+		return paths;
+	}
 
-/*** Start of inlined file: TiledClass.hpp ***/
-//
-// Created by robin on 06.06.22.
-//
+	/*!
+	 * The names of the files directly in a folder of the archive, sorted. Like listing a folder on disk.
+	 */
+	std::vector<std::string> Archive::getFileNames(const fs::path &folder) const
+	{
+		std::string prefix = NormalizePath(folder);
+		if(!prefix.empty())
+			prefix += '/';
 
-#ifndef TILESON_TILEDCLASS_HPP
-#define TILESON_TILEDCLASS_HPP
+		std::vector<std::string> fileNames;
+		for(size_t i = 0; i < size(); ++i)
+		{
+			std::string_view const path = m_data.string(m_data.record<EntryRecord>(m_header.entries, i).path);
+			if(path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0 && path.find('/', prefix.size()) == std::string_view::npos)
+				fileNames.emplace_back(path.substr(prefix.size()));
+		}
+		return fileNames;
+	}
 
-namespace tson
-{
-	class TiledClass
+	/*!
+	 * Number of files in the archive
+	 */
+	size_t Archive::size() const
 	{
-		public:
-			inline explicit TiledClass() = default;
-			inline explicit TiledClass(IJson &json, tson::Project *project = nullptr);
-
-			[[nodiscard]] inline uint32_t getId() const;
-			[[nodiscard]] inline const std::string &getName() const;
-			[[nodiscard]] inline const std::string &getType() const;
-			[[nodiscard]] inline PropertyCollection &getMembers();
-			inline void update(IJson &json);
-			inline void update(PropertyCollection &properties);
+		return (m_isOpen) ? m_header.entries.count : 0;
+	}
 
-			template <typename T>
-			inline T get(const std::string &name);
-			inline tson::Property *getMember(const std::string &name);
+	/*!
+	 * Number of distinct contents in the archive. Less than size() when files share their content.
+	 */
+	size_t Archive::getBlobCount() const
+	{
+		return (m_isOpen) ? m_header.blobs.count : 0;
+	}
 
-		private:
-			uint32_t m_id {};
-			std::string m_name {};
-			std::string m_type {};
-			PropertyCollection m_members {};
+	/*!
+	 * Creates a tson::LinkedFileParser that reads the files linked by a file of the archive, relative to it.
+	 * The archive must outlive the parser.
+	 * @param json Used to create the json parsers of the linked files. Must outlive the parser.
+	 * @param path Path of the file in the archive that links to the other files
+	 */
+	tson::LinkedFileParser Archive::createLinkedFileParser(IJson &json, const fs::path &path) const
+	{
+		fs::path const folder = fs::path(NormalizePath(path)).parent_path();
+		return [this, &json, folder](std::string relativePath) -> std::unique_ptr<IJson>
+		{
+			std::vector<uint8_t> content;
+			if(!read(folder / relativePath, content))
+				return nullptr;
 
-	};
+			std::unique_ptr<IJson> linkedFileJson = json.create();
+			if(!linkedFileJson->parse(content.data(), content.size()))
+				return nullptr;
+			return linkedFileJson;
+		};
+	}
 
-	TiledClass::TiledClass(IJson &json, tson::Project *project)
+	/*!
+	 * The path as it is stored in the archive: with '/' as separator, and without '.', '..' or empty parts.
+	 * '..' parts leaving the root of the archive are dropped.
+	 */
+	std::string Archive::NormalizePath(const fs::path &path)
 	{
-		if(json.count("id") > 0)
-			m_id = json["id"].get<uint32_t>();
+		std::vector<std::string> parts;
+		std::string const generic = path.generic_string();
+		size_t start = 0;
+		while(start <= generic.size())
+		{
+			size_t end = generic.find('/', start);
+			if(end == std::string::npos)
+				end = generic.size();
 
-		if(json.count("name") > 0)
-			m_name = json["name"].get<std::string>();
-		if(json.count("type") > 0)
-			m_type = json["type"].get<std::string>();
+			std::string part = generic.substr(start, end - start);
+			if(part == "..")
+			{
+				if(!parts.empty())
+					parts.pop_back();
+			}
+			else if(!part.empty() && part != ".")
+				parts.push_back(std::move(part));
+			start = end + 1;
+		}
 
-		if(json.count("members") > 0 && json["members"].isArray())
+		std::string normalized;
+		for(const auto &part : parts)
 		{
-			auto &array = json.array("members");
-			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
-			{
-				m_members.add(*item, project);
-			});
+			if(!normalized.empty())
+				normalized += '/';
+			normalized += part;
 		}
+		return normalized;
 	}
 
-	uint32_t TiledClass::getId() const
+	/*!
+	 * Finds an entry by its normalized path. Entries are sorted by path, so this is a binary search.
+	 */
+	bool Archive::find(const std::string &path, EntryRecord &entry) const
 	{
-		return m_id;
+		size_t first = 0;
+		size_t last = size();
+		while(first < last)
+		{
+			size_t const middle = first + (last - first) / 2;
+			auto const current = m_data.record<EntryRecord>(m_header.entries, middle);
+			int const compared = m_data.string(current.path).compare(path);
+			if(compared == 0)
+			{
+				entry = current;
+				return true;
+			}
+			if(compared < 0)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		return false;
 	}
 
-	const std::string &TiledClass::getName() const
+	/*!
+	 * Adds a file to the archive, replacing any file with the same path.
+	 * When another file has the same content, the content is only stored once.
+	 * @param archivePath Path of the file in the archive
+	 * @param content The content of the file
+	 */
+	void ArchiveWriter::add(const fs::path &archivePath, std::vector<uint8_t> content)
 	{
-		return m_name;
-	}
+		uint64_t const hash = tson::MapSnapshot::Hash(content.data(), content.size());
+		size_t blob = m_blobs.size();
+		auto [first, last] = m_blobsByHash.equal_range(hash);
+		for(auto it = first; it != last; ++it)
+		{
+			if(m_blobs[it->second].content == content)
+			{
+				blob = it->second;
+				break;
+			}
+		}
 
-	const std::string &TiledClass::getType() const
-	{
-		return m_type;
+		if(blob == m_blobs.size())
+		{
+			m_blobs.push_back({std::move(content), hash});
+			m_blobsByHash.emplace(hash, blob);
+		}
+		m_entries[Archive::NormalizePath(archivePath)] = blob;
 	}
 
-	PropertyCollection &TiledClass::getMembers()
+	/*!
+	 * Adds a file from disk
+	 * @param file The file to add
+	 * @param archivePath Path of the file in the archive
+	 * @return false if the file could not be read
+	 */
+	bool ArchiveWriter::addFile(const fs::path &file, const fs::path &archivePath)
 	{
-		return m_members;
+		std::vector<uint8_t> content;
+		if(!tson::MapSnapshot::ReadFile(file, content))
+			return false;
+		add(archivePath, std::move(content));
+		return true;
 	}
 
-	template<typename T>
-	T TiledClass::get(const std::string &name)
+	/*!
+	 * Adds the files of a folder and its subfolders, with their paths relative to the folder
+	 * @param extensions The extensions of the files to add. Every file is added when empty.
+	 * @return Number of files added
+	 */
+	size_t ArchiveWriter::addDirectory(const fs::path &folder, const std::vector<std::string> &extensions)
 	{
-		return m_members.getValue<T>(name);
+		size_t added = 0;
+		std::error_code error;
+		std::string const root = folder.generic_string();
+		for(const auto &entry : fs::recursive_directory_iterator(folder, error))
+		{
+			if(!fs::is_regular_file(entry.status()))
+				continue;
+
+			std::string const extension = entry.path().extension().generic_string();
+			if(!extensions.empty() && std::find(extensions.begin(), extensions.end(), extension) == extensions.end())
+				continue;
+
+			std::string const path = entry.path().generic_string();
+			if(addFile(entry.path(), path.substr(std::min(path.size(), root.size() + 1))))
+				++added;
+		}
+		return added;
 	}
 
-	tson::Property *TiledClass::getMember(const std::string &name)
+	/*!
+	 * Compresses the files of the archive when it is written. Files that do not get smaller are stored as they are.
+	 * @param name Name of the compression. Readers need a decompressor with this name(), like "lzma" for tson::Lzma.
+	 * @param compressor Compresses the content of one file
+	 */
+	void ArchiveWriter::setCompressor(std::string name, tson::ArchiveCompressor compressor)
 	{
-		if(m_members.hasProperty(name))
-			return m_members.getProperty(name);
-		return nullptr;
+		m_compressorName = std::move(name);
+		m_compressor = std::move(compressor);
 	}
 
 	/*!
-	 * Takes a json object from a particular map top update values if they differ from the original values of the class
-	 * @param json
+	 * Writes the archive
 	 */
-	void TiledClass::update(IJson &json)
+	std::vector<uint8_t> ArchiveWriter::serialize() const
 	{
-		for(Property *property : m_members.get())
+		std::vector<uint8_t> data(sizeof(Archive::Header));
+		std::vector<uint8_t> strings;
+		auto addString = [&](const std::string &value) -> FlatMap::String
 		{
-			if(json.any(property->getName()))
-			{
-				property->setValueByType(json[property->getName()]);
-			}
-		}
-	}
+			FlatMap::String result {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+			strings.insert(strings.end(), value.begin(), value.end());
+			return result;
+		};
+		auto pad = [&]()
+		{
+			data.resize((data.size() + 3) & ~size_t(3));
+		};
 
-	void TiledClass::update(PropertyCollection &properties)
-	{
-		std::vector<Property *> toUpdate;
-		for(Property *member : m_members.get())
+		//Only the blobs still used by a file are written, in the order of the files
+		std::vector<size_t> order;
+		std::vector<uint32_t> indices(m_blobs.size(), std::numeric_limits<uint32_t>::max());
+		for(const auto &[path, blob] : m_entries)
 		{
-			if(properties.hasProperty(member->getName()))
+			if(indices[blob] == std::numeric_limits<uint32_t>::max())
 			{
-				Property *property = properties.getProperty(member->getName());
-				if(member->getType() == property->getType())
-				{
-					toUpdate.push_back(property);
-				}
+				indices[blob] = static_cast<uint32_t>(order.size());
+				order.push_back(blob);
 			}
 		}
 
-		std::for_each(toUpdate.begin(), toUpdate.end(), [&](Property *p)
+		FlatMap::String const compression = (m_compressor) ? addString(m_compressorName) : FlatMap::String {0, 0};
+		std::vector<Archive::BlobRecord> blobs;
+		blobs.reserve(order.size());
+		for(size_t index : order)
 		{
-		   m_members.setProperty(p->getName(), *p);
-		});
-	}
-}
+			const Blob &blob = m_blobs[index];
+			std::vector<uint8_t> compressed;
+			if(m_compressor)
+				compressed = m_compressor(blob.content);
+			bool const isCompressed = !compressed.empty() && compressed.size() < blob.content.size();
+			const std::vector<uint8_t> &stored = (isCompressed) ? compressed : blob.content;
+
+			Archive::BlobRecord record {};
+			record.offset = static_cast<uint32_t>(data.size());
+			record.size = static_cast<uint32_t>(stored.size());
+			record.originalSize = static_cast<uint32_t>(blob.content.size());
+			record.compression = (isCompressed) ? compression : FlatMap::String {0, 0};
+			record.hashLow = static_cast<uint32_t>(blob.hash);
+			record.hashHigh = static_cast<uint32_t>(blob.hash >> 32);
+			blobs.push_back(record);
+			data.insert(data.end(), stored.begin(), stored.end());
+			pad();
+		}
 
-#endif //TILESON_TILEDCLASS_HPP
+		Archive::Header header {};
+		std::memcpy(header.magic, Archive::Magic, sizeof(header.magic));
+		header.version = Archive::Version;
+		header.byteOrder = FlatMap::ByteOrderMark;
 
-/*** End of inlined file: TiledClass.hpp ***/
+		header.blobs = {static_cast<uint32_t>(data.size()), static_cast<uint32_t>(blobs.size())};
+		data.resize(data.size() + blobs.size() * sizeof(Archive::BlobRecord));
+		if(!blobs.empty())
+			std::memcpy(data.data() + header.blobs.offset, blobs.data(), blobs.size() * sizeof(Archive::BlobRecord));
 
+		header.entries = {static_cast<uint32_t>(data.size()), static_cast<uint32_t>(m_entries.size())};
+		data.resize(data.size() + m_entries.size() * sizeof(Archive::EntryRecord));
+		size_t i = 0;
+		for(const auto &[path, blob] : m_entries)
+		{
+			Archive::EntryRecord record {addString(path), indices[blob]};
+			std::memcpy(data.data() + header.entries.offset + (i++) * sizeof(Archive::EntryRecord), &record, sizeof(record));
+		}
 
-/*** Start of inlined file: Project.hpp ***/
-//
-// Created by robin on 01.08.2020.
-//
+		header.strings = static_cast<uint32_t>(data.size());
+		header.stringsSize = static_cast<uint32_t>(strings.size());
+		data.insert(data.end(), strings.begin(), strings.end());
+		pad();
+		header.size = static_cast<uint32_t>(data.size());
+		std::memcpy(data.data(), &header, sizeof(header));
+		return data;
+	}
 
-#ifndef TILESON_PROJECT_HPP
-#define TILESON_PROJECT_HPP
+	/*!
+	 * Writes the archive to a file
+	 * @return true if the file was written
+	 */
+	bool ArchiveWriter::save(const fs::path &path) const
+	{
+		std::vector<uint8_t> data = serialize();
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+		return file.good();
+	}
 
-#include <fstream>
-#include <sstream>
-#include <memory>
+	/*!
+	 * Number of files added
+	 */
+	size_t ArchiveWriter::size() const
+	{
+		return m_entries.size();
+	}
 
-/*** Start of inlined file: World.hpp ***/
-//
-// Created by robin on 01.08.2020.
-//
+	/*!
+	 * Number of distinct contents added, including those of files that were replaced
+	 */
+	size_t ArchiveWriter::getBlobCount() const
+	{
+		return m_blobs.size();
+	}
+}
 
-#ifndef TILESON_WORLD_HPP
-#define TILESON_WORLD_HPP
+#endif //TILESON_ARCHIVE_HPP
 
+/*** End of inlined file: Archive.hpp ***/
 
-/*** Start of inlined file: WorldMapData.hpp ***/
-//
-// Created by robin on 01.08.2020.
-//
 
-#ifndef TILESON_WORLDMAPDATA_HPP
-#define TILESON_WORLDMAPDATA_HPP
+/*** Start of inlined file: MapInfo.hpp ***/
+#ifndef TILESON_MAPINFO_HPP
+#define TILESON_MAPINFO_HPP
 
 namespace tson
 {
-	class WorldMapData
+	/*!
+	 * What tson::MapProbe reads about a map without parsing it: Its size, layers, tilesets and properties.
+	 */
+	class MapInfo
 	{
 		public:
-			inline WorldMapData(const fs::path &folder_, IJson &json);
-			inline void parse(const fs::path &folder_, IJson &json);
-			//inline WorldMapData(fs::path folder_, std::string fileName_) : folder {std::move(folder_)}, fileName {fileName_}
-			//{
-			//    path = folder / fileName;
-			//}
+			class LayerInfo
+			{
+				public:
+					int id {0};
+					std::string name;
+					tson::LayerType type {tson::LayerType::Undefined};
+					std::vector<LayerInfo> layers;      /*! The layers of a group */
+			};
+
+			class TilesetInfo
+			{
+				public:
+					int firstgid {0};
+					std::string name;                   /*! Only set for tilesets that are part of the map */
+					std::string source;                 /*! Only set for external tilesets */
+			};
 
-			fs::path folder;
 			fs::path path;
-			std::string fileName;
+			tson::ParseStatus status {tson::ParseStatus::OK};
+			std::string type;                           /*! 'map' for maps. Tilesets, templates etc. can be probed, but have no map data */
+			std::string classType;
+			std::string orientation;
 			tson::Vector2i size;
-			tson::Vector2i position;
+			tson::Vector2i tileSize;
+			bool infinite {false};
+			std::vector<LayerInfo> layers;
+			std::vector<TilesetInfo> tilesets;
+			tson::PropertyCollection properties;
+
+			[[nodiscard]] inline bool isMap() const;
 	};
 
-	WorldMapData::WorldMapData(const fs::path &folder_, IJson &json)
+	bool MapInfo::isMap() const
 	{
-		parse(folder_, json);
+		return status == tson::ParseStatus::OK && type == "map";
 	}
+}
 
-	void WorldMapData::parse(const fs::path &folder_, IJson &json)
-	{
-		folder = folder_;
-		if(json.count("fileName") > 0) fileName = json["fileName"].get<std::string>();
-		if(json.count("height") > 0) size = {json["width"].get<int>(), json["height"].get<int>()};
-		if(json.count("x") > 0) position = {json["x"].get<int>(), json["y"].get<int>()};
+#endif //TILESON_MAPINFO_HPP
 
-		path = (!fileName.empty()) ? folder / fileName : folder;
-	}
-}
+/*** End of inlined file: MapInfo.hpp ***/
 
-#endif //TILESON_WORLDMAPDATA_HPP
-/*** End of inlined file: WorldMapData.hpp ***/
 
-#include <memory>
+/*** Start of inlined file: MapProbe.hpp ***/
+#ifndef TILESON_MAPPROBE_HPP
+#define TILESON_MAPPROBE_HPP
+
+#include <atomic>
+#include <cctype>
+#include <thread>
+#include <system_error>
+#include <algorithm>
+
 namespace tson
 {
-	class Tileson;
-	class World
+	/*!
+	 * Reads the size, layers, tilesets and properties of maps without parsing them, for tools that list many maps.
+	 *
+	 * Json maps (.json/.tmj) and .tmx maps are read as a stream, straight from a mapped file: Tile data, objects, chunks and
+	 * the tiles of tilesets are skipped without being decoded, and json stops being read as soon as everything has been found.
+	 * Only the properties are parsed, with the json parser given to the constructor (json) or tson::TmxJson (tmx).
+	 *
+	 * Example:
+	 * tson::MapProbe probe;
+	 * for(const tson::MapInfo &info : probe.probeDirectory("maps"))
+	 *     std::cout << info.path << ": " << info.size.x << "x" << info.size.y << "\n";
+	 */
+	class MapProbe
 	{
 		public:
 			#ifdef JSON11_IS_DEFINED
-			inline explicit World(std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>()) : m_json {std::move(jsonParser)}
-			{
-			}
-
-			inline explicit World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>());
-			#else
-			inline explicit World(std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
-			{
-			}
-
-			inline explicit World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser);
+			inline MapProbe();
 			#endif
-			inline bool parse(const fs::path &path);
-			inline std::size_t loadMaps(tson::Tileson *parser); //tileson_forward.hpp
-			inline bool contains(std::string_view filename);
-			inline const WorldMapData *get(std::string_view filename) const;
+			inline explicit MapProbe(std::unique_ptr<tson::IJson> json);
 
-			[[nodiscard]] inline const fs::path &getPath() const;
-			[[nodiscard]] inline const fs::path &getFolder() const;
-			[[nodiscard]] inline const std::vector<WorldMapData> &getMapData() const;
-			[[nodiscard]] inline bool onlyShowAdjacentMaps() const;
-			[[nodiscard]] inline const std::string &getType() const;
-			[[nodiscard]] inline const std::vector<std::unique_ptr<tson::Map>> &getMaps() const;
+			inline tson::MapInfo probe(const fs::path &path);
+			inline tson::MapInfo probe(const void *data, size_t size);
+			inline std::vector<tson::MapInfo> probeDirectory(const fs::path &folder, size_t threadCount = 0, bool recursive = true);
+
+			inline static bool IsMapFile(const fs::path &path);
 
 		private:
-			inline void parseJson(IJson &json);
+			/*!
+			 * Reads json one value at a time. Values that are not needed are skipped by matching brackets and quotes only.
+			 */
+			class JsonCursor
+			{
+				public:
+					inline JsonCursor(const char *data, size_t size);
+
+					template <typename Func>
+					inline bool readObject(Func &&readValue);
+					template <typename Func>
+					inline bool readArray(Func &&readItem);
+					inline bool readString(std::string &value);
+					inline bool readNumber(double &value);
+					inline bool readBool(bool &value);
+					inline bool skipValue();
+					inline bool skipValue(std::string_view &raw);
+
+					[[nodiscard]] inline bool isAtEnd();
+
+				private:
+					inline void skipWhitespace();
+					inline bool consume(char c);
+					inline bool readKey(std::string_view &key);
+					inline bool skipString();
+
+					const char *    m_data;
+					size_t          m_size;
+					size_t          m_pos {0};
+			};
 
-			std::unique_ptr<IJson> m_json = nullptr;
-			fs::path m_path;
-			fs::path m_folder;
-			std::vector<WorldMapData> m_mapData;
-			std::vector<std::unique_ptr<tson::Map>> m_maps;
-			bool m_onlyShowAdjacentMaps;
-			std::string m_type;
-	};
+			inline bool probeJson(const char *data, size_t size, tson::MapInfo &info);
+			inline bool probeXml(const char *data, size_t size, tson::MapInfo &info);
+			inline bool readJsonLayers(JsonCursor &cursor, std::vector<tson::MapInfo::LayerInfo> &layers);
+			inline bool readXmlLayer(XmlReader &reader, tson::MapInfo::LayerInfo &layer);
+			inline static void ReadProperties(IJson &json, tson::PropertyCollection &properties);
+			inline static tson::LayerType ToLayerType(std::string_view type);
+			inline static int ToInt(std::string_view text);
 
-	World::World(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
-	{
-		parse(path);
-	}
+			std::unique_ptr<tson::IJson> m_json;        /*! Parses the properties of json maps */
+			tson::TmxJson m_tmxJson;                    /*! Parses the properties of tmx maps */
+	};
 
-	bool World::parse(const fs::path &path)
+	MapProbe::JsonCursor::JsonCursor(const char *data, size_t size) : m_data {data}, m_size {size}
 	{
-		m_path = path;
-		m_folder = m_path.parent_path();
-
-		if(!m_json->parse(path))
-			return false;
-
-		parseJson(*m_json);
-		return true;
-	}
 
-	const fs::path &World::getPath() const
-	{
-		return m_path;
 	}
 
-	const std::vector<WorldMapData> &World::getMapData() const
+	void MapProbe::JsonCursor::skipWhitespace()
 	{
-		return m_mapData;
+		while(m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\n' || m_data[m_pos] == '\r' || m_data[m_pos] == '\t'))
+			++m_pos;
 	}
 
-	bool World::onlyShowAdjacentMaps() const
+	bool MapProbe::JsonCursor::consume(char c)
 	{
-		return m_onlyShowAdjacentMaps;
+		skipWhitespace();
+		if(m_pos < m_size && m_data[m_pos] == c)
+		{
+			++m_pos;
+			return true;
+		}
+		return false;
 	}
 
-	const std::string &World::getType() const
+	bool MapProbe::JsonCursor::isAtEnd()
 	{
-		return m_type;
+		skipWhitespace();
+		return m_pos == m_size;
 	}
 
-	void World::parseJson(IJson &json)
+	/*!
+	 * Moves past a string. m_pos is at its opening quote.
+	 */
+	bool MapProbe::JsonCursor::skipString()
 	{
-		if(json.count("onlyShowAdjacentMaps") > 0) m_onlyShowAdjacentMaps = json["onlyShowAdjacentMaps"].get<bool>();
-		if(json.count("type") > 0) m_type = json["type"].get<std::string>();
-
-		if(json["maps"].isArray())
+		++m_pos;
+		while(true)
 		{
-			auto &maps = json.array("maps");
-			std::for_each(maps.begin(), maps.end(), [&](std::unique_ptr<IJson> &item) { m_mapData.emplace_back(m_folder, *item); });
-		}
-	}
+			const void *quote = std::memchr(m_data + m_pos, '"', m_size - m_pos);
+			if(quote == nullptr)
+				return false;
 
-	const fs::path &World::getFolder() const
-	{
-		return m_folder;
+			size_t const end = static_cast<size_t>(static_cast<const char *>(quote) - m_data);
+			size_t backslashes = 0;
+			while(end - backslashes > m_pos && m_data[end - backslashes - 1] == '\\')
+				++backslashes;
+			m_pos = end + 1;
+			if(backslashes % 2 == 0)
+				return true;
+		}
 	}
 
 	/*!
-	 * Check if there is WorldMapData in the world that contains the current filename.
-	 * Filename = <file>.<extension>
-	 * @param filename
-	 * @return
+	 * Reads a key and its colon. Keys are compared as they are in the json, so keys with escapes never match.
 	 */
-	bool World::contains(std::string_view filename)
+	bool MapProbe::JsonCursor::readKey(std::string_view &key)
 	{
-		//Note: might be moved to std::ranges from C++20.
-		return std::any_of(m_mapData.begin(), m_mapData.end(), [&](const auto &item) { return item.fileName == filename; });
+		skipWhitespace();
+		if(m_pos >= m_size || m_data[m_pos] != '"')
+			return false;
+
+		size_t const start = m_pos + 1;
+		if(!skipString())
+			return false;
+		key = std::string_view(m_data + start, m_pos - 1 - start);
+		return consume(':');
 	}
 
 	/*!
-	 * Get a map by its filename
-	 * @param filename Filename (including extension) - (example: file.json)
-	 * @return pointer to WorldMapData or nullptr if not exists
+	 * Calls readValue(key) for each key of an object. readValue must read or skip the value, and return false on errors.
 	 */
-	const WorldMapData * World::get(std::string_view filename) const
+	template<typename Func>
+	bool MapProbe::JsonCursor::readObject(Func &&readValue)
 	{
-		auto iter = std::find_if(m_mapData.begin(), m_mapData.end(), [&](const auto &item) { return item.fileName == filename; });
-		return (iter == m_mapData.end()) ? nullptr : iter.operator->();
+		if(!consume('{'))
+			return false;
+		if(consume('}'))
+			return true;
+
+		do
+		{
+			std::string_view key;
+			if(!readKey(key) || !readValue(key))
+				return false;
+		} while(consume(','));
+		return consume('}');
 	}
 
 	/*!
-	 * Get all maps that have been loaded by loadMaps().
-	 * NOTE: This is untested, and was a last second addition to Tileson 1.2.0, as I had forgot about the loadMaps() functionality (also untested)
-	 * If you find anything malfunctioning - please report.
-	 * @return All maps loaded by loadMaps()
+	 * Calls readItem() for each item of an array. readItem must read or skip the item, and return false on errors.
 	 */
-	const std::vector<std::unique_ptr<tson::Map>> &World::getMaps() const
+	template<typename Func>
+	bool MapProbe::JsonCursor::readArray(Func &&readItem)
 	{
-		return m_maps;
-	}
-
-}
-
-#endif //TILESON_WORLD_HPP
+		if(!consume('['))
+			return false;
+		if(consume(']'))
+			return true;
 
-/*** End of inlined file: World.hpp ***/
+		do
+		{
+			if(!readItem())
+				return false;
+		} while(consume(','));
+		return consume(']');
+	}
 
+	bool MapProbe::JsonCursor::readString(std::string &value)
+	{
+		skipWhitespace();
+		if(m_pos >= m_size || m_data[m_pos] != '"')
+			return skipValue();
 
+		size_t const start = m_pos + 1;
+		if(!skipString())
+			return false;
 
-/*** Start of inlined file: ProjectPropertyTypes.hpp ***/
-//
-// Created by robin on 01.08.22.
-//
+		size_t const end = m_pos - 1; //The closing quote
+		value.clear();
+		for(size_t i = start; i < end; ++i)
+		{
+			char const c = m_data[i];
+			if(c != '\\')
+			{
+				value += c;
+				continue;
+			}
 
-#ifndef TILESON_PROJECTPROPERTYTYPES_HPP
-#define TILESON_PROJECTPROPERTYTYPES_HPP
+			char const escaped = m_data[++i];
+			switch(escaped)
+			{
+				case 'b': value += '\b'; break;
+				case 'f': value += '\f'; break;
+				case 'n': value += '\n'; break;
+				case 'r': value += '\r'; break;
+				case 't': value += '\t'; break;
+				case 'u':
+				{
+					if(i + 4 >= end)
+						return false;
+					auto codepoint = static_cast<uint32_t>(std::strtoul(std::string(m_data + i + 1, 4).c_str(), nullptr, 16));
+					i += 4;
+					//A surrogate pair
+					if(codepoint >= 0xd800 && codepoint <= 0xdbff && i + 6 < end && m_data[i + 1] == '\\' && m_data[i + 2] == 'u')
+					{
+						auto const low = static_cast<uint32_t>(std::strtoul(std::string(m_data + i + 3, 4).c_str(), nullptr, 16));
+						codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+						i += 6;
+					}
+					value += XmlReader::Unescape("&#" + std::to_string(codepoint) + ";");
+					break;
+				}
+				default: value += escaped; break;
+			}
+		}
+		return true;
+	}
 
-namespace tson
-{
-	class ProjectPropertyTypes
+	bool MapProbe::JsonCursor::readNumber(double &value)
 	{
-		public:
-			inline ProjectPropertyTypes() = default;
-			inline bool parse(IJson &json, tson::Project *project);
+		skipWhitespace();
+		size_t const start = m_pos;
+		if(!skipValue())
+			return false;
 
-			inline const std::vector<tson::EnumDefinition> &getEnums() const;
-			inline const std::vector<tson::TiledClass> &getClasses() const;
-			[[nodiscard]] inline tson::EnumDefinition* getEnumDefinition(std::string_view name);
-			[[nodiscard]] inline tson::TiledClass* getClass(std::string_view name);
-			inline bool isUnhandledContentFound() const;
+		std::string const text(m_data + start, m_pos - start);
+		char *end = nullptr;
+		value = std::strtod(text.c_str(), &end);
+		return end != text.c_str();
+	}
 
-		private:
-			std::vector<tson::EnumDefinition> m_enums;
-			std::vector<tson::TiledClass> m_classes;
-			bool m_unhandledContentFound {false};
+	bool MapProbe::JsonCursor::readBool(bool &value)
+	{
+		skipWhitespace();
+		value = m_pos < m_size && m_data[m_pos] == 't';
+		return skipValue();
+	}
 
-	};
+	bool MapProbe::JsonCursor::skipValue()
+	{
+		std::string_view raw;
+		return skipValue(raw);
+	}
 
-	bool ProjectPropertyTypes::parse(IJson &json, tson::Project *project)
+	/*!
+	 * Moves past a value without reading it.
+	 * @param raw The json text of the value
+	 */
+	bool MapProbe::JsonCursor::skipValue(std::string_view &raw)
 	{
-		m_enums.clear();
-		m_classes.clear();
-		m_unhandledContentFound = false;
+		skipWhitespace();
+		if(m_pos >= m_size)
+			return false;
 
-		if(json.count("propertyTypes") > 0 && json["propertyTypes"].isArray())
+		size_t const start = m_pos;
+		char const first = m_data[m_pos];
+		if(first == '"')
 		{
-			auto &array = json.array("propertyTypes");
-			std::vector<tson::IJson*> classes; //Classes must be handled after enums
-			std::vector<tson::IJson*> other; //Unhandled stuff - just to keep track if something is missing...
-			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item)
+			if(!skipString())
+				return false;
+		}
+		else if(first == '{' || first == '[')
+		{
+			size_t depth = 0;
+			while(m_pos < m_size)
 			{
-				IJson &j = *item;
-				if(j.count("type") > 0)
+				char const c = m_data[m_pos];
+				if(c == '"')
 				{
-					std::string t = j["type"].get<std::string>();
-					if(t == "enum")
-					{
-						m_enums.emplace_back(j); //Can be resolved directly
-					}
-					else if(t == "class")
-					{
-						classes.push_back(item.get()); //Must be resolved later
-					}
-					else
-						other.push_back(item.get()); //Only used to set flag for whether unhandled content was found.
+					if(!skipString())
+						return false;
+					continue;
 				}
-			});
-
-			std::for_each(classes.begin(), classes.end(), [&](IJson *item)
-			{
-				m_classes.emplace_back(*item, project);
-			});
-
-			if(!other.empty())
-				m_unhandledContentFound = true;
 
+				++m_pos;
+				if(c == '{' || c == '[')
+					++depth;
+				else if((c == '}' || c == ']') && --depth == 0)
+					break;
+			}
+			if(depth != 0)
+				return false;
+		}
+		else
+		{
+			while(m_pos < m_size && std::strchr(",}] \n\r\t", m_data[m_pos]) == nullptr)
+				++m_pos;
+			if(m_pos == start)
+				return false;
 		}
-		return false;
-	}
 
-	const std::vector<tson::EnumDefinition> &ProjectPropertyTypes::getEnums() const
-	{
-		return m_enums;
+		raw = std::string_view(m_data + start, m_pos - start);
+		return true;
 	}
 
-	const std::vector<tson::TiledClass> &ProjectPropertyTypes::getClasses() const
+	#ifdef JSON11_IS_DEFINED
+	/*!
+	 * Parses the properties of json maps with tson::Json11
+	 */
+	MapProbe::MapProbe() : MapProbe(std::make_unique<tson::Json11>())
 	{
-		return m_classes;
+
 	}
+	#endif
 
-	bool ProjectPropertyTypes::isUnhandledContentFound() const
+	/*!
+	 * @param json Parses the properties of json maps. If nullptr, the properties of json maps are not read.
+	 */
+	MapProbe::MapProbe(std::unique_ptr<tson::IJson> json) : m_json {std::move(json)}
 	{
-		return m_unhandledContentFound;
+
 	}
 
-	tson::EnumDefinition *ProjectPropertyTypes::getEnumDefinition(std::string_view name)
+	tson::MapInfo MapProbe::probe(const fs::path &path)
 	{
-		auto it = std::find_if(m_enums.begin(), m_enums.end(), [&](const EnumDefinition &def)
+		tson::MappedFile file;
+		if(!fs::exists(path) || !fs::is_regular_file(path) || !file.open(path))
 		{
-			return def.getName() == name;
-		});
+			tson::MapInfo info;
+			info.path = path;
+			info.status = tson::ParseStatus::FileNotFound;
+			return info;
+		}
 
-		if(it != m_enums.end())
-			return &it.operator*();
+		tson::MapInfo info = probe(file.data(), file.size());
+		info.path = path;
+		return info;
+	}
 
-		return nullptr;
+	/*!
+	 * Probes a json map (starts with '{') or a tmx map (starts with '<'). Other data gives ParseStatus::ParseError.
+	 */
+	tson::MapInfo MapProbe::probe(const void *data, size_t size)
+	{
+		tson::MapInfo info;
+		const char *text = static_cast<const char *>(data);
+		size_t start = (size >= 3 && std::memcmp(text, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+		while(start < size && (text[start] == ' ' || text[start] == '\n' || text[start] == '\r' || text[start] == '\t'))
+			++start;
+
+		bool ok = false;
+		if(start < size && text[start] == '{')
+			ok = probeJson(text + start, size - start, info);
+		else if(start < size && text[start] == '<')
+			ok = probeXml(text + start, size - start, info);
+
+		if(!ok)
+			info.status = tson::ParseStatus::ParseError;
+		return info;
 	}
 
-	tson::TiledClass *ProjectPropertyTypes::getClass(std::string_view name)
+	/*!
+	 * Probes every .json, .tmj and .tmx file in a folder on several threads.
+	 * @param threadCount Number of threads. 0 uses the number of hardware threads.
+	 * @param recursive Include subfolders
+	 * @return Maps, and files that could not be read, sorted by path. Other json files, like tilesets and worlds, are left out.
+	 */
+	std::vector<tson::MapInfo> MapProbe::probeDirectory(const fs::path &folder, size_t threadCount, bool recursive)
 	{
-		auto it = std::find_if(m_classes.begin(), m_classes.end(), [&](const TiledClass &def)
+		//Folders that cannot be read are skipped, and an error while iterating ends the search with the files found so far
+		std::vector<fs::path> files;
+		std::error_code error;
+		auto const collect = [&](auto it)
 		{
-			return def.getName() == name;
-		});
-
-		if(it != m_classes.end())
-			return &it.operator*();
+			for(decltype(it) const last; !error && it != last; it.increment(error))
+			{
+				std::error_code statusError;
+				if(it->is_regular_file(statusError) && IsMapFile(it->path()))
+					files.push_back(it->path());
+			}
+		};
 
-		return nullptr;
-	}
-}
+		if(fs::is_directory(folder, error))
+		{
+			if(recursive)
+				collect(fs::recursive_directory_iterator(folder, fs::directory_options::skip_permission_denied, error));
+			else
+				collect(fs::directory_iterator(folder, fs::directory_options::skip_permission_denied, error));
+		}
+		std::sort(files.begin(), files.end());
 
-#endif //TILESON_PROJECTPROPERTYTYPES_HPP
+		std::vector<tson::MapInfo> infos(files.size());
+		std::atomic<size_t> next {0};
+		auto work = [&](MapProbe &probe)
+		{
+			for(size_t i = next++; i < files.size(); i = next++)
+				infos[i] = probe.probe(files[i]);
+		};
 
-/*** End of inlined file: ProjectPropertyTypes.hpp ***/
+		if(threadCount == 0)
+			threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+		threadCount = std::min(threadCount, std::max<size_t>(1, files.size()));
 
+		//Every thread has its own probe, as the json parsers are not thread safe
+		std::vector<std::thread> threads;
+		for(size_t i = 1; i < threadCount; ++i)
+		{
+			threads.emplace_back([&, json = (m_json != nullptr) ? m_json->create() : nullptr]() mutable
+			{
+				MapProbe probe {std::move(json)};
+				work(probe);
+			});
+		}
+		work(*this);
+		for(std::thread &thread : threads)
+			thread.join();
 
-/*** Start of inlined file: ProjectFolder.hpp ***/
-//
-// Created by robin on 01.08.2020.
-//
+		infos.erase(std::remove_if(infos.begin(), infos.end(), [](const tson::MapInfo &info)
+		{
+			return info.status == tson::ParseStatus::OK && !info.isMap();
+		}), infos.end());
+		return infos;
+	}
 
-#ifndef TILESON_PROJECTFOLDER_HPP
-#define TILESON_PROJECTFOLDER_HPP
+	bool MapProbe::IsMapFile(const fs::path &path)
+	{
+		std::string extension = path.extension().u8string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return extension == ".json" || extension == ".tmj" || extension == ".tmx";
+	}
 
-namespace tson
-{
-	class ProjectFolder
+	bool MapProbe::probeJson(const char *data, size_t size, tson::MapInfo &info)
 	{
-		public:
-			inline ProjectFolder(const fs::path &path);
+		enum Found : uint32_t
+		{
+			Width = 1, Height = 2, TileWidth = 4, TileHeight = 8, Orientation = 16, Infinite = 32,
+			Layers = 64, Tilesets = 128, Properties = 256, Type = 512, Class = 1024, All = 2047
+		};
 
-			inline const fs::path &getPath() const;
-			inline bool hasWorldFile() const;
-			inline const std::vector<ProjectFolder> &getSubFolders() const;
-			inline const std::vector<fs::path> &getFiles() const;
-			inline const World &getWorld() const;
+		JsonCursor cursor {data, size};
+		uint32_t found = 0;
+		bool stopped = false;
+		double number = 0.0;
+		std::string_view properties;
 
-		private:
-			inline void loadData();
-			fs::path                    m_path;
-			bool                        m_hasWorldFile;
-			tson::World                 m_world;
-			std::vector<ProjectFolder>  m_subFolders;
-			std::vector<fs::path>       m_files;
+		bool ok = cursor.readObject([&](std::string_view key)
+		{
+			bool result;
+			if(key == "width") { result = cursor.readNumber(number); info.size.x = static_cast<int>(number); found |= Width; }
+			else if(key == "height") { result = cursor.readNumber(number); info.size.y = static_cast<int>(number); found |= Height; }
+			else if(key == "tilewidth") { result = cursor.readNumber(number); info.tileSize.x = static_cast<int>(number); found |= TileWidth; }
+			else if(key == "tileheight") { result = cursor.readNumber(number); info.tileSize.y = static_cast<int>(number); found |= TileHeight; }
+			else if(key == "orientation") { result = cursor.readString(info.orientation); found |= Orientation; }
+			else if(key == "infinite") { result = cursor.readBool(info.infinite); found |= Infinite; }
+			else if(key == "layers") { result = readJsonLayers(cursor, info.layers); found |= Layers; }
+			else if(key == "type") { result = cursor.readString(info.type); found |= Type; }
+			else if(key == "class") { result = cursor.readString(info.classType); found |= Class; }
+			else if(key == "properties") { result = cursor.skipValue(properties); found |= Properties; }
+			else if(key == "tilesets")
+			{
+				found |= Tilesets;
+				result = cursor.readArray([&]()
+				{
+					tson::MapInfo::TilesetInfo &tileset = info.tilesets.emplace_back();
+					return cursor.readObject([&](std::string_view tilesetKey)
+					{
+						if(tilesetKey == "firstgid")
+						{
+							bool const read = cursor.readNumber(number);
+							tileset.firstgid = static_cast<int>(number);
+							return read;
+						}
+						if(tilesetKey == "name")
+							return cursor.readString(tileset.name);
+						if(tilesetKey == "source")
+							return cursor.readString(tileset.source);
+						return cursor.skipValue();
+					});
+				});
+			}
+			else
+				result = cursor.skipValue();
 
-	};
+			//Everything has been found: Returning false stops reading
+			stopped = result && found == All;
+			return result && !stopped;
+		});
 
-	ProjectFolder::ProjectFolder(const fs::path &path) : m_path {path}
-	{
-		loadData();
+		if(!stopped && (!ok || !cursor.isAtEnd()))
+			return false;
+
+		if(info.type.empty() && (found & Layers) != 0)
+			info.type = "map";
+		if(!properties.empty() && m_json != nullptr)
+		{
+			std::string const wrapped = "{\"properties\":" + std::string(properties) + "}";
+			if(m_json->parse(wrapped.data(), wrapped.size()))
+				ReadProperties(*m_json, info.properties);
+		}
+		return true;
 	}
 
-	void ProjectFolder::loadData()
+	bool MapProbe::readJsonLayers(JsonCursor &cursor, std::vector<tson::MapInfo::LayerInfo> &layers)
 	{
-		m_hasWorldFile = false;
-		m_subFolders.clear();
-		m_files.clear();
-		//Search and see if there is a World file .world file
-		fs::path worldPath;
-		for (const auto & entry : fs::directory_iterator(m_path))
+		return cursor.readArray([&]()
 		{
-			if(fs::is_regular_file(entry.path()))
+			tson::MapInfo::LayerInfo &layer = layers.emplace_back();
+			return cursor.readObject([&](std::string_view key)
 			{
-				if(entry.path().extension() == ".world")
+				if(key == "id")
 				{
-					m_hasWorldFile = true;
-					worldPath = entry.path();
+					double id = 0.0;
+					bool const read = cursor.readNumber(id);
+					layer.id = static_cast<int>(id);
+					return read;
 				}
-			}
-		}
+				if(key == "name")
+					return cursor.readString(layer.name);
+				if(key == "type")
+				{
+					std::string type;
+					bool const read = cursor.readString(type);
+					layer.type = ToLayerType(type);
+					return read;
+				}
+				if(key == "layers")
+					return readJsonLayers(cursor, layer.layers);
+				return cursor.skipValue();
+			});
+		});
+	}
 
-		if(m_hasWorldFile)
-			m_world.parse(worldPath);
+	bool MapProbe::probeXml(const char *data, size_t size, tson::MapInfo &info)
+	{
+		XmlReader reader {data, size};
+		if(reader.nextStartElement() != XmlReader::Token::StartElement)
+			return false;
 
-		for (const auto & entry : fs::directory_iterator(m_path))
+		info.type = reader.getName();
+		if(info.type != "map")
+			return true;
+
+		info.size = {ToInt(reader.getAttribute("width")), ToInt(reader.getAttribute("height"))};
+		info.tileSize = {ToInt(reader.getAttribute("tilewidth")), ToInt(reader.getAttribute("tileheight"))};
+		info.orientation = XmlReader::Unescape(reader.getAttribute("orientation"));
+		info.classType = XmlReader::Unescape(reader.getAttribute("class"));
+		info.infinite = reader.getAttribute("infinite") == "1";
+
+		while(true)
 		{
-			if (fs::is_directory(entry.path()))
-				m_subFolders.emplace_back(entry.path());//.loadData(); - loadData() is called in the constructor, so don't call again.
-			else if (fs::is_regular_file(entry.path()))
+			XmlReader::Token const token = reader.nextStartElement();
+			if(token == XmlReader::Token::EndElement)
+				return true;
+			if(token != XmlReader::Token::StartElement)
+				return false;
+
+			std::string_view const name = reader.getName();
+			if(name == "tileset")
 			{
-				if(m_hasWorldFile && m_world.contains(entry.path().filename().generic_string()))
-					m_files.emplace_back(entry.path());
-				else if(!m_hasWorldFile)
-					m_files.emplace_back(entry.path());
+				tson::MapInfo::TilesetInfo &tileset = info.tilesets.emplace_back();
+				tileset.firstgid = ToInt(reader.getAttribute("firstgid"));
+				tileset.name = XmlReader::Unescape(reader.getAttribute("name"));
+				tileset.source = XmlReader::Unescape(reader.getAttribute("source"));
+				if(!reader.skipElement())
+					return false;
 			}
-		}
+			else if(ToLayerType(name) != tson::LayerType::Undefined)
+			{
+				if(!readXmlLayer(reader, info.layers.emplace_back()))
+					return false;
+			}
+			else if(name == "properties")
+			{
+				size_t const start = reader.getTokenOffset();
+				if(!reader.skipElement())
+					return false;
 
+				std::string const wrapped = "<map>" + std::string(data + start, reader.getOffset() - start) + "</map>";
+				if(m_tmxJson.parse(wrapped.data(), wrapped.size()))
+					ReadProperties(m_tmxJson, info.properties);
+			}
+			else if(!reader.skipElement())
+				return false;
+		}
 	}
 
-	const fs::path &ProjectFolder::getPath() const
+	/*!
+	 * Reads a layer element. Its content is skipped, except the layers of a group.
+	 */
+	bool MapProbe::readXmlLayer(XmlReader &reader, tson::MapInfo::LayerInfo &layer)
 	{
-		return m_path;
-	}
+		layer.id = ToInt(reader.getAttribute("id"));
+		layer.name = XmlReader::Unescape(reader.getAttribute("name"));
+		layer.type = ToLayerType(reader.getName());
+		if(layer.type != tson::LayerType::Group)
+			return reader.skipElement();
 
-	bool ProjectFolder::hasWorldFile() const
-	{
-		return m_hasWorldFile;
-	}
+		while(true)
+		{
+			XmlReader::Token const token = reader.nextStartElement();
+			if(token == XmlReader::Token::EndElement)
+				return true;
+			if(token != XmlReader::Token::StartElement)
+				return false;
 
-	const std::vector<ProjectFolder> &ProjectFolder::getSubFolders() const
-	{
-		return m_subFolders;
+			if(ToLayerType(reader.getName()) != tson::LayerType::Undefined)
+			{
+				if(!readXmlLayer(reader, layer.layers.emplace_back()))
+					return false;
+			}
+			else if(!reader.skipElement())
+				return false;
+		}
 	}
 
-	const std::vector<fs::path> &ProjectFolder::getFiles() const
+	void MapProbe::ReadProperties(IJson &json, tson::PropertyCollection &properties)
 	{
-		return m_files;
+		for(std::unique_ptr<IJson> &property : json.array("properties"))
+			properties.add(*property);
 	}
 
 	/*!
-	 * Only gives useful data if hasWorldFile() is true!
-	 * @return
+	 * The type of a layer from its json 'type' or its tmx element name
 	 */
-	const World &ProjectFolder::getWorld() const
+	tson::LayerType MapProbe::ToLayerType(std::string_view type)
 	{
-		return m_world;
+		if(type == "tilelayer" || type == "layer") return tson::LayerType::TileLayer;
+		if(type == "objectgroup") return tson::LayerType::ObjectGroup;
+		if(type == "imagelayer") return tson::LayerType::ImageLayer;
+		if(type == "group") return tson::LayerType::Group;
+		return tson::LayerType::Undefined;
 	}
-}
-
-#endif //TILESON_PROJECTFOLDER_HPP
-/*** End of inlined file: ProjectFolder.hpp ***/
 
+	int MapProbe::ToInt(std::string_view text)
+	{
+		return static_cast<int>(std::strtol(std::string(text).c_str(), nullptr, 10));
+	}
+}
 
-/*** Start of inlined file: ProjectData.hpp ***/
-//
-// Created by robin on 01.08.2020.
-//
+#endif //TILESON_MAPPROBE_HPP
 
-#ifndef TILESON_PROJECTDATA_HPP
-#define TILESON_PROJECTDATA_HPP
+/*** End of inlined file: MapProbe.hpp ***/
 
-namespace tson
-{
-	class ProjectData
-	{
-		public:
-			ProjectData() = default;
-			std::string automappingRulesFile;
-			std::vector<std::string> commands;
-			std::string extensionsPath;
-			std::vector<std::string> folders;
-			std::string objectTypesFile;
-			ProjectPropertyTypes projectPropertyTypes;
 
-			//Tileson specific
-			fs::path basePath;
-			std::vector<tson::ProjectFolder> folderPaths;
-	};
-}
+/*** Start of inlined file: ParsePool.hpp ***/
+#ifndef TILESON_PARSEPOOL_HPP
+#define TILESON_PARSEPOOL_HPP
 
-#endif //TILESON_PROJECTDATA_HPP
-/*** End of inlined file: ProjectData.hpp ***/
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <condition_variable>
 
 namespace tson
 {
-	class Project
+	/*!
+	 * The background threads of tson::Tileson::parseAsync() and tson::Tileson::parseMany().
+	 *
+	 * Each thread owns a tson::Tileson with its own json backend and decompressors, so maps are parsed without sharing any parse state.
+	 * Jobs are run in the order they are pushed, by whichever thread is free first.
+	 * An exception thrown by a job does not stop its thread. The first one is rethrown by wait().
+	 */
+	class ParsePool
 	{
 		public:
-			#ifdef JSON11_IS_DEFINED
-			inline explicit Project(std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>()) : m_json {std::move(jsonParser)}
-			{
+			/*! Runs on a background thread, with the parser owned by that thread */
+			using Job = std::function<void(tson::Tileson &parser)>;
 
-			}
-			inline explicit Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>());
-			#else
-			inline explicit Project(std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
-			{
+			inline explicit ParsePool(std::vector<std::unique_ptr<tson::Tileson>> parsers); //tileson_forward.hpp
+			inline ~ParsePool(); //tileson_forward.hpp
 
-			}
-			inline explicit Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser);
-			#endif
-			inline bool parse(const fs::path &path);
-			inline void parse();
+			ParsePool(const ParsePool &) = delete;
+			ParsePool &operator=(const ParsePool &) = delete;
 
-			[[nodiscard]] inline const ProjectData &getData() const;
-			[[nodiscard]] inline const fs::path &getPath() const;
-			[[nodiscard]] inline const std::vector<ProjectFolder> &getFolders() const;
-			[[nodiscard]] inline tson::EnumDefinition* getEnumDefinition(std::string_view name);
-			[[nodiscard]] inline tson::TiledClass* getClass(std::string_view name);
+			inline void push(Job job);
+			inline void wait();
 
-		private:
-			inline void parseJson(IJson &json);
-			fs::path m_path;
-			std::vector<ProjectFolder> m_folders;
-			ProjectData m_data;
-			std::unique_ptr<IJson> m_json = nullptr;
-	};
+			[[nodiscard]] inline size_t getThreadCount() const;
 
-	Project::Project(const fs::path &path, std::unique_ptr<tson::IJson> jsonParser) : m_json {std::move(jsonParser)}
-	{
-		parse(path);
-	}
+			inline static size_t GetThreadCount(size_t threadCount);
 
-	bool Project::parse(const fs::path &path)
-	{
-		m_path = path;
-		std::ifstream i(m_path.generic_string());
+		private:
+			/*! Counts a job as finished when it goes out of scope, even when the job throws */
+			class ActiveJob
+			{
+				public:
+					inline explicit ActiveJob(ParsePool &pool) : m_pool {pool} {}
+					inline ~ActiveJob();
 
-		try
-		{
-			if(!m_json->parse(path))
-				return false;
-		}
-		catch(const std::exception &error)
-		{
-			std::string message = "Parse error: ";
-			message += std::string(error.what());
-			message += std::string("\n");
-			return false;
-		}
-		parseJson(*m_json);
-		return true;
-	}
+					ActiveJob(const ActiveJob &) = delete;
+					ActiveJob &operator=(const ActiveJob &) = delete;
 
-	const ProjectData &Project::getData() const
-	{
-		return m_data;
-	}
+				private:
+					ParsePool &m_pool;
+			};
 
-	void Project::parseJson(IJson &json)
-	{
-		m_data.basePath = (m_path.empty()) ? fs::path() : m_path.parent_path(); //The directory of the project file
+			inline void workerLoop(tson::Tileson &parser);
 
-		//Make sure these property types are read before any map is, so they can be resolved.
-		if(json.count("propertyTypes") > 0)
-		{
-			m_data.projectPropertyTypes.parse(json, this);
-		}
+			std::vector<std::unique_ptr<tson::Tileson>> m_parsers;
 
-		if(json.count("automappingRulesFile") > 0) m_data.automappingRulesFile = json["automappingRulesFile"].get<std::string>();
-		if(json.count("commands") > 0)
-		{
-			m_data.commands.clear();
-			auto &commands = json.array("commands");
-			std::for_each(commands.begin(), commands.end(), [&](std::unique_ptr<IJson> &item)
-			{
-				m_data.commands.emplace_back(item->get<std::string>());
-			});
-		}
-		if(json.count("extensionsPath") > 0) m_data.extensionsPath = json["extensionsPath"].get<std::string>();
-		if(json.count("folders") > 0)
+			//Shared with the background threads. Guarded by m_mutex.
+			std::mutex                          m_mutex;
+			std::condition_variable             m_workAvailable;
+			std::condition_variable             m_workDone;
+			std::deque<Job>                     m_queue;
+			size_t                              m_activeJobs {};
+			std::exception_ptr                  m_error;                /*! The first exception thrown by a job, until wait() rethrows it */
+			bool                                m_stop {false};
+			std::vector<std::thread>            m_threads;
+	};
+
+	/*!
+	 * Queues a job, which is run by the first background thread that is free
+	 */
+	void ParsePool::push(Job job)
+	{
 		{
-			m_data.folders.clear();
-			m_data.folderPaths.clear();
-			auto &folders = json.array("folders");
-			std::for_each(folders.begin(), folders.end(), [&](std::unique_ptr<IJson> &item)
-			{
-				std::string folder = item->get<std::string>();
-				m_data.folders.emplace_back(folder);
-				m_data.folderPaths.emplace_back(m_data.basePath / folder);
-				m_folders.emplace_back(m_data.basePath / folder);
-			});
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push_back(std::move(job));
 		}
-		if(json.count("objectTypesFile") > 0) m_data.objectTypesFile = json["objectTypesFile"].get<std::string>();
+		m_workAvailable.notify_one();
 	}
 
-	const fs::path &Project::getPath() const
+	/*!
+	 * Blocks until every queued job has finished. Rethrows the first exception thrown by a job since the last call.
+	 */
+	void ParsePool::wait()
 	{
-		return m_path;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workDone.wait(lock, [&]() { return m_queue.empty() && m_activeJobs == 0; });
+
+		std::exception_ptr error = m_error;
+		m_error = nullptr;
+		lock.unlock();
+		if(error != nullptr)
+			std::rethrow_exception(error);
 	}
 
-	const std::vector<ProjectFolder> &Project::getFolders() const
+	size_t ParsePool::getThreadCount() const
 	{
-		return m_folders;
+		return m_threads.size();
 	}
 
-	tson::EnumDefinition *Project::getEnumDefinition(std::string_view name)
+	/*!
+	 * @param threadCount A requested number of threads. 0 means the number of hardware threads.
+	 * @return The number of threads to start. At least 1.
+	 */
+	size_t ParsePool::GetThreadCount(size_t threadCount)
 	{
-		return m_data.projectPropertyTypes.getEnumDefinition(name);
+		return (threadCount == 0) ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : threadCount;
 	}
 
-	tson::TiledClass *Project::getClass(std::string_view name)
+	void ParsePool::workerLoop(tson::Tileson &parser)
 	{
-		return m_data.projectPropertyTypes.getClass(name);
+		while(true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workAvailable.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+				//Queued jobs are finished before stopping, so every future gets its map
+				if(m_queue.empty())
+					return;
+
+				job = std::move(m_queue.front());
+				m_queue.pop_front();
+				++m_activeJobs;
+			}
+
+			ActiveJob const active {*this};
+			try
+			{
+				job(parser);
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if(m_error == nullptr)
+					m_error = std::current_exception();
+			}
+		}
 	}
 
-	/*!
-	 * Parses preloaded json data. Only used during tests involving project jsons not actually read from files
-	 * @return
-	 */
-	void Project::parse()
+	ParsePool::ActiveJob::~ActiveJob()
 	{
-		parseJson(*m_json);
+		{
+			std::lock_guard<std::mutex> lock(m_pool.m_mutex);
+			--m_pool.m_activeJobs;
+		}
+		m_pool.m_workDone.notify_all();
 	}
-
 }
 
-#endif //TILESON_PROJECT_HPP
+#endif //TILESON_PARSEPOOL_HPP
 
-/*** End of inlined file: Project.hpp ***/
+/*** End of inlined file: ParsePool.hpp ***/
 
 namespace tson
 {
 	class Tileson
 	{
 		public:
+			/*! Gets each map parsed by parseMany(). Called from the background threads. */
+			using ParseCallback = std::function<void(size_t index, std::unique_ptr<tson::Map> map)>;
+
 			#ifdef JSON11_IS_DEFINED
 			inline explicit Tileson(std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>(), bool includeBase64Decoder = true);
 			inline explicit Tileson(tson::Project *project, std::unique_ptr<tson::IJson> jsonParser = std::make_unique<tson::Json11>(), bool includeBase64Decoder = true);
@@ -7461,13 +19805,55 @@ namespace tson
 
 			inline std::unique_ptr<tson::Map> parse(const fs::path &path, std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor = nullptr);
 			inline std::unique_ptr<tson::Map> parse(const void * data, size_t size, std::unique_ptr<IDecompressor<std::vector<uint8_t>, std::vector<uint8_t>>> decompressor = nullptr);
+			inline std::unique_ptr<tson::Map> parse(const tson::Archive &archive, const fs::path &path);
+			inline std::future<std::unique_ptr<tson::Map>> parseAsync(const fs::path &path);
+			inline std::future<std::unique_ptr<tson::Map>> parseAsync(const tson::Archive &archive, const fs::path &path);
+			inline std::vector<std::future<std::unique_ptr<tson::Map>>> parseMany(const std::vector<fs::path> &paths);
+			inline void parseMany(const std::vector<fs::path> &paths, ParseCallback callback);
+			inline void waitForParses();
 			inline tson::DecompressorContainer *decompressors();
+			inline void setTilesetCache(std::shared_ptr<tson::TilesetCache> tilesetCache);
+			[[nodiscard]] inline const std::shared_ptr<tson::TilesetCache> &getTilesetCache() const;
+			inline void setTemplateCache(std::shared_ptr<tson::TemplateCache> templateCache);
+			[[nodiscard]] inline const std::shared_ptr<tson::TemplateCache> &getTemplateCache() const;
+			inline void setSnapshotMode(tson::SnapshotMode snapshotMode);
+			[[nodiscard]] inline tson::SnapshotMode getSnapshotMode() const;
+			inline void setLayerFilter(tson::LayerFilter layerFilter);
+			[[nodiscard]] inline const tson::LayerFilter &getLayerFilter() const;
+			inline void setLazyLayers(bool lazyLayers);
+			[[nodiscard]] inline bool hasLazyLayers() const;
+			inline void setTileRegion(const tson::Rect &tileRegion);
+			[[nodiscard]] inline const tson::Rect &getTileRegion() const;
+			inline void setThreadCount(size_t threadCount);
+			[[nodiscard]] inline size_t getThreadCount() const;
+
+			inline static std::unique_ptr<tson::Map> CreateFailedMap(const std::exception_ptr &error);
 
 		private:
-			inline std::unique_ptr<tson::Map> parseJson();
+			inline std::unique_ptr<tson::Map> parseJson(tson::LinkedFileParser linkedFileParser = nullptr);
+			inline std::unique_ptr<tson::Map> parseWithSnapshot(const fs::path &path);
+			/*! Parses a map with the parser of a background thread */
+			using ParseFunction = std::function<std::unique_ptr<tson::Map>(tson::Tileson &parser)>;
+			/*! Gets the map of a job, or the exception thrown while parsing it */
+			using ParseResult = std::function<void(std::unique_ptr<tson::Map> map, std::exception_ptr error)>;
+
+			inline void pushParseJob(ParseFunction parse, ParseResult result);
+			inline std::future<std::unique_ptr<tson::Map>> pushAsyncParseJob(ParseFunction parse);
 			std::unique_ptr<tson::IJson> m_json;
 			tson::DecompressorContainer m_decompressors;
 			tson::Project *m_project {nullptr};
+			std::shared_ptr<tson::TilesetCache> m_tilesetCache;
+			std::shared_ptr<tson::TemplateCache> m_templateCache;
+			tson::SnapshotMode m_snapshotMode {tson::SnapshotMode::Disabled};
+			tson::LayerFilter m_layerFilter;
+			bool m_lazyLayers {false};
+			tson::Rect m_tileRegion;
+			size_t m_threadCount {0};
+			std::unique_ptr<tson::ParsePool> m_pool;    //Created by the first background parse
+			//The decompressors the background parsers clone. Replaced when decompressors() changes.
+			//In a background parser: The decompressors its own were cloned from.
+			std::shared_ptr<const tson::DecompressorContainer> m_poolDecompressors;
+			uint64_t m_poolDecompressorsRevision {0};
 	};
 }
 
@@ -7511,6 +19897,10 @@ std::unique_ptr<tson::Map> tson::Tileson::parse(const fs::path &path, std::uniqu
 		if(result)
 			return parseJson();
 	}
+	else if(m_snapshotMode != tson::SnapshotMode::Disabled && !m_layerFilter && m_tileRegion.width <= 0)
+	{
+		return parseWithSnapshot(path);
+	}
 	else if(m_json->parse(path))
 	{
 		return parseJson();
@@ -7548,25 +19938,96 @@ std::unique_ptr<tson::Map> tson::Tileson::parse(const void *data, size_t size, s
 	return parseJson();
 }
 
+/*!
+ * Parses a map in a tson::Archive. External tilesets and templates are read from the archive, relative to the map.
+ * @param archive The archive. Must stay open while parsing.
+ * @param path Path of the map in the archive
+ * @return parsed data as Map
+ */
+std::unique_ptr<tson::Map> tson::Tileson::parse(const tson::Archive &archive, const fs::path &path)
+{
+	std::vector<uint8_t> content;
+	if(!archive.read(path, content))
+		return std::make_unique<tson::Map>(tson::ParseStatus::FileNotFound, "File not found in archive: " + path.generic_string());
+
+	if(!m_json->parse(content.data(), content.size()))
+		return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Parse error: " + path.generic_string());
+
+	//Paths of the map, like the images of tilesets, are relative to the root of the archive
+	m_json->directory(fs::path(tson::Archive::NormalizePath(path)).parent_path());
+	return parseJson(archive.createLinkedFileParser(*m_json, path));
+}
+
 /*!
  * Common parsing functionality for doing the json parsing
  * @param json Tiled json to parse
  * @return parsed data as Map
  */
-std::unique_ptr<tson::Map> tson::Tileson::parseJson()
+std::unique_ptr<tson::Map> tson::Tileson::parseJson(tson::LinkedFileParser linkedFileParser)
 {
 	std::unique_ptr<tson::Map> map = std::make_unique<tson::Map>();
+	map->setTilesetCache(m_tilesetCache.get());
+	map->setTemplateCache(m_templateCache.get());
+	map->setLayerFilter(m_layerFilter);
+	map->setTileRegion(m_tileRegion);
+
+	tson::IJson *json = m_json.get();
+	tson::DecompressorContainer *decompressors = &m_decompressors;
+	if(m_lazyLayers)
+	{
+		//The lazy layers of the map read from its json until they are loaded, so the map takes it and a new one is used for the next parse
+		map->m_json = std::move(m_json);
+		m_json = json->create();
+
+		//The map can outlive this parser, so it gets its own decompressors and keeps the template cache alive
+		map->m_lazyDecompressors = std::make_unique<tson::DecompressorContainer>(m_decompressors.clone());
+		map->m_lazyTemplateCache = m_templateCache;
+		decompressors = map->m_lazyDecompressors.get();
+	}
 
-	if(map->parse(*m_json, &m_decompressors, m_project))
+	if(map->parse(*json, decompressors, m_project, std::move(linkedFileParser)))
 		return map;
 
 	return std::make_unique<tson::Map> (tson::ParseStatus::MissingData, "Missing map data...");
 }
 
+/*!
+ * Parses a map file through its .tsonb snapshot (see tson::MapSnapshot): The snapshot is loaded instead of the json
+ * when it was made from the same json, and none of the files the map depends on have changed since.
+ * Otherwise the json is parsed, and a new snapshot is written when the mode is tson::SnapshotMode::ReadWrite.
+ * @param path path to file
+ * @return parsed data as Map
+ */
+std::unique_ptr<tson::Map> tson::Tileson::parseWithSnapshot(const fs::path &path)
+{
+	std::vector<uint8_t> source;
+	std::error_code error;
+	fs::file_time_type const modified = fs::last_write_time(path, error);
+	if(error || !tson::MapSnapshot::ReadFile(path, source) || source.empty())
+		return std::make_unique<tson::Map>(tson::ParseStatus::FileNotFound, "File not found: " + path.generic_string());
+
+	uint64_t const hash = tson::MapSnapshot::Hash(source.data(), source.size());
+	fs::path const snapshotPath = tson::MapSnapshot::GetPath(path);
+	std::unique_ptr<tson::Map> map = tson::MapSnapshot::LoadIfCurrent(snapshotPath, hash, modified, m_project, &m_decompressors);
+	if(map != nullptr)
+		return map;
+
+	if(!m_json->parse(source.data(), source.size()))
+		return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Parse error: " + path.generic_string());
+	m_json->directory(path.parent_path());
+
+	map = parseJson();
+	if(m_snapshotMode == tson::SnapshotMode::ReadWrite && map->getStatus() == tson::ParseStatus::OK)
+		tson::MapSnapshot::Save(*map, snapshotPath, hash, path.parent_path());
+
+	return map;
+}
+
 /*!
  * Gets the decompressor container used when something is either encoded or compressed (regardless: IDecompressor is used as base).
  * These are used specifically for tile layers, and are connected by checking the name of the IDecompressor. If the name of a decompressor
  * matches with an encoding or a compression, its decompress() function will be used.
+ * Changes are also used by the maps parseAsync() and parseMany() queue after them, as the background threads clone the decompressors again.
  *
  * @return The container including all decompressors.
  */
@@ -7575,6 +20036,309 @@ tson::DecompressorContainer *tson::Tileson::decompressors()
 	return &m_decompressors;
 }
 
+/*!
+ * Attaches a cache of external tilesets. Maps parsed afterwards copy their external tilesets from the cache,
+ * so a tileset file shared by many maps is only parsed once. The cache can be shared by several tson::Tileson instances.
+ * @param tilesetCache The cache. nullptr parses every external tileset again.
+ */
+void tson::Tileson::setTilesetCache(std::shared_ptr<tson::TilesetCache> tilesetCache)
+{
+	m_tilesetCache = std::move(tilesetCache);
+}
+
+/*!
+ * The attached tileset cache. nullptr if there is none.
+ */
+const std::shared_ptr<tson::TilesetCache> &tson::Tileson::getTilesetCache() const
+{
+	return m_tilesetCache;
+}
+
+/*!
+ * Attaches a cache of object templates. Maps parsed afterwards parse each template file once, and their template instances
+ * only read the fields they override. The cache can be shared by several tson::Tileson instances.
+ * @param templateCache The cache. nullptr reads the template file for every instance.
+ */
+void tson::Tileson::setTemplateCache(std::shared_ptr<tson::TemplateCache> templateCache)
+{
+	m_templateCache = std::move(templateCache);
+}
+
+/*!
+ * The attached template cache. nullptr if there is none.
+ */
+const std::shared_ptr<tson::TemplateCache> &tson::Tileson::getTemplateCache() const
+{
+	return m_templateCache;
+}
+
+/*!
+ * Lets parse() of a file use a binary snapshot of the map ('<map>.tsonb' next to it), which loads without any json parsing.
+ * Snapshots are only used for files parsed without a decompressor, a layer filter or a tile region.
+ * @param snapshotMode tson::SnapshotMode::Read only loads snapshots that exist. tson::SnapshotMode::ReadWrite also writes them.
+ */
+void tson::Tileson::setSnapshotMode(tson::SnapshotMode snapshotMode)
+{
+	m_snapshotMode = snapshotMode;
+}
+
+/*!
+ * How parse() of a file uses snapshots. tson::SnapshotMode::Disabled by default.
+ */
+tson::SnapshotMode tson::Tileson::getSnapshotMode() const
+{
+	return m_snapshotMode;
+}
+
+/*!
+ * Makes maps parsed afterwards skip the layers rejected by the filter, without reading their data or objects.
+ * The filter gets each layer with only its own fields read, so layers can be chosen by name, type, class, visibility etc.
+ * A rejected group layer is kept if any of its child layers are accepted. All child layers of an accepted group are kept.
+ *
+ * Example: t.setLayerFilter([](const tson::Layer &layer) { return layer.getType() == tson::LayerType::ObjectGroup; });
+ *
+ * NOTE: Snapshots (see setSnapshotMode()) are not read or written while a layer filter is set, as they hold every layer.
+ * @param layerFilter The filter. An empty filter keeps every layer.
+ */
+void tson::Tileson::setLayerFilter(tson::LayerFilter layerFilter)
+{
+	m_layerFilter = std::move(layerFilter);
+}
+
+/*!
+ * The layer filter. Empty if every layer is kept.
+ */
+const tson::LayerFilter &tson::Tileson::getLayerFilter() const
+{
+	return m_layerFilter;
+}
+
+/*!
+ * Makes maps parsed afterwards only read the fields and properties of their layers. The tile data, chunks and objects of a layer
+ * are read the first time something needs them (like Layer::getData() or Layer::getObjects()), or when Layer::load() or Map::loadLayers() is called.
+ * Map-wide object lookups like Map::getObj() load all layers.
+ * The map keeps its json until every layer is loaded. Linked files, like external templates, must also be readable until then.
+ * The map gets its own copy of the decompressors, and shares the template cache, so it does not depend on this parser.
+ * The project (see the constructor), which holds the classes and enums of properties, must outlive the map's lazy layers.
+ *
+ * NOTE: Loading changes the map, so a map with lazy layers must not be used from several threads until Map::loadLayers() has been called.
+ * @param lazyLayers true to defer reading the layers
+ */
+void tson::Tileson::setLazyLayers(bool lazyLayers)
+{
+	m_lazyLayers = lazyLayers;
+}
+
+/*!
+ * Whether maps are parsed with lazy layers. false by default.
+ */
+bool tson::Tileson::hasLazyLayers() const
+{
+	return m_lazyLayers;
+}
+
+/*!
+ * Makes maps parsed afterwards only decode the tiles inside a rectangle of each tile layer, like the part of a big map a server
+ * shard is responsible for. The other tiles are skipped without being stored:
+ * csv data skips the items outside the rectangle, uncompressed base64 data is decoded from the position of each row,
+ * and zlib/gzip data is decompressed as a stream where only the rows inside the rectangle are kept.
+ *
+ * The data of such layers only holds the region. See tson::Layer::hasRegion(). Infinite maps only read the chunks overlapping the rectangle.
+ * Snapshots (see setSnapshotMode()) are not read or written while a region is set, as they hold every tile.
+ * @param tileRegion The rectangle in tile units. An empty rectangle decodes every tile, which is the default.
+ */
+void tson::Tileson::setTileRegion(const tson::Rect &tileRegion)
+{
+	m_tileRegion = tileRegion;
+}
+
+/*!
+ * The rectangle of tiles that is decoded. Empty if every tile is decoded.
+ */
+const tson::Rect &tson::Tileson::getTileRegion() const
+{
+	return m_tileRegion;
+}
+
+/*!
+ * Parses a map on a background thread. See parseMany().
+ * @param path path to file
+ * @return The parsed map, once it is ready. Holds the exception if parsing threw one, like std::bad_alloc.
+ */
+std::future<std::unique_ptr<tson::Map>> tson::Tileson::parseAsync(const fs::path &path)
+{
+	return pushAsyncParseJob([path](tson::Tileson &parser) { return parser.parse(path); });
+}
+
+/*!
+ * Parses a map in a tson::Archive on a background thread. See parseMany().
+ * @param archive The archive. Must outlive the parsing of the map.
+ * @param path Path of the map in the archive
+ * @return The parsed map, once it is ready. Holds the exception if parsing threw one, like std::bad_alloc.
+ */
+std::future<std::unique_ptr<tson::Map>> tson::Tileson::parseAsync(const tson::Archive &archive, const fs::path &path)
+{
+	return pushAsyncParseJob([&archive, path](tson::Tileson &parser) { return parser.parse(archive, path); });
+}
+
+/*!
+ * Parses maps on background threads, like the maps of a tson::World or the files of a tson::ProjectFolder.
+ * The number of threads is set by setThreadCount(). Each thread has its own json backend (created by IJson::create())
+ * and its own copy of the decompressors (see DecompressorContainer::clone()), so the maps are parsed without sharing any parse state.
+ * The tileset cache, template cache and project are shared by all threads.
+ *
+ * The options of this parser (caches, decompressors, snapshot mode, layer filter, lazy layers, tile region) are copied when the maps are queued.
+ * A map that failed to parse has the status of the failure, like tson::ParseStatus::FileNotFound.
+ * @param paths The files to parse
+ * @return The parsed maps, once they are ready, in the order of the paths. A future holds the exception if parsing threw one.
+ */
+std::vector<std::future<std::unique_ptr<tson::Map>>> tson::Tileson::parseMany(const std::vector<fs::path> &paths)
+{
+	std::vector<std::future<std::unique_ptr<tson::Map>>> futures;
+	futures.reserve(paths.size());
+	for(const fs::path &path : paths)
+		futures.push_back(parseAsync(path));
+	return futures;
+}
+
+/*!
+ * Parses maps on background threads, like parseMany() without a callback, but gives each map to the callback as soon as it is parsed.
+ * Returns right away. Use waitForParses() to block until every map has been given to the callback.
+ * When parsing throws, the callback gets a map with tson::ParseStatus::ParseError and the message of the exception.
+ * @param paths The files to parse
+ * @param callback Gets the index of the path and the parsed map. Called from the background threads, so several calls can run at the same time.
+ * An exception thrown by the callback is rethrown by waitForParses().
+ */
+void tson::Tileson::parseMany(const std::vector<fs::path> &paths, ParseCallback callback)
+{
+	for(size_t i = 0; i < paths.size(); ++i)
+	{
+		pushParseJob([path = paths[i]](tson::Tileson &parser) { return parser.parse(path); },
+					 [i, callback](std::unique_ptr<tson::Map> map, std::exception_ptr error)
+		{
+			callback(i, (error != nullptr) ? CreateFailedMap(error) : std::move(map));
+		});
+	}
+}
+
+/*!
+ * Blocks until every map queued by parseAsync() or parseMany() has been parsed.
+ * Rethrows the first exception thrown by a parseMany() callback since the last call.
+ */
+void tson::Tileson::waitForParses()
+{
+	if(m_pool != nullptr)
+		m_pool->wait();
+}
+
+/*!
+ * Number of background threads used by parseAsync() and parseMany(). Default: 0, which is the number of hardware threads.
+ * Maps that are already queued are parsed before the threads are replaced.
+ * @param threadCount Number of threads. 0 uses the number of hardware threads.
+ */
+void tson::Tileson::setThreadCount(size_t threadCount)
+{
+	m_threadCount = threadCount;
+	m_pool.reset();
+}
+
+size_t tson::Tileson::getThreadCount() const
+{
+	return m_threadCount;
+}
+
+/*!
+ * Queues the parsing of a map. The options of this parser are copied into the job, so they can be changed while it is queued.
+ * @param parse Parses the map with the parser of the background thread
+ * @param result Gets the parsed map, or the exception thrown while parsing it
+ */
+void tson::Tileson::pushParseJob(ParseFunction parse, ParseResult result)
+{
+	if(m_pool == nullptr)
+	{
+		std::vector<std::unique_ptr<tson::Tileson>> parsers;
+		for(size_t i = 0; i < tson::ParsePool::GetThreadCount(m_threadCount); ++i)
+			parsers.push_back(std::make_unique<tson::Tileson>(m_json->create(), false));
+		m_pool = std::make_unique<tson::ParsePool>(std::move(parsers));
+	}
+
+	//Decompressors added or removed since the last job are cloned again by the background parsers
+	if(m_poolDecompressors == nullptr || m_poolDecompressorsRevision != m_decompressors.getRevision())
+	{
+		m_poolDecompressors = std::make_shared<const tson::DecompressorContainer>(m_decompressors.clone());
+		m_poolDecompressorsRevision = m_decompressors.getRevision();
+	}
+
+	m_pool->push([parse = std::move(parse), result = std::move(result), decompressors = m_poolDecompressors, project = m_project, tilesetCache = m_tilesetCache,
+				  templateCache = m_templateCache, snapshotMode = m_snapshotMode, layerFilter = m_layerFilter,
+				  lazyLayers = m_lazyLayers, tileRegion = m_tileRegion](tson::Tileson &parser)
+	{
+		parser.m_project = project;
+		parser.m_tilesetCache = tilesetCache;
+		parser.m_templateCache = templateCache;
+		parser.m_snapshotMode = snapshotMode;
+		parser.m_layerFilter = layerFilter;
+		parser.m_lazyLayers = lazyLayers;
+		parser.m_tileRegion = tileRegion;
+
+		std::unique_ptr<tson::Map> map;
+		std::exception_ptr error;
+		try
+		{
+			if(parser.m_poolDecompressors != decompressors)
+			{
+				parser.m_decompressors = decompressors->clone();
+				parser.m_poolDecompressors = decompressors;
+			}
+			map = parse(parser);
+		}
+		catch(...)
+		{
+			error = std::current_exception();
+		}
+		result(std::move(map), error);
+	});
+}
+
+/*!
+ * Queues the parsing of a map, and gives the result to the returned future
+ */
+std::future<std::unique_ptr<tson::Map>> tson::Tileson::pushAsyncParseJob(ParseFunction parse)
+{
+	auto promise = std::make_shared<std::promise<std::unique_ptr<tson::Map>>>();
+	std::future<std::unique_ptr<tson::Map>> future = promise->get_future();
+	pushParseJob(std::move(parse), [promise](std::unique_ptr<tson::Map> map, std::exception_ptr error)
+	{
+		if(error != nullptr)
+			promise->set_exception(error);
+		else
+			promise->set_value(std::move(map));
+	});
+	return future;
+}
+
+/*!
+ * A map with the status tson::ParseStatus::ParseError, for a map whose parsing threw an exception.
+ * Used by parseMany() and tson::World::loadMaps() to report the exception as a failed map.
+ * @param error The exception
+ * @return A map with the message of the exception as its status message
+ */
+std::unique_ptr<tson::Map> tson::Tileson::CreateFailedMap(const std::exception_ptr &error)
+{
+	try
+	{
+		std::rethrow_exception(error);
+	}
+	catch(const std::exception &e)
+	{
+		return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, std::string("Exception while parsing: ") + e.what());
+	}
+	catch(...)
+	{
+		return std::make_unique<tson::Map>(tson::ParseStatus::ParseError, "Unknown exception while parsing");
+	}
+}
+
 #endif //TILESON_TILESON_PARSER_HPP
 
 /*** End of inlined file: tileson_parser.hpp ***/
@@ -7614,6 +20378,19 @@ tson::TiledClass *tson::Map::getClass()
 	return (m_class != nullptr) ? m_class.get() : nullptr;
 }
 
+/*!
+ * Gets a template from the template cache. Only available while parsing, for maps whose linked files are read from disk.
+ * @param relativePath Path to the template file, relative to the map file
+ * @return The template. nullptr if there is no cache, or the template could not be parsed.
+ */
+std::shared_ptr<const tson::ObjectTemplate> tson::Map::getTemplate(const std::string &relativePath)
+{
+	if(m_templateCache == nullptr || m_parsingJson == nullptr || m_hasCustomLinkedFileParser || m_parsingJson->directory().empty())
+		return nullptr;
+
+	return m_templateCache->get(m_parsingJson->directory() / relativePath, *m_parsingJson, this);
+}
+
 // T i l e . h p p
 // ---------------------
 /*!
@@ -7832,6 +20609,43 @@ tson::TiledClass *tson::Tileset::getClass()
 	return (m_class != nullptr) ? m_class.get() : nullptr;
 }
 
+/*!
+ * Copies an external tileset from a tson::TilesetCache, and binds the copy to the map and 'firstgid' of this tileset.
+ * m_source and m_path must be set.
+ */
+bool tson::Tileset::parseFromCache(IJson &json, tson::TilesetCache &cache)
+{
+	std::shared_ptr<const tson::TilesetCache::Entry> entry = cache.get(m_path, json, m_map);
+	if(entry == nullptr)
+		return false;
+
+	tson::Map *map = m_map;
+	int const firstgid = m_firstgid;
+	fs::path source = std::move(m_source);
+	fs::path path = std::move(m_path);
+
+	*this = *entry->tileset;
+	m_source = std::move(source);
+	m_path = std::move(path);
+	if(m_type == TilesetType::ImageTileset)
+		m_imagePath = m_path.parent_path() / m_image;
+	bind(map, firstgid);
+
+	return entry->allFound;
+}
+
+/*!
+ * Reads the external tileset file ('source') through the tson::LinkedFileParser of the map, if the map was given one.
+ * @return The tileset file. nullptr if the map reads linked files from disk, or the parser could not read it.
+ */
+tson::IJson *tson::Tileset::parseLinkedFile()
+{
+	if(m_map == nullptr || !m_map->m_hasCustomLinkedFileParser)
+		return nullptr;
+
+	return m_map->parseLinkedFile(m_source.generic_string());
+}
+
 // T i l e O b j e c t . h p p
 // ---------------------
 
@@ -7858,8 +20672,10 @@ const tson::Rect &tson::TileObject::getDrawingRect() const
 
 /*!
  * Decompresses data if there are matching decompressors
+ * @param region If set, only the tiles inside this rectangle are kept. Uncompressed and zlib/gzip compressed base64 data is decoded
+ * without creating the rest of the tiles.
  */
-void tson::Layer::decompressData()
+void tson::Layer::decompressData(const tson::Rect *region)
 {
 
 	tson::DecompressorContainer *container = m_map->getDecompressors();
@@ -7869,6 +20685,14 @@ void tson::Layer::decompressData()
 	if(m_encoding.empty() && m_compression.empty())
 		return;
 
+	bool const canDecodeRegion = m_encoding == "base64" && container->contains(m_encoding) &&
+								 (m_compression.empty() || ((m_compression == "zlib" || m_compression == "gzip") && container->contains(m_compression)));
+	if(region != nullptr && canDecodeRegion)
+	{
+		decodeRegion(*region);
+		return;
+	}
+
 	std::string data = m_base64Data;
 	bool hasBeenDecoded = false;
 	if(!m_encoding.empty() && container->contains(m_encoding))
@@ -7887,6 +20711,100 @@ void tson::Layer::decompressData()
 		std::vector<uint8_t> bytes = tson::Tools::Base64DecodedStringToBytes(data);
 		m_data = tson::Tools::BytesToUnsignedInts(bytes);
 	}
+
+	//Other compressions are decoded in full, and then cropped
+	if(region != nullptr && hasBeenDecoded)
+	{
+		std::vector<uint32_t> tiles;
+		tiles.reserve(static_cast<size_t>(region->width) * static_cast<size_t>(region->height));
+		for(int y = region->y; y < region->y + region->height; ++y)
+		{
+			for(int x = region->x; x < region->x + region->width; ++x)
+			{
+				size_t const i = static_cast<size_t>(y) * static_cast<size_t>(m_size.x) + static_cast<size_t>(x);
+				tiles.push_back((i < m_data.size()) ? m_data[i] : 0);
+			}
+		}
+		m_data = std::move(tiles);
+	}
+}
+
+/*!
+ * Decodes the tiles inside the region from base64 data, which is either uncompressed or compressed with zlib or gzip.
+ * Uncompressed rows are decoded directly from their position in the base64 string. Compressed data is decompressed as a stream,
+ * where only the bytes of the rows inside the region are kept, and decompressing stops after the last row of the region.
+ */
+void tson::Layer::decodeRegion(const tson::Rect &region)
+{
+	size_t const rowBytes = static_cast<size_t>(m_size.x) * 4;
+	size_t const regionRowBytes = static_cast<size_t>(region.width) * 4;
+	size_t const firstRow = static_cast<size_t>(region.y);
+	size_t const endRow = firstRow + static_cast<size_t>(region.height);
+	if(regionRowBytes == 0 || region.height <= 0)
+		return;
+
+	std::vector<uint8_t> bytes;
+	bytes.resize(regionRowBytes * static_cast<size_t>(region.height), 0);
+
+	if(m_compression.empty())
+	{
+		for(size_t row = firstRow; row < endRow; ++row)
+		{
+			size_t const offset = row * rowBytes + static_cast<size_t>(region.x) * 4;
+			if(!tson::Tools::Base64DecodeRange(m_base64Data, offset, regionRowBytes, bytes.data() + (row - firstRow) * regionRowBytes))
+				break;
+		}
+	}
+	else
+	{
+		std::string compressed = m_map->getDecompressors()->get(m_encoding)->decompress(m_base64Data);
+		size_t position = 0;    //Position of the next decompressed byte in the whole layer
+		tson::Inflate::Sink sink = [&](const uint8_t *data, size_t size) -> bool
+		{
+			size_t const end = position + size;
+			for(size_t row = std::max(position / rowBytes, firstRow); row < endRow && row * rowBytes < end; ++row)
+			{
+				size_t const rowStart = row * rowBytes + static_cast<size_t>(region.x) * 4;
+				size_t const from = std::max(rowStart, position);
+				size_t const to = std::min(rowStart + regionRowBytes, end);
+				if(from < to)
+					std::memcpy(bytes.data() + (row - firstRow) * regionRowBytes + (from - rowStart), data + (from - position), to - from);
+			}
+			position = end;
+			return position < endRow * rowBytes;
+		};
+
+		const auto *data = reinterpret_cast<const uint8_t *>(compressed.data());
+		if(m_compression == "zlib")
+			tson::Inflate::Zlib(data, compressed.size(), sink);
+		else
+			tson::Inflate::Gzip(data, compressed.size(), sink);
+	}
+
+	m_data = tson::Tools::BytesToUnsignedInts(bytes);
+}
+
+/*!
+ * The rectangle of the tile data to decode, when the map has a tile region (see tson::Map::setTileRegion()).
+ * Only finite tile layers are decoded as a region.
+ * @param region Receives the tile region of the map, clipped to the size of the layer
+ * @return true if only the region must be decoded
+ */
+bool tson::Layer::getDataRegion(tson::Rect &region) const
+{
+	if(m_map == nullptr || m_map->isInfinite() || m_type != tson::LayerType::TileLayer)
+		return false;
+
+	const tson::Rect &tileRegion = m_map->m_tileRegion;
+	if(tileRegion.width <= 0 || tileRegion.height <= 0)
+		return false;
+
+	int const x0 = std::clamp(tileRegion.x, 0, m_size.x);
+	int const y0 = std::clamp(tileRegion.y, 0, m_size.y);
+	int const x1 = std::clamp(tileRegion.x + tileRegion.width, 0, m_size.x);
+	int const y1 = std::clamp(tileRegion.y + tileRegion.height, 0, m_size.y);
+	region = {x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)};
+	return true;
 }
 
 /*!
@@ -7895,11 +20813,72 @@ void tson::Layer::decompressData()
  * @return true if all mandatory fields was found. false otherwise.
  */
 bool tson::Layer::parse(IJson &json, tson::Map *map)
+{
+	bool allFound = parseHeader(json, map);
+	if(json.count("layers") > 0 && json["layers"].isArray())
+		ParseLayers(json, m_map, m_layers, {}, false);
+
+	parseProperties(json);
+	parseData(json);
+	return allFound;
+}
+
+/*!
+ * Parses the 'layers' of json into layers.
+ * Layers rejected by filter are skipped before anything but their own fields are read. A rejected group is still kept
+ * if any of its child layers are accepted. The child layers of an accepted group are all kept.
+ * @param filter Which layers to keep. Keeps all layers if empty.
+ * @param lazy If true, the data, chunks and objects of the layers are not read until the layer is loaded. json must be owned by the map.
+ */
+void tson::Layer::ParseLayers(IJson &json, tson::Map *map, std::vector<tson::Layer> &layers, const tson::LayerFilter &filter, bool lazy)
+{
+	const tson::LayerFilter keepAll;
+	auto &array = json.array("layers");
+	for(std::unique_ptr<IJson> &item : array)
+	{
+		tson::Layer &layer = layers.emplace_back();
+		layer.parseHeader(*item, map);
+		bool const accepted = !filter || filter(layer);
+		if(!accepted && layer.m_type != tson::LayerType::Group)
+		{
+			layers.pop_back();
+			continue;
+		}
+
+		if(item->count("layers") > 0 && (*item)["layers"].isArray())
+			ParseLayers(*item, map, layer.m_layers, (accepted) ? keepAll : filter, lazy);
+
+		if(!accepted && layer.m_layers.empty())
+		{
+			layers.pop_back();
+			continue;
+		}
+
+		layer.parseProperties(*item);
+		if(lazy && map != nullptr)
+		{
+			layer.m_lazyJson = item.get();
+			++map->m_unloadedLayers;
+		}
+		else
+			layer.parseData(*item);
+	}
+}
+
+/*!
+ * Reads the fields of the layer itself, which is everything but the data, chunks, child layers, objects and properties.
+ * @return true if all mandatory fields was found. false otherwise.
+ */
+bool tson::Layer::parseHeader(IJson &json, tson::Map *map)
 {
 	m_map = map;
 
 	bool allFound = true;
-	if(json.count("tintcolor") > 0) m_tintColor = tson::Colori(json["tintcolor"].get<std::string>()); //Optional
+	if(json.count("tintcolor") > 0)
+	{
+		m_tintColor = tson::Colori(json["tintcolor"].get<std::string>()); //Optional
+		m_hasTintColor = true;
+	}
 	if(json.count("compression") > 0) m_compression = json["compression"].get<std::string>(); //Optional
 	if(json.count("draworder") > 0) m_drawOrder = json["draworder"].get<std::string>(); //Optional
 	if(json.count("encoding") > 0) m_encoding = json["encoding"].get<std::string>(); //Optional
@@ -7928,47 +20907,229 @@ bool tson::Layer::parse(IJson &json, tson::Map *map)
 
 	m_parallax = parallax;
 
+	setTypeByString();
+	return allFound;
+}
+
+void tson::Layer::parseProperties(IJson &json)
+{
+	if(json.count("properties") > 0 && json["properties"].isArray())
+	{
+		auto &properties = json.array("properties");
+		tson::Project *project = (m_map != nullptr) ? m_map->getProject() : nullptr;
+		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item, project); });
+	}
+}
+
+/*!
+ * Reads the data, chunks and objects of the layer. This is the part of a layer that is deferred by lazy layers.
+ */
+void tson::Layer::parseData(IJson &json)
+{
+	tson::Rect region;
+	bool const decodeRegion = getDataRegion(region);
+
 	//Handle DATA (Optional)
 	if(json.count("data") > 0)
 	{
 		if(json["data"].isArray())
 		{
-			auto &array = json.array("data");
-			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item) { m_data.push_back(item->get<uint32_t>()); });
+			if(decodeRegion)
+				json.readArrayRegion("data", m_data, static_cast<size_t>(m_size.x), static_cast<size_t>(region.x), static_cast<size_t>(region.y),
+									 static_cast<size_t>(region.width), static_cast<size_t>(region.height));
+			else
+				json.readArray("data", m_data);
 		}
 		else
 		{
 			m_base64Data = json["data"].get<std::string>();
-			decompressData();
+			decompressData((decodeRegion) ? &region : nullptr);
 		}
 	}
 
-	//More advanced data
-	if(json.count("chunks") > 0 && json["chunks"].isArray())
+	if(decodeRegion)
 	{
-		auto &chunks = json.array("chunks");
-		std::for_each(chunks.begin(), chunks.end(), [&](std::unique_ptr<IJson> &item) { m_chunks.emplace_back(*item); });
+		m_regionOrigin = {region.x, region.y};
+		m_size = {region.width, region.height};
+		m_hasRegion = true;
 	}
-	if(json.count("layers") > 0 && json["layers"].isArray())
+
+	//More advanced data. With a tile region, only the chunks overlapping it are read.
+	if(json.count("chunks") > 0 && json["chunks"].isArray())
 	{
-		auto &layers = json.array("layers");
-		std::for_each(layers.begin(), layers.end(), [&](std::unique_ptr<IJson> &item) { m_layers.emplace_back(*item, m_map); });
+		const tson::Rect &tileRegion = (m_map != nullptr) ? m_map->m_tileRegion : tson::Rect();
+		auto &chunks = json.array("chunks");
+		for(std::unique_ptr<IJson> &item : chunks)
+		{
+			if(tileRegion.width > 0 && tileRegion.height > 0)
+			{
+				IJson &chunk = *item;
+				int const x = chunk["x"].get<int>();
+				int const y = chunk["y"].get<int>();
+				if(x >= tileRegion.x + tileRegion.width || x + chunk["width"].get<int>() <= tileRegion.x ||
+				   y >= tileRegion.y + tileRegion.height || y + chunk["height"].get<int>() <= tileRegion.y)
+					continue;
+			}
+			m_chunks.emplace_back(*item);
+		}
 	}
 	if(json.count("objects") > 0 && json["objects"].isArray())
 	{
 		auto &objects = json.array("objects");
 		std::for_each(objects.begin(), objects.end(), [&](std::unique_ptr<IJson> &item) { m_objects.emplace_back(*item, m_map); });
 	}
-	if(json.count("properties") > 0 && json["properties"].isArray())
+
+	buildObjectBuckets();
+}
+
+/*!
+ * Reads the tile data, chunks and objects of a lazy layer (see tson::Tileson::setLazyLayers()), and makes its tiles and objects
+ * available through the map. Does nothing if the layer is already loaded.
+ * Called automatically by the functions that need the data, so calling it is only needed to control when the work is done.
+ *
+ * NOTE: Loading changes the layer and its map, so layers of the same map must not be loaded from several threads at once.
+ */
+void tson::Layer::load()
+{
+	if(m_lazyJson != nullptr && m_map != nullptr)
+		m_map->loadLayer(*this);
+}
+
+/*!
+ * The extra offset caused by the parallax factor of this layer, when the given camera rectangle is used.
+ * Follows Tiled: The offset is zero when the center of the camera is at the parallax origin of the map.
+ * @param camera The visible area in pixels
+ * @return Offset in pixels that must be added to the position of everything in this layer.
+ */
+tson::Vector2f tson::Layer::getParallaxOffset(const tson::Rect &camera) const
+{
+	tson::Vector2f origin = (m_map != nullptr) ? m_map->getParallaxOrigin() : tson::Vector2f();
+	float const centerX = static_cast<float>(camera.x) + static_cast<float>(camera.width) / 2.f;
+	float const centerY = static_cast<float>(camera.y) + static_cast<float>(camera.height) / 2.f;
+	return {(1.f - m_parallax.x) * (centerX - origin.x), (1.f - m_parallax.y) * (centerY - origin.y)};
+}
+
+/*!
+ * Converts a rectangle into a range of tiles for the current orientation of the map.
+ * @param rect The rectangle to convert
+ * @param inPixels true if rect is a camera in pixels, false if rect is in tile units
+ */
+tson::Layer::TileRegion tson::Layer::createTileRegion(const tson::Rect &rect, bool inPixels)
+{
+	TileRegion region;
+	if(m_map == nullptr || m_map->getTileSize().x <= 0 || m_map->getTileSize().y <= 0)
+		return region;
+
+	const std::string &orientation = m_map->getOrientation();
+	bool const hexagonal = orientation == "hexagonal";
+	region.orientation = (orientation == "isometric") ? 1 : (hexagonal || orientation == "staggered") ? 2 : 0;
+	region.tileWidth = static_cast<float>(m_map->getTileSize().x);
+	region.tileHeight = static_cast<float>(m_map->getTileSize().y);
+	region.origin = m_offset;
+
+	if(region.orientation == 1)
 	{
-		auto &properties = json.array("properties");
-		tson::Project *project = (m_map != nullptr) ? m_map->getProject() : nullptr;
-		std::for_each(properties.begin(), properties.end(), [&](std::unique_ptr<IJson> &item) { m_properties.add(*item, project); });
+		region.isoOriginX = static_cast<float>(m_map->getSize().y - 1) * region.tileWidth / 2.f;
+	}
+	else if(region.orientation == 2)
+	{
+		//Same as the RenderParams of Tiled's hexagonal renderer. Staggered maps are hexagonal maps with a side length of 0.
+		region.tileWidth = static_cast<float>(m_map->getTileSize().x & ~1);
+		region.tileHeight = static_cast<float>(m_map->getTileSize().y & ~1);
+		region.staggerX = m_map->getStaggerAxis() == "x";
+		region.staggerEven = m_map->getStaggerIndex() == "even";
+		float const sideLength = (hexagonal) ? static_cast<float>(m_map->getHexsideLength()) : 0.f;
+		region.sideLengthX = (region.staggerX) ? sideLength : 0.f;
+		region.sideLengthY = (region.staggerX) ? 0.f : sideLength;
+		region.columnWidth = (region.tileWidth - region.sideLengthX) / 2.f + region.sideLengthX;
+		region.rowHeight = (region.tileHeight - region.sideLengthY) / 2.f + region.sideLengthY;
 	}
 
-	setTypeByString();
+	if(!inPixels)
+	{
+		region.x0 = rect.x;
+		region.y0 = rect.y;
+		region.x1 = rect.x + rect.width - 1;
+		region.y1 = rect.y + rect.height - 1;
+		return region;
+	}
 
-	return allFound;
+	tson::Vector2f parallax = getParallaxOffset(rect);
+	region.origin = {m_offset.x + parallax.x, m_offset.y + parallax.y};
+
+	//Tiles larger than the grid are drawn from the bottom-left corner of the cell, and may also have a tile offset.
+	float padX = 0.f;
+	float padY = 0.f;
+	float padOffset = 0.f;
+	for(auto &tileset : m_map->getTilesets())
+	{
+		padX = std::max(padX, static_cast<float>(tileset.getTileSize().x) - region.tileWidth);
+		padY = std::max(padY, static_cast<float>(tileset.getTileSize().y) - region.tileHeight);
+		padOffset = std::max(padOffset, static_cast<float>(std::max(std::abs(tileset.getTileOffset().x), std::abs(tileset.getTileOffset().y))));
+	}
+
+	region.cull = true;
+	region.minX = static_cast<float>(rect.x) - region.origin.x - padX - padOffset;
+	region.minY = static_cast<float>(rect.y) - region.origin.y - padOffset;
+	region.maxX = static_cast<float>(rect.x + rect.width) - region.origin.x + padOffset;
+	region.maxY = static_cast<float>(rect.y + rect.height) - region.origin.y + padY + padOffset;
+
+	auto toTile = [](float value, float size) { return static_cast<int>(std::floor(value / size)); };
+	if(region.orientation == 1)
+	{
+		float const halfWidth = region.tileWidth / 2.f;
+		float const halfHeight = region.tileHeight / 2.f;
+		float const u0 = (region.minX - region.isoOriginX) / halfWidth;
+		float const u1 = (region.maxX - region.isoOriginX) / halfWidth;
+		float const v0 = region.minY / halfHeight;
+		float const v1 = region.maxY / halfHeight;
+		//x = (u + v) / 2 and y = (v - u) / 2, where u = x - y and v = x + y
+		region.x0 = static_cast<int>(std::floor((u0 + v0) / 2.f)) - 1;
+		region.x1 = static_cast<int>(std::ceil((u1 + v1) / 2.f)) + 1;
+		region.y0 = static_cast<int>(std::floor((v0 - u1) / 2.f)) - 1;
+		region.y1 = static_cast<int>(std::ceil((v1 - u0) / 2.f)) + 1;
+	}
+	else if(region.orientation == 2)
+	{
+		float const stepX = (region.staggerX) ? region.columnWidth : region.tileWidth + region.sideLengthX;
+		float const stepY = (region.staggerX) ? region.tileHeight + region.sideLengthY : region.rowHeight;
+		region.x0 = toTile(region.minX, stepX) - 1;
+		region.x1 = toTile(region.maxX, stepX) + 1;
+		region.y0 = toTile(region.minY, stepY) - 1;
+		region.y1 = toTile(region.maxY, stepY) + 1;
+	}
+	else
+	{
+		region.x0 = toTile(region.minX, region.tileWidth) - 1;
+		region.x1 = toTile(region.maxX, region.tileWidth);
+		region.y0 = toTile(region.minY, region.tileHeight) - 1;
+		region.y1 = toTile(region.maxY, region.tileHeight);
+	}
+
+	return region;
+}
+
+/*!
+ * Finds the tile of a gid. Flip flagged gids are resolved to their flipped tile if it exists, otherwise to the original tile.
+ */
+tson::Tile *tson::Layer::resolveTile(uint32_t gid)
+{
+	if(m_map == nullptr)
+		return nullptr;
+
+	//Tiles without flip flags are found with a single lookup in the drawing table
+	if((gid & (FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG)) == 0)
+	{
+		const tson::TileDrawInfo *info = m_map->getTileDrawInfo(gid);
+		return (info != nullptr) ? info->tile : nullptr;
+	}
+
+	const std::map<uint32_t, tson::Tile *> &tileMap = m_map->getTileMap();
+	auto iter = tileMap.find(gid);
+	if(iter == tileMap.end())
+		iter = tileMap.find(gid & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG));
+
+	return (iter != tileMap.end()) ? iter->second : nullptr;
 }
 
 tson::TiledClass *tson::Layer::getClass()
@@ -8124,6 +21285,10 @@ bool tson::Object::parse(IJson &json, tson::Map *map)
 
 	if(readField(m_template, "template", json) && map != nullptr)
 	{
+		std::shared_ptr<const tson::ObjectTemplate> objectTemplate = map->getTemplate(m_template);
+		if(objectTemplate != nullptr)
+			return parseInstance(json, *objectTemplate);
+
 		IJson* tobjJsonFile = map->parseLinkedFile(m_template);
 		if(tobjJsonFile)
 			templateJson = readField("object", *tobjJsonFile);
@@ -8158,6 +21323,65 @@ bool tson::Object::parse(IJson &json, tson::Map *map)
 	return allFound;
 }
 
+/*!
+ * Parses an instance of a cached template: The object starts as a copy of the template object, and only the fields of the
+ * instance are read on top of it.
+ * @param json The instance
+ * @param objectTemplate The template of the instance
+ * @return true if all mandatory fields was found in the instance or the template. false otherwise.
+ */
+bool tson::Object::parseInstance(IJson &json, const tson::ObjectTemplate &objectTemplate)
+{
+	tson::Map *map = m_map;
+	std::string templatePath = std::move(m_template);
+	*this = objectTemplate.getObject();
+	m_map = map;
+	m_template = std::move(templatePath);
+
+	auto hasField = [&](const std::string &name) { return json.count(name) > 0 || objectTemplate.hasField(name); };
+
+	readField(m_ellipse, "ellipse", json); //Optional
+	readField(m_point, "point", json); // Optional
+	readField(m_text, "text", json);
+	if(json.count("gid") > 0)
+	{
+		m_flipFlags = TileFlipFlags::None;
+		readGid(m_gid, m_flipFlags, json);
+	}
+
+	bool allFound = true;
+	allFound &= readField(m_id, "id", json) || objectTemplate.hasField("id");
+	allFound &= readField(m_name, "name", json) || objectTemplate.hasField("name");
+	allFound &= readField(m_rotation, "rotation", json) || objectTemplate.hasField("rotation");
+	allFound &= readField(m_type, "type", json) || objectTemplate.hasField("type") || readField(m_type, "class", json) || objectTemplate.hasField("class");
+	allFound &= readField(m_visible, "visible", json) || objectTemplate.hasField("visible");
+	readField(m_size.x, "width", json);
+	readField(m_size.y, "height", json);
+	allFound &= hasField("width") && hasField("height");
+	readField(m_position.x, "x", json);
+	readField(m_position.y, "y", json);
+	allFound &= hasField("x") && hasField("y");
+
+	setObjectType(hasField, true);
+	if(m_objectType == ObjectType::Template)
+		allFound = true; //Just accept anything with this type
+
+	if(json.count("polygon") > 0)
+	{
+		m_polygon.clear();
+		readField(m_polygon, "polygon", json);
+	}
+	if(json.count("polyline") > 0)
+	{
+		m_polyline.clear();
+		readField(m_polyline, "polyline", json);
+	}
+
+	readProperties(m_properties, json, m_map);
+
+	return allFound;
+}
+
 // W a n g s e t . h p p
 // ----------------------
 tson::TiledClass *tson::WangSet::getClass()
@@ -8213,24 +21437,204 @@ tson::TiledClass *tson::Object::getClass()
 // ------------------
 
 /*!
- * Loads the actual maps based on the world data.
+ * Loads the actual maps based on the world data. The maps are parsed in parallel on the background threads of the parser,
+ * whose number is set by tson::Tileson::setThreadCount(). See tson::Tileson::parseMany().
+ *
+ * External tilesets and templates shared by the maps are only parsed once: If the parser has no tileset cache or template cache,
+ * the world attaches its own to every map it loads.
  * @param parser A Tileson object used for parsing the maps of the world.
- * @return How many maps who were parsed. Remember to call getStatus() for the actual map to find out if everything went okay.
+ * @return How many maps were loaded successfully. getMaps() has a map for every entry of getMapData(), in the same order,
+ * and getFailedMaps() lists the maps that failed. A map whose parsing threw an exception, like std::bad_alloc,
+ * fails with tson::ParseStatus::ParseError and the message of the exception (see tson::Tileson::CreateFailedMap()).
  */
-
 std::size_t tson::World::loadMaps(tson::Tileson *parser)
 {
 	m_maps.clear();
-	std::for_each(m_mapData.begin(), m_mapData.end(), [&](const tson::WorldMapData &data)
+	m_failedMaps.clear();
+
+	std::shared_ptr<tson::TilesetCache> tilesetCache = parser->getTilesetCache();
+	std::shared_ptr<tson::TemplateCache> templateCache = parser->getTemplateCache();
+	if(tilesetCache == nullptr)
+	{
+		if(m_tilesetCache == nullptr)
+			m_tilesetCache = std::make_shared<tson::TilesetCache>();
+		parser->setTilesetCache(m_tilesetCache);
+	}
+	if(templateCache == nullptr)
+	{
+		if(m_templateCache == nullptr)
+			m_templateCache = std::make_shared<tson::TemplateCache>();
+		parser->setTemplateCache(m_templateCache);
+	}
+
+	std::vector<std::future<std::unique_ptr<tson::Map>>> futures;
+	futures.reserve(m_mapData.size());
+	for(const tson::WorldMapData &data : m_mapData)
+		futures.push_back((m_archive != nullptr) ? parser->parseAsync(*m_archive, data.path) : parser->parseAsync(data.path));
+
+	//The options are copied when the maps are queued, so the caches of the parser can be restored right away
+	parser->setTilesetCache(std::move(tilesetCache));
+	parser->setTemplateCache(std::move(templateCache));
+
+	m_maps.reserve(futures.size());
+	for(size_t i = 0; i < futures.size(); ++i)
 	{
-		if(fs::exists(data.path))
+		try
 		{
-			std::unique_ptr<tson::Map> map = parser->parse(data.path);
-			m_maps.push_back(std::move(map));
+			m_maps.push_back(futures[i].get());
 		}
-	});
+		catch(...)
+		{
+			m_maps.push_back(tson::Tileson::CreateFailedMap(std::current_exception()));
+		}
+		if(m_maps.back()->getStatus() != tson::ParseStatus::OK)
+			m_failedMaps.push_back(i);
+	}
+
+	return m_maps.size() - m_failedMaps.size();
+}
 
-	return m_maps.size();
+/*!
+ * Parses a world file in a tson::Archive. loadMaps() then loads the maps from the same archive,
+ * and 'patterns' match the files in the folder of the world in the archive.
+ * @param archive The archive. Must outlive the world, or at least every call to loadMaps().
+ * @param path Path of the world file in the archive
+ * @return false if the file is not in the archive, or could not be parsed
+ */
+bool tson::World::parse(const tson::Archive &archive, const fs::path &path)
+{
+	m_path = tson::Archive::NormalizePath(path);
+	m_folder = m_path.parent_path();
+	m_archive = &archive;
+
+	std::vector<uint8_t> content;
+	if(!archive.read(m_path, content) || !m_json->parse(content.data(), content.size()))
+		return false;
+
+	parseJson(*m_json);
+	return true;
+}
+
+std::vector<std::string> tson::World::getFileNamesInArchive() const
+{
+	return m_archive->getFileNames(m_folder);
+}
+
+// P r o j e c t . h p p
+// ------------------
+
+/*!
+ * Parses a project file in a tson::Archive. The 'folders' are listed in getData().folders, but are not loaded as tson::ProjectFolders,
+ * which read their folders from disk.
+ * @param archive The archive
+ * @param path Path of the project file in the archive
+ * @return false if the file is not in the archive, or could not be parsed
+ */
+bool tson::Project::parse(const tson::Archive &archive, const fs::path &path)
+{
+	m_path = tson::Archive::NormalizePath(path);
+
+	std::vector<uint8_t> content;
+	if(!archive.read(m_path, content) || !m_json->parse(content.data(), content.size()))
+		return false;
+
+	parseJson(*m_json, false);
+	return true;
+}
+
+// W o r l d S t r e a m e r . h p p
+// ------------------
+
+#ifdef JSON11_IS_DEFINED
+/*!
+ * Parses the maps with tson::Json11. The threads share a tson::TilesetCache and a tson::TemplateCache,
+ * so tilesets and templates used by many maps are only parsed once.
+ * @param world The world. Its map data is copied, so the world does not have to outlive the streamer.
+ * @param threadCount Number of background threads. 0 uses the number of hardware threads.
+ */
+tson::WorldStreamer::WorldStreamer(const tson::World &world, size_t threadCount)
+	: WorldStreamer(world, [tilesets = std::make_shared<tson::TilesetCache>(), templates = std::make_shared<tson::TemplateCache>()]()
+	{
+		std::unique_ptr<tson::Tileson> parser = std::make_unique<tson::Tileson>();
+		parser->setTilesetCache(tilesets);
+		parser->setTemplateCache(templates);
+		return parser;
+	}, threadCount)
+{
+
+}
+#endif
+
+/*!
+ * Parses queued maps, nearest first, until the streamer is destroyed.
+ * A map whose parsing throws, like when the parser factory does, fails like a file that does not exist.
+ */
+void tson::WorldStreamer::workerLoop()
+{
+	std::unique_ptr<tson::Tileson> parser;
+	while(true)
+	{
+		size_t index = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workAvailable.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+			if(m_stop)
+				return;
+
+			index = m_queue.back();
+			m_queue.pop_back();
+			++m_activeJobs;
+		}
+
+		ActiveJob const active {*this};
+		std::unique_ptr<tson::Map> map;
+		try
+		{
+			//Created by the first job, so an exception from the factory fails that map instead of ending the thread
+			if(parser == nullptr)
+				parser = m_parserFactory();
+
+			const fs::path &path = m_mapData[index].path;
+			if(fs::exists(path))
+				map = parser->parse(path);
+		}
+		catch(...)
+		{
+			map = nullptr;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finished.emplace_back(index, std::move(map));
+		}
+	}
+}
+
+// P a r s e P o o l . h p p
+// ------------------
+
+/*!
+ * Starts one background thread for each parser
+ * @param parsers The parsers of the threads. Each must have its own json backend and decompressors.
+ */
+tson::ParsePool::ParsePool(std::vector<std::unique_ptr<tson::Tileson>> parsers) : m_parsers {std::move(parsers)}
+{
+	for(auto &parser : m_parsers)
+		m_threads.emplace_back([this, &parser = *parser]() { workerLoop(parser); });
+}
+
+/*!
+ * Finishes the queued jobs, and stops the background threads
+ */
+tson::ParsePool::~ParsePool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_workAvailable.notify_all();
+	for(auto &thread : m_threads)
+		thread.join();
 }
 
 // P r o p e r t y . h p p
@@ -0,0 +1,36 @@
+// Converts a Tiled map (.json/.tmj) or a map snapshot (.tsonb) to a flat map (.tsonf), which can be mapped with tson::MappedFile
+// and read with tson::MapView.
+//
+// Usage: tileson_flatmap <input> <output.tsonf>
+//
+
+#include "tileson.h"
+
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    if(argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <map.json|map.tsonb> <output.tsonf>\n";
+        return 1;
+    }
+
+    fs::path input {argv[1]};
+    fs::path output {argv[2]};
+
+    tson::Tileson t;
+    std::unique_ptr<tson::Map> map = (input.extension() == ".tsonb") ? tson::MapSnapshot::Load(input, nullptr, t.decompressors()) : t.parse(input);
+    if(map == nullptr || map->getStatus() != tson::ParseStatus::OK)
+    {
+        std::cerr << "Could not parse " << input.generic_string() << ((map != nullptr) ? ": " + map->getStatusMessage() : "") << "\n";
+        return 1;
+    }
+
+    if(!tson::FlatMap::Save(*map, output))
+    {
+        std::cerr << "Could not write " << output.generic_string() << "\n";
+        return 1;
+    }
+    return 0;
+}